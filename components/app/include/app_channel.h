@@ -0,0 +1,168 @@
+/****************************************************************************
+ * components/app/include/app_channel.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Lock-free inter-task channels, with storage sized at compile time:
+ *
+ *   - Snapshot: latest value, one writer, any number of readers. A
+ *     sequence-count latch keeps two copies; the writer updates them in
+ *     turn and never blocks, readers copy the one not being written and
+ *     retry only if the writer finished two updates meanwhile (writer on
+ *     the other core). A reader preempting the writer on the same core
+ *     never retries, so there is no priority inversion.
+ *
+ *   - Ring: bounded single-producer / single-consumer FIFO for streams
+ *     that must not lose samples. push() fails when full instead of
+ *     overwriting, and the overflow is counted.
+ *
+ * Usage:
+ *   APP_SNAPSHOT_DEFINE(g_state, my_state_t);
+ *   app_snapshot_write(&g_state, &state);
+ *   version = app_snapshot_read(&g_state, &copy);
+ *
+ *   APP_RING_DEFINE(g_samples, my_sample_t, 64);
+ *   app_ring_push(&g_samples, &sample);
+ *   while (app_ring_pop(&g_samples, &sample)) ...
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_APP_INCLUDE_APP_CHANNEL_H
+#define __COMPONENTS_APP_INCLUDE_APP_CHANNEL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Snapshot of a type: storage for both latch copies */
+
+#define APP_SNAPSHOT_DEFINE(name, type) \
+  static type name##_copies[2]; \
+  static app_snapshot_t name = \
+  { \
+    .seq = 0, \
+    .size = sizeof(type), \
+    .copies = { &name##_copies[0], &name##_copies[1] }, \
+  }
+
+/* Ring of depth items of a type (depth a power of two) */
+
+#define APP_RING_DEFINE(name, type, depth) \
+  _Static_assert(((depth) & ((depth) - 1)) == 0 && (depth) > 0, \
+                 #name ": ring depth must be a power of two"); \
+  static type name##_items[depth]; \
+  static app_ring_t name = \
+  { \
+    .head = 0, \
+    .tail = 0, \
+    .overflows = 0, \
+    .size = sizeof(type), \
+    .mask = (depth) - 1, \
+    .items = name##_items, \
+  }
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef struct
+{
+  atomic_uint seq;                  /* Updates * 2 (+1 while writing) */
+  size_t size;                      /* Value size in bytes */
+  void *copies[2];
+} app_snapshot_t;
+
+typedef struct
+{
+  atomic_uint head;                 /* Items pushed (producer) */
+  atomic_uint tail;                 /* Items popped (consumer) */
+  atomic_uint overflows;            /* Pushes refused, ring full */
+  size_t size;                      /* Item size in bytes */
+  uint32_t mask;                    /* Depth - 1 */
+  void *items;
+} app_ring_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: app_snapshot_write
+ *
+ * Description:
+ *   Publish a new value. Never blocks. One writer task only.
+ *
+ ****************************************************************************/
+
+void app_snapshot_write(app_snapshot_t *snap, const void *value);
+
+/****************************************************************************
+ * Name: app_snapshot_read
+ *
+ * Description:
+ *   Copy the latest value. Never blocks or takes a lock; any task.
+ *
+ * Returned Value:
+ *   Version of the copied value (number of writes), 0 if nothing was
+ *   written yet (out is left untouched).
+ *
+ ****************************************************************************/
+
+uint32_t app_snapshot_read(const app_snapshot_t *snap, void *out);
+
+/****************************************************************************
+ * Name: app_ring_push
+ *
+ * Description:
+ *   Append an item (producer task only).
+ *
+ * Returned Value:
+ *   true on success; false if the ring is full (item not stored).
+ *
+ ****************************************************************************/
+
+bool app_ring_push(app_ring_t *ring, const void *item);
+
+/****************************************************************************
+ * Name: app_ring_pop
+ *
+ * Description:
+ *   Remove the oldest item (consumer task only).
+ *
+ * Returned Value:
+ *   true if an item was copied; false if the ring is empty.
+ *
+ ****************************************************************************/
+
+bool app_ring_pop(app_ring_t *ring, void *item);
+
+/****************************************************************************
+ * Name: app_ring_count
+ *
+ * Description:
+ *   Items waiting (either side).
+ *
+ ****************************************************************************/
+
+uint32_t app_ring_count(const app_ring_t *ring);
+
+/****************************************************************************
+ * Name: app_ring_overflows
+ *
+ * Description:
+ *   Pushes refused because the ring was full.
+ *
+ ****************************************************************************/
+
+uint32_t app_ring_overflows(const app_ring_t *ring);
+
+#endif /* __COMPONENTS_APP_INCLUDE_APP_CHANNEL_H */
@@ -12,7 +12,34 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
 #include <esp_err.h>
+#include "display_pages.h"
+#include "obstacle_detection.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Protection path stages (app_boot_ready()) */
+
+#define APP_BOOT_SENSING        (1u << 0)   /* Obstacle detection running */
+#define APP_BOOT_HAPTIC         (1u << 1)   /* RTP streaming started */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Fused obstacle state published by task_sensing after every frame */
+
+typedef struct
+{
+  obstacle_ttc_t ttc;                             /* Most urgent per sector */
+  obstacle_sectors_t sectors;                     /* Nearest per sector */
+  bool have_sectors;                              /* sectors is valid */
+  uint16_t column_cm[DISPLAY_OBSTACLE_SECTORS];   /* Nearest per column */
+  int64_t time_us;                                /* Frame INT time */
+} app_obstacle_state_t;
 
 /****************************************************************************
  * Public Function Prototypes
@@ -23,4 +50,40 @@ void task_haptic(void *pvParameters);
 void task_display(void *pvParameters);
 void task_monitor(void *pvParameters);
 
+/****************************************************************************
+ * Name: task_sensing_get_state
+ *
+ * Description:
+ *   Copy the latest fused obstacle state. Lock-free, never blocks; any
+ *   task.
+ *
+ * Returned Value:
+ *   State version (frames published), 0 if none yet.
+ *
+ ****************************************************************************/
+
+uint32_t task_sensing_get_state(app_obstacle_state_t *state);
+
+/****************************************************************************
+ * Name: task_haptic_wake
+ *
+ * Description:
+ *   Tell the haptic task a new obstacle state is available.
+ *
+ ****************************************************************************/
+
+void task_haptic_wake(void);
+
+/****************************************************************************
+ * Name: app_boot_ready
+ *
+ * Description:
+ *   Report protection path stages as up (APP_BOOT_* bits). The display
+ *   and monitor are started once both are, or after
+ *   CONFIG_MAIA_BOOT_UI_WAIT_MS.
+ *
+ ****************************************************************************/
+
+void app_boot_ready(uint32_t stages);
+
 #endif /* __COMPONENTS_APP_INCLUDE_APP_TASKS_H */
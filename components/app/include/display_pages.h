@@ -0,0 +1,268 @@
+/****************************************************************************
+ * components/app/include/display_pages.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * OLED page compositor: registered pages are rendered into the SSD1306
+ * framebuffer only when a data field they depend on changes, and cached
+ * so that switching pages is a framebuffer copy instead of a redraw.
+ * The display task sleeps in display_pages_wait() until the current
+ * page needs a refresh or a page switch is requested.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_APP_INCLUDE_DISPLAY_PAGES_H
+#define __COMPONENTS_APP_INCLUDE_DISPLAY_PAGES_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Data fields a page can depend on (bit mask) */
+
+#define DISPLAY_FIELD_BATTERY       (1u << 0)
+#define DISPLAY_FIELD_TEMPERATURE   (1u << 1)
+#define DISPLAY_FIELD_OBSTACLES     (1u << 2)
+#define DISPLAY_FIELD_LATENCY       (1u << 3)
+#define DISPLAY_FIELD_DEPTH         (1u << 4)
+#define DISPLAY_FIELD_NONE          0u        /* Static page */
+
+/* Page flag, ORed into the fields mask: render overwrites the whole
+ * screen
+ */
+
+#define DISPLAY_PAGE_OPAQUE         (1u << 31)
+
+/* Display events (display_pages_wait()) */
+
+#define DISPLAY_EVENT_CHANGED       (1u << 0) /* Current page out of date */
+#define DISPLAY_EVENT_INPUT         (1u << 1) /* Page switch requested */
+
+/* Obstacle map: 4 sectors per ToF sensor, left to right */
+
+#define DISPLAY_OBSTACLE_SECTORS    8
+
+/* Latency page: one line per pipeline stage (maia_lat_stage_t order) */
+
+#define DISPLAY_LATENCY_STAGES      4
+
+/* Depth map: one 8x8 zone grid per ToF sensor (4x4 frames upscaled),
+ * each zone a level from 0 (nothing in range) to DISPLAY_DEPTH_LEVELS
+ * (touching)
+ */
+
+#define DISPLAY_DEPTH_SENSORS       2
+#define DISPLAY_DEPTH_SIDE          8
+#define DISPLAY_DEPTH_ZONES         (DISPLAY_DEPTH_SIDE * DISPLAY_DEPTH_SIDE)
+#define DISPLAY_DEPTH_LEVELS        16
+
+/* "No value yet" markers */
+
+#define DISPLAY_BATTERY_UNKNOWN     UINT8_MAX
+#define DISPLAY_TEMPERATURE_UNKNOWN INT16_MIN
+#define DISPLAY_DISTANCE_UNKNOWN    UINT16_MAX
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Latency summary of one stage, in 0.1 ms */
+
+typedef struct
+{
+  uint16_t p50;
+  uint16_t p99;
+  uint16_t max;
+} display_latency_t;
+
+/* Snapshot of the data shown on the pages, passed to render callbacks */
+
+typedef struct
+{
+  uint8_t  battery_pct;                                /* 0-100 */
+  int16_t  temperature_dc;                             /* 0.1 degC */
+  uint16_t obstacle_cm[DISPLAY_OBSTACLE_SECTORS];      /* Nearest, cm */
+  display_latency_t latency[DISPLAY_LATENCY_STAGES];   /* INT to stage */
+  uint8_t  depth[DISPLAY_DEPTH_SENSORS][DISPLAY_DEPTH_ZONES]; /* Levels */
+} display_data_t;
+
+/* Render callback: draw the page into a cleared framebuffer with the
+ * ssd1306 drawing functions. Do not call ssd1306_display(). The
+ * framebuffer of an opaque page (DISPLAY_PAGE_OPAQUE) is not cleared:
+ * the page writes every byte itself, so only the bytes that differ from
+ * the last render are sent.
+ */
+
+typedef void (*display_render_t)(const display_data_t *data, void *arg);
+
+/* Page descriptor (must stay valid after registration) */
+
+typedef struct
+{
+  const char       *name;     /* For logs */
+  display_render_t  render;   /* Render callback */
+  uint32_t          fields;   /* DISPLAY_FIELD_* the page depends on */
+  void             *arg;      /* Passed to render */
+} display_page_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: display_pages_register
+ *
+ * Description:
+ *   Add a page to the cycle. Pages are shown in registration order; at
+ *   most CONFIG_MAIA_SSD1306_NUM_PAGES can be registered. The page with
+ *   index CONFIG_MAIA_SSD1306_DEFAULT_PAGE is shown first.
+ *
+ * Input Parameters:
+ *   page - Page descriptor
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG on bad descriptor;
+ *   ESP_ERR_NO_MEM if all page slots are used.
+ *
+ ****************************************************************************/
+
+esp_err_t display_pages_register(const display_page_t *page);
+
+/****************************************************************************
+ * Name: display_pages_next
+ *
+ * Description:
+ *   Switch to the next page (wraps around). Safe from any task.
+ *
+ * Input Parameters:
+ *   input - true for a user request (also raises DISPLAY_EVENT_INPUT),
+ *           false for an automatic page cycle
+ *
+ ****************************************************************************/
+
+void display_pages_next(bool input);
+
+/****************************************************************************
+ * Name: display_pages_wait
+ *
+ * Description:
+ *   Block until one of the given events is raised, or the timeout.
+ *   The returned events are cleared. DISPLAY_EVENT_CHANGED is raised
+ *   only by an update of a field the current page shows (with a value
+ *   that really changed) or a page switch. Display task only, after
+ *   the pages are registered.
+ *
+ * Input Parameters:
+ *   events     - DISPLAY_EVENT_* mask to wait for
+ *   timeout_ms - Longest wait, UINT32_MAX for none
+ *
+ * Returned Value:
+ *   Events raised (0 on timeout).
+ *
+ ****************************************************************************/
+
+uint32_t display_pages_wait(uint32_t events, uint32_t timeout_ms);
+
+/****************************************************************************
+ * Name: display_pages_set_battery
+ *
+ * Description:
+ *   Update the battery charge. Pages depending on it are re-rendered on
+ *   the next display_pages_refresh() only if the value really changed.
+ *   Safe from any task.
+ *
+ * Input Parameters:
+ *   pct - Charge in percent (0-100)
+ *
+ ****************************************************************************/
+
+void display_pages_set_battery(uint8_t pct);
+
+/****************************************************************************
+ * Name: display_pages_set_temperature
+ *
+ * Description:
+ *   Update the temperature. Pages depending on it are re-rendered on
+ *   the next display_pages_refresh() only if the value really changed.
+ *   Safe from any task.
+ *
+ * Input Parameters:
+ *   dc - Temperature in 0.1 degC
+ *
+ ****************************************************************************/
+
+void display_pages_set_temperature(int16_t dc);
+
+/****************************************************************************
+ * Name: display_pages_set_obstacles
+ *
+ * Description:
+ *   Update the obstacle map. Pages depending on it are re-rendered on
+ *   the next display_pages_refresh() only if the value really changed.
+ *   Safe from any task.
+ *
+ * Input Parameters:
+ *   cm - DISPLAY_OBSTACLE_SECTORS nearest distances in cm (left to
+ *        right)
+ *
+ ****************************************************************************/
+
+void display_pages_set_obstacles(const uint16_t *cm);
+
+/****************************************************************************
+ * Name: display_pages_set_latency
+ *
+ * Description:
+ *   Update the latency summaries. Pages depending on them are
+ *   re-rendered on the next display_pages_refresh() only if a value
+ *   really changed. Safe from any task.
+ *
+ * Input Parameters:
+ *   latency - DISPLAY_LATENCY_STAGES summaries
+ *
+ ****************************************************************************/
+
+void display_pages_set_latency(const display_latency_t *latency);
+
+/****************************************************************************
+ * Name: display_pages_set_depth
+ *
+ * Description:
+ *   Update the depth map of one sensor. Pages depending on it are
+ *   re-rendered on the next display_pages_refresh() only if a zone
+ *   really changed. Safe from any task.
+ *
+ * Input Parameters:
+ *   sensor - Sensor index (0 to DISPLAY_DEPTH_SENSORS - 1)
+ *   levels - DISPLAY_DEPTH_ZONES levels, row by row, in the zone order
+ *            of the driver
+ *
+ ****************************************************************************/
+
+void display_pages_set_depth(uint8_t sensor, const uint8_t *levels);
+
+/****************************************************************************
+ * Name: display_pages_refresh
+ *
+ * Description:
+ *   Bring the screen up to date: re-render the current page if one of
+ *   its fields changed (or it was never rendered), otherwise restore it
+ *   from cache if the page was switched, then flush to the display.
+ *   Does nothing when nothing changed. Call from the display task only.
+ *
+ * Returned Value:
+ *   ESP_OK on success (or nothing to do); ssd1306 error otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t display_pages_refresh(void);
+
+#endif /* __COMPONENTS_APP_INCLUDE_DISPLAY_PAGES_H */
@@ -3,6 +3,18 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Staged bring-up. The protection path comes first: the sensing task
+ * (I2C, ToF firmware, IMU) and the haptic task (motor driver, optional
+ * auto-calibration) start right away and bring their devices up in
+ * parallel on the real-time core. Everything else (session log, data
+ * sync, BLE telemetry, then display and monitor) comes up in a
+ * background boot task on the UI core. The display waits for the
+ * protection path, so its I2C traffic does not delay the ToF firmware
+ * upload. Each stage is marked on the boot timeline (maia_boot_mark()).
+ *
+ * The app tasks and the boot event group are created from static
+ * storage, so bring-up leaves no kernel object on the heap.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -11,16 +23,252 @@
 
 #include "app.h"
 #include "app_tasks.h"
+#include "display_pages.h"
+#include "ble_telemetry.h"
+#include "button.h"
+#include "data_logger.h"
+#include "data_sync.h"
+#include "haptic_feedback.h"
+#include "maia_board.h"
+#include "power_manager.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[APP]"
+
+/* Background bring-up task */
+
+#define APP_BOOT_STACK_SIZE     4096
+#define APP_BOOT_PRIORITY       CONFIG_MAIA_TASK_DISPLAY_PRIORITY
+
+#define APP_BOOT_PROTECTION     (APP_BOOT_SENSING | APP_BOOT_HAPTIC)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  TaskFunction_t entry;
+  const char *name;
+  uint32_t stack_size;
+  UBaseType_t priority;
+  BaseType_t core;
+  StackType_t *stack;               /* stack_size bytes */
+  StaticTask_t *tcb;
+} app_task_t;
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void app_boot_task(void *arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Task storage */
+
+MAIA_TASK_STATIC(g_sensing, CONFIG_MAIA_TASK_SENSING_STACK);
+MAIA_TASK_STATIC(g_haptic, CONFIG_MAIA_TASK_HAPTIC_STACK);
+MAIA_TASK_STATIC(g_display, CONFIG_MAIA_TASK_DISPLAY_STACK);
+MAIA_TASK_STATIC(g_monitor, CONFIG_MAIA_TASK_MONITOR_STACK);
+MAIA_TASK_STATIC(g_boot, APP_BOOT_STACK_SIZE);
+
+/* Task layout (Kconfig "Task Layout"): sensing and haptics on the
+ * real-time core, display and monitor on the UI core with the radio.
+ * Every task blocks (notifications, queues or delays) between work.
+ */
+
+static const app_task_t g_rt_tasks[] =
+{
+  {
+    task_sensing, "sensing", CONFIG_MAIA_TASK_SENSING_STACK,
+    CONFIG_MAIA_TASK_SENSING_PRIORITY, MAIA_CORE_RT,
+    g_sensing_stack, &g_sensing_tcb,
+  },
+  {
+    task_haptic, "haptic_ctl", CONFIG_MAIA_TASK_HAPTIC_STACK,
+    CONFIG_MAIA_TASK_HAPTIC_PRIORITY, MAIA_CORE_RT,
+    g_haptic_stack, &g_haptic_tcb,
+  },
+};
+
+static const app_task_t g_ui_tasks[] =
+{
+  {
+    task_display, "display", CONFIG_MAIA_TASK_DISPLAY_STACK,
+    CONFIG_MAIA_TASK_DISPLAY_PRIORITY, MAIA_CORE_UI,
+    g_display_stack, &g_display_tcb,
+  },
+  {
+    task_monitor, "monitor", CONFIG_MAIA_TASK_MONITOR_STACK,
+    CONFIG_MAIA_TASK_MONITOR_PRIORITY, MAIA_CORE_UI,
+    g_monitor_stack, &g_monitor_tcb,
+  },
+};
+
+static const app_task_t g_boot_task =
+{
+  app_boot_task, "app_boot", APP_BOOT_STACK_SIZE, APP_BOOT_PRIORITY,
+  MAIA_CORE_UI, g_boot_stack, &g_boot_tcb,
+};
+
+/* Protection path stages done (APP_BOOT_*) */
+
+static StaticEventGroup_t g_boot_events_buf;
+static EventGroupHandle_t g_boot_events = NULL;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: app_button_cb
+ *
+ * Description:
+ *   Button events: SINGLE_CLICK cycles the display pages,
+ *   EXTRA_LONG_PRESS_1 recalibrates the haptic motor.
+ *
+ ****************************************************************************/
+
+static void app_button_cb(button_event_t event)
+{
+  if (event == BUTTON_EVENT_SINGLE_CLICK)
+    {
+      display_pages_next(true);
+    }
+  else if (event == BUTTON_EVENT_EXTRA_LONG_PRESS_1)
+    {
+      ESP_LOGI(TAG, "Haptic recalibration requested");
+      haptic_feedback_recalibrate();
+    }
+}
+
+/****************************************************************************
+ * Name: app_start_tasks
+ ****************************************************************************/
+
+static esp_err_t app_start_tasks(const app_task_t *tasks, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    {
+      const app_task_t *t = &tasks[i];
+
+      if (xTaskCreateStaticPinnedToCore(t->entry, t->name, t->stack_size,
+                                        NULL, t->priority, t->stack,
+                                        t->tcb, t->core) == NULL)
+        {
+          ESP_LOGE(TAG, "Failed to create %s task", t->name);
+          return ESP_FAIL;
+        }
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: app_boot_task
+ *
+ * Description:
+ *   Background bring-up: session log, data sync and BLE telemetry
+ *   (flash and radio, no I2C) while the protection path boots, then
+ *   the display and monitor once it is up or has given up.
+ *
+ ****************************************************************************/
+
+static void app_boot_task(void *arg)
+{
+  int64_t start_us;
+  EventBits_t bits;
+  esp_err_t ret;
+
+  (void)arg;
+
+  /* The session log is optional: run without it if the partition is
+   * missing. Frames before it opens are not logged.
+   */
+
+  start_us = esp_timer_get_time();
+  ret = data_logger_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Data logger disabled: %s", esp_err_to_name(ret));
+    }
+  else
+    {
+      maia_boot_mark(MAIA_BOOT_LOGGER, start_us);
+
+      start_us = esp_timer_get_time();
+      ret = data_sync_init();
+      if (ret != ESP_OK)
+        {
+          ESP_LOGW(TAG, "Data sync disabled: %s", esp_err_to_name(ret));
+        }
+      else
+        {
+          maia_boot_mark(MAIA_BOOT_SYNC, start_us);
+        }
+    }
+
+  ret = ble_telemetry_init();
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED)
+    {
+      ESP_LOGW(TAG, "BLE telemetry disabled: %s", esp_err_to_name(ret));
+    }
+
+  bits = xEventGroupWaitBits(g_boot_events, APP_BOOT_PROTECTION, pdFALSE,
+                             pdTRUE,
+                             pdMS_TO_TICKS(CONFIG_MAIA_BOOT_UI_WAIT_MS));
+  if ((bits & APP_BOOT_PROTECTION) != APP_BOOT_PROTECTION)
+    {
+      ESP_LOGW(TAG, "Protection path not up after %d ms (%s%s missing)",
+               CONFIG_MAIA_BOOT_UI_WAIT_MS,
+               (bits & APP_BOOT_SENSING) ? "" : " sensing",
+               (bits & APP_BOOT_HAPTIC) ? "" : " haptic");
+    }
+
+  start_us = esp_timer_get_time();
+  if (app_start_tasks(g_ui_tasks, sizeof(g_ui_tasks) /
+                                  sizeof(g_ui_tasks[0])) == ESP_OK)
+    {
+      maia_boot_mark(MAIA_BOOT_UI, start_us);
+    }
+
+  maia_boot_log();
+  vTaskDelete(NULL);
+}
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: app_boot_ready
+ ****************************************************************************/
+
+void app_boot_ready(uint32_t stages)
+{
+  if (g_boot_events != NULL)
+    {
+      xEventGroupSetBits(g_boot_events, (EventBits_t)stages);
+    }
+}
+
 /****************************************************************************
  * Name: app_init
  *
  * Description:
- *   Initialize the application and start all tasks.
+ *   Initialize the application: start the protection path tasks, then
+ *   the background bring-up. Returns before the devices are up.
  *
  * Input Parameters:
  *   None
@@ -32,7 +280,32 @@
 
 esp_err_t app_init(void)
 {
-  /* TODO: Initialize board and start tasks */
+  esp_err_t ret;
 
-  return ESP_OK;
+  ret = power_manager_init();
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED)
+    {
+      ESP_LOGW(TAG, "Power management disabled: %s", esp_err_to_name(ret));
+    }
+
+  ret = button_init(app_button_cb);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Button init failed: %s", esp_err_to_name(ret));
+      return ESP_FAIL;
+    }
+
+  g_boot_events = xEventGroupCreateStatic(&g_boot_events_buf);
+
+  /* Stage 1: protection path */
+
+  if (app_start_tasks(g_rt_tasks, sizeof(g_rt_tasks) /
+                                  sizeof(g_rt_tasks[0])) != ESP_OK)
+    {
+      return ESP_FAIL;
+    }
+
+  /* Stage 2: everything else */
+
+  return app_start_tasks(&g_boot_task, 1);
 }
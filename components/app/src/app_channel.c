@@ -0,0 +1,142 @@
+/****************************************************************************
+ * components/app/src/app_channel.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Snapshot latch (seq even: readers use copy 0, odd: copy 1):
+ *   writer: seq++ ; write copy 0 ; seq++ ; write copy 1
+ *   reader: s = seq ; read copy[s & 1] ; retry if seq != s
+ * The copy a reader picks is never the one being written, so a torn
+ * read is only possible if the writer moved on twice, which the
+ * sequence check catches.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "app_channel.h"
+#include <string.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: app_snapshot_write
+ ****************************************************************************/
+
+void app_snapshot_write(app_snapshot_t *snap, const void *value)
+{
+  unsigned seq = atomic_load_explicit(&snap->seq, memory_order_relaxed);
+
+  /* Readers move to copy 1 while copy 0 is updated */
+
+  atomic_store_explicit(&snap->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  memcpy(snap->copies[0], value, snap->size);
+
+  /* Back to copy 0 while copy 1 is updated */
+
+  atomic_store_explicit(&snap->seq, seq + 2, memory_order_release);
+  atomic_thread_fence(memory_order_release);
+  memcpy(snap->copies[1], value, snap->size);
+}
+
+/****************************************************************************
+ * Name: app_snapshot_read
+ ****************************************************************************/
+
+uint32_t app_snapshot_read(const app_snapshot_t *snap, void *out)
+{
+  app_snapshot_t *s = (app_snapshot_t *)snap;
+  unsigned seq;
+
+  do
+    {
+      seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+      if (seq < 2)
+        {
+          /* Nothing complete yet */
+
+          return 0;
+        }
+
+      memcpy(out, snap->copies[seq & 1], snap->size);
+      atomic_thread_fence(memory_order_acquire);
+    }
+  while (atomic_load_explicit(&s->seq, memory_order_relaxed) != seq);
+
+  /* A value is complete in the copy readers use once seq is even; an
+   * odd seq means copy 1 still holds the previous value
+   */
+
+  return seq / 2;
+}
+
+/****************************************************************************
+ * Name: app_ring_push
+ ****************************************************************************/
+
+bool app_ring_push(app_ring_t *ring, const void *item)
+{
+  unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+  if (head - tail > ring->mask)
+    {
+      atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+      return false;
+    }
+
+  memcpy((uint8_t *)ring->items + (head & ring->mask) * ring->size, item,
+         ring->size);
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: app_ring_pop
+ ****************************************************************************/
+
+bool app_ring_pop(app_ring_t *ring, void *item)
+{
+  unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+  if (head == tail)
+    {
+      return false;
+    }
+
+  memcpy(item, (const uint8_t *)ring->items + (tail & ring->mask) *
+         ring->size, ring->size);
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: app_ring_count
+ ****************************************************************************/
+
+uint32_t app_ring_count(const app_ring_t *ring)
+{
+  app_ring_t *r = (app_ring_t *)ring;
+
+  return atomic_load_explicit(&r->head, memory_order_acquire) -
+         atomic_load_explicit(&r->tail, memory_order_acquire);
+}
+
+/****************************************************************************
+ * Name: app_ring_overflows
+ ****************************************************************************/
+
+uint32_t app_ring_overflows(const app_ring_t *ring)
+{
+  app_ring_t *r = (app_ring_t *)ring;
+
+  return atomic_load_explicit(&r->overflows, memory_order_relaxed);
+}
@@ -0,0 +1,398 @@
+/****************************************************************************
+ * components/app/src/display_pages.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "display_pages.h"
+#include "ssd1306.h"
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+#include <string.h>
+#include <stdbool.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[DISPLAY_PAGES]"
+
+#define DISPLAY_MAX_PAGES  CONFIG_MAIA_SSD1306_NUM_PAGES
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const display_page_t *g_pages[DISPLAY_MAX_PAGES];
+static uint8_t g_page_count = 0;
+
+/* Rendered framebuffer of each page; valid when its bit is clear in
+ * g_stale (all pages start stale, i.e. never rendered)
+ */
+
+static uint8_t g_cache[DISPLAY_MAX_PAGES][SSD1306_BUFFER_SIZE];
+
+/* Shared with the setters and display_pages_next() (g_lock) */
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static display_data_t g_data =
+{
+  .battery_pct    = DISPLAY_BATTERY_UNKNOWN,
+  .temperature_dc = DISPLAY_TEMPERATURE_UNKNOWN,
+  .obstacle_cm    =
+  {
+    [0 ... DISPLAY_OBSTACLE_SECTORS - 1] = DISPLAY_DISTANCE_UNKNOWN
+  },
+};
+
+static uint32_t g_stale = UINT32_MAX;   /* One bit per page */
+static uint8_t g_current = 0;           /* Page selected */
+
+/* Display events, created with the first page: updates before that are
+ * only recorded in g_stale (the first refresh renders anyway)
+ */
+
+static StaticEventGroup_t g_events_buf;
+static EventGroupHandle_t g_events = NULL;
+
+/* Display task only */
+
+static int g_shown = -1;                /* Page in the framebuffer */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: display_pages_invalidate
+ *
+ * Description:
+ *   Mark stale every page depending on one of the given fields. Must be
+ *   called with g_lock held.
+ *
+ * Returned Value:
+ *   Events to raise once the lock is released.
+ *
+ ****************************************************************************/
+
+static uint32_t display_pages_invalidate(uint32_t fields)
+{
+  for (uint8_t i = 0; i < g_page_count; i++)
+    {
+      if (g_pages[i]->fields & fields)
+        {
+          g_stale |= 1u << i;
+        }
+    }
+
+  return g_page_count > 0 && (g_pages[g_current]->fields & fields) ?
+         DISPLAY_EVENT_CHANGED : 0;
+}
+
+/****************************************************************************
+ * Name: display_pages_signal
+ ****************************************************************************/
+
+static void display_pages_signal(uint32_t events)
+{
+  EventGroupHandle_t group = g_events;
+
+  if (events != 0 && group != NULL)
+    {
+      xEventGroupSetBits(group, events);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: display_pages_register
+ ****************************************************************************/
+
+esp_err_t display_pages_register(const display_page_t *page)
+{
+  EventGroupHandle_t group = NULL;
+  esp_err_t ret = ESP_OK;
+
+  if (page == NULL || page->render == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_events == NULL)
+    {
+      group = xEventGroupCreateStatic(&g_events_buf);
+    }
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (group != NULL)
+    {
+      g_events = group;
+    }
+
+  if (g_page_count >= DISPLAY_MAX_PAGES)
+    {
+      ret = ESP_ERR_NO_MEM;
+    }
+  else
+    {
+      g_pages[g_page_count++] = page;
+
+      if (g_page_count - 1 == CONFIG_MAIA_SSD1306_DEFAULT_PAGE)
+        {
+          g_current = CONFIG_MAIA_SSD1306_DEFAULT_PAGE;
+        }
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "No slot for page '%s' (MAIA_SSD1306_NUM_PAGES=%d)",
+               page->name, DISPLAY_MAX_PAGES);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: display_pages_next
+ ****************************************************************************/
+
+void display_pages_next(bool input)
+{
+  uint32_t events = input ? DISPLAY_EVENT_INPUT : 0;
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (g_page_count > 0)
+    {
+      g_current = (g_current + 1) % g_page_count;
+      events |= DISPLAY_EVENT_CHANGED;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  display_pages_signal(events);
+}
+
+/****************************************************************************
+ * Name: display_pages_wait
+ ****************************************************************************/
+
+uint32_t display_pages_wait(uint32_t events, uint32_t timeout_ms)
+{
+  TickType_t ticks = timeout_ms == UINT32_MAX ? portMAX_DELAY :
+                     pdMS_TO_TICKS(timeout_ms);
+
+  /* Round a short timeout up to a tick instead of polling */
+
+  if (ticks == 0 && timeout_ms > 0)
+    {
+      ticks = 1;
+    }
+
+  if (g_events == NULL)
+    {
+      vTaskDelay(ticks);
+      return 0;
+    }
+
+  return xEventGroupWaitBits(g_events, events, pdTRUE, pdFALSE, ticks) &
+         events;
+}
+
+/****************************************************************************
+ * Name: display_pages_set_battery
+ ****************************************************************************/
+
+void display_pages_set_battery(uint8_t pct)
+{
+  uint32_t events = 0;
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (g_data.battery_pct != pct)
+    {
+      g_data.battery_pct = pct;
+      events = display_pages_invalidate(DISPLAY_FIELD_BATTERY);
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  display_pages_signal(events);
+}
+
+/****************************************************************************
+ * Name: display_pages_set_temperature
+ ****************************************************************************/
+
+void display_pages_set_temperature(int16_t dc)
+{
+  uint32_t events = 0;
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (g_data.temperature_dc != dc)
+    {
+      g_data.temperature_dc = dc;
+      events = display_pages_invalidate(DISPLAY_FIELD_TEMPERATURE);
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  display_pages_signal(events);
+}
+
+/****************************************************************************
+ * Name: display_pages_set_obstacles
+ ****************************************************************************/
+
+void display_pages_set_obstacles(const uint16_t *cm)
+{
+  uint32_t events = 0;
+
+  if (cm == NULL)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (memcmp(g_data.obstacle_cm, cm, sizeof(g_data.obstacle_cm)) != 0)
+    {
+      memcpy(g_data.obstacle_cm, cm, sizeof(g_data.obstacle_cm));
+      events = display_pages_invalidate(DISPLAY_FIELD_OBSTACLES);
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  display_pages_signal(events);
+}
+
+/****************************************************************************
+ * Name: display_pages_set_latency
+ ****************************************************************************/
+
+void display_pages_set_latency(const display_latency_t *latency)
+{
+  uint32_t events = 0;
+
+  if (latency == NULL)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (memcmp(g_data.latency, latency, sizeof(g_data.latency)) != 0)
+    {
+      memcpy(g_data.latency, latency, sizeof(g_data.latency));
+      events = display_pages_invalidate(DISPLAY_FIELD_LATENCY);
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  display_pages_signal(events);
+}
+
+/****************************************************************************
+ * Name: display_pages_set_depth
+ ****************************************************************************/
+
+void display_pages_set_depth(uint8_t sensor, const uint8_t *levels)
+{
+  uint32_t events = 0;
+
+  if (sensor >= DISPLAY_DEPTH_SENSORS || levels == NULL)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (memcmp(g_data.depth[sensor], levels, DISPLAY_DEPTH_ZONES) != 0)
+    {
+      memcpy(g_data.depth[sensor], levels, DISPLAY_DEPTH_ZONES);
+      events = display_pages_invalidate(DISPLAY_FIELD_DEPTH);
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  display_pages_signal(events);
+}
+
+/****************************************************************************
+ * Name: display_pages_refresh
+ ****************************************************************************/
+
+esp_err_t display_pages_refresh(void)
+{
+  const display_page_t *page;
+  display_data_t data;
+  uint8_t current;
+  bool stale;
+
+  /* Snapshot under the lock; the stale bit is cleared now so a change
+   * arriving while rendering marks the page stale again
+   */
+
+  portENTER_CRITICAL(&g_lock);
+
+  if (g_page_count == 0)
+    {
+      portEXIT_CRITICAL(&g_lock);
+      return ESP_OK;
+    }
+
+  current = g_current;
+  page = g_pages[current];
+  stale = (g_stale & (1u << current)) != 0;
+  g_stale &= ~(1u << current);
+  data = g_data;
+
+  portEXIT_CRITICAL(&g_lock);
+
+  if (stale)
+    {
+      /* Re-render from scratch (an opaque page overwrites the previous
+       * screen byte by byte) and update the cache
+       */
+
+      if ((page->fields & DISPLAY_PAGE_OPAQUE) == 0)
+        {
+          ssd1306_clear();
+        }
+
+      page->render(&data, page->arg);
+      ssd1306_save_framebuffer(g_cache[current]);
+    }
+  else if (current != g_shown)
+    {
+      /* Switch: the cached render is still current */
+
+      ssd1306_load_framebuffer(g_cache[current]);
+    }
+  else
+    {
+      return ESP_OK;
+    }
+
+  if (current != g_shown)
+    {
+      ESP_LOGD(TAG, "Page %u: %s", current, page->name);
+      g_shown = current;
+    }
+
+  return ssd1306_display();
+}
@@ -3,6 +3,18 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Display task: sleeps until the current page shows a changed value or
+ * the button switches pages, and flushes at most once per
+ * CONFIG_MAIA_SSD1306_FRAME_MS, so display I2C traffic follows how
+ * often the shown information changes. Screen states:
+ *
+ *   - Active: after a button press, full contrast.
+ *   - Idle: no press for MAIA_TIMEOUT_DISPLAY_SCREEN_SEC. Panel dimmed
+ *     (ssd1306_set_idle()), pages cycle every SCREEN_SEC.
+ *   - Off: no press for MAIA_TIMEOUT_DISPLAY_OFF_SEC. Panel off and no
+ *     flush at all; pages keep tracking their data and the next press
+ *     shows the current state.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,6 +22,354 @@
  ****************************************************************************/
 
 #include "app_tasks.h"
+#include "display_pages.h"
+#include "ssd1306.h"
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdio.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TASK_DISPLAY]"
+
+/* Flush rate limit and screen timeouts */
+
+#define DISPLAY_FRAME_MS   CONFIG_MAIA_SSD1306_FRAME_MS
+#define DISPLAY_SCREEN_MS  (CONFIG_MAIA_TIMEOUT_DISPLAY_SCREEN_SEC * 1000)
+#define DISPLAY_OFF_MS     (CONFIG_MAIA_TIMEOUT_DISPLAY_OFF_SEC * 1000)
+
+/* Obstacle map: full-height bar at 0 cm, empty at DISPLAY_RANGE_CM */
+
+#define DISPLAY_RANGE_CM        200
+#define DISPLAY_BAR_WIDTH       (SSD1306_WIDTH / DISPLAY_OBSTACLE_SECTORS)
+
+/* Depth map: both zone grids side by side, each zone an 8x4 block, so
+ * a page byte holds the zones of two grid rows
+ */
+
+#define DISPLAY_DEPTH_COLS      (SSD1306_WIDTH / DISPLAY_DEPTH_SENSORS)
+#define DISPLAY_ZONE_WIDTH      (DISPLAY_DEPTH_COLS / DISPLAY_DEPTH_SIDE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef enum
+{
+  DISPLAY_ACTIVE,
+  DISPLAY_IDLE,
+  DISPLAY_OFF,
+} display_state_t;
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void render_animal(const display_data_t *data, void *arg);
+static void render_battery(const display_data_t *data, void *arg);
+static void render_temperature(const display_data_t *data, void *arg);
+static void render_obstacles(const display_data_t *data, void *arg);
+static void render_latency(const display_data_t *data, void *arg);
+static void render_depth(const display_data_t *data, void *arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Page cycle (SINGLE_CLICK moves to the next one) */
+
+static const display_page_t g_default_pages[] =
+{
+  { "animal",      render_animal,      DISPLAY_FIELD_NONE,        NULL },
+  { "battery",     render_battery,     DISPLAY_FIELD_BATTERY,     NULL },
+  { "temperature", render_temperature, DISPLAY_FIELD_TEMPERATURE, NULL },
+  { "obstacles",   render_obstacles,   DISPLAY_FIELD_OBSTACLES,   NULL },
+  { "latency",     render_latency,     DISPLAY_FIELD_LATENCY,     NULL },
+  { "depth",       render_depth,
+    DISPLAY_FIELD_DEPTH | DISPLAY_PAGE_OPAQUE,                    NULL },
+};
+
+/* 4x4 ordered (Bayer) dither of each depth level: 4-row column nibble
+ * (bit 0 = top row) for x % 4
+ */
+
+static const uint8_t g_dither[DISPLAY_DEPTH_LEVELS + 1][4] =
+{
+  { 0x0, 0x0, 0x0, 0x0 },
+  { 0x1, 0x0, 0x0, 0x0 },
+  { 0x1, 0x0, 0x4, 0x0 },
+  { 0x1, 0x0, 0x5, 0x0 },
+  { 0x5, 0x0, 0x5, 0x0 },
+  { 0x5, 0x2, 0x5, 0x0 },
+  { 0x5, 0x2, 0x5, 0x8 },
+  { 0x5, 0x2, 0x5, 0xa },
+  { 0x5, 0xa, 0x5, 0xa },
+  { 0x5, 0xb, 0x5, 0xa },
+  { 0x5, 0xb, 0x5, 0xe },
+  { 0x5, 0xb, 0x5, 0xf },
+  { 0x5, 0xf, 0x5, 0xf },
+  { 0x7, 0xf, 0x5, 0xf },
+  { 0x7, 0xf, 0xd, 0xf },
+  { 0x7, 0xf, 0xf, 0xf },
+  { 0xf, 0xf, 0xf, 0xf },
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fill_rect
+ *
+ * Description:
+ *   Set all pixels of a rectangle (clipped by ssd1306_set_pixel()).
+ *
+ ****************************************************************************/
+
+static void fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h)
+{
+  for (uint8_t i = 0; i < w; i++)
+    {
+      for (uint8_t j = 0; j < h; j++)
+        {
+          ssd1306_set_pixel(x + i, y + j, true);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: render_animal
+ *
+ * Description:
+ *   Static page with the animal information from Kconfig.
+ *
+ ****************************************************************************/
+
+static void render_animal(const display_data_t *data, void *arg)
+{
+  char line[32];
+
+  (void)data;
+  (void)arg;
+
+  ssd1306_draw_string(0, 0, CONFIG_MAIA_ANIMAL_NAME, SSD1306_FONT_LARGE);
+
+  snprintf(line, sizeof(line), "%s / %s",
+           CONFIG_MAIA_ANIMAL_SPECIES, CONFIG_MAIA_ANIMAL_BREED);
+  ssd1306_draw_string(0, 16, line, SSD1306_FONT_SMALL);
+
+  snprintf(line, sizeof(line), "%d y  %d kg  %s",
+           CONFIG_MAIA_ANIMAL_AGE, CONFIG_MAIA_ANIMAL_WEIGHT,
+           CONFIG_MAIA_ANIMAL_BLOOD_TYPE);
+  ssd1306_draw_string(0, 24, line, SSD1306_FONT_SMALL);
+}
+
+/****************************************************************************
+ * Name: render_battery
+ ****************************************************************************/
+
+static void render_battery(const display_data_t *data, void *arg)
+{
+  char line[16];
+
+  (void)arg;
+
+  ssd1306_draw_string(0, 0, "Battery", SSD1306_FONT_SMALL);
+
+  if (data->battery_pct == DISPLAY_BATTERY_UNKNOWN)
+    {
+      ssd1306_draw_string(0, 12, "--%", SSD1306_FONT_LARGE);
+      return;
+    }
+
+  snprintf(line, sizeof(line), "%u%%", data->battery_pct);
+  ssd1306_draw_string(0, 12, line, SSD1306_FONT_LARGE);
+
+  /* Charge gauge on the right half */
+
+  fill_rect(64, 14, (data->battery_pct * 60) / 100, 12);
+}
+
+/****************************************************************************
+ * Name: render_temperature
+ ****************************************************************************/
+
+static void render_temperature(const display_data_t *data, void *arg)
+{
+  char line[16];
+  int dc = data->temperature_dc;
+
+  (void)arg;
+
+  ssd1306_draw_string(0, 0, "Temperature", SSD1306_FONT_SMALL);
+
+  if (data->temperature_dc == DISPLAY_TEMPERATURE_UNKNOWN)
+    {
+      ssd1306_draw_string(0, 12, "--.- C", SSD1306_FONT_LARGE);
+      return;
+    }
+
+  snprintf(line, sizeof(line), "%s%d.%d C", dc < 0 ? "-" : "",
+           (dc < 0 ? -dc : dc) / 10, (dc < 0 ? -dc : dc) % 10);
+  ssd1306_draw_string(0, 12, line, SSD1306_FONT_LARGE);
+}
+
+/****************************************************************************
+ * Name: render_obstacles
+ *
+ * Description:
+ *   One bar per sector, the closer the obstacle the taller the bar.
+ *   Sectors without data show a single pixel line at the bottom.
+ *
+ ****************************************************************************/
+
+static void render_obstacles(const display_data_t *data, void *arg)
+{
+  (void)arg;
+
+  for (uint8_t s = 0; s < DISPLAY_OBSTACLE_SECTORS; s++)
+    {
+      uint16_t cm = data->obstacle_cm[s];
+      uint8_t x = s * DISPLAY_BAR_WIDTH;
+      uint8_t h;
+
+      if (cm == DISPLAY_DISTANCE_UNKNOWN)
+        {
+          fill_rect(x + 1, SSD1306_HEIGHT - 1, DISPLAY_BAR_WIDTH - 2, 1);
+          continue;
+        }
+
+      if (cm > DISPLAY_RANGE_CM)
+        {
+          cm = DISPLAY_RANGE_CM;
+        }
+
+      h = ((DISPLAY_RANGE_CM - cm) * SSD1306_HEIGHT) / DISPLAY_RANGE_CM;
+      fill_rect(x + 1, SSD1306_HEIGHT - h, DISPLAY_BAR_WIDTH - 2, h);
+    }
+}
+
+/****************************************************************************
+ * Name: render_latency
+ *
+ * Description:
+ *   INT-to-stage latency, one line per stage: p50 / p99 / max in ms.
+ *
+ ****************************************************************************/
+
+static void render_latency(const display_data_t *data, void *arg)
+{
+  static const char *const names[DISPLAY_LATENCY_STAGES] =
+  {
+    "Rd", "Fu", "Cm", "Mo",
+  };
+
+  char line[32];
+
+  (void)arg;
+
+  for (uint8_t s = 0; s < DISPLAY_LATENCY_STAGES; s++)
+    {
+      const display_latency_t *l = &data->latency[s];
+
+      snprintf(line, sizeof(line), "%s %u.%u %u.%u %u.%u", names[s],
+               l->p50 / 10, l->p50 % 10, l->p99 / 10, l->p99 % 10,
+               l->max / 10, l->max % 10);
+      ssd1306_draw_string(0, s * 8, line, SSD1306_FONT_SMALL);
+    }
+}
+
+/****************************************************************************
+ * Name: render_depth
+ *
+ * Description:
+ *   Depth map of both sensors, left sensor on the left, closer zones
+ *   brighter. Opaque page: every byte is written, a page row at a time,
+ *   so only the zones that changed reach the bus.
+ *
+ ****************************************************************************/
+
+static void render_depth(const display_data_t *data, void *arg)
+{
+  uint8_t row[SSD1306_WIDTH];
+
+  (void)arg;
+
+  for (uint8_t page = 0; page < SSD1306_HEIGHT / 8; page++)
+    {
+      for (uint8_t x = 0; x < SSD1306_WIDTH; x++)
+        {
+          const uint8_t *zones = &data->depth[x / DISPLAY_DEPTH_COLS]
+                                 [page * 2 * DISPLAY_DEPTH_SIDE];
+          uint8_t zone = (x % DISPLAY_DEPTH_COLS) / DISPLAY_ZONE_WIDTH;
+          uint8_t top = zones[zone];
+          uint8_t bottom = zones[DISPLAY_DEPTH_SIDE + zone];
+
+          row[x] = g_dither[top][x & 3] | (g_dither[bottom][x & 3] << 4);
+        }
+
+      ssd1306_write_page(page, 0, row, SSD1306_WIDTH);
+    }
+}
+
+/****************************************************************************
+ * Name: display_elapsed_ms
+ ****************************************************************************/
+
+static inline uint32_t display_elapsed_ms(TickType_t since)
+{
+  return pdTICKS_TO_MS(xTaskGetTickCount() - since);
+}
+
+/****************************************************************************
+ * Name: display_remaining_ms
+ ****************************************************************************/
+
+static inline uint32_t display_remaining_ms(TickType_t since,
+                                            uint32_t period_ms)
+{
+  uint32_t elapsed = display_elapsed_ms(since);
+
+  return elapsed < period_ms ? period_ms - elapsed : 0;
+}
+
+/****************************************************************************
+ * Name: display_set_state
+ *
+ * Description:
+ *   Drive the panel into a screen state. Panel commands are only sent on
+ *   a transition.
+ *
+ ****************************************************************************/
+
+static void display_set_state(display_state_t *state, display_state_t next)
+{
+  if (*state == next)
+    {
+      return;
+    }
+
+  if (next == DISPLAY_OFF)
+    {
+      ssd1306_screen_off();
+    }
+  else
+    {
+      if (*state == DISPLAY_OFF)
+        {
+          ssd1306_screen_on();
+        }
+
+      ssd1306_set_idle(next == DISPLAY_IDLE);
+    }
+
+  ESP_LOGD(TAG, "Screen %s", next == DISPLAY_ACTIVE ? "active" :
+                             next == DISPLAY_IDLE ? "idle" : "off");
+  *state = next;
+}
 
 /****************************************************************************
  * Public Functions
@@ -19,7 +379,9 @@
  * Name: task_display
  *
  * Description:
- *   FreeRTOS task function.
+ *   FreeRTOS task function. Initializes the display, registers the
+ *   default pages and keeps the screen up to date through the page
+ *   compositor, waking only on display events and screen timeouts.
  *
  * Input Parameters:
  *   pvParameters - Task parameters (unused)
@@ -31,10 +393,95 @@
 
 void task_display(void *pvParameters)
 {
+  display_state_t state = DISPLAY_ACTIVE;
+  uint32_t events = DISPLAY_EVENT_CHANGED;      /* First render */
+  TickType_t input = xTaskGetTickCount();       /* Last button press */
+  TickType_t cycled = input;                    /* Last page cycle */
+  TickType_t flushed = input - pdMS_TO_TICKS(DISPLAY_FRAME_MS);
+  uint32_t timeout;
+  uint32_t quiet;
+
   (void)pvParameters;
 
+  if (ssd1306_init() != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Display init failed, task exiting");
+      vTaskDelete(NULL);
+      return;
+    }
+
+  for (size_t i = 0; i < sizeof(g_default_pages) /
+                         sizeof(g_default_pages[0]); i++)
+    {
+      display_pages_register(&g_default_pages[i]);
+    }
+
   for (;;)
     {
-      /* TODO: Implement task_display */
+      if (events & DISPLAY_EVENT_INPUT)
+        {
+          input = cycled = xTaskGetTickCount();
+        }
+
+      quiet = display_elapsed_ms(input);
+      display_set_state(&state, quiet >= DISPLAY_OFF_MS ? DISPLAY_OFF :
+                                quiet >= DISPLAY_SCREEN_MS ? DISPLAY_IDLE :
+                                DISPLAY_ACTIVE);
+
+      if (state == DISPLAY_OFF)
+        {
+          /* Changes stay recorded as stale pages; the press that wakes
+           * the screen also switches the page, so it renders anyway
+           */
+
+          events = display_pages_wait(DISPLAY_EVENT_INPUT, UINT32_MAX) |
+                   DISPLAY_EVENT_CHANGED;
+          continue;
+        }
+
+      if (state == DISPLAY_IDLE &&
+          display_elapsed_ms(cycled) >= DISPLAY_SCREEN_MS)
+        {
+          cycled = xTaskGetTickCount();
+          display_pages_next(false);
+          events |= DISPLAY_EVENT_CHANGED;
+        }
+
+      if (events & DISPLAY_EVENT_CHANGED)
+        {
+          /* Rate limit: changes arriving meanwhile are merged, the
+           * refresh renders the latest values
+           */
+
+          timeout = display_remaining_ms(flushed, DISPLAY_FRAME_MS);
+          if (timeout > 0)
+            {
+              vTaskDelay(pdMS_TO_TICKS(timeout));
+            }
+
+          if (display_pages_refresh() != ESP_OK)
+            {
+              ESP_LOGW(TAG, "Display refresh failed");
+            }
+
+          flushed = xTaskGetTickCount();
+        }
+
+      /* Sleep until an event or the next screen timeout */
+
+      if (state == DISPLAY_ACTIVE)
+        {
+          timeout = display_remaining_ms(input, DISPLAY_SCREEN_MS);
+        }
+      else
+        {
+          timeout = display_remaining_ms(cycled, DISPLAY_SCREEN_MS);
+        }
+
+      quiet = display_remaining_ms(input, DISPLAY_OFF_MS);
+      timeout = quiet < timeout ? quiet : timeout;
+
+      events = display_pages_wait(DISPLAY_EVENT_CHANGED |
+                                  DISPLAY_EVENT_INPUT, timeout);
     }
 }
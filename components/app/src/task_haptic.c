@@ -3,6 +3,12 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Haptic task: owns the haptic feedback bring-up and turns the obstacle
+ * state published by the sensing task into the RTP target. It is woken
+ * per frame and reads the latest snapshot, so bursts coalesce; if
+ * sensing goes quiet the motor is silenced instead of holding a stale
+ * cue.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,16 +16,119 @@
  ****************************************************************************/
 
 #include "app_tasks.h"
+#include "haptic_feedback.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TASK_HAPTIC]"
+
+/* No threat for this long (sensing stalled): stop vibrating */
+
+#define HAPTIC_STALE_MS         500
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_task = NULL;
+static app_obstacle_state_t g_state;
+
+static const drv2605l_config_t g_drv_config =
+{
+  .i2c_addr = CONFIG_MAIA_DRV2605L_I2C_ADDR,
+#ifdef CONFIG_MAIA_DRV2605L_ACTUATOR_ERM
+  .actuator = DRV2605L_ACTUATOR_ERM,
+#else
+  .actuator = DRV2605L_ACTUATOR_LRA,
+#endif
+#if defined(CONFIG_MAIA_DRV2605L_LIBRARY_A)
+  .library = DRV2605L_LIB_ERM_A,
+#elif defined(CONFIG_MAIA_DRV2605L_LIBRARY_B)
+  .library = DRV2605L_LIB_ERM_B,
+#elif defined(CONFIG_MAIA_DRV2605L_LIBRARY_C)
+  .library = DRV2605L_LIB_ERM_C,
+#elif defined(CONFIG_MAIA_DRV2605L_LIBRARY_D)
+  .library = DRV2605L_LIB_ERM_D,
+#elif defined(CONFIG_MAIA_DRV2605L_LIBRARY_E)
+  .library = DRV2605L_LIB_ERM_E,
+#else
+  .library = DRV2605L_LIB_LRA,
+#endif
+  .rated_voltage = CONFIG_MAIA_DRV2605L_RATED_VOLTAGE,
+  .overdrive_clamp = CONFIG_MAIA_DRV2605L_OVERDRIVE_CLAMP,
+#ifdef CONFIG_MAIA_DRV2605L_AUTO_CALIBRATION
+  .auto_calibrate = true,
+#else
+  .auto_calibrate = false,
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: haptic_apply
+ *
+ * Description:
+ *   Drive the RTP target from the most urgent sector (lowest TTC, then
+ *   nearest).
+ *
+ ****************************************************************************/
+
+static void haptic_apply(const app_obstacle_state_t *st)
+{
+  uint16_t best_ttc = OBSTACLE_TTC_NONE;
+  uint16_t best_mm = UINT16_MAX;
+
+  for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+    {
+      uint16_t mm = st->ttc.distance_mm[s] == VL53L5CX_DISTANCE_INVALID ?
+                    UINT16_MAX : (uint16_t)st->ttc.distance_mm[s];
+
+      if (st->ttc.ttc_ms[s] < best_ttc ||
+          (st->ttc.ttc_ms[s] == best_ttc && mm < best_mm))
+        {
+          best_ttc = st->ttc.ttc_ms[s];
+          best_mm = mm;
+        }
+    }
+
+  haptic_feedback_set_threat(best_mm, best_ttc, st->time_us);
+  maia_latency_record(MAIA_LAT_COMMAND, st->time_us, esp_timer_get_time());
+}
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: task_haptic_wake
+ ****************************************************************************/
+
+void task_haptic_wake(void)
+{
+  TaskHandle_t task = g_task;
+
+  if (task != NULL)
+    {
+      xTaskNotifyGive(task);
+    }
+}
+
 /****************************************************************************
  * Name: task_haptic
  *
  * Description:
- *   FreeRTOS task function.
+ *   FreeRTOS task function. Starts haptic feedback in RTP streaming mode
+ *   and blocks on sensing wake-ups.
  *
  * Input Parameters:
  *   pvParameters - Task parameters (unused)
@@ -31,10 +140,59 @@
 
 void task_haptic(void *pvParameters)
 {
+  int64_t start_us = esp_timer_get_time();
+  uint32_t version = 0;
+  bool silent = true;
+  bool cued = false;
+  esp_err_t ret;
+
   (void)pvParameters;
 
+  ret = haptic_feedback_init(&g_drv_config);
+  if (ret == ESP_OK)
+    {
+      ret = haptic_feedback_rtp_start();
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Haptic init failed (%s), task exiting",
+               esp_err_to_name(ret));
+      vTaskDelete(NULL);
+      return;
+    }
+
+  g_task = xTaskGetCurrentTaskHandle();
+  maia_boot_mark(MAIA_BOOT_HAPTIC, start_us);
+  app_boot_ready(APP_BOOT_HAPTIC);
+
   for (;;)
     {
-      /* TODO: Implement task_haptic */
+      uint32_t latest;
+
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HAPTIC_STALE_MS));
+
+      latest = task_sensing_get_state(&g_state);
+      if (latest != version)
+        {
+          version = latest;
+          haptic_apply(&g_state);
+          silent = false;
+
+          /* Boot-to-protection: first cue from an obstacle */
+
+          if (!cued && haptic_feedback_get_target() > 0)
+            {
+              maia_boot_mark(MAIA_BOOT_PROTECTED, 0);
+              cued = true;
+            }
+        }
+      else if (!silent)
+        {
+          ESP_LOGW(TAG, "No obstacle data for %d ms, silencing",
+                   HAPTIC_STALE_MS);
+          haptic_feedback_set_intensity(0);
+          silent = true;
+        }
     }
 }
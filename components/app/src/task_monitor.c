@@ -3,6 +3,11 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Monitor task: periodic report of the obstacle-to-vibration latency
+ * histograms, which also feed the latency page, followed by the health
+ * snapshot (heap, CPU and stack per task, error counters) and the
+ * service rates (status_monitor).
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,6 +15,58 @@
  ****************************************************************************/
 
 #include "app_tasks.h"
+#include "maia_board.h"
+#include "status_monitor.h"
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TASK_MONITOR]"
+
+#define MONITOR_PERIOD_MS       CONFIG_MAIA_TASK_MONITOR_PERIOD_MS
+
+_Static_assert(DISPLAY_LATENCY_STAGES == MAIA_LAT_STAGE_COUNT,
+               "latency page and histogram stages differ");
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: monitor_latency
+ *
+ * Description:
+ *   Dump the latency histograms and refresh the latency page.
+ *
+ ****************************************************************************/
+
+static void monitor_latency(void)
+{
+  display_latency_t page[DISPLAY_LATENCY_STAGES];
+
+  maia_latency_log();
+
+  for (int s = 0; s < MAIA_LAT_STAGE_COUNT; s++)
+    {
+      maia_lat_stats_t st;
+      uint32_t v[3];
+
+      maia_latency_get_stats(s, &st);
+      v[0] = st.p50_us / 100;
+      v[1] = st.p99_us / 100;
+      v[2] = st.max_us / 100;
+
+      page[s].p50 = v[0] > UINT16_MAX ? UINT16_MAX : v[0];
+      page[s].p99 = v[1] > UINT16_MAX ? UINT16_MAX : v[1];
+      page[s].max = v[2] > UINT16_MAX ? UINT16_MAX : v[2];
+    }
+
+  display_pages_set_latency(page);
+}
 
 /****************************************************************************
  * Public Functions
@@ -19,7 +76,7 @@
  * Name: task_monitor
  *
  * Description:
- *   FreeRTOS task function.
+ *   FreeRTOS task function. Sleeps between reports.
  *
  * Input Parameters:
  *   pvParameters - Task parameters (unused)
@@ -31,10 +88,15 @@
 
 void task_monitor(void *pvParameters)
 {
+  TickType_t wake = xTaskGetTickCount();
+
   (void)pvParameters;
 
   for (;;)
     {
-      /* TODO: Implement task_monitor */
+      vTaskDelayUntil(&wake, pdMS_TO_TICKS(MONITOR_PERIOD_MS));
+
+      monitor_latency();
+      status_monitor_report();
     }
 }
@@ -3,6 +3,13 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Sensing task: brings up obstacle detection and, after every tagged
+ * frame, publishes the fused obstacle state (TTC and nearest distance
+ * per sector, nearest distance per display column) as a lock-free
+ * snapshot, wakes the haptic task and updates the obstacle and depth
+ * pages. Each new frame and its head orientation also go to the session
+ * log.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,6 +17,212 @@
  ****************************************************************************/
 
 #include "app_tasks.h"
+#include "app_channel.h"
+#include "data_logger.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TASK_SENSING]"
+
+/* Display columns per sensor (DISPLAY_OBSTACLE_SECTORS over both) */
+
+#define SENSING_DISPLAY_COLS    (DISPLAY_OBSTACLE_SECTORS / \
+                                 VL53L5CX_SENSOR_COUNT)
+
+/* Depth map: brightest at 0 mm, blank from SENSING_DEPTH_RANGE_MM on
+ * (the range of the obstacle bars)
+ */
+
+#define SENSING_DEPTH_RANGE_MM  2000
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_task = NULL;
+
+/* Latest state: written by this task only, read by any */
+
+APP_SNAPSHOT_DEFINE(g_state, app_obstacle_state_t);
+
+/* Sensing task only */
+
+static app_obstacle_state_t g_work;
+static obstacle_frame_t g_frame;
+static uint32_t g_logged_seq[VL53L5CX_SENSOR_COUNT];
+static uint8_t g_logged;                /* Bit N: g_logged_seq[N] valid */
+static uint8_t g_depth[DISPLAY_DEPTH_ZONES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sensing_frame_cb
+ *
+ * Description:
+ *   Obstacle service callback (service task): wake the sensing task.
+ *
+ ****************************************************************************/
+
+static void sensing_frame_cb(const obstacle_frame_t *frame, void *arg)
+{
+  (void)frame;
+  (void)arg;
+  xTaskNotifyGive(g_task);
+}
+
+/****************************************************************************
+ * Name: sensing_log
+ *
+ * Description:
+ *   Log a frame not logged yet (never blocks; drops when the logger is
+ *   behind).
+ *
+ ****************************************************************************/
+
+static void sensing_log(const obstacle_frame_t *f)
+{
+  data_logger_imu_t imu;
+
+  if ((g_logged & (1u << f->sensor)) != 0 &&
+      g_logged_seq[f->sensor] == f->sequence)
+    {
+      return;
+    }
+
+  g_logged |= 1u << f->sensor;
+  g_logged_seq[f->sensor] = f->sequence;
+
+  data_logger_log_tof(f->sensor, f->nb_zones, f->distance_mm,
+                      f->target_status, f->int_time_us);
+
+  if (f->orientation_valid)
+    {
+      imu.pitch = f->orientation.pitch;
+      imu.roll = f->orientation.roll;
+      data_logger_write(DATA_LOGGER_REC_IMU, f->orientation.timestamp_us,
+                        &imu, sizeof(imu));
+    }
+}
+
+/****************************************************************************
+ * Name: sensing_depth
+ *
+ * Description:
+ *   Depth map levels of a frame for the depth page. A 4x4 frame is
+ *   upscaled, each zone covering 2x2 cells of the 8x8 map.
+ *
+ ****************************************************************************/
+
+static void sensing_depth(const obstacle_frame_t *f)
+{
+  int shift = f->nb_zones == VL53L5CX_RESOLUTION_8X8 ? 0 : 1;
+  int side = DISPLAY_DEPTH_SIDE >> shift;
+
+  for (int i = 0; i < DISPLAY_DEPTH_ZONES; i++)
+    {
+      int row = i / DISPLAY_DEPTH_SIDE;
+      int col = i % DISPLAY_DEPTH_SIDE;
+      int16_t mm = f->distance_mm[(row >> shift) * side + (col >> shift)];
+
+      if (mm == VL53L5CX_DISTANCE_INVALID || mm < 0 ||
+          mm >= SENSING_DEPTH_RANGE_MM)
+        {
+          g_depth[i] = 0;
+        }
+      else
+        {
+          g_depth[i] = DISPLAY_DEPTH_LEVELS -
+                       mm * DISPLAY_DEPTH_LEVELS / SENSING_DEPTH_RANGE_MM;
+        }
+    }
+
+  display_pages_set_depth((uint8_t)f->sensor, g_depth);
+}
+
+/****************************************************************************
+ * Name: sensing_columns
+ *
+ * Description:
+ *   Nearest distance per display column: each sensor covers half of the
+ *   columns, left to right, each column folding side / cols zone
+ *   columns over all rows.
+ *
+ ****************************************************************************/
+
+static void sensing_columns(app_obstacle_state_t *st)
+{
+  obstacle_frame_t *f = &g_frame;
+
+  for (int i = 0; i < DISPLAY_OBSTACLE_SECTORS; i++)
+    {
+      st->column_cm[i] = DISPLAY_DISTANCE_UNKNOWN;
+    }
+
+  for (int sensor = 0; sensor < VL53L5CX_SENSOR_COUNT; sensor++)
+    {
+      int side;
+
+      if (obstacle_detection_get_frame(sensor, f) != ESP_OK)
+        {
+          continue;
+        }
+
+      sensing_log(f);
+      sensing_depth(f);
+
+      side = f->nb_zones == VL53L5CX_RESOLUTION_8X8 ? 8 : 4;
+      st->time_us = f->int_time_us > st->time_us ?
+                    f->int_time_us : st->time_us;
+
+      for (int i = 0; i < f->nb_zones; i++)
+        {
+          int col = sensor * SENSING_DISPLAY_COLS +
+                    (i % side) * SENSING_DISPLAY_COLS / side;
+          int16_t mm = f->distance_mm[i];
+
+          if (mm != VL53L5CX_DISTANCE_INVALID &&
+              mm / 10 < st->column_cm[col])
+            {
+              st->column_cm[col] = mm / 10;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: sensing_publish
+ *
+ * Description:
+ *   Gather the obstacle state after a frame and publish it.
+ *
+ ****************************************************************************/
+
+static void sensing_publish(void)
+{
+  app_obstacle_state_t *st = &g_work;
+
+  if (obstacle_detection_get_ttc(&st->ttc) != ESP_OK)
+    {
+      return;
+    }
+
+  st->have_sectors = obstacle_detection_get_sectors(&st->sectors) == ESP_OK;
+  st->time_us = 0;
+  sensing_columns(st);
+
+  app_snapshot_write(&g_state, st);
+  task_haptic_wake();
+  display_pages_set_obstacles(st->column_cm);
+}
 
 /****************************************************************************
  * Public Functions
@@ -19,7 +232,8 @@
  * Name: task_sensing
  *
  * Description:
- *   FreeRTOS task function.
+ *   FreeRTOS task function. Starts obstacle detection and blocks on its
+ *   frame notifications.
  *
  * Input Parameters:
  *   pvParameters - Task parameters (unused)
@@ -31,10 +245,38 @@
 
 void task_sensing(void *pvParameters)
 {
+  int64_t start_us = esp_timer_get_time();
+  esp_err_t ret;
+
   (void)pvParameters;
 
+  g_task = xTaskGetCurrentTaskHandle();
+
+  ret = obstacle_detection_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Obstacle detection init failed (%s), task exiting",
+               esp_err_to_name(ret));
+      vTaskDelete(NULL);
+      return;
+    }
+
+  obstacle_detection_set_frame_callback(sensing_frame_cb, NULL);
+  maia_boot_mark(MAIA_BOOT_SENSING, start_us);
+  app_boot_ready(APP_BOOT_SENSING);
+
   for (;;)
     {
-      /* TODO: Implement task_sensing */
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      sensing_publish();
     }
 }
+
+/****************************************************************************
+ * Name: task_sensing_get_state
+ ****************************************************************************/
+
+uint32_t task_sensing_get_state(app_obstacle_state_t *state)
+{
+  return app_snapshot_read(&g_state, state);
+}
@@ -19,6 +19,12 @@
  *
  * Button driver with debounce, event detection, and callbacks
  *
+ * The GPIO ISR only queues timestamped edges. A driver task owns the
+ * whole state machine (debounce, click and long press deadlines) and
+ * delivers the events either to the callback, from that task, or to an
+ * event queue read with button_get_event(). Nothing runs in the esp_timer
+ * task.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_DRIVERS_BUTTON_INCLUDE_BUTTON_H
@@ -30,6 +36,7 @@
 
 #include <esp_err.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /****************************************************************************
  * Public Types
@@ -46,6 +53,17 @@ typedef enum
   BUTTON_EVENT_EXTRA_LONG_PRESS_2,    /* Held for extra duration 2 */
 } button_event_t;
 
+/* Event with its timing */
+
+typedef struct
+{
+  button_event_t event;
+  int64_t timestamp_us;               /* Edge (or threshold) time */
+  uint32_t held_ms;                   /* Press duration (RELEASED) */
+} button_event_info_t;
+
+/* Event callback, called from the button task */
+
 typedef void (*button_callback_t)(button_event_t event);
 
 /****************************************************************************
@@ -56,10 +74,12 @@ typedef void (*button_callback_t)(button_event_t event);
  * Name: button_init
  *
  * Description:
- *   Initialize the button driver with callback for events.
+ *   Initialize the button driver and start the button task.
  *
  * Input Parameters:
- *   callback - Function to call when button events occur
+ *   callback - Function to call when button events occur (button task
+ *              context), or NULL to queue the events for
+ *              button_get_event()
  *
  * Returned Value:
  *   ESP_OK on success; ESP_FAIL on failure
@@ -94,4 +114,22 @@ esp_err_t button_deinit(void);
 
 bool button_get_state(void);
 
+/****************************************************************************
+ * Name: button_get_event
+ *
+ * Description:
+ *   Wait for the next event (queue mode, button_init(NULL)).
+ *
+ * Input Parameters:
+ *   info       - Pointer to store the event
+ *   timeout_ms - Maximum wait (0 polls)
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_TIMEOUT if no event arrived;
+ *   ESP_ERR_INVALID_STATE if not initialized or in callback mode
+ *
+ ****************************************************************************/
+
+esp_err_t button_get_event(button_event_info_t *info, uint32_t timeout_ms);
+
 #endif /* __COMPONENTS_DRIVERS_BUTTON_INCLUDE_BUTTON_H */
\ No newline at end of file
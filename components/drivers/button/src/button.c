@@ -19,6 +19,11 @@
  *
  * Button driver implementation with state machine
  *
+ * Edges are queued by the ISR (timestamp only). The button task restarts
+ * the debounce window on every edge and samples the pin once it has been
+ * quiet for DEBOUNCE_TIME_MS; click and long press thresholds are
+ * deadlines of the same task, so the state machine has a single owner.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -30,6 +35,9 @@
 #include <driver/gpio.h>
 #include <esp_timer.h>
 #include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 #include <string.h>
 
 /****************************************************************************
@@ -46,6 +54,17 @@
 #define EXTRA_LONG_1_THRESHOLD_MS  CONFIG_MAIA_BUTTON_EXTRA_LONG_PRESS_1_MS
 #define EXTRA_LONG_2_THRESHOLD_MS  CONFIG_MAIA_BUTTON_EXTRA_LONG_PRESS_2_MS
 
+#define BUTTON_TASK_STACK_SIZE     3072
+#define BUTTON_TASK_PRIORITY       (tskIDLE_PRIORITY + 5)
+
+#define BUTTON_EDGE_QUEUE_LEN      16     /* Bounces included */
+#define BUTTON_EVENT_QUEUE_LEN     8
+
+#define BUTTON_EDGE_QUIT           (-1)   /* Edge time asking to exit */
+#define BUTTON_NO_DEADLINE         INT64_MAX
+
+#define BUTTON_LONG_STAGES         3
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -53,22 +72,30 @@
 typedef enum
 {
   BUTTON_STATE_IDLE = 0,
-  BUTTON_STATE_DEBOUNCING_PRESS,
   BUTTON_STATE_PRESSED,
-  BUTTON_STATE_DEBOUNCING_RELEASE,
   BUTTON_STATE_WAIT_DOUBLE_CLICK,
 } button_state_t;
 
 typedef struct
 {
+  /* Shared with the ISR: queues only */
+
+  QueueHandle_t edge_queue;
+  QueueHandle_t event_queue;          /* NULL in callback mode */
+
+  /* Owned by the button task */
+
   button_callback_t callback;
-  esp_timer_handle_t debounce_timer;
-  esp_timer_handle_t press_timer;
-  esp_timer_handle_t double_timer;
+  TaskHandle_t task;
+  TaskHandle_t waiter;                /* button_deinit() caller */
   button_state_t state;
-  int64_t press_time;
-  bool initialized;
+  bool debouncing;
+  int64_t edge_time;                  /* Last edge (us) */
+  int64_t press_time;                 /* Debounced press edge (us) */
+  int64_t double_deadline;            /* End of double click window */
+  uint8_t long_stage;                 /* Long press events sent */
   uint8_t click_count;
+  bool initialized;
 } button_context_t;
 
 /****************************************************************************
@@ -77,17 +104,36 @@ typedef struct
 
 static button_context_t g_button_ctx = {0};
 
+/* Queue storage */
+
+static uint8_t g_edge_storage[BUTTON_EDGE_QUEUE_LEN * sizeof(int64_t)];
+static StaticQueue_t g_edge_queue_buf;
+static uint8_t g_event_storage[BUTTON_EVENT_QUEUE_LEN *
+                               sizeof(button_event_info_t)];
+static StaticQueue_t g_event_queue_buf;
+
+/* Long press thresholds and events, in cascade order */
+
+static const uint32_t g_long_thresholds_ms[BUTTON_LONG_STAGES] =
+{
+  LONG_PRESS_THRESHOLD_MS,
+  EXTRA_LONG_1_THRESHOLD_MS,
+  EXTRA_LONG_2_THRESHOLD_MS,
+};
+
+static const button_event_t g_long_events[BUTTON_LONG_STAGES] =
+{
+  BUTTON_EVENT_LONG_PRESS,
+  BUTTON_EVENT_EXTRA_LONG_PRESS_1,
+  BUTTON_EVENT_EXTRA_LONG_PRESS_2,
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
 static void IRAM_ATTR button_isr_handler(void *arg);
-static void button_debounce_timer_callback(void *arg);
-static void button_press_timer_callback(void *arg);
-static void button_double_click_timer_callback(void *arg);
-static void button_process_press(void);
-static void button_process_release(void);
-static void button_notify_event(button_event_t event);
+static void button_task(void *arg);
 
 /****************************************************************************
  * Private Functions
@@ -97,15 +143,29 @@ static void button_notify_event(button_event_t event);
  * Name: button_notify_event
  *
  * Description:
- *   Notify registered callback of button event.
+ *   Deliver an event to the callback or the event queue.
  *
  ****************************************************************************/
 
-static void button_notify_event(button_event_t event)
+static void button_notify_event(button_event_t event, int64_t time_us,
+                                uint32_t held_ms)
 {
+  button_event_info_t info =
+  {
+    .event = event,
+    .timestamp_us = time_us,
+    .held_ms = held_ms,
+  };
+
   if (g_button_ctx.callback != NULL)
     {
       g_button_ctx.callback(event);
+      return;
+    }
+
+  if (xQueueSend(g_button_ctx.event_queue, &info, 0) != pdTRUE)
+    {
+      MAIA_DLOGW(TAG, "Event queue full, event %d dropped", event);
     }
 }
 
@@ -114,69 +174,24 @@ static void button_notify_event(button_event_t event)
  *
  * Description:
  *   GPIO interrupt handler for button press/release detection.
- *   Runs in ISR context - keep minimal!
+ *   Runs in ISR context - only queues the edge time.
  *
  ****************************************************************************/
 
 static void IRAM_ATTR button_isr_handler(void *arg)
 {
-  /* Start debounce timer on ANY edge (press or release) */
+  int64_t now = esp_timer_get_time();
+  BaseType_t woken = pdFALSE;
 
-  if (g_button_ctx.state == BUTTON_STATE_IDLE ||
-      g_button_ctx.state == BUTTON_STATE_PRESSED ||
-      g_button_ctx.state == BUTTON_STATE_WAIT_DOUBLE_CLICK)
-    {
-      esp_timer_start_once(g_button_ctx.debounce_timer,
-                           DEBOUNCE_TIME_MS * 1000);
-
-      /* Update state based on current GPIO level */
-
-      int level = gpio_get_level(MAIA_GPIO_BUTTON);
+  /* A full queue only loses bounces: the debounce window restarts from
+   * the queued edges and the pin is sampled once it is quiet
+   */
 
-      if (level == 0)  /* Active low - button pressed */
-        {
-          g_button_ctx.state = BUTTON_STATE_DEBOUNCING_PRESS;
-        }
-      else  /* Button released */
-        {
-          g_button_ctx.state = BUTTON_STATE_DEBOUNCING_RELEASE;
-        }
-    }
-}
+  xQueueSendFromISR(g_button_ctx.edge_queue, &now, &woken);
 
-/****************************************************************************
- * Name: button_debounce_timer_callback
- *
- * Description:
- *   Debounce timer callback. Validates GPIO state after debounce period.
- *
- ****************************************************************************/
-
-static void button_debounce_timer_callback(void *arg)
-{
-  int level = gpio_get_level(MAIA_GPIO_BUTTON);
-
-  if (g_button_ctx.state == BUTTON_STATE_DEBOUNCING_PRESS)
-    {
-      if (level == 0)  /* Still pressed - valid press */
-        {
-          button_process_press();
-        }
-      else  /* Was noise - ignore */
-        {
-          g_button_ctx.state = BUTTON_STATE_IDLE;
-        }
-    }
-  else if (g_button_ctx.state == BUTTON_STATE_DEBOUNCING_RELEASE)
+  if (woken == pdTRUE)
     {
-      if (level == 1)  /* Still released - valid release */
-        {
-          button_process_release();
-        }
-      else  /* Was noise - ignore */
-        {
-          g_button_ctx.state = BUTTON_STATE_PRESSED;
-        }
+      portYIELD_FROM_ISR();
     }
 }
 
@@ -188,18 +203,14 @@ static void button_debounce_timer_callback(void *arg)
  *
  ****************************************************************************/
 
-static void button_process_press(void)
+static void button_process_press(int64_t time_us)
 {
-  g_button_ctx.press_time = esp_timer_get_time() / 1000;  /* ms */
+  g_button_ctx.press_time = time_us;
+  g_button_ctx.long_stage = 0;
   g_button_ctx.state = BUTTON_STATE_PRESSED;
 
-  ESP_LOGI(TAG, "Button PRESSED");
-  button_notify_event(BUTTON_EVENT_PRESSED);
-
-  /* Start press timer for long press detection */
-
-  esp_timer_start_once(g_button_ctx.press_timer,
-                       LONG_PRESS_THRESHOLD_MS * 1000);
+  MAIA_DLOGI(TAG, "Button PRESSED");
+  button_notify_event(BUTTON_EVENT_PRESSED, time_us, 0);
 }
 
 /****************************************************************************
@@ -210,143 +221,219 @@ static void button_process_press(void)
  *
  ****************************************************************************/
 
-static void button_process_release(void)
+static void button_process_release(int64_t time_us)
 {
-  /* Stop all timers */
-
-  esp_timer_stop(g_button_ctx.press_timer);
-  esp_timer_stop(g_button_ctx.double_timer);
-
-  int64_t now = esp_timer_get_time() / 1000;
-  int64_t held_time = now - g_button_ctx.press_time;
+  uint32_t held_ms = (uint32_t)((time_us - g_button_ctx.press_time) / 1000);
 
-  ESP_LOGI(TAG, "Button RELEASED (held for %lld ms)", held_time);
-  button_notify_event(BUTTON_EVENT_RELEASED);
+  MAIA_DLOGI(TAG, "Button RELEASED (held for %lu ms)",
+             (unsigned long)held_ms);
+  button_notify_event(BUTTON_EVENT_RELEASED, time_us, held_ms);
 
-  /* Determine what type of press it was */
-
-  if (held_time >= EXTRA_LONG_2_THRESHOLD_MS)
+  if (g_button_ctx.long_stage > 0 || held_ms >= LONG_PRESS_THRESHOLD_MS)
     {
-      /* Already notified EXTRA_LONG_PRESS_2 */
+      /* Long press events already sent */
 
       g_button_ctx.click_count = 0;
       g_button_ctx.state = BUTTON_STATE_IDLE;
+      return;
     }
-  else if (held_time >= EXTRA_LONG_1_THRESHOLD_MS)
+
+  /* Short press - check for SINGLE/DOUBLE click */
+
+  g_button_ctx.click_count++;
+
+  if (g_button_ctx.click_count == 1)
     {
-      /* Already notified EXTRA_LONG_PRESS_1 */
+      /* Wait for possible second click */
 
-      g_button_ctx.click_count = 0;
-      g_button_ctx.state = BUTTON_STATE_IDLE;
+      g_button_ctx.state = BUTTON_STATE_WAIT_DOUBLE_CLICK;
+      g_button_ctx.double_deadline = time_us +
+                                     DOUBLE_CLICK_WINDOW_MS * 1000LL;
     }
-  else if (held_time >= LONG_PRESS_THRESHOLD_MS)
+  else
     {
-      /* Already notified LONG_PRESS */
+      /* Double click detected */
 
+      MAIA_DLOGI(TAG, "DOUBLE_CLICK");
+      button_notify_event(BUTTON_EVENT_DOUBLE_CLICK, time_us, 0);
       g_button_ctx.click_count = 0;
       g_button_ctx.state = BUTTON_STATE_IDLE;
     }
-  else
-    {
-      /* Short press - check for SINGLE/DOUBLE click */
+}
+
+/****************************************************************************
+ * Name: button_next_deadline
+ *
+ * Description:
+ *   Earliest pending deadline (us), BUTTON_NO_DEADLINE if none.
+ *
+ ****************************************************************************/
 
-      g_button_ctx.click_count++;
+static int64_t button_next_deadline(void)
+{
+  int64_t deadline = BUTTON_NO_DEADLINE;
+  int64_t t;
 
-      if (g_button_ctx.click_count == 1)
-        {
-          /* Wait for possible second click */
+  if (g_button_ctx.debouncing)
+    {
+      deadline = g_button_ctx.edge_time + DEBOUNCE_TIME_MS * 1000LL;
+    }
 
-          g_button_ctx.state = BUTTON_STATE_WAIT_DOUBLE_CLICK;
-          esp_timer_start_once(g_button_ctx.double_timer,
-                               DOUBLE_CLICK_WINDOW_MS * 1000);
-        }
-      else if (g_button_ctx.click_count == 2)
-        {
-          /* Double click detected */
+  if (g_button_ctx.state == BUTTON_STATE_PRESSED &&
+      g_button_ctx.long_stage < BUTTON_LONG_STAGES)
+    {
+      t = g_button_ctx.press_time +
+          g_long_thresholds_ms[g_button_ctx.long_stage] * 1000LL;
+      deadline = t < deadline ? t : deadline;
+    }
 
-          ESP_LOGI(TAG, "DOUBLE_CLICK");
-          button_notify_event(BUTTON_EVENT_DOUBLE_CLICK);
-          g_button_ctx.click_count = 0;
-          g_button_ctx.state = BUTTON_STATE_IDLE;
-        }
+  if (g_button_ctx.state == BUTTON_STATE_WAIT_DOUBLE_CLICK)
+    {
+      t = g_button_ctx.double_deadline;
+      deadline = t < deadline ? t : deadline;
     }
+
+  return deadline;
 }
 
 /****************************************************************************
- * Name: button_press_timer_callback
+ * Name: button_run_deadlines
  *
  * Description:
- *   Press timer callback. Detects long press events with cascading.
+ *   Handle every deadline that has expired at time now.
  *
  ****************************************************************************/
 
-static void button_press_timer_callback(void *arg)
+static void button_run_deadlines(int64_t now)
 {
-  if (g_button_ctx.state != BUTTON_STATE_PRESSED)
+  /* Debounce: the pin has been quiet long enough, sample it */
+
+  if (g_button_ctx.debouncing &&
+      now >= g_button_ctx.edge_time + DEBOUNCE_TIME_MS * 1000LL)
     {
-      return;
-    }
+      int level = gpio_get_level(MAIA_GPIO_BUTTON);
+
+      g_button_ctx.debouncing = false;
 
-  int64_t now = esp_timer_get_time() / 1000;
-  int64_t held_time = now - g_button_ctx.press_time;
+      if (level == 0 && g_button_ctx.state != BUTTON_STATE_PRESSED)
+        {
+          button_process_press(g_button_ctx.edge_time);
+        }
+      else if (level == 1 && g_button_ctx.state == BUTTON_STATE_PRESSED)
+        {
+          button_process_release(g_button_ctx.edge_time);
+        }
+    }
 
-  /* Cascading timer logic - check thresholds */
+  /* Cascading long press thresholds */
 
-  if (held_time >= EXTRA_LONG_2_THRESHOLD_MS)
+  while (g_button_ctx.state == BUTTON_STATE_PRESSED &&
+         g_button_ctx.long_stage < BUTTON_LONG_STAGES)
     {
-      /* Extra long press 2 reached - stop timer */
+      uint8_t stage = g_button_ctx.long_stage;
+      int64_t t = g_button_ctx.press_time +
+                  g_long_thresholds_ms[stage] * 1000LL;
+
+      if (now < t)
+        {
+          break;
+        }
 
-      ESP_LOGI(TAG, "EXTRA_LONG_PRESS_2 detected (held %lld ms)",
-               held_time);
-      button_notify_event(BUTTON_EVENT_EXTRA_LONG_PRESS_2);
-      esp_timer_stop(g_button_ctx.press_timer);
+      MAIA_DLOGI(TAG, "Long press stage %d detected (held %lu ms)",
+                 stage + 1, (unsigned long)g_long_thresholds_ms[stage]);
+      g_button_ctx.long_stage++;
+      button_notify_event(g_long_events[stage], t, 0);
     }
-  else if (held_time >= EXTRA_LONG_1_THRESHOLD_MS)
+
+  /* Double click window elapsed - was single click */
+
+  if (g_button_ctx.state == BUTTON_STATE_WAIT_DOUBLE_CLICK &&
+      now >= g_button_ctx.double_deadline)
     {
-      /* Extra long press 1 reached - schedule next check */
+      MAIA_DLOGI(TAG, "SINGLE_CLICK");
+      g_button_ctx.click_count = 0;
+      g_button_ctx.state = BUTTON_STATE_IDLE;
+      button_notify_event(BUTTON_EVENT_SINGLE_CLICK,
+                          g_button_ctx.double_deadline, 0);
+    }
+}
 
-      ESP_LOGI(TAG, "EXTRA_LONG_PRESS_1 detected (held %lld ms)",
-               held_time);
-      button_notify_event(BUTTON_EVENT_EXTRA_LONG_PRESS_1);
+/****************************************************************************
+ * Name: button_task
+ *
+ * Description:
+ *   Button task: waits for edges until the next deadline.
+ *
+ ****************************************************************************/
 
-      /* Reschedule for EXTRA_LONG_2 */
+static void button_task(void *arg)
+{
+  int64_t edge;
+  int64_t deadline;
+  int64_t now;
+  TickType_t wait;
 
-      int64_t next_delay = (EXTRA_LONG_2_THRESHOLD_MS - held_time) * 1000;
-      esp_timer_start_once(g_button_ctx.press_timer, next_delay);
-    }
-  else if (held_time >= LONG_PRESS_THRESHOLD_MS)
+  for (;;)
     {
-      /* Long press reached - schedule next check */
+      deadline = button_next_deadline();
+      now = esp_timer_get_time();
+
+      if (deadline == BUTTON_NO_DEADLINE)
+        {
+          wait = portMAX_DELAY;
+        }
+      else if (deadline <= now)
+        {
+          wait = 0;
+        }
+      else
+        {
+          /* Round up so the deadline has passed on wake up */
+
+          wait = pdMS_TO_TICKS((deadline - now + 999) / 1000) + 1;
+        }
 
-      ESP_LOGI(TAG, "LONG_PRESS detected (held %lld ms)", held_time);
-      button_notify_event(BUTTON_EVENT_LONG_PRESS);
+      if (xQueueReceive(g_button_ctx.edge_queue, &edge, wait) == pdTRUE)
+        {
+          if (edge == BUTTON_EDGE_QUIT)
+            {
+              break;
+            }
+
+          /* Any edge restarts the debounce window */
 
-      /* Reschedule for EXTRA_LONG_1 */
+          g_button_ctx.debouncing = true;
+          g_button_ctx.edge_time = edge;
+        }
 
-      int64_t next_delay = (EXTRA_LONG_1_THRESHOLD_MS - held_time) * 1000;
-      esp_timer_start_once(g_button_ctx.press_timer, next_delay);
+      button_run_deadlines(esp_timer_get_time());
     }
+
+  xTaskNotifyGive(g_button_ctx.waiter);
+  vTaskDelete(NULL);
 }
 
 /****************************************************************************
- * Name: button_double_click_timer_callback
+ * Name: button_free_queues
  *
  * Description:
- *   Double click timer callback. Fires if second click didn't arrive.
+ *   Delete the queues and clear the context.
  *
  ****************************************************************************/
 
-static void button_double_click_timer_callback(void *arg)
+static void button_free_queues(void)
 {
-  if (g_button_ctx.state == BUTTON_STATE_WAIT_DOUBLE_CLICK)
+  if (g_button_ctx.edge_queue != NULL)
     {
-      /* Timeout - was single click */
+      vQueueDelete(g_button_ctx.edge_queue);
+    }
 
-      ESP_LOGI(TAG, "SINGLE_CLICK");
-      button_notify_event(BUTTON_EVENT_SINGLE_CLICK);
-      g_button_ctx.click_count = 0;
-      g_button_ctx.state = BUTTON_STATE_IDLE;
+  if (g_button_ctx.event_queue != NULL)
+    {
+      vQueueDelete(g_button_ctx.event_queue);
     }
+
+  memset(&g_button_ctx, 0, sizeof(button_context_t));
 }
 
 /****************************************************************************
@@ -357,7 +444,7 @@ static void button_double_click_timer_callback(void *arg)
  * Name: button_init
  *
  * Description:
- *   Initialize button driver with callback.
+ *   Initialize button driver and start the button task.
  *
  ****************************************************************************/
 
@@ -371,13 +458,8 @@ esp_err_t button_init(button_callback_t callback)
       return ESP_ERR_INVALID_STATE;
     }
 
-  if (callback == NULL)
-    {
-      ESP_LOGE(TAG, "Callback cannot be NULL");
-      return ESP_ERR_INVALID_ARG;
-    }
-
-  ESP_LOGI(TAG, "Initializing button driver");
+  ESP_LOGI(TAG, "Initializing button driver (%s mode)",
+           callback != NULL ? "callback" : "queue");
 
   /* Initialize context */
 
@@ -385,49 +467,25 @@ esp_err_t button_init(button_callback_t callback)
   g_button_ctx.callback = callback;
   g_button_ctx.state = BUTTON_STATE_IDLE;
 
-  /* Create debounce timer */
-
-  esp_timer_create_args_t debounce_args = {
-    .callback = button_debounce_timer_callback,
-    .name = "button_debounce"
-  };
-
-  ret = esp_timer_create(&debounce_args, &g_button_ctx.debounce_timer);
-  if (ret != ESP_OK)
-    {
-      ESP_LOGE(TAG, "Failed to create debounce timer");
-      return ret;
-    }
-
-  /* Create press timer (for long press detection) */
-
-  esp_timer_create_args_t press_args = {
-    .callback = button_press_timer_callback,
-    .name = "button_press"
-  };
+  g_button_ctx.edge_queue = xQueueCreateStatic(BUTTON_EDGE_QUEUE_LEN,
+                                               sizeof(int64_t),
+                                               g_edge_storage,
+                                               &g_edge_queue_buf);
 
-  ret = esp_timer_create(&press_args, &g_button_ctx.press_timer);
-  if (ret != ESP_OK)
+  if (callback == NULL)
     {
-      ESP_LOGE(TAG, "Failed to create press timer");
-      esp_timer_delete(g_button_ctx.debounce_timer);
-      return ret;
+      g_button_ctx.event_queue =
+        xQueueCreateStatic(BUTTON_EVENT_QUEUE_LEN,
+                           sizeof(button_event_info_t), g_event_storage,
+                           &g_event_queue_buf);
     }
 
-  /* Create double click timer */
-
-  esp_timer_create_args_t double_args = {
-    .callback = button_double_click_timer_callback,
-    .name = "button_double"
-  };
-
-  ret = esp_timer_create(&double_args, &g_button_ctx.double_timer);
-  if (ret != ESP_OK)
+  if (xTaskCreate(button_task, "button", BUTTON_TASK_STACK_SIZE, NULL,
+                  BUTTON_TASK_PRIORITY, &g_button_ctx.task) != pdPASS)
     {
-      ESP_LOGE(TAG, "Failed to create double click timer");
-      esp_timer_delete(g_button_ctx.debounce_timer);
-      esp_timer_delete(g_button_ctx.press_timer);
-      return ret;
+      ESP_LOGE(TAG, "Failed to create button task");
+      button_free_queues();
+      return ESP_ERR_NO_MEM;
     }
 
   /* Add GPIO ISR handler */
@@ -436,9 +494,8 @@ esp_err_t button_init(button_callback_t callback)
   if (ret != ESP_OK)
     {
       ESP_LOGE(TAG, "Failed to add GPIO ISR handler");
-      esp_timer_delete(g_button_ctx.debounce_timer);
-      esp_timer_delete(g_button_ctx.press_timer);
-      esp_timer_delete(g_button_ctx.double_timer);
+      vTaskDelete(g_button_ctx.task);
+      button_free_queues();
       return ret;
     }
 
@@ -449,9 +506,8 @@ esp_err_t button_init(button_callback_t callback)
     {
       ESP_LOGE(TAG, "Failed to set interrupt type");
       gpio_isr_handler_remove(MAIA_GPIO_BUTTON);
-      esp_timer_delete(g_button_ctx.debounce_timer);
-      esp_timer_delete(g_button_ctx.press_timer);
-      esp_timer_delete(g_button_ctx.double_timer);
+      vTaskDelete(g_button_ctx.task);
+      button_free_queues();
       return ret;
     }
 
@@ -472,6 +528,8 @@ esp_err_t button_init(button_callback_t callback)
 
 esp_err_t button_deinit(void)
 {
+  const int64_t quit = BUTTON_EDGE_QUIT;
+
   if (!g_button_ctx.initialized)
     {
       return ESP_ERR_INVALID_STATE;
@@ -482,29 +540,15 @@ esp_err_t button_deinit(void)
   gpio_set_intr_type(MAIA_GPIO_BUTTON, GPIO_INTR_DISABLE);
   gpio_isr_handler_remove(MAIA_GPIO_BUTTON);
 
-  /* Delete timers */
-
-  if (g_button_ctx.debounce_timer != NULL)
-    {
-      esp_timer_stop(g_button_ctx.debounce_timer);
-      esp_timer_delete(g_button_ctx.debounce_timer);
-    }
+  /* Stop the button task */
 
-  if (g_button_ctx.press_timer != NULL)
-    {
-      esp_timer_stop(g_button_ctx.press_timer);
-      esp_timer_delete(g_button_ctx.press_timer);
-    }
-
-  if (g_button_ctx.double_timer != NULL)
-    {
-      esp_timer_stop(g_button_ctx.double_timer);
-      esp_timer_delete(g_button_ctx.double_timer);
-    }
+  g_button_ctx.waiter = xTaskGetCurrentTaskHandle();
+  xQueueSend(g_button_ctx.edge_queue, &quit, portMAX_DELAY);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-  /* Clear context */
+  /* Delete queues and clear context */
 
-  memset(&g_button_ctx, 0, sizeof(button_context_t));
+  button_free_queues();
 
   ESP_LOGI(TAG, "Button driver deinitialized");
 
@@ -522,4 +566,33 @@ esp_err_t button_deinit(void)
 bool button_get_state(void)
 {
   return (gpio_get_level(MAIA_GPIO_BUTTON) == 0);  /* Active low */
-}
\ No newline at end of file
+}
+
+/****************************************************************************
+ * Name: button_get_event
+ *
+ * Description:
+ *   Wait for the next queued event.
+ *
+ ****************************************************************************/
+
+esp_err_t button_get_event(button_event_info_t *info, uint32_t timeout_ms)
+{
+  if (info == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (!g_button_ctx.initialized || g_button_ctx.event_queue == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (xQueueReceive(g_button_ctx.event_queue, info,
+                    pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+    {
+      return ESP_ERR_TIMEOUT;
+    }
+
+  return ESP_OK;
+}
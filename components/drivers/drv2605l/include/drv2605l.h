@@ -133,6 +133,10 @@
 #define DRV2605L_FEEDBACK_ERM     0x00  /* ERM mode (bit 7 = 0) */
 #define DRV2605L_FEEDBACK_LRA     0x80  /* LRA mode (bit 7 = 1) */
 
+/* Control 3 register bits */
+
+#define DRV2605L_CONTROL3_RTP_UNSIGNED 0x08 /* DATA_FORMAT_RTP: unsigned */
+
 /* Effect IDs (Library Waveforms)
  * Datasheet Section 11.2, Page 72-75
  * Each library has 123 effects indexed from 1 to 123
@@ -197,6 +201,19 @@ typedef enum
   DRV2605L_LIB_LRA   = DRV2605L_LIBRARY_LRA,
 } drv2605l_library_t;
 
+/* Auto-calibration results: AUTOCALCOMP, AUTOCALEMP and FEEDBACK
+ * (0x18..0x1A, consecutive)
+ * Datasheet Section 8.5.18-19, Page 65-66
+ */
+
+typedef struct
+{
+  uint8_t compensation;           /* A_CAL_COMP */
+  uint8_t back_emf;               /* A_CAL_BEMF */
+  uint8_t feedback;               /* N_ERM_LRA, brake, loop gain,
+                                   * BEMF_GAIN */
+} drv2605l_calibration_t;
+
 /* Device configuration structure */
 
 typedef struct
@@ -207,6 +224,7 @@ typedef struct
   uint8_t rated_voltage;          /* Rated voltage register value */
   uint8_t overdrive_clamp;        /* Overdrive clamp voltage */
   bool auto_calibrate;            /* Run auto-calibration on init */
+  const drv2605l_calibration_t *calibration; /* Restore, or NULL */
 } drv2605l_config_t;
 
 /****************************************************************************
@@ -223,7 +241,8 @@ extern "C"
  *
  * Description:
  *   Initialize DRV2605L haptic driver with given configuration.
- *   Performs auto-calibration if enabled in config.
+ *   Restores config->calibration if given and plausible for the
+ *   actuator; otherwise performs auto-calibration if enabled in config.
  *
  * Input Parameters:
  *   config - Device configuration structure
@@ -238,6 +257,41 @@ extern "C"
 
 esp_err_t drv2605l_init(const drv2605l_config_t *config);
 
+/****************************************************************************
+ * Name: drv2605l_calibrate
+ *
+ * Description:
+ *   Run auto-calibration now (the motor buzzes for up to ~1.2 s) and
+ *   return to internal trigger mode. Blocks the caller.
+ *
+ * Input Parameters:
+ *   cal - Results (output, may be NULL)
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_FAIL if the device reports a failed
+ *   calibration; error code otherwise
+ *
+ * Reference:
+ *   Datasheet Section 9.2 (Auto-Calibration), Page 78
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_calibrate(drv2605l_calibration_t *cal);
+
+/****************************************************************************
+ * Name: drv2605l_get_calibration
+ *
+ * Description:
+ *   Read the calibration registers currently in use (from the register
+ *   shadow when known).
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_get_calibration(drv2605l_calibration_t *cal);
+
 /****************************************************************************
  * Name: drv2605l_play_effect
  *
@@ -263,7 +317,9 @@ esp_err_t drv2605l_play_effect(uint8_t effect_id);
  *
  * Description:
  *   Play a sequence of up to 8 haptic effects.
- *   Effects play sequentially with automatic timing.
+ *   Effects play sequentially with automatic timing. The sequencer slots
+ *   and GO are written as one burst; slots already holding the right
+ *   effect (per the driver register shadow) are not rewritten.
  *
  * Input Parameters:
  *   effects     - Array of effect IDs (1-123)
@@ -280,6 +336,42 @@ esp_err_t drv2605l_play_effect(uint8_t effect_id);
 esp_err_t drv2605l_play_sequence(const uint8_t *effects,
                                   uint8_t num_effects);
 
+/****************************************************************************
+ * Name: drv2605l_load_sequence
+ *
+ * Description:
+ *   Load a sequence of up to 8 effects into the waveform sequencer
+ *   without starting playback. A loaded sequence can be replayed with
+ *   drv2605l_go() as often as needed.
+ *
+ * Input Parameters:
+ *   effects     - Array of effect IDs (1-123)
+ *   num_effects - Number of effects in sequence (1-8)
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ * Reference:
+ *   Datasheet Section 8.5.5-8.5.8 (Waveform Sequencer), Page 53-57
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_load_sequence(const uint8_t *effects,
+                                 uint8_t num_effects);
+
+/****************************************************************************
+ * Name: drv2605l_go
+ *
+ * Description:
+ *   Start playback of the sequence loaded in the waveform sequencer.
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_go(void);
+
 /****************************************************************************
  * Name: drv2605l_stop
  *
@@ -335,7 +427,8 @@ esp_err_t drv2605l_set_library(drv2605l_library_t library);
  * Name: drv2605l_standby
  *
  * Description:
- *   Put device into low-power standby mode.
+ *   Put device into low-power standby mode. The selected mode is kept
+ *   and restored by drv2605l_wakeup().
  *
  * Returned Value:
  *   ESP_OK on success; error code otherwise
@@ -351,7 +444,8 @@ esp_err_t drv2605l_standby(void);
  * Name: drv2605l_wakeup
  *
  * Description:
- *   Wake device from standby mode to active state.
+ *   Wake device from standby mode to active state (mode selected
+ *   before drv2605l_standby()).
  *
  * Returned Value:
  *   ESP_OK on success; error code otherwise
@@ -379,6 +473,27 @@ esp_err_t drv2605l_wakeup(void);
 
 esp_err_t drv2605l_get_status(uint8_t *status);
 
+/****************************************************************************
+ * Name: drv2605l_set_rtp_value
+ *
+ * Description:
+ *   Set real-time playback (RTP) amplitude. The driver configures the
+ *   RTP input as unsigned, so 0 is off and 255 full scale. Writing the
+ *   value already set does not touch the bus.
+ *
+ * Input Parameters:
+ *   value - Amplitude (0-255)
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ * Notes:
+ *   Device must be in RTP mode: drv2605l_set_mode(DRV2605L_OP_MODE_REALTIME)
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_set_rtp_value(uint8_t value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,11 @@
 
 #define DRV2605L_AUTOCAL_TIMEOUT_MS 2000
 
+/* RATEDV, CLAMPV and the calibration registers, consecutive */
+
+#define DRV2605L_VOLTAGE_REGS         2
+#define DRV2605L_CAL_REGS             3
+
 /* Status register bits (Section 8.5.1, Page 37) */
 
 #define DRV2605L_STATUS_DEVICE_ID     0xE0  /* Device ID mask */
@@ -57,51 +62,248 @@
 #define DRV2605L_STATUS_OVER_TEMP     0x02  /* Over-temperature bit */
 #define DRV2605L_STATUS_OC_DETECT     0x01  /* Over-current bit */
 
+/* Register shadow covers 0x00..LRARESON */
+
+#define DRV2605L_REG_COUNT            (DRV2605L_REG_LRARESON + 1)
+
+/* Waveform sequencer slots (WAVESEQ1..8, GO follows at 0x0C) */
+
+#define DRV2605L_WAVESEQ_SLOTS        8
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
 static bool g_initialized = false;
 static drv2605l_config_t g_config;
-static i2c_master_dev_handle_t g_dev_handle = NULL;
+static maia_i2c_dev_handle_t g_dev_handle = NULL;
+
+/* RAM copy of the writable registers. A bit set in g_shadow_valid means
+ * the shadow value is known to match the device: reads are served from
+ * it and writes of the same value are skipped.
+ */
+
+static uint8_t g_shadow[DRV2605L_REG_COUNT];
+static uint64_t g_shadow_valid = 0;
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: drv2605l_reg_cacheable
+ *
+ * Description:
+ *   True for registers whose value only changes when the host writes it.
+ *   STATUS, VBAT and LRARESON are device-updated, GO self-clears.
+ *
+ ****************************************************************************/
+
+static bool drv2605l_reg_cacheable(uint8_t reg)
+{
+  return reg < DRV2605L_REG_COUNT &&
+         reg != DRV2605L_REG_STATUS &&
+         reg != DRV2605L_REG_GO &&
+         reg != DRV2605L_REG_VBAT &&
+         reg != DRV2605L_REG_LRARESON;
+}
+
+/****************************************************************************
+ * Name: drv2605l_shadow_is
+ *
+ * Description:
+ *   True if the shadow of reg is valid and equal to value.
+ *
+ ****************************************************************************/
+
+static bool drv2605l_shadow_is(uint8_t reg, uint8_t value)
+{
+  return drv2605l_reg_cacheable(reg) &&
+         (g_shadow_valid & (1ull << reg)) != 0 &&
+         g_shadow[reg] == value;
+}
+
+/****************************************************************************
+ * Name: drv2605l_shadow_update
+ *
+ * Description:
+ *   Record (valid = true) or forget (valid = false) the device value of
+ *   len registers starting at reg.
+ *
+ ****************************************************************************/
+
+static void drv2605l_shadow_update(uint8_t reg, const uint8_t *values,
+                                   size_t len, bool valid)
+{
+  for (size_t i = 0; i < len; i++, reg++)
+    {
+      if (!drv2605l_reg_cacheable(reg))
+        {
+          continue;
+        }
+
+      if (valid)
+        {
+          g_shadow[reg] = values[i];
+          g_shadow_valid |= 1ull << reg;
+        }
+      else
+        {
+          g_shadow_valid &= ~(1ull << reg);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: drv2605l_i2c_write_regs
+ *
+ * Description:
+ *   Burst write consecutive registers (the device auto-increments the
+ *   register address) in one transaction (haptic arbiter lane). Leading
+ *   and trailing registers that already hold the value are trimmed; if
+ *   nothing changes the bus is not touched.
+ *
+ ****************************************************************************/
+
+static esp_err_t drv2605l_i2c_write_regs(uint8_t reg, const uint8_t *values,
+                                         size_t len)
+{
+  esp_err_t ret;
+
+  while (len > 0 && drv2605l_shadow_is(reg, values[0]))
+    {
+      reg++;
+      values++;
+      len--;
+    }
+
+  while (len > 0 && drv2605l_shadow_is(reg + len - 1, values[len - 1]))
+    {
+      len--;
+    }
+
+  if (len == 0)
+    {
+      return ESP_OK;
+    }
+
+  ret = maia_i2c_transmit_prefixed(g_dev_handle, &reg, 1, values, len,
+                                   DRV2605L_I2C_TIMEOUT_MS);
+
+  /* On error the device state is unknown: drop the shadow entries */
+
+  drv2605l_shadow_update(reg, values, len, ret == ESP_OK);
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: drv2605l_i2c_write_reg
  *
  * Description:
- *   Write single byte to DRV2605L register using new I2C driver.
+ *   Write single byte to DRV2605L register (skipped if unchanged).
  *
  ****************************************************************************/
 
 static esp_err_t drv2605l_i2c_write_reg(uint8_t reg, uint8_t value)
 {
-  uint8_t write_buf[2] = {reg, value};
-  
-  return i2c_master_transmit(g_dev_handle, write_buf, 2,
-                              DRV2605L_I2C_TIMEOUT_MS);
+  return drv2605l_i2c_write_regs(reg, &value, 1);
 }
 
 /****************************************************************************
  * Name: drv2605l_i2c_read_reg
  *
  * Description:
- *   Read single byte from DRV2605L register using new I2C driver.
+ *   Read single byte from DRV2605L register. Cacheable registers with a
+ *   valid shadow are served from RAM without a bus round trip.
  *
  ****************************************************************************/
 
 static esp_err_t drv2605l_i2c_read_reg(uint8_t reg, uint8_t *value)
 {
+  esp_err_t ret;
+
   if (value == NULL)
     {
       return ESP_ERR_INVALID_ARG;
     }
 
-  return i2c_master_transmit_receive(g_dev_handle, &reg, 1, value, 1,
-                                      DRV2605L_I2C_TIMEOUT_MS);
+  if (drv2605l_reg_cacheable(reg) && (g_shadow_valid & (1ull << reg)))
+    {
+      *value = g_shadow[reg];
+      return ESP_OK;
+    }
+
+  ret = maia_i2c_transmit_receive(g_dev_handle, &reg, 1, value, 1,
+                                  DRV2605L_I2C_TIMEOUT_MS);
+  if (ret == ESP_OK)
+    {
+      drv2605l_shadow_update(reg, value, 1, true);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: drv2605l_sequence_burst
+ *
+ * Description:
+ *   Build the WAVESEQ1..8 image for a sequence (end marker after the
+ *   last effect, remaining slots keep their shadow value so they trim
+ *   away) and validate it. Optionally appends GO at index 8, since GO
+ *   (0x0C) directly follows WAVESEQ8 (0x0B).
+ *
+ * Input Parameters:
+ *   burst - Output, DRV2605L_WAVESEQ_SLOTS + 1 bytes
+ *
+ * Returned Value:
+ *   Number of bytes to burst from WAVESEQ1; 0 on invalid sequence.
+ *
+ ****************************************************************************/
+
+static size_t drv2605l_sequence_burst(const uint8_t *effects,
+                                      uint8_t num_effects, bool go,
+                                      uint8_t *burst)
+{
+  uint8_t i;
+
+  for (i = 0; i < num_effects; i++)
+    {
+      if (effects[i] < DRV2605L_EFFECT_MIN ||
+          effects[i] > DRV2605L_EFFECT_MAX)
+        {
+          MAIA_DLOGE(TAG, "Invalid effect ID in sequence: %d", effects[i]);
+          return 0;
+        }
+
+      burst[i] = effects[i];
+    }
+
+  if (i < DRV2605L_WAVESEQ_SLOTS)
+    {
+      burst[i++] = DRV2605L_EFFECT_STOP;
+    }
+
+  if (!go)
+    {
+      return i;
+    }
+
+  /* Bridge to GO: slots after the end marker are never played, resend
+   * their known value (or stop if unknown)
+   */
+
+  for (; i < DRV2605L_WAVESEQ_SLOTS; i++)
+    {
+      uint8_t reg = DRV2605L_REG_WAVESEQ1 + i;
+
+      burst[i] = (g_shadow_valid & (1ull << reg)) ? g_shadow[reg] :
+                                                    DRV2605L_EFFECT_STOP;
+    }
+
+  burst[i++] = DRV2605L_GO_BIT;
+
+  return i;
 }
 
 /****************************************************************************
@@ -133,6 +335,47 @@ static drv2605l_library_t drv2605l_get_library_from_config(void)
 #endif
 }
 
+/****************************************************************************
+ * Name: drv2605l_calibration_valid
+ *
+ * Description:
+ *   Plausibility check of stored calibration results: taken with the
+ *   configured actuator type, and a back-EMF reading that is neither
+ *   empty nor saturated.
+ *
+ ****************************************************************************/
+
+static bool drv2605l_calibration_valid(const drv2605l_calibration_t *cal)
+{
+  uint8_t type = (g_config.actuator == DRV2605L_ACTUATOR_LRA) ?
+                 DRV2605L_FEEDBACK_LRA : DRV2605L_FEEDBACK_ERM;
+
+  return (cal->feedback & DRV2605L_FEEDBACK_LRA) == type &&
+         cal->back_emf != 0x00 && cal->back_emf != 0xff;
+}
+
+/****************************************************************************
+ * Name: drv2605l_read_calibration
+ ****************************************************************************/
+
+static esp_err_t drv2605l_read_calibration(drv2605l_calibration_t *cal)
+{
+  esp_err_t ret;
+
+  ret = drv2605l_i2c_read_reg(DRV2605L_REG_AUTOCALCOMP, &cal->compensation);
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_i2c_read_reg(DRV2605L_REG_AUTOCALEMP, &cal->back_emf);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_i2c_read_reg(DRV2605L_REG_FEEDBACK, &cal->feedback);
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: drv2605l_run_autocalibration
  *
@@ -142,7 +385,7 @@ static drv2605l_library_t drv2605l_get_library_from_config(void)
  *
  ****************************************************************************/
 
-static esp_err_t drv2605l_run_autocalibration(void)
+static esp_err_t drv2605l_run_autocalibration(drv2605l_calibration_t *cal)
 {
   esp_err_t ret;
   uint8_t status;
@@ -169,6 +412,13 @@ static esp_err_t drv2605l_run_autocalibration(void)
       return ret;
     }
 
+  /* Calibration rewrites the compensation, back-EMF and feedback
+   * registers: re-read them from the device from now on
+   */
+
+  drv2605l_shadow_update(DRV2605L_REG_AUTOCALCOMP, NULL, DRV2605L_CAL_REGS,
+                         false);
+
   /* Wait for calibration to complete (GO bit clears when done) */
 
   timeout_start = xTaskGetTickCount();
@@ -213,15 +463,17 @@ static esp_err_t drv2605l_run_autocalibration(void)
 
   /* Read calibration results */
 
-  uint8_t comp_result;
-  uint8_t bemf_result;
-
-  drv2605l_i2c_read_reg(DRV2605L_REG_AUTOCALCOMP, &comp_result);
-  drv2605l_i2c_read_reg(DRV2605L_REG_AUTOCALEMP, &bemf_result);
+  ret = drv2605l_read_calibration(cal);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to read calibration results");
+      return ret;
+    }
 
   ESP_LOGI(TAG, "Auto-calibration successful:");
-  ESP_LOGI(TAG, "  Compensation: 0x%02X", comp_result);
-  ESP_LOGI(TAG, "  Back-EMF:     0x%02X", bemf_result);
+  ESP_LOGI(TAG, "  Compensation: 0x%02X", cal->compensation);
+  ESP_LOGI(TAG, "  Back-EMF:     0x%02X", cal->back_emf);
+  ESP_LOGI(TAG, "  Feedback:     0x%02X", cal->feedback);
 
   /* Return to standby mode */
 
@@ -251,6 +503,8 @@ static esp_err_t drv2605l_run_autocalibration(void)
 
 esp_err_t drv2605l_init(const drv2605l_config_t *config)
 {
+  drv2605l_calibration_t cal;
+  bool restore = false;
   esp_err_t ret;
   uint8_t status;
 
@@ -266,31 +520,25 @@ esp_err_t drv2605l_init(const drv2605l_config_t *config)
       return ESP_OK;
     }
 
-  /* Store configuration */
+  /* Store configuration; nothing is known about the registers yet */
 
   memcpy(&g_config, config, sizeof(drv2605l_config_t));
+  g_config.calibration = NULL;
+  g_shadow_valid = 0;
 
   ESP_LOGI(TAG, "Initializing DRV2605L (I2C addr: 0x%02X)",
            g_config.i2c_addr);
 
-  /* Get I2C bus handle from maia_board */
+  /* Register device with the I2C arbiter */
 
-  i2c_master_bus_handle_t bus_handle = maia_i2c_get_bus_handle();
-  if (bus_handle == NULL)
-    {
-      ESP_LOGE(TAG, "I2C bus not initialized");
-      return ESP_ERR_INVALID_STATE;
-    }
-
-  /* Register device on I2C bus */
-
-  i2c_device_config_t dev_cfg = {
-      .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-      .device_address = g_config.i2c_addr,
-      .scl_speed_hz = CONFIG_MAIA_I2C_FREQ_HZ,
+  maia_i2c_dev_config_t dev_cfg = {
+      .name = "drv2605l",
+      .addr = g_config.i2c_addr,
+      .bus = MAIA_I2C_BUS_DRV2605L,
+      .prio = MAIA_I2C_PRIO_HAPTIC,
   };
 
-  ret = i2c_master_bus_add_device(bus_handle, &dev_cfg, &g_dev_handle);
+  ret = maia_i2c_add_device(&dev_cfg, &g_dev_handle);
   if (ret != ESP_OK)
     {
       ESP_LOGE(TAG, "Failed to add device to I2C bus: %s",
@@ -348,34 +596,74 @@ esp_err_t drv2605l_init(const drv2605l_config_t *config)
            (g_config.actuator == DRV2605L_ACTUATOR_ERM) ? "ERM" : "LRA",
            g_config.library);
 
-  /* Set rated voltage and overdrive clamp
-   * Datasheet Section 8.5.16-17, Page 64-65
+  /* Set rated voltage and overdrive clamp, followed by the stored
+   * calibration results when restoring them (RATEDV..FEEDBACK are
+   * consecutive: one burst)
+   * Datasheet Section 8.5.16-19, Page 64-66
    */
 
-  ret = drv2605l_i2c_write_reg(DRV2605L_REG_RATEDV,
-                                g_config.rated_voltage);
-  if (ret != ESP_OK)
+  if (config->calibration != NULL)
     {
-      ESP_LOGE(TAG, "Failed to set rated voltage");
-      return ret;
+      restore = drv2605l_calibration_valid(config->calibration);
+      if (!restore)
+        {
+          ESP_LOGW(TAG, "Stored calibration rejected (comp 0x%02X, "
+                   "bemf 0x%02X, feedback 0x%02X)",
+                   config->calibration->compensation,
+                   config->calibration->back_emf,
+                   config->calibration->feedback);
+        }
     }
 
-  ret = drv2605l_i2c_write_reg(DRV2605L_REG_CLAMPV,
-                                g_config.overdrive_clamp);
+  uint8_t voltages[DRV2605L_VOLTAGE_REGS + DRV2605L_CAL_REGS] =
+    {
+      g_config.rated_voltage,
+      g_config.overdrive_clamp,
+      restore ? config->calibration->compensation : 0,
+      restore ? config->calibration->back_emf : 0,
+      restore ? config->calibration->feedback : 0,
+    };
+
+  ret = drv2605l_i2c_write_regs(DRV2605L_REG_RATEDV, voltages,
+                                restore ? sizeof(voltages) :
+                                          DRV2605L_VOLTAGE_REGS);
   if (ret != ESP_OK)
     {
-      ESP_LOGE(TAG, "Failed to set overdrive clamp");
+      ESP_LOGE(TAG, "Failed to set rated voltage / overdrive clamp");
       return ret;
     }
 
   ESP_LOGI(TAG, "Rated voltage: %d, Overdrive clamp: %d",
            g_config.rated_voltage, g_config.overdrive_clamp);
 
-  /* Run auto-calibration if enabled */
+  /* RTP input as unsigned amplitude (0 = off, 255 = full scale) */
+
+  uint8_t control3;
+
+  ret = drv2605l_i2c_read_reg(DRV2605L_REG_CONTROL3, &control3);
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_i2c_write_reg(DRV2605L_REG_CONTROL3,
+                                   control3 | DRV2605L_CONTROL3_RTP_UNSIGNED);
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to set RTP data format");
+      return ret;
+    }
+
+  /* Run auto-calibration if enabled and nothing was restored */
 
-  if (g_config.auto_calibrate)
+  if (restore)
     {
-      ret = drv2605l_run_autocalibration();
+      ESP_LOGI(TAG, "Calibration restored (comp 0x%02X, bemf 0x%02X)",
+               config->calibration->compensation,
+               config->calibration->back_emf);
+    }
+  else if (g_config.auto_calibrate)
+    {
+      ret = drv2605l_run_autocalibration(&cal);
       if (ret != ESP_OK)
         {
           ESP_LOGE(TAG, "Auto-calibration failed");
@@ -399,6 +687,54 @@ esp_err_t drv2605l_init(const drv2605l_config_t *config)
   return ESP_OK;
 }
 
+/****************************************************************************
+ * Name: drv2605l_calibrate
+ ****************************************************************************/
+
+esp_err_t drv2605l_calibrate(drv2605l_calibration_t *cal)
+{
+  drv2605l_calibration_t result;
+  esp_err_t ret;
+
+  if (!g_initialized)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  ret = drv2605l_run_autocalibration(&result);
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_i2c_write_reg(DRV2605L_REG_MODE,
+                                   DRV2605L_MODE_INTTRIG);
+    }
+
+  if (ret == ESP_OK && cal != NULL)
+    {
+      *cal = result;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: drv2605l_get_calibration
+ ****************************************************************************/
+
+esp_err_t drv2605l_get_calibration(drv2605l_calibration_t *cal)
+{
+  if (cal == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (!g_initialized)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  return drv2605l_read_calibration(cal);
+}
+
 /****************************************************************************
  * Name: drv2605l_play_effect
  *
@@ -410,49 +746,96 @@ esp_err_t drv2605l_init(const drv2605l_config_t *config)
 
 esp_err_t drv2605l_play_effect(uint8_t effect_id)
 {
-  esp_err_t ret;
-
   if (!g_initialized)
     {
-      ESP_LOGE(TAG, "Driver not initialized");
+      MAIA_DLOGE(TAG, "Driver not initialized");
       return ESP_ERR_INVALID_STATE;
     }
 
   if (effect_id < DRV2605L_EFFECT_MIN || effect_id > DRV2605L_EFFECT_MAX)
     {
-      ESP_LOGE(TAG, "Invalid effect ID: %d (valid range: 1-123)",
-               effect_id);
+      MAIA_DLOGE(TAG, "Invalid effect ID: %d (valid range: 1-123)",
+                 effect_id);
       return ESP_ERR_INVALID_ARG;
     }
 
-  /* Load effect into sequencer register 1 */
+  return drv2605l_play_sequence(&effect_id, 1);
+}
 
-  ret = drv2605l_i2c_write_reg(DRV2605L_REG_WAVESEQ1, effect_id);
-  if (ret != ESP_OK)
+/****************************************************************************
+ * Name: drv2605l_load_sequence
+ *
+ * Description:
+ *   Load up to 8 effects into the waveform sequencer without playing.
+ *   Datasheet Section 8.5.5-8.5.8 (Waveform Sequencer), Page 53-57
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_load_sequence(const uint8_t *effects,
+                                 uint8_t num_effects)
+{
+  uint8_t burst[DRV2605L_WAVESEQ_SLOTS + 1];
+  size_t len;
+  esp_err_t ret;
+
+  if (!g_initialized)
     {
-      ESP_LOGE(TAG, "Failed to write effect to sequencer");
-      return ret;
+      MAIA_DLOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (effects == NULL || num_effects == 0 ||
+      num_effects > DRV2605L_WAVESEQ_SLOTS)
+    {
+      MAIA_DLOGE(TAG, "Invalid sequence (must be 1-8 effects)");
+      return ESP_ERR_INVALID_ARG;
     }
 
-  /* Set end-of-sequence marker in register 2 */
+  /* One burst from WAVESEQ1 through the end marker; slots that already
+   * hold the right effect are trimmed by the shadow
+   */
+
+  len = drv2605l_sequence_burst(effects, num_effects, false, burst);
+  if (len == 0)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
 
-  ret = drv2605l_i2c_write_reg(DRV2605L_REG_WAVESEQ2,
-                                DRV2605L_EFFECT_STOP);
+  ret = drv2605l_i2c_write_regs(DRV2605L_REG_WAVESEQ1, burst, len);
   if (ret != ESP_OK)
     {
-      return ret;
+      MAIA_DLOGE(TAG, "Failed to load sequencer");
     }
 
-  /* Trigger playback by setting GO bit */
+  return ret;
+}
+
+/****************************************************************************
+ * Name: drv2605l_go
+ *
+ * Description:
+ *   Start playback of the sequence currently loaded in the sequencer.
+ *   GO register (0x0C), bit 0
+ *
+ ****************************************************************************/
+
+esp_err_t drv2605l_go(void)
+{
+  esp_err_t ret;
+
+  if (!g_initialized)
+    {
+      MAIA_DLOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
 
   ret = drv2605l_i2c_write_reg(DRV2605L_REG_GO, DRV2605L_GO_BIT);
   if (ret != ESP_OK)
     {
-      ESP_LOGE(TAG, "Failed to trigger effect playback");
-      return ret;
+      MAIA_DLOGE(TAG, "Failed to trigger sequence playback");
     }
 
-  return ESP_OK;
+  return ret;
 }
 
 /****************************************************************************
@@ -467,62 +850,38 @@ esp_err_t drv2605l_play_effect(uint8_t effect_id)
 esp_err_t drv2605l_play_sequence(const uint8_t *effects,
                                   uint8_t num_effects)
 {
+  uint8_t burst[DRV2605L_WAVESEQ_SLOTS + 1];
+  size_t len;
   esp_err_t ret;
 
   if (!g_initialized)
     {
-      ESP_LOGE(TAG, "Driver not initialized");
+      MAIA_DLOGE(TAG, "Driver not initialized");
       return ESP_ERR_INVALID_STATE;
     }
 
-  if (effects == NULL || num_effects == 0 || num_effects > 8)
+  if (effects == NULL || num_effects == 0 ||
+      num_effects > DRV2605L_WAVESEQ_SLOTS)
     {
-      ESP_LOGE(TAG, "Invalid sequence (must be 1-8 effects)");
+      MAIA_DLOGE(TAG, "Invalid sequence (must be 1-8 effects)");
       return ESP_ERR_INVALID_ARG;
     }
 
-  /* Load effects into sequencer registers */
+  /* Sequence and GO in a single burst (WAVESEQ1..8 then GO at 0x0C) */
 
-  for (uint8_t i = 0; i < num_effects; i++)
+  len = drv2605l_sequence_burst(effects, num_effects, true, burst);
+  if (len == 0)
     {
-      if (effects[i] < DRV2605L_EFFECT_MIN ||
-          effects[i] > DRV2605L_EFFECT_MAX)
-        {
-          ESP_LOGE(TAG, "Invalid effect ID in sequence: %d", effects[i]);
-          return ESP_ERR_INVALID_ARG;
-        }
-
-      ret = drv2605l_i2c_write_reg(DRV2605L_REG_WAVESEQ1 + i,
-                                    effects[i]);
-      if (ret != ESP_OK)
-        {
-          ESP_LOGE(TAG, "Failed to write effect %d to sequencer", i);
-          return ret;
-        }
-    }
-
-  /* Set end-of-sequence marker */
-
-  if (num_effects < 8)
-    {
-      ret = drv2605l_i2c_write_reg(DRV2605L_REG_WAVESEQ1 + num_effects,
-                                    DRV2605L_EFFECT_STOP);
-      if (ret != ESP_OK)
-        {
-          return ret;
-        }
+      return ESP_ERR_INVALID_ARG;
     }
 
-  /* Trigger playback */
-
-  ret = drv2605l_i2c_write_reg(DRV2605L_REG_GO, DRV2605L_GO_BIT);
+  ret = drv2605l_i2c_write_regs(DRV2605L_REG_WAVESEQ1, burst, len);
   if (ret != ESP_OK)
     {
-      ESP_LOGE(TAG, "Failed to trigger sequence playback");
-      return ret;
+      MAIA_DLOGE(TAG, "Failed to load and trigger sequence");
     }
 
-  return ESP_OK;
+  return ret;
 }
 
 /****************************************************************************
@@ -596,14 +955,25 @@ esp_err_t drv2605l_set_library(drv2605l_library_t library)
 
 esp_err_t drv2605l_standby(void)
 {
+  esp_err_t ret;
+  uint8_t mode;
+
   if (!g_initialized)
     {
       ESP_LOGE(TAG, "Driver not initialized");
       return ESP_ERR_INVALID_STATE;
     }
 
+  /* Set the STANDBY bit, keeping the mode bits (served from shadow) */
+
+  ret = drv2605l_i2c_read_reg(DRV2605L_REG_MODE, &mode);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
   return drv2605l_i2c_write_reg(DRV2605L_REG_MODE,
-                                 DRV2605L_MODE_STANDBY);
+                                 mode | DRV2605L_MODE_STANDBY);
 }
 
 /****************************************************************************
@@ -616,14 +986,25 @@ esp_err_t drv2605l_standby(void)
 
 esp_err_t drv2605l_wakeup(void)
 {
+  esp_err_t ret;
+  uint8_t mode;
+
   if (!g_initialized)
     {
       ESP_LOGE(TAG, "Driver not initialized");
       return ESP_ERR_INVALID_STATE;
     }
 
+  /* Clear the STANDBY bit, keeping the mode bits (served from shadow) */
+
+  ret = drv2605l_i2c_read_reg(DRV2605L_REG_MODE, &mode);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
   return drv2605l_i2c_write_reg(DRV2605L_REG_MODE,
-                                 DRV2605L_MODE_INTTRIG);
+                                 mode & ~DRV2605L_MODE_STANDBY);
 }
 
 /****************************************************************************
@@ -660,7 +1041,8 @@ esp_err_t drv2605l_get_status(uint8_t *status)
  *   Datasheet Section 8.5.3 (Real-Time Playback), Page 50
  *
  * Input Parameters:
- *   value - Intensity (0-255, where 0=off, 255=max)
+ *   value - Intensity (0-255, where 0=off, 255=max; unsigned RTP format
+ *           is selected at init)
  *
  * Notes:
  *   Device must be in RTP mode (Mode 5) before calling this.
@@ -44,10 +44,24 @@
 
 #define DS18B20_ROM_SIZE 8
 
+/* DS18B20 family code (ROM byte 0) */
+
+#define DS18B20_FAMILY_CODE 0x28
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* Conversion resolution (bits) */
+
+typedef enum
+{
+  DS18B20_RESOLUTION_9BIT  = 9,     /* 0.5°,     94ms */
+  DS18B20_RESOLUTION_10BIT = 10,    /* 0.25°,   188ms */
+  DS18B20_RESOLUTION_11BIT = 11,    /* 0.125°,  375ms */
+  DS18B20_RESOLUTION_12BIT = 12,    /* 0.0625°, 750ms */
+} ds18b20_resolution_t;
+
 /* DS18B20 ROM address structure */
 
 typedef struct
@@ -55,6 +69,15 @@ typedef struct
   uint8_t rom[DS18B20_ROM_SIZE];
 } ds18b20_rom_t;
 
+/* Conversion-done callback.
+ * Called from the esp_timer task when the conversion time has elapsed.
+ * Do not read the sensor here: signal the owning task instead (task
+ * notification or xEventGroupSetBits()) and call ds18b20_read_result()
+ * from there.
+ */
+
+typedef void (*ds18b20_convert_cb_t)(void *arg);
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -136,6 +159,181 @@ esp_err_t ds18b20_read_temperature(float *temp,
 
 esp_err_t ds18b20_trigger_conversion(const ds18b20_rom_t *rom);
 
+/****************************************************************************
+ * Name: ds18b20_convert_async
+ *
+ * Description:
+ *   Start a conversion without blocking: triggers it and arms a one-shot
+ *   esp_timer for the conversion time of the configured resolution.
+ *   When it expires the callback is called; the result is then read with
+ *   ds18b20_read_result().
+ *
+ * Input Parameters:
+ *   rom      - ROM address (NULL for Skip ROM mode)
+ *   callback - Conversion-done callback (may be NULL, then poll
+ *              ds18b20_is_converting())
+ *   arg      - Callback argument
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized or a
+ *   conversion is already running; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_convert_async(const ds18b20_rom_t *rom,
+                                ds18b20_convert_cb_t callback, void *arg);
+
+/****************************************************************************
+ * Name: ds18b20_convert_all_async
+ *
+ * Description:
+ *   Start a conversion on every sensor at once (Skip ROM + CONVERT_T) and
+ *   arm the conversion timer, so N sensors take one conversion period.
+ *   Read each result with ds18b20_read_result() and the cached ROMs
+ *   (ds18b20_get_rom()).
+ *
+ * Input Parameters:
+ *   callback - Conversion-done callback (may be NULL)
+ *   arg      - Callback argument
+ *
+ * Returned Value:
+ *   Same as ds18b20_convert_async()
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_convert_all_async(ds18b20_convert_cb_t callback,
+                                    void *arg);
+
+/****************************************************************************
+ * Name: ds18b20_read_all
+ *
+ * Description:
+ *   Read every sensor (blocking): one parallel conversion, one conversion
+ *   period, then one scratchpad read per cached ROM. In Skip ROM mode the
+ *   single sensor is read.
+ *
+ * Input Parameters:
+ *   temps     - Output array, in ds18b20_get_rom() order. Sensors that
+ *               could not be read are set to NAN.
+ *   max_temps - Capacity of the array
+ *   num_read  - Pointer to store the number of entries written
+ *
+ * Returned Value:
+ *   ESP_OK if every sensor was read; the last error otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_read_all(float *temps, uint8_t max_temps,
+                           uint8_t *num_read);
+
+/****************************************************************************
+ * Name: ds18b20_is_converting
+ *
+ * Description:
+ *   Check whether an asynchronous conversion is still running.
+ *
+ * Returned Value:
+ *   true until the conversion time has elapsed
+ *
+ ****************************************************************************/
+
+bool ds18b20_is_converting(void);
+
+/****************************************************************************
+ * Name: ds18b20_get_crc_errors
+ *
+ * Description:
+ *   Read the CRC failure counter: scratchpad reads and ROM search steps
+ *   that returned ESP_ERR_INVALID_CRC since boot. Never blocks.
+ *
+ ****************************************************************************/
+
+uint32_t ds18b20_get_crc_errors(void);
+
+/****************************************************************************
+ * Name: ds18b20_read_result
+ *
+ * Description:
+ *   Read the result of the last conversion (scratchpad read with CRC
+ *   check, converted to the Kconfig unit).
+ *
+ * Input Parameters:
+ *   temp - Pointer to store temperature reading
+ *   rom  - ROM address (NULL for Skip ROM mode)
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE while an asynchronous
+ *   conversion is still running; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_read_result(float *temp, const ds18b20_rom_t *rom);
+
+/****************************************************************************
+ * Name: ds18b20_set_resolution
+ *
+ * Description:
+ *   Change the conversion resolution of every sensor at runtime. Only the
+ *   scratchpad (RAM) is written, the EEPROM keeps the Kconfig value, so
+ *   switching often does not wear it.
+ *
+ * Input Parameters:
+ *   resolution - New resolution
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized or a
+ *   conversion is running; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_set_resolution(ds18b20_resolution_t resolution);
+
+/****************************************************************************
+ * Name: ds18b20_get_resolution
+ *
+ * Description:
+ *   Current conversion resolution.
+ *
+ ****************************************************************************/
+
+ds18b20_resolution_t ds18b20_get_resolution(void);
+
+/****************************************************************************
+ * Name: ds18b20_get_conversion_time_ms
+ *
+ * Description:
+ *   Conversion time of the current resolution.
+ *
+ ****************************************************************************/
+
+uint16_t ds18b20_get_conversion_time_ms(void);
+
+/****************************************************************************
+ * Name: ds18b20_adaptive_update
+ *
+ * Description:
+ *   Sampling scheduler. Feed it every reading (in the Kconfig unit); it
+ *   picks the resolution and the delay before the next reading:
+ *     - Near CONFIG_MAIA_DS18B20_ADAPTIVE_ALARM_C: 12 bits, fast interval
+ *     - Changing fast: 9 bits, fast interval
+ *     - Stable: 12 bits, slow interval
+ *   The rate of change is averaged over steps larger than one LSB of
+ *   the current resolution, so quantization dither does not count as a
+ *   change. The resolution is switched with ds18b20_set_resolution()
+ *   only when it changes.
+ *
+ * Input Parameters:
+ *   temp             - Latest reading
+ *   next_interval_ms - Pointer to store the delay before the next reading
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code if the resolution switch failed (the
+ *   interval is still valid)
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_adaptive_update(float temp, uint32_t *next_interval_ms);
+
 /****************************************************************************
  * Name: ds18b20_read_scratchpad
  *
@@ -168,20 +366,51 @@ esp_err_t ds18b20_read_scratchpad(uint8_t *data,
  * Name: ds18b20_search_roms
  *
  * Description:
- *   Search all DS18B20 devices on OneWire bus.
- *   Only useful in Match ROM mode with multiple sensors.
+ *   Search all DS18B20 devices on OneWire bus (Maxim search algorithm)
+ *   and refresh the ROM cache. Devices of other families are skipped.
+ *   In Match ROM mode this already runs once at init.
  *
  * Input Parameters:
- *   roms      - Array to store found ROM addresses
+ *   roms      - Array to store found ROM addresses (may be NULL to only
+ *               refresh the cache)
  *   max_roms  - Maximum number of ROMs array can hold
  *   num_found - Pointer to store number of devices found
  *
  * Returned Value:
- *   ESP_OK on success; ESP_FAIL on failure
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if no device answered;
+ *   ESP_ERR_INVALID_CRC on a corrupted search; ESP_ERR_INVALID_STATE if
+ *   not initialized
  *
  ****************************************************************************/
 
 esp_err_t ds18b20_search_roms(ds18b20_rom_t *roms, uint8_t max_roms,
                                uint8_t *num_found);
 
+/****************************************************************************
+ * Name: ds18b20_get_rom_count
+ *
+ * Description:
+ *   Number of ROMs in the cache (last search).
+ *
+ ****************************************************************************/
+
+uint8_t ds18b20_get_rom_count(void);
+
+/****************************************************************************
+ * Name: ds18b20_get_rom
+ *
+ * Description:
+ *   Copy a cached ROM address.
+ *
+ * Input Parameters:
+ *   index - Cache index (0 to ds18b20_get_rom_count() - 1)
+ *   rom   - Pointer to store the ROM address
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_get_rom(uint8_t index, ds18b20_rom_t *rom);
+
 #endif /* __COMPONENTS_DRIVERS_DS18B20_INCLUDE_DS18B20_H */
\ No newline at end of file
@@ -28,9 +28,12 @@
 #include "ds18b20.h"
 #include "maia_board.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <string.h>
+#include <math.h>
+#include <stdatomic.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -69,6 +72,19 @@
 #define DS18B20_CONV_TIME_11BIT     375
 #define DS18B20_CONV_TIME_12BIT     750
 
+/* select_device() target addressing every device (Skip ROM) */
+
+#define DS18B20_ALL                 (&g_rom_all)
+
+/* Adaptive scheduler: a step of one LSB or less is quantization, not a
+ * change; with no larger step for this long the window closes as a
+ * zero-rate sample. Rate samples are averaged by an EMA (1/2 weight).
+ */
+
+#define DS18B20_RATE_WINDOW_US      \
+  (2 * CONFIG_MAIA_DS18B20_ADAPTIVE_SLOW_MS * 1000LL)
+#define DS18B20_RATE_EMA_ALPHA      0.5f
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -78,6 +94,39 @@ static uint8_t g_resolution_config;
 static uint16_t g_conversion_time_ms;
 static bool g_initialized = false;
 
+/* Asynchronous conversion: one-shot timer armed for the conversion time
+ * (g_conv_lock protects the pending flag and the callback)
+ */
+
+static esp_timer_handle_t g_conv_timer = NULL;
+static portMUX_TYPE g_conv_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool g_converting = false;
+static ds18b20_convert_cb_t g_conv_cb = NULL;
+static void *g_conv_arg = NULL;
+
+/* ROM cache (last search) */
+
+static ds18b20_rom_t g_roms[CONFIG_MAIA_DS18B20_MAX_DEVICES];
+static uint8_t g_num_roms = 0;
+static const ds18b20_rom_t g_rom_all;    /* DS18B20_ALL marker */
+
+/* Adaptive scheduler state: baseline reading (Celsius) the next step is
+ * measured from, its resolution, and the averaged rate (°C/s)
+ */
+
+static bool g_adaptive_valid = false;
+static float g_adaptive_last_c;
+static int64_t g_adaptive_last_us;
+static ds18b20_resolution_t g_adaptive_res;
+static float g_adaptive_rate = 0.0f;
+static bool g_adaptive_fast = false;
+
+/* Health counter (ROM search and scratchpad CRC failures). Lock-free:
+ * read by the monitor while the sensing task counts.
+ */
+
+static atomic_uint g_crc_errors = 0;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -124,6 +173,56 @@ static uint16_t ds18b20_get_conversion_time(void)
 #endif
 }
 
+/****************************************************************************
+ * Name: ds18b20_resolution_to_config
+ *
+ * Description:
+ *   Configuration byte and conversion time of a resolution.
+ *
+ ****************************************************************************/
+
+static uint8_t ds18b20_resolution_to_config(ds18b20_resolution_t res,
+                                            uint16_t *conv_time_ms)
+{
+  switch (res)
+    {
+      case DS18B20_RESOLUTION_9BIT:
+        *conv_time_ms = DS18B20_CONV_TIME_9BIT;
+        return DS18B20_RES_9BIT;
+
+      case DS18B20_RESOLUTION_10BIT:
+        *conv_time_ms = DS18B20_CONV_TIME_10BIT;
+        return DS18B20_RES_10BIT;
+
+      case DS18B20_RESOLUTION_11BIT:
+        *conv_time_ms = DS18B20_CONV_TIME_11BIT;
+        return DS18B20_RES_11BIT;
+
+      default:
+        *conv_time_ms = DS18B20_CONV_TIME_12BIT;
+        return DS18B20_RES_12BIT;
+    }
+}
+
+/****************************************************************************
+ * Name: ds18b20_to_celsius
+ *
+ * Description:
+ *   Convert a reading in the configured unit back to Celsius.
+ *
+ ****************************************************************************/
+
+static float ds18b20_to_celsius(float temp)
+{
+#if defined(CONFIG_MAIA_DS18B20_UNIT_FAHRENHEIT)
+  return (temp - 32.0f) * 5.0f / 9.0f;
+#elif defined(CONFIG_MAIA_DS18B20_UNIT_KELVIN)
+  return temp - 273.15f;
+#else
+  return temp;
+#endif
+}
+
 /****************************************************************************
  * Name: ds18b20_convert_temperature
  *
@@ -155,6 +254,14 @@ static float ds18b20_convert_temperature(int16_t raw)
 
 static esp_err_t ds18b20_select_device(const ds18b20_rom_t *rom)
 {
+  if (rom == DS18B20_ALL)
+    {
+      /* Broadcast: every device executes the next command */
+
+      maia_onewire_write_byte(g_onewire_pin, DS18B20_CMD_SKIP_ROM);
+      return ESP_OK;
+    }
+
 #ifdef CONFIG_MAIA_DS18B20_ROM_SKIP
   /* Skip ROM: single device on bus */
 
@@ -170,13 +277,266 @@ static esp_err_t ds18b20_select_device(const ds18b20_rom_t *rom)
       return ESP_ERR_INVALID_ARG;
     }
 
-  maia_onewire_write_byte(g_onewire_pin, DS18B20_CMD_MATCH_ROM);
-  for (uint8_t i = 0; i < DS18B20_ROM_SIZE; i++)
+  uint8_t cmd[1 + DS18B20_ROM_SIZE];
+
+  cmd[0] = DS18B20_CMD_MATCH_ROM;
+  memcpy(&cmd[1], rom->rom, DS18B20_ROM_SIZE);
+
+  maia_onewire_write_block(g_onewire_pin, cmd, sizeof(cmd));
+  return ESP_OK;
+#endif
+}
+
+/****************************************************************************
+ * Name: ds18b20_write_config
+ *
+ * Description:
+ *   Write TH/TL/configuration to the scratchpad of every sensor.
+ *
+ ****************************************************************************/
+
+static esp_err_t ds18b20_write_config(uint8_t config)
+{
+  esp_err_t ret;
+
+  if (!maia_onewire_reset(g_onewire_pin))
     {
-      maia_onewire_write_byte(g_onewire_pin, rom->rom[i]);
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  ret = ds18b20_select_device(DS18B20_ALL);
+  if (ret != ESP_OK)
+    {
+      return ret;
     }
+
+  const uint8_t write_cmd[] =
+  {
+    DS18B20_CMD_WRITE_SCRATCH,
+    0x00,                           /* TH alarm (unused) */
+    0x00,                           /* TL alarm (unused) */
+    config,
+  };
+
+  maia_onewire_write_block(g_onewire_pin, write_cmd, sizeof(write_cmd));
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: ds18b20_search_next
+ *
+ * Description:
+ *   One pass of the Maxim search algorithm (AN187). rom holds the previous
+ *   result on entry and the next device on return; *last_discrepancy is
+ *   0 before the first pass and 0 again after the last device.
+ *
+ * Returned Value:
+ *   ESP_OK with the next ROM; ESP_ERR_NOT_FOUND if no device answered;
+ *   ESP_ERR_INVALID_CRC on a bad ROM.
+ *
+ ****************************************************************************/
+
+static esp_err_t ds18b20_search_next(uint8_t *rom, int *last_discrepancy)
+{
+  int last_zero = 0;
+
+  if (!maia_onewire_reset(g_onewire_pin))
+    {
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  maia_onewire_write_byte(g_onewire_pin, DS18B20_CMD_SEARCH_ROM);
+
+  for (int bit = 1; bit <= DS18B20_ROM_SIZE * 8; bit++)
+    {
+      uint8_t mask = 1u << ((bit - 1) & 7);
+      uint8_t *byte = &rom[(bit - 1) >> 3];
+      uint8_t id_bit = maia_onewire_read_bit(g_onewire_pin);
+      uint8_t cmp_bit = maia_onewire_read_bit(g_onewire_pin);
+      uint8_t direction;
+
+      if (id_bit && cmp_bit)
+        {
+          return ESP_ERR_NOT_FOUND;
+        }
+
+      if (id_bit != cmp_bit)
+        {
+          /* All remaining devices agree on this bit */
+
+          direction = id_bit;
+        }
+      else
+        {
+          /* Discrepancy: repeat the previous choice before the last
+           * discrepancy, take 1 at it and 0 after it
+           */
+
+          if (bit < *last_discrepancy)
+            {
+              direction = (*byte & mask) != 0;
+            }
+          else
+            {
+              direction = bit == *last_discrepancy;
+            }
+
+          if (direction == 0)
+            {
+              last_zero = bit;
+            }
+        }
+
+      if (direction)
+        {
+          *byte |= mask;
+        }
+      else
+        {
+          *byte &= ~mask;
+        }
+
+      maia_onewire_write_bit(g_onewire_pin, direction);
+    }
+
+  *last_discrepancy = last_zero;
+
+  if (maia_onewire_crc8(rom, DS18B20_ROM_SIZE - 1) !=
+      rom[DS18B20_ROM_SIZE - 1])
+    {
+      atomic_fetch_add_explicit(&g_crc_errors, 1, memory_order_relaxed);
+      return ESP_ERR_INVALID_CRC;
+    }
+
   return ESP_OK;
-#endif
+}
+
+/****************************************************************************
+ * Name: ds18b20_search_bus
+ *
+ * Description:
+ *   Enumerate the bus into the ROM cache.
+ *
+ ****************************************************************************/
+
+static esp_err_t ds18b20_search_bus(void)
+{
+  uint8_t rom[DS18B20_ROM_SIZE] = {0};
+  int last_discrepancy = 0;
+  esp_err_t ret;
+
+  g_num_roms = 0;
+
+  do
+    {
+      ret = ds18b20_search_next(rom, &last_discrepancy);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+
+      if (rom[0] != DS18B20_FAMILY_CODE)
+        {
+          ESP_LOGW(TAG, "Skipping device of family 0x%02X", rom[0]);
+          continue;
+        }
+
+      if (g_num_roms == CONFIG_MAIA_DS18B20_MAX_DEVICES)
+        {
+          ESP_LOGW(TAG, "More than %d devices, ignoring the others",
+                   CONFIG_MAIA_DS18B20_MAX_DEVICES);
+          break;
+        }
+
+      memcpy(g_roms[g_num_roms].rom, rom, DS18B20_ROM_SIZE);
+      g_num_roms++;
+
+      ESP_LOGI(TAG, "Found %02X%02X%02X%02X%02X%02X%02X%02X",
+               rom[0], rom[1], rom[2], rom[3],
+               rom[4], rom[5], rom[6], rom[7]);
+    }
+  while (last_discrepancy != 0);
+
+  return g_num_roms > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/****************************************************************************
+ * Name: ds18b20_start_conversion
+ *
+ * Description:
+ *   Trigger a conversion (one device or DS18B20_ALL) and arm the
+ *   conversion timer.
+ *
+ ****************************************************************************/
+
+static esp_err_t ds18b20_start_conversion(const ds18b20_rom_t *rom,
+                                          ds18b20_convert_cb_t callback,
+                                          void *arg)
+{
+  esp_err_t ret;
+
+  if (!g_initialized)
+    {
+      ESP_LOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  portENTER_CRITICAL(&g_conv_lock);
+  if (g_converting)
+    {
+      portEXIT_CRITICAL(&g_conv_lock);
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  g_converting = true;
+  g_conv_cb = callback;
+  g_conv_arg = arg;
+  portEXIT_CRITICAL(&g_conv_lock);
+
+  ret = ds18b20_trigger_conversion(rom);
+  if (ret == ESP_OK)
+    {
+      ret = esp_timer_start_once(g_conv_timer,
+                                 (uint64_t)g_conversion_time_ms * 1000);
+    }
+
+  if (ret != ESP_OK)
+    {
+      portENTER_CRITICAL(&g_conv_lock);
+      g_converting = false;
+      portEXIT_CRITICAL(&g_conv_lock);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ds18b20_conv_timer_cb
+ *
+ * Description:
+ *   Conversion time elapsed (esp_timer task): the result is ready in the
+ *   scratchpad.
+ *
+ ****************************************************************************/
+
+static void ds18b20_conv_timer_cb(void *arg)
+{
+  ds18b20_convert_cb_t cb;
+  void *cb_arg;
+
+  (void)arg;
+
+  portENTER_CRITICAL(&g_conv_lock);
+  g_converting = false;
+  cb = g_conv_cb;
+  cb_arg = g_conv_arg;
+  portEXIT_CRITICAL(&g_conv_lock);
+
+  if (cb != NULL)
+    {
+      cb(cb_arg);
+    }
 }
 
 /****************************************************************************
@@ -205,6 +565,23 @@ esp_err_t ds18b20_init(void)
   g_resolution_config = ds18b20_get_resolution_config();
   g_conversion_time_ms = ds18b20_get_conversion_time();
 
+  if (g_conv_timer == NULL)
+    {
+      const esp_timer_create_args_t timer_args =
+        {
+          .callback        = ds18b20_conv_timer_cb,
+          .dispatch_method = ESP_TIMER_TASK,
+          .name            = "ds18b20_conv",
+        };
+
+      ret = esp_timer_create(&timer_args, &g_conv_timer);
+      if (ret != ESP_OK)
+        {
+          ESP_LOGE(TAG, "Failed to create conversion timer");
+          return ret;
+        }
+    }
+
   ESP_LOGI(TAG, "Initializing DS18B20 (GPIO%d, resolution=%d-bit)",
            g_onewire_pin, 9 + ((g_resolution_config >> 5) & 0x03));
 
@@ -218,22 +595,12 @@ esp_err_t ds18b20_init(void)
 
   /* Write scratchpad to set resolution */
 
-  if (!maia_onewire_reset(g_onewire_pin))
-    {
-      return ESP_FAIL;
-    }
-
-  ret = ds18b20_select_device(NULL);
+  ret = ds18b20_write_config(g_resolution_config);
   if (ret != ESP_OK)
     {
       return ret;
     }
 
-  maia_onewire_write_byte(g_onewire_pin, DS18B20_CMD_WRITE_SCRATCH);
-  maia_onewire_write_byte(g_onewire_pin, 0x00);  /* TH alarm (unused) */
-  maia_onewire_write_byte(g_onewire_pin, 0x00);  /* TL alarm (unused) */
-  maia_onewire_write_byte(g_onewire_pin, g_resolution_config);
-
   /* Copy scratchpad to EEPROM */
 
   if (!maia_onewire_reset(g_onewire_pin))
@@ -241,7 +608,7 @@ esp_err_t ds18b20_init(void)
       return ESP_FAIL;
     }
 
-  ret = ds18b20_select_device(NULL);
+  ret = ds18b20_select_device(DS18B20_ALL);
   if (ret != ESP_OK)
     {
       return ret;
@@ -250,6 +617,17 @@ esp_err_t ds18b20_init(void)
   maia_onewire_write_byte(g_onewire_pin, DS18B20_CMD_COPY_SCRATCH);
   vTaskDelay(pdMS_TO_TICKS(10));  /* EEPROM write time */
 
+#ifdef CONFIG_MAIA_DS18B20_ROM_MATCH
+  /* Enumerate the sensors once; callers address them from the cache */
+
+  ret = ds18b20_search_bus();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "ROM search failed: %s", esp_err_to_name(ret));
+      return ret;
+    }
+#endif
+
   g_initialized = true;
   ESP_LOGI(TAG, "DS18B20 initialized successfully");
 
@@ -266,7 +644,20 @@ esp_err_t ds18b20_init(void)
 
 esp_err_t ds18b20_deinit(void)
 {
+  if (g_conv_timer != NULL)
+    {
+      esp_timer_stop(g_conv_timer);
+    }
+
+  portENTER_CRITICAL(&g_conv_lock);
+  g_converting = false;
+  portEXIT_CRITICAL(&g_conv_lock);
+
   g_initialized = false;
+  g_num_roms = 0;
+  g_adaptive_valid = false;
+  g_adaptive_rate = 0.0f;
+  g_adaptive_fast = false;
   ESP_LOGI(TAG, "DS18B20 deinitialized");
   return ESP_OK;
 }
@@ -344,10 +735,7 @@ esp_err_t ds18b20_read_scratchpad(uint8_t *data, const ds18b20_rom_t *rom)
 
   maia_onewire_write_byte(g_onewire_pin, DS18B20_CMD_READ_SCRATCH);
 
-  for (uint8_t i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++)
-    {
-      data[i] = maia_onewire_read_byte(g_onewire_pin);
-    }
+  maia_onewire_read_block(g_onewire_pin, data, DS18B20_SCRATCHPAD_SIZE);
 
   /* Verify CRC */
 
@@ -356,6 +744,7 @@ esp_err_t ds18b20_read_scratchpad(uint8_t *data, const ds18b20_rom_t *rom)
     {
       ESP_LOGE(TAG, "CRC mismatch: calculated=0x%02X, received=0x%02X",
                crc, data[8]);
+      atomic_fetch_add_explicit(&g_crc_errors, 1, memory_order_relaxed);
       return ESP_ERR_INVALID_CRC;
     }
 
@@ -374,8 +763,6 @@ esp_err_t ds18b20_read_scratchpad(uint8_t *data, const ds18b20_rom_t *rom)
 esp_err_t ds18b20_read_temperature(float *temp, const ds18b20_rom_t *rom)
 {
   esp_err_t ret;
-  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
-  int16_t raw;
 
   if (temp == NULL)
     {
@@ -394,7 +781,149 @@ esp_err_t ds18b20_read_temperature(float *temp, const ds18b20_rom_t *rom)
 
   vTaskDelay(pdMS_TO_TICKS(g_conversion_time_ms));
 
-  /* Read scratchpad */
+  return ds18b20_read_result(temp, rom);
+}
+
+/****************************************************************************
+ * Name: ds18b20_convert_async
+ *
+ * Description:
+ *   Trigger a conversion and arm the conversion timer; the callback runs
+ *   when the result is ready.
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_convert_async(const ds18b20_rom_t *rom,
+                                ds18b20_convert_cb_t callback, void *arg)
+{
+  return ds18b20_start_conversion(rom, callback, arg);
+}
+
+/****************************************************************************
+ * Name: ds18b20_convert_all_async
+ *
+ * Description:
+ *   Start one broadcast conversion for every sensor.
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_convert_all_async(ds18b20_convert_cb_t callback,
+                                    void *arg)
+{
+  return ds18b20_start_conversion(DS18B20_ALL, callback, arg);
+}
+
+/****************************************************************************
+ * Name: ds18b20_read_all
+ *
+ * Description:
+ *   Read every sensor after one parallel conversion.
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_read_all(float *temps, uint8_t max_temps,
+                           uint8_t *num_read)
+{
+  esp_err_t ret;
+  esp_err_t err = ESP_OK;
+  uint8_t count;
+
+  if (temps == NULL || num_read == NULL || max_temps == 0)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  ret = ds18b20_convert_all_async(NULL, NULL);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vTaskDelay(pdMS_TO_TICKS(g_conversion_time_ms));
+  while (ds18b20_is_converting())
+    {
+      vTaskDelay(1);
+    }
+
+#ifdef CONFIG_MAIA_DS18B20_ROM_MATCH
+  count = g_num_roms < max_temps ? g_num_roms : max_temps;
+#else
+  count = 1;
+#endif
+
+  for (uint8_t i = 0; i < count; i++)
+    {
+#ifdef CONFIG_MAIA_DS18B20_ROM_MATCH
+      ret = ds18b20_read_result(&temps[i], &g_roms[i]);
+#else
+      ret = ds18b20_read_result(&temps[i], NULL);
+#endif
+      if (ret != ESP_OK)
+        {
+          temps[i] = NAN;
+          err = ret;
+        }
+    }
+
+  *num_read = count;
+  return err;
+}
+
+/****************************************************************************
+ * Name: ds18b20_is_converting
+ *
+ * Description:
+ *   Check whether an asynchronous conversion is still running.
+ *
+ ****************************************************************************/
+
+bool ds18b20_is_converting(void)
+{
+  bool converting;
+
+  portENTER_CRITICAL(&g_conv_lock);
+  converting = g_converting;
+  portEXIT_CRITICAL(&g_conv_lock);
+
+  return converting;
+}
+
+/****************************************************************************
+ * Name: ds18b20_get_crc_errors
+ *
+ * Description:
+ *   Number of CRC failures since boot.
+ *
+ ****************************************************************************/
+
+uint32_t ds18b20_get_crc_errors(void)
+{
+  return atomic_load_explicit(&g_crc_errors, memory_order_relaxed);
+}
+
+/****************************************************************************
+ * Name: ds18b20_read_result
+ *
+ * Description:
+ *   Read the last conversion result from the scratchpad.
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_read_result(float *temp, const ds18b20_rom_t *rom)
+{
+  esp_err_t ret;
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  int16_t raw;
+
+  if (temp == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (ds18b20_is_converting())
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
 
   ret = ds18b20_read_scratchpad(scratchpad, rom);
   if (ret != ESP_OK)
@@ -405,11 +934,177 @@ esp_err_t ds18b20_read_temperature(float *temp, const ds18b20_rom_t *rom)
   /* Extract temperature (12-bit signed, LSB = 0.0625°C) */
 
   raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
+
+  /* Below 12 bits the low bits are undefined: 9-bit leaves 3 */
+
+  raw &= ~((1 << (3 - ((scratchpad[4] >> 5) & 0x03))) - 1);
   *temp = ds18b20_convert_temperature(raw);
 
   return ESP_OK;
 }
 
+/****************************************************************************
+ * Name: ds18b20_set_resolution
+ *
+ * Description:
+ *   Switch the resolution of every sensor (scratchpad only).
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_set_resolution(ds18b20_resolution_t resolution)
+{
+  esp_err_t ret;
+  uint8_t config;
+  uint16_t conv_time_ms;
+
+  if (!g_initialized || ds18b20_is_converting())
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (resolution < DS18B20_RESOLUTION_9BIT ||
+      resolution > DS18B20_RESOLUTION_12BIT)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  config = ds18b20_resolution_to_config(resolution, &conv_time_ms);
+  if (config == g_resolution_config)
+    {
+      return ESP_OK;
+    }
+
+  ret = ds18b20_write_config(config);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  g_resolution_config = config;
+  g_conversion_time_ms = conv_time_ms;
+
+  ESP_LOGD(TAG, "Resolution %d-bit", resolution);
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: ds18b20_get_resolution
+ *
+ * Description:
+ *   Current conversion resolution.
+ *
+ ****************************************************************************/
+
+ds18b20_resolution_t ds18b20_get_resolution(void)
+{
+  return (ds18b20_resolution_t)(9 + ((g_resolution_config >> 5) & 0x03));
+}
+
+/****************************************************************************
+ * Name: ds18b20_get_conversion_time_ms
+ *
+ * Description:
+ *   Conversion time of the current resolution.
+ *
+ ****************************************************************************/
+
+uint16_t ds18b20_get_conversion_time_ms(void)
+{
+  return g_conversion_time_ms;
+}
+
+/****************************************************************************
+ * Name: ds18b20_adaptive_update
+ *
+ * Description:
+ *   Pick resolution and next sampling interval from the latest reading.
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_adaptive_update(float temp, uint32_t *next_interval_ms)
+{
+  const float rate_high = CONFIG_MAIA_DS18B20_ADAPTIVE_RATE_MC_S / 1000.0f;
+  ds18b20_resolution_t cur = ds18b20_get_resolution();
+  float lsb = 0.5f / (float)(1 << (cur - DS18B20_RESOLUTION_9BIT));
+  float temp_c;
+  float delta;
+  float rate;
+  int64_t now;
+  int64_t elapsed;
+  bool near_alarm;
+  ds18b20_resolution_t res;
+
+  if (next_interval_ms == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  temp_c = ds18b20_to_celsius(temp);
+  now = esp_timer_get_time();
+
+  /* Rate of change (°C/s) measured from a baseline, not from the previous
+   * reading: a step of one LSB or less (dither between two codes, or a
+   * slow ramp still inside one code) leaves the baseline in place until
+   * a larger step or the end of the window. A baseline taken at another
+   * resolution is dropped, since the rounding differs between the two.
+   * The EMA of the samples gets hysteresis: fast above the threshold,
+   * stable again below half of it.
+   */
+
+  if (!g_adaptive_valid || g_adaptive_res != cur ||
+      now <= g_adaptive_last_us)
+    {
+      g_adaptive_valid = true;
+      g_adaptive_last_c = temp_c;
+      g_adaptive_last_us = now;
+      g_adaptive_res = cur;
+    }
+  else
+    {
+      delta = fabsf(temp_c - g_adaptive_last_c);
+      elapsed = now - g_adaptive_last_us;
+
+      if (delta > lsb || elapsed >= DS18B20_RATE_WINDOW_US)
+        {
+          rate = delta > lsb ? delta * 1e6f / (float)elapsed : 0.0f;
+          g_adaptive_rate += DS18B20_RATE_EMA_ALPHA *
+                             (rate - g_adaptive_rate);
+          g_adaptive_last_c = temp_c;
+          g_adaptive_last_us = now;
+
+          if (g_adaptive_rate > rate_high)
+            {
+              g_adaptive_fast = true;
+            }
+          else if (g_adaptive_rate < rate_high / 2.0f)
+            {
+              g_adaptive_fast = false;
+            }
+        }
+    }
+
+  near_alarm = fabsf(temp_c - CONFIG_MAIA_DS18B20_ADAPTIVE_ALARM_C) <
+               CONFIG_MAIA_DS18B20_ADAPTIVE_ALARM_BAND_C;
+
+  if (near_alarm)
+    {
+      res = DS18B20_RESOLUTION_12BIT;
+      *next_interval_ms = CONFIG_MAIA_DS18B20_ADAPTIVE_FAST_MS;
+    }
+  else if (g_adaptive_fast)
+    {
+      res = DS18B20_RESOLUTION_9BIT;
+      *next_interval_ms = CONFIG_MAIA_DS18B20_ADAPTIVE_FAST_MS;
+    }
+  else
+    {
+      res = DS18B20_RESOLUTION_12BIT;
+      *next_interval_ms = CONFIG_MAIA_DS18B20_ADAPTIVE_SLOW_MS;
+    }
+
+  return ds18b20_set_resolution(res);
+}
+
 /****************************************************************************
  * Name: ds18b20_search_roms
  *
@@ -422,12 +1117,65 @@ esp_err_t ds18b20_read_temperature(float *temp, const ds18b20_rom_t *rom)
 esp_err_t ds18b20_search_roms(ds18b20_rom_t *roms, uint8_t max_roms,
                                uint8_t *num_found)
 {
-#ifdef CONFIG_MAIA_DS18B20_ROM_MATCH
-  /* TODO: Implement ROM search algorithm */
-  ESP_LOGE(TAG, "ROM search not yet implemented");
-  return ESP_ERR_NOT_SUPPORTED;
-#else
-  ESP_LOGW(TAG, "ROM search only available in Match ROM mode");
-  return ESP_ERR_NOT_SUPPORTED;
-#endif
+  esp_err_t ret;
+  uint8_t count;
+
+  if (!g_initialized)
+    {
+      ESP_LOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (num_found == NULL || (roms == NULL && max_roms > 0))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (ds18b20_is_converting())
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  ret = ds18b20_search_bus();
+
+  count = g_num_roms < max_roms ? g_num_roms : max_roms;
+  if (count > 0)
+    {
+      memcpy(roms, g_roms, count * sizeof(ds18b20_rom_t));
+    }
+
+  *num_found = g_num_roms;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ds18b20_get_rom_count
+ *
+ * Description:
+ *   Number of cached ROMs.
+ *
+ ****************************************************************************/
+
+uint8_t ds18b20_get_rom_count(void)
+{
+  return g_num_roms;
+}
+
+/****************************************************************************
+ * Name: ds18b20_get_rom
+ *
+ * Description:
+ *   Copy a cached ROM address.
+ *
+ ****************************************************************************/
+
+esp_err_t ds18b20_get_rom(uint8_t index, ds18b20_rom_t *rom)
+{
+  if (rom == NULL || index >= g_num_roms)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  *rom = g_roms[index];
+  return ESP_OK;
 }
\ No newline at end of file
@@ -3,6 +3,12 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * MPU6050 accelerometer + gyroscope driver. The sensor samples into its
+ * FIFO at CONFIG_MAIA_MPU6050_ODR_HZ; the DATA_RDY interrupt on
+ * MAIA_GPIO_IMU_INT is only counted, and every
+ * CONFIG_MAIA_MPU6050_FIFO_WATERMARK samples a reader task drains the
+ * FIFO with burst reads into a ring of timestamped samples.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_DRIVERS_MPU6050_INCLUDE_MPU6050_H
@@ -12,7 +18,67 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
+#include <stddef.h>
 #include <esp_err.h>
+#include "sdkconfig.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Raw sensitivity of the configured full-scale ranges */
+
+#if defined(CONFIG_MAIA_MPU6050_ACCEL_FS_16G)
+#  define MPU6050_ACCEL_LSB_PER_G       2048
+#elif defined(CONFIG_MAIA_MPU6050_ACCEL_FS_8G)
+#  define MPU6050_ACCEL_LSB_PER_G       4096
+#elif defined(CONFIG_MAIA_MPU6050_ACCEL_FS_4G)
+#  define MPU6050_ACCEL_LSB_PER_G       8192
+#else
+#  define MPU6050_ACCEL_LSB_PER_G       16384
+#endif
+
+#if defined(CONFIG_MAIA_MPU6050_GYRO_FS_2000)
+#  define MPU6050_GYRO_LSB_PER_DPS_X10  164
+#elif defined(CONFIG_MAIA_MPU6050_GYRO_FS_1000)
+#  define MPU6050_GYRO_LSB_PER_DPS_X10  328
+#elif defined(CONFIG_MAIA_MPU6050_GYRO_FS_500)
+#  define MPU6050_GYRO_LSB_PER_DPS_X10  655
+#else
+#  define MPU6050_GYRO_LSB_PER_DPS_X10  1310
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One FIFO sample (raw, sensor axes) */
+
+typedef struct
+{
+  int16_t accel[3];                 /* X, Y, Z */
+  int16_t gyro[3];                  /* X, Y, Z */
+  int64_t timestamp_us;             /* Sampling time (esp_timer) */
+} mpu6050_sample_t;
+
+/* Driver counters */
+
+typedef struct
+{
+  uint32_t bursts;          /* FIFO drains */
+  uint32_t samples;         /* Samples read from the FIFO */
+  uint32_t dropped;         /* Samples lost because the ring was full */
+  uint32_t fifo_overflows;  /* FIFO resets after an overflow */
+  uint32_t i2c_errors;      /* Failed FIFO reads */
+} mpu6050_stats_t;
+
+/* Samples-ready callback.
+ * Called from the driver reader task after each burst has been pushed to
+ * the ring. Keep it short: typically a task notification.
+ */
+
+typedef void (*mpu6050_sample_cb_t)(void *arg);
 
 /****************************************************************************
  * Public Function Prototypes
@@ -22,16 +88,101 @@
  * Name: mpu6050_init
  *
  * Description:
- *   Initialize the mpu6050 driver.
+ *   Reset and configure the MPU6050 (ODR, DLPF, full-scale ranges from
+ *   Kconfig), start the reader task and attach the INT handler. The FIFO
+ *   stays disabled until mpu6050_start().
  *
  * Input Parameters:
  *   None
  *
  * Returned Value:
- *   ESP_OK on success; ESP_FAIL on failure.
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if WHO_AM_I does not match;
+ *   error code otherwise.
  *
  ****************************************************************************/
 
 esp_err_t mpu6050_init(void);
 
+/****************************************************************************
+ * Name: mpu6050_start
+ *
+ * Description:
+ *   Reset and enable the FIFO (accel + gyro) and the DATA_RDY interrupt.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized.
+ *
+ ****************************************************************************/
+
+esp_err_t mpu6050_start(void);
+
+/****************************************************************************
+ * Name: mpu6050_stop
+ *
+ * Description:
+ *   Disable the interrupt and the FIFO. Samples already in the ring can
+ *   still be read.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized.
+ *
+ ****************************************************************************/
+
+esp_err_t mpu6050_stop(void);
+
+/****************************************************************************
+ * Name: mpu6050_read_samples
+ *
+ * Description:
+ *   Pop the oldest samples from the ring. Never blocks; callable from any
+ *   task.
+ *
+ * Input Parameters:
+ *   samples - Output array
+ *   max     - Capacity of the array
+ *
+ * Returned Value:
+ *   Number of samples copied (0 if the ring is empty).
+ *
+ ****************************************************************************/
+
+size_t mpu6050_read_samples(mpu6050_sample_t *samples, size_t max);
+
+/****************************************************************************
+ * Name: mpu6050_set_sample_callback
+ *
+ * Description:
+ *   Register the samples-ready callback (NULL to remove).
+ *
+ ****************************************************************************/
+
+esp_err_t mpu6050_set_sample_callback(mpu6050_sample_cb_t callback,
+                                      void *arg);
+
+/****************************************************************************
+ * Name: mpu6050_get_odr_hz
+ *
+ * Description:
+ *   Output data rate actually configured (1 kHz / (1 + SMPLRT_DIV)).
+ *
+ ****************************************************************************/
+
+uint16_t mpu6050_get_odr_hz(void);
+
+/****************************************************************************
+ * Name: mpu6050_get_stats
+ *
+ * Description:
+ *   Read the driver counters.
+ *
+ * Input Parameters:
+ *   stats - Pointer to store counters
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t mpu6050_get_stats(mpu6050_stats_t *stats);
+
 #endif /* __COMPONENTS_DRIVERS_MPU6050_INCLUDE_MPU6050_H */
@@ -3,6 +3,18 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Sample pipeline:
+ *   DATA_RDY pulse -> ISR (count + timestamp; notify every watermark)
+ *   -> reader task (FIFO_COUNT, then FIFO burst reads)
+ *   -> timestamped samples in the ring -> samples-ready callback
+ *
+ * The MPU6050 has no FIFO watermark interrupt, so the watermark is kept
+ * by counting DATA_RDY pulses. Samples are timestamped backwards from
+ * the last pulse at the configured sample period, which is accurate to
+ * one sample period.
+ *
+ * Reference: MPU-6000/MPU-6050 Register Map and Descriptions (RM-MPU-6000A)
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,6 +22,364 @@
  ****************************************************************************/
 
 #include "mpu6050.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/gpio.h>
+#include <stdbool.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MPU6050]"
+
+#define MPU6050_I2C_TIMEOUT_MS      50
+
+#define MPU6050_TASK_STACK_SIZE     3072
+#define MPU6050_TASK_PRIORITY       (configMAX_PRIORITIES - 3)
+
+/* Registers */
+
+#define MPU6050_REG_SMPLRT_DIV      0x19
+#define MPU6050_REG_CONFIG          0x1A
+#define MPU6050_REG_GYRO_CONFIG     0x1B
+#define MPU6050_REG_ACCEL_CONFIG    0x1C
+#define MPU6050_REG_FIFO_EN         0x23
+#define MPU6050_REG_INT_PIN_CFG     0x37
+#define MPU6050_REG_INT_ENABLE      0x38
+#define MPU6050_REG_USER_CTRL       0x6A
+#define MPU6050_REG_PWR_MGMT_1      0x6B
+#define MPU6050_REG_FIFO_COUNTH     0x72
+#define MPU6050_REG_FIFO_R_W        0x74
+#define MPU6050_REG_WHO_AM_I        0x75
+
+/* Register bits */
+
+#define MPU6050_WHO_AM_I_VALUE      0x68
+#define MPU6050_PWR_DEVICE_RESET    0x80
+#define MPU6050_PWR_CLKSEL_PLL_X    0x01
+#define MPU6050_FIFO_EN_ACCEL_GYRO  0x78    /* XG, YG, ZG, ACCEL */
+#define MPU6050_USER_FIFO_EN        0x40
+#define MPU6050_USER_FIFO_RESET     0x04
+#define MPU6050_INT_DATA_RDY_EN     0x01
+#define MPU6050_INT_PIN_PULSE_HIGH  0x00    /* Active high, 50 us pulse */
+
+#if defined(CONFIG_MAIA_MPU6050_ACCEL_FS_16G)
+#  define MPU6050_AFS_SEL           3
+#elif defined(CONFIG_MAIA_MPU6050_ACCEL_FS_8G)
+#  define MPU6050_AFS_SEL           2
+#elif defined(CONFIG_MAIA_MPU6050_ACCEL_FS_4G)
+#  define MPU6050_AFS_SEL           1
+#else
+#  define MPU6050_AFS_SEL           0
+#endif
+
+#if defined(CONFIG_MAIA_MPU6050_GYRO_FS_2000)
+#  define MPU6050_FS_SEL            3
+#elif defined(CONFIG_MAIA_MPU6050_GYRO_FS_1000)
+#  define MPU6050_FS_SEL            2
+#elif defined(CONFIG_MAIA_MPU6050_GYRO_FS_500)
+#  define MPU6050_FS_SEL            1
+#else
+#  define MPU6050_FS_SEL            0
+#endif
+
+/* With the DLPF enabled (DLPF_CFG 1-6) the sample clock is 1 kHz */
+
+#define MPU6050_SMPLRT_DIV          ((1000 / CONFIG_MAIA_MPU6050_ODR_HZ) - 1)
+#define MPU6050_PERIOD_US           (1000 * (1 + MPU6050_SMPLRT_DIV))
+
+/* FIFO: 1024 bytes of 12-byte frames (accel XYZ, gyro XYZ, big endian) */
+
+#define MPU6050_FIFO_SIZE           1024
+#define MPU6050_FRAME_SIZE          12
+#define MPU6050_WATERMARK           CONFIG_MAIA_MPU6050_FIFO_WATERMARK
+
+/* Frames per burst read: bounds the bus hold time (~10 ms at 400 kHz) so
+ * ToF frame reads are not held back behind a long FIFO drain
+ */
+
+#define MPU6050_BURST_FRAMES        32
+
+#define MPU6050_RING_SIZE           CONFIG_MAIA_MPU6050_RING_SIZE
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static maia_i2c_dev_handle_t g_dev = NULL;
+static bool g_initialized = false;
+static volatile bool g_running = false;
+static TaskHandle_t g_reader_task = NULL;
+static mpu6050_sample_cb_t g_sample_cb = NULL;
+static void *g_sample_cb_arg = NULL;
+
+/* ISR state (g_isr_lock) */
+
+static portMUX_TYPE g_isr_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t g_pulses = 0;           /* Since the last notification */
+static int64_t g_last_pulse_us = 0;
+
+/* Sample ring (g_ring_lock); head/tail are free-running */
+
+static portMUX_TYPE g_ring_lock = portMUX_INITIALIZER_UNLOCKED;
+static mpu6050_sample_t g_ring[MPU6050_RING_SIZE];
+static uint32_t g_head = 0;
+static uint32_t g_tail = 0;
+static mpu6050_stats_t g_stats;
+
+/* Reader task only */
+
+static uint8_t g_burst[MPU6050_BURST_FRAMES * MPU6050_FRAME_SIZE];
+static mpu6050_sample_t g_parsed[MPU6050_BURST_FRAMES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mpu6050_write_reg
+ ****************************************************************************/
+
+static esp_err_t mpu6050_write_reg(uint8_t reg, uint8_t value)
+{
+  uint8_t buf[2] = {reg, value};
+
+  return maia_i2c_transmit(g_dev, buf, sizeof(buf),
+                           MPU6050_I2C_TIMEOUT_MS);
+}
+
+/****************************************************************************
+ * Name: mpu6050_read_regs
+ *
+ * Description:
+ *   Read consecutive registers (the FIFO_R_W register does not
+ *   auto-increment: reading it repeatedly pops the FIFO).
+ *
+ ****************************************************************************/
+
+static esp_err_t mpu6050_read_regs(uint8_t reg, uint8_t *data, size_t len)
+{
+  return maia_i2c_transmit_receive(g_dev, &reg, 1, data, len,
+                                   MPU6050_I2C_TIMEOUT_MS);
+}
+
+/****************************************************************************
+ * Name: mpu6050_fifo_reset
+ *
+ * Description:
+ *   Flush the FIFO and (re)enable it with accel + gyro frames.
+ *
+ ****************************************************************************/
+
+static esp_err_t mpu6050_fifo_reset(void)
+{
+  esp_err_t ret;
+
+  ret = mpu6050_write_reg(MPU6050_REG_USER_CTRL, MPU6050_USER_FIFO_RESET);
+  if (ret == ESP_OK)
+    {
+      ret = mpu6050_write_reg(MPU6050_REG_USER_CTRL, MPU6050_USER_FIFO_EN);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = mpu6050_write_reg(MPU6050_REG_FIFO_EN,
+                              MPU6050_FIFO_EN_ACCEL_GYRO);
+    }
+
+  portENTER_CRITICAL(&g_isr_lock);
+  g_pulses = 0;
+  portEXIT_CRITICAL(&g_isr_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mpu6050_push
+ *
+ * Description:
+ *   Append samples to the ring; samples that do not fit are dropped.
+ *
+ ****************************************************************************/
+
+static void mpu6050_push(const mpu6050_sample_t *samples, size_t n)
+{
+  portENTER_CRITICAL(&g_ring_lock);
+
+  for (size_t i = 0; i < n; i++)
+    {
+      if (g_head - g_tail >= MPU6050_RING_SIZE)
+        {
+          g_stats.dropped += n - i;
+          break;
+        }
+
+      g_ring[g_head % MPU6050_RING_SIZE] = samples[i];
+      g_head++;
+    }
+
+  g_stats.samples += n;
+  portEXIT_CRITICAL(&g_ring_lock);
+}
+
+/****************************************************************************
+ * Name: mpu6050_drain
+ *
+ * Description:
+ *   Read FIFO_COUNT once, then pop every complete frame in bursts of up
+ *   to MPU6050_BURST_FRAMES.
+ *
+ ****************************************************************************/
+
+static void mpu6050_drain(void)
+{
+  uint8_t count_buf[2];
+  uint16_t count;
+  uint32_t frames;
+  int64_t first_us;
+  esp_err_t ret;
+
+  ret = mpu6050_read_regs(MPU6050_REG_FIFO_COUNTH, count_buf, 2);
+  if (ret != ESP_OK)
+    {
+      g_stats.i2c_errors++;
+      return;
+    }
+
+  count = (count_buf[0] << 8) | count_buf[1];
+
+  /* A full FIFO has lost frames and is no longer frame aligned */
+
+  if (count >= MPU6050_FIFO_SIZE)
+    {
+      MAIA_DLOGW(TAG, "FIFO overflow, resetting");
+      g_stats.fifo_overflows++;
+      mpu6050_fifo_reset();
+      return;
+    }
+
+  frames = count / MPU6050_FRAME_SIZE;
+  if (frames == 0)
+    {
+      return;
+    }
+
+  /* The newest frame belongs to the last DATA_RDY pulse */
+
+  portENTER_CRITICAL(&g_isr_lock);
+  first_us = g_last_pulse_us;
+  portEXIT_CRITICAL(&g_isr_lock);
+
+  first_us -= (int64_t)(frames - 1) * MPU6050_PERIOD_US;
+
+  for (uint32_t done = 0; done < frames; )
+    {
+      uint32_t n = frames - done;
+      const uint8_t *p = g_burst;
+
+      if (n > MPU6050_BURST_FRAMES)
+        {
+          n = MPU6050_BURST_FRAMES;
+        }
+
+      ret = mpu6050_read_regs(MPU6050_REG_FIFO_R_W, g_burst,
+                              n * MPU6050_FRAME_SIZE);
+      if (ret != ESP_OK)
+        {
+          /* Frame alignment is unknown after a failed read */
+
+          g_stats.i2c_errors++;
+          mpu6050_fifo_reset();
+          return;
+        }
+
+      for (uint32_t i = 0; i < n; i++, p += MPU6050_FRAME_SIZE)
+        {
+          mpu6050_sample_t *s = &g_parsed[i];
+
+          for (int axis = 0; axis < 3; axis++)
+            {
+              s->accel[axis] = (int16_t)((p[2 * axis] << 8) |
+                                         p[2 * axis + 1]);
+              s->gyro[axis] = (int16_t)((p[6 + 2 * axis] << 8) |
+                                        p[6 + 2 * axis + 1]);
+            }
+
+          s->timestamp_us = first_us +
+                            (int64_t)(done + i) * MPU6050_PERIOD_US;
+        }
+
+      mpu6050_push(g_parsed, n);
+      done += n;
+    }
+
+  g_stats.bursts++;
+
+  if (g_sample_cb != NULL)
+    {
+      g_sample_cb(g_sample_cb_arg);
+    }
+}
+
+/****************************************************************************
+ * Name: mpu6050_reader_task
+ ****************************************************************************/
+
+static void mpu6050_reader_task(void *arg)
+{
+  (void)arg;
+
+  for (;;)
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      if (g_running)
+        {
+          mpu6050_drain();
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mpu6050_isr_handler
+ *
+ * Description:
+ *   DATA_RDY pulse: one new FIFO frame. Wake the reader every
+ *   MPU6050_WATERMARK frames.
+ *
+ ****************************************************************************/
+
+static void IRAM_ATTR mpu6050_isr_handler(void *arg)
+{
+  BaseType_t woken = pdFALSE;
+  bool notify;
+
+  (void)arg;
+
+  portENTER_CRITICAL_ISR(&g_isr_lock);
+  g_last_pulse_us = esp_timer_get_time();
+  notify = ++g_pulses >= MPU6050_WATERMARK;
+  if (notify)
+    {
+      g_pulses = 0;
+    }
+
+  portEXIT_CRITICAL_ISR(&g_isr_lock);
+
+  if (notify)
+    {
+      vTaskNotifyGiveFromISR(g_reader_task, &woken);
+      if (woken == pdTRUE)
+        {
+          portYIELD_FROM_ISR();
+        }
+    }
+}
 
 /****************************************************************************
  * Public Functions
@@ -21,17 +391,229 @@
  * Description:
  *   Initialize the mpu6050 driver.
  *
- * Input Parameters:
- *   None
- *
- * Returned Value:
- *   ESP_OK on success; ESP_FAIL on failure.
- *
  ****************************************************************************/
 
 esp_err_t mpu6050_init(void)
 {
-  /* TODO: Implement mpu6050 initialization */
+  esp_err_t ret;
+  uint8_t who = 0;
+
+  if (g_initialized)
+    {
+      ESP_LOGW(TAG, "Already initialized");
+      return ESP_OK;
+    }
+
+  ESP_LOGI(TAG, "Initializing MPU6050 (addr 0x%02X, %d Hz, watermark %d)",
+           MAIA_I2C_ADDR_MPU6050, mpu6050_get_odr_hz(), MPU6050_WATERMARK);
+
+  maia_i2c_dev_config_t dev_cfg = {
+      .name = "mpu6050",
+      .addr = MAIA_I2C_ADDR_MPU6050,
+      .bus = MAIA_I2C_BUS_MPU6050,
+      .prio = MAIA_I2C_PRIO_IMU,
+  };
+
+  ret = maia_i2c_add_device(&dev_cfg, &g_dev);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to add I2C device: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+  ret = mpu6050_read_regs(MPU6050_REG_WHO_AM_I, &who, 1);
+  if (ret != ESP_OK || who != MPU6050_WHO_AM_I_VALUE)
+    {
+      ESP_LOGE(TAG, "MPU6050 not found (WHO_AM_I=0x%02X)", who);
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  /* Reset, then wake up on the gyro X PLL (more stable than the
+   * internal oscillator)
+   */
+
+  mpu6050_write_reg(MPU6050_REG_PWR_MGMT_1, MPU6050_PWR_DEVICE_RESET);
+  vTaskDelay(pdMS_TO_TICKS(100));
+
+  ret = mpu6050_write_reg(MPU6050_REG_PWR_MGMT_1, MPU6050_PWR_CLKSEL_PLL_X);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  /* SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG: one burst */
+
+  const uint8_t prefix = MPU6050_REG_SMPLRT_DIV;
+  const uint8_t config[4] =
+    {
+      MPU6050_SMPLRT_DIV,
+      CONFIG_MAIA_MPU6050_DLPF_CFG,
+      MPU6050_FS_SEL << 3,
+      MPU6050_AFS_SEL << 3,
+    };
+
+  ret = maia_i2c_transmit_prefixed(g_dev, &prefix, 1, config,
+                                   sizeof(config), MPU6050_I2C_TIMEOUT_MS);
+  if (ret == ESP_OK)
+    {
+      ret = mpu6050_write_reg(MPU6050_REG_INT_PIN_CFG,
+                              MPU6050_INT_PIN_PULSE_HIGH);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = mpu6050_write_reg(MPU6050_REG_INT_ENABLE, 0);
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Configuration failed: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+  /* Reader task and INT handler */
+
+  if (xTaskCreatePinnedToCore(mpu6050_reader_task, "imu_reader",
+                              MPU6050_TASK_STACK_SIZE, NULL,
+                              MPU6050_TASK_PRIORITY, &g_reader_task,
+                              MAIA_CORE_RT) != pdPASS)
+    {
+      ESP_LOGE(TAG, "Failed to create reader task");
+      return ESP_ERR_NO_MEM;
+    }
+
+  ret = gpio_isr_handler_add(MAIA_GPIO_IMU_INT, mpu6050_isr_handler, NULL);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to add INT handler: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+  g_initialized = true;
+  ESP_LOGI(TAG, "MPU6050 initialized successfully");
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: mpu6050_start
+ ****************************************************************************/
+
+esp_err_t mpu6050_start(void)
+{
+  esp_err_t ret;
+
+  if (!g_initialized)
+    {
+      ESP_LOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  ret = mpu6050_fifo_reset();
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  g_running = true;
+
+  return mpu6050_write_reg(MPU6050_REG_INT_ENABLE, MPU6050_INT_DATA_RDY_EN);
+}
+
+/****************************************************************************
+ * Name: mpu6050_stop
+ ****************************************************************************/
+
+esp_err_t mpu6050_stop(void)
+{
+  esp_err_t ret;
+
+  if (!g_initialized)
+    {
+      ESP_LOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  g_running = false;
+
+  ret = mpu6050_write_reg(MPU6050_REG_INT_ENABLE, 0);
+  if (ret == ESP_OK)
+    {
+      ret = mpu6050_write_reg(MPU6050_REG_FIFO_EN, 0);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = mpu6050_write_reg(MPU6050_REG_USER_CTRL, 0);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mpu6050_read_samples
+ ****************************************************************************/
+
+size_t mpu6050_read_samples(mpu6050_sample_t *samples, size_t max)
+{
+  size_t n = 0;
+
+  if (samples == NULL)
+    {
+      return 0;
+    }
+
+  portENTER_CRITICAL(&g_ring_lock);
+
+  while (n < max && g_tail != g_head)
+    {
+      samples[n++] = g_ring[g_tail % MPU6050_RING_SIZE];
+      g_tail++;
+    }
+
+  portEXIT_CRITICAL(&g_ring_lock);
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: mpu6050_set_sample_callback
+ ****************************************************************************/
+
+esp_err_t mpu6050_set_sample_callback(mpu6050_sample_cb_t callback,
+                                      void *arg)
+{
+  portENTER_CRITICAL(&g_ring_lock);
+  g_sample_cb = callback;
+  g_sample_cb_arg = arg;
+  portEXIT_CRITICAL(&g_ring_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: mpu6050_get_odr_hz
+ ****************************************************************************/
+
+uint16_t mpu6050_get_odr_hz(void)
+{
+  return 1000 / (1 + MPU6050_SMPLRT_DIV);
+}
+
+/****************************************************************************
+ * Name: mpu6050_get_stats
+ ****************************************************************************/
+
+esp_err_t mpu6050_get_stats(mpu6050_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_ring_lock);
+  *stats = g_stats;
+  portEXIT_CRITICAL(&g_ring_lock);
 
   return ESP_OK;
 }
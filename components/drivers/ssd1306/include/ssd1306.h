@@ -34,12 +34,21 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Display dimensions from Kconfig */
+#define SSD1306_WIDTH   CONFIG_MAIA_SSD1306_WIDTH
+#define SSD1306_HEIGHT  CONFIG_MAIA_SSD1306_HEIGHT
+
+/** Framebuffer size: (width * height) / 8 bits per byte */
+#define SSD1306_BUFFER_SIZE  ((SSD1306_WIDTH * SSD1306_HEIGHT) / 8)
+
 /**
  * @brief Font size selection for text rendering
  *
@@ -92,21 +101,61 @@ esp_err_t ssd1306_init(void);
  * @brief Clear framebuffer (set all pixels OFF)
  *
  * Zeros internal 512-byte framebuffer. Call ssd1306_display() to
- * update screen with cleared buffer.
+ * update screen with cleared buffer. Only columns that had pixels set are
+ * marked dirty.
  *
  * @return
  *     - ESP_OK: Framebuffer cleared successfully
  */
 esp_err_t ssd1306_clear(void);
 
+/**
+ * @brief Copy the framebuffer contents out
+ *
+ * Used to cache a rendered screen so it can be shown again later with
+ * ssd1306_load_framebuffer() instead of being redrawn.
+ *
+ * @param[out] dst Buffer of SSD1306_BUFFER_SIZE bytes
+ *
+ * @return
+ *     - ESP_OK: Framebuffer copied
+ *     - ESP_ERR_INVALID_ARG: NULL buffer
+ */
+esp_err_t ssd1306_save_framebuffer(uint8_t *dst);
+
+/**
+ * @brief Replace the framebuffer contents
+ *
+ * Only the columns that differ from the current framebuffer are marked
+ * dirty, so switching between similar screens sends little data on the
+ * next ssd1306_display().
+ *
+ * @param[in] src Buffer of SSD1306_BUFFER_SIZE bytes
+ *
+ * @return
+ *     - ESP_OK: Framebuffer replaced
+ *     - ESP_ERR_INVALID_ARG: NULL buffer
+ */
+esp_err_t ssd1306_load_framebuffer(const uint8_t *src);
+
 /**
  * @brief Flush framebuffer to display GDDRAM
  *
- * Transmits entire 512-byte framebuffer (128x32 bits) to SSD1306
- * GDDRAM via I2C. Updates visible screen content.
+ * Transmits the parts of the framebuffer modified since the last flush
+ * to SSD1306 GDDRAM via I2C. Updates visible screen content.
  *
- * Uses horizontal addressing mode: data written sequentially from
- * column 0-127, then advances to next page (row group).
+ * Drawing functions track a dirty column span per page (only when a
+ * byte really changes). Each dirty page is sent through a
+ * COLUMN_ADDR/PAGE_ADDR window covering just its span, or all of them
+ * through a single window bounding the spans when that is cheaper on
+ * the bus; clean pages are skipped, so a flush without changes does not
+ * touch the bus.
+ *
+ * With CONFIG_MAIA_SSD1306_DOUBLE_BUFFER the frame is handed to a flush
+ * task and drawing continues in the second framebuffer right away; the
+ * call only blocks while the previous frame is still being sent. The
+ * returned status is then the one of the previous flush, and pages it
+ * failed to send are retried with this one.
  *
  * @return
  *     - ESP_OK: Display updated successfully
@@ -114,6 +163,18 @@ esp_err_t ssd1306_clear(void);
  */
 esp_err_t ssd1306_display(void);
 
+/**
+ * @brief Wait until the last ssd1306_display() reached GDDRAM
+ *
+ * Returns immediately when double buffering is disabled.
+ *
+ * @return
+ *     - ESP_OK: Last flush completed successfully
+ *     - ESP_FAIL: I2C transmission error in last flush
+ *     - ESP_ERR_INVALID_STATE: Driver not initialized
+ */
+esp_err_t ssd1306_display_wait(void);
+
 /**
  * @brief Set individual pixel state in framebuffer
  *
@@ -130,12 +191,37 @@ esp_err_t ssd1306_display(void);
  */
 esp_err_t ssd1306_set_pixel(uint8_t x, uint8_t y, bool on);
 
+/**
+ * @brief Overwrite a run of column bytes of one page
+ *
+ * Copies whole framebuffer bytes (bit 0 = top row of the page), for
+ * screens rendered a byte at a time rather than pixel by pixel. Only
+ * the columns that differ are marked dirty.
+ *
+ * Does not automatically update screen - call ssd1306_display().
+ *
+ * @param[in] page Page index (0-3, 8 rows each, top to bottom)
+ * @param[in] x First column (0-127)
+ * @param[in] src Column bytes, left to right
+ * @param[in] width Number of columns (x + width <= 128)
+ *
+ * @return
+ *     - ESP_OK: Bytes written to framebuffer
+ *     - ESP_ERR_INVALID_ARG: NULL source or run out of bounds
+ */
+esp_err_t ssd1306_write_page(uint8_t page, uint8_t x, const uint8_t *src,
+                             uint8_t width);
+
 /**
  * @brief Draw single ASCII character at specified position
  *
  * Character is drawn using selected font. Non-printable characters
  * (outside 0x20-0x7E range) are silently ignored.
  *
+ * Glyph bits are ORed into the framebuffer a whole column byte at a
+ * time (two shifted bytes when y is not a multiple of 8). Parts falling
+ * off the right or bottom edge are clipped.
+ *
  * Does not automatically update screen - call ssd1306_display().
  *
  * @param[in] x X coordinate in pixels (left edge of character)
@@ -218,6 +304,41 @@ esp_err_t ssd1306_screen_off(void);
  */
 esp_err_t ssd1306_set_contrast(uint8_t contrast);
 
+/**
+ * @brief Enter or leave the idle (dimmed) state
+ *
+ * Idle slows the panel oscillator down (about 40 Hz frame rate) and
+ * lowers the contrast to CONFIG_MAIA_SSD1306_IDLE_CONTRAST, in one
+ * command transaction. Leaving idle restores the reset oscillator
+ * setting and the contrast of the last ssd1306_set_contrast() call.
+ * The framebuffer and display ON/OFF state are not affected.
+ *
+ * @param[in] idle true to dim, false to restore
+ *
+ * @return
+ *     - ESP_OK: Panel updated
+ *     - ESP_ERR_INVALID_STATE: Driver not initialized
+ *     - ESP_FAIL: I2C communication error
+ */
+esp_err_t ssd1306_set_idle(bool idle);
+
+/**
+ * @brief Send a list of commands in a single I2C transaction
+ *
+ * Commands and their arguments are sent back to back after one command
+ * stream control byte (0x00), instead of one transaction per byte.
+ *
+ * @param[in] cmds Command bytes (commands followed by their arguments)
+ * @param[in] len  Number of bytes (1-32)
+ *
+ * @return
+ *     - ESP_OK: Commands sent successfully
+ *     - ESP_ERR_INVALID_ARG: NULL list or invalid length
+ *     - ESP_ERR_INVALID_STATE: Driver not initialized
+ *     - ESP_FAIL: I2C communication error
+ */
+esp_err_t ssd1306_write_command_list(const uint8_t *cmds, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,9 @@
 #include "maia_board.h"
 #include "driver/i2c_master.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
 /****************************************************************************
@@ -54,14 +57,9 @@
 #define SSD1306_CMD_SEG_REMAP               0xA0
 #define SSD1306_CMD_CHARGE_PUMP             0x8D
 
-/* Display dimensions from Kconfig */
+/* Number of 8-pixel pages */
 
-#define SSD1306_WIDTH   CONFIG_MAIA_SSD1306_WIDTH
-#define SSD1306_HEIGHT  CONFIG_MAIA_SSD1306_HEIGHT
-
-/* Framebuffer size: (width * height) / 8 bits per byte */
-
-#define SSD1306_BUFFER_SIZE  ((SSD1306_WIDTH * SSD1306_HEIGHT) / 8)
+#define SSD1306_PAGES        (SSD1306_HEIGHT / 8)
 
 /* I2C communication parameters */
 
@@ -74,6 +72,37 @@
 #define SSD1306_CONTROL_CMD_STREAM   0x00  /* Command stream */
 #define SSD1306_CONTROL_DATA_STREAM  0x40  /* Data stream */
 
+/* Longest command list sent in one transaction */
+
+#define SSD1306_CMD_LIST_MAX         32
+
+/* Oscillator setting (upper nibble) and clock divide ratio - 1: 0x80 is
+ * the reset value (~175 Hz frame rate at 32 lines), 0x01 the slowest
+ * oscillator divided by 2 (~40 Hz) for the idle screen
+ */
+
+#define SSD1306_CLK_DIV_NORMAL       0x80
+#define SSD1306_CLK_DIV_IDLE         0x01
+
+/* Bus cost of one extra window, in data byte equivalents (address,
+ * control bytes, start/stop and the 6-byte window command stream)
+ */
+
+#define SSD1306_WINDOW_COST          12
+
+/* Flush task (double-buffered mode) */
+
+#define SSD1306_FLUSH_STACK_SIZE     3072
+#define SSD1306_FLUSH_PRIORITY       (tskIDLE_PRIORITY + 2)
+
+/* Number of framebuffers */
+
+#ifdef CONFIG_MAIA_SSD1306_DOUBLE_BUFFER
+#define SSD1306_NUM_BUFFERS          2
+#else
+#define SSD1306_NUM_BUFFERS          1
+#endif
+
 /* Font dimensions */
 
 #define FONT_5X8_WIDTH   5
@@ -86,6 +115,18 @@
 #define FONT_FIRST_CHAR  0x20  /* Space */
 #define FONT_LAST_CHAR   0x7E  /* Tilde ~ */
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Dirty column span per page [x0, x1]; x0 > x1 means page is clean */
+
+typedef struct
+{
+    uint8_t x0[SSD1306_PAGES];
+    uint8_t x1[SSD1306_PAGES];
+} ssd1306_dirty_t;
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -94,11 +135,71 @@ static const char *TAG = "ssd1306";
 
 /* Framebuffer: 512 bytes for 128x32 display (column-major order) */
 
-static uint8_t g_framebuffer[SSD1306_BUFFER_SIZE];
+static uint8_t g_framebuffers[SSD1306_NUM_BUFFERS][SSD1306_BUFFER_SIZE];
+
+/* Buffer being drawn and its dirty spans (vs. panel GDDRAM) */
+
+static uint8_t *g_framebuffer = g_framebuffers[0];
+static ssd1306_dirty_t g_dirty;
 
-/* I2C device handle (obtained from maia_board) */
+/* Merged window gathered from a framebuffer (flush context only) */
 
-static i2c_master_dev_handle_t g_ssd1306_handle = NULL;
+static uint8_t g_window[SSD1306_BUFFER_SIZE];
+
+/* Contrast restored when leaving idle (ssd1306_set_contrast()) */
+
+static uint8_t g_contrast = CONFIG_MAIA_SSD1306_CONTRAST;
+
+#ifdef CONFIG_MAIA_SSD1306_DOUBLE_BUFFER
+
+/* Buffer owned by the flush task and the spans it still has to send.
+ * g_flush_idle is given back by the flush task when it is done; pages
+ * that failed stay dirty in g_tx_dirty and are re-sent next flush.
+ */
+
+static const uint8_t *g_tx_buffer = NULL;
+static ssd1306_dirty_t g_tx_dirty;
+static esp_err_t g_flush_result = ESP_OK;
+static SemaphoreHandle_t g_flush_idle = NULL;
+static StaticSemaphore_t g_flush_idle_buf;
+static TaskHandle_t g_flush_task = NULL;
+
+#endif
+
+/* Power-up command sequence (sent as a single command stream) */
+
+static const uint8_t g_init_sequence[] =
+{
+    SSD1306_CMD_DISPLAY_OFF,
+    SSD1306_CMD_SET_DISPLAY_CLK_DIV, SSD1306_CLK_DIV_NORMAL,
+    SSD1306_CMD_SET_MULTIPLEX, SSD1306_HEIGHT - 1,  /* 31 for 32 lines */
+    SSD1306_CMD_SET_DISPLAY_OFFSET, 0x00,   /* No vertical offset */
+    SSD1306_CMD_SET_START_LINE | 0x00,
+    SSD1306_CMD_CHARGE_PUMP, 0x14,          /* Enable charge pump */
+    SSD1306_CMD_MEMORY_MODE, 0x00,          /* Horizontal addressing */
+
+    /* Apply rotation configuration */
+
+#ifdef CONFIG_MAIA_SSD1306_ROTATION_180
+    SSD1306_CMD_SEG_REMAP | 0x00,           /* No remap */
+    SSD1306_CMD_COM_SCAN_INC,               /* Normal scan */
+#else
+    SSD1306_CMD_SEG_REMAP | 0x01,           /* Remap */
+    SSD1306_CMD_COM_SCAN_DEC,               /* Reverse */
+#endif
+
+    SSD1306_CMD_SET_COMPINS, 0x02,          /* Sequential COM, no remap */
+    SSD1306_CMD_SET_CONTRAST, CONFIG_MAIA_SSD1306_CONTRAST,
+    SSD1306_CMD_SET_PRECHARGE, 0xF1,        /* Phase 1: 15, Phase 2: 1 */
+    SSD1306_CMD_SET_VCOMH_DESELECT, 0x40,   /* 0.77 * VCC */
+    SSD1306_CMD_DISPLAY_ALL_ON_RESUME,
+    SSD1306_CMD_NORMAL_DISPLAY,
+    SSD1306_CMD_DISPLAY_ON,
+};
+
+/* I2C arbiter device handle (display lane, splittable) */
+
+static maia_i2c_dev_handle_t g_ssd1306_handle = NULL;
 
 /****************************************************************************
  * Font Data: 5x8 Bitmap Font
@@ -517,8 +618,18 @@ static const uint8_t g_font8x16[][16] =
 
 static esp_err_t ssd1306_write_command(uint8_t cmd);
 static esp_err_t ssd1306_write_data(const uint8_t *data, size_t len);
+static void ssd1306_or_columns(uint8_t page, uint8_t x, const uint8_t *src,
+                               uint8_t width, int8_t shift);
+static void ssd1306_blit_glyph(uint8_t x, uint8_t y, const uint8_t *glyph,
+                               uint8_t width, uint8_t bands);
 static void ssd1306_draw_char_5x8(uint8_t x, uint8_t y, char ch);
 static void ssd1306_draw_char_8x16(uint8_t x, uint8_t y, char ch);
+static void ssd1306_mark_dirty(ssd1306_dirty_t *dirty, uint8_t page,
+                               uint8_t x0, uint8_t x1);
+static void ssd1306_mark_clean(ssd1306_dirty_t *dirty, uint8_t page);
+static esp_err_t ssd1306_flush_window(const uint8_t *fb, uint8_t x0,
+                                      uint8_t x1, uint8_t p0, uint8_t p1);
+static esp_err_t ssd1306_flush(const uint8_t *fb, ssd1306_dirty_t *dirty);
 
 /****************************************************************************
  * Private Functions
@@ -544,8 +655,8 @@ static esp_err_t ssd1306_write_command(uint8_t cmd)
     buffer[0] = SSD1306_CONTROL_CMD_SINGLE;
     buffer[1] = cmd;
 
-    ret = i2c_master_transmit(g_ssd1306_handle, buffer, 2,
-                              SSD1306_TIMEOUT_MS);
+    ret = maia_i2c_transmit(g_ssd1306_handle, buffer, 2,
+                            SSD1306_TIMEOUT_MS);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "I2C transmit cmd 0x%02X failed: %s",
@@ -555,16 +666,65 @@ static esp_err_t ssd1306_write_command(uint8_t cmd)
     return ret;
 }
 
+/**
+ * @brief Write command list to SSD1306 in one I2C transaction
+ *
+ * Uses the command stream control byte (Co = 0): every byte after it is
+ * interpreted as a command or command argument.
+ *
+ * @param[in] cmds Command bytes (commands with their arguments)
+ * @param[in] len Number of bytes (max SSD1306_CMD_LIST_MAX)
+ * @return ESP_OK on success, ESP_FAIL on I2C error
+ */
+esp_err_t ssd1306_write_command_list(const uint8_t *cmds, size_t len)
+{
+    uint8_t buffer[SSD1306_CMD_LIST_MAX + 1];
+    esp_err_t ret;
+
+    if (g_ssd1306_handle == NULL)
+    {
+        ESP_LOGE(TAG, "Device not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (cmds == NULL || len == 0 || len > SSD1306_CMD_LIST_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Small copy on purpose: a plain transmit is never split by the
+     * arbiter, so a command is never separated from its arguments
+     */
+
+    buffer[0] = SSD1306_CONTROL_CMD_STREAM;
+    memcpy(&buffer[1], cmds, len);
+
+    ret = maia_i2c_transmit(g_ssd1306_handle, buffer, len + 1,
+                            SSD1306_TIMEOUT_MS);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "I2C transmit cmd list (%zu bytes) failed: %s",
+                 len, esp_err_to_name(ret));
+    }
+
+    return ret;
+}
+
 /**
  * @brief Write data stream to SSD1306 GDDRAM via I2C
  *
+ * The control byte is sent as a separate prefix, so the data is read in
+ * place. The arbiter splits the stream into chunks (each with its own
+ * 0x40 control byte, GDDRAM pointer keeps advancing) so that sensing and
+ * haptic transactions can run in between.
+ *
  * @param[in] data Pointer to data buffer
  * @param[in] len Number of bytes to write
  * @return ESP_OK on success, ESP_FAIL on I2C error
  */
 static esp_err_t ssd1306_write_data(const uint8_t *data, size_t len)
 {
-    uint8_t buffer[SSD1306_BUFFER_SIZE + 1];
+    const uint8_t control = SSD1306_CONTROL_DATA_STREAM;
     esp_err_t ret;
 
     if (g_ssd1306_handle == NULL)
@@ -580,11 +740,8 @@ static esp_err_t ssd1306_write_data(const uint8_t *data, size_t len)
         return ESP_ERR_INVALID_SIZE;
     }
 
-    buffer[0] = SSD1306_CONTROL_DATA_STREAM;
-    memcpy(&buffer[1], data, len);
-
-    ret = i2c_master_transmit(g_ssd1306_handle, buffer, len + 1,
-                              SSD1306_TIMEOUT_MS);
+    ret = maia_i2c_transmit_prefixed(g_ssd1306_handle, &control, 1,
+                                     data, len, SSD1306_TIMEOUT_MS);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "I2C transmit data (%zu bytes) failed: %s",
@@ -595,95 +752,354 @@ static esp_err_t ssd1306_write_data(const uint8_t *data, size_t len)
 }
 
 /**
- * @brief Draw single character using 5x8 font
+ * @brief Extend the dirty column span of a page
  *
- * @param[in] x X coordinate (pixels)
- * @param[in] y Y coordinate (pixels)
- * @param[in] ch ASCII character (0x20-0x7E)
+ * @param[in,out] dirty Dirty span set
+ * @param[in] page Page index (0 to SSD1306_PAGES - 1)
+ * @param[in] x0 First modified column
+ * @param[in] x1 Last modified column
  */
-static void ssd1306_draw_char_5x8(uint8_t x, uint8_t y, char ch)
+static void ssd1306_mark_dirty(ssd1306_dirty_t *dirty, uint8_t page,
+                               uint8_t x0, uint8_t x1)
 {
-    uint8_t font_idx;
-    uint8_t col;
-    uint8_t row;
-    uint8_t line;
+    if (x0 < dirty->x0[page])
+    {
+        dirty->x0[page] = x0;
+    }
 
-    /* Validate printable ASCII range */
+    if (x1 > dirty->x1[page])
+    {
+        dirty->x1[page] = x1;
+    }
+}
 
-    if (ch < FONT_FIRST_CHAR || ch > FONT_LAST_CHAR)
+/**
+ * @brief Mark a page as in sync with GDDRAM
+ *
+ * @param[in,out] dirty Dirty span set
+ * @param[in] page Page index (0 to SSD1306_PAGES - 1)
+ */
+static void ssd1306_mark_clean(ssd1306_dirty_t *dirty, uint8_t page)
+{
+    dirty->x0[page] = SSD1306_WIDTH;
+    dirty->x1[page] = 0;
+}
+
+/**
+ * @brief Send one column/page window of a framebuffer to GDDRAM
+ *
+ * Two transactions: the window as one command stream, then the data.
+ * A full-width window is contiguous in the framebuffer and read in
+ * place; otherwise its page spans are gathered first (horizontal
+ * addressing wraps to x0 of the next page).
+ *
+ * @param[in] fb Framebuffer to send from
+ * @param[in] x0 First column
+ * @param[in] x1 Last column
+ * @param[in] p0 First page
+ * @param[in] p1 Last page
+ * @return ESP_OK on success, ESP_FAIL on I2C error
+ */
+static esp_err_t ssd1306_flush_window(const uint8_t *fb, uint8_t x0,
+                                      uint8_t x1, uint8_t p0, uint8_t p1)
+{
+    const uint8_t *data = &fb[p0 * SSD1306_WIDTH + x0];
+    size_t width = x1 - x0 + 1;
+    uint8_t window[6];
+    esp_err_t ret;
+
+    window[0] = SSD1306_CMD_COLUMN_ADDR;
+    window[1] = x0;
+    window[2] = x1;
+    window[3] = SSD1306_CMD_PAGE_ADDR;
+    window[4] = p0;
+    window[5] = p1;
+
+    ret = ssd1306_write_command_list(window, sizeof(window));
+    if (ret != ESP_OK) return ret;
+
+    if (p1 > p0 && width < SSD1306_WIDTH)
     {
-        return;
+        for (uint8_t page = p0; page <= p1; page++)
+        {
+            memcpy(&g_window[(page - p0) * width],
+                   &fb[page * SSD1306_WIDTH + x0], width);
+        }
+
+        data = g_window;
     }
 
-    font_idx = ch - FONT_FIRST_CHAR;
+    ret = ssd1306_write_data(data, width * (p1 - p0 + 1));
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to write pages %u-%u to display", p0, p1);
+    }
 
-    /* Draw each column of the character */
+    return ret;
+}
 
-    for (col = 0; col < FONT_5X8_WIDTH; col++)
+/**
+ * @brief Send the dirty spans of a range of pages to GDDRAM
+ *
+ * The dirty spans are sent as one window bounding all of them (clean
+ * bytes inside it already match GDDRAM) when that costs no more bus
+ * time than one window per dirty page. Otherwise, with runs set, each
+ * run of consecutive dirty pages gets the same choice; without it each
+ * dirty page is sent through its own window. Sent pages are marked
+ * clean; on error the remaining pages stay dirty.
+ *
+ * @param[in] fb Framebuffer to send from
+ * @param[in,out] dirty Dirty spans of fb
+ * @param[in] first First page of the range
+ * @param[in] last Last page of the range
+ * @param[in] runs Try runs of dirty pages before single pages
+ * @return ESP_OK on success, ESP_FAIL on I2C error
+ */
+static esp_err_t ssd1306_flush_range(const uint8_t *fb,
+                                     ssd1306_dirty_t *dirty, uint8_t first,
+                                     uint8_t last, bool runs)
+{
+    esp_err_t ret;
+    uint8_t x0 = SSD1306_WIDTH;
+    uint8_t x1 = 0;
+    uint8_t p0 = SSD1306_PAGES;
+    uint8_t p1 = 0;
+    size_t separate = 0;
+    size_t merged;
+
+    for (uint8_t page = first; page <= last; page++)
+    {
+        if (dirty->x0[page] > dirty->x1[page])
+        {
+            continue;  /* Page unchanged */
+        }
+
+        x0 = dirty->x0[page] < x0 ? dirty->x0[page] : x0;
+        x1 = dirty->x1[page] > x1 ? dirty->x1[page] : x1;
+        p0 = page < p0 ? page : p0;
+        p1 = page;
+        separate += dirty->x1[page] - dirty->x0[page] + 1 +
+                    SSD1306_WINDOW_COST;
+    }
+
+    if (p0 == SSD1306_PAGES)
+    {
+        return ESP_OK;  /* Nothing to send */
+    }
+
+    merged = (size_t)(x1 - x0 + 1) * (p1 - p0 + 1) + SSD1306_WINDOW_COST;
+
+    if (merged <= separate)
     {
-        line = g_font5x8[font_idx][col];
+        ret = ssd1306_flush_window(fb, x0, x1, p0, p1);
+        if (ret != ESP_OK) return ret;
 
-        for (row = 0; row < FONT_5X8_HEIGHT; row++)
+        for (uint8_t page = p0; page <= p1; page++)
         {
-            if (line & (1 << row))
+            ssd1306_mark_clean(dirty, page);
+        }
+
+        return ESP_OK;
+    }
+
+    for (uint8_t page = p0; page <= p1; page++)
+    {
+        uint8_t end = page;
+
+        if (dirty->x0[page] > dirty->x1[page])
+        {
+            continue;
+        }
+
+        if (runs)
+        {
+            while (end < p1 && dirty->x0[end + 1] <= dirty->x1[end + 1])
             {
-                ssd1306_set_pixel(x + col, y + row, true);
+                end++;
             }
+
+            ret = ssd1306_flush_range(fb, dirty, page, end, false);
+            if (ret != ESP_OK) return ret;
+
+            page = end;
+            continue;
         }
+
+        ret = ssd1306_flush_window(fb, dirty->x0[page], dirty->x1[page],
+                                   page, page);
+        if (ret != ESP_OK) return ret;
+
+        ssd1306_mark_clean(dirty, page);
     }
+
+    return ESP_OK;
 }
 
 /**
- * @brief Draw single character using 8x16 font
+ * @brief Send the dirty spans of a framebuffer to GDDRAM
  *
- * @param[in] x X coordinate (pixels)
- * @param[in] y Y coordinate (pixels)
- * @param[in] ch ASCII character (0x20-0x7E)
+ * A full redraw, or any frame changing all over the screen, is one
+ * window: two transactions (window command stream, then the data).
+ *
+ * @param[in] fb Framebuffer to send from
+ * @param[in,out] dirty Dirty spans of fb
+ * @return ESP_OK on success, ESP_FAIL on I2C error
  */
-static void ssd1306_draw_char_8x16(uint8_t x, uint8_t y, char ch)
+static esp_err_t ssd1306_flush(const uint8_t *fb, ssd1306_dirty_t *dirty)
 {
-    uint8_t font_idx;
-    uint8_t col;
-    uint8_t row;
-    uint8_t line_top;
-    uint8_t line_bottom;
+    return ssd1306_flush_range(fb, dirty, 0, SSD1306_PAGES - 1, true);
+}
 
-    /* Validate printable ASCII range */
+#ifdef CONFIG_MAIA_SSD1306_DOUBLE_BUFFER
 
-    if (ch < FONT_FIRST_CHAR || ch > FONT_LAST_CHAR)
+/**
+ * @brief Flush task: sends the handed-over buffer, then signals idle
+ *
+ * @param[in] arg Unused
+ */
+static void ssd1306_flush_task(void *arg)
+{
+    (void)arg;
+
+    for (;;)
     {
-        return;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        g_flush_result = ssd1306_flush(g_tx_buffer, &g_tx_dirty);
+        xSemaphoreGive(g_flush_idle);
     }
+}
 
-    font_idx = ch - FONT_FIRST_CHAR;
+#endif /* CONFIG_MAIA_SSD1306_DOUBLE_BUFFER */
 
-    /* Draw each column of the character (8 columns) */
+/**
+ * @brief OR a run of glyph columns into one framebuffer page
+ *
+ * Writes straight into the framebuffer byte of each column; the page is
+ * marked dirty once, over the columns that really changed.
+ *
+ * @param[in] page Destination page (0 to SSD1306_PAGES - 1)
+ * @param[in] x First destination column
+ * @param[in] src Glyph column bytes (bit 0 = top row)
+ * @param[in] width Number of columns (already clipped to the screen)
+ * @param[in] shift Left shift (> 0, moves rows down) or right shift (< 0)
+ */
+static void ssd1306_or_columns(uint8_t page, uint8_t x, const uint8_t *src,
+                               uint8_t width, int8_t shift)
+{
+    uint8_t *dst = &g_framebuffer[page * SSD1306_WIDTH + x];
+    uint8_t first = SSD1306_WIDTH;
+    uint8_t last = 0;
 
-    for (col = 0; col < FONT_8X16_WIDTH; col++)
+    for (uint8_t col = 0; col < width; col++)
     {
-        line_top = g_font8x16[font_idx][col];
-        line_bottom = g_font8x16[font_idx][col + 8];
+        uint8_t bits = (shift >= 0) ? (uint8_t)(src[col] << shift) :
+                                      (uint8_t)(src[col] >> -shift);
 
-        /* Top 8 rows */
-
-        for (row = 0; row < 8; row++)
+        if ((dst[col] | bits) != dst[col])
         {
-            if (line_top & (1 << row))
+            dst[col] |= bits;
+            if (first == SSD1306_WIDTH)
             {
-                ssd1306_set_pixel(x + col, y + row, true);
+                first = col;
             }
+
+            last = col;
         }
+    }
 
-        /* Bottom 8 rows */
+    if (first != SSD1306_WIDTH)
+    {
+        ssd1306_mark_dirty(&g_dirty, page, x + first, x + last);
+    }
+}
 
-        for (row = 0; row < 8; row++)
+/**
+ * @brief Blit a page-organized glyph into the framebuffer (OR, clipped)
+ *
+ * Glyph bytes are stored one 8-row band after the other, width columns
+ * per band, same layout as the framebuffer. A band drawn at a
+ * page-aligned y maps to one framebuffer page; otherwise it straddles
+ * two pages and is split with a shift in each direction.
+ *
+ * @param[in] x X coordinate (pixels, < SSD1306_WIDTH)
+ * @param[in] y Y coordinate (pixels, < SSD1306_HEIGHT)
+ * @param[in] glyph Glyph column bytes
+ * @param[in] width Glyph width in columns
+ * @param[in] bands Glyph height in 8-row bands
+ */
+static void ssd1306_blit_glyph(uint8_t x, uint8_t y, const uint8_t *glyph,
+                               uint8_t width, uint8_t bands)
+{
+    uint8_t page = y / 8;
+    uint8_t shift = y % 8;
+    uint8_t visible = width;
+
+    /* Clip columns at the right edge */
+
+    if (x + visible > SSD1306_WIDTH)
+    {
+        visible = SSD1306_WIDTH - x;
+    }
+
+    for (uint8_t band = 0; band < bands; band++, page++)
+    {
+        const uint8_t *src = &glyph[band * width];
+
+        if (page >= SSD1306_PAGES)
         {
-            if (line_bottom & (1 << row))
-            {
-                ssd1306_set_pixel(x + col, y + row + 8, true);
-            }
+            break;  /* Clipped at the bottom edge */
         }
+
+        ssd1306_or_columns(page, x, src, visible, shift);
+
+        if (shift != 0 && page + 1 < SSD1306_PAGES)
+        {
+            ssd1306_or_columns(page + 1, x, src, visible, shift - 8);
+        }
+    }
+}
+
+/**
+ * @brief Draw single character using 5x8 font
+ *
+ * @param[in] x X coordinate (pixels)
+ * @param[in] y Y coordinate (pixels)
+ * @param[in] ch ASCII character (0x20-0x7E)
+ */
+static void ssd1306_draw_char_5x8(uint8_t x, uint8_t y, char ch)
+{
+    /* Validate printable ASCII range */
+
+    if (ch < FONT_FIRST_CHAR || ch > FONT_LAST_CHAR)
+    {
+        return;
     }
+
+    ssd1306_blit_glyph(x, y, g_font5x8[ch - FONT_FIRST_CHAR],
+                       FONT_5X8_WIDTH, FONT_5X8_HEIGHT / 8);
+}
+
+/**
+ * @brief Draw single character using 8x16 font
+ *
+ * @param[in] x X coordinate (pixels)
+ * @param[in] y Y coordinate (pixels)
+ * @param[in] ch ASCII character (0x20-0x7E)
+ */
+static void ssd1306_draw_char_8x16(uint8_t x, uint8_t y, char ch)
+{
+    /* Validate printable ASCII range */
+
+    if (ch < FONT_FIRST_CHAR || ch > FONT_LAST_CHAR)
+    {
+        return;
+    }
+
+    /* Font rows 0-7 are bytes 0-7, rows 8-15 are bytes 8-15 */
+
+    ssd1306_blit_glyph(x, y, g_font8x16[ch - FONT_FIRST_CHAR],
+                       FONT_8X16_WIDTH, FONT_8X16_HEIGHT / 8);
 }
 
 /****************************************************************************
@@ -696,30 +1112,21 @@ static void ssd1306_draw_char_8x16(uint8_t x, uint8_t y, char ch)
 esp_err_t ssd1306_init(void)
 {
     esp_err_t ret;
-    i2c_master_bus_handle_t bus_handle;
-    i2c_device_config_t dev_cfg;
+    maia_i2c_dev_config_t dev_cfg;
 
     ESP_LOGI(TAG, "Initializing SSD1306 OLED display (%dx%d)",
              SSD1306_WIDTH, SSD1306_HEIGHT);
 
-    /* Get I2C bus handle from maia_board */
-
-    bus_handle = maia_i2c_get_bus_handle();
-    if (bus_handle == NULL)
-    {
-        ESP_LOGE(TAG, "I2C bus not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    /* Configure I2C device */
+    /* Register with the I2C arbiter (lowest priority, splittable) */
 
     memset(&dev_cfg, 0, sizeof(dev_cfg));
-    dev_cfg.dev_addr_length = I2C_ADDR_BIT_LEN_7;
-    dev_cfg.device_address = SSD1306_I2C_ADDR;
-    dev_cfg.scl_speed_hz = CONFIG_MAIA_I2C_FREQ_HZ;
+    dev_cfg.name = "ssd1306";
+    dev_cfg.addr = SSD1306_I2C_ADDR;
+    dev_cfg.bus = MAIA_I2C_BUS_SSD1306;
+    dev_cfg.prio = MAIA_I2C_PRIO_DISPLAY;
+    dev_cfg.splittable = true;
 
-    ret = i2c_master_bus_add_device(bus_handle, &dev_cfg,
-                                    &g_ssd1306_handle);
+    ret = maia_i2c_add_device(&dev_cfg, &g_ssd1306_handle);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to add I2C device: %s",
@@ -729,74 +1136,137 @@ esp_err_t ssd1306_init(void)
 
     ESP_LOGI(TAG, "I2C device configured @ 0x%02X", SSD1306_I2C_ADDR);
 
-    /* Hardware initialization sequence (SSD1306 datasheet) */
-
-    ssd1306_write_command(SSD1306_CMD_DISPLAY_OFF);
+    /* Hardware initialization sequence (SSD1306 datasheet) as one
+     * command stream transaction
+     */
 
-    ssd1306_write_command(SSD1306_CMD_SET_DISPLAY_CLK_DIV);
-    ssd1306_write_command(0x80);  /* Default oscillator frequency */
-
-    ssd1306_write_command(SSD1306_CMD_SET_MULTIPLEX);
-    ssd1306_write_command(SSD1306_HEIGHT - 1);  /* 31 for 32 lines */
+    ret = ssd1306_write_command_list(g_init_sequence,
+                                     sizeof(g_init_sequence));
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Init sequence failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
 
-    ssd1306_write_command(SSD1306_CMD_SET_DISPLAY_OFFSET);
-    ssd1306_write_command(0x00);  /* No vertical offset */
+    ESP_LOGI(TAG, "Hardware initialization complete");
 
-    ssd1306_write_command(SSD1306_CMD_SET_START_LINE | 0x00);
+    /* Clear framebuffer and display (GDDRAM content is unknown after
+     * power-up, so the first flush sends every page)
+     */
 
-    ssd1306_write_command(SSD1306_CMD_CHARGE_PUMP);
-    ssd1306_write_command(0x14);  /* Enable charge pump */
+    memset(g_framebuffers, 0, sizeof(g_framebuffers));
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        ssd1306_mark_dirty(&g_dirty, page, 0, SSD1306_WIDTH - 1);
+    }
 
-    ssd1306_write_command(SSD1306_CMD_MEMORY_MODE);
-    ssd1306_write_command(0x00);  /* Horizontal addressing mode */
+#ifdef CONFIG_MAIA_SSD1306_DOUBLE_BUFFER
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        ssd1306_mark_clean(&g_tx_dirty, page);
+    }
 
-    /* Apply rotation configuration */
+    if (g_flush_idle == NULL)
+    {
+        g_flush_idle = xSemaphoreCreateBinaryStatic(&g_flush_idle_buf);
+        if (g_flush_idle == NULL ||
+            xTaskCreatePinnedToCore(ssd1306_flush_task, "ssd1306_flush",
+                                    SSD1306_FLUSH_STACK_SIZE, NULL,
+                                    SSD1306_FLUSH_PRIORITY, &g_flush_task,
+                                    MAIA_CORE_UI) != pdPASS)
+        {
+            ESP_LOGE(TAG, "Failed to create flush task");
+            return ESP_ERR_NO_MEM;
+        }
 
-#ifdef CONFIG_MAIA_SSD1306_ROTATION_180
-    ssd1306_write_command(SSD1306_CMD_SEG_REMAP | 0x00);  /* No remap */
-    ssd1306_write_command(SSD1306_CMD_COM_SCAN_INC);      /* Normal scan */
-#else
-    ssd1306_write_command(SSD1306_CMD_SEG_REMAP | 0x01);  /* Remap */
-    ssd1306_write_command(SSD1306_CMD_COM_SCAN_DEC);      /* Reverse */
+        xSemaphoreGive(g_flush_idle);
+    }
 #endif
 
-    ssd1306_write_command(SSD1306_CMD_SET_COMPINS);
-    ssd1306_write_command(0x02);  /* Sequential COM, no remap */
-
-    /* Set contrast from Kconfig */
-
-    ssd1306_write_command(SSD1306_CMD_SET_CONTRAST);
-    ssd1306_write_command(CONFIG_MAIA_SSD1306_CONTRAST);
+    ssd1306_display();
 
-    ssd1306_write_command(SSD1306_CMD_SET_PRECHARGE);
-    ssd1306_write_command(0xF1);  /* Phase 1: 15 clocks, Phase 2: 1 */
+    ESP_LOGI(TAG, "SSD1306 initialization successful");
 
-    ssd1306_write_command(SSD1306_CMD_SET_VCOMH_DESELECT);
-    ssd1306_write_command(0x40);  /* 0.77 * VCC */
+    return ESP_OK;
+}
 
-    ssd1306_write_command(SSD1306_CMD_DISPLAY_ALL_ON_RESUME);
-    ssd1306_write_command(SSD1306_CMD_NORMAL_DISPLAY);
+/**
+ * @brief Clear framebuffer (set all pixels OFF)
+ */
+esp_err_t ssd1306_clear(void)
+{
+    /* Only columns that had pixels set become dirty */
 
-    ssd1306_write_command(SSD1306_CMD_DISPLAY_ON);
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        uint8_t *row = &g_framebuffer[page * SSD1306_WIDTH];
 
-    ESP_LOGI(TAG, "Hardware initialization complete");
+        for (uint8_t x = 0; x < SSD1306_WIDTH; x++)
+        {
+            if (row[x] != 0)
+            {
+                ssd1306_mark_dirty(&g_dirty, page, x, x);
+                row[x] = 0;
+            }
+        }
+    }
 
-    /* Clear framebuffer and display */
+    return ESP_OK;
+}
 
-    ssd1306_clear();
-    ssd1306_display();
+/**
+ * @brief Copy the framebuffer out (e.g. to cache a rendered screen)
+ */
+esp_err_t ssd1306_save_framebuffer(uint8_t *dst)
+{
+    if (dst == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    ESP_LOGI(TAG, "SSD1306 initialization successful");
+    memcpy(dst, g_framebuffer, SSD1306_BUFFER_SIZE);
 
     return ESP_OK;
 }
 
 /**
- * @brief Clear framebuffer (set all pixels OFF)
+ * @brief Replace the framebuffer contents, marking only changed spans
  */
-esp_err_t ssd1306_clear(void)
+esp_err_t ssd1306_load_framebuffer(const uint8_t *src)
 {
-    memset(g_framebuffer, 0, SSD1306_BUFFER_SIZE);
+    if (src == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        uint8_t *row = &g_framebuffer[page * SSD1306_WIDTH];
+        const uint8_t *in = &src[page * SSD1306_WIDTH];
+        uint8_t x0 = 0;
+        uint8_t x1 = SSD1306_WIDTH - 1;
+
+        /* Trim identical columns on both ends of the page */
+
+        while (x0 < SSD1306_WIDTH && row[x0] == in[x0])
+        {
+            x0++;
+        }
+
+        if (x0 == SSD1306_WIDTH)
+        {
+            continue;  /* Page identical */
+        }
+
+        while (row[x1] == in[x1])
+        {
+            x1--;
+        }
+
+        memcpy(&row[x0], &in[x0], x1 - x0 + 1);
+        ssd1306_mark_dirty(&g_dirty, page, x0, x1);
+    }
+
     return ESP_OK;
 }
 
@@ -805,40 +1275,96 @@ esp_err_t ssd1306_clear(void)
  */
 esp_err_t ssd1306_display(void)
 {
+#ifdef CONFIG_MAIA_SSD1306_DOUBLE_BUFFER
     esp_err_t ret;
+    uint8_t *next;
+    bool dirty = false;
 
-    /* Set column address range (0-127) */
+    /* Wait for the previous frame to leave the bus */
 
-    ret = ssd1306_write_command(SSD1306_CMD_COLUMN_ADDR);
-    if (ret != ESP_OK) return ret;
+    xSemaphoreTake(g_flush_idle, portMAX_DELAY);
+    ret = g_flush_result;
 
-    ret = ssd1306_write_command(0);  /* Column start */
-    if (ret != ESP_OK) return ret;
+    /* Pages the previous flush could not send are re-sent with this one
+     * (the draw buffer holds the same or newer content there)
+     */
 
-    ret = ssd1306_write_command(SSD1306_WIDTH - 1);  /* Column end */
-    if (ret != ESP_OK) return ret;
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        if (g_tx_dirty.x0[page] <= g_tx_dirty.x1[page])
+        {
+            ssd1306_mark_dirty(&g_dirty, page, g_tx_dirty.x0[page],
+                               g_tx_dirty.x1[page]);
+        }
 
-    /* Set page address range (0-3 for 32-line display) */
+        dirty |= (g_dirty.x0[page] <= g_dirty.x1[page]);
+    }
 
-    ret = ssd1306_write_command(SSD1306_CMD_PAGE_ADDR);
-    if (ret != ESP_OK) return ret;
+    if (!dirty)
+    {
+        xSemaphoreGive(g_flush_idle);
+        return ret;
+    }
 
-    ret = ssd1306_write_command(0);  /* Page start */
-    if (ret != ESP_OK) return ret;
+    /* Swap: the drawn frame goes to the flush task. The other buffer is
+     * brought up to date by copying only the dirty spans, which keeps
+     * both buffers identical outside of what changes next.
+     */
 
-    ret = ssd1306_write_command((SSD1306_HEIGHT / 8) - 1);  /* Page end */
-    if (ret != ESP_OK) return ret;
+    next = (g_framebuffer == g_framebuffers[0]) ? g_framebuffers[1] :
+                                                  g_framebuffers[0];
 
-    /* Transmit entire framebuffer */
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
+    {
+        uint8_t x0 = g_dirty.x0[page];
+        uint8_t x1 = g_dirty.x1[page];
 
-    ret = ssd1306_write_data(g_framebuffer, SSD1306_BUFFER_SIZE);
-    if (ret != ESP_OK)
+        if (x0 <= x1)
+        {
+            uint16_t offset = page * SSD1306_WIDTH + x0;
+
+            memcpy(&next[offset], &g_framebuffer[offset], x1 - x0 + 1);
+        }
+    }
+
+    g_tx_buffer = g_framebuffer;
+    g_tx_dirty = g_dirty;
+    g_framebuffer = next;
+
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++)
     {
-        ESP_LOGE(TAG, "Failed to write framebuffer to display");
-        return ret;
+        ssd1306_mark_clean(&g_dirty, page);
+    }
+
+    xTaskNotifyGive(g_flush_task);
+
+    return ret;
+#else
+    return ssd1306_flush(g_framebuffer, &g_dirty);
+#endif
+}
+
+/**
+ * @brief Wait until the last flush has reached the display
+ */
+esp_err_t ssd1306_display_wait(void)
+{
+#ifdef CONFIG_MAIA_SSD1306_DOUBLE_BUFFER
+    esp_err_t ret;
+
+    if (g_flush_idle == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
     }
 
+    xSemaphoreTake(g_flush_idle, portMAX_DELAY);
+    ret = g_flush_result;
+    xSemaphoreGive(g_flush_idle);
+
+    return ret;
+#else
     return ESP_OK;
+#endif
 }
 
 /**
@@ -848,6 +1374,7 @@ esp_err_t ssd1306_set_pixel(uint8_t x, uint8_t y, bool on)
 {
     uint16_t byte_idx;
     uint8_t bit_idx;
+    uint8_t value;
 
     /* Validate coordinates */
 
@@ -861,20 +1388,68 @@ esp_err_t ssd1306_set_pixel(uint8_t x, uint8_t y, bool on)
     byte_idx = x + (y / 8) * SSD1306_WIDTH;
     bit_idx = y % 8;
 
-    /* Set or clear bit */
+    /* Set or clear bit, marking the column dirty only on a real change */
 
     if (on)
     {
-        g_framebuffer[byte_idx] |= (1 << bit_idx);
+        value = g_framebuffer[byte_idx] | (1 << bit_idx);
     }
     else
     {
-        g_framebuffer[byte_idx] &= ~(1 << bit_idx);
+        value = g_framebuffer[byte_idx] & ~(1 << bit_idx);
+    }
+
+    if (value != g_framebuffer[byte_idx])
+    {
+        g_framebuffer[byte_idx] = value;
+        ssd1306_mark_dirty(&g_dirty, y / 8, x, x);
     }
 
     return ESP_OK;
 }
 
+/**
+ * @brief Overwrite a run of column bytes of one page
+ */
+esp_err_t ssd1306_write_page(uint8_t page, uint8_t x, const uint8_t *src,
+                             uint8_t width)
+{
+    uint8_t *row;
+    uint8_t x0 = 0;
+    uint8_t x1;
+
+    if (src == NULL || page >= SSD1306_PAGES || x >= SSD1306_WIDTH ||
+        width == 0 || width > SSD1306_WIDTH - x)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    row = &g_framebuffer[page * SSD1306_WIDTH + x];
+    x1 = width - 1;
+
+    /* Trim identical columns on both ends, as a framebuffer load */
+
+    while (x0 < width && row[x0] == src[x0])
+    {
+        x0++;
+    }
+
+    if (x0 == width)
+    {
+        return ESP_OK;  /* Run identical */
+    }
+
+    while (row[x1] == src[x1])
+    {
+        x1--;
+    }
+
+    memcpy(&row[x0], &src[x0], x1 - x0 + 1);
+    ssd1306_mark_dirty(&g_dirty, page, x + x0, x + x1);
+
+    return ESP_OK;
+}
+
 /**
  * @brief Draw single ASCII character at specified position
  */
@@ -1001,15 +1576,30 @@ esp_err_t ssd1306_screen_off(void)
 esp_err_t ssd1306_set_contrast(uint8_t contrast)
 {
     esp_err_t ret;
+    const uint8_t cmds[2] = {SSD1306_CMD_SET_CONTRAST, contrast};
 
-    ret = ssd1306_write_command(SSD1306_CMD_SET_CONTRAST);
-    if (ret != ESP_OK) return ret;
-
-    ret = ssd1306_write_command(contrast);
+    ret = ssd1306_write_command_list(cmds, sizeof(cmds));
     if (ret == ESP_OK)
     {
+        g_contrast = contrast;
         ESP_LOGI(TAG, "Contrast set to %d", contrast);
     }
 
     return ret;
 }
+
+/**
+ * @brief Enter or leave the idle (dimmed) state
+ */
+esp_err_t ssd1306_set_idle(bool idle)
+{
+    const uint8_t cmds[4] =
+    {
+        SSD1306_CMD_SET_DISPLAY_CLK_DIV,
+        idle ? SSD1306_CLK_DIV_IDLE : SSD1306_CLK_DIV_NORMAL,
+        SSD1306_CMD_SET_CONTRAST,
+        idle ? CONFIG_MAIA_SSD1306_IDLE_CONTRAST : g_contrast,
+    };
+
+    return ssd1306_write_command_list(cmds, sizeof(cmds));
+}
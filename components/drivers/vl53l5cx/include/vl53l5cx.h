@@ -1,7 +1,27 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
 /****************************************************************************
  * components/drivers/vl53l5cx/include/vl53l5cx.h
  *
- * SPDX-License-Identifier: Apache-2.0
+ * VL53L5CX 8x8 multizone Time-of-Flight sensor driver
+ * Two sensors (left/right) on the shared I2C bus, interrupt driven.
+ *
+ * Reference: UM2884 - A guide to using the VL53L5CX multizone ToF sensor
+ * https://www.st.com/resource/en/user_manual/um2884.pdf
  *
  ****************************************************************************/
 
@@ -12,26 +32,245 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <esp_err.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Maximum number of zones per frame (8x8 resolution) */
+
+#define VL53L5CX_NB_ZONES_MAX       64
+
+/* Distance reported for zones rejected by the target status filter.
+ * Chosen as the largest value so sector minima ignore it naturally.
+ */
+
+#define VL53L5CX_DISTANCE_INVALID   INT16_MAX
+
+/* Target status codes
+ * UM2884 Table 4 (Target status)
+ */
+
+#define VL53L5CX_TARGET_STATUS_VALID          5   /* Range valid */
+#define VL53L5CX_TARGET_STATUS_NO_WRAP_CHECK  6   /* Wrap-around not done */
+#define VL53L5CX_TARGET_STATUS_VALID_LARGE    9   /* Valid, large pulse */
+#define VL53L5CX_TARGET_STATUS_NO_TARGET      255 /* No target detected */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Sensor instance (TOF1 = left, TOF2 = right) */
+
+typedef enum
+{
+  VL53L5CX_SENSOR_LEFT = 0,
+  VL53L5CX_SENSOR_RIGHT,
+  VL53L5CX_SENSOR_COUNT,
+} vl53l5cx_sensor_t;
+
+/* Ranging resolution (value = number of zones) */
+
+typedef enum
+{
+  VL53L5CX_RESOLUTION_4X4 = 16,
+  VL53L5CX_RESOLUTION_8X8 = 64,
+} vl53l5cx_resolution_t;
+
+/* One ranging frame, already filtered by target status.
+ * Zone index 0 is the top-left zone as seen by the sensor.
+ */
+
+typedef struct
+{
+  int16_t  distance_mm[VL53L5CX_NB_ZONES_MAX];     /* Filtered distance */
+  uint16_t signal_kcps[VL53L5CX_NB_ZONES_MAX];     /* Signal per SPAD */
+  uint8_t  target_status[VL53L5CX_NB_ZONES_MAX];   /* Raw target status */
+  uint8_t  nb_zones;                               /* 16 or 64 */
+  uint8_t  valid_zones;                            /* Zones that passed */
+  uint8_t  stream_count;                           /* Sensor frame counter */
+  vl53l5cx_sensor_t sensor;                        /* Source sensor */
+  uint32_t sequence;                               /* Driver frame counter */
+  int64_t  int_time_us;                            /* INT edge timestamp */
+  int64_t  read_done_us;                           /* I2C read completed */
+} vl53l5cx_frame_t;
+
+/* Per-sensor counters */
+
+typedef struct
+{
+  uint32_t frames;          /* Frames read and published */
+  uint32_t dropped;         /* Frames skipped (frame pool empty) */
+  uint32_t i2c_errors;      /* Failed frame reads */
+  uint32_t reconfigs;       /* Profile changes applied */
+  uint32_t reconfig_max_us; /* Longest stop-configure-start gap */
+} vl53l5cx_stats_t;
+
+/* Frame-ready callback.
+ * Called from the driver reader task (not ISR context) right after a new
+ * frame has been published. Keep it short: typically a task notification.
+ */
+
+typedef void (*vl53l5cx_frame_cb_t)(vl53l5cx_sensor_t sensor, void *arg);
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /****************************************************************************
  * Name: vl53l5cx_init
  *
  * Description:
- *   Initialize the vl53l5cx driver.
+ *   Bring up both VL53L5CX sensors: LPn sequencing and I2C re-addressing,
+ *   firmware upload, NVM offset/crosstalk calibration and ranging
+ *   configuration (resolution and frequency from Kconfig). Installs the
+ *   INT pin handlers and starts the reader task. Ranging is not started.
  *
  * Input Parameters:
  *   None
  *
  * Returned Value:
- *   ESP_OK on success; ESP_FAIL on failure.
+ *   ESP_OK on success; error code otherwise
+ *
+ * Reference:
+ *   UM2884 Section 4.2 (Initialization)
  *
  ****************************************************************************/
 
 esp_err_t vl53l5cx_init(void);
 
+/****************************************************************************
+ * Name: vl53l5cx_start_ranging
+ *
+ * Description:
+ *   Start continuous ranging on both sensors. Each new frame asserts the
+ *   sensor INT pin, the reader task reads it and publishes it.
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_start_ranging(void);
+
+/****************************************************************************
+ * Name: vl53l5cx_stop_ranging
+ *
+ * Description:
+ *   Stop ranging on both sensors.
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_stop_ranging(void);
+
+/****************************************************************************
+ * Name: vl53l5cx_set_profile
+ *
+ * Description:
+ *   Change resolution and ranging frequency of both sensors at run time.
+ *   The change is applied by the reader task between frames, one sensor
+ *   at a time, so the other sensor keeps delivering frames and every
+ *   published frame is complete (nb_zones tells the resolution). Each
+ *   sensor stops for one reconfiguration (tens of ms). Requests made
+ *   while a change is running are merged: the latest one wins.
+ *
+ * Input Parameters:
+ *   resolution - VL53L5CX_RESOLUTION_4X4 or VL53L5CX_RESOLUTION_8X8
+ *   freq_hz    - Ranging frequency: 1-15 Hz in 8x8, 1-60 Hz in 4x4
+ *
+ * Returned Value:
+ *   ESP_OK if the change was queued; ESP_ERR_INVALID_ARG for an
+ *   unsupported combination; ESP_ERR_INVALID_STATE before init
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_set_profile(vl53l5cx_resolution_t resolution,
+                               uint8_t freq_hz);
+
+/****************************************************************************
+ * Name: vl53l5cx_set_frame_callback
+ *
+ * Description:
+ *   Register the frame-ready callback (NULL to unregister).
+ *
+ * Input Parameters:
+ *   callback - Function called when a frame is published
+ *   arg      - User argument passed to callback
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_set_frame_callback(vl53l5cx_frame_cb_t callback,
+                                      void *arg);
+
+/****************************************************************************
+ * Name: vl53l5cx_acquire_frame
+ *
+ * Description:
+ *   Get the latest published frame of a sensor without touching the bus.
+ *   The frame stays valid until vl53l5cx_release_frame() is called; while
+ *   it is held the reader keeps publishing newer frames in other blocks
+ *   of the frame pool.
+ *
+ * Input Parameters:
+ *   sensor - Sensor instance
+ *   frame  - Pointer to receive the frame pointer
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if no frame was published yet;
+ *   ESP_ERR_INVALID_STATE if a frame of this sensor is already held
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_acquire_frame(vl53l5cx_sensor_t sensor,
+                                 const vl53l5cx_frame_t **frame);
+
+/****************************************************************************
+ * Name: vl53l5cx_release_frame
+ *
+ * Description:
+ *   Release a frame obtained with vl53l5cx_acquire_frame().
+ *
+ * Input Parameters:
+ *   sensor - Sensor instance
+ *
+ ****************************************************************************/
+
+void vl53l5cx_release_frame(vl53l5cx_sensor_t sensor);
+
+/****************************************************************************
+ * Name: vl53l5cx_get_stats
+ *
+ * Description:
+ *   Read per-sensor frame counters.
+ *
+ * Input Parameters:
+ *   sensor - Sensor instance
+ *   stats  - Pointer to store counters
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_get_stats(vl53l5cx_sensor_t sensor,
+                             vl53l5cx_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __COMPONENTS_DRIVERS_VL53L5CX_INCLUDE_VL53L5CX_H */
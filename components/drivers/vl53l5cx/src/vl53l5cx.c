@@ -1,7 +1,40 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
 /****************************************************************************
  * components/drivers/vl53l5cx/src/vl53l5cx.c
  *
- * SPDX-License-Identifier: Apache-2.0
+ * VL53L5CX multizone ToF driver implementation
+ *
+ * The register-level boot, calibration and ranging sequences follow ST's
+ * Ultra Lite Driver (ULD, STSW-IMG023). The firmware image and default
+ * configuration blobs are ST property and are not part of this tree: copy
+ * vl53l5cx_buffers.h from the ULD package into vl53l5cx/uld/.
+ *
+ * Frame pipeline:
+ *   INT falling edge -> ISR (timestamp + task notify)
+ *   -> reader task (one I2C read per frame, parse, status filter)
+ *   -> frame pool block published as the latest -> frame callback
+ *
+ * Profile changes (vl53l5cx_set_profile) are applied by the reader task
+ * between frames, one sensor at a time: stop, configure, start. The other
+ * sensor keeps ranging meanwhile, and an INT latched before the restart
+ * is discarded by its timestamp, so no frame mixes two profiles.
+ *
+ * Reference: UM2884 - A guide to using the VL53L5CX multizone ToF sensor
  *
  ****************************************************************************/
 
@@ -10,28 +43,2248 @@
  ****************************************************************************/
 
 #include "vl53l5cx.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/gpio.h>
+#include <driver/i2c_master.h>
+#include <string.h>
+
+#if __has_include("vl53l5cx/uld/vl53l5cx_buffers.h")
+#  include "vl53l5cx/uld/vl53l5cx_buffers.h"
+#  define VL53L5CX_HAVE_ULD_BUFFERS 1
+#endif
 
 /****************************************************************************
- * Public Functions
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[VL53L5CX]"
+
+/* I2C parameters
+ * Kconfig addresses use ST 8-bit notation (0x52 = 7-bit 0x29)
+ */
+
+#define VL53L5CX_DEFAULT_ADDR       (0x52 >> 1)
+#define VL53L5CX_LEFT_ADDR          (MAIA_I2C_ADDR_TOF1 >> 1)
+#define VL53L5CX_RIGHT_ADDR         (MAIA_I2C_ADDR_TOF2 >> 1)
+#define VL53L5CX_I2C_TIMEOUT_MS     100
+#define VL53L5CX_BLOCK_TIMEOUT_MS   1000
+
+/* Firmware upload
+ * Block writes go straight from flash (no bounce buffer) in chunks of
+ * CHUNK_SIZE bytes; each chunk is one I2C transaction, which is what lets
+ * the other sensor's boot interleave on the shared bus.
+ */
+
+#define VL53L5CX_WR_CHUNK_SIZE      CONFIG_MAIA_VL53L5CX_UPLOAD_CHUNK_SIZE
+#define VL53L5CX_UPLOAD_FREQ_HZ     CONFIG_MAIA_VL53L5CX_UPLOAD_FREQ_HZ
+
+/* Ranging configuration from Kconfig */
+
+#ifdef CONFIG_MAIA_VL53L5CX_RESOLUTION_4X4
+#  define VL53L5CX_DEFAULT_RESOLUTION  VL53L5CX_RESOLUTION_4X4
+#else
+#  define VL53L5CX_DEFAULT_RESOLUTION  VL53L5CX_RESOLUTION_8X8
+#endif
+
+#define VL53L5CX_DEFAULT_FREQ_HZ    CONFIG_MAIA_VL53L5CX_RANGING_FREQ_HZ
+
+/* Maximum ranging frequency per resolution (UM2884 Section 5.5) */
+
+#define VL53L5CX_MAX_FREQ_8X8       15
+#define VL53L5CX_MAX_FREQ_4X4       60
+
+/* Reader task */
+
+#define VL53L5CX_TASK_STACK_SIZE    4096
+#define VL53L5CX_TASK_PRIORITY      (configMAX_PRIORITIES - 2)
+
+/* Parallel bring-up helper task (boots the right sensor) */
+
+#define VL53L5CX_BOOT_STACK_SIZE    4096
+#define VL53L5CX_BOOT_PRIORITY      (tskIDLE_PRIORITY + 5)
+
+/* Reader task notification: bits 0-1 = INT of sensor N */
+
+#define VL53L5CX_EVT_PROFILE        (1u << 31)
+
+/* Device registers and UI command area (ULD vl53l5cx_api.h) */
+
+#define VL53L5CX_REG_PAGE           0x7FFF
+#define VL53L5CX_UI_CMD_STATUS      0x2C00
+#define VL53L5CX_UI_CMD_START       0x2C04
+#define VL53L5CX_UI_CMD_END         0x2FFF
+
+/* Device identification (page 0, registers 0x00-0x01) */
+
+#define VL53L5CX_DEVICE_ID          0xF0
+#define VL53L5CX_REVISION_ID        0x02
+
+/* DCI (device configuration interface) indexes */
+
+#define VL53L5CX_DCI_ZONE_CONFIG    0x5450
+#define VL53L5CX_DCI_FREQ_HZ        0x5458
+#define VL53L5CX_DCI_RANGING_MODE   0xAD30
+#define VL53L5CX_DCI_DSS_CONFIG     0xAD38
+#define VL53L5CX_DCI_SINGLE_RANGE   0xD964
+#define VL53L5CX_DCI_OUTPUT_CONFIG  0xD968
+#define VL53L5CX_DCI_OUTPUT_ENABLES 0xD970
+#define VL53L5CX_DCI_OUTPUT_LIST    0xD980
+#define VL53L5CX_DCI_PIPE_CONTROL   0xDB80
+#define VL53L5CX_DCI_UI_RANGE_DATA  0x5440
+
+/* Calibration buffer sizes */
+
+#define VL53L5CX_NVM_DATA_SIZE      492
+#define VL53L5CX_OFFSET_BUFFER_SIZE 488
+#define VL53L5CX_XTALK_BUFFER_SIZE  776
+#define VL53L5CX_TEMP_BUFFER_SIZE   1024
+
+/* Output block headers: type[3:0] size[15:4] idx[31:16] */
+
+#define VL53L5CX_START_BH           0x0000000D
+#define VL53L5CX_METADATA_BH        0x54B400C0
+#define VL53L5CX_COMMONDATA_BH      0x54C00040
+#define VL53L5CX_NB_TARGET_BH       0xCF7C0401
+#define VL53L5CX_SIGNAL_RATE_BH     0xCFBC0404
+#define VL53L5CX_DISTANCE_BH        0xD33C0402
+#define VL53L5CX_TARGET_STATUS_BH   0xD47C0401
+
+#define VL53L5CX_BH_TYPE(bh)        ((bh) & 0x0F)
+#define VL53L5CX_BH_SIZE(bh)        (((bh) >> 4) & 0x0FFF)
+#define VL53L5CX_BH_IDX(bh)         ((uint16_t)((bh) >> 16))
+
+#define VL53L5CX_NB_TARGET_IDX      VL53L5CX_BH_IDX(VL53L5CX_NB_TARGET_BH)
+#define VL53L5CX_SIGNAL_RATE_IDX    VL53L5CX_BH_IDX(VL53L5CX_SIGNAL_RATE_BH)
+#define VL53L5CX_DISTANCE_IDX       VL53L5CX_BH_IDX(VL53L5CX_DISTANCE_BH)
+#define VL53L5CX_TARGET_STATUS_IDX  VL53L5CX_BH_IDX(VL53L5CX_TARGET_STATUS_BH)
+
+/* Output list slots enabled (bit n = entry n of the output list):
+ * start, metadata, common data, nb targets, signal, distance, status.
+ * Ambient, SPAD count, sigma, reflectance and motion are not read.
+ */
+
+#define VL53L5CX_OUTPUT_ENABLES     0x00000567
+
+/* Scale factors of raw output data (ULD vl53l5cx_get_ranging_data) */
+
+#define VL53L5CX_DISTANCE_SHIFT     2      /* Raw distance is mm * 4 */
+#define VL53L5CX_SIGNAL_SHIFT       11     /* Raw signal is kcps * 2048 */
+
+/* Frame pool: per sensor the latest published frame, the one held by
+ * the consumer and the one being read
+ */
+
+#define VL53L5CX_FRAME_BLOCKS       (VL53L5CX_SENSOR_COUNT * 3)
+
+/****************************************************************************
+ * Private Types
  ****************************************************************************/
 
+/* Register write step of a ULD init sequence */
+
+typedef struct
+{
+  uint16_t reg;
+  uint8_t value;
+} vl53l5cx_reg_val_t;
+
+/* Per-sensor state */
+
+typedef struct
+{
+  vl53l5cx_sensor_t id;
+  const char *name;
+  gpio_num_t lpn_pin;
+  gpio_num_t int_pin;
+  uint16_t i2c_addr;
+  maia_i2c_dev_handle_t dev;
+  maia_i2c_dev_handle_t dev_upload;     /* FM+ handle, upload only */
+
+  /* Ranging configuration */
+
+  vl53l5cx_resolution_t resolution;
+  uint8_t freq_hz;
+  uint16_t data_read_size;
+  bool ranging;
+  int64_t start_us;                     /* Ranging (re)started */
+
+  /* Frame pipeline: pool blocks, front/held protected by g_frame_lock
+   * (the same block while the consumer holds the latest frame)
+   */
+
+  volatile int64_t int_time_us;
+  vl53l5cx_frame_t *front;
+  vl53l5cx_frame_t *held;
+  uint32_t sequence;
+  vl53l5cx_stats_t stats;
+
+  /* Calibration data and transfer buffers */
+
+  uint8_t offset_data[VL53L5CX_OFFSET_BUFFER_SIZE];
+  uint8_t xtalk_data[VL53L5CX_XTALK_BUFFER_SIZE];
+  uint8_t temp[VL53L5CX_TEMP_BUFFER_SIZE] __attribute__((aligned(4)));
+
+  /* Bring-up */
+
+  esp_err_t boot_result;
+  int64_t boot_time_us;
+} vl53l5cx_dev_t;
+
 /****************************************************************************
- * Name: vl53l5cx_init
+ * Private Data
+ ****************************************************************************/
+
+static vl53l5cx_dev_t g_sensors[VL53L5CX_SENSOR_COUNT] =
+{
+  [VL53L5CX_SENSOR_LEFT] =
+    {
+      .id = VL53L5CX_SENSOR_LEFT,
+      .name = "left",
+      .lpn_pin = MAIA_GPIO_TOF1_LPN,
+      .int_pin = MAIA_GPIO_TOF1_INT,
+      .i2c_addr = VL53L5CX_LEFT_ADDR,
+    },
+  [VL53L5CX_SENSOR_RIGHT] =
+    {
+      .id = VL53L5CX_SENSOR_RIGHT,
+      .name = "right",
+      .lpn_pin = MAIA_GPIO_TOF2_LPN,
+      .int_pin = MAIA_GPIO_TOF2_INT,
+      .i2c_addr = VL53L5CX_RIGHT_ADDR,
+    },
+};
+
+static bool g_initialized = false;
+static int64_t g_init_start_us = 0;
+static TaskHandle_t g_reader_task = NULL;
+static TaskHandle_t g_init_task = NULL;
+static vl53l5cx_frame_cb_t g_frame_cb = NULL;
+static void *g_frame_cb_arg = NULL;
+static portMUX_TYPE g_frame_lock = portMUX_INITIALIZER_UNLOCKED;
+
+MAIA_POOL_DEFINE(g_frame_pool, vl53l5cx_frame_t, VL53L5CX_FRAME_BLOCKS);
+
+/* Requested ranging profile (g_frame_lock) */
+
+static vl53l5cx_resolution_t g_profile_res = VL53L5CX_DEFAULT_RESOLUTION;
+static uint8_t g_profile_freq_hz = VL53L5CX_DEFAULT_FREQ_HZ;
+
+/****************************************************************************
+ * Private Functions: Platform Layer
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_wait_ms
+ *
+ * Description:
+ *   Sleep at least one tick (pdMS_TO_TICKS rounds down at 100 Hz).
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_wait_ms(uint32_t ms)
+{
+  TickType_t ticks = pdMS_TO_TICKS(ms);
+
+  vTaskDelay(ticks > 0 ? ticks : 1);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_wr_byte
  *
  * Description:
- *   Initialize the vl53l5cx driver.
+ *   Write one byte to a 16-bit register address.
  *
- * Input Parameters:
- *   None
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_wr_byte(vl53l5cx_dev_t *s, uint16_t reg,
+                                  uint8_t value)
+{
+  uint8_t buf[3] = {reg >> 8, reg & 0xFF, value};
+
+  return maia_i2c_transmit(s->dev, buf, sizeof(buf),
+                           VL53L5CX_I2C_TIMEOUT_MS);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_rd_multi
  *
- * Returned Value:
- *   ESP_OK on success; ESP_FAIL on failure.
+ * Description:
+ *   Read a block starting at a 16-bit register address (auto-increment).
  *
  ****************************************************************************/
 
-esp_err_t vl53l5cx_init(void)
+static esp_err_t vl53l5cx_rd_multi(vl53l5cx_dev_t *s, uint16_t reg,
+                                   uint8_t *data, size_t len)
+{
+  uint8_t addr[2] = {reg >> 8, reg & 0xFF};
+
+  return maia_i2c_transmit_receive(s->dev, addr, sizeof(addr), data, len,
+                                   VL53L5CX_I2C_TIMEOUT_MS);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_rd_byte
+ *
+ * Description:
+ *   Read one byte from a 16-bit register address.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_rd_byte(vl53l5cx_dev_t *s, uint16_t reg,
+                                  uint8_t *value)
+{
+  return vl53l5cx_rd_multi(s, reg, value, 1);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_wr_block
+ *
+ * Description:
+ *   Write a block starting at a 16-bit register address. The device
+ *   auto-increments, so the block is sent in chunks with the address
+ *   advanced for each chunk. Address and payload go out as two buffers of
+ *   one transaction, so the payload is read in place (flash or RAM).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_wr_block(maia_i2c_dev_handle_t dev,
+                                   uint16_t reg, const uint8_t *data,
+                                   size_t len)
+{
+  esp_err_t ret;
+  uint8_t addr[2];
+
+  while (len > 0)
+    {
+      size_t n = (len > VL53L5CX_WR_CHUNK_SIZE) ?
+                 VL53L5CX_WR_CHUNK_SIZE : len;
+
+      addr[0] = reg >> 8;
+      addr[1] = reg & 0xFF;
+
+      ret = maia_i2c_transmit_prefixed(dev, addr, sizeof(addr), data, n,
+                                       VL53L5CX_BLOCK_TIMEOUT_MS);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+
+      reg += n;
+      data += n;
+      len -= n;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_wr_multi
+ *
+ * Description:
+ *   Block write on the regular (bus speed) device handle.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_wr_multi(vl53l5cx_dev_t *s, uint16_t reg,
+                                   const uint8_t *data, size_t len)
+{
+  return vl53l5cx_wr_block(s->dev, reg, data, len);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_swap_buffer
+ *
+ * Description:
+ *   Swap byte order of every 32-bit word (device streams big-endian).
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_swap_buffer(uint8_t *buf, size_t len)
+{
+  for (size_t i = 0; i + 3 < len; i += 4)
+    {
+      uint8_t b0 = buf[i];
+      uint8_t b1 = buf[i + 1];
+
+      buf[i] = buf[i + 3];
+      buf[i + 1] = buf[i + 2];
+      buf[i + 2] = b1;
+      buf[i + 3] = b0;
+    }
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_poll_for_answer
+ *
+ * Description:
+ *   Poll a register block until (data[pos] & mask) == expected.
+ *   Fails on timeout (2 s) or when the firmware reports an MCU error.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_poll_for_answer(vl53l5cx_dev_t *s, uint8_t size,
+                                          uint8_t pos, uint16_t reg,
+                                          uint8_t mask, uint8_t expected)
+{
+  esp_err_t ret;
+  uint8_t buf[4];
+
+  for (int timeout = 0; timeout < 200; timeout++)
+    {
+      ret = vl53l5cx_rd_multi(s, reg, buf, size);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+
+      if ((buf[pos] & mask) == expected)
+        {
+          return ESP_OK;
+        }
+
+      if (size >= 4 && buf[2] >= 0x7F)
+        {
+          ESP_LOGE(TAG, "%s: MCU error 0x%02X", s->name, buf[2]);
+          return ESP_ERR_INVALID_RESPONSE;
+        }
+
+      vl53l5cx_wait_ms(10);
+    }
+
+  ESP_LOGE(TAG, "%s: timeout polling 0x%04X", s->name, reg);
+  return ESP_ERR_TIMEOUT;
+}
+
+/****************************************************************************
+ * Private Functions: Device Configuration Interface
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_dci_read
+ *
+ * Description:
+ *   Read a DCI structure (size must be a multiple of 4).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_dci_read(vl53l5cx_dev_t *s, uint16_t index,
+                                   uint8_t *data, uint16_t size)
+{
+  esp_err_t ret;
+  uint16_t rd_size = size + 12;
+  uint8_t cmd[12] =
+    {
+      index >> 8, index & 0xFF, (size & 0xFF0) >> 4, (size & 0xF) << 4,
+      0x00, 0x00, 0x00, 0x0F, 0x00, 0x02, 0x00, 0x08,
+    };
+
+  if (rd_size > VL53L5CX_TEMP_BUFFER_SIZE)
+    {
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+  ret = vl53l5cx_wr_multi(s, VL53L5CX_UI_CMD_END - 11, cmd, sizeof(cmd));
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_poll_for_answer(s, 4, 1, VL53L5CX_UI_CMD_STATUS,
+                                 0xFF, 0x03);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_rd_multi(s, VL53L5CX_UI_CMD_START, s->temp, rd_size);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_swap_buffer(s->temp, rd_size);
+  memcpy(data, &s->temp[4], size);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_dci_write
+ *
+ * Description:
+ *   Write a DCI structure (size must be a multiple of 4).
+ *   Frame: 4-byte header + swapped payload + 8-byte footer, placed at the
+ *   end of the UI command area.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_dci_write(vl53l5cx_dev_t *s, uint16_t index,
+                                    const uint8_t *data, uint16_t size)
+{
+  esp_err_t ret;
+  uint16_t total = size + 12;
+  uint16_t address = VL53L5CX_UI_CMD_END - total + 1;
+  const uint8_t footer[8] =
+    {
+      0x00, 0x00, 0x00, 0x0F, 0x05, 0x01,
+      (size + 8) >> 8, (size + 8) & 0xFF,
+    };
+
+  if (total > VL53L5CX_TEMP_BUFFER_SIZE)
+    {
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+  s->temp[0] = index >> 8;
+  s->temp[1] = index & 0xFF;
+  s->temp[2] = (size & 0xFF0) >> 4;
+  s->temp[3] = (size & 0xF) << 4;
+  memcpy(&s->temp[4], data, size);
+  vl53l5cx_swap_buffer(&s->temp[4], size);
+  memcpy(&s->temp[4 + size], footer, sizeof(footer));
+
+  ret = vl53l5cx_wr_multi(s, address, s->temp, total);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  return vl53l5cx_poll_for_answer(s, 4, 1, VL53L5CX_UI_CMD_STATUS,
+                                  0xFF, 0x03);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_dci_replace
+ *
+ * Description:
+ *   Read-modify-write part of a DCI structure.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_dci_replace(vl53l5cx_dev_t *s, uint16_t index,
+                                      uint16_t size, const uint8_t *value,
+                                      uint16_t value_size, uint16_t pos)
 {
-  /* TODO: Implement vl53l5cx initialization */
+  esp_err_t ret;
+  uint8_t buf[16];
+
+  if (size > sizeof(buf) || pos + value_size > size)
+    {
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+  ret = vl53l5cx_dci_read(s, index, buf, size);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  memcpy(&buf[pos], value, value_size);
+
+  return vl53l5cx_dci_write(s, index, buf, size);
+}
+
+/****************************************************************************
+ * Private Functions: Calibration Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_average_signal_4x4 / vl53l5cx_average_range_4x4
+ *
+ * Description:
+ *   Reduce an 8x8 grid to 4x4 by averaging 2x2 blocks (in place), then
+ *   clear the unused tail. Used for offset/crosstalk in 4x4 resolution.
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_average_signal_4x4(uint32_t *grid)
+{
+  for (int j = 0; j < 4; j++)
+    {
+      for (int i = 0; i < 4; i++)
+        {
+          int k = (2 * i) + (16 * j);
+
+          grid[i + (4 * j)] = (grid[k] + grid[k + 1] +
+                               grid[k + 8] + grid[k + 9]) / 4;
+        }
+    }
+
+  memset(&grid[16], 0, 48 * sizeof(uint32_t));
+}
+
+static void vl53l5cx_average_range_4x4(int16_t *grid)
+{
+  for (int j = 0; j < 4; j++)
+    {
+      for (int i = 0; i < 4; i++)
+        {
+          int k = (2 * i) + (16 * j);
+          int32_t sum = (int32_t)grid[k] + grid[k + 1] +
+                        grid[k + 8] + grid[k + 9];
+
+          grid[i + (4 * j)] = (int16_t)(sum / 4);
+        }
+    }
+
+  memset(&grid[16], 0, 48 * sizeof(int16_t));
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_send_offset_data
+ *
+ * Description:
+ *   Send NVM offset calibration for the given resolution.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_send_offset_data(vl53l5cx_dev_t *s,
+                                           vl53l5cx_resolution_t res)
+{
+  esp_err_t ret;
+  uint32_t signal_grid[64];
+  int16_t range_grid[64];
+  const uint8_t dss_4x4[8] = {0x0F, 0x04, 0x04, 0x00,
+                              0x08, 0x10, 0x10, 0x07};
+  const uint8_t footer[8] = {0x00, 0x00, 0x00, 0x0F,
+                             0x03, 0x01, 0x01, 0xE4};
+
+  memcpy(s->temp, s->offset_data, VL53L5CX_OFFSET_BUFFER_SIZE);
+
+  if (res == VL53L5CX_RESOLUTION_4X4)
+    {
+      memcpy(&s->temp[0x10], dss_4x4, sizeof(dss_4x4));
+      vl53l5cx_swap_buffer(s->temp, VL53L5CX_OFFSET_BUFFER_SIZE);
+      memcpy(signal_grid, &s->temp[0x3C], sizeof(signal_grid));
+      memcpy(range_grid, &s->temp[0x140], sizeof(range_grid));
+
+      vl53l5cx_average_signal_4x4(signal_grid);
+      vl53l5cx_average_range_4x4(range_grid);
+
+      memcpy(&s->temp[0x3C], signal_grid, sizeof(signal_grid));
+      memcpy(&s->temp[0x140], range_grid, sizeof(range_grid));
+      vl53l5cx_swap_buffer(s->temp, VL53L5CX_OFFSET_BUFFER_SIZE);
+    }
+
+  memmove(s->temp, &s->temp[8], VL53L5CX_OFFSET_BUFFER_SIZE - 8);
+  memcpy(&s->temp[0x1E0], footer, sizeof(footer));
+
+  ret = vl53l5cx_wr_multi(s, 0x2E18, s->temp, VL53L5CX_OFFSET_BUFFER_SIZE);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  return vl53l5cx_poll_for_answer(s, 4, 1, VL53L5CX_UI_CMD_STATUS,
+                                  0xFF, 0x03);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_send_xtalk_data
+ *
+ * Description:
+ *   Send crosstalk calibration for the given resolution.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_send_xtalk_data(vl53l5cx_dev_t *s,
+                                          vl53l5cx_resolution_t res)
+{
+  esp_err_t ret;
+  uint32_t signal_grid[64];
+  const uint8_t res_4x4[8] = {0x0F, 0x04, 0x04, 0x17,
+                              0x08, 0x10, 0x10, 0x07};
+  const uint8_t dss_4x4[8] = {0x00, 0x78, 0x00, 0x08,
+                              0x00, 0x00, 0x00, 0x08};
+  const uint8_t profile_4x4[4] = {0xA0, 0xFC, 0x01, 0x00};
+
+  memcpy(s->temp, s->xtalk_data, VL53L5CX_XTALK_BUFFER_SIZE);
+
+  if (res == VL53L5CX_RESOLUTION_4X4)
+    {
+      memcpy(&s->temp[0x08], res_4x4, sizeof(res_4x4));
+      memcpy(&s->temp[0x20], dss_4x4, sizeof(dss_4x4));
+      vl53l5cx_swap_buffer(s->temp, VL53L5CX_XTALK_BUFFER_SIZE);
+      memcpy(signal_grid, &s->temp[0x34], sizeof(signal_grid));
+
+      vl53l5cx_average_signal_4x4(signal_grid);
+
+      memcpy(&s->temp[0x34], signal_grid, sizeof(signal_grid));
+      vl53l5cx_swap_buffer(s->temp, VL53L5CX_XTALK_BUFFER_SIZE);
+      memcpy(&s->temp[0x134], profile_4x4, sizeof(profile_4x4));
+      memset(&s->temp[0x78], 0, 4);
+    }
+
+  ret = vl53l5cx_wr_multi(s, 0x2CF8, s->temp, VL53L5CX_XTALK_BUFFER_SIZE);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  return vl53l5cx_poll_for_answer(s, 4, 1, VL53L5CX_UI_CMD_STATUS,
+                                  0xFF, 0x03);
+}
+
+/****************************************************************************
+ * Private Functions: Bring-up
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_attach
+ *
+ * Description:
+ *   Register (or re-register) a sensor with the I2C arbiter (sensing
+ *   lane) at the given 7-bit address and SCL speed (0 = the frequency
+ *   of MAIA_I2C_BUS_TOF).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_attach(vl53l5cx_dev_t *s,
+                                 maia_i2c_dev_handle_t *dev,
+                                 uint16_t addr, uint32_t freq_hz)
+{
+  if (*dev != NULL)
+    {
+      maia_i2c_remove_device(*dev);
+      *dev = NULL;
+    }
+
+  maia_i2c_dev_config_t dev_cfg = {
+      .name = (dev == &s->dev_upload) ? "tof_fw" : s->name,
+      .addr = addr,
+      .bus = MAIA_I2C_BUS_TOF,
+      .scl_speed_hz = freq_hz,
+      .prio = MAIA_I2C_PRIO_SENSING,
+  };
+
+  return maia_i2c_add_device(&dev_cfg, dev);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_is_alive
+ *
+ * Description:
+ *   Check device and revision ID.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_is_alive(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  uint8_t id[2];
+
+  ret = vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_rd_multi(s, 0x0000, id, sizeof(id));
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  if (id[0] != VL53L5CX_DEVICE_ID || id[1] != VL53L5CX_REVISION_ID)
+    {
+      ESP_LOGE(TAG, "%s: unexpected ID 0x%02X rev 0x%02X",
+               s->name, id[0], id[1]);
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_power_up
+ *
+ * Description:
+ *   Release LPn of one sensor and move it to its configured address.
+ *   Only one sensor may answer the default address at a time, so this
+ *   runs sequentially for each sensor with the other still in LPn low.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_power_up(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+
+  gpio_set_level(s->lpn_pin, 1);
+  vl53l5cx_wait_ms(10);
+
+  ret = vl53l5cx_attach(s, &s->dev, VL53L5CX_DEFAULT_ADDR, 0);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_is_alive(s);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "%s: sensor not responding", s->name);
+      return ret;
+    }
+
+  if (s->i2c_addr == VL53L5CX_DEFAULT_ADDR)
+    {
+      return ESP_OK;
+    }
+
+  /* ULD vl53l5cx_set_i2c_address() */
+
+  ret = vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_wr_byte(s, 0x0004, s->i2c_addr);
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_attach(s, &s->dev, s->i2c_addr, 0);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  return vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+}
+
+#ifdef VL53L5CX_HAVE_ULD_BUFFERS
+
+/****************************************************************************
+ * Name: vl53l5cx_poll_for_mcu_boot
+ *
+ * Description:
+ *   Wait until the sensor MCU has booted (GO2 status registers).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_poll_for_mcu_boot(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  uint8_t status0;
+  uint8_t status1;
+
+  for (int timeout = 0; timeout < 500; timeout++)
+    {
+      ret = vl53l5cx_rd_byte(s, 0x06, &status0);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+
+      if (status0 & 0x80)
+        {
+          ret = vl53l5cx_rd_byte(s, 0x07, &status1);
+          if (ret == ESP_OK && status1 != 0)
+            {
+              ESP_LOGE(TAG, "%s: MCU boot error 0x%02X", s->name, status1);
+              return ESP_ERR_INVALID_RESPONSE;
+            }
+
+          return ret;
+        }
+
+      if (status0 & 0x01)
+        {
+          return ESP_OK;
+        }
+
+      vl53l5cx_wait_ms(1);
+    }
+
+  return ESP_ERR_TIMEOUT;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_run_sequence
+ *
+ * Description:
+ *   Write a list of {register, value} pairs.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_run_sequence(vl53l5cx_dev_t *s,
+                                       const vl53l5cx_reg_val_t *seq,
+                                       size_t count)
+{
+  esp_err_t ret;
+
+  for (size_t i = 0; i < count; i++)
+    {
+      ret = vl53l5cx_wr_byte(s, seq[i].reg, seq[i].value);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_upload_firmware
+ *
+ * Description:
+ *   Download the ranging firmware into the three RAM banks (0x09-0x0B).
+ *   The image is written at VL53L5CX_UPLOAD_FREQ_HZ (Fast-mode Plus)
+ *   through a temporary device handle; the regular handle and thus every
+ *   other transaction stays at the bus frequency.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_upload_firmware(vl53l5cx_dev_t *s)
+{
+  static const struct
+  {
+    uint8_t page;
+    uint32_t offset;
+    uint32_t size;
+  } banks[] =
+    {
+      {0x09, 0x00000, 0x8000},
+      {0x0A, 0x08000, 0x8000},
+      {0x0B, 0x10000, 0x5000},
+    };
+
+  esp_err_t ret = ESP_OK;
+  maia_i2c_dev_handle_t dev = s->dev;
+  int64_t t0 = esp_timer_get_time();
+
+  if (VL53L5CX_UPLOAD_FREQ_HZ != maia_i2c_get_bus_freq(MAIA_I2C_BUS_TOF))
+    {
+      ret = vl53l5cx_attach(s, &s->dev_upload, s->i2c_addr,
+                            VL53L5CX_UPLOAD_FREQ_HZ);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+
+      dev = s->dev_upload;
+    }
+
+  for (size_t i = 0; i < sizeof(banks) / sizeof(banks[0]); i++)
+    {
+      ret = vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, banks[i].page);
+      if (ret != ESP_OK)
+        {
+          break;
+        }
+
+      ret = vl53l5cx_wr_block(dev, 0, &VL53L5CX_FIRMWARE[banks[i].offset],
+                              banks[i].size);
+      if (ret != ESP_OK)
+        {
+          break;
+        }
+    }
+
+  if (s->dev_upload != NULL)
+    {
+      maia_i2c_remove_device(s->dev_upload);
+      s->dev_upload = NULL;
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ESP_LOGI(TAG, "%s: firmware uploaded in %lld ms (%d kHz, %d B chunks)",
+           s->name, (long long)((esp_timer_get_time() - t0) / 1000),
+           VL53L5CX_UPLOAD_FREQ_HZ / 1000, VL53L5CX_WR_CHUNK_SIZE);
+
+  return vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x01);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_boot
+ *
+ * Description:
+ *   Full sensor boot (ULD vl53l5cx_init): MCU reset, firmware download,
+ *   NVM offset read, crosstalk and default configuration.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_boot(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  uint8_t tmp;
+
+  static const vl53l5cx_reg_val_t sw_reboot[] =
+    {
+      {0x7FFF, 0x00}, {0x0009, 0x04}, {0x000F, 0x40}, {0x000A, 0x03},
+    };
+
+  static const vl53l5cx_reg_val_t sw_reboot_2[] =
+    {
+      {0x000C, 0x01}, {0x0101, 0x00}, {0x0102, 0x00}, {0x010A, 0x01},
+      {0x4002, 0x01}, {0x4002, 0x00}, {0x010A, 0x03}, {0x0103, 0x01},
+      {0x000C, 0x00}, {0x000F, 0x43},
+    };
+
+  static const vl53l5cx_reg_val_t power_on[] =
+    {
+      {0x7FFF, 0x00}, {0x0101, 0x00}, {0x0102, 0x00}, {0x010A, 0x01},
+      {0x4002, 0x01}, {0x4002, 0x00}, {0x010A, 0x03}, {0x0103, 0x01},
+      {0x400F, 0x00}, {0x021A, 0x43}, {0x021A, 0x03}, {0x021A, 0x01},
+      {0x021A, 0x00}, {0x0219, 0x00}, {0x021B, 0x00},
+    };
+
+  static const vl53l5cx_reg_val_t mcu_reset[] =
+    {
+      {0x7FFF, 0x00}, {0x0114, 0x00}, {0x0115, 0x00}, {0x0116, 0x42},
+      {0x0117, 0x00}, {0x000B, 0x00},
+    };
+
+  uint8_t pipe_ctrl[4] = {1, 0x00, 0x01, 0x00};   /* 1 target per zone */
+  uint32_t single_range = 0x01;
+
+  /* Software reboot */
+
+  ret = vl53l5cx_run_sequence(s, sw_reboot, 4);
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_rd_byte(s, VL53L5CX_REG_PAGE, &tmp);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_run_sequence(s, sw_reboot_2, 10);
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_wait_ms(1);
+
+  vl53l5cx_wr_byte(s, 0x000F, 0x40);
+  vl53l5cx_wr_byte(s, 0x000A, 0x01);
+  vl53l5cx_wait_ms(100);
+
+  /* Wait for sensor booted (several ms required to get sensor ready) */
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  ret = vl53l5cx_poll_for_answer(s, 1, 0, 0x06, 0xFF, 1);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_wr_byte(s, 0x000E, 0x01);
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+
+  /* Enable FW access */
+
+  vl53l5cx_wr_byte(s, 0x0003, 0x0D);
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x01);
+  ret = vl53l5cx_poll_for_answer(s, 1, 0, 0x21, 0x10, 0x10);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+
+  /* Enable host access to GO1 */
+
+  vl53l5cx_rd_byte(s, VL53L5CX_REG_PAGE, &tmp);
+  vl53l5cx_wr_byte(s, 0x000C, 0x01);
+
+  /* Power ON status */
+
+  ret = vl53l5cx_run_sequence(s, power_on, 15);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  /* Wake up MCU */
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  vl53l5cx_rd_byte(s, VL53L5CX_REG_PAGE, &tmp);
+  vl53l5cx_wr_byte(s, 0x000C, 0x00);
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x01);
+  vl53l5cx_wr_byte(s, 0x0020, 0x07);
+  vl53l5cx_wr_byte(s, 0x0020, 0x06);
+
+  /* Download FW into VL53L5CX */
+
+  ret = vl53l5cx_upload_firmware(s);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "%s: firmware upload failed: %s", s->name,
+               esp_err_to_name(ret));
+      return ret;
+    }
+
+  /* Check if FW correctly downloaded */
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+  vl53l5cx_wr_byte(s, 0x0003, 0x0D);
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x01);
+  ret = vl53l5cx_poll_for_answer(s, 1, 0, 0x21, 0x10, 0x10);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  vl53l5cx_rd_byte(s, VL53L5CX_REG_PAGE, &tmp);
+  vl53l5cx_wr_byte(s, 0x000C, 0x01);
+
+  /* Reset MCU and wait boot */
+
+  ret = vl53l5cx_run_sequence(s, mcu_reset, 6);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_rd_byte(s, VL53L5CX_REG_PAGE, &tmp);
+  vl53l5cx_wr_byte(s, 0x000C, 0x00);
+  vl53l5cx_wr_byte(s, 0x000B, 0x01);
+
+  ret = vl53l5cx_poll_for_mcu_boot(s);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+
+  /* Get offset NVM data and keep it for resolution changes */
+
+  ret = vl53l5cx_wr_multi(s, 0x2FD8, VL53L5CX_GET_NVM_CMD,
+                          sizeof(VL53L5CX_GET_NVM_CMD));
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_poll_for_answer(s, 4, 0, VL53L5CX_UI_CMD_STATUS,
+                                     0xFF, 2);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_rd_multi(s, VL53L5CX_UI_CMD_START, s->temp,
+                              VL53L5CX_NVM_DATA_SIZE);
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "%s: failed to read NVM offsets", s->name);
+      return ret;
+    }
+
+  memcpy(s->offset_data, s->temp, VL53L5CX_OFFSET_BUFFER_SIZE);
+  memcpy(s->xtalk_data, VL53L5CX_DEFAULT_XTALK,
+         VL53L5CX_XTALK_BUFFER_SIZE);
+
+  ret = vl53l5cx_send_offset_data(s, VL53L5CX_RESOLUTION_4X4);
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_send_xtalk_data(s, VL53L5CX_RESOLUTION_4X4);
+    }
+
+  /* Send default configuration */
+
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_wr_multi(s, 0x2C34, VL53L5CX_DEFAULT_CONFIGURATION,
+                              sizeof(VL53L5CX_DEFAULT_CONFIGURATION));
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_poll_for_answer(s, 4, 1, VL53L5CX_UI_CMD_STATUS,
+                                     0xFF, 0x03);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_PIPE_CONTROL, pipe_ctrl,
+                               sizeof(pipe_ctrl));
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_SINGLE_RANGE,
+                               (const uint8_t *)&single_range,
+                               sizeof(single_range));
+    }
+
+  s->resolution = VL53L5CX_RESOLUTION_4X4;
+
+  return ret;
+}
+
+#else /* !VL53L5CX_HAVE_ULD_BUFFERS */
+
+static esp_err_t vl53l5cx_boot(vl53l5cx_dev_t *s)
+{
+  ESP_LOGE(TAG, "%s: ST ULD firmware buffers missing "
+                "(vl53l5cx/uld/vl53l5cx_buffers.h)", s->name);
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* VL53L5CX_HAVE_ULD_BUFFERS */
+
+/****************************************************************************
+ * Private Functions: Ranging Configuration
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_set_resolution
+ *
+ * Description:
+ *   Select 4x4 or 8x8 zones (ranging must be stopped).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_set_resolution(vl53l5cx_dev_t *s,
+                                         vl53l5cx_resolution_t res)
+{
+  esp_err_t ret;
+  uint8_t buf[16];
+  bool is_4x4 = (res == VL53L5CX_RESOLUTION_4X4);
+
+  ret = vl53l5cx_dci_read(s, VL53L5CX_DCI_DSS_CONFIG, buf, 16);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  buf[0x04] = is_4x4 ? 64 : 16;
+  buf[0x06] = is_4x4 ? 64 : 16;
+  buf[0x09] = is_4x4 ? 4 : 1;
+
+  ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_DSS_CONFIG, buf, 16);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_dci_read(s, VL53L5CX_DCI_ZONE_CONFIG, buf, 8);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  buf[0x00] = is_4x4 ? 4 : 8;
+  buf[0x01] = is_4x4 ? 4 : 8;
+  buf[0x04] = is_4x4 ? 8 : 4;
+  buf[0x05] = is_4x4 ? 8 : 4;
+
+  ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_ZONE_CONFIG, buf, 8);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_send_offset_data(s, res);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_send_xtalk_data(s, res);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  s->resolution = res;
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_configure
+ *
+ * Description:
+ *   Apply resolution, frequency and continuous ranging mode.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_configure(vl53l5cx_dev_t *s,
+                                    vl53l5cx_resolution_t res,
+                                    uint8_t freq_hz)
+{
+  esp_err_t ret;
+  uint8_t buf[8];
+  uint32_t single_range = 0x00;
+
+  ret = vl53l5cx_set_resolution(s, res);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_dci_replace(s, VL53L5CX_DCI_FREQ_HZ, 4, &freq_hz, 1, 1);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  s->freq_hz = freq_hz;
+
+  /* Continuous mode: the sensor ranges back to back at freq_hz */
+
+  ret = vl53l5cx_dci_read(s, VL53L5CX_DCI_RANGING_MODE, buf, 8);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  buf[0x01] = 0x01;
+  buf[0x03] = 0x03;
+
+  ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_RANGING_MODE, buf, 8);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  return vl53l5cx_dci_write(s, VL53L5CX_DCI_SINGLE_RANGE,
+                            (const uint8_t *)&single_range,
+                            sizeof(single_range));
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_start
+ *
+ * Description:
+ *   Program the output list and start ranging on one sensor
+ *   (ULD vl53l5cx_start_ranging).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_start(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  uint8_t buf[12];
+  uint16_t reported_size;
+  uint32_t size = 0;
+  uint32_t header_config[2];
+  uint32_t output_enables[4] = {VL53L5CX_OUTPUT_ENABLES, 0, 0, 0xC0000000};
+  const uint8_t cmd[4] = {0x00, 0x03, 0x00, 0x00};
+  uint32_t output[] =
+    {
+      VL53L5CX_START_BH,
+      VL53L5CX_METADATA_BH,
+      VL53L5CX_COMMONDATA_BH,
+      0x54D00104,                 /* Ambient rate (disabled) */
+      0x55D00404,                 /* SPAD count (disabled) */
+      VL53L5CX_NB_TARGET_BH,
+      VL53L5CX_SIGNAL_RATE_BH,
+      0xD2BC0402,                 /* Range sigma (disabled) */
+      VL53L5CX_DISTANCE_BH,
+      0xD43C0401,                 /* Reflectance (disabled) */
+      VL53L5CX_TARGET_STATUS_BH,
+      0xCC5008C0,                 /* Motion detector (disabled) */
+    };
+
+  const size_t n_outputs = sizeof(output) / sizeof(output[0]);
+
+  /* Compute the size of one frame read from the enabled blocks */
+
+  for (size_t i = 0; i < n_outputs; i++)
+    {
+      uint32_t bh = output[i];
+      uint32_t type = VL53L5CX_BH_TYPE(bh);
+
+      if ((output_enables[0] & (1u << i)) == 0)
+        {
+          continue;
+        }
+
+      if (type >= 0x1 && type < 0xD)
+        {
+          uint32_t zones = s->resolution;
+
+          output[i] = (bh & 0xFFFF000F) | (zones << 4);
+          size += type * zones;
+        }
+      else
+        {
+          size += VL53L5CX_BH_SIZE(bh);
+        }
+
+      size += 4;
+    }
+
+  size += 24;
+
+  if (size > VL53L5CX_TEMP_BUFFER_SIZE)
+    {
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+  ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_OUTPUT_LIST,
+                           (const uint8_t *)output, sizeof(output));
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  header_config[0] = size;
+  header_config[1] = n_outputs;
+
+  ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_OUTPUT_CONFIG,
+                           (const uint8_t *)header_config,
+                           sizeof(header_config));
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = vl53l5cx_dci_write(s, VL53L5CX_DCI_OUTPUT_ENABLES,
+                           (const uint8_t *)output_enables,
+                           sizeof(output_enables));
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  /* Start xshut bypass (interrupt mode) */
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  vl53l5cx_wr_byte(s, 0x0009, 0x05);
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+
+  /* Start ranging session */
+
+  ret = vl53l5cx_wr_multi(s, VL53L5CX_UI_CMD_END - 3, cmd, sizeof(cmd));
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_poll_for_answer(s, 4, 1, VL53L5CX_UI_CMD_STATUS,
+                                     0xFF, 0x03);
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  /* Check that the firmware agrees on the frame size */
+
+  ret = vl53l5cx_dci_read(s, VL53L5CX_DCI_UI_RANGE_DATA, buf, 12);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  memcpy(&reported_size, &buf[0x08], sizeof(reported_size));
+  if (reported_size != size)
+    {
+      ESP_LOGE(TAG, "%s: frame size mismatch (%u != %u)", s->name,
+               reported_size, (unsigned)size);
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+  s->data_read_size = size;
+  s->start_us = esp_timer_get_time();
+  s->ranging = true;
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_stop
+ *
+ * Description:
+ *   Stop ranging on one sensor (ULD vl53l5cx_stop_ranging).
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_stop(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  uint8_t tmp = 0;
+  uint32_t auto_stop_flag = 0;
+
+  ret = vl53l5cx_rd_multi(s, 0x2FFC, (uint8_t *)&auto_stop_flag, 4);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  if (auto_stop_flag != 0x4FF)
+    {
+      /* Provoke MCU stop and poll GO2 status 0 */
+
+      vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+      vl53l5cx_wr_byte(s, 0x0015, 0x16);
+      vl53l5cx_wr_byte(s, 0x0014, 0x01);
+
+      for (int timeout = 0; (tmp & 0x80) == 0; timeout++)
+        {
+          if (timeout > 500)
+            {
+              ESP_LOGW(TAG, "%s: MCU stop timeout", s->name);
+              break;
+            }
+
+          vl53l5cx_rd_byte(s, 0x0006, &tmp);
+          vl53l5cx_wait_ms(10);
+        }
+    }
+
+  /* Undo MCU stop and stop xshut bypass */
+
+  vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x00);
+  vl53l5cx_wr_byte(s, 0x0014, 0x00);
+  vl53l5cx_wr_byte(s, 0x0015, 0x00);
+  vl53l5cx_wr_byte(s, 0x0009, 0x04);
+  ret = vl53l5cx_wr_byte(s, VL53L5CX_REG_PAGE, 0x02);
+
+  s->ranging = false;
+
+  return ret;
+}
+
+/****************************************************************************
+ * Private Functions: Parallel Bring-up
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_bringup
+ *
+ * Description:
+ *   Boot and configure one sensor, recording result and duration.
+ *
+ ****************************************************************************/
+
+static esp_err_t vl53l5cx_bringup(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  int64_t t0 = esp_timer_get_time();
+
+  ret = vl53l5cx_boot(s);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "%s: boot failed: %s", s->name, esp_err_to_name(ret));
+    }
+  else
+    {
+      ret = vl53l5cx_configure(s, VL53L5CX_DEFAULT_RESOLUTION,
+                               VL53L5CX_DEFAULT_FREQ_HZ);
+      if (ret != ESP_OK)
+        {
+          ESP_LOGE(TAG, "%s: configuration failed: %s", s->name,
+                   esp_err_to_name(ret));
+        }
+    }
+
+  s->boot_time_us = esp_timer_get_time() - t0;
+  s->boot_result = ret;
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_bringup_task
+ *
+ * Description:
+ *   Helper task booting one sensor while vl53l5cx_init() boots the other.
+ *   Every boot step is either an I2C transaction or a sleep/poll, so the
+ *   two sequences interleave on the bus: one sensor's firmware chunks go
+ *   out while the other waits for its MCU.
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_bringup_task(void *arg)
+{
+  vl53l5cx_bringup((vl53l5cx_dev_t *)arg);
+  xTaskNotifyGive(g_init_task);
+  vTaskDelete(NULL);
+}
+
+/****************************************************************************
+ * Private Functions: Frame Pipeline
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_zone_valid
+ *
+ * Description:
+ *   Target status filter (Kconfig MAIA_VL53L5CX_FILTER_STATUS_5/6).
+ *   Status 5 and 9 are the only fully trusted ranges (UM2884 Table 4).
+ *
+ ****************************************************************************/
+
+static inline bool vl53l5cx_zone_valid(uint8_t nb_target, uint8_t status)
+{
+  if (nb_target == 0 || status == VL53L5CX_TARGET_STATUS_NO_TARGET)
+    {
+      return false;
+    }
+
+#ifdef CONFIG_MAIA_VL53L5CX_FILTER_STATUS_6
+  if (status == VL53L5CX_TARGET_STATUS_NO_WRAP_CHECK)
+    {
+      return false;
+    }
+#endif
+
+#ifdef CONFIG_MAIA_VL53L5CX_FILTER_STATUS_5
+  return status == VL53L5CX_TARGET_STATUS_VALID ||
+         status == VL53L5CX_TARGET_STATUS_VALID_LARGE ||
+         status == VL53L5CX_TARGET_STATUS_NO_WRAP_CHECK;
+#else
+  return true;
+#endif
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_parse_frame
+ *
+ * Description:
+ *   Decode the swapped result stream into a frame and apply the status
+ *   filter.
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_parse_frame(vl53l5cx_dev_t *s, vl53l5cx_frame_t *f)
+{
+  const int16_t *distance = NULL;
+  const uint32_t *signal = NULL;
+  const uint8_t *nb_target = NULL;
+  const uint8_t *status = NULL;
+  uint8_t zones = s->resolution;
+  uint8_t valid = 0;
+
+  for (uint32_t i = 16; i < s->data_read_size; i += 4)
+    {
+      uint32_t bh;
+      uint32_t type;
+      uint32_t msize;
+
+      memcpy(&bh, &s->temp[i], sizeof(bh));
+      type = VL53L5CX_BH_TYPE(bh);
+      msize = (type > 0x1 && type < 0xD) ?
+              type * VL53L5CX_BH_SIZE(bh) : VL53L5CX_BH_SIZE(bh);
+
+      switch (VL53L5CX_BH_IDX(bh))
+        {
+          case VL53L5CX_NB_TARGET_IDX:
+            nb_target = &s->temp[i + 4];
+            break;
+
+          case VL53L5CX_SIGNAL_RATE_IDX:
+            signal = (const uint32_t *)&s->temp[i + 4];
+            break;
+
+          case VL53L5CX_DISTANCE_IDX:
+            distance = (const int16_t *)&s->temp[i + 4];
+            break;
+
+          case VL53L5CX_TARGET_STATUS_IDX:
+            status = &s->temp[i + 4];
+            break;
+
+          default:
+            break;
+        }
+
+      i += msize;
+    }
+
+  if (distance == NULL || signal == NULL || nb_target == NULL ||
+      status == NULL)
+    {
+      f->nb_zones = 0;
+      f->valid_zones = 0;
+      return;
+    }
+
+  for (uint8_t z = 0; z < zones; z++)
+    {
+      uint32_t kcps = signal[z] >> VL53L5CX_SIGNAL_SHIFT;
+      int16_t mm = distance[z] >> VL53L5CX_DISTANCE_SHIFT;
+
+      f->target_status[z] = status[z];
+      f->signal_kcps[z] = (kcps > UINT16_MAX) ? UINT16_MAX : kcps;
+
+      if (vl53l5cx_zone_valid(nb_target[z], status[z]))
+        {
+          f->distance_mm[z] = (mm < 0) ? 0 : mm;
+          valid++;
+        }
+      else
+        {
+          f->distance_mm[z] = VL53L5CX_DISTANCE_INVALID;
+        }
+    }
+
+  f->nb_zones = zones;
+  f->valid_zones = valid;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_read_frame
+ *
+ * Description:
+ *   Read one frame into a pool block and publish it as the latest; the
+ *   previous latest goes back to the pool unless the consumer holds it.
+ *   Without a free block the frame is skipped without touching the bus.
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_read_frame(vl53l5cx_dev_t *s)
+{
+  esp_err_t ret;
+  vl53l5cx_frame_t *f;
+  vl53l5cx_frame_t *old;
+
+  f = maia_pool_alloc(&g_frame_pool);
+  if (f == NULL)
+    {
+      portENTER_CRITICAL(&g_frame_lock);
+      s->stats.dropped++;
+      portEXIT_CRITICAL(&g_frame_lock);
+      return;
+    }
+
+  ret = vl53l5cx_rd_multi(s, 0x0000, s->temp, s->data_read_size);
+  if (ret != ESP_OK)
+    {
+      maia_pool_free(&g_frame_pool, f);
+      portENTER_CRITICAL(&g_frame_lock);
+      s->stats.i2c_errors++;
+      portEXIT_CRITICAL(&g_frame_lock);
+      return;
+    }
+
+  f->stream_count = s->temp[0];
+  f->read_done_us = esp_timer_get_time();
+  f->int_time_us = s->int_time_us;
+  f->sensor = s->id;
+  f->sequence = ++s->sequence;
+
+  vl53l5cx_swap_buffer(s->temp, s->data_read_size);
+  vl53l5cx_parse_frame(s, f);
+
+  portENTER_CRITICAL(&g_frame_lock);
+  old = s->front;
+  s->front = f;
+  s->stats.frames++;
+  if (old == s->held)
+    {
+      old = NULL;
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  maia_pool_free(&g_frame_pool, old);
+
+  if (f->sequence == 1)
+    {
+      ESP_LOGI(TAG, "%s: first frame %lld ms after init start "
+               "(%lld ms since boot)", s->name,
+               (long long)((f->read_done_us - g_init_start_us) / 1000),
+               (long long)(f->read_done_us / 1000));
+    }
+
+  if (g_frame_cb != NULL)
+    {
+      g_frame_cb(s->id, g_frame_cb_arg);
+    }
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_apply_profile
+ *
+ * Description:
+ *   Bring one sensor to the requested profile (reader task). A ranging
+ *   sensor is stopped for the change and restarted; its frames resume
+ *   at the new resolution after the first new integration period.
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_apply_profile(vl53l5cx_dev_t *s)
+{
+  vl53l5cx_resolution_t res;
+  uint8_t freq_hz;
+  bool ranging = s->ranging;
+  int64_t t0 = esp_timer_get_time();
+  int64_t dt;
+  esp_err_t ret;
+
+  portENTER_CRITICAL(&g_frame_lock);
+  res = g_profile_res;
+  freq_hz = g_profile_freq_hz;
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  if (s->resolution == res && s->freq_hz == freq_hz)
+    {
+      return;
+    }
+
+  ret = ranging ? vl53l5cx_stop(s) : ESP_OK;
+  if (ret == ESP_OK)
+    {
+      ret = vl53l5cx_configure(s, res, freq_hz);
+    }
+
+  if (ret == ESP_OK && ranging)
+    {
+      ret = vl53l5cx_start(s);
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "%s: profile change failed: %s", s->name,
+               esp_err_to_name(ret));
+      return;
+    }
+
+  dt = esp_timer_get_time() - t0;
+
+  portENTER_CRITICAL(&g_frame_lock);
+  s->stats.reconfigs++;
+  if (dt > s->stats.reconfig_max_us)
+    {
+      s->stats.reconfig_max_us = (uint32_t)dt;
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  ESP_LOGI(TAG, "%s: %dx%d @ %u Hz (%lld ms)", s->name,
+           res == VL53L5CX_RESOLUTION_8X8 ? 8 : 4,
+           res == VL53L5CX_RESOLUTION_8X8 ? 8 : 4, freq_hz,
+           (long long)(dt / 1000));
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_reader_task
+ *
+ * Description:
+ *   Waits for INT notifications (one bit per sensor) and reads frames.
+ *   Profile changes run after the frames of the same wake-up; an INT
+ *   timestamped before a sensor's last start belongs to the stopped
+ *   session and is ignored.
+ *
+ ****************************************************************************/
+
+static void vl53l5cx_reader_task(void *arg)
+{
+  uint32_t pending;
+
+  (void)arg;
+
+  for (;;)
+    {
+      xTaskNotifyWait(0, UINT32_MAX, &pending, portMAX_DELAY);
+
+      for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+        {
+          vl53l5cx_dev_t *s = &g_sensors[i];
+
+          if ((pending & (1u << i)) && s->ranging &&
+              s->int_time_us >= s->start_us)
+            {
+              vl53l5cx_read_frame(s);
+            }
+        }
+
+      if (pending & VL53L5CX_EVT_PROFILE)
+        {
+          for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+            {
+              vl53l5cx_apply_profile(&g_sensors[i]);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_isr_handler
+ *
+ * Description:
+ *   INT pin falling edge: data ready. Timestamp and wake the reader.
+ *
+ ****************************************************************************/
+
+static void IRAM_ATTR vl53l5cx_isr_handler(void *arg)
+{
+  vl53l5cx_dev_t *s = (vl53l5cx_dev_t *)arg;
+  BaseType_t woken = pdFALSE;
+
+  s->int_time_us = esp_timer_get_time();
+  xTaskNotifyFromISR(g_reader_task, 1u << s->id, eSetBits, &woken);
+
+  if (woken == pdTRUE)
+    {
+      portYIELD_FROM_ISR();
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_init
+ *
+ * Description:
+ *   Initialize both sensors.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_init(void)
+{
+  esp_err_t ret;
+
+  if (g_initialized)
+    {
+      ESP_LOGW(TAG, "Already initialized");
+      return ESP_OK;
+    }
+
+  if (VL53L5CX_LEFT_ADDR == VL53L5CX_RIGHT_ADDR)
+    {
+      ESP_LOGE(TAG, "Left and right sensors need distinct I2C addresses");
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  g_init_start_us = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "Initializing VL53L5CX (left 0x%02X, right 0x%02X, "
+           "%dx%d @ %d Hz)", VL53L5CX_LEFT_ADDR, VL53L5CX_RIGHT_ADDR,
+           VL53L5CX_DEFAULT_RESOLUTION == VL53L5CX_RESOLUTION_8X8 ? 8 : 4,
+           VL53L5CX_DEFAULT_RESOLUTION == VL53L5CX_RESOLUTION_8X8 ? 8 : 4,
+           VL53L5CX_DEFAULT_FREQ_HZ);
+
+  /* Hold both sensors in LPn low, then wake and re-address one at a time
+   * (both answer the default address after reset).
+   */
+
+  gpio_set_level(MAIA_GPIO_TOF1_LPN, 0);
+  gpio_set_level(MAIA_GPIO_TOF2_LPN, 0);
+  vl53l5cx_wait_ms(10);
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      ret = vl53l5cx_power_up(&g_sensors[i]);
+      if (ret != ESP_OK)
+        {
+          return ret;
+        }
+    }
+
+  /* Firmware upload and ranging configuration: both sensors now have
+   * distinct addresses, so the right one boots in a helper task while
+   * this task boots the left one.
+   */
+
+  g_init_task = xTaskGetCurrentTaskHandle();
+  ulTaskNotifyTake(pdTRUE, 0);
+
+  if (xTaskCreatePinnedToCore(vl53l5cx_bringup_task, "tof_boot",
+                              VL53L5CX_BOOT_STACK_SIZE,
+                              &g_sensors[VL53L5CX_SENSOR_RIGHT],
+                              VL53L5CX_BOOT_PRIORITY, NULL,
+                              tskNO_AFFINITY) != pdPASS)
+    {
+      ESP_LOGW(TAG, "Boot task unavailable, booting sequentially");
+      vl53l5cx_bringup(&g_sensors[VL53L5CX_SENSOR_RIGHT]);
+      xTaskNotifyGive(g_init_task);
+    }
+
+  vl53l5cx_bringup(&g_sensors[VL53L5CX_SENSOR_LEFT]);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      vl53l5cx_dev_t *s = &g_sensors[i];
+
+      if (s->boot_result != ESP_OK)
+        {
+          return s->boot_result;
+        }
+
+      ESP_LOGI(TAG, "%s: ready in %lld ms", s->name,
+               (long long)(s->boot_time_us / 1000));
+    }
+
+  /* Reader task and INT handlers */
+
+  if (xTaskCreatePinnedToCore(vl53l5cx_reader_task, "tof_reader",
+                              VL53L5CX_TASK_STACK_SIZE, NULL,
+                              VL53L5CX_TASK_PRIORITY, &g_reader_task,
+                              MAIA_CORE_RT) != pdPASS)
+    {
+      ESP_LOGE(TAG, "Failed to create reader task");
+      return ESP_ERR_NO_MEM;
+    }
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      ret = gpio_isr_handler_add(g_sensors[i].int_pin,
+                                 vl53l5cx_isr_handler, &g_sensors[i]);
+      if (ret != ESP_OK)
+        {
+          ESP_LOGE(TAG, "Failed to add INT handler: %s",
+                   esp_err_to_name(ret));
+
+          /* Unwind so a retry starts from scratch */
+
+          while (--i >= 0)
+            {
+              gpio_isr_handler_remove(g_sensors[i].int_pin);
+            }
+
+          vTaskDelete(g_reader_task);
+          g_reader_task = NULL;
+          return ret;
+        }
+    }
+
+  g_initialized = true;
+  ESP_LOGI(TAG, "VL53L5CX initialized successfully");
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_start_ranging
+ *
+ * Description:
+ *   Start continuous ranging on both sensors.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_start_ranging(void)
+{
+  esp_err_t ret;
+
+  if (!g_initialized)
+    {
+      ESP_LOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      ret = vl53l5cx_start(&g_sensors[i]);
+      if (ret != ESP_OK)
+        {
+          ESP_LOGE(TAG, "%s: failed to start ranging: %s",
+                   g_sensors[i].name, esp_err_to_name(ret));
+          return ret;
+        }
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_stop_ranging
+ *
+ * Description:
+ *   Stop ranging on both sensors.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_stop_ranging(void)
+{
+  esp_err_t ret = ESP_OK;
+
+  if (!g_initialized)
+    {
+      ESP_LOGE(TAG, "Driver not initialized");
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      esp_err_t err = vl53l5cx_stop(&g_sensors[i]);
+
+      if (err != ESP_OK)
+        {
+          ESP_LOGE(TAG, "%s: failed to stop ranging: %s",
+                   g_sensors[i].name, esp_err_to_name(err));
+          ret = err;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_set_profile
+ *
+ * Description:
+ *   Request a new resolution and ranging frequency for both sensors.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_set_profile(vl53l5cx_resolution_t resolution,
+                               uint8_t freq_hz)
+{
+  uint8_t max_hz;
+
+  if (!g_initialized)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (resolution == VL53L5CX_RESOLUTION_8X8)
+    {
+      max_hz = VL53L5CX_MAX_FREQ_8X8;
+    }
+  else if (resolution == VL53L5CX_RESOLUTION_4X4)
+    {
+      max_hz = VL53L5CX_MAX_FREQ_4X4;
+    }
+  else
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (freq_hz == 0 || freq_hz > max_hz)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_frame_lock);
+  g_profile_res = resolution;
+  g_profile_freq_hz = freq_hz;
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  xTaskNotify(g_reader_task, VL53L5CX_EVT_PROFILE, eSetBits);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_set_frame_callback
+ *
+ * Description:
+ *   Register frame-ready callback.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_set_frame_callback(vl53l5cx_frame_cb_t callback,
+                                      void *arg)
+{
+  portENTER_CRITICAL(&g_frame_lock);
+  g_frame_cb = callback;
+  g_frame_cb_arg = arg;
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_acquire_frame
+ *
+ * Description:
+ *   Hold the latest published frame of a sensor.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_acquire_frame(vl53l5cx_sensor_t sensor,
+                                 const vl53l5cx_frame_t **frame)
+{
+  vl53l5cx_dev_t *s;
+  esp_err_t ret = ESP_OK;
+
+  if (sensor >= VL53L5CX_SENSOR_COUNT || frame == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  s = &g_sensors[sensor];
+
+  portENTER_CRITICAL(&g_frame_lock);
+  if (s->held != NULL)
+    {
+      ret = ESP_ERR_INVALID_STATE;
+    }
+  else if (s->front == NULL)
+    {
+      ret = ESP_ERR_NOT_FOUND;
+    }
+  else
+    {
+      s->held = s->front;
+      *frame = s->held;
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_release_frame
+ *
+ * Description:
+ *   Release a held frame: back to the pool if a newer one was published
+ *   meanwhile.
+ *
+ ****************************************************************************/
+
+void vl53l5cx_release_frame(vl53l5cx_sensor_t sensor)
+{
+  vl53l5cx_dev_t *s;
+  vl53l5cx_frame_t *f;
+
+  if (sensor >= VL53L5CX_SENSOR_COUNT)
+    {
+      return;
+    }
+
+  s = &g_sensors[sensor];
+
+  portENTER_CRITICAL(&g_frame_lock);
+  f = s->held;
+  s->held = NULL;
+  if (f == s->front)
+    {
+      f = NULL;
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  maia_pool_free(&g_frame_pool, f);
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_get_stats
+ *
+ * Description:
+ *   Read per-sensor counters.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_get_stats(vl53l5cx_sensor_t sensor,
+                             vl53l5cx_stats_t *stats)
+{
+  if (sensor >= VL53L5CX_SENSOR_COUNT || stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_frame_lock);
+  *stats = g_sensors[sensor].stats;
+  portEXIT_CRITICAL(&g_frame_lock);
 
   return ESP_OK;
 }
@@ -29,6 +29,9 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <esp_err.h>
 #include <driver/gpio.h>
 #include <driver/i2c_master.h>
@@ -72,13 +75,20 @@
 
 #define MAIA_GPIO_IMU_INT           4
 
-/* I2C Bus */
+/* I2C Bus 0 */
 
 #define MAIA_I2C_FREQ_HZ            CONFIG_MAIA_I2C_FREQ_HZ
 #define MAIA_GPIO_I2C_SDA           5
 #define MAIA_GPIO_I2C_SCL           6
 #define MAIA_I2C_PORT               I2C_NUM_0
 
+/* I2C Bus 1 (CONFIG_MAIA_I2C_BUS1_ENABLE, back pads by default) */
+
+#define MAIA_I2C1_FREQ_HZ           CONFIG_MAIA_I2C_BUS1_FREQ_HZ
+#define MAIA_GPIO_I2C1_SDA          CONFIG_MAIA_I2C_BUS1_SDA_GPIO
+#define MAIA_GPIO_I2C1_SCL          CONFIG_MAIA_I2C_BUS1_SCL_GPIO
+#define MAIA_I2C1_PORT              I2C_NUM_1
+
 /* PWM Motors (ERM Left and Right) */
 
 #define MAIA_PWM_FREQ_MOTOR_LEFT    CONFIG_MAIA_PWM_FREQ_MOTOR_LEFT
@@ -108,6 +118,298 @@
 #define MAIA_I2C_ADDR_DRV2605L      CONFIG_MAIA_DRV2605L_I2C_ADDR
 #define MAIA_I2C_ADDR_MPU6050       CONFIG_MAIA_MPU6050_I2C_ADDR
 
+/* I2C Device Buses (maia_i2c_bus_t) */
+
+#define MAIA_I2C_BUS_SSD1306        CONFIG_MAIA_SSD1306_I2C_BUS
+#define MAIA_I2C_BUS_TOF            CONFIG_MAIA_VL53L5CX_I2C_BUS
+#define MAIA_I2C_BUS_DRV2605L       CONFIG_MAIA_DRV2605L_I2C_BUS
+#define MAIA_I2C_BUS_MPU6050        CONFIG_MAIA_MPU6050_I2C_BUS
+
+/* I2C arbiter */
+
+#define MAIA_I2C_MAX_DEVICES        8
+
+/* Stereo PWM fade patterns */
+
+#define MAIA_PWM_FADE_MAX_STEPS     8
+
+/* Task placement (Kconfig "Task Layout", -1 = no affinity). Use from
+ * files that include FreeRTOS.
+ */
+
+#define MAIA_TASK_CORE(c)           ((c) < 0 ? tskNO_AFFINITY : (c))
+#define MAIA_CORE_RT                MAIA_TASK_CORE(CONFIG_MAIA_TASK_RT_CORE)
+#define MAIA_CORE_UI                MAIA_TASK_CORE(CONFIG_MAIA_TASK_UI_CORE)
+
+/* Static task storage for xTaskCreateStaticPinnedToCore(): a stack of
+ * stack_size bytes (the ESP-IDF stack depth unit) and the TCB, both in
+ * .bss, as name_stack and name_tcb. Use from files that include
+ * FreeRTOS.
+ */
+
+#define MAIA_TASK_STATIC(name, stack_size) \
+  static StackType_t name##_stack[stack_size]; \
+  static StaticTask_t name##_tcb
+
+/* Fixed-block pool of count blocks of a type, in .bss (maia_pool_*).
+ * Blocks are handed between tasks by pointer, never copied.
+ */
+
+#define MAIA_POOL_DEFINE(pool, type, count) \
+  static union \
+  { \
+    type item; \
+    void *link; \
+  } pool##_blocks[count]; \
+  static maia_pool_t pool = \
+  { \
+    .name = #pool, \
+    .block_size = sizeof(pool##_blocks[0]), \
+    .blocks = (count), \
+    .storage = (uint8_t *)pool##_blocks, \
+  }
+
+/* Tasks whose heap allocations are counted (maia_mem_watch_task()) */
+
+#define MAIA_MEM_WATCH_MAX          8
+
+/* Obstacle-to-vibration latency histograms: MAIA_LAT_BUCKETS buckets of
+ * 2^MAIA_LAT_BUCKET_SHIFT us, the last one also counts anything longer
+ */
+
+#define MAIA_LAT_BUCKET_SHIFT       8
+#define MAIA_LAT_BUCKETS            128
+
+/* Light sleep wake pins */
+
+#define MAIA_PM_WAKE_MAX_PINS       4
+
+/* Deferred logging: the call site stores the format pointer and up to
+ * MAIA_DLOG_MAX_ARGS 32-bit arguments; the "dlog" task formats them
+ * later. Arguments must be integers or pointers of at most 32 bits (no
+ * float, no 64-bit), and %s strings must be static (literals, Kconfig
+ * strings, esp_err_to_name()). Levels above CONFIG_MAIA_DLOG_LEVEL
+ * compile to nothing.
+ */
+
+#ifdef CONFIG_MAIA_DLOG_LEVEL
+#  define MAIA_DLOG_LEVEL           CONFIG_MAIA_DLOG_LEVEL
+#else
+#  define MAIA_DLOG_LEVEL           0
+#endif
+
+#define MAIA_DLOG_MAX_ARGS          4
+
+#define MAIA_DLOG_NARGS(...) \
+  MAIA_DLOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define MAIA_DLOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+#define MAIA_DLOG_A(x)              ((uint32_t)(uintptr_t)(x))
+#define MAIA_DLOG_ARGS_0()          0
+#define MAIA_DLOG_ARGS_1(a)         MAIA_DLOG_A(a)
+#define MAIA_DLOG_ARGS_2(a, b)      MAIA_DLOG_A(a), MAIA_DLOG_A(b)
+#define MAIA_DLOG_ARGS_3(a, b, c) \
+  MAIA_DLOG_A(a), MAIA_DLOG_A(b), MAIA_DLOG_A(c)
+#define MAIA_DLOG_ARGS_4(a, b, c, d) \
+  MAIA_DLOG_A(a), MAIA_DLOG_A(b), MAIA_DLOG_A(c), MAIA_DLOG_A(d)
+#define MAIA_DLOG_CAT(a, b)         a##b
+#define MAIA_DLOG_XCAT(a, b)        MAIA_DLOG_CAT(a, b)
+
+#define MAIA_DLOG(level, tag, fmt, ...) \
+  do \
+    { \
+      if ((level) <= MAIA_DLOG_LEVEL) \
+        { \
+          const uint32_t _dlog_args[] = \
+            { \
+              MAIA_DLOG_XCAT(MAIA_DLOG_ARGS_, \
+                             MAIA_DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__) \
+            }; \
+          if (0) \
+            { \
+              maia_dlog_check(fmt, ##__VA_ARGS__); \
+            } \
+          maia_dlog_write((level), (tag), (fmt), _dlog_args, \
+                          MAIA_DLOG_NARGS(__VA_ARGS__)); \
+        } \
+    } \
+  while (0)
+
+#define MAIA_DLOGE(tag, fmt, ...)   MAIA_DLOG(1, tag, fmt, ##__VA_ARGS__)
+#define MAIA_DLOGW(tag, fmt, ...)   MAIA_DLOG(2, tag, fmt, ##__VA_ARGS__)
+#define MAIA_DLOGI(tag, fmt, ...)   MAIA_DLOG(3, tag, fmt, ##__VA_ARGS__)
+#define MAIA_DLOGD(tag, fmt, ...)   MAIA_DLOG(4, tag, fmt, ##__VA_ARGS__)
+#define MAIA_DLOGV(tag, fmt, ...)   MAIA_DLOG(5, tag, fmt, ##__VA_ARGS__)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* I2C transaction priority lanes (lower value = more urgent).
+ * When the bus is released it is granted to the most urgent waiter.
+ */
+
+typedef enum
+{
+  MAIA_I2C_PRIO_SENSING = 0,        /* ToF frame reads */
+  MAIA_I2C_PRIO_HAPTIC,             /* Haptic GO / RTP updates */
+  MAIA_I2C_PRIO_IMU,                /* IMU FIFO reads */
+  MAIA_I2C_PRIO_DISPLAY,            /* OLED framebuffer pushes */
+  MAIA_I2C_PRIO_COUNT,
+} maia_i2c_prio_t;
+
+/* I2C buses, each with its own controller and arbiter */
+
+typedef enum
+{
+  MAIA_I2C_BUS_0 = 0,               /* I2C_NUM_0, always present */
+  MAIA_I2C_BUS_1,                   /* I2C_NUM_1, optional */
+  MAIA_I2C_BUS_COUNT,
+} maia_i2c_bus_t;
+
+/* Arbitrated I2C device (opaque) */
+
+typedef struct maia_i2c_dev_s *maia_i2c_dev_handle_t;
+
+/* Device registration */
+
+typedef struct
+{
+  const char *name;                 /* Short name for statistics */
+  uint16_t addr;                    /* 7-bit address */
+  maia_i2c_bus_t bus;               /* Controller the device is wired to */
+  uint32_t scl_speed_hz;            /* 0 = bus frequency */
+  maia_i2c_prio_t prio;             /* Priority lane */
+  bool splittable;                  /* Prefixed writes may be split */
+} maia_i2c_dev_config_t;
+
+/* Per-device bus occupancy statistics */
+
+typedef struct
+{
+  uint32_t transactions;            /* Completed bus transactions */
+  uint32_t bytes;                   /* Bytes written + read */
+  uint64_t busy_us;                 /* Time holding the bus */
+  uint32_t max_wait_us;             /* Worst wait for the bus */
+  uint32_t errors;                  /* Failed transactions (NACK, ...) */
+  uint32_t timeouts;                /* Bus grant timeouts */
+} maia_i2c_stats_t;
+
+/* Statistics of one registered device (maia_i2c_get_all_stats) */
+
+typedef struct
+{
+  const char *name;                 /* From maia_i2c_dev_config_t */
+  uint16_t addr;
+  maia_i2c_bus_t bus;
+  maia_i2c_stats_t stats;
+} maia_i2c_dev_stats_t;
+
+/* One step of a stereo motor fade: both channels ramp from their current
+ * duty to the targets in time_ms (0 = jump). A step that keeps both
+ * duties is a pause of time_ms.
+ */
+
+typedef struct
+{
+  uint8_t left;                     /* Left motor target duty */
+  uint8_t right;                    /* Right motor target duty */
+  uint16_t time_ms;                 /* Ramp duration */
+} maia_pwm_fade_step_t;
+
+/* Fade pattern completion callback (called from the fade task) */
+
+typedef void (*maia_pwm_fade_cb_t)(void *arg);
+
+/* Latency stages, each measured from the VL53L5CX INT edge (ISR
+ * timestamp) carried with the frame
+ */
+
+typedef enum
+{
+  MAIA_LAT_I2C_READ = 0,            /* Frame read over I2C */
+  MAIA_LAT_FUSION,                  /* Gating, fusion and tracking done */
+  MAIA_LAT_COMMAND,                 /* Haptic target issued */
+  MAIA_LAT_ACTUATOR,                /* Motor amplitude written (RTP/PWM) */
+  MAIA_LAT_STAGE_COUNT,
+} maia_lat_stage_t;
+
+/* Latency summary of one stage */
+
+typedef struct
+{
+  uint32_t count;                   /* Samples */
+  uint32_t p50_us;                  /* Bucket upper edge */
+  uint32_t p99_us;
+  uint32_t max_us;                  /* Exact */
+} maia_lat_stats_t;
+
+/* Bring-up stages on the boot timeline (maia_boot_mark()) */
+
+typedef enum
+{
+  MAIA_BOOT_BOARD = 0,              /* maia_board_init() */
+  MAIA_BOOT_SENSING,                /* ToF ranging and IMU running */
+  MAIA_BOOT_HAPTIC,                 /* Motor driver in RTP streaming */
+  MAIA_BOOT_PROTECTED,              /* First obstacle-driven vibration */
+  MAIA_BOOT_LOGGER,                 /* Session log open */
+  MAIA_BOOT_SYNC,                   /* NVS and radio up */
+  MAIA_BOOT_UI,                     /* Display and monitor tasks started */
+  MAIA_BOOT_STAGE_COUNT,
+} maia_boot_stage_t;
+
+/* One stage: esp_timer_get_time() values, start 0 for "since boot" */
+
+typedef struct
+{
+  int64_t start_us;
+  int64_t end_us;
+} maia_boot_span_t;
+
+/* Fixed-block pool (MAIA_POOL_DEFINE). The fields are private to
+ * maia_mem.c; read them through maia_pool_get_stats().
+ */
+
+typedef struct maia_pool_s
+{
+  const char *name;
+  size_t block_size;
+  uint16_t blocks;
+  uint16_t carved;                  /* Blocks handed out at least once */
+  uint16_t in_use;
+  uint16_t peak;
+  uint32_t failures;
+  uint8_t *storage;
+  void *free_list;                  /* Returned blocks, linked in place */
+  struct maia_pool_s *next;         /* Registry, from the first alloc */
+  bool registered;
+} maia_pool_t;
+
+/* Pool occupancy */
+
+typedef struct
+{
+  const char *name;
+  size_t block_size;
+  uint16_t blocks;
+  uint16_t in_use;
+  uint16_t peak;                    /* Most blocks in use at once */
+  uint32_t failures;                /* Allocations refused, pool empty */
+} maia_pool_stats_t;
+
+/* Power state time since maia_pm_init(). Awake time not listed is spent
+ * at the DFS minimum frequency (or ramping).
+ */
+
+typedef struct
+{
+  uint32_t sleeps;                  /* Light sleeps entered */
+  uint32_t gpio_wakes;              /* Ended by a wake pin */
+  uint64_t sleep_us;                /* Time in light sleep */
+  uint64_t busy_us;                 /* Time with the busy lock held */
+  uint64_t uptime_us;               /* Since maia_pm_init() */
+} maia_pm_stats_t;
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -151,7 +453,7 @@ void maia_config_log(void);
  * Name: maia_i2c_init
  *
  * Description:
- *   Initialize I2C master bus.
+ *   Initialize I2C master bus 0, and bus 1 if CONFIG_MAIA_I2C_BUS1_ENABLE.
  *
  * Input Parameters:
  *   None
@@ -167,17 +469,482 @@ esp_err_t maia_i2c_init(void);
  * Name: maia_i2c_get_bus_handle
  *
  * Description:
- *   Get the I2C master bus handle for device registration.
+ *   Get the I2C master bus handle of a bus.
  *
  * Input Parameters:
- *   None
+ *   bus - MAIA_I2C_BUS_0 or MAIA_I2C_BUS_1
+ *
+ * Returned Value:
+ *   I2C master bus handle, or NULL if the bus is not initialized.
+ *
+ ****************************************************************************/
+
+i2c_master_bus_handle_t maia_i2c_get_bus_handle(maia_i2c_bus_t bus);
+
+/****************************************************************************
+ * Name: maia_i2c_get_bus_freq
+ *
+ * Description:
+ *   SCL frequency of a bus (used by devices registered with
+ *   scl_speed_hz = 0).
+ *
+ ****************************************************************************/
+
+uint32_t maia_i2c_get_bus_freq(maia_i2c_bus_t bus);
+
+/****************************************************************************
+ * Name: maia_i2c_add_device
+ *
+ * Description:
+ *   Register a device with the arbiter of its bus (config->bus). All
+ *   traffic on a shared bus should go through the maia_i2c_* transfer
+ *   functions so that priority and statistics apply.
+ *
+ * Input Parameters:
+ *   config - Device configuration
+ *   dev    - Pointer to store the device handle
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NO_MEM if all slots are used;
+ *   ESP_ERR_INVALID_STATE if the device bus is not initialized.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_add_device(const maia_i2c_dev_config_t *config,
+                              maia_i2c_dev_handle_t *dev);
+
+/****************************************************************************
+ * Name: maia_i2c_remove_device
+ *
+ * Description:
+ *   Unregister a device and free its slot.
+ *
+ * Input Parameters:
+ *   dev - Device handle
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG on invalid handle.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_remove_device(maia_i2c_dev_handle_t dev);
+
+/****************************************************************************
+ * Name: maia_i2c_transmit
+ *
+ * Description:
+ *   Write a buffer to a device as one transaction.
+ *
+ * Input Parameters:
+ *   dev        - Device handle
+ *   data       - Data to write
+ *   len        - Number of bytes
+ *   timeout_ms - Timeout for the bus grant and for the transfer
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_TIMEOUT if the bus was not granted in time;
+ *   I2C driver error otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit(maia_i2c_dev_handle_t dev, const uint8_t *data,
+                            size_t len, int timeout_ms);
+
+/****************************************************************************
+ * Name: maia_i2c_transmit_prefixed
+ *
+ * Description:
+ *   Write prefix + data (register address or control byte followed by a
+ *   payload) without copying them together. On devices registered as
+ *   splittable the payload is sent in CONFIG_MAIA_I2C_SPLIT_SIZE chunks,
+ *   each preceded by the same prefix, and the bus is released between
+ *   chunks so more urgent lanes can run in between.
+ *
+ * Input Parameters:
+ *   dev        - Device handle
+ *   prefix     - Prefix bytes (repeated per chunk when split)
+ *   prefix_len - Prefix length (max 4)
+ *   data       - Payload
+ *   len        - Payload length
+ *   timeout_ms - Timeout per bus grant and per transfer
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit_prefixed(maia_i2c_dev_handle_t dev,
+                                     const uint8_t *prefix,
+                                     size_t prefix_len,
+                                     const uint8_t *data, size_t len,
+                                     int timeout_ms);
+
+/****************************************************************************
+ * Name: maia_i2c_transmit_receive
+ *
+ * Description:
+ *   Write then read with a repeated start (register read).
+ *
+ * Input Parameters:
+ *   dev        - Device handle
+ *   wr_data    - Data to write
+ *   wr_len     - Number of bytes to write
+ *   rd_data    - Buffer for read data
+ *   rd_len     - Number of bytes to read
+ *   timeout_ms - Timeout for the bus grant and for the transfer
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit_receive(maia_i2c_dev_handle_t dev,
+                                    const uint8_t *wr_data, size_t wr_len,
+                                    uint8_t *rd_data, size_t rd_len,
+                                    int timeout_ms);
+
+/****************************************************************************
+ * Name: maia_i2c_get_stats
+ *
+ * Description:
+ *   Read bus occupancy statistics of a device.
+ *
+ * Input Parameters:
+ *   dev   - Device handle
+ *   stats - Pointer to store statistics
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG on invalid arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_get_stats(maia_i2c_dev_handle_t dev,
+                             maia_i2c_stats_t *stats);
+
+/****************************************************************************
+ * Name: maia_i2c_get_all_stats
+ *
+ * Description:
+ *   Copy the statistics of every registered device, in registration
+ *   slot order.
+ *
+ * Input Parameters:
+ *   out - Output array
+ *   max - Capacity of out (MAIA_I2C_MAX_DEVICES covers all devices)
+ *
+ * Returned Value:
+ *   Number of entries written.
+ *
+ ****************************************************************************/
+
+size_t maia_i2c_get_all_stats(maia_i2c_dev_stats_t *out, size_t max);
+
+/****************************************************************************
+ * Name: maia_i2c_log_stats
+ *
+ * Description:
+ *   Log statistics of all registered devices and bus utilization since
+ *   the previous call.
+ *
+ ****************************************************************************/
+
+void maia_i2c_log_stats(void);
+
+/****************************************************************************
+ * Name: maia_latency_record
+ *
+ * Description:
+ *   Add one sample to a stage histogram: now_us - origin_us, both
+ *   esp_timer_get_time() values (comparable across cores). A few
+ *   instructions under a spinlock; any task. No-op when
+ *   CONFIG_MAIA_LATENCY_ENABLE is off or origin_us is 0.
+ *
+ * Input Parameters:
+ *   stage     - Pipeline stage
+ *   origin_us - INT edge time of the frame
+ *   now_us    - Stage completion time
+ *
+ ****************************************************************************/
+
+void maia_latency_record(maia_lat_stage_t stage, int64_t origin_us,
+                         int64_t now_us);
+
+/****************************************************************************
+ * Name: maia_latency_get_stats
+ *
+ * Description:
+ *   Summarize a stage histogram (p50/p99 at bucket resolution).
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG on bad arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_latency_get_stats(maia_lat_stage_t stage,
+                                 maia_lat_stats_t *stats);
+
+/****************************************************************************
+ * Name: maia_latency_stage_name
+ ****************************************************************************/
+
+const char *maia_latency_stage_name(maia_lat_stage_t stage);
+
+/****************************************************************************
+ * Name: maia_latency_log
+ *
+ * Description:
+ *   Dump every stage over the console: summary and non-empty buckets.
+ *
+ ****************************************************************************/
+
+void maia_latency_log(void);
+
+/****************************************************************************
+ * Name: maia_latency_reset
+ ****************************************************************************/
+
+void maia_latency_reset(void);
+
+/****************************************************************************
+ * Name: maia_boot_mark
+ *
+ * Description:
+ *   Record the completion of a bring-up stage that started at start_us
+ *   and log its duration. Only the first mark of a stage counts; any
+ *   task. The timeline starts at esp_timer start-up, so ROM and
+ *   bootloader time (a few hundred ms, see the bootloader log) are not
+ *   included.
+ *
+ * Input Parameters:
+ *   stage    - Stage completed now
+ *   start_us - esp_timer_get_time() when it started, 0 for boot
+ *
+ ****************************************************************************/
+
+void maia_boot_mark(maia_boot_stage_t stage, int64_t start_us);
+
+/****************************************************************************
+ * Name: maia_boot_get
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_NOT_FOUND if the stage has not completed yet;
+ *   ESP_ERR_INVALID_ARG on bad arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_boot_get(maia_boot_stage_t stage, maia_boot_span_t *span);
+
+/****************************************************************************
+ * Name: maia_boot_log
+ *
+ * Description:
+ *   Dump the boot timeline: start, end and duration of every completed
+ *   stage, in completion order.
+ *
+ ****************************************************************************/
+
+void maia_boot_log(void);
+
+/****************************************************************************
+ * Name: maia_pool_alloc
+ *
+ * Description:
+ *   Take a block from a pool. O(1) under a spinlock; any task. The block
+ *   content is left as the previous owner wrote it.
  *
  * Returned Value:
- *   I2C master bus handle.
+ *   The block, or NULL if every block is in use (counted as a failure).
+ *
+ ****************************************************************************/
+
+void *maia_pool_alloc(maia_pool_t *pool);
+
+/****************************************************************************
+ * Name: maia_pool_free
+ *
+ * Description:
+ *   Return a block taken from the same pool (NULL is ignored).
  *
  ****************************************************************************/
 
-i2c_master_bus_handle_t maia_i2c_get_bus_handle(void);
+void maia_pool_free(maia_pool_t *pool, void *block);
+
+/****************************************************************************
+ * Name: maia_pool_get_stats
+ ****************************************************************************/
+
+esp_err_t maia_pool_get_stats(const maia_pool_t *pool,
+                              maia_pool_stats_t *stats);
+
+/****************************************************************************
+ * Name: maia_pool_get_all_stats
+ *
+ * Description:
+ *   Copy the statistics of every pool used so far.
+ *
+ * Returned Value:
+ *   Number of entries written.
+ *
+ ****************************************************************************/
+
+size_t maia_pool_get_all_stats(maia_pool_stats_t *out, size_t max);
+
+/****************************************************************************
+ * Name: maia_pool_log
+ ****************************************************************************/
+
+void maia_pool_log(void);
+
+/****************************************************************************
+ * Name: maia_mem_watch_task
+ *
+ * Description:
+ *   Count the heap allocations made by a task from now on (heap hook,
+ *   CONFIG_HEAP_USE_HOOKS). Meant to check that a hot loop does not
+ *   allocate.
+ *
+ * Input Parameters:
+ *   name - FreeRTOS task name
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if no task has that name;
+ *   ESP_ERR_NO_MEM if MAIA_MEM_WATCH_MAX tasks are watched already;
+ *   ESP_ERR_NOT_SUPPORTED without CONFIG_HEAP_USE_HOOKS.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_mem_watch_task(const char *name);
+
+/****************************************************************************
+ * Name: maia_mem_watch_allocs
+ *
+ * Description:
+ *   Heap allocations made by the watched tasks since the last reset.
+ *
+ ****************************************************************************/
+
+uint32_t maia_mem_watch_allocs(void);
+
+/****************************************************************************
+ * Name: maia_mem_watch_reset
+ *
+ * Description:
+ *   Stop watching every task and clear the count.
+ *
+ ****************************************************************************/
+
+void maia_mem_watch_reset(void);
+
+/****************************************************************************
+ * Name: maia_pm_init
+ *
+ * Description:
+ *   Create the board busy lock and register the light sleep callbacks
+ *   that arm the wake pins. Called by maia_board_init() before the I2C
+ *   bus and PWM are set up; light sleep and DFS themselves only start
+ *   with esp_pm_configure() (power_manager).
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_SUPPORTED without CONFIG_PM_ENABLE
+ *   (maia_pm_busy_acquire/release() are then no-ops); esp_pm error
+ *   otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pm_init(void);
+
+/****************************************************************************
+ * Name: maia_pm_wake_enable
+ *
+ * Description:
+ *   Wake from light sleep when an interrupt pin reaches its active level.
+ *   The pin keeps its edge interrupt while awake: it is switched to a
+ *   level wake source only for the duration of each sleep, and an edge
+ *   that woke the chip is delivered to the pin's ISR right after wake
+ *   (its timestamp then includes the wake-up time).
+ *
+ * Input Parameters:
+ *   pin   - GPIO already configured with an edge interrupt
+ *   level - Active level (1 for a rising edge, 0 for a falling edge)
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NO_MEM if MAIA_PM_WAKE_MAX_PINS are
+ *   armed; ESP_ERR_INVALID_STATE before maia_pm_init().
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pm_wake_enable(gpio_num_t pin, int level);
+
+/****************************************************************************
+ * Name: maia_pm_busy_acquire / maia_pm_busy_release
+ *
+ * Description:
+ *   Hold the APB clock at its maximum and keep the chip out of light
+ *   sleep (reference counted). Held by the I2C arbiter from bus grant to
+ *   release and by the PWM driver while a motor is driven.
+ *
+ ****************************************************************************/
+
+void maia_pm_busy_acquire(void);
+void maia_pm_busy_release(void);
+
+/****************************************************************************
+ * Name: maia_pm_get_stats
+ ****************************************************************************/
+
+void maia_pm_get_stats(maia_pm_stats_t *stats);
+
+/****************************************************************************
+ * Name: maia_dlog_init
+ *
+ * Description:
+ *   Start the deferred log task. Messages written before are kept in
+ *   the rings and printed once it runs.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NO_MEM if the task could not be created;
+ *   ESP_ERR_NOT_SUPPORTED with CONFIG_MAIA_DLOG_LEVEL 0.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_dlog_init(void);
+
+/****************************************************************************
+ * Name: maia_dlog_write
+ *
+ * Description:
+ *   Queue one message on the current core's ring (use the MAIA_DLOGx
+ *   macros). Never blocks; callable from tasks, timer callbacks and ISRs.
+ *
+ ****************************************************************************/
+
+void maia_dlog_write(uint8_t level, const char *tag, const char *fmt,
+                     const uint32_t *args, uint8_t nargs);
+
+/****************************************************************************
+ * Name: maia_dlog_check
+ *
+ * Description:
+ *   Compile-time printf format check of MAIA_DLOGx call sites (never
+ *   called).
+ *
+ ****************************************************************************/
+
+static inline void __attribute__((format(printf, 1, 2)))
+maia_dlog_check(const char *fmt, ...)
+{
+  (void)fmt;
+}
+
+/****************************************************************************
+ * Name: maia_dlog_get_dropped
+ *
+ * Description:
+ *   Messages lost because a ring was full, since boot.
+ *
+ ****************************************************************************/
+
+uint32_t maia_dlog_get_dropped(void);
 
 /****************************************************************************
  * Name: maia_gpio_init
@@ -228,6 +995,64 @@ esp_err_t maia_pwm_init(void);
 
 esp_err_t maia_pwm_set_duty(ledc_channel_t channel, uint8_t duty);
 
+/****************************************************************************
+ * Name: maia_pwm_set_duty_stereo
+ *
+ * Description:
+ *   Set both motor duties together. Cancels a running fade pattern.
+ *
+ * Input Parameters:
+ *   left  - Left motor duty (0-255)
+ *   right - Right motor duty (0-255)
+ *
+ * Returned Value:
+ *   ESP_OK on success; LEDC error otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pwm_set_duty_stereo(uint8_t left, uint8_t right);
+
+/****************************************************************************
+ * Name: maia_pwm_fade_stereo
+ *
+ * Description:
+ *   Play a stereo ramp/pulse pattern on both motors using the LEDC
+ *   hardware fade engine: each step ramps both channels in hardware, so
+ *   no CPU time is spent while it plays. A small task chains the steps
+ *   (one wake-up per step) and calls cb when the pattern ends. Replaces
+ *   a running pattern.
+ *
+ *   Example (obstacle on the left, left motor builds up):
+ *     { {255, 0, 400}, {0, 0, 150} }, cycles = 3
+ *
+ * Input Parameters:
+ *   steps  - Pattern steps (copied)
+ *   count  - Number of steps (1-MAIA_PWM_FADE_MAX_STEPS)
+ *   cycles - Times to play the pattern (0 = until stopped)
+ *   cb     - Completion callback (task context, may be NULL)
+ *   arg    - Callback argument
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG on bad pattern;
+ *   ESP_ERR_INVALID_STATE if PWM is not initialized.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pwm_fade_stereo(const maia_pwm_fade_step_t *steps,
+                               size_t count, uint8_t cycles,
+                               maia_pwm_fade_cb_t cb, void *arg);
+
+/****************************************************************************
+ * Name: maia_pwm_fade_stop
+ *
+ * Description:
+ *   Stop a running fade pattern; duties stay where they are and the
+ *   completion callback is not called.
+ *
+ ****************************************************************************/
+
+void maia_pwm_fade_stop(void);
+
 /****************************************************************************
  * Name: maia_onewire_init
  *
@@ -326,6 +1151,46 @@ void maia_onewire_write_byte(gpio_num_t pin, uint8_t byte);
 
 uint8_t maia_onewire_read_byte(gpio_num_t pin);
 
+/****************************************************************************
+ * Name: maia_onewire_write_block
+ *
+ * Description:
+ *   Write a buffer on OneWire bus (each byte LSB first). With the RMT
+ *   backend the whole buffer goes out in one transmission.
+ *
+ * Input Parameters:
+ *   pin  - GPIO pin number
+ *   data - Bytes to write
+ *   len  - Number of bytes
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void maia_onewire_write_block(gpio_num_t pin, const uint8_t *data,
+                              size_t len);
+
+/****************************************************************************
+ * Name: maia_onewire_read_block
+ *
+ * Description:
+ *   Read a buffer from OneWire bus (each byte LSB first). With the RMT
+ *   backend the read slots are generated and captured in a few large
+ *   transactions instead of one per byte.
+ *
+ * Input Parameters:
+ *   pin  - GPIO pin number
+ *   data - Output buffer
+ *   len  - Number of bytes
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void maia_onewire_read_block(gpio_num_t pin, uint8_t *data, size_t len);
+
 /****************************************************************************
  * Name: maia_onewire_crc8
  *
@@ -28,6 +28,7 @@
 
 #include "maia_board.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -57,10 +58,23 @@
 
 esp_err_t maia_board_init(void)
 {
+  int64_t start_us = esp_timer_get_time();
   esp_err_t ret;
 
   ESP_LOGI(TAG, "============ Initializing MAIA board ============");
 
+  /* Deferred log task first: the configuration dump below goes through
+   * it. At level 0 messages are compiled out and nothing is started.
+   */
+
+#if MAIA_DLOG_LEVEL > 0
+  ret = maia_dlog_init();
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+#endif
+
 #ifdef CONFIG_MAIA_LOG_GENERAL_CONFIG
   maia_config_log();
 #endif
@@ -83,6 +97,15 @@ esp_err_t maia_board_init(void)
       return ret;
     }
 
+  /* Power management hooks, before the peripherals that take the lock */
+
+  ret = maia_pm_init();
+  if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED)
+    {
+      ESP_LOGE(TAG, "Failed to initialize power management hooks");
+      return ret;
+    }
+
   /* Initialize I2C bus */
 
   ret = maia_i2c_init();
@@ -112,7 +135,11 @@ esp_err_t maia_board_init(void)
     }
 #endif
 
-  ESP_LOGI(TAG, "MAIA board initialized successfully");
+  /* Time reference for the drivers' time-to-first-frame logs */
+
+  ESP_LOGI(TAG, "MAIA board initialized successfully (%lld ms since boot)",
+           (long long)(esp_timer_get_time() / 1000));
+  maia_boot_mark(MAIA_BOOT_BOARD, start_us);
 
   return ESP_OK;
 }
\ No newline at end of file
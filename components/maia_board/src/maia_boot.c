@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * components/maia_board/src/maia_boot.c
+ *
+ * MAIA - Motion Assistance for Impaired Animals
+ * Boot timeline
+ *
+ * Start and end of each bring-up stage, marked by the code that runs
+ * it. The figure of merit is MAIA_BOOT_PROTECTED: time from boot to the
+ * first vibration driven by an obstacle.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[BOOT]"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *const g_stage_names[MAIA_BOOT_STAGE_COUNT] =
+{
+  [MAIA_BOOT_BOARD]     = "board",
+  [MAIA_BOOT_SENSING]   = "sensing",
+  [MAIA_BOOT_HAPTIC]    = "haptic",
+  [MAIA_BOOT_PROTECTED] = "protected",
+  [MAIA_BOOT_LOGGER]    = "logger",
+  [MAIA_BOOT_SYNC]      = "sync",
+  [MAIA_BOOT_UI]        = "ui",
+};
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static maia_boot_span_t g_spans[MAIA_BOOT_STAGE_COUNT];
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_boot_mark
+ ****************************************************************************/
+
+void maia_boot_mark(maia_boot_stage_t stage, int64_t start_us)
+{
+  int64_t now = esp_timer_get_time();
+  bool first = false;
+
+  if (stage >= MAIA_BOOT_STAGE_COUNT)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_spans[stage].end_us == 0)
+    {
+      g_spans[stage].start_us = start_us;
+      g_spans[stage].end_us = now;
+      first = true;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  if (first)
+    {
+      ESP_LOGI(TAG, "%s up at %lld ms (%lld ms)", g_stage_names[stage],
+               (long long)(now / 1000),
+               (long long)((now - start_us) / 1000));
+    }
+}
+
+/****************************************************************************
+ * Name: maia_boot_get
+ ****************************************************************************/
+
+esp_err_t maia_boot_get(maia_boot_stage_t stage, maia_boot_span_t *span)
+{
+  if (stage >= MAIA_BOOT_STAGE_COUNT || span == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  *span = g_spans[stage];
+  portEXIT_CRITICAL(&g_lock);
+
+  return span->end_us != 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/****************************************************************************
+ * Name: maia_boot_log
+ ****************************************************************************/
+
+void maia_boot_log(void)
+{
+  maia_boot_span_t spans[MAIA_BOOT_STAGE_COUNT];
+  bool done[MAIA_BOOT_STAGE_COUNT] = { false };
+
+  portENTER_CRITICAL(&g_lock);
+  for (int s = 0; s < MAIA_BOOT_STAGE_COUNT; s++)
+    {
+      spans[s] = g_spans[s];
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  /* Selection by end time: a handful of stages */
+
+  for (;;)
+    {
+      int next = -1;
+
+      for (int s = 0; s < MAIA_BOOT_STAGE_COUNT; s++)
+        {
+          if (!done[s] && spans[s].end_us != 0 &&
+              (next < 0 || spans[s].end_us < spans[next].end_us))
+            {
+              next = s;
+            }
+        }
+
+      if (next < 0)
+        {
+          break;
+        }
+
+      done[next] = true;
+      ESP_LOGI(TAG, "%-9s %6lld -> %6lld ms (%lld ms)",
+               g_stage_names[next],
+               (long long)(spans[next].start_us / 1000),
+               (long long)(spans[next].end_us / 1000),
+               (long long)((spans[next].end_us - spans[next].start_us) /
+                           1000));
+    }
+
+  if (spans[MAIA_BOOT_PROTECTED].end_us == 0)
+    {
+      ESP_LOGI(TAG, "protected: no obstacle cue yet");
+    }
+}
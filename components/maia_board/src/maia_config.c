@@ -27,7 +27,6 @@
  ****************************************************************************/
 
 #include "maia_board.h"
-#include <esp_log.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -43,7 +42,8 @@
  * Name: maia_config_log
  *
  * Description:
- *   Log all general configuration parameters at startup.
+ *   Log all general configuration parameters at startup (deferred: the
+ *   "dlog" task prints them while board bring-up goes on).
  *
  * Input Parameters:
  *   None
@@ -56,48 +56,48 @@
 #ifdef CONFIG_MAIA_LOG_GENERAL_CONFIG
 void maia_config_log(void)
 {
-  ESP_LOGI(TAG, "========== MAIA General Configuration ==========");
+  MAIA_DLOGI(TAG, "========== MAIA General Configuration ==========");
 
   /* Software Version */
 
-  ESP_LOGI(TAG, "Software Version: v%d.%d.%d",
-           CONFIG_MAIA_SW_VERSION_MAJOR,
-           CONFIG_MAIA_SW_VERSION_MINOR,
-           CONFIG_MAIA_SW_VERSION_PATCH);
+  MAIA_DLOGI(TAG, "Software Version: v%d.%d.%d",
+             CONFIG_MAIA_SW_VERSION_MAJOR,
+             CONFIG_MAIA_SW_VERSION_MINOR,
+             CONFIG_MAIA_SW_VERSION_PATCH);
 
   /* Timeouts */
 
-  ESP_LOGI(TAG, "Timeout - Sync Data: %d min",
-           CONFIG_MAIA_TIMEOUT_SYNC_DATA_MIN);
-  ESP_LOGI(TAG, "Timeout - Display Off: %d sec",
-           CONFIG_MAIA_TIMEOUT_DISPLAY_OFF_SEC);
-  ESP_LOGI(TAG, "Timeout - Screen Change: %d sec",
-           CONFIG_MAIA_TIMEOUT_DISPLAY_SCREEN_SEC);
+  MAIA_DLOGI(TAG, "Timeout - Sync Data: %d min",
+             CONFIG_MAIA_TIMEOUT_SYNC_DATA_MIN);
+  MAIA_DLOGI(TAG, "Timeout - Display Off: %d sec",
+             CONFIG_MAIA_TIMEOUT_DISPLAY_OFF_SEC);
+  MAIA_DLOGI(TAG, "Timeout - Screen Change: %d sec",
+             CONFIG_MAIA_TIMEOUT_DISPLAY_SCREEN_SEC);
 
   /* Animal Information */
 
-  ESP_LOGI(TAG, "Animal - Species: %s", CONFIG_MAIA_ANIMAL_SPECIES);
-  ESP_LOGI(TAG, "Animal - Breed: %s", CONFIG_MAIA_ANIMAL_BREED);
-  ESP_LOGI(TAG, "Animal - Name: %s", CONFIG_MAIA_ANIMAL_NAME);
-  ESP_LOGI(TAG, "Animal - Age: %d years", CONFIG_MAIA_ANIMAL_AGE);
-  ESP_LOGI(TAG, "Animal - Weight: %d kg", CONFIG_MAIA_ANIMAL_WEIGHT);
-  ESP_LOGI(TAG, "Animal - Blood Type: %s", CONFIG_MAIA_ANIMAL_BLOOD_TYPE);
-  ESP_LOGI(TAG, "Animal - Comorbidity: %s", CONFIG_MAIA_ANIMAL_COMORBIDITY);
-  ESP_LOGI(TAG, "Animal - Allergy: %s", CONFIG_MAIA_ANIMAL_ALLERGY);
+  MAIA_DLOGI(TAG, "Animal - Species: %s", CONFIG_MAIA_ANIMAL_SPECIES);
+  MAIA_DLOGI(TAG, "Animal - Breed: %s", CONFIG_MAIA_ANIMAL_BREED);
+  MAIA_DLOGI(TAG, "Animal - Name: %s", CONFIG_MAIA_ANIMAL_NAME);
+  MAIA_DLOGI(TAG, "Animal - Age: %d years", CONFIG_MAIA_ANIMAL_AGE);
+  MAIA_DLOGI(TAG, "Animal - Weight: %d kg", CONFIG_MAIA_ANIMAL_WEIGHT);
+  MAIA_DLOGI(TAG, "Animal - Blood Type: %s", CONFIG_MAIA_ANIMAL_BLOOD_TYPE);
+  MAIA_DLOGI(TAG, "Animal - Comorbidity: %s", CONFIG_MAIA_ANIMAL_COMORBIDITY);
+  MAIA_DLOGI(TAG, "Animal - Allergy: %s", CONFIG_MAIA_ANIMAL_ALLERGY);
 
   /* Tutor Information */
 
-  ESP_LOGI(TAG, "Tutor - Name: %s %s",
-           CONFIG_MAIA_TUTOR_NAME, CONFIG_MAIA_TUTOR_SURNAME);
-  ESP_LOGI(TAG, "Tutor - Phone: %s", CONFIG_MAIA_TUTOR_PHONE);
-  ESP_LOGI(TAG, "Tutor - Email: %s", CONFIG_MAIA_TUTOR_EMAIL);
-  ESP_LOGI(TAG, "Tutor - Social Media: %s", CONFIG_MAIA_TUTOR_SOCIAL_MEDIA);
-  ESP_LOGI(TAG, "Tutor - Location: %s, %s, %s",
-           CONFIG_MAIA_TUTOR_CITY,
-           CONFIG_MAIA_TUTOR_STATE,
-           CONFIG_MAIA_TUTOR_COUNTRY);
-  ESP_LOGI(TAG, "Tutor - Street: %s", CONFIG_MAIA_TUTOR_STREET);
-
-  ESP_LOGI(TAG, "================================================");
+  MAIA_DLOGI(TAG, "Tutor - Name: %s %s",
+             CONFIG_MAIA_TUTOR_NAME, CONFIG_MAIA_TUTOR_SURNAME);
+  MAIA_DLOGI(TAG, "Tutor - Phone: %s", CONFIG_MAIA_TUTOR_PHONE);
+  MAIA_DLOGI(TAG, "Tutor - Email: %s", CONFIG_MAIA_TUTOR_EMAIL);
+  MAIA_DLOGI(TAG, "Tutor - Social Media: %s", CONFIG_MAIA_TUTOR_SOCIAL_MEDIA);
+  MAIA_DLOGI(TAG, "Tutor - Location: %s, %s, %s",
+             CONFIG_MAIA_TUTOR_CITY,
+             CONFIG_MAIA_TUTOR_STATE,
+             CONFIG_MAIA_TUTOR_COUNTRY);
+  MAIA_DLOGI(TAG, "Tutor - Street: %s", CONFIG_MAIA_TUTOR_STREET);
+
+  MAIA_DLOGI(TAG, "================================================");
 }
 #endif
\ No newline at end of file
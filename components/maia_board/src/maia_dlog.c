@@ -0,0 +1,314 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * components/maia_board/src/maia_dlog.c
+ *
+ * MAIA - Motion Assistance for Impaired Animals
+ * Deferred logging
+ *
+ * A MAIA_DLOGx call only stores the format pointer, the tag, a
+ * timestamp and the raw 32-bit arguments in the ring of the core it runs
+ * on (a few hundred cycles, no formatting, no UART). The low priority
+ * "dlog" task merges both rings in timestamp order, formats the entries
+ * and hands them to esp_log_write(), so the console shows them in the
+ * usual "I (ms) TAG: text" form with the time of the call.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdio.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MAIA_DLOG]"
+
+#define DLOG_TASK_STACK         3072
+#define DLOG_TASK_PRIORITY      (tskIDLE_PRIORITY + 1)
+#define DLOG_LINE_LEN           160
+#define DLOG_NB_RINGS           2       /* One per core */
+
+#if MAIA_DLOG_LEVEL > 0
+#  define DLOG_DEPTH            CONFIG_MAIA_DLOG_RING_DEPTH
+#  define DLOG_MASK             (DLOG_DEPTH - 1)
+
+_Static_assert((DLOG_DEPTH & DLOG_MASK) == 0,
+               "CONFIG_MAIA_DLOG_RING_DEPTH must be a power of two");
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  const char *tag;
+  const char *fmt;
+  int64_t time_us;                  /* esp_timer time of the call */
+  uint8_t level;
+  uint8_t nargs;
+  uint32_t args[MAIA_DLOG_MAX_ARGS];
+} dlog_entry_t;
+
+#if MAIA_DLOG_LEVEL > 0
+
+typedef struct
+{
+  portMUX_TYPE lock;
+  uint32_t head;                    /* Next write (lock) */
+  uint32_t tail;                    /* Next read (lock) */
+  uint32_t dropped;                 /* Ring full (lock) */
+  dlog_entry_t items[DLOG_DEPTH];
+} dlog_ring_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static DRAM_ATTR dlog_ring_t g_rings[DLOG_NB_RINGS] = {
+    { .lock = portMUX_INITIALIZER_UNLOCKED },
+    { .lock = portMUX_INITIALIZER_UNLOCKED },
+};
+
+static TaskHandle_t g_task = NULL;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: dlog_pop
+ *
+ * Description:
+ *   Take the oldest entry of both rings.
+ *
+ * Returned Value:
+ *   false if both are empty.
+ *
+ ****************************************************************************/
+
+static bool dlog_pop(dlog_entry_t *e)
+{
+  dlog_ring_t *best = NULL;
+  int64_t best_us = INT64_MAX;
+
+  /* Peek both heads: an entry pushed meanwhile is newer than either */
+
+  for (int i = 0; i < DLOG_NB_RINGS; i++)
+    {
+      dlog_ring_t *r = &g_rings[i];
+
+      portENTER_CRITICAL(&r->lock);
+      if (r->tail != r->head &&
+          r->items[r->tail & DLOG_MASK].time_us < best_us)
+        {
+          best = r;
+          best_us = r->items[r->tail & DLOG_MASK].time_us;
+        }
+
+      portEXIT_CRITICAL(&r->lock);
+    }
+
+  if (best == NULL)
+    {
+      return false;
+    }
+
+  portENTER_CRITICAL(&best->lock);
+  *e = best->items[best->tail & DLOG_MASK];
+  best->tail++;
+  portEXIT_CRITICAL(&best->lock);
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: dlog_print
+ ****************************************************************************/
+
+static void dlog_print(const dlog_entry_t *e)
+{
+  static const char letters[] = "NEWIDV";
+  char line[DLOG_LINE_LEN];
+  const uint32_t *a = e->args;
+
+  /* Unused slots are 0: passing all four is harmless for the format.
+   * Pointers and ints are both 32 bits on this target.
+   */
+
+  snprintf(line, sizeof(line), e->fmt, a[0], a[1], a[2], a[3]);
+
+  esp_log_write((esp_log_level_t)e->level, e->tag, "%c (%lu) %s: %s\n",
+                letters[e->level], (unsigned long)(e->time_us / 1000),
+                e->tag, line);
+}
+
+/****************************************************************************
+ * Name: dlog_task
+ ****************************************************************************/
+
+static void dlog_task(void *arg)
+{
+  dlog_entry_t e;
+  uint32_t reported = 0;
+  uint32_t dropped;
+
+  (void)arg;
+
+  for (; ; )
+    {
+      while (dlog_pop(&e))
+        {
+          dlog_print(&e);
+        }
+
+      dropped = maia_dlog_get_dropped();
+      if (dropped != reported)
+        {
+          ESP_LOGW(TAG, "%lu messages dropped (ring full)",
+                   (unsigned long)(dropped - reported));
+          reported = dropped;
+        }
+
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+#endif /* MAIA_DLOG_LEVEL > 0 */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_dlog_init
+ ****************************************************************************/
+
+esp_err_t maia_dlog_init(void)
+{
+#if MAIA_DLOG_LEVEL > 0
+  if (g_task != NULL)
+    {
+      return ESP_OK;
+    }
+
+  if (xTaskCreate(dlog_task, "dlog", DLOG_TASK_STACK, NULL,
+                  DLOG_TASK_PRIORITY, &g_task) != pdPASS)
+    {
+      ESP_LOGE(TAG, "Failed to create log task");
+      return ESP_ERR_NO_MEM;
+    }
+
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_dlog_write
+ ****************************************************************************/
+
+void IRAM_ATTR maia_dlog_write(uint8_t level, const char *tag,
+                               const char *fmt, const uint32_t *args,
+                               uint8_t nargs)
+{
+#if MAIA_DLOG_LEVEL > 0
+  dlog_ring_t *r = &g_rings[xPortGetCoreID() % DLOG_NB_RINGS];
+  dlog_entry_t *e;
+  bool wake = false;
+  int64_t now = esp_timer_get_time();
+
+  portENTER_CRITICAL_SAFE(&r->lock);
+  if (r->head - r->tail < DLOG_DEPTH)
+    {
+      e = &r->items[r->head & DLOG_MASK];
+      e->tag = tag;
+      e->fmt = fmt;
+      e->time_us = now;
+      e->level = level;
+      e->nargs = nargs;
+
+      for (int i = 0; i < MAIA_DLOG_MAX_ARGS; i++)
+        {
+          e->args[i] = i < nargs ? args[i] : 0;
+        }
+
+      wake = r->head == r->tail;
+      r->head++;
+    }
+  else
+    {
+      r->dropped++;
+    }
+
+  portEXIT_CRITICAL_SAFE(&r->lock);
+
+  /* Empty to non-empty only: the task drains until both are empty */
+
+  if (wake && g_task != NULL)
+    {
+      if (xPortInIsrContext())
+        {
+          BaseType_t woken = pdFALSE;
+
+          vTaskNotifyGiveFromISR(g_task, &woken);
+          portYIELD_FROM_ISR(woken);
+        }
+      else
+        {
+          xTaskNotifyGive(g_task);
+        }
+    }
+#else
+  (void)level;
+  (void)tag;
+  (void)fmt;
+  (void)args;
+  (void)nargs;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_dlog_get_dropped
+ ****************************************************************************/
+
+uint32_t maia_dlog_get_dropped(void)
+{
+  uint32_t dropped = 0;
+
+#if MAIA_DLOG_LEVEL > 0
+  for (int i = 0; i < DLOG_NB_RINGS; i++)
+    {
+      portENTER_CRITICAL(&g_rings[i].lock);
+      dropped += g_rings[i].dropped;
+      portEXIT_CRITICAL(&g_rings[i].lock);
+    }
+#endif
+
+  return dropped;
+}
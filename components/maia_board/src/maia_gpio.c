@@ -28,6 +28,7 @@
 
 #include "maia_board.h"
 #include <driver/gpio.h>
+#include <esp_intr_alloc.h>
 #include <esp_log.h>
 
 /****************************************************************************
@@ -205,9 +206,11 @@ esp_err_t maia_gpio_init(void)
   /* This service is shared by all GPIO interrupts in the system
    * Must be called once before any gpio_isr_handler_add()
    * ESP_ERR_INVALID_STATE returned if already installed (safe to ignore)
+   * IRAM: edges are still serviced while the flash cache is disabled, so
+   * every handler must be IRAM_ATTR and touch only internal RAM
    */
 
-  ret = gpio_install_isr_service(0);
+  ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
   if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
     {
       ESP_LOGE(TAG, "Failed to install GPIO ISR service");
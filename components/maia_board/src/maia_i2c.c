@@ -20,6 +20,15 @@
  * MAIA - Motion Assistance for Impaired Animals
  * I2C bus initialization and management
  *
+ * Devices sit on bus 0 or, with CONFIG_MAIA_I2C_BUS1_ENABLE, on a second
+ * controller with its own clock. Transfers go through a small arbiter
+ * per bus with one priority lane per traffic class (sensing > haptic >
+ * IMU > display): a transaction first needs a grant of its bus, and on
+ * release the grant is handed to the most urgent waiting lane. The two
+ * buses run in parallel. Large writes of splittable devices are chopped
+ * so an urgent transaction waits for at most one chunk instead of a
+ * full framebuffer.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -28,6 +37,11 @@
 
 #include "maia_board.h"
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <inttypes.h>
+#include <string.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -35,54 +49,321 @@
 
 #define TAG "[MAIA_I2C]"
 
+/* Largest prefix of maia_i2c_transmit_prefixed() */
+
+#define MAIA_I2C_PREFIX_MAX         4
+
+/* Payload chunk size of splittable devices */
+
+#define MAIA_I2C_SPLIT_SIZE         CONFIG_MAIA_I2C_SPLIT_SIZE
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct maia_i2c_bus_s
+{
+  i2c_master_bus_handle_t handle;
+  uint32_t freq_hz;
+  bool busy;
+  uint8_t waiting[MAIA_I2C_PRIO_COUNT];
+  SemaphoreHandle_t lane[MAIA_I2C_PRIO_COUNT];
+  StaticSemaphore_t lane_buf[MAIA_I2C_PRIO_COUNT];
+  uint64_t busy_us;
+  int64_t stats_since_us;
+};
+
+struct maia_i2c_dev_s
+{
+  bool in_use;
+  const char *name;
+  uint16_t addr;
+  maia_i2c_bus_t bus_id;
+  struct maia_i2c_bus_s *bus;
+  maia_i2c_prio_t prio;
+  bool splittable;
+  i2c_master_dev_handle_t handle;
+  maia_i2c_stats_t stats;
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-static i2c_master_bus_handle_t g_i2c_bus_handle = NULL;
+/* Arbiter state of both buses (g_i2c_lock protects everything below) */
+
+static portMUX_TYPE g_i2c_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct maia_i2c_bus_s g_i2c_buses[MAIA_I2C_BUS_COUNT];
+static struct maia_i2c_dev_s g_i2c_devices[MAIA_I2C_MAX_DEVICES];
+
+static const char *const g_i2c_prio_names[MAIA_I2C_PRIO_COUNT] =
+{
+  "sensing", "haptic", "imu", "display",
+};
 
 /****************************************************************************
- * Public Functions
+ * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: maia_i2c_init
+ * Name: maia_i2c_acquire
  *
  * Description:
- *   Initialize I2C master bus with SDA=GPIO5, SCL=GPIO6 at 400kHz.
+ *   Get the grant of a bus for a lane. Free bus: taken immediately. Busy
+ *   bus: wait on the lane semaphore until a release hands the grant over.
  *
- * Input Parameters:
- *   None
+ *   A waiter that times out only gives up if it is still counted in its
+ *   lane; otherwise a release already granted the bus to this lane and
+ *   the waiter must consume that grant (it then owns the bus).
  *
  * Returned Value:
- *   ESP_OK on success; ESP_FAIL on failure.
+ *   ESP_OK with the bus granted; ESP_ERR_TIMEOUT otherwise.
  *
  ****************************************************************************/
 
-esp_err_t maia_i2c_init(void)
+static esp_err_t maia_i2c_acquire(struct maia_i2c_bus_s *bus,
+                                  maia_i2c_prio_t prio, int timeout_ms)
 {
+  bool granted = false;
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  if (!bus->busy)
+    {
+      bus->busy = true;
+      granted = true;
+    }
+  else
+    {
+      bus->waiting[prio]++;
+    }
+
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  if (granted)
+    {
+      return ESP_OK;
+    }
+
+  if (xSemaphoreTake(bus->lane[prio], pdMS_TO_TICKS(timeout_ms)) == pdTRUE)
+    {
+      return ESP_OK;
+    }
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  if (bus->waiting[prio] > 0)
+    {
+      bus->waiting[prio]--;
+      granted = false;
+    }
+  else
+    {
+      granted = true;
+    }
+
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  if (granted)
+    {
+      xSemaphoreTake(bus->lane[prio], portMAX_DELAY);
+      return ESP_OK;
+    }
+
+  return ESP_ERR_TIMEOUT;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_release
+ *
+ * Description:
+ *   Hand the bus to the most urgent waiting lane, or mark it free.
+ *
+ ****************************************************************************/
+
+static void maia_i2c_release(struct maia_i2c_bus_s *bus)
+{
+  int next = -1;
+
+  maia_pm_busy_release();
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  for (int p = 0; p < MAIA_I2C_PRIO_COUNT; p++)
+    {
+      if (bus->waiting[p] > 0)
+        {
+          bus->waiting[p]--;
+          next = p;
+          break;
+        }
+    }
+
+  if (next < 0)
+    {
+      bus->busy = false;
+    }
+
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  if (next >= 0)
+    {
+      xSemaphoreGive(bus->lane[next]);
+    }
+}
+
+/****************************************************************************
+ * Name: maia_i2c_account
+ *
+ * Description:
+ *   Update device statistics after a transaction.
+ *
+ ****************************************************************************/
+
+static void maia_i2c_account(struct maia_i2c_dev_s *dev, esp_err_t ret,
+                             size_t bytes, int64_t t_request,
+                             int64_t t_grant, int64_t t_done)
+{
+  uint32_t wait_us = (uint32_t)(t_grant - t_request);
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  if (ret == ESP_OK)
+    {
+      dev->stats.transactions++;
+      dev->stats.bytes += bytes;
+    }
+  else
+    {
+      dev->stats.errors++;
+    }
+
+  dev->stats.busy_us += t_done - t_grant;
+  dev->bus->busy_us += t_done - t_grant;
+  if (wait_us > dev->stats.max_wait_us)
+    {
+      dev->stats.max_wait_us = wait_us;
+    }
+
+  portEXIT_CRITICAL(&g_i2c_lock);
+}
+
+/****************************************************************************
+ * Name: maia_i2c_grant
+ *
+ * Description:
+ *   Acquire the bus for a device, counting grant timeouts. The owner
+ *   holds the board busy lock: no light sleep or APB change mid-transfer.
+ *
+ ****************************************************************************/
+
+static esp_err_t maia_i2c_grant(struct maia_i2c_dev_s *dev, int timeout_ms)
+{
+  esp_err_t ret = maia_i2c_acquire(dev->bus, dev->prio, timeout_ms);
+
+  if (ret != ESP_OK)
+    {
+      portENTER_CRITICAL(&g_i2c_lock);
+      dev->stats.timeouts++;
+      portEXIT_CRITICAL(&g_i2c_lock);
+    }
+  else
+    {
+      maia_pm_busy_acquire();     /* Until maia_i2c_release() */
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_bus_init
+ *
+ * Description:
+ *   Create the master bus of one controller and its arbiter lanes.
+ *
+ ****************************************************************************/
+
+static esp_err_t maia_i2c_bus_init(maia_i2c_bus_t id, i2c_port_num_t port,
+                                   int sda, int scl, uint32_t freq_hz)
+{
+  struct maia_i2c_bus_s *bus = &g_i2c_buses[id];
   esp_err_t ret;
 
-  ESP_LOGI(TAG, "Initializing I2C bus (SDA=%d, SCL=%d, %dHz)",
-           MAIA_GPIO_I2C_SDA, MAIA_GPIO_I2C_SCL, MAIA_I2C_FREQ_HZ);
+  ESP_LOGI(TAG, "Initializing I2C bus %d (SDA=%d, SCL=%d, %" PRIu32 "Hz)",
+           id, sda, scl, freq_hz);
 
   i2c_master_bus_config_t bus_config = {
       .clk_source = I2C_CLK_SRC_DEFAULT,
-      .i2c_port = MAIA_I2C_PORT,
-      .scl_io_num = MAIA_GPIO_I2C_SCL,
-      .sda_io_num = MAIA_GPIO_I2C_SDA,
+      .i2c_port = port,
+      .scl_io_num = scl,
+      .sda_io_num = sda,
       .glitch_ignore_cnt = 7,
       .flags.enable_internal_pullup = false,  /* External 2.2k pull-ups */
   };
 
-  ret = i2c_new_master_bus(&bus_config, &g_i2c_bus_handle);
+  ret = i2c_new_master_bus(&bus_config, &bus->handle);
   if (ret != ESP_OK)
     {
-      ESP_LOGE(TAG, "Failed to create I2C master bus: %s",
+      ESP_LOGE(TAG, "Failed to create I2C master bus %d: %s", id,
                esp_err_to_name(ret));
       return ret;
     }
 
+  /* Arbiter lanes: one grant semaphore per priority */
+
+  for (int p = 0; p < MAIA_I2C_PRIO_COUNT; p++)
+    {
+      bus->lane[p] = xSemaphoreCreateCountingStatic(UINT8_MAX, 0,
+                                                    &bus->lane_buf[p]);
+      if (bus->lane[p] == NULL)
+        {
+          ESP_LOGE(TAG, "Failed to create arbiter lane %d", p);
+          return ESP_ERR_NO_MEM;
+        }
+    }
+
+  bus->freq_hz = freq_hz;
+  bus->stats_since_us = esp_timer_get_time();
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_i2c_init
+ *
+ * Description:
+ *   Initialize I2C master bus 0 (SDA=GPIO5, SCL=GPIO6) and, with
+ *   CONFIG_MAIA_I2C_BUS1_ENABLE, bus 1 on its configured pins.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_FAIL on failure.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_init(void)
+{
+  esp_err_t ret;
+
+  ret = maia_i2c_bus_init(MAIA_I2C_BUS_0, MAIA_I2C_PORT, MAIA_GPIO_I2C_SDA,
+                          MAIA_GPIO_I2C_SCL, MAIA_I2C_FREQ_HZ);
+
+#ifdef CONFIG_MAIA_I2C_BUS1_ENABLE
+  if (ret == ESP_OK)
+    {
+      ret = maia_i2c_bus_init(MAIA_I2C_BUS_1, MAIA_I2C1_PORT,
+                              MAIA_GPIO_I2C1_SDA, MAIA_GPIO_I2C1_SCL,
+                              MAIA_I2C1_FREQ_HZ);
+    }
+#endif
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
   ESP_LOGI(TAG, "I2C bus initialized successfully");
 
   return ESP_OK;
@@ -92,17 +373,379 @@ esp_err_t maia_i2c_init(void)
  * Name: maia_i2c_get_bus_handle
  *
  * Description:
- *   Get the I2C master bus handle for device registration.
+ *   Get the I2C master bus handle of a bus.
  *
  * Input Parameters:
- *   None
+ *   bus - MAIA_I2C_BUS_0 or MAIA_I2C_BUS_1
  *
  * Returned Value:
  *   I2C master bus handle, or NULL if not initialized.
  *
  ****************************************************************************/
 
-i2c_master_bus_handle_t maia_i2c_get_bus_handle(void)
+i2c_master_bus_handle_t maia_i2c_get_bus_handle(maia_i2c_bus_t bus)
 {
-  return g_i2c_bus_handle;
-}
\ No newline at end of file
+  return bus < MAIA_I2C_BUS_COUNT ? g_i2c_buses[bus].handle : NULL;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_bus_freq
+ ****************************************************************************/
+
+uint32_t maia_i2c_get_bus_freq(maia_i2c_bus_t bus)
+{
+  return bus < MAIA_I2C_BUS_COUNT ? g_i2c_buses[bus].freq_hz : 0;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_add_device
+ *
+ * Description:
+ *   Register a device with the I2C arbiter.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_add_device(const maia_i2c_dev_config_t *config,
+                              maia_i2c_dev_handle_t *dev)
+{
+  esp_err_t ret;
+  struct maia_i2c_dev_s *slot = NULL;
+  struct maia_i2c_bus_s *bus;
+
+  if (config == NULL || dev == NULL || config->prio >= MAIA_I2C_PRIO_COUNT ||
+      config->bus >= MAIA_I2C_BUS_COUNT)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  bus = &g_i2c_buses[config->bus];
+  if (bus->handle == NULL)
+    {
+      ESP_LOGE(TAG, "I2C bus %d not initialized", config->bus);
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES; i++)
+    {
+      if (!g_i2c_devices[i].in_use)
+        {
+          slot = &g_i2c_devices[i];
+          memset(slot, 0, sizeof(*slot));
+          slot->in_use = true;
+          break;
+        }
+    }
+
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  if (slot == NULL)
+    {
+      ESP_LOGE(TAG, "No free device slot for %s", config->name);
+      return ESP_ERR_NO_MEM;
+    }
+
+  i2c_device_config_t dev_cfg = {
+      .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+      .device_address = config->addr,
+      .scl_speed_hz = config->scl_speed_hz ? config->scl_speed_hz :
+                                             bus->freq_hz,
+  };
+
+  ret = i2c_master_bus_add_device(bus->handle, &dev_cfg, &slot->handle);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to add %s @ 0x%02X: %s", config->name,
+               config->addr, esp_err_to_name(ret));
+      slot->in_use = false;
+      return ret;
+    }
+
+  slot->name = config->name ? config->name : "?";
+  slot->addr = config->addr;
+  slot->bus_id = config->bus;
+  slot->bus = bus;
+  slot->prio = config->prio;
+  slot->splittable = config->splittable;
+
+  *dev = slot;
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_remove_device
+ *
+ * Description:
+ *   Unregister a device and free its slot.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_remove_device(maia_i2c_dev_handle_t dev)
+{
+  esp_err_t ret;
+
+  if (dev == NULL || !dev->in_use)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  ret = i2c_master_bus_rm_device(dev->handle);
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  dev->handle = NULL;
+  dev->in_use = false;
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_transmit
+ *
+ * Description:
+ *   Write a buffer to a device as one transaction.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit(maia_i2c_dev_handle_t dev, const uint8_t *data,
+                            size_t len, int timeout_ms)
+{
+  esp_err_t ret;
+  int64_t t_request;
+  int64_t t_grant;
+
+  if (dev == NULL || !dev->in_use)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  t_request = esp_timer_get_time();
+  ret = maia_i2c_grant(dev, timeout_ms);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  t_grant = esp_timer_get_time();
+  ret = i2c_master_transmit(dev->handle, data, len, timeout_ms);
+  maia_i2c_account(dev, ret, len, t_request, t_grant, esp_timer_get_time());
+  maia_i2c_release(dev->bus);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_transmit_prefixed
+ *
+ * Description:
+ *   Write prefix + payload, split into chunks on splittable devices.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit_prefixed(maia_i2c_dev_handle_t dev,
+                                     const uint8_t *prefix,
+                                     size_t prefix_len,
+                                     const uint8_t *data, size_t len,
+                                     int timeout_ms)
+{
+  esp_err_t ret = ESP_OK;
+  size_t chunk;
+  uint8_t pfx[MAIA_I2C_PREFIX_MAX];
+  i2c_master_transmit_multi_buffer_info_t bufs[2];
+
+  if (dev == NULL || !dev->in_use || prefix_len > MAIA_I2C_PREFIX_MAX)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  /* The driver may read the buffer list from ISR context: keep the
+   * prefix in a local copy that lives for the whole call.
+   */
+
+  memcpy(pfx, prefix, prefix_len);
+  chunk = dev->splittable ? MAIA_I2C_SPLIT_SIZE : len;
+
+  do
+    {
+      size_t n = (len > chunk) ? chunk : len;
+      int64_t t_request = esp_timer_get_time();
+      int64_t t_grant;
+
+      bufs[0].write_buffer = pfx;
+      bufs[0].buffer_size = prefix_len;
+      bufs[1].write_buffer = (uint8_t *)data;
+      bufs[1].buffer_size = n;
+
+      ret = maia_i2c_grant(dev, timeout_ms);
+      if (ret != ESP_OK)
+        {
+          break;
+        }
+
+      t_grant = esp_timer_get_time();
+      ret = i2c_master_multi_buffer_transmit(dev->handle, bufs, 2,
+                                             timeout_ms);
+      maia_i2c_account(dev, ret, prefix_len + n, t_request, t_grant,
+                       esp_timer_get_time());
+      maia_i2c_release(dev->bus);
+
+      data += n;
+      len -= n;
+    }
+  while (ret == ESP_OK && len > 0);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_transmit_receive
+ *
+ * Description:
+ *   Write then read with a repeated start.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit_receive(maia_i2c_dev_handle_t dev,
+                                    const uint8_t *wr_data, size_t wr_len,
+                                    uint8_t *rd_data, size_t rd_len,
+                                    int timeout_ms)
+{
+  esp_err_t ret;
+  int64_t t_request;
+  int64_t t_grant;
+
+  if (dev == NULL || !dev->in_use)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  t_request = esp_timer_get_time();
+  ret = maia_i2c_grant(dev, timeout_ms);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  t_grant = esp_timer_get_time();
+  ret = i2c_master_transmit_receive(dev->handle, wr_data, wr_len,
+                                    rd_data, rd_len, timeout_ms);
+  maia_i2c_account(dev, ret, wr_len + rd_len, t_request, t_grant,
+                   esp_timer_get_time());
+  maia_i2c_release(dev->bus);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_stats
+ *
+ * Description:
+ *   Read bus occupancy statistics of a device.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_get_stats(maia_i2c_dev_handle_t dev,
+                             maia_i2c_stats_t *stats)
+{
+  if (dev == NULL || stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  *stats = dev->stats;
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_all_stats
+ *
+ * Description:
+ *   Copy the statistics of all registered devices.
+ *
+ ****************************************************************************/
+
+size_t maia_i2c_get_all_stats(maia_i2c_dev_stats_t *out, size_t max)
+{
+  size_t n = 0;
+
+  portENTER_CRITICAL(&g_i2c_lock);
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES && n < max; i++)
+    {
+      struct maia_i2c_dev_s *dev = &g_i2c_devices[i];
+
+      if (dev->in_use)
+        {
+          out[n].name = dev->name;
+          out[n].addr = dev->addr;
+          out[n].bus = dev->bus_id;
+          out[n].stats = dev->stats;
+          n++;
+        }
+    }
+
+  portEXIT_CRITICAL(&g_i2c_lock);
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_log_stats
+ *
+ * Description:
+ *   Log statistics of all registered devices and the utilization of each
+ *   bus since the previous call.
+ *
+ ****************************************************************************/
+
+void maia_i2c_log_stats(void)
+{
+  int64_t now = esp_timer_get_time();
+
+  for (int b = 0; b < MAIA_I2C_BUS_COUNT; b++)
+    {
+      struct maia_i2c_bus_s *bus = &g_i2c_buses[b];
+      int64_t window_us;
+      uint64_t busy_us;
+
+      if (bus->handle == NULL)
+        {
+          continue;
+        }
+
+      portENTER_CRITICAL(&g_i2c_lock);
+      busy_us = bus->busy_us;
+      bus->busy_us = 0;
+      window_us = now - bus->stats_since_us;
+      bus->stats_since_us = now;
+      portEXIT_CRITICAL(&g_i2c_lock);
+
+      ESP_LOGI(TAG, "Bus %d utilization: %" PRIu32 ".%" PRIu32
+               "%% over %lld ms", b,
+               (uint32_t)(busy_us * 100 / (window_us ? window_us : 1)),
+               (uint32_t)(busy_us * 1000 / (window_us ? window_us : 1)) % 10,
+               (long long)(window_us / 1000));
+    }
+
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES; i++)
+    {
+      maia_i2c_stats_t st;
+      struct maia_i2c_dev_s *dev = &g_i2c_devices[i];
+
+      if (!dev->in_use)
+        {
+          continue;
+        }
+
+      maia_i2c_get_stats(dev, &st);
+      ESP_LOGI(TAG, "  %-8s %d:0x%02X %-7s tx=%" PRIu32 " bytes=%" PRIu32
+               " busy=%llu ms max_wait=%" PRIu32 " us err=%" PRIu32
+               " timeout=%" PRIu32, dev->name, dev->bus_id, dev->addr,
+               g_i2c_prio_names[dev->prio], st.transactions, st.bytes,
+               (unsigned long long)(st.busy_us / 1000), st.max_wait_us,
+               st.errors, st.timeouts);
+    }
+}
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * components/maia_board/src/maia_latency.c
+ *
+ * MAIA - Motion Assistance for Impaired Animals
+ * Obstacle-to-vibration latency histograms
+ *
+ * One fixed histogram per pipeline stage. Recording is a shift, a
+ * bucket increment and a max update under a spinlock, cheap enough to
+ * stay enabled in release builds; percentiles are only computed when
+ * the stats are read.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[LATENCY]"
+
+#define LAT_BUCKET_US           (1u << MAIA_LAT_BUCKET_SHIFT)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  uint32_t buckets[MAIA_LAT_BUCKETS];
+  uint32_t count;
+  uint32_t max_us;
+} lat_hist_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *const g_stage_names[MAIA_LAT_STAGE_COUNT] =
+{
+  [MAIA_LAT_I2C_READ] = "i2c_read",
+  [MAIA_LAT_FUSION]   = "fusion",
+  [MAIA_LAT_COMMAND]  = "command",
+  [MAIA_LAT_ACTUATOR] = "actuator",
+};
+
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static lat_hist_t g_hist[MAIA_LAT_STAGE_COUNT];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+
+/****************************************************************************
+ * Name: lat_percentile
+ *
+ * Description:
+ *   Upper edge of the bucket holding the given share (per mille) of the
+ *   samples, capped at the exact maximum.
+ *
+ ****************************************************************************/
+
+static uint32_t lat_percentile(const lat_hist_t *h, uint32_t permille)
+{
+  uint32_t target = (uint32_t)(((uint64_t)h->count * permille + 999) /
+                               1000);
+  uint32_t seen = 0;
+
+  for (uint32_t i = 0; i < MAIA_LAT_BUCKETS; i++)
+    {
+      seen += h->buckets[i];
+      if (seen >= target)
+        {
+          uint32_t edge = (i + 1) * LAT_BUCKET_US;
+
+          return edge < h->max_us ? edge : h->max_us;
+        }
+    }
+
+  return h->max_us;
+}
+
+#endif /* CONFIG_MAIA_LATENCY_ENABLE */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_latency_record
+ ****************************************************************************/
+
+void maia_latency_record(maia_lat_stage_t stage, int64_t origin_us,
+                         int64_t now_us)
+{
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+  int64_t dt = now_us - origin_us;
+  uint32_t us;
+  uint32_t idx;
+  lat_hist_t *h;
+
+  if (stage >= MAIA_LAT_STAGE_COUNT || origin_us == 0 || dt < 0)
+    {
+      return;
+    }
+
+  us = dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt;
+  idx = us >> MAIA_LAT_BUCKET_SHIFT;
+  if (idx >= MAIA_LAT_BUCKETS)
+    {
+      idx = MAIA_LAT_BUCKETS - 1;
+    }
+
+  h = &g_hist[stage];
+
+  portENTER_CRITICAL_SAFE(&g_lock);
+  h->buckets[idx]++;
+  h->count++;
+  if (us > h->max_us)
+    {
+      h->max_us = us;
+    }
+
+  portEXIT_CRITICAL_SAFE(&g_lock);
+#else
+  (void)stage;
+  (void)origin_us;
+  (void)now_us;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_latency_get_stats
+ ****************************************************************************/
+
+esp_err_t maia_latency_get_stats(maia_lat_stage_t stage,
+                                 maia_lat_stats_t *stats)
+{
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+  static lat_hist_t h;
+#endif
+
+  if (stage >= MAIA_LAT_STAGE_COUNT || stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  memset(stats, 0, sizeof(*stats));
+
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+  /* Callers are the monitor and display tasks: one static copy is
+   * enough and keeps 512 bytes off their stacks
+   */
+
+  portENTER_CRITICAL(&g_lock);
+  h = g_hist[stage];
+  portEXIT_CRITICAL(&g_lock);
+
+  stats->count = h.count;
+  stats->max_us = h.max_us;
+  if (h.count > 0)
+    {
+      stats->p50_us = lat_percentile(&h, 500);
+      stats->p99_us = lat_percentile(&h, 990);
+    }
+#endif
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_latency_stage_name
+ ****************************************************************************/
+
+const char *maia_latency_stage_name(maia_lat_stage_t stage)
+{
+  return stage < MAIA_LAT_STAGE_COUNT ? g_stage_names[stage] : "?";
+}
+
+/****************************************************************************
+ * Name: maia_latency_log
+ ****************************************************************************/
+
+void maia_latency_log(void)
+{
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+  for (int s = 0; s < MAIA_LAT_STAGE_COUNT; s++)
+    {
+      maia_lat_stats_t st;
+      char line[96];
+      int len = 0;
+
+      maia_latency_get_stats(s, &st);
+      ESP_LOGI(TAG, "%-8s n=%lu p50=%lu p99=%lu max=%lu us",
+               g_stage_names[s], (unsigned long)st.count,
+               (unsigned long)st.p50_us, (unsigned long)st.p99_us,
+               (unsigned long)st.max_us);
+
+      /* Non-empty buckets as "<upper edge ms>:<count>" */
+
+      for (uint32_t i = 0; i < MAIA_LAT_BUCKETS; i++)
+        {
+          uint32_t n = g_hist[s].buckets[i];
+          uint32_t edge = (i + 1) * LAT_BUCKET_US;
+
+          if (n == 0)
+            {
+              continue;
+            }
+
+          len += snprintf(line + len, sizeof(line) - len, " %lu.%02lu:%lu",
+                          (unsigned long)(edge / 1000),
+                          (unsigned long)(edge % 1000 / 10),
+                          (unsigned long)n);
+          if (len >= (int)sizeof(line) - 24)
+            {
+              ESP_LOGI(TAG, " %s", line);
+              len = 0;
+            }
+        }
+
+      if (len > 0)
+        {
+          ESP_LOGI(TAG, " %s", line);
+        }
+    }
+#else
+  ESP_LOGI(TAG, "Latency histograms disabled (CONFIG_MAIA_LATENCY_ENABLE)");
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_latency_reset
+ ****************************************************************************/
+
+void maia_latency_reset(void)
+{
+#ifdef CONFIG_MAIA_LATENCY_ENABLE
+  portENTER_CRITICAL(&g_lock);
+  memset(g_hist, 0, sizeof(g_hist));
+  portEXIT_CRITICAL(&g_lock);
+#endif
+}
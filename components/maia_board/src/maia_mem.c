@@ -0,0 +1,333 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * components/maia_board/src/maia_mem.c
+ *
+ * MAIA - Motion Assistance for Impaired Animals
+ * Static memory model
+ *
+ * Runtime objects live in fixed storage reserved at link time, so the
+ * heap cannot fragment over a day of use:
+ *
+ *   - Fixed-block pools (MAIA_POOL_DEFINE): blocks are carved from the
+ *     pool storage in order the first time, then recycled through a
+ *     free list linked inside the returned blocks. Alloc and free are
+ *     O(1) and never touch the heap.
+ *
+ *   - Heap watch: with CONFIG_HEAP_USE_HOOKS every heap allocation made
+ *     by a watched task is counted, so the benchmark can prove that the
+ *     sensing loop allocates nothing.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+#  include <esp_heap_caps.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MEM]"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Pool state and registry (g_pool_lock) */
+
+static portMUX_TYPE g_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+static maia_pool_t *g_pools = NULL;
+
+/* Watched tasks: g_watch[0..g_watch_count) is written before the count
+ * is raised, so the hook never reads an unset slot
+ */
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+static portMUX_TYPE g_watch_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t g_watch[MAIA_MEM_WATCH_MAX];
+static atomic_uint g_watch_count;
+static atomic_uint g_watch_allocs;
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_pool_alloc
+ ****************************************************************************/
+
+void *maia_pool_alloc(maia_pool_t *pool)
+{
+  uint8_t *block = NULL;
+
+  if (pool == NULL)
+    {
+      return NULL;
+    }
+
+  portENTER_CRITICAL(&g_pool_lock);
+  if (pool->free_list != NULL)
+    {
+      block = pool->free_list;
+      pool->free_list = *(void **)block;
+    }
+  else if (pool->carved < pool->blocks)
+    {
+      block = pool->storage + (size_t)pool->carved * pool->block_size;
+      pool->carved++;
+    }
+
+  if (block != NULL)
+    {
+      pool->in_use++;
+      if (pool->in_use > pool->peak)
+        {
+          pool->peak = pool->in_use;
+        }
+    }
+  else
+    {
+      pool->failures++;
+    }
+
+  if (!pool->registered)
+    {
+      pool->registered = true;
+      pool->next = g_pools;
+      g_pools = pool;
+    }
+
+  portEXIT_CRITICAL(&g_pool_lock);
+
+  return block;
+}
+
+/****************************************************************************
+ * Name: maia_pool_free
+ ****************************************************************************/
+
+void maia_pool_free(maia_pool_t *pool, void *block)
+{
+  if (pool == NULL || block == NULL)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_pool_lock);
+  *(void **)block = pool->free_list;
+  pool->free_list = block;
+  pool->in_use--;
+  portEXIT_CRITICAL(&g_pool_lock);
+}
+
+/****************************************************************************
+ * Name: maia_pool_get_stats
+ ****************************************************************************/
+
+esp_err_t maia_pool_get_stats(const maia_pool_t *pool,
+                              maia_pool_stats_t *stats)
+{
+  if (pool == NULL || stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_pool_lock);
+  stats->name = pool->name;
+  stats->block_size = pool->block_size;
+  stats->blocks = pool->blocks;
+  stats->in_use = pool->in_use;
+  stats->peak = pool->peak;
+  stats->failures = pool->failures;
+  portEXIT_CRITICAL(&g_pool_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_pool_get_all_stats
+ ****************************************************************************/
+
+size_t maia_pool_get_all_stats(maia_pool_stats_t *out, size_t max)
+{
+  const maia_pool_t *pool;
+  size_t n = 0;
+
+  portENTER_CRITICAL(&g_pool_lock);
+  pool = g_pools;
+  portEXIT_CRITICAL(&g_pool_lock);
+
+  /* Pools are never unregistered: the list only grows at the head */
+
+  for (; pool != NULL && n < max; pool = pool->next)
+    {
+      maia_pool_get_stats(pool, &out[n++]);
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: maia_pool_log
+ ****************************************************************************/
+
+void maia_pool_log(void)
+{
+  maia_pool_stats_t st;
+  const maia_pool_t *pool;
+
+  portENTER_CRITICAL(&g_pool_lock);
+  pool = g_pools;
+  portEXIT_CRITICAL(&g_pool_lock);
+
+  for (; pool != NULL; pool = pool->next)
+    {
+      maia_pool_get_stats(pool, &st);
+      ESP_LOGI(TAG, "  %-16s %4u x %4u bytes, in use %u, peak %u, "
+               "failures %" PRIu32, st.name, st.blocks,
+               (unsigned)st.block_size, st.in_use, st.peak, st.failures);
+    }
+}
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+
+/****************************************************************************
+ * Name: esp_heap_trace_alloc_hook
+ *
+ * Description:
+ *   Heap hook, called from the heap API after every allocation (with
+ *   the cache possibly disabled, hence IRAM).
+ *
+ ****************************************************************************/
+
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size,
+                                         uint32_t caps)
+{
+  unsigned count = atomic_load_explicit(&g_watch_count,
+                                        memory_order_acquire);
+  TaskHandle_t self;
+
+  (void)ptr;
+  (void)size;
+  (void)caps;
+
+  if (count == 0)
+    {
+      return;
+    }
+
+  self = xTaskGetCurrentTaskHandle();
+  for (unsigned i = 0; i < count; i++)
+    {
+      if (g_watch[i] == self)
+        {
+          atomic_fetch_add_explicit(&g_watch_allocs, 1,
+                                    memory_order_relaxed);
+          return;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: esp_heap_trace_free_hook
+ ****************************************************************************/
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+  (void)ptr;
+}
+
+#endif /* CONFIG_HEAP_USE_HOOKS */
+
+/****************************************************************************
+ * Name: maia_mem_watch_task
+ ****************************************************************************/
+
+esp_err_t maia_mem_watch_task(const char *name)
+{
+#ifdef CONFIG_HEAP_USE_HOOKS
+  TaskHandle_t task = xTaskGetHandle(name);
+  esp_err_t ret = ESP_OK;
+  unsigned count;
+
+  if (task == NULL)
+    {
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  portENTER_CRITICAL(&g_watch_lock);
+  count = atomic_load_explicit(&g_watch_count, memory_order_relaxed);
+  if (count >= MAIA_MEM_WATCH_MAX)
+    {
+      ret = ESP_ERR_NO_MEM;
+    }
+  else
+    {
+      g_watch[count] = task;
+      atomic_store_explicit(&g_watch_count, count + 1,
+                            memory_order_release);
+    }
+
+  portEXIT_CRITICAL(&g_watch_lock);
+
+  return ret;
+#else
+  (void)name;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_mem_watch_allocs
+ ****************************************************************************/
+
+uint32_t maia_mem_watch_allocs(void)
+{
+#ifdef CONFIG_HEAP_USE_HOOKS
+  return atomic_load_explicit(&g_watch_allocs, memory_order_relaxed);
+#else
+  return 0;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_mem_watch_reset
+ ****************************************************************************/
+
+void maia_mem_watch_reset(void)
+{
+#ifdef CONFIG_HEAP_USE_HOOKS
+  portENTER_CRITICAL(&g_watch_lock);
+  atomic_store_explicit(&g_watch_count, 0, memory_order_release);
+  atomic_store_explicit(&g_watch_allocs, 0, memory_order_relaxed);
+  portEXIT_CRITICAL(&g_watch_lock);
+#endif
+}
@@ -0,0 +1,503 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * components/maia_board/src/maia_onewire_rmt.c
+ *
+ * MAIA - Motion Assistance for Impaired Animals
+ * OneWire protocol, RMT peripheral backend
+ *
+ * TX and RX RMT channels share the OneWire GPIO (open drain, loop back).
+ * Each slot is one RMT symbol (low time, recovery time): write bytes are
+ * generated by a bytes encoder, reads send 0xFF write-1 slots while the
+ * RX channel captures how long the bus stayed low in each of them. The
+ * calling task sleeps on the TX/RX completion instead of spinning in
+ * esp_rom_delay_us(), and slot timing no longer depends on interrupt
+ * latency.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+
+#ifdef CONFIG_MAIA_ONEWIRE_BACKEND_RMT
+
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <driver/gpio.h>
+#include <driver/rmt_tx.h>
+#include <driver/rmt_rx.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MAIA_ONEWIRE]"
+
+/* 1 MHz RMT clock: one tick per microsecond */
+
+#define OW_RMT_RESOLUTION_HZ    1000000
+#define OW_RMT_MEM_SYMBOLS      64
+#define OW_RMT_RX_MEM_SYMBOLS   96     /* Two ESP32-S3 RMT memory blocks */
+#define OW_RMT_TIMEOUT_MS       20
+
+/* OneWire timing constants (microseconds), same slots as the GPIO
+ * backend
+ */
+
+#define OW_RESET_LOW_US         480    /* Reset pulse duration */
+#define OW_RESET_RELEASE_US     480    /* Presence window */
+#define OW_WRITE_0_LOW_US       60     /* Write 0: low duration */
+#define OW_WRITE_0_HIGH_US      10     /* Write 0: recovery time */
+#define OW_WRITE_1_LOW_US       6      /* Write 1 / read: low duration */
+#define OW_WRITE_1_HIGH_US      64     /* Write 1 / read: recovery time */
+
+/* Read slot decoding: a device answering 0 holds the bus low well past
+ * the master's 6 us pulse
+ */
+
+#define OW_READ_THRESHOLD_US    15
+
+/* Presence pulse: 60-240 us low after the reset pulse */
+
+#define OW_PRESENCE_MIN_US      50
+
+/* RX: pulses shorter than this are glitches; a level held longer ends
+ * the capture. Reset captures must span the reset pulse, slot captures
+ * end shortly after the last slot.
+ */
+
+#define OW_RX_MIN_NS            1000
+#define OW_RX_RESET_MAX_NS      ((OW_RESET_LOW_US + 80) * 1000)
+#define OW_RX_SLOT_MAX_NS       ((OW_WRITE_1_HIGH_US + 36) * 1000)
+
+/* Read slots captured per RX transaction (one symbol per bit, must fit
+ * the RX channel memory)
+ */
+
+#define OW_RX_BLOCK_BYTES       8
+#define OW_RX_SYMBOLS           (OW_RX_BLOCK_BYTES * 8 + 8)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static rmt_channel_handle_t g_tx = NULL;
+static rmt_channel_handle_t g_rx = NULL;
+static rmt_encoder_handle_t g_bytes_encoder = NULL;
+static rmt_encoder_handle_t g_copy_encoder = NULL;
+static QueueHandle_t g_rx_queue = NULL;
+static uint8_t g_rx_queue_storage[sizeof(rmt_rx_done_event_data_t)];
+static StaticQueue_t g_rx_queue_buf;
+static rmt_symbol_word_t g_rx_symbols[OW_RX_SYMBOLS];
+
+static const rmt_symbol_word_t g_reset_symbol =
+{
+  .level0 = 0, .duration0 = OW_RESET_LOW_US,
+  .level1 = 1, .duration1 = OW_RESET_RELEASE_US,
+};
+
+static const rmt_symbol_word_t g_bit_symbols[2] =
+{
+  {
+    .level0 = 0, .duration0 = OW_WRITE_0_LOW_US,
+    .level1 = 1, .duration1 = OW_WRITE_0_HIGH_US,
+  },
+  {
+    .level0 = 0, .duration0 = OW_WRITE_1_LOW_US,
+    .level1 = 1, .duration1 = OW_WRITE_1_HIGH_US,
+  },
+};
+
+static const rmt_transmit_config_t g_tx_config =
+{
+  .loop_count = 0,
+  .flags.eot_level = 1,                 /* Release the bus when done */
+};
+
+static const rmt_receive_config_t g_rx_reset_config =
+{
+  .signal_range_min_ns = OW_RX_MIN_NS,
+  .signal_range_max_ns = OW_RX_RESET_MAX_NS,
+};
+
+static const rmt_receive_config_t g_rx_slot_config =
+{
+  .signal_range_min_ns = OW_RX_MIN_NS,
+  .signal_range_max_ns = OW_RX_SLOT_MAX_NS,
+};
+
+/* Read slots are write-1 slots */
+
+static const uint8_t g_read_slots[OW_RX_BLOCK_BYTES] =
+{
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: onewire_rmt_rx_done
+ *
+ * Description:
+ *   RX capture complete (ISR context): hand the result to the waiting
+ *   task.
+ *
+ ****************************************************************************/
+
+static bool IRAM_ATTR
+onewire_rmt_rx_done(rmt_channel_handle_t channel,
+                    const rmt_rx_done_event_data_t *edata, void *user_ctx)
+{
+  BaseType_t woken = pdFALSE;
+
+  (void)channel;
+  (void)user_ctx;
+
+  xQueueSendFromISR(g_rx_queue, edata, &woken);
+
+  return woken == pdTRUE;
+}
+
+/****************************************************************************
+ * Name: onewire_rmt_transfer
+ *
+ * Description:
+ *   Send symbols (copy encoder) or bytes (bytes encoder) and, if rx_config
+ *   is not NULL, capture the bus while doing so.
+ *
+ * Returned Value:
+ *   Number of captured symbols; -1 on error or timeout.
+ *
+ ****************************************************************************/
+
+static int onewire_rmt_transfer(rmt_encoder_handle_t encoder,
+                                const void *data, size_t len,
+                                const rmt_receive_config_t *rx_config)
+{
+  rmt_rx_done_event_data_t rx;
+
+  if (rx_config != NULL)
+    {
+      xQueueReset(g_rx_queue);
+
+      if (rmt_receive(g_rx, g_rx_symbols, sizeof(g_rx_symbols),
+                      rx_config) != ESP_OK)
+        {
+          return -1;
+        }
+    }
+
+  if (rmt_transmit(g_tx, encoder, data, len, &g_tx_config) != ESP_OK ||
+      rmt_tx_wait_all_done(g_tx, OW_RMT_TIMEOUT_MS) != ESP_OK)
+    {
+      return -1;
+    }
+
+  if (rx_config == NULL)
+    {
+      return 0;
+    }
+
+  if (xQueueReceive(g_rx_queue, &rx,
+                    pdMS_TO_TICKS(OW_RMT_TIMEOUT_MS)) != pdTRUE)
+    {
+      return -1;
+    }
+
+  return (int)rx.num_symbols;
+}
+
+/****************************************************************************
+ * Name: onewire_rmt_decode_bits
+ *
+ * Description:
+ *   Decode captured read slots first..first+bits-1, LSB first.
+ *
+ ****************************************************************************/
+
+static uint8_t onewire_rmt_decode_bits(int num_symbols, int first,
+                                       int bits)
+{
+  uint8_t value = 0;
+
+  for (int i = 0; i < bits; i++)
+    {
+      int s = first + i;
+
+      /* A missing slot reads as 1 (idle bus) */
+
+      if (s < num_symbols && g_rx_symbols[s].level0 == 0 &&
+          g_rx_symbols[s].duration0 > OW_READ_THRESHOLD_US)
+        {
+          continue;
+        }
+
+      value |= 1u << i;
+    }
+
+  return value;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_onewire_init
+ *
+ * Description:
+ *   Create the RMT TX/RX channels and encoders on the OneWire GPIO.
+ *   External 4.7kΩ pull-up resistor required.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_onewire_init(void)
+{
+  esp_err_t ret;
+
+  rmt_tx_channel_config_t tx_cfg = {
+    .gpio_num = MAIA_GPIO_ONEWIRE,
+    .clk_src = RMT_CLK_SRC_DEFAULT,
+    .resolution_hz = OW_RMT_RESOLUTION_HZ,
+    .mem_block_symbols = OW_RMT_MEM_SYMBOLS,
+    .trans_queue_depth = 4,
+    .flags.io_loop_back = 1,            /* RX sees the TX signal */
+    .flags.io_od_mode = 1,              /* Open drain, bus pull-up */
+  };
+
+  rmt_rx_channel_config_t rx_cfg = {
+    .gpio_num = MAIA_GPIO_ONEWIRE,
+    .clk_src = RMT_CLK_SRC_DEFAULT,
+    .resolution_hz = OW_RMT_RESOLUTION_HZ,
+    .mem_block_symbols = OW_RMT_RX_MEM_SYMBOLS,
+  };
+
+  rmt_bytes_encoder_config_t bytes_cfg = {
+    .bit0 = g_bit_symbols[0],
+    .bit1 = g_bit_symbols[1],
+    .flags.msb_first = 0,               /* OneWire is LSB first */
+  };
+
+  rmt_copy_encoder_config_t copy_cfg = {0};
+
+  rmt_rx_event_callbacks_t cbs = {
+    .on_recv_done = onewire_rmt_rx_done,
+  };
+
+  g_rx_queue = xQueueCreateStatic(1, sizeof(rmt_rx_done_event_data_t),
+                                  g_rx_queue_storage, &g_rx_queue_buf);
+
+  /* TX first: the RX channel attaches to the already routed pin */
+
+  ret = rmt_new_tx_channel(&tx_cfg, &g_tx);
+  if (ret == ESP_OK)
+    {
+      ret = rmt_new_rx_channel(&rx_cfg, &g_rx);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = rmt_new_bytes_encoder(&bytes_cfg, &g_bytes_encoder);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = rmt_new_copy_encoder(&copy_cfg, &g_copy_encoder);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = rmt_rx_register_event_callbacks(g_rx, &cbs, NULL);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = rmt_enable(g_tx);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = rmt_enable(g_rx);
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to set up RMT OneWire: %s",
+               esp_err_to_name(ret));
+      return ret;
+    }
+
+  ESP_LOGI(TAG, "OneWire (RMT) initialized on GPIO%d "
+           "(4.7k external pull-up)", MAIA_GPIO_ONEWIRE);
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_onewire_reset
+ *
+ * Description:
+ *   Send reset pulse and detect presence.
+ *   Returns true if at least one device responded.
+ *
+ *   The RMT channels are bound to MAIA_GPIO_ONEWIRE at init; pin is
+ *   accepted for API compatibility with the GPIO backend.
+ *
+ ****************************************************************************/
+
+bool maia_onewire_reset(gpio_num_t pin)
+{
+  int n;
+
+  (void)pin;
+
+  n = onewire_rmt_transfer(g_copy_encoder, &g_reset_symbol,
+                           sizeof(g_reset_symbol), &g_rx_reset_config);
+
+  /* Symbol 0 = our reset pulse, symbol 1 = presence pulse */
+
+  return n >= 2 && g_rx_symbols[1].level0 == 0 &&
+         g_rx_symbols[1].duration0 >= OW_PRESENCE_MIN_US;
+}
+
+/****************************************************************************
+ * Name: maia_onewire_write_bit
+ *
+ * Description:
+ *   Write single bit on OneWire bus.
+ *
+ ****************************************************************************/
+
+void maia_onewire_write_bit(gpio_num_t pin, uint8_t bit)
+{
+  (void)pin;
+
+  onewire_rmt_transfer(g_copy_encoder, &g_bit_symbols[bit & 1],
+                       sizeof(rmt_symbol_word_t), NULL);
+}
+
+/****************************************************************************
+ * Name: maia_onewire_read_bit
+ *
+ * Description:
+ *   Read single bit from OneWire bus (one write-1 slot, captured).
+ *
+ ****************************************************************************/
+
+uint8_t maia_onewire_read_bit(gpio_num_t pin)
+{
+  int n;
+
+  (void)pin;
+
+  n = onewire_rmt_transfer(g_copy_encoder, &g_bit_symbols[1],
+                           sizeof(rmt_symbol_word_t), &g_rx_slot_config);
+
+  return onewire_rmt_decode_bits(n, 0, 1);
+}
+
+/****************************************************************************
+ * Name: maia_onewire_write_byte
+ *
+ * Description:
+ *   Write byte on OneWire bus (LSB first), 8 slots in one transmission.
+ *
+ ****************************************************************************/
+
+void maia_onewire_write_byte(gpio_num_t pin, uint8_t byte)
+{
+  (void)pin;
+
+  onewire_rmt_transfer(g_bytes_encoder, &byte, 1, NULL);
+}
+
+/****************************************************************************
+ * Name: maia_onewire_read_byte
+ *
+ * Description:
+ *   Read byte from OneWire bus (LSB first): 8 read slots sent as 0xFF
+ *   and captured in one RX transaction.
+ *
+ ****************************************************************************/
+
+uint8_t maia_onewire_read_byte(gpio_num_t pin)
+{
+  uint8_t byte;
+
+  maia_onewire_read_block(pin, &byte, 1);
+
+  return byte;
+}
+
+/****************************************************************************
+ * Name: maia_onewire_write_block
+ *
+ * Description:
+ *   Write a buffer on OneWire bus in one transmission.
+ *
+ ****************************************************************************/
+
+void maia_onewire_write_block(gpio_num_t pin, const uint8_t *data,
+                              size_t len)
+{
+  (void)pin;
+
+  if (len > 0)
+    {
+      onewire_rmt_transfer(g_bytes_encoder, data, len, NULL);
+    }
+}
+
+/****************************************************************************
+ * Name: maia_onewire_read_block
+ *
+ * Description:
+ *   Read a buffer from OneWire bus, OW_RX_BLOCK_BYTES per RX transaction
+ *   (the bus simply idles high between transactions).
+ *
+ ****************************************************************************/
+
+void maia_onewire_read_block(gpio_num_t pin, uint8_t *data, size_t len)
+{
+  (void)pin;
+
+  while (len > 0)
+    {
+      size_t chunk = len < OW_RX_BLOCK_BYTES ? len : OW_RX_BLOCK_BYTES;
+      int n;
+
+      n = onewire_rmt_transfer(g_bytes_encoder, g_read_slots, chunk,
+                               &g_rx_slot_config);
+
+      for (size_t i = 0; i < chunk; i++)
+        {
+          data[i] = n < 0 ? 0xFF :
+                    onewire_rmt_decode_bits(n, (int)i * 8, 8);
+        }
+
+      data += chunk;
+      len -= chunk;
+    }
+}
+
+#endif /* CONFIG_MAIA_ONEWIRE_BACKEND_RMT */
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * components/maia_board/src/maia_pm.c
+ *
+ * MAIA - Motion Assistance for Impaired Animals
+ * Board power management hooks: busy lock and light sleep wake pins
+ *
+ * The GPIO only wakes the chip on a level, while the sensor drivers
+ * need edge interrupts. The light sleep entry callback switches each
+ * wake pin to its active level, and the exit callback puts the edge
+ * back. The level interrupt latched while asleep stays pending, so the
+ * pin's ISR runs as soon as interrupts are enabled again. A pin already
+ * at its active level before the sleep had its edge handled, and its
+ * pending bit is cleared so that level is not taken for a new edge.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+#ifdef CONFIG_PM_ENABLE
+#  include <esp_pm.h>
+#  include <esp_sleep.h>
+#  include <hal/gpio_ll.h>
+#  include <soc/gpio_struct.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MAIA_PM]"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  gpio_num_t pin;
+  uint8_t level;                    /* Active level */
+  bool asserted;                    /* At its active level before sleep */
+} pm_wake_pin_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_PM_ENABLE
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_pm_lock_handle_t g_busy_lock = NULL;
+
+/* Busy lock accounting (g_lock) */
+
+static uint32_t g_busy = 0;
+static int64_t g_busy_since_us = 0;
+
+/* Wake pins (g_lock, read by the sleep callbacks) */
+
+static pm_wake_pin_t g_wake[MAIA_PM_WAKE_MAX_PINS];
+static uint8_t g_nb_wake = 0;
+
+static maia_pm_stats_t g_stats;
+static int64_t g_init_us = 0;
+
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_PM_ENABLE
+
+/****************************************************************************
+ * Name: pm_pending / pm_clear
+ *
+ * Description:
+ *   Interrupt status bit of a pin (GPIO 0-31 and 32-48 banks).
+ *
+ ****************************************************************************/
+
+static inline bool IRAM_ATTR pm_pending(gpio_num_t pin)
+{
+  return pin < 32 ? (GPIO.status >> pin) & 1 :
+                    (GPIO.status1.val >> (pin - 32)) & 1;
+}
+
+static inline void IRAM_ATTR pm_clear(gpio_num_t pin)
+{
+  if (pin < 32)
+    {
+      gpio_ll_clear_intr_status(&GPIO, 1u << pin);
+    }
+  else
+    {
+      gpio_ll_clear_intr_status_high(&GPIO, 1u << (pin - 32));
+    }
+}
+
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+
+/****************************************************************************
+ * Name: pm_sleep_enter
+ *
+ * Description:
+ *   Light sleep entry (interrupts off): wake pins to level wake sources.
+ *
+ ****************************************************************************/
+
+static esp_err_t IRAM_ATTR pm_sleep_enter(int64_t sleep_time_us, void *arg)
+{
+  (void)sleep_time_us;
+  (void)arg;
+
+  for (int i = 0; i < g_nb_wake; i++)
+    {
+      pm_wake_pin_t *w = &g_wake[i];
+
+      w->asserted = gpio_ll_get_level(&GPIO, w->pin) == w->level;
+      gpio_ll_set_intr_type(&GPIO, w->pin, w->level ?
+                            GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+      gpio_ll_wakeup_enable(&GPIO, w->pin);
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: pm_sleep_exit
+ *
+ * Description:
+ *   Light sleep exit (interrupts off): edge interrupts back, level seen
+ *   before the sleep discarded, sleep accounted.
+ *
+ ****************************************************************************/
+
+static esp_err_t IRAM_ATTR pm_sleep_exit(int64_t sleep_time_us, void *arg)
+{
+  bool gpio_wake = false;
+
+  (void)arg;
+
+  for (int i = 0; i < g_nb_wake; i++)
+    {
+      pm_wake_pin_t *w = &g_wake[i];
+
+      gpio_ll_wakeup_disable(&GPIO, w->pin);
+      gpio_ll_set_intr_type(&GPIO, w->pin, w->level ?
+                            GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+
+      if (w->asserted)
+        {
+          pm_clear(w->pin);
+        }
+      else if (pm_pending(w->pin))
+        {
+          gpio_wake = true;
+        }
+    }
+
+  portENTER_CRITICAL_ISR(&g_lock);
+  g_stats.sleeps++;
+  g_stats.sleep_us += sleep_time_us;
+  g_stats.gpio_wakes += gpio_wake;
+  portEXIT_CRITICAL_ISR(&g_lock);
+
+  return ESP_OK;
+}
+
+#endif /* CONFIG_PM_LIGHT_SLEEP_CALLBACKS */
+#endif /* CONFIG_PM_ENABLE */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_pm_init
+ ****************************************************************************/
+
+esp_err_t maia_pm_init(void)
+{
+#ifdef CONFIG_PM_ENABLE
+  esp_err_t ret;
+
+  ret = esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "maia_busy",
+                           &g_busy_lock);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to create busy lock: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+  esp_pm_sleep_cbs_register_config_t cbs = {
+      .enter_cb = pm_sleep_enter,
+      .exit_cb = pm_sleep_exit,
+  };
+
+  ret = esp_pm_light_sleep_register_cbs(&cbs);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to register sleep callbacks: %s",
+               esp_err_to_name(ret));
+      return ret;
+    }
+#endif
+
+  g_init_us = esp_timer_get_time();
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_pm_wake_enable
+ ****************************************************************************/
+
+esp_err_t maia_pm_wake_enable(gpio_num_t pin, int level)
+{
+#if defined(CONFIG_PM_ENABLE) && defined(CONFIG_PM_LIGHT_SLEEP_CALLBACKS)
+  esp_err_t ret = ESP_OK;
+
+  if (g_busy_lock == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_nb_wake < MAIA_PM_WAKE_MAX_PINS)
+    {
+      g_wake[g_nb_wake].pin = pin;
+      g_wake[g_nb_wake].level = level ? 1 : 0;
+      g_wake[g_nb_wake].asserted = false;
+      g_nb_wake++;
+    }
+  else
+    {
+      ret = ESP_ERR_NO_MEM;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  if (ret == ESP_OK)
+    {
+      ret = esp_sleep_enable_gpio_wakeup();
+    }
+
+  return ret;
+#else
+  (void)pin;
+  (void)level;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_pm_busy_acquire
+ ****************************************************************************/
+
+void maia_pm_busy_acquire(void)
+{
+#ifdef CONFIG_PM_ENABLE
+  if (g_busy_lock == NULL)
+    {
+      return;
+    }
+
+  esp_pm_lock_acquire(g_busy_lock);
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_busy++ == 0)
+    {
+      g_busy_since_us = esp_timer_get_time();
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_pm_busy_release
+ ****************************************************************************/
+
+void maia_pm_busy_release(void)
+{
+#ifdef CONFIG_PM_ENABLE
+  if (g_busy_lock == NULL)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (--g_busy == 0)
+    {
+      g_stats.busy_us += esp_timer_get_time() - g_busy_since_us;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  esp_pm_lock_release(g_busy_lock);
+#endif
+}
+
+/****************************************************************************
+ * Name: maia_pm_get_stats
+ ****************************************************************************/
+
+void maia_pm_get_stats(maia_pm_stats_t *stats)
+{
+#ifdef CONFIG_PM_ENABLE
+  int64_t now = esp_timer_get_time();
+
+  portENTER_CRITICAL(&g_lock);
+  *stats = g_stats;
+  if (g_busy > 0)
+    {
+      stats->busy_us += now - g_busy_since_us;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  stats->uptime_us = g_init_us > 0 ? now - g_init_us : 0;
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
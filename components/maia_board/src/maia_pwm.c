@@ -28,6 +28,11 @@
 
 #include "maia_board.h"
 #include <esp_log.h>
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <string.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -35,6 +40,306 @@
 
 #define TAG "[MAIA_PWM]"
 
+/* Fade sequencer task: woken once per segment, not per duty step */
+
+#define MAIA_PWM_FADE_STACK_SIZE  2048
+#define MAIA_PWM_FADE_PRIORITY    (tskIDLE_PRIORITY + 4)
+
+/* Channel bits in g_fade.pending */
+
+#define MAIA_PWM_BIT_LEFT         (1u << 0)
+#define MAIA_PWM_BIT_RIGHT        (1u << 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Stereo fade pattern being played */
+
+typedef struct
+{
+  maia_pwm_fade_step_t steps[MAIA_PWM_FADE_MAX_STEPS];
+  uint8_t count;                    /* Number of steps */
+  uint8_t index;                    /* Step playing */
+  uint8_t cycles;                   /* Cycles left (0 = forever) */
+  bool active;
+  uint32_t pending;                 /* Channels still fading (ISR) */
+  uint16_t hold_ms;                 /* Step to wait out, no fade (ms) */
+  maia_pwm_fade_cb_t cb;
+  void *arg;
+} maia_pwm_fade_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static maia_pwm_fade_t g_fade;
+static portMUX_TYPE g_fade_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Serializes LEDC fade calls between callers and the fade task */
+
+static SemaphoreHandle_t g_fade_mutex = NULL;
+static StaticSemaphore_t g_fade_mutex_buf;
+static TaskHandle_t g_fade_task = NULL;
+
+/* Board busy lock held while a motor is driven (g_fade_mutex) */
+
+static bool g_pm_held = false;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_pwm_fade_isr
+ *
+ * Description:
+ *   LEDC fade-end callback (ISR context). When both channels of the
+ *   current segment are done, wake the fade task.
+ *
+ ****************************************************************************/
+
+static bool IRAM_ATTR maia_pwm_fade_isr(const ledc_cb_param_t *param,
+                                        void *user_arg)
+{
+  BaseType_t woken = pdFALSE;
+  uint32_t bit = (uint32_t)(uintptr_t)user_arg;
+  bool done;
+
+  if (param->event != LEDC_FADE_END_EVT)
+    {
+      return false;
+    }
+
+  portENTER_CRITICAL_ISR(&g_fade_lock);
+  done = (g_fade.pending & bit) != 0;
+  g_fade.pending &= ~bit;
+  done = done && g_fade.pending == 0 && g_fade.active;
+  portEXIT_CRITICAL_ISR(&g_fade_lock);
+
+  if (done)
+    {
+      vTaskNotifyGiveFromISR(g_fade_task, &woken);
+    }
+
+  return woken == pdTRUE;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_channel
+ *
+ * Description:
+ *   Start a hardware fade of one channel. A zero-time segment or one that
+ *   does not change the duty is applied at once and reports no fade end.
+ *
+ * Returned Value:
+ *   true if a fade was started (a fade-end event will follow).
+ *
+ ****************************************************************************/
+
+static bool maia_pwm_fade_channel(ledc_channel_t channel, uint8_t duty,
+                                  uint16_t time_ms)
+{
+  if (time_ms == 0 || ledc_get_duty(MAIA_PWM_MODE, channel) == duty)
+    {
+      ledc_set_duty_and_update(MAIA_PWM_MODE, channel, duty, 0);
+      return false;
+    }
+
+  if (ledc_set_fade_with_time(MAIA_PWM_MODE, channel, duty,
+                              time_ms) != ESP_OK ||
+      ledc_fade_start(MAIA_PWM_MODE, channel,
+                      LEDC_FADE_NO_WAIT) != ESP_OK)
+    {
+      ledc_set_duty_and_update(MAIA_PWM_MODE, channel, duty, 0);
+      return false;
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_segment
+ *
+ * Description:
+ *   Start the current step on both channels (g_fade_mutex held). A
+ *   step that starts no fade but has a time (a pause at the current
+ *   duties) leaves it in g_fade.hold_ms for the task to wait out.
+ *
+ * Returned Value:
+ *   true if at least one channel is fading; false if the step completed
+ *   immediately.
+ *
+ ****************************************************************************/
+
+static bool maia_pwm_fade_segment(void)
+{
+  const maia_pwm_fade_step_t *step = &g_fade.steps[g_fade.index];
+  uint32_t pending = MAIA_PWM_BIT_LEFT | MAIA_PWM_BIT_RIGHT;
+
+  /* Mark both pending before starting so an early fade end on one
+   * channel cannot complete the segment on its own
+   */
+
+  portENTER_CRITICAL(&g_fade_lock);
+  g_fade.pending = pending;
+  portEXIT_CRITICAL(&g_fade_lock);
+
+  if (!maia_pwm_fade_channel(MAIA_PWM_CH_MOTOR_LEFT, step->left,
+                             step->time_ms))
+    {
+      pending &= ~MAIA_PWM_BIT_LEFT;
+    }
+
+  if (!maia_pwm_fade_channel(MAIA_PWM_CH_MOTOR_RIGHT, step->right,
+                             step->time_ms))
+    {
+      pending &= ~MAIA_PWM_BIT_RIGHT;
+    }
+
+  g_fade.hold_ms = pending == 0 ? step->time_ms : 0;
+
+  /* Drop channels that did not fade; the ISR may already have cleared
+   * the others
+   */
+
+  portENTER_CRITICAL(&g_fade_lock);
+  g_fade.pending &= pending;
+  pending = g_fade.pending;
+  portEXIT_CRITICAL(&g_fade_lock);
+
+  return pending != 0;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_pm_update
+ *
+ * Description:
+ *   Hold the board busy lock while a pattern plays or a duty is not zero:
+ *   the LEDC runs from the APB clock and stops in light sleep
+ *   (g_fade_mutex held).
+ *
+ ****************************************************************************/
+
+static void maia_pwm_pm_update(void)
+{
+  bool playing = g_fade.active ||
+                 ledc_get_duty(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_LEFT) > 0 ||
+                 ledc_get_duty(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_RIGHT) > 0;
+
+  if (playing && !g_pm_held)
+    {
+      maia_pm_busy_acquire();
+    }
+  else if (!playing && g_pm_held)
+    {
+      maia_pm_busy_release();
+    }
+
+  g_pm_held = playing;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_advance
+ *
+ * Description:
+ *   Move to the next step (wrapping per cycle count) and start it.
+ *   Returns false when the pattern is finished.
+ *
+ ****************************************************************************/
+
+static bool maia_pwm_fade_advance(void)
+{
+  if (++g_fade.index >= g_fade.count)
+    {
+      g_fade.index = 0;
+
+      if (g_fade.cycles != 0 && --g_fade.cycles == 0)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_task
+ *
+ * Description:
+ *   Chains pattern steps and reports completion. Steps that complete
+ *   immediately (zero time) are chained without waiting; steps that
+ *   change no duty are waited out for their time.
+ *
+ ****************************************************************************/
+
+static void maia_pwm_fade_task(void *arg)
+{
+  maia_pwm_fade_cb_t cb;
+  void *cb_arg;
+  uint32_t pending;
+  TickType_t wait = portMAX_DELAY;
+  uint8_t idle;
+
+  (void)arg;
+
+  for (;;)
+    {
+      ulTaskNotifyTake(pdTRUE, wait);
+
+      xSemaphoreTake(g_fade_mutex, portMAX_DELAY);
+
+      cb = NULL;
+      cb_arg = NULL;
+      wait = portMAX_DELAY;
+      idle = 0;
+
+      /* A wake-up left over from a stopped pattern must not advance the
+       * one now playing
+       */
+
+      portENTER_CRITICAL(&g_fade_lock);
+      pending = g_fade.pending;
+      portEXIT_CRITICAL(&g_fade_lock);
+
+      while (g_fade.active && pending == 0)
+        {
+          if (g_fade.hold_ms != 0)
+            {
+              wait = pdMS_TO_TICKS(g_fade.hold_ms);
+              wait = wait > 0 ? wait : 1;
+              g_fade.hold_ms = 0;
+              break;    /* Wait for the pause to end */
+            }
+
+          /* A full pass of steps that neither fade nor pause would
+           * chain forever: the duties are final, end the pattern
+           */
+
+          if (!maia_pwm_fade_advance() || ++idle > g_fade.count)
+            {
+              g_fade.active = false;
+              cb = g_fade.cb;
+              cb_arg = g_fade.arg;
+              break;
+            }
+
+          if (maia_pwm_fade_segment())
+            {
+              break;    /* Wait for the fade end */
+            }
+        }
+
+      maia_pwm_pm_update();
+      xSemaphoreGive(g_fade_mutex);
+
+      if (cb != NULL)
+        {
+          cb(cb_arg);
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -138,6 +443,33 @@ esp_err_t maia_pwm_init(void)
       return ret;
     }
 
+  /* Hardware fade engine with fade-end callbacks on both channels */
+
+  ret = ledc_fade_func_install(0);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to install LEDC fade: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+  ledc_cbs_t cbs = {
+      .fade_cb = maia_pwm_fade_isr,
+  };
+
+  ledc_cb_register(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_LEFT, &cbs,
+                   (void *)(uintptr_t)MAIA_PWM_BIT_LEFT);
+  ledc_cb_register(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_RIGHT, &cbs,
+                   (void *)(uintptr_t)MAIA_PWM_BIT_RIGHT);
+
+  g_fade_mutex = xSemaphoreCreateMutexStatic(&g_fade_mutex_buf);
+  if (g_fade_mutex == NULL ||
+      xTaskCreate(maia_pwm_fade_task, "pwm_fade", MAIA_PWM_FADE_STACK_SIZE,
+                  NULL, MAIA_PWM_FADE_PRIORITY, &g_fade_task) != pdPASS)
+    {
+      ESP_LOGE(TAG, "Failed to create fade task");
+      return ESP_ERR_NO_MEM;
+    }
+
   ESP_LOGI(TAG, "PWM initialized (Left=GPIO%d, Right=GPIO%d)",
            MAIA_GPIO_MOTOR_LEFT, MAIA_GPIO_MOTOR_RIGHT);
 
@@ -163,13 +495,165 @@ esp_err_t maia_pwm_set_duty(ledc_channel_t channel, uint8_t duty)
 {
   esp_err_t ret;
 
-  ret = ledc_set_duty(MAIA_PWM_MODE, channel, duty);
-  if (ret != ESP_OK)
+  if (g_fade_mutex == NULL)
     {
-      return ret;
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  xSemaphoreTake(g_fade_mutex, portMAX_DELAY);
+
+  /* Fade-safe variant (the fade service is installed) */
+
+  ret = ledc_set_duty_and_update(MAIA_PWM_MODE, channel, duty, 0);
+  maia_pwm_pm_update();
+
+  xSemaphoreGive(g_fade_mutex);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_set_duty_stereo
+ *
+ * Description:
+ *   Set both motor duties together, cancelling any running fade.
+ *
+ * Input Parameters:
+ *   left  - Left motor duty (0-255)
+ *   right - Right motor duty (0-255)
+ *
+ * Returned Value:
+ *   ESP_OK on success; LEDC error otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pwm_set_duty_stereo(uint8_t left, uint8_t right)
+{
+  esp_err_t ret;
+
+  if (g_fade_mutex == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  maia_pwm_fade_stop();
+
+  xSemaphoreTake(g_fade_mutex, portMAX_DELAY);
+
+  /* Load both duties first, then latch both: the two updates are a few
+   * register writes apart and take effect on the next PWM period
+   */
+
+  ret = ledc_set_duty(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_LEFT, left);
+  if (ret == ESP_OK)
+    {
+      ret = ledc_set_duty(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_RIGHT, right);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = ledc_update_duty(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_LEFT);
     }
 
-  ret = ledc_update_duty(MAIA_PWM_MODE, channel);
+  if (ret == ESP_OK)
+    {
+      ret = ledc_update_duty(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_RIGHT);
+    }
+
+  maia_pwm_pm_update();
+  xSemaphoreGive(g_fade_mutex);
 
   return ret;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_stereo
+ *
+ * Description:
+ *   Play a stereo fade pattern on the LEDC fade hardware.
+ *
+ * Input Parameters:
+ *   steps  - Pattern steps (copied)
+ *   count  - Number of steps (1-MAIA_PWM_FADE_MAX_STEPS)
+ *   cycles - Times to play the pattern (0 = until stopped)
+ *   cb     - Completion callback (task context, may be NULL)
+ *   arg    - Callback argument
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG or ESP_ERR_INVALID_STATE.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pwm_fade_stereo(const maia_pwm_fade_step_t *steps,
+                               size_t count, uint8_t cycles,
+                               maia_pwm_fade_cb_t cb, void *arg)
+{
+  if (steps == NULL || count == 0 || count > MAIA_PWM_FADE_MAX_STEPS)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_fade_mutex == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  maia_pwm_fade_stop();
+
+  xSemaphoreTake(g_fade_mutex, portMAX_DELAY);
+
+  memcpy(g_fade.steps, steps, count * sizeof(steps[0]));
+  g_fade.count = count;
+  g_fade.index = 0;
+  g_fade.cycles = cycles;
+  g_fade.cb = cb;
+  g_fade.arg = arg;
+  g_fade.active = true;
+
+  /* First step completing at once is chained by the task */
+
+  if (!maia_pwm_fade_segment())
+    {
+      xTaskNotifyGive(g_fade_task);
+    }
+
+  maia_pwm_pm_update();
+  xSemaphoreGive(g_fade_mutex);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_stop
+ *
+ * Description:
+ *   Stop a running fade pattern, leaving both duties where they are.
+ *   The completion callback is not called.
+ *
+ ****************************************************************************/
+
+void maia_pwm_fade_stop(void)
+{
+  if (g_fade_mutex == NULL)
+    {
+      return;
+    }
+
+  xSemaphoreTake(g_fade_mutex, portMAX_DELAY);
+
+  if (g_fade.active)
+    {
+      portENTER_CRITICAL(&g_fade_lock);
+      g_fade.active = false;
+      g_fade.pending = 0;
+      portEXIT_CRITICAL(&g_fade_lock);
+
+      g_fade.hold_ms = 0;
+
+      ledc_fade_stop(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_LEFT);
+      ledc_fade_stop(MAIA_PWM_MODE, MAIA_PWM_CH_MOTOR_RIGHT);
+    }
+
+  maia_pwm_pm_update();
+  xSemaphoreGive(g_fade_mutex);
 }
\ No newline at end of file
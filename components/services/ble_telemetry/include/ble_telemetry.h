@@ -0,0 +1,121 @@
+/****************************************************************************
+ * components/services/ble_telemetry/include/ble_telemetry.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Live telemetry over BLE (NimBLE peripheral), for watching the device
+ * from a phone without the WiFi AP. One notify characteristic streams
+ * records batched once per connection interval into notifications of
+ * up to ATT MTU - 3 bytes. On connect the service asks for the
+ * configured connection interval, the 2M PHY, the longest link layer
+ * packets (DLE) and a 247-byte MTU, so a batch usually leaves in one
+ * connection event.
+ *
+ * Notification: records back to back, each type (u8) | len (u8) |
+ * payload (little-endian):
+ *   - BLE_TELEMETRY_REC_STATUS: uptime_s (u32), heap_free (u32),
+ *     heap_min (u32), cpu_pct[2] (u8), battery_pct (u8, 0xff unknown),
+ *     temperature_dc (i16, INT16_MIN unknown), tof_dropped (u32),
+ *     tof_i2c_errors (u32), log_dropped (u32). Sent when the
+ *     status_monitor snapshot or a value changes.
+ *   - BLE_TELEMETRY_REC_SECTORS: per obstacle sector (left to right)
+ *     distance_mm (i16, INT16_MAX none) and ttc_ms (u16, 0xffff not
+ *     closing). Sent when it changes.
+ *   - BLE_TELEMETRY_REC_TOF: a ToF frame coded as a
+ *     DATA_LOGGER_REC_TOF_DELTA payload (data_logger_codec.h), one
+ *     stream per sensor. Every subscription starts with keyframes; a
+ *     frame that does not fit a notification (small MTU) is skipped and
+ *     the stream restarts with a keyframe.
+ * A record never spans notifications, so a client left at the default
+ * 23-byte MTU receives nothing.
+ *
+ * The service task runs on the UI core next to the NimBLE host and the
+ * controller (BT_NIMBLE_PINNED_TO_CORE, BT_CTRL_PINNED_TO_CORE), and
+ * it only reads the latest sensing state, so the radio never stalls
+ * the real-time core.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_SERVICES_BLE_TELEMETRY_INCLUDE_BLE_TELEMETRY_H
+#define __COMPONENTS_SERVICES_BLE_TELEMETRY_INCLUDE_BLE_TELEMETRY_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Record types */
+
+#define BLE_TELEMETRY_REC_STATUS      1
+#define BLE_TELEMETRY_REC_SECTORS     2
+#define BLE_TELEMETRY_REC_TOF         3
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Service counters */
+
+typedef struct
+{
+  uint32_t connections;
+  uint32_t notifications;   /* Sent */
+  uint32_t bytes;           /* Notification payload sent */
+  uint32_t frames;          /* ToF records sent */
+  uint32_t frames_skipped;  /* Did not fit or could not be queued */
+  uint16_t mtu;             /* Current connection, 0 if none */
+  uint16_t interval_ms;     /* Current connection interval */
+  bool phy_2m;              /* Current connection on the 2M PHY */
+  bool subscribed;
+} ble_telemetry_stats_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ble_telemetry_init
+ *
+ * Description:
+ *   Start the BLE controller and NimBLE host, register the telemetry
+ *   service, advertise as CONFIG_MAIA_BLE_DEVICE_NAME and start the
+ *   batching task.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_SUPPORTED if the service is disabled
+ *   (CONFIG_MAIA_BLE_TELEMETRY); NimBLE or FreeRTOS error otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t ble_telemetry_init(void);
+
+/****************************************************************************
+ * Name: ble_telemetry_set_environment
+ *
+ * Description:
+ *   Battery charge and body temperature of the next status record
+ *   (re-sent only if a value changed). Safe from any task.
+ *
+ * Input Parameters:
+ *   battery_pct    - 0-100, UINT8_MAX if unknown
+ *   temperature_dc - 0.1 degC, INT16_MIN if unknown
+ *
+ ****************************************************************************/
+
+void ble_telemetry_set_environment(uint8_t battery_pct,
+                                   int16_t temperature_dc);
+
+/****************************************************************************
+ * Name: ble_telemetry_get_stats
+ ****************************************************************************/
+
+esp_err_t ble_telemetry_get_stats(ble_telemetry_stats_t *stats);
+
+#endif /* __COMPONENTS_SERVICES_BLE_TELEMETRY_INCLUDE_BLE_TELEMETRY_H */
@@ -0,0 +1,822 @@
+/****************************************************************************
+ * components/services/ble_telemetry/src/ble_telemetry.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * GAP and GATT events run in the NimBLE host task; they only update the
+ * connection state under g_lock. Records are built and notified by the
+ * service task, once per connection interval, from the published
+ * sensing state (obstacle_detection getters, status_monitor snapshot).
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "ble_telemetry.h"
+#include "data_logger_codec.h"
+#include "maia_board.h"
+#include "obstacle_detection.h"
+#include "status_monitor.h"
+#include <esp_log.h>
+#include <nvs_flash.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#ifdef CONFIG_MAIA_BLE_TELEMETRY
+#  include <nimble/nimble_port.h>
+#  include <nimble/nimble_port_freertos.h>
+#  include <host/ble_hs.h>
+#  include <host/util/util.h>
+#  include <services/gap/ble_svc_gap.h>
+#  include <services/gatt/ble_svc_gatt.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[BLE_TELEMETRY]"
+
+#ifdef CONFIG_MAIA_BLE_TELEMETRY
+
+/* The radio stack must stay off the real-time core */
+
+#if defined(CONFIG_BT_NIMBLE_PINNED_TO_CORE) && \
+    CONFIG_BT_NIMBLE_PINNED_TO_CORE == CONFIG_MAIA_TASK_RT_CORE
+#  warning "NimBLE host task pinned to the real-time core"
+#endif
+
+#if defined(CONFIG_BT_CTRL_PINNED_TO_CORE) && \
+    CONFIG_BT_CTRL_PINNED_TO_CORE == CONFIG_MAIA_TASK_RT_CORE
+#  warning "BLE controller task pinned to the real-time core"
+#endif
+
+#define BT_TASK_STACK_SIZE      4096
+#define BT_TASK_PRIORITY        (tskIDLE_PRIORITY + 2)
+
+/* Link setup requested on connect: MTU, LE data length (DLE) */
+
+#define BT_MTU                  247
+#define BT_DLE_OCTETS           251
+#define BT_DLE_TIME_US          2120
+
+/* Connection update: no slave latency, 4 s supervision timeout */
+
+#define BT_CONN_ITVL            BLE_GAP_CONN_ITVL_MS( \
+                                  CONFIG_MAIA_BLE_CONN_INTERVAL_MS)
+#define BT_SUPERVISION_TIMEOUT  400     /* 10 ms units */
+
+/* Notification payload, and notifications queued per interval */
+
+#define BT_PACKET_MAX           (BT_MTU - 3)
+#define BT_BATCH_PACKETS        4
+
+/* Record header: type, len */
+
+#define BT_REC_HEADER           2
+
+#define BT_STATUS_LEN           27
+#define BT_SECTORS_LEN          (OBSTACLE_SECTOR_COUNT * 4)
+
+#endif /* CONFIG_MAIA_BLE_TELEMETRY */
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_BLE_TELEMETRY
+static int bt_access(uint16_t conn, uint16_t attr,
+                     struct ble_gatt_access_ctxt *ctxt, void *arg);
+static int bt_gap_event(struct ble_gap_event *event, void *arg);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_task = NULL;
+
+/* Shared with the host task and the setters (g_lock) */
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static ble_telemetry_stats_t g_stats;
+static uint8_t g_battery_pct = UINT8_MAX;
+static int16_t g_temperature_dc = INT16_MIN;
+static bool g_env_changed = true;
+
+#ifdef CONFIG_MAIA_BLE_TELEMETRY
+
+static uint16_t g_conn;                 /* Valid while g_connected */
+static bool g_connected = false;
+static bool g_restart = false;          /* New subscription: keyframes */
+
+/* GATT: one notify characteristic in a vendor service */
+
+static const ble_uuid128_t g_svc_uuid =
+  BLE_UUID128_INIT(0x4d, 0x41, 0x49, 0x41, 0x00, 0x00, 0x00, 0x80,
+                   0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x1e, 0x7e);
+static const ble_uuid128_t g_chr_uuid =
+  BLE_UUID128_INIT(0x4d, 0x41, 0x49, 0x41, 0x00, 0x00, 0x00, 0x80,
+                   0x00, 0x10, 0x00, 0x00, 0x01, 0x10, 0x1e, 0x7e);
+
+static uint16_t g_val_handle;
+static uint8_t g_own_addr_type;
+
+static const struct ble_gatt_chr_def g_characteristics[] =
+{
+  {
+    .uuid       = &g_chr_uuid.u,
+    .access_cb  = bt_access,
+    .flags      = BLE_GATT_CHR_F_NOTIFY,
+    .val_handle = &g_val_handle,
+  },
+  { 0 },
+};
+
+static const struct ble_gatt_svc_def g_services[] =
+{
+  {
+    .type            = BLE_GATT_SVC_TYPE_PRIMARY,
+    .uuid            = &g_svc_uuid.u,
+    .characteristics = g_characteristics,
+  },
+  { 0 },
+};
+
+/* Service task only */
+
+static uint8_t g_packet[BT_PACKET_MAX];
+static size_t g_len;                    /* Bytes in g_packet */
+static size_t g_cap;                    /* Payload of one notification */
+static uint8_t g_packets;               /* Sent in the current batch */
+
+static data_logger_codec_t g_codec[VL53L5CX_SENSOR_COUNT];
+static uint32_t g_frame_seq[VL53L5CX_SENSOR_COUNT];
+static uint8_t g_frame_sent;            /* Bit N: g_frame_seq[N] valid */
+static obstacle_frame_t g_frame;
+static uint8_t g_coded[DATA_LOGGER_CODEC_MAX];
+
+static status_monitor_health_t g_health;
+static uint32_t g_status_seq;
+static bool g_status_sent;
+static uint8_t g_sectors[BT_SECTORS_LEN];
+static bool g_sectors_sent;
+
+#endif /* CONFIG_MAIA_BLE_TELEMETRY */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_BLE_TELEMETRY
+
+/****************************************************************************
+ * Name: bt_put16 / bt_put32
+ ****************************************************************************/
+
+static uint8_t *bt_put16(uint8_t *p, uint16_t v)
+{
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static uint8_t *bt_put32(uint8_t *p, uint32_t v)
+{
+  p = bt_put16(p, v & 0xffff);
+  return bt_put16(p, v >> 16);
+}
+
+/****************************************************************************
+ * Name: bt_access
+ *
+ * Description:
+ *   The characteristic is notify only: nothing to read or write.
+ *
+ ****************************************************************************/
+
+static int bt_access(uint16_t conn, uint16_t attr,
+                     struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+  (void)conn;
+  (void)attr;
+  (void)ctxt;
+  (void)arg;
+
+  return BLE_ATT_ERR_UNLIKELY;
+}
+
+/****************************************************************************
+ * Name: bt_advertise
+ ****************************************************************************/
+
+static void bt_advertise(void)
+{
+  struct ble_hs_adv_fields fields;
+  struct ble_hs_adv_fields rsp;
+  struct ble_gap_adv_params params;
+  const char *name = ble_svc_gap_device_name();
+  int rc;
+
+  /* Name in the advertisement, service UUID in the scan response */
+
+  memset(&fields, 0, sizeof(fields));
+  fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+  fields.name = (uint8_t *)name;
+  fields.name_len = strlen(name);
+  fields.name_is_complete = 1;
+
+  memset(&rsp, 0, sizeof(rsp));
+  rsp.uuids128 = &g_svc_uuid;
+  rsp.num_uuids128 = 1;
+  rsp.uuids128_is_complete = 1;
+
+  rc = ble_gap_adv_set_fields(&fields);
+  if (rc == 0)
+    {
+      rc = ble_gap_adv_rsp_set_fields(&rsp);
+    }
+
+  if (rc == 0)
+    {
+      memset(&params, 0, sizeof(params));
+      params.conn_mode = BLE_GAP_CONN_MODE_UND;
+      params.disc_mode = BLE_GAP_DISC_MODE_GEN;
+      rc = ble_gap_adv_start(g_own_addr_type, NULL, BLE_HS_FOREVER,
+                             &params, bt_gap_event, NULL);
+    }
+
+  if (rc != 0)
+    {
+      ESP_LOGE(TAG, "Advertising failed (%d)", rc);
+    }
+}
+
+/****************************************************************************
+ * Name: bt_link_setup
+ *
+ * Description:
+ *   Ask for the batch interval, the 2M PHY, DLE and a large MTU. Each
+ *   request is best effort: the central may refuse or pick less.
+ *
+ ****************************************************************************/
+
+static void bt_link_setup(uint16_t conn)
+{
+  struct ble_gap_upd_params params =
+    {
+      .itvl_min            = BT_CONN_ITVL,
+      .itvl_max            = BT_CONN_ITVL,
+      .latency             = 0,
+      .supervision_timeout = BT_SUPERVISION_TIMEOUT,
+    };
+
+  if (ble_gap_update_params(conn, &params) != 0)
+    {
+      ESP_LOGW(TAG, "Connection interval request refused");
+    }
+
+  if (ble_gap_set_prefered_le_phy(conn, BLE_GAP_LE_PHY_2M_MASK,
+                                  BLE_GAP_LE_PHY_2M_MASK,
+                                  BLE_GAP_LE_PHY_CODED_ANY) != 0)
+    {
+      ESP_LOGW(TAG, "2M PHY request refused");
+    }
+
+  if (ble_gap_set_data_len(conn, BT_DLE_OCTETS, BT_DLE_TIME_US) != 0)
+    {
+      ESP_LOGW(TAG, "Data length extension refused");
+    }
+
+  ble_gattc_exchange_mtu(conn, NULL, NULL);
+}
+
+/****************************************************************************
+ * Name: bt_update_interval
+ ****************************************************************************/
+
+static void bt_update_interval(uint16_t conn)
+{
+  struct ble_gap_conn_desc desc;
+
+  if (ble_gap_conn_find(conn, &desc) == 0)
+    {
+      portENTER_CRITICAL(&g_lock);
+      g_stats.interval_ms = desc.conn_itvl * BLE_HCI_CONN_ITVL / 1000;
+      portEXIT_CRITICAL(&g_lock);
+    }
+}
+
+/****************************************************************************
+ * Name: bt_gap_event
+ *
+ * Description:
+ *   NimBLE host task context.
+ *
+ ****************************************************************************/
+
+static int bt_gap_event(struct ble_gap_event *event, void *arg)
+{
+  (void)arg;
+
+  switch (event->type)
+    {
+      case BLE_GAP_EVENT_CONNECT:
+        if (event->connect.status != 0)
+          {
+            bt_advertise();
+            break;
+          }
+
+        portENTER_CRITICAL(&g_lock);
+        g_conn = event->connect.conn_handle;
+        g_connected = true;
+        g_stats.connections++;
+        g_stats.mtu = BLE_ATT_MTU_DFLT;
+        g_stats.phy_2m = false;
+        g_stats.subscribed = false;
+        portEXIT_CRITICAL(&g_lock);
+
+        ESP_LOGI(TAG, "Connected");
+        bt_update_interval(event->connect.conn_handle);
+        bt_link_setup(event->connect.conn_handle);
+        break;
+
+      case BLE_GAP_EVENT_DISCONNECT:
+        portENTER_CRITICAL(&g_lock);
+        g_connected = false;
+        g_stats.mtu = 0;
+        g_stats.subscribed = false;
+        portEXIT_CRITICAL(&g_lock);
+
+        ESP_LOGI(TAG, "Disconnected (0x%x)", event->disconnect.reason);
+        bt_advertise();
+        break;
+
+      case BLE_GAP_EVENT_CONN_UPDATE:
+        bt_update_interval(event->conn_update.conn_handle);
+        break;
+
+      case BLE_GAP_EVENT_ADV_COMPLETE:
+        bt_advertise();
+        break;
+
+      case BLE_GAP_EVENT_SUBSCRIBE:
+        if (event->subscribe.attr_handle == g_val_handle)
+          {
+            portENTER_CRITICAL(&g_lock);
+            g_stats.subscribed = event->subscribe.cur_notify != 0;
+            g_restart = g_stats.subscribed;
+            portEXIT_CRITICAL(&g_lock);
+          }
+        break;
+
+      case BLE_GAP_EVENT_MTU:
+        portENTER_CRITICAL(&g_lock);
+        g_stats.mtu = event->mtu.value;
+        portEXIT_CRITICAL(&g_lock);
+
+        ESP_LOGI(TAG, "MTU %u", event->mtu.value);
+        break;
+
+      case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        portENTER_CRITICAL(&g_lock);
+        g_stats.phy_2m = event->phy_updated.tx_phy == BLE_GAP_LE_PHY_2M;
+        portEXIT_CRITICAL(&g_lock);
+        break;
+
+      default:
+        break;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: bt_on_sync / bt_on_reset
+ ****************************************************************************/
+
+static void bt_on_sync(void)
+{
+  if (ble_hs_util_ensure_addr(0) != 0 ||
+      ble_hs_id_infer_auto(0, &g_own_addr_type) != 0)
+    {
+      ESP_LOGE(TAG, "No BLE address");
+      return;
+    }
+
+  bt_advertise();
+}
+
+static void bt_on_reset(int reason)
+{
+  ESP_LOGW(TAG, "Host reset (%d)", reason);
+}
+
+/****************************************************************************
+ * Name: bt_host_task
+ ****************************************************************************/
+
+static void bt_host_task(void *arg)
+{
+  (void)arg;
+
+  nimble_port_run();
+  nimble_port_freertos_deinit();
+}
+
+/****************************************************************************
+ * Name: bt_send
+ *
+ * Description:
+ *   Notify the packet built so far. Returns false if it could not be
+ *   queued (no buffer, link gone): the packet is dropped.
+ *
+ ****************************************************************************/
+
+static bool bt_send(uint16_t conn)
+{
+  struct os_mbuf *om;
+  bool ok;
+
+  if (g_len == 0)
+    {
+      return true;
+    }
+
+  om = ble_hs_mbuf_from_flat(g_packet, g_len);
+  ok = om != NULL && ble_gatts_notify_custom(conn, g_val_handle, om) == 0;
+
+  if (ok)
+    {
+      portENTER_CRITICAL(&g_lock);
+      g_stats.notifications++;
+      g_stats.bytes += g_len;
+      portEXIT_CRITICAL(&g_lock);
+    }
+
+  g_packets++;
+  g_len = 0;
+
+  return ok;
+}
+
+/****************************************************************************
+ * Name: bt_append
+ *
+ * Description:
+ *   Add a record to the batch, sending the current packet first if the
+ *   record does not fit. Returns false if it was not added (larger than
+ *   a notification, batch budget used up, or notify failed).
+ *
+ ****************************************************************************/
+
+static bool bt_append(uint16_t conn, uint8_t type, const uint8_t *payload,
+                      size_t len)
+{
+  if (BT_REC_HEADER + len > g_cap)
+    {
+      return false;
+    }
+
+  if (g_len + BT_REC_HEADER + len > g_cap)
+    {
+      if (g_packets + 1 >= BT_BATCH_PACKETS || !bt_send(conn))
+        {
+          return false;
+        }
+    }
+
+  g_packet[g_len++] = type;
+  g_packet[g_len++] = (uint8_t)len;
+  memcpy(&g_packet[g_len], payload, len);
+  g_len += len;
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: bt_batch_status
+ ****************************************************************************/
+
+static void bt_batch_status(uint16_t conn)
+{
+  uint8_t rec[BT_STATUS_LEN];
+  uint8_t *p = rec;
+  uint8_t battery;
+  int16_t temperature;
+  bool changed;
+
+  status_monitor_get_health(&g_health);
+
+  portENTER_CRITICAL(&g_lock);
+  battery = g_battery_pct;
+  temperature = g_temperature_dc;
+  changed = g_env_changed;
+  g_env_changed = false;
+  portEXIT_CRITICAL(&g_lock);
+
+  if (g_status_sent && !changed && g_health.sequence == g_status_seq)
+    {
+      return;
+    }
+
+  p = bt_put32(p, g_health.uptime_s);
+  p = bt_put32(p, g_health.heap_free);
+  p = bt_put32(p, g_health.heap_min);
+  *p++ = g_health.cpu_pct[0];
+  *p++ = g_health.cpu_pct[1];
+  *p++ = battery;
+  p = bt_put16(p, (uint16_t)temperature);
+  p = bt_put32(p, g_health.tof_dropped);
+  p = bt_put32(p, g_health.tof_i2c_errors);
+  bt_put32(p, g_health.log_dropped);
+
+  g_status_sent = bt_append(conn, BLE_TELEMETRY_REC_STATUS, rec,
+                            sizeof(rec));
+  g_status_seq = g_health.sequence;
+}
+
+/****************************************************************************
+ * Name: bt_batch_sectors
+ ****************************************************************************/
+
+static void bt_batch_sectors(uint16_t conn)
+{
+  obstacle_ttc_t ttc;
+  uint8_t rec[BT_SECTORS_LEN];
+  uint8_t *p = rec;
+
+  if (obstacle_detection_get_ttc(&ttc) != ESP_OK)
+    {
+      return;
+    }
+
+  for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+    {
+      p = bt_put16(p, (uint16_t)ttc.distance_mm[s]);
+      p = bt_put16(p, ttc.ttc_ms[s]);
+    }
+
+  if (g_sectors_sent && memcmp(rec, g_sectors, sizeof(rec)) == 0)
+    {
+      return;
+    }
+
+  memcpy(g_sectors, rec, sizeof(rec));
+  g_sectors_sent = bt_append(conn, BLE_TELEMETRY_REC_SECTORS, rec,
+                             sizeof(rec));
+}
+
+/****************************************************************************
+ * Name: bt_batch_frames
+ *
+ * Description:
+ *   Latest frame of each sensor, if new. Frames in between are not
+ *   sent; the codec stream does not need them.
+ *
+ ****************************************************************************/
+
+static void bt_batch_frames(uint16_t conn)
+{
+  for (int s = 0; s < VL53L5CX_SENSOR_COUNT; s++)
+    {
+      size_t len;
+      bool sent;
+
+      if (obstacle_detection_get_frame(s, &g_frame) != ESP_OK ||
+          ((g_frame_sent & (1u << s)) && g_frame_seq[s] == g_frame.sequence))
+        {
+          continue;
+        }
+
+      g_frame_seq[s] = g_frame.sequence;
+      g_frame_sent |= 1u << s;
+
+      len = data_logger_codec_encode(&g_codec[s], (uint8_t)s,
+                                     g_frame.nb_zones, g_frame.distance_mm,
+                                     g_frame.target_status,
+                                     CONFIG_MAIA_BLE_KEY_INTERVAL, g_coded);
+      sent = len <= UINT8_MAX &&
+             bt_append(conn, BLE_TELEMETRY_REC_TOF, g_coded, len);
+
+      if (!sent)
+        {
+          data_logger_codec_reset(&g_codec[s]);
+        }
+
+      portENTER_CRITICAL(&g_lock);
+      if (sent)
+        {
+          g_stats.frames++;
+        }
+      else
+        {
+          g_stats.frames_skipped++;
+        }
+
+      portEXIT_CRITICAL(&g_lock);
+    }
+}
+
+/****************************************************************************
+ * Name: bt_task
+ *
+ * Description:
+ *   One batch per connection interval while a client is subscribed.
+ *
+ ****************************************************************************/
+
+static void bt_task(void *arg)
+{
+  (void)arg;
+
+  for (;;)
+    {
+      uint16_t conn;
+      uint16_t mtu;
+      uint16_t interval_ms;
+      bool active;
+      bool restart;
+      TickType_t ticks;
+
+      portENTER_CRITICAL(&g_lock);
+      conn = g_conn;
+      mtu = g_stats.mtu;
+      interval_ms = g_stats.interval_ms;
+      active = g_connected && g_stats.subscribed;
+      restart = g_restart;
+      g_restart = false;
+      portEXIT_CRITICAL(&g_lock);
+
+      if (!active || interval_ms == 0)
+        {
+          interval_ms = CONFIG_MAIA_BLE_CONN_INTERVAL_MS;
+        }
+
+      ticks = pdMS_TO_TICKS(interval_ms);
+      vTaskDelay(ticks > 0 ? ticks : 1);
+
+      if (!active)
+        {
+          continue;
+        }
+
+      if (restart)
+        {
+          /* New subscriber: keyframes and a full state first */
+
+          for (int s = 0; s < VL53L5CX_SENSOR_COUNT; s++)
+            {
+              data_logger_codec_reset(&g_codec[s]);
+            }
+
+          g_frame_sent = 0;
+          g_status_sent = false;
+          g_sectors_sent = false;
+        }
+
+      g_cap = mtu > 3 ? mtu - 3 : 0;
+      g_cap = g_cap > sizeof(g_packet) ? sizeof(g_packet) : g_cap;
+      g_len = 0;
+      g_packets = 0;
+
+      bt_batch_status(conn);
+      bt_batch_sectors(conn);
+      bt_batch_frames(conn);
+      bt_send(conn);
+    }
+}
+
+#endif /* CONFIG_MAIA_BLE_TELEMETRY */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ble_telemetry_init
+ ****************************************************************************/
+
+esp_err_t ble_telemetry_init(void)
+{
+#ifdef CONFIG_MAIA_BLE_TELEMETRY
+  esp_err_t ret;
+  int rc;
+
+  if (g_task != NULL)
+    {
+      return ESP_OK;
+    }
+
+  /* NVS: controller calibration data and the NimBLE key store */
+
+  ret = nvs_flash_init();
+  if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
+      ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+      nvs_flash_erase();
+      ret = nvs_flash_init();
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = nimble_port_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "NimBLE init failed: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+  ble_hs_cfg.sync_cb = bt_on_sync;
+  ble_hs_cfg.reset_cb = bt_on_reset;
+
+  ble_svc_gap_init();
+  ble_svc_gatt_init();
+
+  rc = ble_gatts_count_cfg(g_services);
+  if (rc == 0)
+    {
+      rc = ble_gatts_add_svcs(g_services);
+    }
+
+  if (rc == 0)
+    {
+      rc = ble_svc_gap_device_name_set(CONFIG_MAIA_BLE_DEVICE_NAME);
+    }
+
+  if (rc != 0)
+    {
+      ESP_LOGE(TAG, "GATT setup failed (%d)", rc);
+      nimble_port_deinit();
+      return ESP_FAIL;
+    }
+
+  ble_att_set_preferred_mtu(BT_MTU);
+
+  if (xTaskCreatePinnedToCore(bt_task, "ble", BT_TASK_STACK_SIZE, NULL,
+                              BT_TASK_PRIORITY, &g_task,
+                              MAIA_CORE_UI) != pdPASS)
+    {
+      nimble_port_deinit();
+      return ESP_ERR_NO_MEM;
+    }
+
+  nimble_port_freertos_init(bt_host_task);
+
+  ESP_LOGI(TAG, "Advertising as '%s', %d ms batches",
+           CONFIG_MAIA_BLE_DEVICE_NAME, CONFIG_MAIA_BLE_CONN_INTERVAL_MS);
+
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/****************************************************************************
+ * Name: ble_telemetry_set_environment
+ ****************************************************************************/
+
+void ble_telemetry_set_environment(uint8_t battery_pct,
+                                   int16_t temperature_dc)
+{
+  portENTER_CRITICAL(&g_lock);
+
+  if (g_battery_pct != battery_pct || g_temperature_dc != temperature_dc)
+    {
+      g_battery_pct = battery_pct;
+      g_temperature_dc = temperature_dc;
+      g_env_changed = true;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+}
+
+/****************************************************************************
+ * Name: ble_telemetry_get_stats
+ ****************************************************************************/
+
+esp_err_t ble_telemetry_get_stats(ble_telemetry_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_task == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  *stats = g_stats;
+  portEXIT_CRITICAL(&g_lock);
+
+  return ESP_OK;
+}
@@ -3,6 +3,22 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Session logger. Producers append fixed-layout binary records to a RAM
+ * staging ring of flash-page-sized buffers; a low-priority task writes
+ * full pages, one flash sector each, to a dedicated raw partition used
+ * as a circular log (the oldest sector is erased and reused).
+ *
+ * Producers never block: a record that does not fit in the staging ring
+ * is dropped and counted.
+ *
+ * Flash layout (little endian):
+ *   sector = page header | record | record | ... | 0xFF padding
+ *   record = record header | payload (len bytes)
+ * Records never span sectors. The page header is written last, so a
+ * sector only counts once completely programmed; each record carries a
+ * CRC-16 and a sequence number, so a reader can resume after the last
+ * record it has seen and detect torn or stale data.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_SERVICES_DATA_LOGGER_INCLUDE_DATA_LOGGER_H
@@ -14,11 +30,252 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <esp_err.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* One staging page per flash sector */
+
+#define DATA_LOGGER_PAGE_SIZE       4096
+
+/* Page header magic ("MLOG") */
+
+#define DATA_LOGGER_PAGE_MAGIC      0x474f4c4du
+
+/* Largest record payload */
+
+#define DATA_LOGGER_PAYLOAD_MAX     255
+
+/* Zones of a ToF record (8x8) and ToF streams (sensors) */
+
+#define DATA_LOGGER_TOF_ZONES       64
+#define DATA_LOGGER_TOF_SENSORS     2
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Record types */
+
+typedef enum
+{
+  DATA_LOGGER_REC_TOF = 1,          /* data_logger_tof_t */
+  DATA_LOGGER_REC_IMU,              /* data_logger_imu_t */
+  DATA_LOGGER_REC_TEMP,             /* data_logger_temp_t */
+  DATA_LOGGER_REC_TOF_DELTA,        /* data_logger_codec.h */
+  DATA_LOGGER_REC_HEALTH,           /* data_logger_health_t */
+} data_logger_rec_type_t;
+
+/* Page header, at the start of every sector */
+
+typedef struct __attribute__((packed))
+{
+  uint32_t magic;                   /* DATA_LOGGER_PAGE_MAGIC */
+  uint32_t page_seq;                /* Pages written since the log start */
+  uint32_t first_seq;               /* Sequence of the first record */
+  uint16_t session;                 /* Boot session of the page */
+  uint16_t used;                    /* Bytes used, header included */
+  uint16_t records;                 /* Records in the page */
+  uint16_t reserved;                /* 0xFFFF */
+  uint32_t crc;                     /* CRC-32 of the bytes above */
+} data_logger_page_t;
+
+/* Record header. crc: CRC-16 of the payload, continued over the header
+ * bytes after the crc field
+ */
+
+typedef struct __attribute__((packed))
+{
+  uint16_t crc;                     /* esp_rom_crc16_le() */
+  uint8_t type;                     /* data_logger_rec_type_t */
+  uint8_t len;                      /* Payload bytes */
+  uint32_t seq;                     /* Record sequence (all sessions) */
+  uint32_t time_ms;                 /* Sample time since boot */
+} data_logger_rec_t;
+
+/* ToF frame, followed by nb_zones int16 distances (mm) and nb_zones
+ * target status codes
+ */
+
+typedef struct __attribute__((packed))
+{
+  uint8_t sensor;                   /* vl53l5cx_sensor_t */
+  uint8_t nb_zones;                 /* 16 or 64 */
+} data_logger_tof_t;
+
+/* Head orientation at a ToF frame */
+
+typedef struct __attribute__((packed))
+{
+  int16_t pitch;                    /* Q15 binary angle */
+  int16_t roll;                     /* Q15 binary angle */
+} data_logger_imu_t;
+
+/* Temperature */
+
+typedef struct __attribute__((packed))
+{
+  uint8_t index;                    /* DS18B20 bus index */
+  int16_t temp_cdeg;                /* Hundredths of a degree C */
+} data_logger_temp_t;
+
+/* Health summary, once per status_monitor period. Counters are totals
+ * since boot.
+ */
+
+typedef struct __attribute__((packed))
+{
+  uint32_t heap_free;               /* Bytes */
+  uint32_t heap_min;                /* Lowest free heap since boot */
+  uint8_t cpu_pct[2];               /* Load per core over the period */
+  uint16_t stack_min;               /* Smallest task stack headroom */
+  uint32_t i2c_errors;              /* All devices */
+  uint32_t i2c_timeouts;
+  uint32_t onewire_crc_errors;
+  uint32_t tof_dropped;             /* Both sensors, skipped + failed */
+  uint32_t imu_dropped;             /* Ring full + FIFO overflows */
+  uint32_t log_dropped;             /* Records refused */
+} data_logger_health_t;
+
+/* Logger counters */
+
+typedef struct
+{
+  uint32_t records;                 /* Records accepted */
+  uint32_t record_bytes;            /* Bytes accepted, headers included */
+  uint32_t dropped;                 /* Records refused, staging ring full */
+  uint32_t pages;                   /* Sectors written */
+  uint32_t flash_errors;            /* Failed erase/write */
+  uint32_t flush_last_us;           /* Erase + write of the last sector */
+  uint32_t flush_max_us;
+  uint64_t flush_total_us;
+  uint32_t tof_frames;              /* ToF frames logged */
+  uint32_t tof_raw_bytes;           /* Their DATA_LOGGER_REC_TOF size */
+  uint32_t tof_bytes;               /* Their logged payload size */
+  uint32_t codec_max_cycles;        /* Worst frame encode */
+  uint8_t staged;                   /* Pages waiting for the flash */
+  uint16_t session;                 /* Current boot session */
+  uint32_t sectors;                 /* Sectors in the partition */
+} data_logger_stats_t;
 
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
-/* TODO: Define data_logger interface */
+/****************************************************************************
+ * Name: data_logger_init
+ *
+ * Description:
+ *   Find the log partition, recover the write position, sequence numbers
+ *   and session from the sectors already written and start the flush
+ *   task.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if the partition is missing;
+ *   ESP_ERR_NO_MEM if the task cannot be created.
+ *
+ ****************************************************************************/
+
+esp_err_t data_logger_init(void);
+
+/****************************************************************************
+ * Name: data_logger_write
+ *
+ * Description:
+ *   Append a record. Never blocks (short critical section); any task.
+ *
+ * Input Parameters:
+ *   type    - Record type
+ *   time_us - Sample time (esp_timer)
+ *   payload - Record payload
+ *   len     - Payload bytes (up to DATA_LOGGER_PAYLOAD_MAX)
+ *
+ * Returned Value:
+ *   true if staged; false if the logger is not running, the record is
+ *   too large or the staging ring is full (counted as dropped).
+ *
+ ****************************************************************************/
+
+bool data_logger_write(data_logger_rec_type_t type, int64_t time_us,
+                       const void *payload, uint8_t len);
+
+/****************************************************************************
+ * Name: data_logger_log_tof
+ *
+ * Description:
+ *   Log a ToF frame (16 or 64 zones). With the frame codec enabled the
+ *   frame is stored as a DATA_LOGGER_REC_TOF_DELTA record, falling back
+ *   to DATA_LOGGER_REC_TOF if that is larger than a record. One producer
+ *   task per sensor stream.
+ *
+ ****************************************************************************/
+
+bool data_logger_log_tof(uint8_t sensor, uint8_t nb_zones,
+                         const int16_t *distance_mm,
+                         const uint8_t *target_status, int64_t time_us);
+
+/****************************************************************************
+ * Name: data_logger_flush
+ *
+ * Description:
+ *   Queue the partly filled page for writing now instead of waiting for
+ *   it to fill or age (e.g. before a sync or a shutdown). Non-blocking.
+ *
+ ****************************************************************************/
+
+void data_logger_flush(void);
+
+/****************************************************************************
+ * Name: data_logger_get_range
+ *
+ * Description:
+ *   Pages that can be read back: page sequences first to next - 1 (the
+ *   oldest sector is next in line for reuse and is not included).
+ *   Staged pages are only included once written (data_logger_flush()).
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_INVALID_STATE if the logger is not running.
+ *
+ ****************************************************************************/
+
+esp_err_t data_logger_get_range(uint32_t *first, uint32_t *next);
+
+/****************************************************************************
+ * Name: data_logger_read_header
+ *
+ * Description:
+ *   Read the header of a written page from the partition.
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_NOT_FOUND if the page was overwritten, lost on a
+ *   flash error or never written.
+ *
+ ****************************************************************************/
+
+esp_err_t data_logger_read_header(uint32_t page_seq, data_logger_page_t *hdr);
+
+/****************************************************************************
+ * Name: data_logger_read
+ *
+ * Description:
+ *   Read part of a written page straight from the partition (header
+ *   included, offset 0). Safe against the flush task: the page is
+ *   checked again after the read.
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_NOT_FOUND if the page is not (or no longer) there.
+ *
+ ****************************************************************************/
+
+esp_err_t data_logger_read(uint32_t page_seq, size_t offset, void *buf,
+                           size_t len);
+
+/****************************************************************************
+ * Name: data_logger_get_stats
+ ****************************************************************************/
+
+esp_err_t data_logger_get_stats(data_logger_stats_t *stats);
 
 #endif /* __COMPONENTS_SERVICES_DATA_LOGGER_INCLUDE_DATA_LOGGER_H */
@@ -0,0 +1,149 @@
+/****************************************************************************
+ * components/services/data_logger/include/data_logger_codec.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Streaming ToF frame codec (DATA_LOGGER_REC_TOF_DELTA payloads). Plain
+ * C without IDF dependencies, so host tools can build the decoder from
+ * the same sources.
+ *
+ * Payload:
+ *   sensor (u8) | nb_zones (u8) | flags (u8) | count (u8) | distances |
+ *   status
+ *   - count: frame number of the sensor stream (mod 256); a delta frame
+ *     only decodes on top of frame count - 1
+ *   - distances, keyframe: nb_zones varints, zigzag(v)
+ *   - distances, delta: (nb_zones + 7) / 8 bytes of changed-zone bitmap
+ *     (zone i = bit i % 8 of byte i / 8), then one varint zigzag(v -
+ *     previous v) per changed zone
+ *   - status: (run, code) pairs, run a varint, until nb_zones are
+ *     covered; or nb_zones raw codes with DATA_LOGGER_CODEC_STATUS_RAW
+ * v is the distance in mm, -1 for DATA_LOGGER_CODEC_INVALID. Varints are
+ * little-endian base 128 (7 bits per byte, bit 7 set on all but the
+ * last byte).
+ *
+ * A keyframe starts the stream and is repeated every key_interval
+ * frames, so a decoder joining late or losing a record (sector reused,
+ * record dropped) resynchronises within that many frames.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_SERVICES_DATA_LOGGER_INCLUDE_DATA_LOGGER_CODEC_H
+#define __COMPONENTS_SERVICES_DATA_LOGGER_INCLUDE_DATA_LOGGER_CODEC_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DATA_LOGGER_CODEC_ZONES         64
+
+/* Zone without a distance (VL53L5CX_DISTANCE_INVALID) */
+
+#define DATA_LOGGER_CODEC_INVALID       INT16_MAX
+
+/* Largest payload (3-byte varint per zone, raw status) */
+
+#define DATA_LOGGER_CODEC_MAX \
+  (4 + DATA_LOGGER_CODEC_ZONES / 8 + DATA_LOGGER_CODEC_ZONES * 4)
+
+/* Payload flags */
+
+#define DATA_LOGGER_CODEC_KEY           (1u << 0)
+#define DATA_LOGGER_CODEC_STATUS_RAW    (1u << 1)
+
+/* Decoder results */
+
+#define DATA_LOGGER_CODEC_OK            0
+#define DATA_LOGGER_CODEC_CORRUPT       -1    /* Malformed payload */
+#define DATA_LOGGER_CODEC_NO_REF        -2    /* Delta without its frame */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Stream state of one sensor (encoder or decoder) */
+
+typedef struct
+{
+  int16_t ref[DATA_LOGGER_CODEC_ZONES];   /* Previous frame, coded values */
+  uint8_t nb_zones;
+  uint8_t count;                          /* Frame number of ref */
+  uint8_t since_key;                      /* Deltas since the keyframe */
+  bool valid;                             /* ref holds a frame */
+} data_logger_codec_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: data_logger_codec_reset
+ *
+ * Description:
+ *   Forget the previous frame: the next frame is a keyframe (encoder),
+ *   or deltas are refused until one (decoder).
+ *
+ ****************************************************************************/
+
+void data_logger_codec_reset(data_logger_codec_t *c);
+
+/****************************************************************************
+ * Name: data_logger_codec_encode
+ *
+ * Description:
+ *   Encode a frame against the previous one. If the payload is then not
+ *   stored, call data_logger_codec_reset() so the stream restarts with a
+ *   keyframe.
+ *
+ * Input Parameters:
+ *   c            - Encoder state of the sensor
+ *   sensor       - Sensor index
+ *   nb_zones     - 16 or 64
+ *   distance_mm  - Zone distances (>= 0 or DATA_LOGGER_CODEC_INVALID)
+ *   status       - Zone target status codes
+ *   key_interval - Frames per keyframe (1: every frame)
+ *   out          - DATA_LOGGER_CODEC_MAX bytes
+ *
+ * Returned Value:
+ *   Payload bytes.
+ *
+ ****************************************************************************/
+
+size_t data_logger_codec_encode(data_logger_codec_t *c, uint8_t sensor,
+                                uint8_t nb_zones, const int16_t *distance_mm,
+                                const uint8_t *status, uint8_t key_interval,
+                                uint8_t *out);
+
+/****************************************************************************
+ * Name: data_logger_codec_decode
+ *
+ * Description:
+ *   Decode a payload of the sensor stream of c.
+ *
+ * Input Parameters:
+ *   c           - Decoder state of the sensor (payload byte 0)
+ *   payload     - Record payload
+ *   len         - Payload bytes
+ *   nb_zones    - Zones decoded (output)
+ *   distance_mm - DATA_LOGGER_CODEC_ZONES distances (output)
+ *   status      - DATA_LOGGER_CODEC_ZONES status codes (output)
+ *
+ * Returned Value:
+ *   DATA_LOGGER_CODEC_OK, DATA_LOGGER_CODEC_CORRUPT or
+ *   DATA_LOGGER_CODEC_NO_REF (state reset in both error cases).
+ *
+ ****************************************************************************/
+
+int data_logger_codec_decode(data_logger_codec_t *c, const uint8_t *payload,
+                             size_t len, uint8_t *nb_zones,
+                             int16_t *distance_mm, uint8_t *status);
+
+#endif /* __COMPONENTS_SERVICES_DATA_LOGGER_INCLUDE_DATA_LOGGER_CODEC_H */
@@ -3,6 +3,21 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Staging ring: DL_PAGES RAM pages, counted by g_head (pages sealed by
+ * the producers) and g_tail (pages written by the flush task). Records
+ * go to page g_head % DL_PAGES; when a record does not fit, that page is
+ * sealed (header filled in) and the next one is started, provided it is
+ * not still waiting for the flash. Sealed pages are written in order to
+ * the next sector of the partition, which wraps around.
+ *
+ * ToF frames go through the frame codec (data_logger_codec.h), one
+ * stream per sensor; a record that is not stored restarts the stream
+ * with a keyframe.
+ *
+ * Flash operations stall both caches: the flush task runs at low
+ * priority on the UI core and interrupt handlers that must keep running
+ * have to live in IRAM.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,9 +25,624 @@
  ****************************************************************************/
 
 #include "data_logger.h"
+#include "data_logger_codec.h"
+#include "maia_board.h"
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stddef.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[DATA_LOGGER]"
+
+#define DL_TASK_STACK_SIZE      3072
+#define DL_TASK_PRIORITY        (tskIDLE_PRIORITY + 1)
+
+#define DL_PARTITION            CONFIG_MAIA_DATA_LOGGER_PARTITION
+#define DL_PAGES                CONFIG_MAIA_DATA_LOGGER_STAGING_PAGES
+#define DL_MAX_AGE_MS           CONFIG_MAIA_DATA_LOGGER_MAX_AGE_MS
+#define DL_KEY_INTERVAL         CONFIG_MAIA_DATA_LOGGER_KEYFRAME_INTERVAL
+
+#define DL_HDR_SIZE             sizeof(data_logger_page_t)
+#define DL_REC_SIZE             sizeof(data_logger_rec_t)
+
+_Static_assert(DL_HDR_SIZE == 24 && DL_REC_SIZE == 12,
+               "log layout changed");
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const esp_partition_t *g_part = NULL;
+static TaskHandle_t g_task = NULL;
+static volatile bool g_running = false;
+
+/* Staging ring, protected by g_lock */
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t g_pages[DL_PAGES][DATA_LOGGER_PAGE_SIZE]
+  __attribute__((aligned(4)));
+static uint32_t g_head = 0;
+static uint32_t g_tail = 0;
+static uint16_t g_used = DL_HDR_SIZE;   /* Bytes in the page being filled */
+static uint16_t g_records = 0;          /* Records in that page */
+static int64_t g_fill_us = 0;           /* Time of its first record */
+static uint32_t g_first_seq = 0;
+static uint32_t g_seq = 0;              /* Next record sequence */
+static uint32_t g_page_seq = 0;         /* Next page sequence */
+static data_logger_stats_t g_stats;
+
+/* ToF producers (one per sensor) */
+
+#ifdef CONFIG_MAIA_DATA_LOGGER_TOF_CODEC
+static data_logger_codec_t g_codec[DATA_LOGGER_TOF_SENSORS];
+#endif
+
+/* Flash position, written by the flush task under g_lock */
+
+static uint32_t g_sector = 0;           /* Next sector to write */
+static uint32_t g_written = 0;          /* Page sequence of that sector */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: dl_page_crc
+ ****************************************************************************/
+
+static uint32_t dl_page_crc(const data_logger_page_t *hdr)
+{
+  return esp_rom_crc32_le(0, (const uint8_t *)hdr,
+                          offsetof(data_logger_page_t, crc));
+}
+
+/****************************************************************************
+ * Name: dl_locate
+ *
+ * Description:
+ *   Flash offset of a written page, if its sector has not been reused.
+ *
+ ****************************************************************************/
+
+static bool dl_locate(uint32_t page_seq, size_t *offset)
+{
+  uint32_t back;
+  bool found;
+
+  portENTER_CRITICAL(&g_lock);
+  back = g_written - page_seq;
+  found = back >= 1 && back < g_stats.sectors;
+  *offset = (size_t)((g_sector + g_stats.sectors - back) %
+                     g_stats.sectors) * DATA_LOGGER_PAGE_SIZE;
+  portEXIT_CRITICAL(&g_lock);
+
+  return found;
+}
+
+/****************************************************************************
+ * Name: dl_read_header
+ *
+ * Description:
+ *   Read and check the header of a written page.
+ *
+ ****************************************************************************/
+
+static esp_err_t dl_read_header(uint32_t page_seq, data_logger_page_t *hdr,
+                                size_t *offset)
+{
+  esp_err_t ret;
+
+  if (!dl_locate(page_seq, offset))
+    {
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  ret = esp_partition_read(g_part, *offset, hdr, sizeof(*hdr));
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  if (hdr->magic != DATA_LOGGER_PAGE_MAGIC || hdr->crc != dl_page_crc(hdr) ||
+      hdr->page_seq != page_seq)
+    {
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: dl_seal_locked
+ *
+ * Description:
+ *   Close the page being filled and start the next one. Called with
+ *   g_lock held.
+ *
+ * Returned Value:
+ *   false if there is nothing to seal or no free page.
+ *
+ ****************************************************************************/
+
+static bool dl_seal_locked(void)
+{
+  data_logger_page_t *hdr;
+
+  if (g_records == 0 || g_head + 1 - g_tail >= DL_PAGES)
+    {
+      return false;
+    }
+
+  hdr = (data_logger_page_t *)g_pages[g_head % DL_PAGES];
+  hdr->magic = DATA_LOGGER_PAGE_MAGIC;
+  hdr->page_seq = g_page_seq++;
+  hdr->first_seq = g_first_seq;
+  hdr->session = g_stats.session;
+  hdr->used = g_used;
+  hdr->records = g_records;
+  hdr->reserved = 0xffff;
+  hdr->crc = dl_page_crc(hdr);
+
+  g_head++;
+  g_used = DL_HDR_SIZE;
+  g_records = 0;
+  g_first_seq = g_seq;
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: dl_write_page
+ *
+ * Description:
+ *   Erase the next sector and program a sealed page: records first, page
+ *   header last.
+ *
+ ****************************************************************************/
+
+static void dl_write_page(const uint8_t *page)
+{
+  const data_logger_page_t *hdr = (const data_logger_page_t *)page;
+  size_t offset = (size_t)g_sector * DATA_LOGGER_PAGE_SIZE;
+  size_t body = ((hdr->used + 3) & ~3u) - DL_HDR_SIZE;
+  int64_t start = esp_timer_get_time();
+  uint32_t elapsed;
+  esp_err_t ret;
+
+  ret = esp_partition_erase_range(g_part, offset, DATA_LOGGER_PAGE_SIZE);
+  if (ret == ESP_OK)
+    {
+      ret = esp_partition_write(g_part, offset + DL_HDR_SIZE,
+                                page + DL_HDR_SIZE, body);
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = esp_partition_write(g_part, offset, page, DL_HDR_SIZE);
+    }
+
+  elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+  portENTER_CRITICAL(&g_lock);
+  g_sector = (g_sector + 1) % g_stats.sectors;
+  g_written = hdr->page_seq + 1;
+  if (ret == ESP_OK)
+    {
+      g_stats.pages++;
+      g_stats.flush_last_us = elapsed;
+      g_stats.flush_total_us += elapsed;
+      if (elapsed > g_stats.flush_max_us)
+        {
+          g_stats.flush_max_us = elapsed;
+        }
+    }
+  else
+    {
+      g_stats.flash_errors++;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Page %lu lost: %s", (unsigned long)hdr->page_seq,
+               esp_err_to_name(ret));
+    }
+}
+
+/****************************************************************************
+ * Name: dl_task
+ *
+ * Description:
+ *   Flush task: woken when a page is sealed, and every DL_MAX_AGE_MS to
+ *   seal a page that has been filling for too long.
+ *
+ ****************************************************************************/
+
+static void dl_task(void *arg)
+{
+  (void)arg;
+
+  for (;;)
+    {
+      uint32_t tail;
+      uint32_t head;
+
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DL_MAX_AGE_MS));
+
+      portENTER_CRITICAL(&g_lock);
+      if (g_records > 0 &&
+          esp_timer_get_time() - g_fill_us >= DL_MAX_AGE_MS * 1000LL)
+        {
+          dl_seal_locked();
+        }
+
+      tail = g_tail;
+      head = g_head;
+      portEXIT_CRITICAL(&g_lock);
+
+      /* Sealed pages are not touched by the producers until released */
+
+      while (tail != head)
+        {
+          dl_write_page(g_pages[tail % DL_PAGES]);
+
+          portENTER_CRITICAL(&g_lock);
+          g_tail = ++tail;
+          head = g_head;
+          portEXIT_CRITICAL(&g_lock);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: dl_recover
+ *
+ * Description:
+ *   Scan the page headers for the newest page and continue after it.
+ *
+ ****************************************************************************/
+
+static void dl_recover(void)
+{
+  data_logger_page_t newest = { 0 };
+  bool found = false;
+
+  for (uint32_t s = 0; s < g_stats.sectors; s++)
+    {
+      data_logger_page_t hdr;
+
+      if (esp_partition_read(g_part, (size_t)s * DATA_LOGGER_PAGE_SIZE,
+                             &hdr, sizeof(hdr)) != ESP_OK ||
+          hdr.magic != DATA_LOGGER_PAGE_MAGIC ||
+          hdr.crc != dl_page_crc(&hdr))
+        {
+          continue;
+        }
+
+      if (!found || (int32_t)(hdr.page_seq - newest.page_seq) > 0)
+        {
+          newest = hdr;
+          g_sector = (s + 1) % g_stats.sectors;
+          found = true;
+        }
+    }
+
+  if (found)
+    {
+      g_page_seq = newest.page_seq + 1;
+      g_written = g_page_seq;
+      g_seq = newest.first_seq + newest.records;
+      g_stats.session = newest.session + 1;
+    }
+
+  g_first_seq = g_seq;
+
+  ESP_LOGI(TAG, "Session %u: %lu sectors, next sector %lu, record %lu",
+           g_stats.session, (unsigned long)g_stats.sectors,
+           (unsigned long)g_sector, (unsigned long)g_seq);
+}
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/* TODO: Implement data_logger functions */
+/****************************************************************************
+ * Name: data_logger_init
+ ****************************************************************************/
+
+esp_err_t data_logger_init(void)
+{
+  if (g_running)
+    {
+      return ESP_OK;
+    }
+
+  g_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    ESP_PARTITION_SUBTYPE_ANY, DL_PARTITION);
+  if (g_part == NULL || g_part->size < 2 * DATA_LOGGER_PAGE_SIZE)
+    {
+      ESP_LOGE(TAG, "No \"%s\" log partition", DL_PARTITION);
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  g_stats.sectors = g_part->size / DATA_LOGGER_PAGE_SIZE;
+  dl_recover();
+
+  if (xTaskCreatePinnedToCore(dl_task, "logger", DL_TASK_STACK_SIZE, NULL,
+                              DL_TASK_PRIORITY, &g_task,
+                              MAIA_CORE_UI) != pdPASS)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+
+  g_running = true;
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: data_logger_write
+ ****************************************************************************/
+
+bool data_logger_write(data_logger_rec_type_t type, int64_t time_us,
+                       const void *payload, uint8_t len)
+{
+  data_logger_rec_t rec;
+  uint16_t crc;
+  uint16_t size = DL_REC_SIZE + len;
+  bool sealed = false;
+  bool stored = false;
+  uint8_t *page;
+
+  if (!g_running)
+    {
+      return false;
+    }
+
+  /* The payload CRC is computed outside the critical section */
+
+  crc = esp_rom_crc16_le(0, payload, len);
+  rec.type = type;
+  rec.len = len;
+  rec.time_ms = (uint32_t)(time_us / 1000);
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_used + size > DATA_LOGGER_PAGE_SIZE)
+    {
+      sealed = dl_seal_locked();
+    }
+
+  if (g_used + size <= DATA_LOGGER_PAGE_SIZE)
+    {
+      if (g_records == 0)
+        {
+          g_fill_us = time_us;
+        }
+
+      rec.seq = g_seq++;
+      rec.crc = esp_rom_crc16_le(crc, &rec.type, DL_REC_SIZE - 2);
+
+      page = g_pages[g_head % DL_PAGES];
+      memcpy(page + g_used, &rec, DL_REC_SIZE);
+      memcpy(page + g_used + DL_REC_SIZE, payload, len);
+      g_used += size;
+      g_records++;
+
+      g_stats.records++;
+      g_stats.record_bytes += size;
+      stored = true;
+    }
+  else
+    {
+      g_stats.dropped++;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  if (sealed)
+    {
+      xTaskNotifyGive(g_task);
+    }
+
+  return stored;
+}
+
+/****************************************************************************
+ * Name: data_logger_log_tof
+ ****************************************************************************/
+
+bool data_logger_log_tof(uint8_t sensor, uint8_t nb_zones,
+                         const int16_t *distance_mm,
+                         const uint8_t *target_status, int64_t time_us)
+{
+  uint8_t buf[DATA_LOGGER_CODEC_MAX];
+  data_logger_tof_t *tof = (data_logger_tof_t *)buf;
+  uint8_t *p = buf + sizeof(*tof);
+  size_t raw = sizeof(*tof) + nb_zones * 3;
+  size_t len = raw;
+  data_logger_rec_type_t type = DATA_LOGGER_REC_TOF;
+  uint32_t cycles = 0;
+  bool stored;
+
+  if (nb_zones > DATA_LOGGER_TOF_ZONES || sensor >= DATA_LOGGER_TOF_SENSORS)
+    {
+      return false;
+    }
+
+#ifdef CONFIG_MAIA_DATA_LOGGER_TOF_CODEC
+  cycles = esp_cpu_get_cycle_count();
+  len = data_logger_codec_encode(&g_codec[sensor], sensor, nb_zones,
+                                 distance_mm, target_status,
+                                 DL_KEY_INTERVAL, buf);
+  cycles = esp_cpu_get_cycle_count() - cycles;
+  type = DATA_LOGGER_REC_TOF_DELTA;
+
+  if (len > DATA_LOGGER_PAYLOAD_MAX)
+    {
+      data_logger_codec_reset(&g_codec[sensor]);
+      len = raw;
+      type = DATA_LOGGER_REC_TOF;
+    }
+#endif
+
+  if (type == DATA_LOGGER_REC_TOF)
+    {
+      tof->sensor = sensor;
+      tof->nb_zones = nb_zones;
+      memcpy(p, distance_mm, nb_zones * sizeof(distance_mm[0]));
+      memcpy(p + nb_zones * sizeof(distance_mm[0]), target_status,
+             nb_zones);
+    }
+
+  stored = data_logger_write(type, time_us, buf, (uint8_t)len);
+  if (!stored)
+    {
+#ifdef CONFIG_MAIA_DATA_LOGGER_TOF_CODEC
+      data_logger_codec_reset(&g_codec[sensor]);
+#endif
+      return false;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  g_stats.tof_frames++;
+  g_stats.tof_raw_bytes += raw;
+  g_stats.tof_bytes += len;
+  if (cycles > g_stats.codec_max_cycles)
+    {
+      g_stats.codec_max_cycles = cycles;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  return stored;
+}
+
+/****************************************************************************
+ * Name: data_logger_flush
+ ****************************************************************************/
+
+void data_logger_flush(void)
+{
+  bool sealed;
+
+  if (!g_running)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  sealed = dl_seal_locked();
+  portEXIT_CRITICAL(&g_lock);
+
+  if (sealed)
+    {
+      xTaskNotifyGive(g_task);
+    }
+}
+
+/****************************************************************************
+ * Name: data_logger_get_range
+ ****************************************************************************/
+
+esp_err_t data_logger_get_range(uint32_t *first, uint32_t *next)
+{
+  if (!g_running)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  *next = g_written;
+  *first = g_written >= g_stats.sectors - 1 ?
+           g_written - (g_stats.sectors - 1) : 0;
+  portEXIT_CRITICAL(&g_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: data_logger_read_header
+ ****************************************************************************/
+
+esp_err_t data_logger_read_header(uint32_t page_seq, data_logger_page_t *hdr)
+{
+  size_t offset;
+
+  if (!g_running)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (hdr == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  return dl_read_header(page_seq, hdr, &offset);
+}
+
+/****************************************************************************
+ * Name: data_logger_read
+ ****************************************************************************/
+
+esp_err_t data_logger_read(uint32_t page_seq, size_t offset, void *buf,
+                           size_t len)
+{
+  data_logger_page_t hdr;
+  size_t base;
+  esp_err_t ret;
+
+  if (!g_running)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (buf == NULL || offset + len > DATA_LOGGER_PAGE_SIZE)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (!dl_locate(page_seq, &base))
+    {
+      return ESP_ERR_NOT_FOUND;
+    }
+
+  ret = esp_partition_read(g_part, base + offset, buf, len);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  /* The sector may have been reused while it was read */
+
+  return dl_read_header(page_seq, &hdr, &base);
+}
+
+/****************************************************************************
+ * Name: data_logger_get_stats
+ ****************************************************************************/
+
+esp_err_t data_logger_get_stats(data_logger_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  *stats = g_stats;
+  stats->staged = (uint8_t)(g_head - g_tail);
+  portEXIT_CRITICAL(&g_lock);
+
+  return ESP_OK;
+}
@@ -0,0 +1,323 @@
+/****************************************************************************
+ * components/services/data_logger/src/data_logger_codec.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "data_logger_codec.h"
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DLC_HDR_SIZE            4
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: dlc_value / dlc_distance
+ *
+ * Description:
+ *   Distance to coded value and back (invalid zones code as -1, next to
+ *   the short ranges, so a zone dropping out costs one or two bytes).
+ *
+ ****************************************************************************/
+
+static inline int16_t dlc_value(int16_t mm)
+{
+  return mm == DATA_LOGGER_CODEC_INVALID ? -1 : mm;
+}
+
+static inline int16_t dlc_distance(int16_t v)
+{
+  return v < 0 ? DATA_LOGGER_CODEC_INVALID : v;
+}
+
+/****************************************************************************
+ * Name: dlc_put
+ *
+ * Description:
+ *   Append zigzag(v) as a varint.
+ *
+ ****************************************************************************/
+
+static inline uint8_t *dlc_put(uint8_t *p, int32_t v)
+{
+  uint32_t u = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+
+  while (u >= 0x80)
+    {
+      *p++ = (uint8_t)(u | 0x80);
+      u >>= 7;
+    }
+
+  *p++ = (uint8_t)u;
+  return p;
+}
+
+/****************************************************************************
+ * Name: dlc_get
+ *
+ * Description:
+ *   Read a zigzag varint (at most 3 bytes here).
+ *
+ * Returned Value:
+ *   Next byte, NULL if the varint is truncated or too long.
+ *
+ ****************************************************************************/
+
+static const uint8_t *dlc_get(const uint8_t *p, const uint8_t *end,
+                              int32_t *v)
+{
+  uint32_t u = 0;
+
+  for (int shift = 0; shift < 21; shift += 7)
+    {
+      if (p == end)
+        {
+          return NULL;
+        }
+
+      u |= (uint32_t)(*p & 0x7f) << shift;
+      if ((*p++ & 0x80) == 0)
+        {
+          *v = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+          return p;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: dlc_put_status
+ *
+ * Description:
+ *   Run-length encode the status codes, or copy them when that is not
+ *   shorter.
+ *
+ ****************************************************************************/
+
+static uint8_t *dlc_put_status(uint8_t *p, const uint8_t *status,
+                               uint8_t nb_zones, uint8_t *flags)
+{
+  uint8_t *start = p;
+  int i = 0;
+
+  while (i < nb_zones)
+    {
+      int run = 1;
+
+      while (i + run < nb_zones && status[i + run] == status[i])
+        {
+          run++;
+        }
+
+      if (p - start + 2 >= nb_zones)
+        {
+          memcpy(start, status, nb_zones);
+          *flags |= DATA_LOGGER_CODEC_STATUS_RAW;
+          return start + nb_zones;
+        }
+
+      *p++ = (uint8_t)run;          /* Single-byte varint: run <= 64 */
+      *p++ = status[i];
+      i += run;
+    }
+
+  return p;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: data_logger_codec_reset
+ ****************************************************************************/
+
+void data_logger_codec_reset(data_logger_codec_t *c)
+{
+  c->valid = false;
+  c->since_key = 0;
+}
+
+/****************************************************************************
+ * Name: data_logger_codec_encode
+ ****************************************************************************/
+
+size_t data_logger_codec_encode(data_logger_codec_t *c, uint8_t sensor,
+                                uint8_t nb_zones, const int16_t *distance_mm,
+                                const uint8_t *status, uint8_t key_interval,
+                                uint8_t *out)
+{
+  uint8_t flags = 0;
+  uint8_t *p = out + DLC_HDR_SIZE;
+  bool key;
+
+  key = !c->valid || c->nb_zones != nb_zones ||
+        c->since_key + 1 >= key_interval;
+
+  if (key)
+    {
+      flags |= DATA_LOGGER_CODEC_KEY;
+      for (int i = 0; i < nb_zones; i++)
+        {
+          c->ref[i] = dlc_value(distance_mm[i]);
+          p = dlc_put(p, c->ref[i]);
+        }
+
+      c->since_key = 0;
+    }
+  else
+    {
+      uint8_t *bitmap = p;
+
+      p += (nb_zones + 7) / 8;
+      memset(bitmap, 0, p - bitmap);
+
+      for (int i = 0; i < nb_zones; i++)
+        {
+          int16_t v = dlc_value(distance_mm[i]);
+
+          if (v != c->ref[i])
+            {
+              bitmap[i / 8] |= 1u << (i % 8);
+              p = dlc_put(p, (int32_t)v - c->ref[i]);
+              c->ref[i] = v;
+            }
+        }
+
+      c->since_key++;
+    }
+
+  p = dlc_put_status(p, status, nb_zones, &flags);
+
+  c->nb_zones = nb_zones;
+  c->count++;
+  c->valid = true;
+
+  out[0] = sensor;
+  out[1] = nb_zones;
+  out[2] = flags;
+  out[3] = c->count;
+
+  return p - out;
+}
+
+/****************************************************************************
+ * Name: data_logger_codec_decode
+ ****************************************************************************/
+
+int data_logger_codec_decode(data_logger_codec_t *c, const uint8_t *payload,
+                             size_t len, uint8_t *nb_zones,
+                             int16_t *distance_mm, uint8_t *status)
+{
+  const uint8_t *end = payload + len;
+  const uint8_t *p = payload + DLC_HDR_SIZE;
+  uint8_t nb;
+  uint8_t flags;
+  uint8_t count;
+  int i;
+
+  if (len < DLC_HDR_SIZE || payload[1] > DATA_LOGGER_CODEC_ZONES)
+    {
+      data_logger_codec_reset(c);
+      return DATA_LOGGER_CODEC_CORRUPT;
+    }
+
+  nb = payload[1];
+  flags = payload[2];
+  count = payload[3];
+
+  if ((flags & DATA_LOGGER_CODEC_KEY) == 0 &&
+      (!c->valid || c->nb_zones != nb || (uint8_t)(c->count + 1) != count))
+    {
+      data_logger_codec_reset(c);
+      return DATA_LOGGER_CODEC_NO_REF;
+    }
+
+  /* Distances */
+
+  if (flags & DATA_LOGGER_CODEC_KEY)
+    {
+      for (i = 0; i < nb && p != NULL; i++)
+        {
+          int32_t v = 0;
+
+          p = dlc_get(p, end, &v);
+          c->ref[i] = (int16_t)v;
+        }
+    }
+  else
+    {
+      const uint8_t *bitmap = p;
+
+      p = end - p >= (nb + 7) / 8 ? p + (nb + 7) / 8 : NULL;
+      for (i = 0; i < nb && p != NULL; i++)
+        {
+          int32_t d = 0;
+
+          if (bitmap[i / 8] & (1u << (i % 8)))
+            {
+              p = dlc_get(p, end, &d);
+              c->ref[i] = (int16_t)(c->ref[i] + d);
+            }
+        }
+    }
+
+  /* Status */
+
+  if (p != NULL && (flags & DATA_LOGGER_CODEC_STATUS_RAW))
+    {
+      if (end - p < nb)
+        {
+          p = NULL;
+        }
+      else
+        {
+          memcpy(status, p, nb);
+          p += nb;
+        }
+    }
+  else if (p != NULL)
+    {
+      for (i = 0; i < nb; p += 2)
+        {
+          if (end - p < 2 || p[0] == 0 || p[0] > nb - i)
+            {
+              p = NULL;
+              break;
+            }
+
+          memset(status + i, p[1], p[0]);
+          i += p[0];
+        }
+    }
+
+  if (p == NULL || p != end)
+    {
+      data_logger_codec_reset(c);
+      return DATA_LOGGER_CODEC_CORRUPT;
+    }
+
+  for (i = 0; i < nb; i++)
+    {
+      distance_mm[i] = dlc_distance(c->ref[i]);
+    }
+
+  c->nb_zones = nb;
+  c->count = count;
+  c->valid = true;
+  *nb_zones = nb;
+
+  return DATA_LOGGER_CODEC_OK;
+}
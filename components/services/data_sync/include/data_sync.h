@@ -0,0 +1,95 @@
+/****************************************************************************
+ * components/services/data_sync/include/data_sync.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Session log upload over WiFi (station mode). Every
+ * CONFIG_MAIA_WIFI_SYNC_INTERVAL_MIN the sync task checks the backlog
+ * of log pages not uploaded yet; only once it reaches
+ * CONFIG_MAIA_WIFI_SYNC_MIN_BACKLOG_KB is the radio started, and the
+ * pages are then sent in large HTTP POSTs streamed straight from the log
+ * partition. The radio is stopped when the backlog is sent or after
+ * CONFIG_MAIA_TIMEOUT_SYNC_DATA_MIN, whichever comes first.
+ *
+ * The page sequence of the next page to send is kept in NVS and only
+ * advanced once the server has acknowledged a batch, so an interrupted
+ * sync resends at most one batch. Pages reused by the circular log
+ * before they could be sent are skipped and counted.
+ *
+ * Request: POST CONFIG_MAIA_WIFI_SYNC_URL, application/octet-stream,
+ * body = the page images (header and records, data_logger.h) of pages
+ * X-Maia-First-Page to X-Maia-First-Page + X-Maia-Pages - 1, X-Maia-Device
+ * = station MAC. Any 2xx status acknowledges the batch.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_SERVICES_DATA_SYNC_INCLUDE_DATA_SYNC_H
+#define __COMPONENTS_SERVICES_DATA_SYNC_INCLUDE_DATA_SYNC_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Sync counters */
+
+typedef struct
+{
+  uint32_t checks;          /* Backlog checks */
+  uint32_t syncs;           /* Radio sessions */
+  uint32_t failures;        /* Sessions without an upload (no AP, HTTP) */
+  uint32_t batches;         /* Batches acknowledged */
+  uint32_t pages;           /* Pages acknowledged */
+  uint32_t bytes;           /* Bytes acknowledged */
+  uint32_t lost_pages;      /* Reused or unreadable before upload */
+  uint32_t radio_last_ms;   /* Radio on time of the last session */
+  uint32_t radio_total_ms;
+  uint32_t cursor;          /* Next page to send */
+  uint32_t backlog;         /* Pages waiting at the last check */
+} data_sync_stats_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: data_sync_init
+ *
+ * Description:
+ *   Initialise NVS and the WiFi driver (radio off), load the resume
+ *   cursor and start the sync task. Requires a running data logger.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if no station SSID is
+ *   configured or the logger is not running; other errors from NVS or
+ *   the WiFi driver.
+ *
+ ****************************************************************************/
+
+esp_err_t data_sync_init(void);
+
+/****************************************************************************
+ * Name: data_sync_request
+ *
+ * Description:
+ *   Sync now, whatever the backlog (e.g. on a user request). Returns
+ *   immediately.
+ *
+ ****************************************************************************/
+
+void data_sync_request(void);
+
+/****************************************************************************
+ * Name: data_sync_get_stats
+ ****************************************************************************/
+
+esp_err_t data_sync_get_stats(data_sync_stats_t *stats);
+
+#endif /* __COMPONENTS_SERVICES_DATA_SYNC_INCLUDE_DATA_SYNC_H */
@@ -0,0 +1,591 @@
+/****************************************************************************
+ * components/services/data_sync/src/data_sync.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "data_sync.h"
+#include "data_logger.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_mac.h>
+#include <esp_wifi.h>
+#include <esp_netif.h>
+#include <esp_event.h>
+#include <esp_http_client.h>
+#include <nvs.h>
+#include <nvs_flash.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[DATA_SYNC]"
+
+#define DS_TASK_STACK_SIZE      6144
+#define DS_TASK_PRIORITY        (tskIDLE_PRIORITY + 2)
+
+#define DS_INTERVAL_MS          (CONFIG_MAIA_WIFI_SYNC_INTERVAL_MIN * 60000)
+#define DS_RADIO_MAX_US \
+  (CONFIG_MAIA_TIMEOUT_SYNC_DATA_MIN * 60LL * 1000000LL)
+#define DS_MIN_BACKLOG_PAGES \
+  (CONFIG_MAIA_WIFI_SYNC_MIN_BACKLOG_KB * 1024 / DATA_LOGGER_PAGE_SIZE)
+#define DS_BATCH_PAGES \
+  (CONFIG_MAIA_WIFI_SYNC_BATCH_KB * 1024 / DATA_LOGGER_PAGE_SIZE)
+
+#define DS_HTTP_TIMEOUT_MS      10000
+#define DS_FLUSH_WAIT_MS        200     /* Partly filled page to flash */
+
+#define DS_NVS_NAMESPACE        "maia_sync"
+#define DS_NVS_CURSOR           "cursor"
+
+/* Radio events */
+
+#define DS_EVT_GOT_IP           (1u << 0)
+#define DS_EVT_DISCONNECTED     (1u << 1)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_task = NULL;
+static EventGroupHandle_t g_events = NULL;
+static StaticEventGroup_t g_events_buf;
+static uint32_t g_cursor = 0;           /* Sync task only */
+static char g_device[13];               /* Station MAC, hex */
+
+/* One page, streamed from the partition to the socket */
+
+static uint8_t g_page[DATA_LOGGER_PAGE_SIZE];
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static data_sync_stats_t g_stats;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ds_save_cursor
+ ****************************************************************************/
+
+static void ds_save_cursor(void)
+{
+  nvs_handle_t nvs;
+
+  if (nvs_open(DS_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK)
+    {
+      return;
+    }
+
+  if (nvs_set_u32(nvs, DS_NVS_CURSOR, g_cursor) == ESP_OK)
+    {
+      nvs_commit(nvs);
+    }
+
+  nvs_close(nvs);
+}
+
+/****************************************************************************
+ * Name: ds_load_cursor
+ ****************************************************************************/
+
+static void ds_load_cursor(void)
+{
+  nvs_handle_t nvs;
+
+  g_cursor = 0;
+  if (nvs_open(DS_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK)
+    {
+      nvs_get_u32(nvs, DS_NVS_CURSOR, &g_cursor);
+      nvs_close(nvs);
+    }
+}
+
+/****************************************************************************
+ * Name: ds_event_handler
+ ****************************************************************************/
+
+static void ds_event_handler(void *arg, esp_event_base_t base, int32_t id,
+                             void *data)
+{
+  (void)arg;
+  (void)data;
+
+  if (base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED)
+    {
+      xEventGroupClearBits(g_events, DS_EVT_GOT_IP);
+      xEventGroupSetBits(g_events, DS_EVT_DISCONNECTED);
+    }
+  else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP)
+    {
+      xEventGroupSetBits(g_events, DS_EVT_GOT_IP);
+    }
+}
+
+/****************************************************************************
+ * Name: ds_wifi_init
+ *
+ * Description:
+ *   Station interface and WiFi driver, left stopped (radio off).
+ *
+ ****************************************************************************/
+
+static esp_err_t ds_wifi_init(void)
+{
+  wifi_init_config_t init = WIFI_INIT_CONFIG_DEFAULT();
+  wifi_config_t config;
+  uint8_t mac[6];
+  esp_err_t ret;
+
+  ret = esp_netif_init();
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = esp_event_loop_create_default();
+  if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+    {
+      return ret;
+    }
+
+  esp_netif_create_default_wifi_sta();
+
+  ret = esp_wifi_init(&init);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  esp_event_handler_instance_register(WIFI_EVENT,
+                                      WIFI_EVENT_STA_DISCONNECTED,
+                                      ds_event_handler, NULL, NULL);
+  esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                      ds_event_handler, NULL, NULL);
+
+  memset(&config, 0, sizeof(config));
+  strncpy((char *)config.sta.ssid, CONFIG_MAIA_WIFI_STA_SSID,
+          sizeof(config.sta.ssid));
+  strncpy((char *)config.sta.password, CONFIG_MAIA_WIFI_STA_PASSWORD,
+          sizeof(config.sta.password));
+
+  esp_wifi_set_storage(WIFI_STORAGE_RAM);
+  ret = esp_wifi_set_mode(WIFI_MODE_STA);
+  if (ret == ESP_OK)
+    {
+      ret = esp_wifi_set_config(WIFI_IF_STA, &config);
+    }
+
+  esp_read_mac(mac, ESP_MAC_WIFI_STA);
+  snprintf(g_device, sizeof(g_device), "%02x%02x%02x%02x%02x%02x",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ds_radio_on
+ *
+ * Description:
+ *   Start the radio and wait for an IP address until the deadline.
+ *
+ ****************************************************************************/
+
+static bool ds_radio_on(int64_t deadline)
+{
+  int64_t left = deadline - esp_timer_get_time();
+
+  xEventGroupClearBits(g_events, DS_EVT_GOT_IP | DS_EVT_DISCONNECTED);
+
+  if (esp_wifi_start() != ESP_OK || esp_wifi_connect() != ESP_OK)
+    {
+      return false;
+    }
+
+  return (xEventGroupWaitBits(g_events, DS_EVT_GOT_IP, pdFALSE, pdFALSE,
+                              pdMS_TO_TICKS(left / 1000)) &
+          DS_EVT_GOT_IP) != 0;
+}
+
+/****************************************************************************
+ * Name: ds_radio_off
+ ****************************************************************************/
+
+static void ds_radio_off(void)
+{
+  esp_wifi_disconnect();
+  esp_wifi_stop();
+}
+
+/****************************************************************************
+ * Name: ds_connected
+ ****************************************************************************/
+
+static bool ds_connected(void)
+{
+  return (xEventGroupGetBits(g_events) & DS_EVT_GOT_IP) != 0;
+}
+
+/****************************************************************************
+ * Name: ds_send_batch
+ *
+ * Description:
+ *   POST up to count consecutive pages from first, streaming one page at
+ *   a time from the partition.
+ *
+ * Returned Value:
+ *   Pages acknowledged (0 on failure); *bytes gets the body size.
+ *
+ ****************************************************************************/
+
+static uint32_t ds_send_batch(uint32_t first, uint32_t count,
+                              int64_t deadline, uint32_t *bytes)
+{
+  esp_http_client_config_t cfg =
+  {
+    .url = CONFIG_MAIA_WIFI_SYNC_URL,
+    .method = HTTP_METHOD_POST,
+    .timeout_ms = DS_HTTP_TIMEOUT_MS,
+  };
+
+  esp_http_client_handle_t client;
+  data_logger_page_t hdr;
+  char value[12];
+  uint32_t total = 0;
+  uint32_t n = 0;
+  uint32_t sent = 0;
+  int status;
+
+  /* Body size: the batch stops at the first page that is not there */
+
+  while (n < count && data_logger_read_header(first + n, &hdr) == ESP_OK)
+    {
+      total += hdr.used;
+      n++;
+    }
+
+  if (n == 0)
+    {
+      return 0;
+    }
+
+  client = esp_http_client_init(&cfg);
+  if (client == NULL)
+    {
+      return 0;
+    }
+
+  esp_http_client_set_header(client, "Content-Type",
+                             "application/octet-stream");
+  esp_http_client_set_header(client, "X-Maia-Device", g_device);
+  snprintf(value, sizeof(value), "%lu", (unsigned long)first);
+  esp_http_client_set_header(client, "X-Maia-First-Page", value);
+  snprintf(value, sizeof(value), "%lu", (unsigned long)n);
+  esp_http_client_set_header(client, "X-Maia-Pages", value);
+
+  if (esp_http_client_open(client, total) == ESP_OK)
+    {
+      for (sent = 0; sent < n; sent++)
+        {
+          if (data_logger_read_header(first + sent, &hdr) != ESP_OK ||
+              data_logger_read(first + sent, 0, g_page, hdr.used) != ESP_OK ||
+              esp_http_client_write(client, (const char *)g_page,
+                                    hdr.used) != hdr.used ||
+              esp_timer_get_time() > deadline || !ds_connected())
+            {
+              break;
+            }
+        }
+    }
+
+  /* A short body is never acknowledged */
+
+  status = 0;
+  if (sent == n && esp_http_client_fetch_headers(client) >= 0)
+    {
+      status = esp_http_client_get_status_code(client);
+    }
+
+  esp_http_client_close(client);
+  esp_http_client_cleanup(client);
+
+  if (status < 200 || status >= 300)
+    {
+      ESP_LOGW(TAG, "Batch at page %lu not acknowledged (%d)",
+               (unsigned long)first, status);
+      return 0;
+    }
+
+  *bytes = total;
+  return n;
+}
+
+/****************************************************************************
+ * Name: ds_read_range
+ *
+ * Description:
+ *   Read the log range and bring the cursor back inside it. Pages
+ *   reused before being sent are added to *lost.
+ *
+ ****************************************************************************/
+
+static esp_err_t ds_read_range(uint32_t *next, uint32_t *lost)
+{
+  uint32_t first;
+  esp_err_t ret;
+
+  ret = data_logger_get_range(&first, next);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  /* Pages reused before being sent, or a log reset (cursor ahead) */
+
+  if ((int32_t)(first - g_cursor) > 0 || (int32_t)(g_cursor - *next) > 0)
+    {
+      *lost += (int32_t)(first - g_cursor) > 0 ? first - g_cursor : 0;
+      g_cursor = first;
+      ds_save_cursor();
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: ds_sync
+ *
+ * Description:
+ *   One sync session, if the backlog is large enough (or forced).
+ *
+ ****************************************************************************/
+
+static void ds_sync(bool force)
+{
+  uint32_t next;
+  uint32_t lost = 0;
+  int64_t start;
+  int64_t deadline;
+  bool uploaded = false;
+
+  if (ds_read_range(&next, &lost) != ESP_OK)
+    {
+      return;
+    }
+
+  /* The partly filled page adds at most one page: flush it (and wait
+   * for it to reach flash) only when a session may run
+   */
+
+  if (force || next - g_cursor + 1 >= DS_MIN_BACKLOG_PAGES)
+    {
+      data_logger_flush();
+      vTaskDelay(pdMS_TO_TICKS(DS_FLUSH_WAIT_MS));
+
+      if (ds_read_range(&next, &lost) != ESP_OK)
+        {
+          return;
+        }
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  g_stats.checks++;
+  g_stats.lost_pages += lost;
+  g_stats.backlog = next - g_cursor;
+  g_stats.cursor = g_cursor;
+  portEXIT_CRITICAL(&g_lock);
+
+  if (next == g_cursor || (!force && next - g_cursor < DS_MIN_BACKLOG_PAGES))
+    {
+      return;
+    }
+
+  start = esp_timer_get_time();
+  deadline = start + DS_RADIO_MAX_US;
+
+  ESP_LOGI(TAG, "Sync: %lu pages from %lu", (unsigned long)(next - g_cursor),
+           (unsigned long)g_cursor);
+
+  if (ds_radio_on(deadline))
+    {
+      while (g_cursor != next && esp_timer_get_time() < deadline &&
+             ds_connected())
+        {
+          uint32_t count = next - g_cursor;
+          uint32_t bytes = 0;
+          uint32_t done;
+          data_logger_page_t hdr;
+
+          count = count > DS_BATCH_PAGES ? DS_BATCH_PAGES : count;
+          done = ds_send_batch(g_cursor, count, deadline, &bytes);
+
+          if (done == 0 &&
+              data_logger_read_header(g_cursor, &hdr) == ESP_ERR_NOT_FOUND)
+            {
+              /* Lost on a flash error or reused meanwhile: skip it */
+
+              done = 1;
+              portENTER_CRITICAL(&g_lock);
+              g_stats.lost_pages++;
+              portEXIT_CRITICAL(&g_lock);
+            }
+          else if (done == 0)
+            {
+              break;
+            }
+          else
+            {
+              uploaded = true;
+              portENTER_CRITICAL(&g_lock);
+              g_stats.batches++;
+              g_stats.pages += done;
+              g_stats.bytes += bytes;
+              portEXIT_CRITICAL(&g_lock);
+            }
+
+          g_cursor += done;
+          ds_save_cursor();
+        }
+    }
+
+  ds_radio_off();
+
+  portENTER_CRITICAL(&g_lock);
+  g_stats.syncs++;
+  g_stats.failures += uploaded ? 0 : 1;
+  g_stats.radio_last_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+  g_stats.radio_total_ms += g_stats.radio_last_ms;
+  g_stats.cursor = g_cursor;
+  g_stats.backlog = next - g_cursor;
+  portEXIT_CRITICAL(&g_lock);
+
+  ESP_LOGI(TAG, "Sync done: cursor %lu, %lu pages left, radio on %lu ms",
+           (unsigned long)g_cursor, (unsigned long)(next - g_cursor),
+           (unsigned long)g_stats.radio_last_ms);
+}
+
+/****************************************************************************
+ * Name: ds_task
+ ****************************************************************************/
+
+static void ds_task(void *arg)
+{
+  (void)arg;
+
+  for (;;)
+    {
+      /* Notified: forced sync; timeout: backlog check */
+
+      bool force = ulTaskNotifyTake(pdTRUE,
+                                    pdMS_TO_TICKS(DS_INTERVAL_MS)) != 0;
+
+      ds_sync(force);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: data_sync_init
+ ****************************************************************************/
+
+esp_err_t data_sync_init(void)
+{
+  uint32_t first;
+  uint32_t next;
+  esp_err_t ret;
+
+  if (g_task != NULL)
+    {
+      return ESP_OK;
+    }
+
+  if (strlen(CONFIG_MAIA_WIFI_STA_SSID) == 0 ||
+      data_logger_get_range(&first, &next) != ESP_OK)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  ret = nvs_flash_init();
+  if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
+      ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+      nvs_flash_erase();
+      ret = nvs_flash_init();
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  g_events = xEventGroupCreateStatic(&g_events_buf);
+
+  ret = ds_wifi_init();
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ds_load_cursor();
+  ESP_LOGI(TAG, "Resume at page %lu (log %lu-%lu)", (unsigned long)g_cursor,
+           (unsigned long)first, (unsigned long)next);
+
+  if (xTaskCreatePinnedToCore(ds_task, "sync", DS_TASK_STACK_SIZE, NULL,
+                              DS_TASK_PRIORITY, &g_task,
+                              MAIA_CORE_UI) != pdPASS)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: data_sync_request
+ ****************************************************************************/
+
+void data_sync_request(void)
+{
+  if (g_task != NULL)
+    {
+      xTaskNotifyGive(g_task);
+    }
+}
+
+/****************************************************************************
+ * Name: data_sync_get_stats
+ ****************************************************************************/
+
+esp_err_t data_sync_get_stats(data_sync_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_task == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  *stats = g_stats;
+  portEXIT_CRITICAL(&g_lock);
+
+  return ESP_OK;
+}
@@ -3,6 +3,16 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Non-blocking haptic API. Requests go through a single-slot mailbox to
+ * a worker task that owns the DRV2605L, so callers (e.g. task_sensing)
+ * never wait on haptic I2C traffic. A request still pending when a new
+ * one arrives is replaced: only the newest cue is played.
+ *
+ * RTP streaming drives the motor amplitude directly (no sequencer, no
+ * GO): producers set a target from the obstacle distance (and time to
+ * collision) at the sensing rate and the worker smooths the amplitude
+ * towards it at CONFIG_MAIA_DRV2605L_RTP_RATE_HZ.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_SERVICES_HAPTIC_FEEDBACK_INCLUDE_HAPTIC_FEEDBACK_H
@@ -14,11 +24,232 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <esp_err.h>
+#include "drv2605l.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Longest raw sequence (DRV2605L waveform sequencer slots) */
+
+#define HAPTIC_SEQUENCE_MAX  8
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Obstacle urgency, mapped to a library effect sequence */
+
+typedef enum
+{
+  HAPTIC_URGENCY_NONE = 0,      /* Stop vibrating */
+  HAPTIC_URGENCY_LOW,
+  HAPTIC_URGENCY_MEDIUM,
+  HAPTIC_URGENCY_HIGH,
+  HAPTIC_URGENCY_CRITICAL,
+  HAPTIC_URGENCY_COUNT,
+} haptic_urgency_t;
+
+/* Worker counters */
+
+typedef struct
+{
+  uint32_t requests;        /* Requests posted */
+  uint32_t coalesced;       /* Replaced before the worker took them */
+  uint32_t played;          /* Sequences started */
+  uint32_t reloads_skipped; /* Played without rewriting WAVESEQ */
+  uint32_t rtp_updates;     /* RTP amplitude changes written */
+  uint32_t errors;          /* Failed driver calls */
+} haptic_feedback_stats_t;
 
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
-/* TODO: Define haptic_feedback interface */
+/****************************************************************************
+ * Name: haptic_feedback_init
+ *
+ * Description:
+ *   Initialize the DRV2605L and start the haptic worker task. With
+ *   config->auto_calibrate and CONFIG_MAIA_DRV2605L_CAL_PERSIST, the
+ *   results stored in NVS for this actuator type and voltages are
+ *   restored instead of recalibrating; a fresh calibration (nothing
+ *   stored, or stored values rejected) is stored.
+ *
+ * Input Parameters:
+ *   config - DRV2605L configuration
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_init(const drv2605l_config_t *config);
+
+/****************************************************************************
+ * Name: haptic_feedback_set_urgency
+ *
+ * Description:
+ *   Request the cue for an urgency level. Never blocks; replaces any
+ *   request the worker has not taken yet.
+ *
+ * Input Parameters:
+ *   urgency - Urgency level (HAPTIC_URGENCY_NONE stops playback)
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG or ESP_ERR_INVALID_STATE
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_set_urgency(haptic_urgency_t urgency);
+
+/****************************************************************************
+ * Name: haptic_feedback_play_sequence
+ *
+ * Description:
+ *   Request a raw effect sequence. Never blocks; replaces any request
+ *   the worker has not taken yet.
+ *
+ * Input Parameters:
+ *   effects     - Effect IDs (1-123)
+ *   num_effects - Number of effects (1-HAPTIC_SEQUENCE_MAX)
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG or ESP_ERR_INVALID_STATE
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_play_sequence(const uint8_t *effects,
+                                        uint8_t num_effects);
+
+/****************************************************************************
+ * Name: haptic_feedback_stop
+ *
+ * Description:
+ *   Stop playback (library sequence or RTP streaming). Never blocks.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_stop(void);
+
+/****************************************************************************
+ * Name: haptic_feedback_rtp_start
+ *
+ * Description:
+ *   Enter RTP streaming mode. The amplitude starts at 0 and follows the
+ *   target set with haptic_feedback_set_distance() or
+ *   haptic_feedback_set_intensity(). Any library cue request (or
+ *   haptic_feedback_stop()) leaves streaming mode. Never blocks.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_rtp_start(void);
+
+/****************************************************************************
+ * Name: haptic_feedback_set_distance
+ *
+ * Description:
+ *   Set the RTP target from the nearest obstacle distance through the
+ *   precomputed distance-to-amplitude table (full scale at 0 mm, off at
+ *   CONFIG_MAIA_DRV2605L_RTP_RANGE_MM and beyond). Only stores the
+ *   target: cheap enough for every sensing frame, callable from any
+ *   task.
+ *
+ * Input Parameters:
+ *   mm - Distance in mm
+ *
+ ****************************************************************************/
+
+void haptic_feedback_set_distance(uint16_t mm);
+
+/****************************************************************************
+ * Name: haptic_feedback_set_threat
+ *
+ * Description:
+ *   Set the RTP target from the distance and the time to collision of
+ *   the most urgent obstacle: the stronger of the distance curve and the
+ *   same curve over CONFIG_MAIA_DRV2605L_RTP_TTC_MS, so a fast approach
+ *   vibrates earlier than a slow one at the same distance. Same cost and
+ *   context rules as haptic_feedback_set_distance().
+ *
+ *   When the target changes, the first amplitude write after it is
+ *   recorded in the MAIA_LAT_ACTUATOR latency histogram against
+ *   origin_us.
+ *
+ * Input Parameters:
+ *   mm        - Distance in mm
+ *   ttc_ms    - Time to collision in ms (UINT16_MAX if not closing in)
+ *   origin_us - INT time of the frame behind the threat (0 if unknown)
+ *
+ ****************************************************************************/
+
+void haptic_feedback_set_threat(uint16_t mm, uint16_t ttc_ms,
+                                int64_t origin_us);
+
+/****************************************************************************
+ * Name: haptic_feedback_set_intensity
+ *
+ * Description:
+ *   Set the RTP target amplitude directly.
+ *
+ * Input Parameters:
+ *   level - Amplitude (0-255)
+ *
+ ****************************************************************************/
+
+void haptic_feedback_set_intensity(uint8_t level);
+
+/****************************************************************************
+ * Name: haptic_feedback_get_target
+ *
+ * Description:
+ *   Read the current RTP target amplitude: the decision of the last
+ *   set_distance / set_threat / set_intensity call, whether or not RTP
+ *   streaming is running.
+ *
+ * Returned Value:
+ *   Amplitude (0-255)
+ *
+ ****************************************************************************/
+
+uint8_t haptic_feedback_get_target(void);
+
+/****************************************************************************
+ * Name: haptic_feedback_recalibrate
+ *
+ * Description:
+ *   Request a new auto-calibration cycle (motor buzzes ~1 s). The worker
+ *   leaves RTP streaming for it, stores the results and resumes. Never
+ *   blocks.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_STATE if not initialized
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_recalibrate(void);
+
+/****************************************************************************
+ * Name: haptic_feedback_get_stats
+ *
+ * Description:
+ *   Read the worker counters.
+ *
+ * Input Parameters:
+ *   stats - Pointer to store counters
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_INVALID_ARG otherwise
+ *
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_get_stats(haptic_feedback_stats_t *stats);
 
 #endif /* __COMPONENTS_SERVICES_HAPTIC_FEEDBACK_INCLUDE_HAPTIC_FEEDBACK_H */
@@ -10,9 +10,849 @@
  ****************************************************************************/
 
 #include "haptic_feedback.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+#include <nvs.h>
+#include <nvs_flash.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[HAPTIC]"
+
+#define HAPTIC_TASK_STACK_SIZE  4096        /* NVS write on recalibration */
+#define HAPTIC_TASK_PRIORITY    (tskIDLE_PRIORITY + 4)
+
+/* Worker wake-up reasons (task notification bits) */
+
+#define HAPTIC_EVT_REQUEST      (1u << 0)   /* Mailbox has a request */
+#define HAPTIC_EVT_RTP_TICK     (1u << 1)   /* RTP update period */
+#define HAPTIC_EVT_CALIBRATE    (1u << 2)   /* Recalibration requested */
+
+/* Stored calibration: one blob, keyed by actuator type and voltages so
+ * a configuration change finds nothing and recalibrates
+ */
+
+#define HAPTIC_NVS_NAMESPACE    "haptic"
+#define HAPTIC_NVS_KEY_SIZE     16
+
+/* RTP streaming */
+
+#define HAPTIC_RTP_PERIOD_US    (1000000 / CONFIG_MAIA_DRV2605L_RTP_RATE_HZ)
+#define HAPTIC_RTP_RANGE_MM     CONFIG_MAIA_DRV2605L_RTP_RANGE_MM
+#define HAPTIC_RTP_RANGE_TTC_MS CONFIG_MAIA_DRV2605L_RTP_TTC_MS
+#define HAPTIC_RTP_MIN_LEVEL    CONFIG_MAIA_DRV2605L_RTP_MIN_LEVEL
+#define HAPTIC_RTP_LUT_SIZE     128
+#define HAPTIC_RTP_LUT_LAST     (HAPTIC_RTP_LUT_SIZE - 1)
+
+/* Distance-to-amplitude curve, entry i: quadratic in closeness, from
+ * HAPTIC_RTP_MIN_LEVEL just inside the range up to 255 at 0 mm; the
+ * last entry (at or beyond the range) is 0. A constant expression, so
+ * the table is built by the compiler and lives in flash.
+ */
+
+#define HAPTIC_RTP_CURVE(i) \
+  ((i) >= HAPTIC_RTP_LUT_LAST ? 0 : \
+   HAPTIC_RTP_MIN_LEVEL + \
+   ((255 - HAPTIC_RTP_MIN_LEVEL) * (HAPTIC_RTP_LUT_LAST - (i)) * \
+    (HAPTIC_RTP_LUT_LAST - (i))) / \
+   (HAPTIC_RTP_LUT_LAST * HAPTIC_RTP_LUT_LAST))
+
+#define HAPTIC_RTP_ENTRY(i)     HAPTIC_RTP_CURVE(i),
+
+/* Table expansion: HAPTIC_REPn(m, i) expands to m(i) .. m(i + n - 1) */
+
+#define HAPTIC_REP2(m, i)       m(i) m((i) + 1)
+#define HAPTIC_REP4(m, i)       HAPTIC_REP2(m, i) HAPTIC_REP2(m, (i) + 2)
+#define HAPTIC_REP8(m, i)       HAPTIC_REP4(m, i) HAPTIC_REP4(m, (i) + 4)
+#define HAPTIC_REP16(m, i)      HAPTIC_REP8(m, i) HAPTIC_REP8(m, (i) + 8)
+#define HAPTIC_REP32(m, i)      HAPTIC_REP16(m, i) HAPTIC_REP16(m, (i) + 16)
+#define HAPTIC_REP64(m, i)      HAPTIC_REP32(m, i) HAPTIC_REP32(m, (i) + 32)
+#define HAPTIC_REP128(m, i)     HAPTIC_REP64(m, i) HAPTIC_REP64(m, (i) + 64)
+
+/* Urgency cue profile, from the actuator and library choice */
+
+#if defined(CONFIG_MAIA_DRV2605L_ACTUATOR_LRA)
+#  define HAPTIC_CUE_PROFILE    "lra"
+#elif defined(CONFIG_MAIA_DRV2605L_LIBRARY_B)
+#  define HAPTIC_CUE_PROFILE    "erm_soft"
+#else
+#  define HAPTIC_CUE_PROFILE    "erm"
+#endif
+
+/* Envelope smoothing: each tick moves 1/2^N of the way to the target */
+
+#define HAPTIC_RTP_SMOOTH_SHIFT 2
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef enum
+{
+  HAPTIC_REQ_SEQUENCE = 0,      /* Play effects[] */
+  HAPTIC_REQ_STOP,              /* Stop playback (sequence or RTP) */
+  HAPTIC_REQ_RTP_START,         /* Enter RTP streaming */
+} haptic_req_kind_t;
+
+/* Mailbox entry */
+
+typedef struct
+{
+  uint8_t kind;                 /* haptic_req_kind_t */
+  uint8_t num_effects;
+  uint8_t effects[HAPTIC_SEQUENCE_MAX];
+} haptic_request_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Urgency cues, ready-made WAVESEQ images (library effect IDs, the
+ * numbering is shared by all libraries): 1 = strong click, 10 = double
+ * click, 12 = triple click, 14 = strong buzz, 52 = pulsing strong.
+ * Library B plays every effect as a soft bump, so its cues start one
+ * step up; the LRA critical cue pulses to stay distinct from steady
+ * RTP vibration.
+ */
+
+static const haptic_request_t g_urgency_cues[HAPTIC_URGENCY_COUNT] =
+{
+  [HAPTIC_URGENCY_NONE]     = { HAPTIC_REQ_STOP,     0, { 0 } },
+#if defined(CONFIG_MAIA_DRV2605L_ACTUATOR_LRA)
+  [HAPTIC_URGENCY_LOW]      = { HAPTIC_REQ_SEQUENCE, 1, { 1 } },
+  [HAPTIC_URGENCY_MEDIUM]   = { HAPTIC_REQ_SEQUENCE, 1, { 10 } },
+  [HAPTIC_URGENCY_HIGH]     = { HAPTIC_REQ_SEQUENCE, 1, { 12 } },
+  [HAPTIC_URGENCY_CRITICAL] = { HAPTIC_REQ_SEQUENCE, 2, { 52, 52 } },
+#elif defined(CONFIG_MAIA_DRV2605L_LIBRARY_B)
+  [HAPTIC_URGENCY_LOW]      = { HAPTIC_REQ_SEQUENCE, 1, { 10 } },
+  [HAPTIC_URGENCY_MEDIUM]   = { HAPTIC_REQ_SEQUENCE, 1, { 12 } },
+  [HAPTIC_URGENCY_HIGH]     = { HAPTIC_REQ_SEQUENCE, 2, { 12, 12 } },
+  [HAPTIC_URGENCY_CRITICAL] = { HAPTIC_REQ_SEQUENCE, 3, { 14, 14, 14 } },
+#else
+  [HAPTIC_URGENCY_LOW]      = { HAPTIC_REQ_SEQUENCE, 1, { 1 } },
+  [HAPTIC_URGENCY_MEDIUM]   = { HAPTIC_REQ_SEQUENCE, 1, { 10 } },
+  [HAPTIC_URGENCY_HIGH]     = { HAPTIC_REQ_SEQUENCE, 1, { 12 } },
+  [HAPTIC_URGENCY_CRITICAL] = { HAPTIC_REQ_SEQUENCE, 2, { 14, 14 } },
+#endif
+};
+
+/* Distance (or TTC) bucket to RTP amplitude */
+
+static const uint8_t g_rtp_lut[HAPTIC_RTP_LUT_SIZE] =
+{
+  HAPTIC_REP128(HAPTIC_RTP_ENTRY, 0)
+};
+
+_Static_assert(HAPTIC_RTP_LUT_SIZE == 128, "HAPTIC_REP128 fills g_rtp_lut");
+
+/* Single-slot mailbox: xQueueOverwrite() keeps only the newest request */
+
+static QueueHandle_t g_mailbox = NULL;
+static uint8_t g_mailbox_storage[sizeof(haptic_request_t)];
+static StaticQueue_t g_mailbox_buf;
+static TaskHandle_t g_worker = NULL;
+
+/* Sequence currently held by the WAVESEQ registers (worker only) */
+
+static haptic_request_t g_loaded;
+
+/* RTP streaming: target written by producers, level owned by the
+ * worker
+ */
+
+static esp_timer_handle_t g_rtp_timer = NULL;
+static volatile uint8_t g_rtp_target = 0;
+static uint8_t g_rtp_level = 0;
+static bool g_rtp_active = false;
+
+/* INT time of the frame behind the latest target change, until the
+ * worker writes the first amplitude after it (latency histogram)
+ */
+
+static portMUX_TYPE g_rtp_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t g_rtp_origin_us = 0;
+
+static portMUX_TYPE g_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static haptic_feedback_stats_t g_stats;
+
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+static char g_cal_key[HAPTIC_NVS_KEY_SIZE];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: haptic_post
+ *
+ * Description:
+ *   Put a request in the mailbox, replacing a pending one.
+ *
+ ****************************************************************************/
+
+static esp_err_t haptic_post(const haptic_request_t *req)
+{
+  bool pending;
+
+  if (g_mailbox == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  pending = uxQueueMessagesWaiting(g_mailbox) != 0;
+  xQueueOverwrite(g_mailbox, req);
+  xTaskNotify(g_worker, HAPTIC_EVT_REQUEST, eSetBits);
+
+  portENTER_CRITICAL(&g_stats_lock);
+  g_stats.requests++;
+  if (pending)
+    {
+      g_stats.coalesced++;
+    }
+
+  portEXIT_CRITICAL(&g_stats_lock);
+
+  return ESP_OK;
+}
+
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+
+/****************************************************************************
+ * Name: haptic_cal_load
+ *
+ * Description:
+ *   Read the calibration stored for this actuator configuration. Brings
+ *   NVS up if nobody has yet (data_sync may come later).
+ *
+ ****************************************************************************/
+
+static bool haptic_cal_load(const drv2605l_config_t *config,
+                            drv2605l_calibration_t *cal)
+{
+  size_t len = sizeof(*cal);
+  nvs_handle_t nvs;
+  esp_err_t ret;
+
+  snprintf(g_cal_key, sizeof(g_cal_key), "cal_%c%02x%02x",
+           config->actuator == DRV2605L_ACTUATOR_LRA ? 'l' : 'e',
+           config->rated_voltage, config->overdrive_clamp);
+
+  ret = nvs_flash_init();
+  if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
+      ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+      nvs_flash_erase();
+      ret = nvs_flash_init();
+    }
+
+  if (ret != ESP_OK ||
+      nvs_open(HAPTIC_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK)
+    {
+      return false;
+    }
+
+  ret = nvs_get_blob(nvs, g_cal_key, cal, &len);
+  nvs_close(nvs);
+
+  return ret == ESP_OK && len == sizeof(*cal);
+}
+
+/****************************************************************************
+ * Name: haptic_cal_store
+ *
+ * Description:
+ *   Replace the stored calibration (entries for other configurations
+ *   are dropped).
+ *
+ ****************************************************************************/
+
+static void haptic_cal_store(const drv2605l_calibration_t *cal)
+{
+  nvs_handle_t nvs;
+  esp_err_t ret;
+
+  if (nvs_open(HAPTIC_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Calibration not stored: NVS unavailable");
+      return;
+    }
+
+  ret = nvs_erase_all(nvs);
+  if (ret == ESP_OK)
+    {
+      ret = nvs_set_blob(nvs, g_cal_key, cal, sizeof(*cal));
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = nvs_commit(nvs);
+    }
+
+  nvs_close(nvs);
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Calibration not stored: %s", esp_err_to_name(ret));
+      return;
+    }
+
+  ESP_LOGI(TAG, "Calibration stored as %s", g_cal_key);
+}
+
+#endif /* CONFIG_MAIA_DRV2605L_CAL_PERSIST */
+
+/****************************************************************************
+ * Name: haptic_rtp_level
+ *
+ * Description:
+ *   Table amplitude for a value on a 0..range scale (0 = full scale).
+ *
+ ****************************************************************************/
+
+static uint8_t haptic_rtp_level(uint32_t value, uint32_t range)
+{
+  uint32_t idx = (value * (HAPTIC_RTP_LUT_SIZE - 1)) / range;
+
+  if (idx >= HAPTIC_RTP_LUT_SIZE)
+    {
+      idx = HAPTIC_RTP_LUT_SIZE - 1;
+    }
+
+  return g_rtp_lut[idx];
+}
+
+/****************************************************************************
+ * Name: haptic_rtp_timer_cb
+ *
+ * Description:
+ *   esp_timer callback: wake the worker for one RTP update.
+ *
+ ****************************************************************************/
+
+static void haptic_rtp_timer_cb(void *arg)
+{
+  (void)arg;
+  xTaskNotify(g_worker, HAPTIC_EVT_RTP_TICK, eSetBits);
+}
+
+/****************************************************************************
+ * Name: haptic_rtp_enter
+ *
+ * Description:
+ *   Switch the DRV2605L to RTP mode at zero amplitude and start ticking.
+ *
+ ****************************************************************************/
+
+static esp_err_t haptic_rtp_enter(void)
+{
+  esp_err_t ret;
+
+  if (g_rtp_active)
+    {
+      return ESP_OK;
+    }
+
+  g_rtp_level = 0;
+
+  ret = drv2605l_set_rtp_value(0);
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_set_mode(DRV2605L_OP_MODE_REALTIME);
+    }
+
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  g_rtp_active = true;
+
+  return esp_timer_start_periodic(g_rtp_timer, HAPTIC_RTP_PERIOD_US);
+}
+
+/****************************************************************************
+ * Name: haptic_rtp_leave
+ *
+ * Description:
+ *   Stop ticking, silence the motor and return to internal trigger mode.
+ *
+ ****************************************************************************/
+
+static esp_err_t haptic_rtp_leave(void)
+{
+  esp_err_t ret;
+
+  if (!g_rtp_active)
+    {
+      return ESP_OK;
+    }
+
+  esp_timer_stop(g_rtp_timer);
+  g_rtp_active = false;
+  g_rtp_level = 0;
+
+  ret = drv2605l_set_rtp_value(0);
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_set_mode(DRV2605L_OP_MODE_INTERNAL_TRIGGER);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: haptic_rtp_step
+ *
+ * Description:
+ *   One RTP update: move the amplitude towards the target (first-order
+ *   smoothing, at least one step so it always converges) and write it
+ *   if it changed.
+ *
+ ****************************************************************************/
+
+static esp_err_t haptic_rtp_step(void)
+{
+  int diff = (int)g_rtp_target - (int)g_rtp_level;
+  int64_t origin;
+  esp_err_t ret;
+  int step;
+
+  if (!g_rtp_active || diff == 0)
+    {
+      return ESP_OK;
+    }
+
+  step = diff / (1 << HAPTIC_RTP_SMOOTH_SHIFT);
+  if (step == 0)
+    {
+      step = (diff > 0) ? 1 : -1;
+    }
+
+  g_rtp_level += step;
+
+  portENTER_CRITICAL(&g_stats_lock);
+  g_stats.rtp_updates++;
+  portEXIT_CRITICAL(&g_stats_lock);
+
+  ret = drv2605l_set_rtp_value(g_rtp_level);
+  if (ret == ESP_OK)
+    {
+      portENTER_CRITICAL(&g_rtp_lock);
+      origin = g_rtp_origin_us;
+      g_rtp_origin_us = 0;
+      portEXIT_CRITICAL(&g_rtp_lock);
+
+      maia_latency_record(MAIA_LAT_ACTUATOR, origin, esp_timer_get_time());
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: haptic_execute
+ *
+ * Description:
+ *   Run one request on the DRV2605L. The sequencer is only reloaded
+ *   when the sequence differs from the one already loaded; replaying
+ *   the same cue costs a single GO write.
+ *
+ ****************************************************************************/
+
+static esp_err_t haptic_execute(const haptic_request_t *req)
+{
+  esp_err_t ret;
+  bool reload;
+
+  switch (req->kind)
+    {
+      case HAPTIC_REQ_RTP_START:
+        return haptic_rtp_enter();
+
+      case HAPTIC_REQ_STOP:
+        if (g_rtp_active)
+          {
+            return haptic_rtp_leave();
+          }
+
+        return drv2605l_stop();
+
+      default:
+        break;
+    }
+
+  /* Library cues need internal trigger mode */
+
+  ret = haptic_rtp_leave();
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  reload = req->num_effects != g_loaded.num_effects ||
+           memcmp(req->effects, g_loaded.effects, req->num_effects) != 0;
+
+  if (reload)
+    {
+      ret = drv2605l_load_sequence(req->effects, req->num_effects);
+      if (ret != ESP_OK)
+        {
+          g_loaded.num_effects = 0;   /* Registers state unknown */
+          return ret;
+        }
+
+      g_loaded = *req;
+    }
+
+  ret = drv2605l_go();
+
+  portENTER_CRITICAL(&g_stats_lock);
+  if (ret == ESP_OK)
+    {
+      g_stats.played++;
+    }
+
+  if (!reload)
+    {
+      g_stats.reloads_skipped++;
+    }
+
+  portEXIT_CRITICAL(&g_stats_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: haptic_calibrate
+ *
+ * Description:
+ *   Recalibrate on request: leave RTP streaming for the calibration
+ *   cycle, store the new results and resume streaming.
+ *
+ ****************************************************************************/
+
+static esp_err_t haptic_calibrate(void)
+{
+  drv2605l_calibration_t cal;
+  bool streaming = g_rtp_active;
+  esp_err_t ret;
+
+  ret = haptic_rtp_leave();
+  if (ret == ESP_OK)
+    {
+      ret = drv2605l_calibrate(&cal);
+    }
+
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+  if (ret == ESP_OK)
+    {
+      haptic_cal_store(&cal);
+    }
+#endif
+
+  if (streaming && haptic_rtp_enter() != ESP_OK)
+    {
+      ret = ESP_FAIL;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: haptic_worker
+ *
+ * Description:
+ *   Worker task: owns all DRV2605L traffic. Woken by requests and, while
+ *   streaming, by the RTP timer.
+ *
+ ****************************************************************************/
+
+static void haptic_worker(void *arg)
+{
+  haptic_request_t req;
+  uint32_t events;
+  esp_err_t ret;
+
+  (void)arg;
+
+  for (;;)
+    {
+      xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+
+      ret = ESP_OK;
+
+      if ((events & HAPTIC_EVT_REQUEST) &&
+          xQueueReceive(g_mailbox, &req, 0) == pdTRUE)
+        {
+          ret = haptic_execute(&req);
+        }
+
+      if ((events & HAPTIC_EVT_CALIBRATE) && ret == ESP_OK)
+        {
+          ret = haptic_calibrate();
+        }
+
+      if ((events & HAPTIC_EVT_RTP_TICK) && ret == ESP_OK)
+        {
+          ret = haptic_rtp_step();
+        }
+
+      if (ret != ESP_OK)
+        {
+          portENTER_CRITICAL(&g_stats_lock);
+          g_stats.errors++;
+          portEXIT_CRITICAL(&g_stats_lock);
+        }
+    }
+}
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/* TODO: Implement haptic_feedback functions */
+/****************************************************************************
+ * Name: haptic_feedback_init
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_init(const drv2605l_config_t *config)
+{
+  drv2605l_config_t drv;
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+  drv2605l_calibration_t stored;
+  drv2605l_calibration_t cal;
+  bool have_stored = false;
+#endif
+  esp_err_t ret;
+
+  if (g_mailbox != NULL)
+    {
+      return ESP_OK;
+    }
+
+  if (config == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  /* Restore the stored calibration instead of running a new cycle; the
+   * driver still calibrates if it fails validation
+   */
+
+  drv = *config;
+
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+  if (config->auto_calibrate)
+    {
+      have_stored = haptic_cal_load(config, &stored);
+      if (have_stored)
+        {
+          drv.calibration = &stored;
+        }
+    }
+#endif
+
+  ret = drv2605l_init(&drv);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "DRV2605L init failed: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+#ifdef CONFIG_MAIA_DRV2605L_CAL_PERSIST
+  if (config->auto_calibrate &&
+      drv2605l_get_calibration(&cal) == ESP_OK &&
+      (!have_stored || memcmp(&cal, &stored, sizeof(cal)) != 0))
+    {
+      haptic_cal_store(&cal);
+    }
+#endif
+
+  g_mailbox = xQueueCreateStatic(1, sizeof(haptic_request_t),
+                                 g_mailbox_storage, &g_mailbox_buf);
+
+  memset(&g_loaded, 0, sizeof(g_loaded));
+
+  const esp_timer_create_args_t timer_args =
+    {
+      .callback        = haptic_rtp_timer_cb,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name            = "haptic_rtp",
+      .skip_unhandled_events = true,
+    };
+
+  ret = esp_timer_create(&timer_args, &g_rtp_timer);
+  if (ret != ESP_OK)
+    {
+      vQueueDelete(g_mailbox);
+      g_mailbox = NULL;
+      return ret;
+    }
+
+  if (xTaskCreatePinnedToCore(haptic_worker, "haptic",
+                              HAPTIC_TASK_STACK_SIZE, NULL,
+                              HAPTIC_TASK_PRIORITY, &g_worker,
+                              MAIA_CORE_RT) != pdPASS)
+    {
+      esp_timer_delete(g_rtp_timer);
+      g_rtp_timer = NULL;
+      vQueueDelete(g_mailbox);
+      g_mailbox = NULL;
+      return ESP_ERR_NO_MEM;
+    }
+
+  ESP_LOGI(TAG, "Haptic worker started (%s cues)", HAPTIC_CUE_PROFILE);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_set_urgency
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_set_urgency(haptic_urgency_t urgency)
+{
+  if (urgency >= HAPTIC_URGENCY_COUNT)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  return haptic_post(&g_urgency_cues[urgency]);
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_play_sequence
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_play_sequence(const uint8_t *effects,
+                                        uint8_t num_effects)
+{
+  haptic_request_t req;
+
+  if (effects == NULL || num_effects == 0 ||
+      num_effects > HAPTIC_SEQUENCE_MAX)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  memset(&req, 0, sizeof(req));
+  req.kind = HAPTIC_REQ_SEQUENCE;
+  memcpy(req.effects, effects, num_effects);
+  req.num_effects = num_effects;
+
+  return haptic_post(&req);
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_rtp_start
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_rtp_start(void)
+{
+  const haptic_request_t req =
+    {
+      .kind = HAPTIC_REQ_RTP_START,
+    };
+
+  return haptic_post(&req);
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_stop
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_stop(void)
+{
+  return haptic_post(&g_urgency_cues[HAPTIC_URGENCY_NONE]);
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_set_distance
+ ****************************************************************************/
+
+void haptic_feedback_set_distance(uint16_t mm)
+{
+  g_rtp_target = haptic_rtp_level(mm, HAPTIC_RTP_RANGE_MM);
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_set_threat
+ ****************************************************************************/
+
+void haptic_feedback_set_threat(uint16_t mm, uint16_t ttc_ms,
+                                int64_t origin_us)
+{
+  uint8_t by_distance = haptic_rtp_level(mm, HAPTIC_RTP_RANGE_MM);
+  uint8_t by_ttc = haptic_rtp_level(ttc_ms, HAPTIC_RTP_RANGE_TTC_MS);
+  uint8_t target = by_ttc > by_distance ? by_ttc : by_distance;
+
+  portENTER_CRITICAL(&g_rtp_lock);
+  if (target != g_rtp_target)
+    {
+      g_rtp_origin_us = origin_us;
+    }
+
+  g_rtp_target = target;
+  portEXIT_CRITICAL(&g_rtp_lock);
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_set_intensity
+ ****************************************************************************/
+
+void haptic_feedback_set_intensity(uint8_t level)
+{
+  g_rtp_target = level;
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_get_target
+ ****************************************************************************/
+
+uint8_t haptic_feedback_get_target(void)
+{
+  return g_rtp_target;
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_recalibrate
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_recalibrate(void)
+{
+  if (g_worker == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  xTaskNotify(g_worker, HAPTIC_EVT_CALIBRATE, eSetBits);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: haptic_feedback_get_stats
+ ****************************************************************************/
+
+esp_err_t haptic_feedback_get_stats(haptic_feedback_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_stats_lock);
+  *stats = g_stats;
+  portEXIT_CRITICAL(&g_stats_lock);
+
+  return ESP_OK;
+}
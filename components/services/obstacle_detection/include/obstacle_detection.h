@@ -3,6 +3,19 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Obstacle detection service. A service task consumes the MPU6050 FIFO
+ * stream and the VL53L5CX frames: every IMU sample updates a fixed-point
+ * complementary filter (pitch/roll), and every ToF frame is tagged with
+ * the orientation at its INT time. Zones whose range matches the ground
+ * seen at that orientation are discarded, so a lowered head does not
+ * report the floor as an obstacle.
+ *
+ * Every zone is then tracked across frames (obstacle_track.h) to get its
+ * closing speed and time to collision.
+ *
+ * Body axes (IMU mounting): X forward, Y left, Z up. Pitch is positive
+ * nose up, roll positive right side down.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_DETECTION_H
@@ -14,11 +27,219 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <esp_err.h>
+#include "vl53l5cx.h"
+#include "obstacle_fusion.h"
+#include "obstacle_track.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Angles are Q15 binary angles: 32768 = 180 degrees */
+
+#define OBSTACLE_ANGLE_TO_CDEG(a)  ((int32_t)(a) * 18000 / 32768)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Activity class driving the ToF ranging profile */
+
+typedef enum
+{
+  OBSTACLE_ACTIVITY_REST = 0,       /* 8x8, low rate */
+  OBSTACLE_ACTIVITY_WALK,           /* 8x8, walk rate */
+  OBSTACLE_ACTIVITY_RUN,            /* 4x4, run rate */
+} obstacle_activity_t;
+
+/* Orientation estimate */
+
+typedef struct
+{
+  int16_t pitch;                    /* Q15 binary angle, nose up > 0 */
+  int16_t roll;                     /* Q15 binary angle, right down > 0 */
+  int64_t timestamp_us;             /* IMU sample time */
+} obstacle_orientation_t;
+
+/* ToF frame tagged with the head orientation */
+
+typedef struct
+{
+  vl53l5cx_sensor_t sensor;
+  uint32_t sequence;                             /* Driver frame counter */
+  int64_t int_time_us;                           /* INT edge timestamp */
+  int64_t read_done_us;                          /* I2C read completed */
+  int64_t fusion_done_us;                        /* Fusion/tracking done */
+  int16_t distance_mm[VL53L5CX_NB_ZONES_MAX];    /* Ground zones invalid */
+  uint16_t ttc_ms[VL53L5CX_NB_ZONES_MAX];        /* OBSTACLE_TTC_NONE */
+  uint8_t target_status[VL53L5CX_NB_ZONES_MAX];  /* Raw, from the driver */
+  uint8_t nb_zones;                              /* 16 or 64 */
+  uint8_t valid_zones;                           /* After ground gating */
+  uint8_t ground_zones;                          /* Zones discarded */
+  bool orientation_valid;                        /* IMU data available */
+  obstacle_orientation_t orientation;            /* Nearest to INT time */
+} obstacle_frame_t;
+
+/* Service counters */
+
+typedef struct
+{
+  uint32_t imu_samples;     /* Samples through the filter */
+  uint32_t accel_rejected;  /* Samples not used for correction (|a|) */
+  uint32_t frames;          /* ToF frames tagged */
+  uint32_t untagged;        /* Frames without orientation */
+  uint32_t ground_zones;    /* Zones discarded as ground (total) */
+  uint32_t filter_max_cycles;  /* Worst filter update */
+  uint32_t filter_avg_cycles;  /* Average filter update */
+  uint32_t fusions;         /* Sector reductions */
+  uint32_t fusion_max_cycles;  /* Worst fusion kernel run */
+  uint32_t track_max_cycles;   /* Worst zone tracking update (frame) */
+  obstacle_activity_t activity;  /* Current activity class */
+  uint32_t profile_switches;     /* ToF profile changes requested */
+} obstacle_detection_stats_t;
+
+/* Tagged frame callback (service task context, keep it short) */
+
+typedef void (*obstacle_frame_cb_t)(const obstacle_frame_t *frame,
+                                    void *arg);
 
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
-/* TODO: Define obstacle_detection interface */
+/****************************************************************************
+ * Name: obstacle_detection_init
+ *
+ * Description:
+ *   Bring up the VL53L5CX sensors and the MPU6050, start the service
+ *   task and start ranging and IMU streaming. Without a working IMU the
+ *   service keeps running: frames are passed on untagged and ungated.
+ *
+ * Returned Value:
+ *   ESP_OK on success; error code if the ToF sensors or the task could
+ *   not be started.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_init(void);
+
+/****************************************************************************
+ * Name: obstacle_detection_set_frame_callback
+ *
+ * Description:
+ *   Register the tagged frame callback (NULL to remove).
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_set_frame_callback(obstacle_frame_cb_t callback,
+                                                void *arg);
+
+/****************************************************************************
+ * Name: obstacle_detection_get_frame
+ *
+ * Description:
+ *   Copy the latest tagged frame of a sensor.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if no frame yet;
+ *   ESP_ERR_INVALID_ARG on bad arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_frame(vl53l5cx_sensor_t sensor,
+                                       obstacle_frame_t *frame);
+
+/****************************************************************************
+ * Name: obstacle_detection_get_orientation
+ *
+ * Description:
+ *   Read the latest orientation estimate.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if no IMU sample yet.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_orientation(obstacle_orientation_t *out);
+
+/****************************************************************************
+ * Name: obstacle_detection_get_sectors
+ *
+ * Description:
+ *   Copy the latest left/center/right sector minima and confidence,
+ *   refreshed after every frame from the latest frame of each sensor.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND until both sensors delivered a
+ *   frame at the same resolution; ESP_ERR_INVALID_ARG on bad arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_sectors(obstacle_sectors_t *sectors);
+
+/****************************************************************************
+ * Name: obstacle_detection_get_ttc
+ *
+ * Description:
+ *   Copy the most urgent tracked zone of each sector (lowest time to
+ *   collision), refreshed after every frame. This is the input for the
+ *   haptic cue: a fast approach reports a short TTC while still far.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_FOUND if no frame yet;
+ *   ESP_ERR_INVALID_ARG on bad arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_ttc(obstacle_ttc_t *ttc);
+
+/****************************************************************************
+ * Name: obstacle_detection_get_stats
+ *
+ * Description:
+ *   Read the service counters.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_stats(obstacle_detection_stats_t *stats);
+
+/****************************************************************************
+ * Name: obstacle_detection_replay_reset
+ *
+ * Description:
+ *   Prepare the service for replay without starting it: clear the
+ *   trackers, the fusion input, the published state and the counters, as
+ *   at boot. Call again before each run for repeatable results.
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_INVALID_STATE if the service was started with
+ *   obstacle_detection_init().
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_replay_reset(void);
+
+/****************************************************************************
+ * Name: obstacle_detection_replay_frame
+ *
+ * Description:
+ *   Run a recorded frame through ground gating, fusion and tracking in
+ *   the caller's context, exactly as a live frame tagged with
+ *   orientation. The tagged frame callback is called, and the getters
+ *   return the updated state on return.
+ *
+ * Input Parameters:
+ *   frame - ToF frame (int_time_us drives the trackers)
+ *   o     - Orientation at the frame, or NULL for an untagged frame
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_INVALID_ARG on a bad frame; ESP_ERR_INVALID_STATE if
+ *   the service is running live or replay was not reset.
+ *
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_replay_frame(const vl53l5cx_frame_t *frame,
+                                          const obstacle_orientation_t *o);
 
 #endif /* __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_DETECTION_H */
@@ -0,0 +1,148 @@
+/****************************************************************************
+ * components/services/obstacle_detection/include/obstacle_fusion.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Dual-sensor zone fusion kernel. Reduces the left and right VL53L5CX
+ * frames to left/center/right sector minima and confidence:
+ *   - left sector:   outer half of the left sensor columns
+ *   - center sector: inner halves of both sensors
+ *   - right sector:  outer half of the right sensor columns
+ * A zone counts when its distance is valid (the driver target status
+ * filter and the ground gating both write VL53L5CX_DISTANCE_INVALID) and
+ * its signal is at least the minimum signal.
+ *
+ * Input is structure-of-arrays with 16-byte aligned 64-entry buffers so
+ * one 128-bit vector holds one 8x8 row (or two 4x4 rows). On the
+ * ESP32-S3 the per-column stage runs on the PIE SIMD unit
+ * (CONFIG_MAIA_OBSTACLE_FUSION_PIE); the scalar version is the portable
+ * fallback and the reference for the unit test.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_FUSION_H
+#define __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_FUSION_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vl53l5cx.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Alignment of the SoA buffers (PIE 128-bit loads) */
+
+#define OBSTACLE_FUSION_ALIGN  16
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef enum
+{
+  OBSTACLE_SECTOR_LEFT = 0,
+  OBSTACLE_SECTOR_CENTER,
+  OBSTACLE_SECTOR_RIGHT,
+  OBSTACLE_SECTOR_COUNT,
+} obstacle_sector_t;
+
+/* Zones of one sensor, structure-of-arrays */
+
+typedef struct
+{
+  int16_t distance_mm[VL53L5CX_NB_ZONES_MAX]
+    __attribute__((aligned(OBSTACLE_FUSION_ALIGN)));
+  uint16_t signal_kcps[VL53L5CX_NB_ZONES_MAX]
+    __attribute__((aligned(OBSTACLE_FUSION_ALIGN)));
+} obstacle_zones_t;
+
+/* Kernel input: both sensors at the same resolution */
+
+typedef struct
+{
+  obstacle_zones_t zones[VL53L5CX_SENSOR_COUNT];
+  uint8_t nb_zones;                 /* 16 or 64 */
+  uint16_t min_signal_kcps;         /* Weaker zones are ignored */
+} obstacle_fusion_input_t;
+
+/* Kernel output */
+
+typedef struct
+{
+  int16_t min_mm[OBSTACLE_SECTOR_COUNT];    /* INVALID if no zone */
+  uint8_t confidence[OBSTACLE_SECTOR_COUNT];  /* Valid share, 0-255 */
+} obstacle_sectors_t;
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obstacle_fusion_sector
+ *
+ * Description:
+ *   Sector of a zone column: the outer half of each sensor is its own
+ *   side, the inner halves form the center.
+ *
+ ****************************************************************************/
+
+static inline obstacle_sector_t obstacle_fusion_sector(int sensor, int col,
+                                                       int side)
+{
+  bool left_half = col < side / 2;
+
+  if (sensor == VL53L5CX_SENSOR_LEFT)
+    {
+      return left_half ? OBSTACLE_SECTOR_LEFT : OBSTACLE_SECTOR_CENTER;
+    }
+
+  return left_half ? OBSTACLE_SECTOR_CENTER : OBSTACLE_SECTOR_RIGHT;
+}
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obstacle_fusion_reduce
+ *
+ * Description:
+ *   Reduce both frames to sector minima and confidence, with the PIE
+ *   kernel when built in, the scalar one otherwise.
+ *
+ * Input Parameters:
+ *   in  - Zones of both sensors (nb_zones 16 or 64)
+ *   out - Sector results
+ *
+ ****************************************************************************/
+
+void obstacle_fusion_reduce(const obstacle_fusion_input_t *in,
+                            obstacle_sectors_t *out);
+
+/****************************************************************************
+ * Name: obstacle_fusion_reduce_scalar
+ *
+ * Description:
+ *   Portable zone-by-zone reference implementation.
+ *
+ ****************************************************************************/
+
+void obstacle_fusion_reduce_scalar(const obstacle_fusion_input_t *in,
+                                   obstacle_sectors_t *out);
+
+/****************************************************************************
+ * Name: obstacle_fusion_has_simd
+ *
+ * Description:
+ *   true if obstacle_fusion_reduce() uses the PIE kernel.
+ *
+ ****************************************************************************/
+
+bool obstacle_fusion_has_simd(void);
+
+#endif /* __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_FUSION_H */
@@ -0,0 +1,113 @@
+/****************************************************************************
+ * components/services/obstacle_detection/include/obstacle_track.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Per-zone obstacle tracking. Each of the 2 x 64 zones runs an integer
+ * alpha-beta filter on its gated distance to estimate range and closing
+ * speed, and reports the time to collision (range / closing speed):
+ *   - predict:  x' = x + v dt
+ *   - correct:  x = x' + alpha r,  v = v + beta r / dt  (r = z - x')
+ * A short ring of past frames per zone lets a track coast over dropped
+ * zones, reject single-frame spikes (residual beyond the gate) and
+ * restart on a new target once the ring confirms it.
+ *
+ * All state is static (sized for 8x8 on both sensors); updates run in
+ * the obstacle detection service task.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_TRACK_H
+#define __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_TRACK_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vl53l5cx.h"
+#include "obstacle_fusion.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Frames kept per zone */
+
+#define OBSTACLE_TRACK_HISTORY  4
+
+/* TTC of a zone that is not closing in (or not tracked) */
+
+#define OBSTACLE_TTC_NONE       UINT16_MAX
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Filter gains and thresholds */
+
+typedef struct
+{
+  uint16_t alpha_q15;               /* Position gain */
+  uint16_t beta_q15;                /* Velocity gain */
+  uint16_t gate_mm;                 /* Residual beyond this is an outlier */
+  uint16_t min_closing_mm_s;        /* Slower approaches report no TTC */
+  uint8_t max_coast;                /* Frames predicted without a range */
+} obstacle_track_config_t;
+
+/* Sector summary: the most urgent zone of each sector */
+
+typedef struct
+{
+  uint16_t ttc_ms[OBSTACLE_SECTOR_COUNT];        /* OBSTACLE_TTC_NONE */
+  int16_t closing_mm_s[OBSTACLE_SECTOR_COUNT];   /* Of that zone */
+  int16_t distance_mm[OBSTACLE_SECTOR_COUNT];    /* Filtered, of that zone */
+} obstacle_ttc_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obstacle_track_init
+ *
+ * Description:
+ *   Set the filter configuration and drop every track.
+ *
+ ****************************************************************************/
+
+void obstacle_track_init(const obstacle_track_config_t *config);
+
+/****************************************************************************
+ * Name: obstacle_track_update
+ *
+ * Description:
+ *   Run one frame of a sensor through the zone filters. A resolution
+ *   change restarts the tracks of that sensor.
+ *
+ * Input Parameters:
+ *   sensor      - Sensor of the frame
+ *   distance_mm - Gated zone distances (VL53L5CX_DISTANCE_INVALID if none)
+ *   nb_zones    - 16 or 64
+ *   time_us     - Frame time (INT timestamp)
+ *   ttc_ms      - Per-zone TTC output (nb_zones entries)
+ *
+ ****************************************************************************/
+
+void obstacle_track_update(vl53l5cx_sensor_t sensor,
+                           const int16_t *distance_mm, uint8_t nb_zones,
+                           int64_t time_us, uint16_t *ttc_ms);
+
+/****************************************************************************
+ * Name: obstacle_track_sectors
+ *
+ * Description:
+ *   Most urgent (lowest TTC) tracked zone of each sector, over the
+ *   latest frame of both sensors.
+ *
+ ****************************************************************************/
+
+void obstacle_track_sectors(obstacle_ttc_t *out);
+
+#endif /* __COMPONENTS_SERVICES_OBSTACLE_DETECTION_INCLUDE_OBSTACLE_TRACK_H */
@@ -3,6 +3,30 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Orientation filter (per IMU sample, integer only):
+ *   - gyro: pitch -= gy * dt, roll += gx * dt (small-angle Euler rates)
+ *   - accel: pitch_a = atan2(ax, |ayz|), roll_a = atan2(ay, az)
+ *   - state += (accel - state) * dt / (tau + dt), skipped while |a| is
+ *     far from 1 g (running, jumping)
+ * State is kept as Q31 binary angles (2^31 = 180 degrees) so additions
+ * and errors wrap naturally at +/-180; published angles are Q15.
+ *
+ * Ground gating (per ToF frame): each zone's elevation is derived from
+ * the pitch/roll at the frame's INT time and the zone direction. A zone
+ * looking below the horizon whose range is at least the distance to the
+ * floor along that ray (minus a margin) sees the ground and is marked
+ * invalid.
+ *
+ * Tracking (per ToF frame): the gated zones go through the per-zone
+ * alpha-beta filters; the frame carries the zone TTCs and the sector
+ * summary is refreshed.
+ *
+ * Adaptive ranging (per IMU window): the mean deviation of |a| from 1 g
+ * classifies the dog as resting, walking or running, independently of
+ * the head orientation. A faster ToF profile is requested at the first
+ * window above its threshold; a slower one only after the activity has
+ * stayed below the threshold minus the hysteresis for the dwell time.
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,9 +34,1229 @@
  ****************************************************************************/
 
 #include "obstacle_detection.h"
+#include "mpu6050.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+#include <stdlib.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[OBSTACLE]"
+
+#define OD_TASK_STACK_SIZE      4096
+#define OD_TASK_PRIORITY        (configMAX_PRIORITIES - 4)
+
+/* Service task wake-up reasons: bits 0-1 = ToF frame of sensor N */
+
+#define OD_EVT_IMU              (1u << 2)
+
+/* IMU samples popped from the driver ring per read */
+
+#define OD_IMU_BATCH            32
+
+/* Orientation history used to tag frames (covers the IMU watermark
+ * latency at 1 kHz)
+ */
+
+#define OD_HISTORY_SIZE         64
+
+/* Filter */
+
+#define OD_TAU_US               (CONFIG_MAIA_OBSTACLE_ORIENT_TAU_MS * 1000)
+#define OD_MAX_DT_US            50000   /* Gyro gap clamp */
+
+/* Q31 binary angles */
+
+#define OD_BAM32_90             0x40000000u
+#define OD_BAM32_180            0x80000000u
+#define OD_BAM32_45             0x20000000
+
+/* Q15 binary angles */
+
+#define OD_BAM16_90             16384
+#define OD_DEG_TO_BAM16(d)      ((int32_t)(d) * 32768 / 180)
+
+/* ToF geometry: 45 x 45 degree square field of view */
+
+#define OD_TOF_HALF_FOV         (OD_DEG_TO_BAM16(45) / 2)
+#define OD_MOUNT_HEIGHT_MM      CONFIG_MAIA_OBSTACLE_MOUNT_HEIGHT_MM
+#define OD_MOUNT_TILT \
+  OD_DEG_TO_BAM16(CONFIG_MAIA_OBSTACLE_MOUNT_TILT_DEG)
+#define OD_GROUND_MARGIN_PCT    CONFIG_MAIA_OBSTACLE_GROUND_MARGIN_PCT
+
+/* Sector fusion */
+
+#define OD_MIN_SIGNAL_KCPS      CONFIG_MAIA_OBSTACLE_MIN_SIGNAL_KCPS
+
+/* Zone tracking (percent to Q15) */
+
+#define OD_PCT_TO_Q15(p)        ((p) * 32768 / 100)
+#define OD_TRACK_ALPHA_Q15 \
+  OD_PCT_TO_Q15(CONFIG_MAIA_OBSTACLE_TRACK_ALPHA_PCT)
+#define OD_TRACK_BETA_Q15 \
+  OD_PCT_TO_Q15(CONFIG_MAIA_OBSTACLE_TRACK_BETA_PCT)
+
+/* Adaptive ranging */
+
+#ifdef CONFIG_MAIA_OBSTACLE_ADAPTIVE_RANGING
+#  define OD_ACT_WINDOW_US      500000
+#  define OD_ACT_WALK_MG        CONFIG_MAIA_OBSTACLE_ACTIVITY_WALK_MG
+#  define OD_ACT_RUN_MG         CONFIG_MAIA_OBSTACLE_ACTIVITY_RUN_MG
+#  define OD_ACT_EXIT(mg) \
+  ((mg) * (100 - CONFIG_MAIA_OBSTACLE_ACTIVITY_HYST_PCT) / 100)
+#  define OD_ACT_DWELL_US \
+  ((int64_t)CONFIG_MAIA_OBSTACLE_ACTIVITY_DWELL_MS * 1000)
+
+#  if OD_ACT_RUN_MG <= OD_ACT_WALK_MG
+#    error "Running threshold must be above the walking threshold"
+#  endif
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Complementary filter state (service task only) */
+
+typedef struct
+{
+  int32_t pitch;                /* Q31 binary angle */
+  int32_t roll;                 /* Q31 binary angle */
+  int64_t last_us;              /* Previous sample time */
+  int32_t gyro_gain_q24;        /* Q31 angle per LSB per us, Q24 */
+  int32_t alpha_q15;            /* Accel correction weight */
+  uint32_t norm_min;            /* |a|^2 window (LSB^2) */
+  uint32_t norm_max;
+  bool primed;
+} od_filter_t;
+
+/* Activity classifier state (service task only) */
+
+typedef struct
+{
+  uint64_t sum;                 /* | |a| - 1 g | over the window (LSB) */
+  uint32_t count;
+  int64_t window_us;            /* Window start */
+  int64_t low_since_us;         /* Below the state's exit, 0 if not */
+  obstacle_activity_t state;
+  bool applied;                 /* Driver runs the state's profile */
+} od_activity_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const obstacle_track_config_t g_track_config =
+{
+  .alpha_q15 = OD_TRACK_ALPHA_Q15,
+  .beta_q15 = OD_TRACK_BETA_Q15,
+  .gate_mm = CONFIG_MAIA_OBSTACLE_TRACK_GATE_MM,
+  .min_closing_mm_s = CONFIG_MAIA_OBSTACLE_TRACK_MIN_CLOSING_MM_S,
+  .max_coast = CONFIG_MAIA_OBSTACLE_TRACK_MAX_COAST,
+};
+
+static TaskHandle_t g_task = NULL;
+static bool g_imu_ok = false;
+static bool g_replay_ready = false;     /* Replay state was reset */
+
+/* Service task, or the replay caller, only */
+
+static od_filter_t g_filter;
+static obstacle_orientation_t g_history[OD_HISTORY_SIZE];
+static uint32_t g_history_head = 0;     /* Entries written */
+static mpu6050_sample_t g_imu_batch[OD_IMU_BATCH];
+static obstacle_frame_t g_work;
+static uint64_t g_filter_cycles = 0;
+static od_activity_t g_activity;
+static obstacle_fusion_input_t g_fusion;
+static uint32_t g_fusion_have = 0;      /* One bit per sensor */
+
+/* Published state (g_lock) */
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static obstacle_frame_t g_frames[VL53L5CX_SENSOR_COUNT];
+static uint32_t g_have_frame = 0;       /* One bit per sensor */
+static obstacle_sectors_t g_sectors;
+static bool g_have_sectors = false;
+static obstacle_ttc_t g_ttc;
+static obstacle_orientation_t g_orientation;
+static obstacle_detection_stats_t g_stats;
+static obstacle_frame_cb_t g_frame_cb = NULL;
+static void *g_frame_cb_arg = NULL;
+
+/****************************************************************************
+ * Private Functions: Fixed-point Math
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: od_isqrt
+ *
+ * Description:
+ *   Integer square root (bit by bit).
+ *
+ ****************************************************************************/
+
+static uint32_t od_isqrt(uint32_t v)
+{
+  uint32_t res = 0;
+  uint32_t bit = 1u << 30;
+
+  while (bit > v)
+    {
+      bit >>= 2;
+    }
+
+  while (bit != 0)
+    {
+      if (v >= res + bit)
+        {
+          v -= res + bit;
+          res = (res >> 1) + bit;
+        }
+      else
+        {
+          res >>= 1;
+        }
+
+      bit >>= 2;
+    }
+
+  return res;
+}
+
+/****************************************************************************
+ * Name: od_atan2
+ *
+ * Description:
+ *   atan2(y, x) as a Q31 binary angle. First octant polynomial
+ *   atan(r) = pi/4 r + r (1 - r) (0.2447 + 0.0663 r), error < 0.1 deg.
+ *
+ ****************************************************************************/
+
+static int32_t od_atan2(int32_t y, int32_t x)
+{
+  uint32_t ax = (uint32_t)abs(x);
+  uint32_t ay = (uint32_t)abs(y);
+  uint32_t angle;
+  int64_t r;
+  int64_t c;
+
+  if (ax == 0 && ay == 0)
+    {
+      return 0;
+    }
+
+  /* r = min / max in Q15 (inputs < 2^17) */
+
+  r = (ax >= ay) ? ((uint64_t)ay << 15) / ax : ((uint64_t)ax << 15) / ay;
+
+  /* 0.2447 and 0.0663 rad as Q31 binary angles */
+
+  c = 167268423 + ((45320378 * r) >> 15);
+  angle = (uint32_t)(((OD_BAM32_45 * r) >> 15) +
+                     ((((r * (32768 - r)) >> 15) * c) >> 15));
+
+  if (ax < ay)
+    {
+      angle = OD_BAM32_90 - angle;
+    }
+
+  if (x < 0)
+    {
+      angle = OD_BAM32_180 - angle;
+    }
+
+  if (y < 0)
+    {
+      angle = -angle;
+    }
+
+  return (int32_t)angle;
+}
+
+/****************************************************************************
+ * Name: od_sin
+ *
+ * Description:
+ *   sin() of a Q15 binary angle, Q15 result (Bhaskara I approximation,
+ *   error < 0.002).
+ *
+ ****************************************************************************/
+
+static int32_t od_sin(int32_t a)
+{
+  int32_t t;
+  int64_t p;
+  int32_t s;
+
+  a = (int16_t)a;                       /* Wrap to [-180, 180) */
+  t = (a < 0) ? -a : a;                 /* Fraction of 180 degrees, Q15 */
+
+  /* sin(pi t) = 16 t (1 - t) / (5 - 4 t (1 - t)) */
+
+  p = ((int64_t)t * (32768 - t)) >> 15;
+  s = (int32_t)((16 * p * 32768) / (5 * 32768 - 4 * p));
+
+  return (a < 0) ? -s : s;
+}
+
+/****************************************************************************
+ * Name: od_blend
+ *
+ * Description:
+ *   Move a Q31 binary angle towards a target by alpha (Q15), along the
+ *   shortest way around the circle.
+ *
+ ****************************************************************************/
+
+static inline int32_t od_blend(int32_t angle, int32_t target,
+                               int32_t alpha_q15)
+{
+  int32_t err = (int32_t)((uint32_t)target - (uint32_t)angle);
+
+  return (int32_t)((uint32_t)angle +
+                   (uint32_t)(((int64_t)err * alpha_q15) >> 15));
+}
+
+/****************************************************************************
+ * Private Functions: Orientation
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: od_filter_init
+ ****************************************************************************/
+
+static void od_filter_init(od_filter_t *f, uint16_t odr_hz)
+{
+  int32_t dt_us = 1000000 / odr_hz;
+  uint32_t g2 = (uint32_t)MPU6050_ACCEL_LSB_PER_G * MPU6050_ACCEL_LSB_PER_G;
+
+  memset(f, 0, sizeof(*f));
+
+  /* 2^31 / 180 [Q31 per deg] * 10 / LSB_PER_DPS_X10 [deg/s per LSB]
+   * / 1e6 [s per us], in Q24. Init time only.
+   */
+
+  f->gyro_gain_q24 = (int32_t)(2147483648.0 / 180.0 * 10.0 /
+                               MPU6050_GYRO_LSB_PER_DPS_X10 / 1e6 *
+                               16777216.0);
+  f->alpha_q15 = (int32_t)(((int64_t)dt_us << 15) / (OD_TAU_US + dt_us));
+
+  /* Accept accel correction for |a| within 0.8 .. 1.2 g */
+
+  f->norm_min = g2 / 100 * 64;
+  f->norm_max = g2 / 100 * 144;
+}
+
+/****************************************************************************
+ * Name: od_filter_update
+ *
+ * Description:
+ *   One complementary filter step. Returns false if the accelerometer
+ *   was not used for correction.
+ *
+ ****************************************************************************/
+
+static bool od_filter_update(od_filter_t *f, const mpu6050_sample_t *s)
+{
+  int32_t ax = s->accel[0];
+  int32_t ay = s->accel[1];
+  int32_t az = s->accel[2];
+  uint32_t yz2 = (uint32_t)(ay * ay) + (uint32_t)(az * az);
+  uint32_t norm = yz2 + (uint32_t)(ax * ax);
+  int32_t pitch_a;
+  int32_t roll_a;
+  int64_t dt;
+
+  pitch_a = od_atan2(ax, (int32_t)od_isqrt(yz2));
+  roll_a = od_atan2(ay, az);
+
+  if (!f->primed)
+    {
+      f->pitch = pitch_a;
+      f->roll = roll_a;
+      f->last_us = s->timestamp_us;
+      f->primed = true;
+      return true;
+    }
+
+  dt = s->timestamp_us - f->last_us;
+  f->last_us = s->timestamp_us;
+  if (dt < 0 || dt > OD_MAX_DT_US)
+    {
+      dt = 0;
+    }
+
+  /* Gyro propagation (nose up is a negative rotation about +Y) */
+
+  f->pitch = (int32_t)((uint32_t)f->pitch -
+                       (uint32_t)((s->gyro[1] * dt * f->gyro_gain_q24)
+                                  >> 24));
+  f->roll = (int32_t)((uint32_t)f->roll +
+                      (uint32_t)((s->gyro[0] * dt * f->gyro_gain_q24)
+                                 >> 24));
+
+  if (norm < f->norm_min || norm > f->norm_max)
+    {
+      return false;
+    }
+
+  /* Accel correction on the wrapped error */
+
+  f->pitch = od_blend(f->pitch, pitch_a, f->alpha_q15);
+  f->roll = od_blend(f->roll, roll_a, f->alpha_q15);
+
+  return true;
+}
+
+#ifdef CONFIG_MAIA_OBSTACLE_ADAPTIVE_RANGING
+
+/****************************************************************************
+ * Private Functions: Adaptive Ranging
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: od_activity_apply
+ *
+ * Description:
+ *   Request the ToF profile of an activity class. Returns false if the
+ *   driver rejected it (retried at the next window).
+ *
+ ****************************************************************************/
+
+static bool od_activity_apply(obstacle_activity_t state)
+{
+  static const struct
+  {
+    vl53l5cx_resolution_t res;
+    uint8_t freq_hz;
+  } profiles[] =
+  {
+    [OBSTACLE_ACTIVITY_REST] =
+      { VL53L5CX_RESOLUTION_8X8, CONFIG_MAIA_OBSTACLE_REST_FREQ_HZ },
+    [OBSTACLE_ACTIVITY_WALK] =
+      { VL53L5CX_RESOLUTION_8X8, CONFIG_MAIA_OBSTACLE_WALK_FREQ_HZ },
+    [OBSTACLE_ACTIVITY_RUN] =
+      { VL53L5CX_RESOLUTION_4X4, CONFIG_MAIA_OBSTACLE_RUN_FREQ_HZ },
+  };
+
+  static const char *const names[] =
+  {
+    [OBSTACLE_ACTIVITY_REST] = "rest",
+    [OBSTACLE_ACTIVITY_WALK] = "walk",
+    [OBSTACLE_ACTIVITY_RUN] = "run",
+  };
+
+  esp_err_t ret;
+
+  ret = vl53l5cx_set_profile(profiles[state].res, profiles[state].freq_hz);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Profile for %s rejected: %s", names[state],
+               esp_err_to_name(ret));
+      return false;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  g_stats.activity = state;
+  g_stats.profile_switches++;
+  portEXIT_CRITICAL(&g_lock);
+
+  ESP_LOGI(TAG, "Activity: %s", names[state]);
+  return true;
+}
+
+/****************************************************************************
+ * Name: od_activity_classify
+ *
+ * Description:
+ *   New state from one window mean. Thresholds above the current state
+ *   use the entry value, the current one and below the exit value. The
+ *   first window also brings the driver from its Kconfig default to the
+ *   profile of the state.
+ *
+ ****************************************************************************/
+
+static void od_activity_classify(od_activity_t *a, uint32_t mean_mg,
+                                 int64_t now_us)
+{
+  obstacle_activity_t want = OBSTACLE_ACTIVITY_REST;
+
+  if (mean_mg >= (a->state >= OBSTACLE_ACTIVITY_WALK ?
+                  OD_ACT_EXIT(OD_ACT_WALK_MG) : OD_ACT_WALK_MG))
+    {
+      want = OBSTACLE_ACTIVITY_WALK;
+    }
+
+  if (mean_mg >= (a->state >= OBSTACLE_ACTIVITY_RUN ?
+                  OD_ACT_EXIT(OD_ACT_RUN_MG) : OD_ACT_RUN_MG))
+    {
+      want = OBSTACLE_ACTIVITY_RUN;
+    }
+
+  if (want < a->state)
+    {
+      if (a->low_since_us == 0)
+        {
+          a->low_since_us = now_us;
+        }
+
+      if (now_us - a->low_since_us >= OD_ACT_DWELL_US)
+        {
+          a->state = want;
+          a->applied = false;
+        }
+    }
+  else if (want > a->state)
+    {
+      a->state = want;
+      a->applied = false;
+    }
+
+  if (want >= a->state)
+    {
+      a->low_since_us = 0;
+    }
+
+  if (!a->applied)
+    {
+      a->applied = od_activity_apply(a->state);
+    }
+}
+
+/****************************************************************************
+ * Name: od_activity_update
+ *
+ * Description:
+ *   Accumulate one IMU sample and classify at the end of each window.
+ *
+ ****************************************************************************/
+
+static void od_activity_update(od_activity_t *a, const mpu6050_sample_t *s)
+{
+  int32_t ax = s->accel[0];
+  int32_t ay = s->accel[1];
+  int32_t az = s->accel[2];
+  uint32_t norm = (uint32_t)(ax * ax) + (uint32_t)(ay * ay) +
+                  (uint32_t)(az * az);
+
+  a->sum += (uint32_t)abs((int32_t)od_isqrt(norm) -
+                          MPU6050_ACCEL_LSB_PER_G);
+  a->count++;
+
+  if (a->window_us == 0)
+    {
+      a->window_us = s->timestamp_us;
+    }
+
+  if (s->timestamp_us - a->window_us < OD_ACT_WINDOW_US)
+    {
+      return;
+    }
+
+  od_activity_classify(a, (uint32_t)(a->sum * 1000 /
+                                     ((uint64_t)a->count *
+                                      MPU6050_ACCEL_LSB_PER_G)),
+                       s->timestamp_us);
+
+  a->sum = 0;
+  a->count = 0;
+  a->window_us = s->timestamp_us;
+}
+
+#endif /* CONFIG_MAIA_OBSTACLE_ADAPTIVE_RANGING */
+
+/****************************************************************************
+ * Name: od_process_imu
+ *
+ * Description:
+ *   Run every pending IMU sample through the filter and record the
+ *   orientation history.
+ *
+ ****************************************************************************/
+
+static void od_process_imu(void)
+{
+  uint32_t samples = 0;
+  uint32_t rejected = 0;
+  uint32_t max_cycles = 0;
+  obstacle_orientation_t *o = NULL;
+  size_t n;
+
+  while ((n = mpu6050_read_samples(g_imu_batch, OD_IMU_BATCH)) > 0)
+    {
+      for (size_t i = 0; i < n; i++)
+        {
+          uint32_t c0 = esp_cpu_get_cycle_count();
+          uint32_t cycles;
+
+          if (!od_filter_update(&g_filter, &g_imu_batch[i]))
+            {
+              rejected++;
+            }
+
+          cycles = esp_cpu_get_cycle_count() - c0;
+          g_filter_cycles += cycles;
+          if (cycles > max_cycles)
+            {
+              max_cycles = cycles;
+            }
+
+#ifdef CONFIG_MAIA_OBSTACLE_ADAPTIVE_RANGING
+          od_activity_update(&g_activity, &g_imu_batch[i]);
+#endif
+
+          o = &g_history[g_history_head++ % OD_HISTORY_SIZE];
+          o->pitch = (int16_t)(g_filter.pitch >> 16);
+          o->roll = (int16_t)(g_filter.roll >> 16);
+          o->timestamp_us = g_imu_batch[i].timestamp_us;
+        }
+
+      samples += n;
+    }
+
+  if (o == NULL)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  g_orientation = *o;
+  g_stats.imu_samples += samples;
+  g_stats.accel_rejected += rejected;
+  if (max_cycles > g_stats.filter_max_cycles)
+    {
+      g_stats.filter_max_cycles = max_cycles;
+    }
+
+  g_stats.filter_avg_cycles = (uint32_t)(g_filter_cycles /
+                                         g_stats.imu_samples);
+  portEXIT_CRITICAL(&g_lock);
+}
+
+/****************************************************************************
+ * Name: od_orientation_at
+ *
+ * Description:
+ *   Orientation history entry nearest to a time. Frames newer than the
+ *   last IMU sample get the latest entry.
+ *
+ ****************************************************************************/
+
+static const obstacle_orientation_t *od_orientation_at(int64_t t_us)
+{
+  uint32_t count = g_history_head < OD_HISTORY_SIZE ?
+                   g_history_head : OD_HISTORY_SIZE;
+  const obstacle_orientation_t *best;
+
+  if (count == 0)
+    {
+      return NULL;
+    }
+
+  best = &g_history[(g_history_head - 1) % OD_HISTORY_SIZE];
+
+  for (uint32_t i = 1; i < count && best->timestamp_us > t_us; i++)
+    {
+      const obstacle_orientation_t *older =
+        &g_history[(g_history_head - 1 - i) % OD_HISTORY_SIZE];
+
+      if (t_us - older->timestamp_us >= best->timestamp_us - t_us)
+        {
+          break;
+        }
+
+      best = older;
+    }
+
+  return best;
+}
+
+/****************************************************************************
+ * Private Functions: Frames
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: od_gate_ground
+ *
+ * Description:
+ *   Invalidate the zones of g_work that see the floor. Zone (row, col)
+ *   points at elevation row_elev * cos(roll) - col_az * sin(roll)
+ *   relative to the sensor boresight, which points at pitch - tilt.
+ *
+ ****************************************************************************/
+
+static void od_gate_ground(obstacle_frame_t *f)
+{
+  int side = (f->nb_zones == 64) ? 8 : 4;
+  int32_t step = (2 * OD_TOF_HALF_FOV) / side;
+  int32_t boresight = f->orientation.pitch - OD_MOUNT_TILT;
+  int32_t sin_roll = od_sin(f->orientation.roll);
+  int32_t cos_roll = od_sin(f->orientation.roll + OD_BAM16_90);
+
+  for (int row = 0; row < side; row++)
+    {
+      int32_t row_elev = OD_TOF_HALF_FOV - (2 * row + 1) * step / 2;
+
+      for (int col = 0; col < side; col++)
+        {
+          int32_t col_az = -OD_TOF_HALF_FOV + (2 * col + 1) * step / 2;
+          int32_t elev = boresight + ((row_elev * cos_roll -
+                                       col_az * sin_roll) >> 15);
+          int16_t *mm = &f->distance_mm[row * side + col];
+          int32_t sin_dep;
+          int64_t ground_mm;
+
+          if (elev >= 0 || *mm == VL53L5CX_DISTANCE_INVALID)
+            {
+              continue;
+            }
+
+          /* Floor along the ray: h / sin(depression) */
+
+          sin_dep = od_sin(-elev);
+          if (sin_dep <= 0)
+            {
+              continue;
+            }
+
+          ground_mm = ((int64_t)OD_MOUNT_HEIGHT_MM << 15) / sin_dep;
+
+          if ((int64_t)*mm * 100 >= ground_mm * (100 - OD_GROUND_MARGIN_PCT))
+            {
+              *mm = VL53L5CX_DISTANCE_INVALID;
+              f->valid_zones--;
+              f->ground_zones++;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: od_fuse
+ *
+ * Description:
+ *   Store the gated distances of a sensor in the fusion input and, once
+ *   both sensors are at the same resolution, refresh the sectors.
+ *
+ ****************************************************************************/
+
+static void od_fuse(vl53l5cx_sensor_t sensor, const obstacle_frame_t *f)
+{
+  obstacle_sectors_t sectors;
+  uint32_t c0;
+  uint32_t cycles;
+
+  if (f->nb_zones != g_fusion.nb_zones)
+    {
+      /* Resolution change: wait for the other sensor to follow */
+
+      g_fusion.nb_zones = f->nb_zones;
+      g_fusion_have = 0;
+    }
+
+  memcpy(g_fusion.zones[sensor].distance_mm, f->distance_mm,
+         f->nb_zones * sizeof(f->distance_mm[0]));
+  g_fusion_have |= 1u << sensor;
+
+  if (g_fusion_have != (1u << VL53L5CX_SENSOR_COUNT) - 1)
+    {
+      return;
+    }
+
+  c0 = esp_cpu_get_cycle_count();
+  obstacle_fusion_reduce(&g_fusion, &sectors);
+  cycles = esp_cpu_get_cycle_count() - c0;
+
+  portENTER_CRITICAL(&g_lock);
+  g_sectors = sectors;
+  g_have_sectors = true;
+  g_stats.fusions++;
+  if (cycles > g_stats.fusion_max_cycles)
+    {
+      g_stats.fusion_max_cycles = cycles;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+}
+
+/****************************************************************************
+ * Name: od_track
+ *
+ * Description:
+ *   Run the gated frame through the zone trackers and refresh the sector
+ *   TTC summary.
+ *
+ ****************************************************************************/
+
+static void od_track(obstacle_frame_t *f)
+{
+  obstacle_ttc_t ttc;
+  uint32_t c0;
+  uint32_t cycles;
+
+  c0 = esp_cpu_get_cycle_count();
+  obstacle_track_update(f->sensor, f->distance_mm, f->nb_zones,
+                        f->int_time_us, f->ttc_ms);
+  obstacle_track_sectors(&ttc);
+  cycles = esp_cpu_get_cycle_count() - c0;
+
+  portENTER_CRITICAL(&g_lock);
+  g_ttc = ttc;
+  if (cycles > g_stats.track_max_cycles)
+    {
+      g_stats.track_max_cycles = cycles;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+}
+
+/****************************************************************************
+ * Name: od_load_frame
+ *
+ * Description:
+ *   Copy a driver frame into the work frame and the fusion input, so the
+ *   driver frame can be released before the processing.
+ *
+ ****************************************************************************/
+
+static void od_load_frame(const vl53l5cx_frame_t *frame)
+{
+  obstacle_frame_t *f = &g_work;
+
+  f->sensor = frame->sensor;
+  f->sequence = frame->sequence;
+  f->int_time_us = frame->int_time_us;
+  f->read_done_us = frame->read_done_us;
+  f->nb_zones = frame->nb_zones;
+  f->valid_zones = frame->valid_zones;
+  f->ground_zones = 0;
+  memcpy(f->distance_mm, frame->distance_mm,
+         frame->nb_zones * sizeof(frame->distance_mm[0]));
+  memcpy(f->target_status, frame->target_status, frame->nb_zones);
+  memcpy(g_fusion.zones[frame->sensor].signal_kcps, frame->signal_kcps,
+         frame->nb_zones * sizeof(frame->signal_kcps[0]));
+}
+
+/****************************************************************************
+ * Name: od_run_frame
+ *
+ * Description:
+ *   Tag the work frame with an orientation (NULL: untagged), gate ground
+ *   zones, fuse, track and publish it.
+ *
+ ****************************************************************************/
+
+static void od_run_frame(const obstacle_orientation_t *o)
+{
+  obstacle_frame_t *f = &g_work;
+  obstacle_frame_cb_t cb;
+  void *cb_arg;
+
+  f->orientation_valid = (o != NULL);
+  if (o != NULL)
+    {
+      f->orientation = *o;
+      od_gate_ground(f);
+    }
+  else
+    {
+      memset(&f->orientation, 0, sizeof(f->orientation));
+    }
+
+  od_fuse(f->sensor, f);
+  od_track(f);
+
+  f->fusion_done_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&g_lock);
+  g_frames[f->sensor] = *f;
+  g_have_frame |= 1u << f->sensor;
+  g_stats.frames++;
+  g_stats.ground_zones += f->ground_zones;
+  if (o == NULL)
+    {
+      g_stats.untagged++;
+    }
+
+  cb = g_frame_cb;
+  cb_arg = g_frame_cb_arg;
+  portEXIT_CRITICAL(&g_lock);
+
+  if (cb != NULL)
+    {
+      cb(f, cb_arg);
+    }
+}
+
+/****************************************************************************
+ * Name: od_process_frame
+ *
+ * Description:
+ *   Copy the latest frame of a sensor, tag it with the orientation at
+ *   its INT time and process it.
+ *
+ ****************************************************************************/
+
+static void od_process_frame(vl53l5cx_sensor_t sensor)
+{
+  const vl53l5cx_frame_t *frame;
+
+  if (vl53l5cx_acquire_frame(sensor, &frame) != ESP_OK)
+    {
+      return;
+    }
+
+  od_load_frame(frame);
+  vl53l5cx_release_frame(sensor);
+
+  maia_latency_record(MAIA_LAT_I2C_READ, g_work.int_time_us,
+                      g_work.read_done_us);
+
+  od_run_frame(od_orientation_at(g_work.int_time_us));
+
+  maia_latency_record(MAIA_LAT_FUSION, g_work.int_time_us,
+                      g_work.fusion_done_us);
+}
+
+/****************************************************************************
+ * Name: od_task
+ ****************************************************************************/
+
+static void od_task(void *arg)
+{
+  uint32_t pending;
+
+  (void)arg;
+
+  for (;;)
+    {
+      xTaskNotifyWait(0, UINT32_MAX, &pending, portMAX_DELAY);
+
+      /* IMU first, so the history covers the frames' INT times */
+
+      if (pending & OD_EVT_IMU)
+        {
+          od_process_imu();
+        }
+
+      for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+        {
+          if (pending & (1u << i))
+            {
+              od_process_frame(i);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: od_imu_cb / od_tof_cb
+ *
+ * Description:
+ *   Driver callbacks (driver reader tasks): wake the service task.
+ *
+ ****************************************************************************/
+
+static void od_imu_cb(void *arg)
+{
+  (void)arg;
+  xTaskNotify(g_task, OD_EVT_IMU, eSetBits);
+}
+
+static void od_tof_cb(vl53l5cx_sensor_t sensor, void *arg)
+{
+  (void)arg;
+  xTaskNotify(g_task, 1u << sensor, eSetBits);
+}
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/* TODO: Implement obstacle_detection functions */
+/****************************************************************************
+ * Name: obstacle_detection_init
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_init(void)
+{
+  esp_err_t ret;
+
+  if (g_task != NULL)
+    {
+      return ESP_OK;
+    }
+
+  g_fusion.min_signal_kcps = OD_MIN_SIGNAL_KCPS;
+  obstacle_track_init(&g_track_config);
+
+  /* Walking profile until the first activity window is in */
+
+  g_activity.state = OBSTACLE_ACTIVITY_WALK;
+  g_stats.activity = OBSTACLE_ACTIVITY_WALK;
+
+  if (xTaskCreatePinnedToCore(od_task, "obstacle", OD_TASK_STACK_SIZE, NULL,
+                              OD_TASK_PRIORITY, &g_task,
+                              MAIA_CORE_RT) != pdPASS)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+
+  ret = vl53l5cx_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "ToF init failed: %s", esp_err_to_name(ret));
+      vTaskDelete(g_task);
+      g_task = NULL;
+      return ret;
+    }
+
+  vl53l5cx_set_frame_callback(od_tof_cb, NULL);
+
+  /* The IMU is optional: without it frames are not gated */
+
+  ret = mpu6050_init();
+  if (ret == ESP_OK)
+    {
+      od_filter_init(&g_filter, mpu6050_get_odr_hz());
+      mpu6050_set_sample_callback(od_imu_cb, NULL);
+      ret = mpu6050_start();
+    }
+
+  g_imu_ok = (ret == ESP_OK);
+  if (!g_imu_ok)
+    {
+      ESP_LOGW(TAG, "IMU unavailable (%s), ground gating disabled",
+               esp_err_to_name(ret));
+    }
+
+  ret = vl53l5cx_start_ranging();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Start ranging failed: %s", esp_err_to_name(ret));
+
+      /* Detach the callbacks before the task they notify goes away */
+
+      vl53l5cx_set_frame_callback(NULL, NULL);
+      if (g_imu_ok)
+        {
+          mpu6050_stop();
+        }
+
+      mpu6050_set_sample_callback(NULL, NULL);
+      vTaskDelete(g_task);
+      g_task = NULL;
+      return ret;
+    }
+
+  ESP_LOGI(TAG, "Obstacle detection started (IMU %s, %s fusion)",
+           g_imu_ok ? "on" : "off",
+           obstacle_fusion_has_simd() ? "PIE" : "scalar");
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_set_frame_callback
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_set_frame_callback(obstacle_frame_cb_t callback,
+                                                void *arg)
+{
+  portENTER_CRITICAL(&g_lock);
+  g_frame_cb = callback;
+  g_frame_cb_arg = arg;
+  portEXIT_CRITICAL(&g_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_get_frame
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_frame(vl53l5cx_sensor_t sensor,
+                                       obstacle_frame_t *frame)
+{
+  esp_err_t ret = ESP_OK;
+
+  if (sensor >= VL53L5CX_SENSOR_COUNT || frame == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_have_frame & (1u << sensor))
+    {
+      *frame = g_frames[sensor];
+    }
+  else
+    {
+      ret = ESP_ERR_NOT_FOUND;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_get_orientation
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_orientation(obstacle_orientation_t *out)
+{
+  esp_err_t ret = ESP_OK;
+
+  if (out == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_stats.imu_samples == 0)
+    {
+      ret = ESP_ERR_NOT_FOUND;
+    }
+  else
+    {
+      *out = g_orientation;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_get_sectors
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_sectors(obstacle_sectors_t *sectors)
+{
+  esp_err_t ret = ESP_OK;
+
+  if (sectors == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_have_sectors)
+    {
+      *sectors = g_sectors;
+    }
+  else
+    {
+      ret = ESP_ERR_NOT_FOUND;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_get_ttc
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_ttc(obstacle_ttc_t *ttc)
+{
+  esp_err_t ret = ESP_OK;
+
+  if (ttc == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  if (g_have_frame != 0)
+    {
+      *ttc = g_ttc;
+    }
+  else
+    {
+      ret = ESP_ERR_NOT_FOUND;
+    }
+
+  portEXIT_CRITICAL(&g_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_get_stats
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_get_stats(obstacle_detection_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_lock);
+  *stats = g_stats;
+  portEXIT_CRITICAL(&g_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_replay_reset
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_replay_reset(void)
+{
+  if (g_task != NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  memset(&g_fusion, 0, sizeof(g_fusion));
+  g_fusion.min_signal_kcps = OD_MIN_SIGNAL_KCPS;
+  g_fusion_have = 0;
+  obstacle_track_init(&g_track_config);
+
+  portENTER_CRITICAL(&g_lock);
+  g_have_frame = 0;
+  g_have_sectors = false;
+  memset(&g_stats, 0, sizeof(g_stats));
+  g_stats.activity = OBSTACLE_ACTIVITY_WALK;
+  portEXIT_CRITICAL(&g_lock);
+
+  g_replay_ready = true;
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: obstacle_detection_replay_frame
+ ****************************************************************************/
+
+esp_err_t obstacle_detection_replay_frame(const vl53l5cx_frame_t *frame,
+                                          const obstacle_orientation_t *o)
+{
+  if (frame == NULL || frame->sensor >= VL53L5CX_SENSOR_COUNT ||
+      frame->nb_zones > VL53L5CX_NB_ZONES_MAX)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_task != NULL || !g_replay_ready)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  od_load_frame(frame);
+  od_run_frame(o);
+
+  return ESP_OK;
+}
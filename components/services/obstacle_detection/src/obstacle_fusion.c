@@ -0,0 +1,178 @@
+/****************************************************************************
+ * components/services/obstacle_detection/src/obstacle_fusion.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Zone fusion kernel: scalar reference and PIE dispatch. The PIE column
+ * stage (obstacle_fusion_pie.S) produces, per vector lane, the minimum
+ * valid distance and the rejected zone count; lane l holds columns
+ * l % side of the sensor, so folding the 8 lanes into sectors is all
+ * that is left in C.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "obstacle_fusion.h"
+#include "sdkconfig.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define OD_FUSION_LANES         8       /* int16 lanes per 128-bit vector */
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_OBSTACLE_FUSION_PIE
+void od_fusion_lanes_pie(const int16_t *distance, const uint16_t *signal,
+                         int nvec, const int16_t *consts, int16_t *lane_min,
+                         int16_t *lane_rejected);
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: od_fusion_finish
+ *
+ * Description:
+ *   Confidence = valid zones / zones in the sector (0-255).
+ *
+ ****************************************************************************/
+
+static void od_fusion_finish(obstacle_sectors_t *out,
+                             const uint8_t *valid, uint8_t nb_zones)
+{
+  /* Outer sectors have half a frame, the center a full one */
+
+  const uint16_t total[OBSTACLE_SECTOR_COUNT] =
+  {
+    nb_zones / 2, nb_zones, nb_zones / 2,
+  };
+
+  for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+    {
+      out->confidence[s] = (uint8_t)(valid[s] * 255u / total[s]);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obstacle_fusion_reduce_scalar
+ ****************************************************************************/
+
+void obstacle_fusion_reduce_scalar(const obstacle_fusion_input_t *in,
+                                   obstacle_sectors_t *out)
+{
+  int side = in->nb_zones == VL53L5CX_RESOLUTION_8X8 ? 8 : 4;
+  uint8_t valid[OBSTACLE_SECTOR_COUNT] = {0};
+
+  for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+    {
+      out->min_mm[s] = VL53L5CX_DISTANCE_INVALID;
+    }
+
+  for (int sensor = 0; sensor < VL53L5CX_SENSOR_COUNT; sensor++)
+    {
+      const obstacle_zones_t *z = &in->zones[sensor];
+
+      for (int i = 0; i < in->nb_zones; i++)
+        {
+          obstacle_sector_t s = obstacle_fusion_sector(sensor, i % side,
+                                                       side);
+          int16_t mm = z->distance_mm[i];
+
+          if (mm == VL53L5CX_DISTANCE_INVALID ||
+              z->signal_kcps[i] < in->min_signal_kcps)
+            {
+              continue;
+            }
+
+          valid[s]++;
+          if (mm < out->min_mm[s])
+            {
+              out->min_mm[s] = mm;
+            }
+        }
+    }
+
+  od_fusion_finish(out, valid, in->nb_zones);
+}
+
+/****************************************************************************
+ * Name: obstacle_fusion_reduce
+ ****************************************************************************/
+
+void obstacle_fusion_reduce(const obstacle_fusion_input_t *in,
+                            obstacle_sectors_t *out)
+{
+#ifdef CONFIG_MAIA_OBSTACLE_FUSION_PIE
+  int side = in->nb_zones == VL53L5CX_RESOLUTION_8X8 ? 8 : 4;
+  int nvec = in->nb_zones / OD_FUSION_LANES;
+  uint8_t valid[OBSTACLE_SECTOR_COUNT] = {0};
+  int16_t consts[3 * OD_FUSION_LANES]
+    __attribute__((aligned(OBSTACLE_FUSION_ALIGN)));
+  int16_t lane_min[OD_FUSION_LANES]
+    __attribute__((aligned(OBSTACLE_FUSION_ALIGN)));
+  int16_t lane_rejected[OD_FUSION_LANES]
+    __attribute__((aligned(OBSTACLE_FUSION_ALIGN)));
+
+  for (int l = 0; l < OD_FUSION_LANES; l++)
+    {
+      consts[l] = VL53L5CX_DISTANCE_INVALID;
+      consts[OD_FUSION_LANES + l] =
+        (int16_t)(in->min_signal_kcps ^ 0x8000);
+      consts[2 * OD_FUSION_LANES + l] = INT16_MIN;
+    }
+
+  for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+    {
+      out->min_mm[s] = VL53L5CX_DISTANCE_INVALID;
+    }
+
+  for (int sensor = 0; sensor < VL53L5CX_SENSOR_COUNT; sensor++)
+    {
+      od_fusion_lanes_pie(in->zones[sensor].distance_mm,
+                          in->zones[sensor].signal_kcps, nvec, consts,
+                          lane_min, lane_rejected);
+
+      for (int l = 0; l < OD_FUSION_LANES; l++)
+        {
+          obstacle_sector_t s = obstacle_fusion_sector(sensor, l % side,
+                                                       side);
+
+          valid[s] += nvec - lane_rejected[l];
+          if (lane_min[l] < out->min_mm[s])
+            {
+              out->min_mm[s] = lane_min[l];
+            }
+        }
+    }
+
+  od_fusion_finish(out, valid, in->nb_zones);
+#else
+  obstacle_fusion_reduce_scalar(in, out);
+#endif
+}
+
+/****************************************************************************
+ * Name: obstacle_fusion_has_simd
+ ****************************************************************************/
+
+bool obstacle_fusion_has_simd(void)
+{
+#ifdef CONFIG_MAIA_OBSTACLE_FUSION_PIE
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,336 @@
+/****************************************************************************
+ * components/services/obstacle_detection/src/obstacle_track.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Fixed point: distances in mm Q4, speeds in mm/s Q4 (positive when
+ * receding), gains Q15, times in us. The zone rings are indexed by the
+ * sensor frame counter, so one timestamp ring per sensor serves all its
+ * zones.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "obstacle_track.h"
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define OT_Q                    4
+#define OT_MAX_DT_US            500000  /* Longer gaps restart the tracks */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  int32_t x;                    /* Filtered distance (mm, Q4) */
+  int32_t v;                    /* Range rate (mm/s, Q4) */
+  uint16_t ttc_ms;
+  uint8_t misses;               /* Frames since the last used range */
+  bool active;
+} ot_zone_t;
+
+/* One sensor: zone filters and the ring of past frames */
+
+typedef struct
+{
+  ot_zone_t zones[VL53L5CX_NB_ZONES_MAX];
+  int16_t ring[VL53L5CX_NB_ZONES_MAX][OBSTACLE_TRACK_HISTORY];
+  int64_t ring_us[OBSTACLE_TRACK_HISTORY];
+  uint32_t frames;              /* Frames written to the ring */
+  uint8_t nb_zones;
+} ot_sensor_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static obstacle_track_config_t g_config;
+static ot_sensor_t g_sensors[VL53L5CX_SENSOR_COUNT];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ot_reset
+ ****************************************************************************/
+
+static void ot_reset(ot_sensor_t *s, uint8_t nb_zones)
+{
+  memset(s, 0, sizeof(*s));
+  s->nb_zones = nb_zones;
+
+  for (int i = 0; i < VL53L5CX_NB_ZONES_MAX; i++)
+    {
+      s->zones[i].ttc_ms = OBSTACLE_TTC_NONE;
+    }
+}
+
+/****************************************************************************
+ * Name: ot_acquire
+ *
+ * Description:
+ *   Start a track on the newest range of a zone. The initial speed comes
+ *   from the oldest ring entry still consistent with it (each step within
+ *   the gate), 0 if there is none.
+ *
+ ****************************************************************************/
+
+static void ot_acquire(const ot_sensor_t *s, int zone, ot_zone_t *t)
+{
+  uint32_t newest = s->frames - 1;
+  uint32_t depth = s->frames < OBSTACLE_TRACK_HISTORY ?
+                   s->frames : OBSTACLE_TRACK_HISTORY;
+  const int16_t *ring = s->ring[zone];
+  int16_t z = ring[newest % OBSTACLE_TRACK_HISTORY];
+  uint32_t oldest = newest;
+
+  for (uint32_t k = 1; k < depth; k++)
+    {
+      int16_t prev = ring[(newest - k) % OBSTACLE_TRACK_HISTORY];
+      int16_t next = ring[(newest - k + 1) % OBSTACLE_TRACK_HISTORY];
+
+      if (prev == VL53L5CX_DISTANCE_INVALID ||
+          abs(next - prev) > g_config.gate_mm)
+        {
+          break;
+        }
+
+      oldest = newest - k;
+    }
+
+  t->x = (int32_t)z << OT_Q;
+  t->v = 0;
+  if (oldest != newest)
+    {
+      int64_t span = s->ring_us[newest % OBSTACLE_TRACK_HISTORY] -
+                     s->ring_us[oldest % OBSTACLE_TRACK_HISTORY];
+      int32_t d = z - ring[oldest % OBSTACLE_TRACK_HISTORY];
+
+      if (span > 0)
+        {
+          t->v = (int32_t)(((int64_t)d << OT_Q) * 1000000 / span);
+        }
+    }
+
+  t->misses = 0;
+  t->active = true;
+}
+
+/****************************************************************************
+ * Name: ot_confirmed
+ *
+ * Description:
+ *   true if the two newest ranges of a zone agree (a new target rather
+ *   than a spike).
+ *
+ ****************************************************************************/
+
+static bool ot_confirmed(const ot_sensor_t *s, int zone)
+{
+  const int16_t *ring = s->ring[zone];
+  int16_t a = ring[(s->frames - 1) % OBSTACLE_TRACK_HISTORY];
+  int16_t b = ring[(s->frames - 2) % OBSTACLE_TRACK_HISTORY];
+
+  return s->frames >= 2 && b != VL53L5CX_DISTANCE_INVALID &&
+         abs(a - b) <= g_config.gate_mm;
+}
+
+/****************************************************************************
+ * Name: ot_ttc
+ *
+ * Description:
+ *   Time to collision of a track (ms), OBSTACLE_TTC_NONE unless it closes
+ *   in faster than the minimum.
+ *
+ ****************************************************************************/
+
+static uint16_t ot_ttc(const ot_zone_t *t)
+{
+  int32_t closing = -t->v;
+  int64_t ttc;
+
+  if (!t->active || t->x <= 0 ||
+      closing < ((int32_t)g_config.min_closing_mm_s << OT_Q))
+    {
+      return OBSTACLE_TTC_NONE;
+    }
+
+  ttc = (int64_t)t->x * 1000 / closing;
+
+  return ttc >= OBSTACLE_TTC_NONE ? OBSTACLE_TTC_NONE - 1 : (uint16_t)ttc;
+}
+
+/****************************************************************************
+ * Name: ot_zone_update
+ *
+ * Description:
+ *   One alpha-beta step. The new range is already in the ring.
+ *
+ ****************************************************************************/
+
+static void ot_zone_update(const ot_sensor_t *s, int zone, ot_zone_t *t,
+                           int16_t z, int32_t dt_us)
+{
+  int32_t xp;
+  int32_t r;
+
+  if (!t->active)
+    {
+      if (z != VL53L5CX_DISTANCE_INVALID)
+        {
+          ot_acquire(s, zone, t);
+        }
+
+      t->ttc_ms = ot_ttc(t);
+      return;
+    }
+
+  xp = t->x + (int32_t)((int64_t)t->v * dt_us / 1000000);
+  r = ((int32_t)z << OT_Q) - xp;
+
+  if (z == VL53L5CX_DISTANCE_INVALID || abs(r) > (g_config.gate_mm << OT_Q))
+    {
+      if (z != VL53L5CX_DISTANCE_INVALID && ot_confirmed(s, zone))
+        {
+          ot_acquire(s, zone, t);
+        }
+      else if (++t->misses > g_config.max_coast)
+        {
+          t->active = false;
+        }
+      else
+        {
+          t->x = xp;
+        }
+
+      t->ttc_ms = ot_ttc(t);
+      return;
+    }
+
+  t->x = xp + (int32_t)(((int64_t)r * g_config.alpha_q15) >> 15);
+  if (dt_us > 0)
+    {
+      t->v += (int32_t)((((int64_t)r * g_config.beta_q15) >> 15) *
+                        1000000 / dt_us);
+    }
+
+  t->misses = 0;
+  t->ttc_ms = ot_ttc(t);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: obstacle_track_init
+ ****************************************************************************/
+
+void obstacle_track_init(const obstacle_track_config_t *config)
+{
+  g_config = *config;
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      ot_reset(&g_sensors[i], 0);
+    }
+}
+
+/****************************************************************************
+ * Name: obstacle_track_update
+ ****************************************************************************/
+
+void obstacle_track_update(vl53l5cx_sensor_t sensor,
+                           const int16_t *distance_mm, uint8_t nb_zones,
+                           int64_t time_us, uint16_t *ttc_ms)
+{
+  ot_sensor_t *s = &g_sensors[sensor];
+  int64_t dt = 0;
+  uint32_t slot;
+
+  if (s->frames > 0)
+    {
+      dt = time_us - s->ring_us[(s->frames - 1) % OBSTACLE_TRACK_HISTORY];
+    }
+
+  if (nb_zones != s->nb_zones || dt < 0 || dt > OT_MAX_DT_US)
+    {
+      ot_reset(s, nb_zones);
+      dt = 0;
+    }
+  else if (s->frames > 0 && dt == 0)
+    {
+      /* Same timestamp as the previous frame (replayed trace, same-tick
+       * frames): no time has passed, keep the tracks as they are
+       */
+
+      for (int i = 0; i < nb_zones; i++)
+        {
+          ttc_ms[i] = s->zones[i].ttc_ms;
+        }
+
+      return;
+    }
+
+  slot = s->frames++ % OBSTACLE_TRACK_HISTORY;
+  s->ring_us[slot] = time_us;
+
+  for (int i = 0; i < nb_zones; i++)
+    {
+      s->ring[i][slot] = distance_mm[i];
+      ot_zone_update(s, i, &s->zones[i], distance_mm[i], (int32_t)dt);
+      ttc_ms[i] = s->zones[i].ttc_ms;
+    }
+}
+
+/****************************************************************************
+ * Name: obstacle_track_sectors
+ ****************************************************************************/
+
+void obstacle_track_sectors(obstacle_ttc_t *out)
+{
+  const ot_zone_t *best[OBSTACLE_SECTOR_COUNT] = { NULL };
+
+  for (int sensor = 0; sensor < VL53L5CX_SENSOR_COUNT; sensor++)
+    {
+      const ot_sensor_t *s = &g_sensors[sensor];
+      int side = s->nb_zones == VL53L5CX_RESOLUTION_8X8 ? 8 : 4;
+
+      for (int i = 0; i < s->nb_zones; i++)
+        {
+          const ot_zone_t *t = &s->zones[i];
+          obstacle_sector_t sec = obstacle_fusion_sector(sensor, i % side,
+                                                         side);
+          const ot_zone_t *b = best[sec];
+
+          /* Lowest TTC, then nearest */
+
+          if (t->active &&
+              (b == NULL || t->ttc_ms < b->ttc_ms ||
+               (t->ttc_ms == b->ttc_ms && t->x < b->x)))
+            {
+              best[sec] = t;
+            }
+        }
+    }
+
+  for (int sec = 0; sec < OBSTACLE_SECTOR_COUNT; sec++)
+    {
+      const ot_zone_t *b = best[sec];
+
+      out->ttc_ms[sec] = b ? b->ttc_ms : OBSTACLE_TTC_NONE;
+      out->closing_mm_s[sec] = b ? (int16_t)(-b->v >> OT_Q) : 0;
+      out->distance_mm[sec] = b ? (int16_t)(b->x >> OT_Q) :
+                                  VL53L5CX_DISTANCE_INVALID;
+    }
+}
@@ -3,6 +3,18 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Dynamic frequency scaling and automatic light sleep (esp_pm). The CPU
+ * runs at CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ while a task runs and drops
+ * to CONFIG_MAIA_PM_MIN_FREQ_MHZ when idle; with nothing due for a few
+ * ticks the chip enters light sleep until the next timeout or a wake
+ * pin (the ToF INT pins and, optionally, the IMU INT pin). The board
+ * busy lock (I2C transfers, motor drive) keeps it awake.
+ *
+ * Time is accounted in three states: light sleep, busy (busy lock held,
+ * APB at 80 MHz) and awake otherwise. The charge estimate weighs them
+ * with the per-state currents of the "Power Management" menu, measured
+ * with the power test mode.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_SERVICES_POWER_MANAGER_INCLUDE_POWER_MANAGER_H
@@ -14,11 +26,48 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <esp_err.h>
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Power state counters since power_manager_init() */
+
+typedef struct
+{
+  uint32_t sleeps;          /* Light sleeps */
+  uint32_t gpio_wakes;      /* Ended by a wake pin */
+  uint64_t sleep_us;        /* Light sleep */
+  uint64_t busy_us;         /* Busy lock held */
+  uint64_t awake_us;        /* Awake otherwise */
+  uint64_t charge_uc;       /* Estimated charge (uA x s) */
+  bool light_sleep;         /* Light sleep enabled */
+} power_manager_stats_t;
 
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
-/* TODO: Define power_manager interface */
+/****************************************************************************
+ * Name: power_manager_init
+ *
+ * Description:
+ *   Configure frequency scaling and light sleep and arm the wake pins.
+ *   Call after maia_board_init().
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NOT_SUPPORTED if power management is
+ *   disabled (CONFIG_MAIA_PM_ENABLE); esp_pm error otherwise.
+ *
+ ****************************************************************************/
+
+esp_err_t power_manager_init(void);
+
+/****************************************************************************
+ * Name: power_manager_get_stats
+ ****************************************************************************/
+
+esp_err_t power_manager_get_stats(power_manager_stats_t *stats);
 
 #endif /* __COMPONENTS_SERVICES_POWER_MANAGER_INCLUDE_POWER_MANAGER_H */
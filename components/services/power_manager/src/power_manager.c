@@ -10,9 +10,171 @@
  ****************************************************************************/
 
 #include "power_manager.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <string.h>
+
+#ifdef CONFIG_MAIA_PM_ENABLE
+#  include <esp_pm.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[POWER]"
+
+#define PM_MAX_FREQ_MHZ         CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+
+#ifdef CONFIG_MAIA_PM_LIGHT_SLEEP
+#  define PM_LIGHT_SLEEP        true
+#else
+#  define PM_LIGHT_SLEEP        false
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static bool g_running = false;
+static bool g_light_sleep = false;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_PM_LIGHT_SLEEP
+
+/****************************************************************************
+ * Name: pm_arm_wake_pins
+ *
+ * Description:
+ *   Wake sources: ToF data ready (falling edge) and optionally IMU
+ *   DATA_RDY (rising edge), as configured by maia_gpio_init().
+ *
+ ****************************************************************************/
+
+static esp_err_t pm_arm_wake_pins(void)
+{
+  esp_err_t ret = ESP_OK;
+
+#ifdef CONFIG_MAIA_VL53L5CX_ENABLE
+  ret = maia_pm_wake_enable(MAIA_GPIO_TOF1_INT, 0);
+  if (ret == ESP_OK)
+    {
+      ret = maia_pm_wake_enable(MAIA_GPIO_TOF2_INT, 0);
+    }
+#endif
+
+#ifdef CONFIG_MAIA_PM_WAKE_IMU
+  if (ret == ESP_OK)
+    {
+      ret = maia_pm_wake_enable(MAIA_GPIO_IMU_INT, 1);
+    }
+#endif
+
+  return ret;
+}
+
+#endif /* CONFIG_MAIA_PM_LIGHT_SLEEP */
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/* TODO: Implement power_manager functions */
+/****************************************************************************
+ * Name: power_manager_init
+ ****************************************************************************/
+
+esp_err_t power_manager_init(void)
+{
+#ifdef CONFIG_MAIA_PM_ENABLE
+  esp_err_t ret;
+  bool light_sleep = PM_LIGHT_SLEEP;
+
+  if (g_running)
+    {
+      return ESP_OK;
+    }
+
+#ifdef CONFIG_MAIA_PM_LIGHT_SLEEP
+
+  /* Pins first: a sleep entered before they are armed would only end
+   * at the next timeout
+   */
+
+  ret = pm_arm_wake_pins();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Wake pins unavailable (%s), light sleep disabled",
+               esp_err_to_name(ret));
+      light_sleep = false;
+    }
+#endif
+
+  esp_pm_config_t cfg = {
+      .max_freq_mhz = PM_MAX_FREQ_MHZ,
+      .min_freq_mhz = CONFIG_MAIA_PM_MIN_FREQ_MHZ,
+      .light_sleep_enable = light_sleep,
+  };
+
+  ret = esp_pm_configure(&cfg);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(ret));
+      return ret;
+    }
+
+  g_light_sleep = light_sleep;
+  g_running = true;
+
+  ESP_LOGI(TAG, "CPU %d-%d MHz, light sleep %s",
+           CONFIG_MAIA_PM_MIN_FREQ_MHZ, PM_MAX_FREQ_MHZ,
+           light_sleep ? "on" : "off");
+
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/****************************************************************************
+ * Name: power_manager_get_stats
+ ****************************************************************************/
+
+esp_err_t power_manager_get_stats(power_manager_stats_t *stats)
+{
+  maia_pm_stats_t pm;
+  uint64_t awake;
+
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (!g_running)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  maia_pm_get_stats(&pm);
+
+  awake = pm.sleep_us + pm.busy_us;
+  awake = pm.uptime_us > awake ? pm.uptime_us - awake : 0;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->sleeps = pm.sleeps;
+  stats->gpio_wakes = pm.gpio_wakes;
+  stats->sleep_us = pm.sleep_us;
+  stats->busy_us = pm.busy_us;
+  stats->awake_us = awake;
+  stats->light_sleep = g_light_sleep;
+
+#ifdef CONFIG_MAIA_PM_ENABLE
+  stats->charge_uc = (pm.sleep_us * CONFIG_MAIA_PM_CURRENT_SLEEP_UA +
+                      pm.busy_us * CONFIG_MAIA_PM_CURRENT_BUSY_UA +
+                      awake * CONFIG_MAIA_PM_CURRENT_AWAKE_UA) / 1000000;
+#endif
+
+  return ESP_OK;
+}
@@ -3,6 +3,11 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * Service health report: rates and latencies derived from the service
+ * counters between two reports, and a health snapshot (CPU and stack
+ * per task, heap, bus and sensor error counters) sampled at each report
+ * for the display and the session log.
+ *
  ****************************************************************************/
 
 #ifndef __COMPONENTS_SERVICES_STATUS_MONITOR_INCLUDE_STATUS_MONITOR_H
@@ -15,10 +20,122 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Tasks in the health snapshot: the default build runs about 35 (app,
+ * services, drivers, IDF, NimBLE, WiFi). uxTaskGetSystemState() reports
+ * nothing at all when the array is too short, so keep it well above.
+ */
+
+#define STATUS_MONITOR_MAX_TASKS      48
+#define STATUS_MONITOR_MAX_I2C        8     /* MAIA_I2C_MAX_DEVICES */
+#define STATUS_MONITOR_NAME_LEN       12
+
+/* CPU share unknown (run time stats disabled) */
+
+#define STATUS_MONITOR_CPU_UNKNOWN    UINT8_MAX
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Data logger over the last report period */
+
+typedef struct
+{
+  uint32_t records_per_s;
+  uint32_t bytes_per_s;             /* Records accepted */
+  uint32_t flash_bytes_per_s;       /* Sectors written */
+  uint32_t dropped;                 /* Records refused in the period */
+  uint32_t flush_avg_us;            /* Per sector, over the period */
+  uint32_t flush_max_us;            /* Since boot */
+  uint8_t tof_size_pct;             /* Logged / raw ToF size, over the
+                                     * period */
+  uint32_t codec_max_us;            /* Worst ToF frame encode (boot) */
+  uint8_t staged;                   /* Pages waiting for the flash */
+} status_monitor_logger_t;
+
+/* One task in the health snapshot */
+
+typedef struct
+{
+  char name[STATUS_MONITOR_NAME_LEN];
+  uint16_t stack_free;              /* Headroom low-water mark, bytes */
+  uint8_t cpu_pct;                  /* Share of one core, over the
+                                     * period */
+} status_monitor_task_t;
+
+/* One I2C device in the health snapshot (totals since boot) */
+
+typedef struct
+{
+  char name[STATUS_MONITOR_NAME_LEN];
+  uint16_t addr;
+  uint32_t errors;
+  uint32_t timeouts;
+} status_monitor_i2c_t;
+
+/* Health snapshot, refreshed at every report. Counters are totals since
+ * boot, so two snapshots give the rates.
+ */
+
+typedef struct
+{
+  uint32_t sequence;                /* Snapshots taken */
+  uint32_t uptime_s;
+  uint32_t heap_free;
+  uint32_t heap_min;                /* Lowest free heap since boot */
+  uint8_t cpu_pct[2];               /* Load per core, over the period */
+  uint8_t nb_tasks;
+  bool tasks_truncated;             /* More tasks than MAX_TASKS: tasks[]
+                                     * and cpu_pct[] left empty */
+  uint8_t nb_i2c;
+  status_monitor_task_t tasks[STATUS_MONITOR_MAX_TASKS];
+  status_monitor_i2c_t i2c[STATUS_MONITOR_MAX_I2C];
+  uint32_t onewire_crc_errors;
+  uint32_t tof_dropped;             /* Frames skipped (consumer busy) */
+  uint32_t tof_i2c_errors;          /* Frame reads failed */
+  uint32_t imu_dropped;             /* Samples lost (ring full) */
+  uint32_t imu_overflows;           /* FIFO overflows */
+  uint32_t log_dropped;             /* Records refused */
+} status_monitor_health_t;
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
-/* TODO: Define status_monitor interface */
+/****************************************************************************
+ * Name: status_monitor_report
+ *
+ * Description:
+ *   Log the service rates since the previous call. Call periodically
+ *   from a single task (e.g. task_monitor).
+ *
+ ****************************************************************************/
+
+void status_monitor_report(void);
+
+/****************************************************************************
+ * Name: status_monitor_get_logger
+ *
+ * Description:
+ *   Data logger figures of the last report.
+ *
+ ****************************************************************************/
+
+void status_monitor_get_logger(status_monitor_logger_t *out);
+
+/****************************************************************************
+ * Name: status_monitor_get_health
+ *
+ * Description:
+ *   Copy the health snapshot of the last report (sequence 0 before the
+ *   first one).
+ *
+ ****************************************************************************/
+
+void status_monitor_get_health(status_monitor_health_t *out);
 
 #endif /* __COMPONENTS_SERVICES_STATUS_MONITOR_INCLUDE_STATUS_MONITOR_H */
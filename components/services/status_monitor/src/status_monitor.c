@@ -3,6 +3,11 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
+ * The health snapshot only reads counters the subsystems keep anyway
+ * (driver stats, I2C accounting, heap, FreeRTOS run time): nothing is
+ * added to their hot paths. CPU shares need FreeRTOS run time stats and
+ * the task list needs the trace facility (sdkconfig.defaults).
+ *
  ****************************************************************************/
 
 /****************************************************************************
@@ -10,9 +15,508 @@
  ****************************************************************************/
 
 #include "status_monitor.h"
+#include "data_logger.h"
+#include "data_sync.h"
+#include "power_manager.h"
+#include "maia_board.h"
+#include "ds18b20.h"
+#include "mpu6050.h"
+#include "vl53l5cx.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[STATUS]"
+
+#define SM_CPU_MHZ              CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) && \
+    defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+#  define SM_RUN_TIME           1
+#endif
+
+_Static_assert(STATUS_MONITOR_MAX_I2C >= MAIA_I2C_MAX_DEVICES,
+               "health snapshot must hold every I2C device");
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Reporting task only */
+
+static data_logger_stats_t g_prev_logger;
+static power_manager_stats_t g_prev_power;
+static int64_t g_prev_us = 0;
+static status_monitor_health_t g_health_work;
+static maia_i2c_dev_stats_t g_i2c_work[MAIA_I2C_MAX_DEVICES];
+
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+static TaskStatus_t g_task_work[STATUS_MONITOR_MAX_TASKS];
+#endif
+
+#ifdef SM_RUN_TIME
+static struct
+{
+  TaskHandle_t handle;
+  configRUN_TIME_COUNTER_TYPE run_time;
+} g_prev_tasks[STATUS_MONITOR_MAX_TASKS];
+static UBaseType_t g_prev_nb_tasks = 0;
+static configRUN_TIME_COUNTER_TYPE g_prev_total = 0;
+#endif
+
+/* Last report */
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static status_monitor_logger_t g_logger;
+static status_monitor_health_t g_health;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sm_rate
+ *
+ * Description:
+ *   Per-second rate of a counter increment over dt_us.
+ *
+ ****************************************************************************/
+
+static uint32_t sm_rate(uint32_t delta, int64_t dt_us)
+{
+  return dt_us > 0 ? (uint32_t)((uint64_t)delta * 1000000 / dt_us) : 0;
+}
+
+/****************************************************************************
+ * Name: sm_logger
+ ****************************************************************************/
+
+static void sm_logger(int64_t dt_us)
+{
+  data_logger_stats_t st;
+  status_monitor_logger_t out;
+  uint32_t pages;
+  uint32_t raw;
+
+  if (data_logger_get_stats(&st) != ESP_OK)
+    {
+      return;
+    }
+
+  pages = st.pages - g_prev_logger.pages;
+  raw = st.tof_raw_bytes - g_prev_logger.tof_raw_bytes;
+
+  out.records_per_s = sm_rate(st.records - g_prev_logger.records, dt_us);
+  out.bytes_per_s = sm_rate(st.record_bytes - g_prev_logger.record_bytes,
+                            dt_us);
+  out.flash_bytes_per_s = sm_rate(pages * DATA_LOGGER_PAGE_SIZE, dt_us);
+  out.dropped = st.dropped - g_prev_logger.dropped;
+  out.flush_avg_us = pages > 0 ?
+    (uint32_t)((st.flush_total_us - g_prev_logger.flush_total_us) / pages) :
+    0;
+  out.flush_max_us = st.flush_max_us;
+  out.staged = st.staged;
+  out.tof_size_pct = raw > 0 ?
+    (uint8_t)((uint64_t)(st.tof_bytes - g_prev_logger.tof_bytes) * 100 /
+              raw) : 0;
+  out.codec_max_us = st.codec_max_cycles / SM_CPU_MHZ;
+
+  g_prev_logger = st;
+
+  portENTER_CRITICAL(&g_lock);
+  g_logger = out;
+  portEXIT_CRITICAL(&g_lock);
+
+  ESP_LOGI(TAG, "Logger: %lu rec/s, %lu B/s staged, %lu B/s to flash, "
+           "%lu dropped, %u pages waiting",
+           (unsigned long)out.records_per_s, (unsigned long)out.bytes_per_s,
+           (unsigned long)out.flash_bytes_per_s,
+           (unsigned long)out.dropped, out.staged);
+  ESP_LOGI(TAG, "Logger: sector flush avg %lu us, max %lu us, "
+           "%lu flash errors",
+           (unsigned long)out.flush_avg_us, (unsigned long)out.flush_max_us,
+           (unsigned long)st.flash_errors);
+  ESP_LOGI(TAG, "Logger: ToF frames at %u%% of raw size, encode max %lu us",
+           out.tof_size_pct, (unsigned long)out.codec_max_us);
+}
+
+/****************************************************************************
+ * Name: sm_sync
+ ****************************************************************************/
+
+static void sm_sync(void)
+{
+  data_sync_stats_t st;
+
+  if (data_sync_get_stats(&st) != ESP_OK)
+    {
+      return;
+    }
+
+  ESP_LOGI(TAG, "Sync: %lu sessions (%lu failed), %lu KB sent, "
+           "%lu pages waiting, %lu lost",
+           (unsigned long)st.syncs, (unsigned long)st.failures,
+           (unsigned long)(st.bytes / 1024), (unsigned long)st.backlog,
+           (unsigned long)st.lost_pages);
+  ESP_LOGI(TAG, "Sync: radio on %lu ms last session, %lu s total",
+           (unsigned long)st.radio_last_ms,
+           (unsigned long)(st.radio_total_ms / 1000));
+}
+
+/****************************************************************************
+ * Name: sm_power
+ *
+ * Description:
+ *   State shares and mean current over the period.
+ *
+ ****************************************************************************/
+
+static void sm_power(int64_t dt_us)
+{
+  power_manager_stats_t st;
+  uint64_t sleep_us;
+  uint64_t busy_us;
+  uint64_t charge;
+
+  if (power_manager_get_stats(&st) != ESP_OK || dt_us <= 0)
+    {
+      return;
+    }
+
+  sleep_us = st.sleep_us - g_prev_power.sleep_us;
+  busy_us = st.busy_us - g_prev_power.busy_us;
+  charge = st.charge_uc - g_prev_power.charge_uc;
+
+  ESP_LOGI(TAG, "Power: sleep %lu%%, busy %lu%%, %lu sleeps (%lu GPIO "
+           "wakes), ~%lu uA",
+           (unsigned long)(sleep_us * 100 / dt_us),
+           (unsigned long)(busy_us * 100 / dt_us),
+           (unsigned long)(st.sleeps - g_prev_power.sleeps),
+           (unsigned long)(st.gpio_wakes - g_prev_power.gpio_wakes),
+           (unsigned long)(charge * 1000000 / dt_us));
+
+  g_prev_power = st;
+}
+
+/****************************************************************************
+ * Name: sm_name
+ ****************************************************************************/
+
+static void sm_name(char *dst, const char *src)
+{
+  strncpy(dst, src != NULL ? src : "?", STATUS_MONITOR_NAME_LEN - 1);
+  dst[STATUS_MONITOR_NAME_LEN - 1] = '\0';
+}
+
+#ifdef SM_RUN_TIME
+
+/****************************************************************************
+ * Name: sm_share
+ *
+ * Description:
+ *   Share of one core a task got since the previous snapshot, from its
+ *   run time counter.
+ *
+ ****************************************************************************/
+
+static uint8_t sm_share(TaskHandle_t handle,
+                        configRUN_TIME_COUNTER_TYPE run_time,
+                        configRUN_TIME_COUNTER_TYPE total)
+{
+  configRUN_TIME_COUNTER_TYPE delta = run_time;
+  uint32_t pct;
+
+  if (total == 0)
+    {
+      return STATUS_MONITOR_CPU_UNKNOWN;
+    }
+
+  for (UBaseType_t i = 0; i < g_prev_nb_tasks; i++)
+    {
+      if (g_prev_tasks[i].handle == handle)
+        {
+          delta = run_time - g_prev_tasks[i].run_time;
+          break;
+        }
+    }
+
+  pct = (uint32_t)((uint64_t)delta * 100 / total);
+  return pct > 100 ? 100 : (uint8_t)pct;
+}
+
+#endif /* SM_RUN_TIME */
+
+/****************************************************************************
+ * Name: sm_health_tasks
+ *
+ * Description:
+ *   Stack headroom and CPU share of every task, load of each core.
+ *
+ ****************************************************************************/
+
+static void sm_health_tasks(status_monitor_health_t *h)
+{
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+  configRUN_TIME_COUNTER_TYPE total = 0;
+  UBaseType_t count = uxTaskGetNumberOfTasks();
+  UBaseType_t n = 0;
+
+  /* An array too short gives 0 entries, not a partial list; a task
+   * created between the two calls has the same effect
+   */
+
+  if (count <= STATUS_MONITOR_MAX_TASKS)
+    {
+      n = uxTaskGetSystemState(g_task_work, STATUS_MONITOR_MAX_TASKS,
+                               &total);
+    }
+
+  h->tasks_truncated = n == 0;
+  if (h->tasks_truncated)
+    {
+      ESP_LOGW(TAG, "%u tasks, health snapshot holds %d: task list "
+               "skipped", (unsigned)count, STATUS_MONITOR_MAX_TASKS);
+    }
+
+  h->nb_tasks = (uint8_t)n;
+  h->cpu_pct[0] = STATUS_MONITOR_CPU_UNKNOWN;
+  h->cpu_pct[1] = STATUS_MONITOR_CPU_UNKNOWN;
+
+  for (UBaseType_t i = 0; i < n; i++)
+    {
+      const TaskStatus_t *t = &g_task_work[i];
+      status_monitor_task_t *o = &h->tasks[i];
+
+      sm_name(o->name, t->pcTaskName);
+      o->stack_free = t->usStackHighWaterMark > UINT16_MAX ?
+                      UINT16_MAX : (uint16_t)t->usStackHighWaterMark;
+      o->cpu_pct = STATUS_MONITOR_CPU_UNKNOWN;
+
+#ifdef SM_RUN_TIME
+      o->cpu_pct = sm_share(t->xHandle, t->ulRunTimeCounter,
+                            total - g_prev_total);
+
+      for (int c = 0; c < portNUM_PROCESSORS && c < 2; c++)
+        {
+          if (t->xHandle == xTaskGetIdleTaskHandleForCore(c) &&
+              o->cpu_pct != STATUS_MONITOR_CPU_UNKNOWN)
+            {
+              h->cpu_pct[c] = 100 - o->cpu_pct;
+            }
+        }
+#endif
+    }
+
+#ifdef SM_RUN_TIME
+  for (UBaseType_t i = 0; i < n; i++)
+    {
+      g_prev_tasks[i].handle = g_task_work[i].xHandle;
+      g_prev_tasks[i].run_time = g_task_work[i].ulRunTimeCounter;
+    }
+
+  g_prev_nb_tasks = n;
+  g_prev_total = total;
+#endif
+#else
+  h->nb_tasks = 0;
+  h->tasks_truncated = false;
+  h->cpu_pct[0] = STATUS_MONITOR_CPU_UNKNOWN;
+  h->cpu_pct[1] = STATUS_MONITOR_CPU_UNKNOWN;
+#endif
+}
+
+/****************************************************************************
+ * Name: sm_health_counters
+ *
+ * Description:
+ *   Bus, sensor and logger error counters (totals since boot).
+ *
+ ****************************************************************************/
+
+static void sm_health_counters(status_monitor_health_t *h)
+{
+  data_logger_stats_t log;
+  mpu6050_stats_t imu;
+  size_t n;
+
+  n = maia_i2c_get_all_stats(g_i2c_work, MAIA_I2C_MAX_DEVICES);
+  h->nb_i2c = (uint8_t)n;
+
+  for (size_t i = 0; i < n; i++)
+    {
+      sm_name(h->i2c[i].name, g_i2c_work[i].name);
+      h->i2c[i].addr = g_i2c_work[i].addr;
+      h->i2c[i].errors = g_i2c_work[i].stats.errors;
+      h->i2c[i].timeouts = g_i2c_work[i].stats.timeouts;
+    }
+
+  h->onewire_crc_errors = ds18b20_get_crc_errors();
+
+  h->tof_dropped = 0;
+  h->tof_i2c_errors = 0;
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      vl53l5cx_stats_t tof;
+
+      if (vl53l5cx_get_stats(i, &tof) == ESP_OK)
+        {
+          h->tof_dropped += tof.dropped;
+          h->tof_i2c_errors += tof.i2c_errors;
+        }
+    }
+
+  memset(&imu, 0, sizeof(imu));
+  mpu6050_get_stats(&imu);
+  h->imu_dropped = imu.dropped;
+  h->imu_overflows = imu.fifo_overflows;
+
+  h->log_dropped = data_logger_get_stats(&log) == ESP_OK ? log.dropped : 0;
+}
+
+/****************************************************************************
+ * Name: sm_health_record
+ *
+ * Description:
+ *   Summary of a snapshot into the session log (uploaded with it).
+ *
+ ****************************************************************************/
+
+static void sm_health_record(const status_monitor_health_t *h,
+                             int64_t now_us)
+{
+  data_logger_health_t rec;
+
+  memset(&rec, 0, sizeof(rec));
+  rec.heap_free = h->heap_free;
+  rec.heap_min = h->heap_min;
+  rec.cpu_pct[0] = h->cpu_pct[0];
+  rec.cpu_pct[1] = h->cpu_pct[1];
+  rec.stack_min = UINT16_MAX;
+  rec.onewire_crc_errors = h->onewire_crc_errors;
+  rec.tof_dropped = h->tof_dropped + h->tof_i2c_errors;
+  rec.imu_dropped = h->imu_dropped + h->imu_overflows;
+  rec.log_dropped = h->log_dropped;
+
+  for (int i = 0; i < h->nb_tasks; i++)
+    {
+      if (h->tasks[i].stack_free < rec.stack_min)
+        {
+          rec.stack_min = h->tasks[i].stack_free;
+        }
+    }
+
+  for (int i = 0; i < h->nb_i2c; i++)
+    {
+      rec.i2c_errors += h->i2c[i].errors;
+      rec.i2c_timeouts += h->i2c[i].timeouts;
+    }
+
+  data_logger_write(DATA_LOGGER_REC_HEALTH, now_us, &rec, sizeof(rec));
+}
+
+/****************************************************************************
+ * Name: sm_health
+ *
+ * Description:
+ *   Take, publish and log the health snapshot. Per-task lines size the
+ *   Task Layout stacks; I2C devices are listed only with errors.
+ *
+ ****************************************************************************/
+
+static void sm_health(int64_t now_us)
+{
+  status_monitor_health_t *h = &g_health_work;
+
+  h->sequence++;
+  h->uptime_s = (uint32_t)(now_us / 1000000);
+  h->heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+  h->heap_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+
+  sm_health_tasks(h);
+  sm_health_counters(h);
+
+  portENTER_CRITICAL(&g_lock);
+  g_health = *h;
+  portEXIT_CRITICAL(&g_lock);
+
+  sm_health_record(h, now_us);
+
+  ESP_LOGI(TAG, "Health: heap %lu free, %lu minimum, CPU %u%% / %u%%",
+           (unsigned long)h->heap_free, (unsigned long)h->heap_min,
+           h->cpu_pct[0], h->cpu_pct[1]);
+
+  for (int i = 0; i < h->nb_tasks; i++)
+    {
+      ESP_LOGI(TAG, "  %-12s cpu %3u%%  stack headroom %u bytes",
+               h->tasks[i].name, h->tasks[i].cpu_pct,
+               h->tasks[i].stack_free);
+    }
+
+  for (int i = 0; i < h->nb_i2c; i++)
+    {
+      if (h->i2c[i].errors != 0 || h->i2c[i].timeouts != 0)
+        {
+          ESP_LOGW(TAG, "  I2C %-8s 0x%02X: %lu errors, %lu timeouts",
+                   h->i2c[i].name, h->i2c[i].addr,
+                   (unsigned long)h->i2c[i].errors,
+                   (unsigned long)h->i2c[i].timeouts);
+        }
+    }
+
+  ESP_LOGI(TAG, "Health: OneWire CRC %lu, ToF dropped %lu / I2C %lu, "
+           "IMU dropped %lu / overflows %lu, log dropped %lu",
+           (unsigned long)h->onewire_crc_errors,
+           (unsigned long)h->tof_dropped, (unsigned long)h->tof_i2c_errors,
+           (unsigned long)h->imu_dropped, (unsigned long)h->imu_overflows,
+           (unsigned long)h->log_dropped);
+}
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/* TODO: Implement status_monitor functions */
+/****************************************************************************
+ * Name: status_monitor_report
+ ****************************************************************************/
+
+void status_monitor_report(void)
+{
+  int64_t now = esp_timer_get_time();
+  int64_t dt = g_prev_us > 0 ? now - g_prev_us : now;
+
+  g_prev_us = now;
+
+  sm_health(now);
+  sm_logger(dt);
+  sm_sync();
+  sm_power(dt);
+}
+
+/****************************************************************************
+ * Name: status_monitor_get_logger
+ ****************************************************************************/
+
+void status_monitor_get_logger(status_monitor_logger_t *out)
+{
+  portENTER_CRITICAL(&g_lock);
+  *out = g_logger;
+  portEXIT_CRITICAL(&g_lock);
+}
+
+/****************************************************************************
+ * Name: status_monitor_get_health
+ ****************************************************************************/
+
+void status_monitor_get_health(status_monitor_health_t *out)
+{
+  portENTER_CRITICAL(&g_lock);
+  *out = g_health;
+  portEXIT_CRITICAL(&g_lock);
+}
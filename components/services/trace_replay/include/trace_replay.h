@@ -0,0 +1,140 @@
+/****************************************************************************
+ * components/services/trace_replay/include/trace_replay.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Trace replay: feeds the ToF frames and head orientations recorded by
+ * data_logger back through obstacle detection and the haptic threat
+ * mapping, in the caller's task, and reports the haptic decision of
+ * every frame together with the cost of each stage.
+ *
+ * A run is deterministic: the same log gives the same decision stream
+ * and digest, so a change to the fusion, tracking or haptic code can be
+ * checked against a recorded session for identical decisions while its
+ * timing is compared. Recorded times have millisecond resolution, so
+ * TTCs can differ slightly from the live run that logged them; signal
+ * levels are not logged, so the fusion signal threshold does not apply.
+ *
+ ****************************************************************************/
+
+#ifndef __COMPONENTS_SERVICES_TRACE_REPLAY_INCLUDE_TRACE_REPLAY_H
+#define __COMPONENTS_SERVICES_TRACE_REPLAY_INCLUDE_TRACE_REPLAY_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* trace_replay_config_t.session: every session in the log */
+
+#define TRACE_REPLAY_ALL_SESSIONS   (-1)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Timed stages of a replayed frame */
+
+typedef enum
+{
+  TRACE_REPLAY_STAGE_DECODE = 0,    /* Record to frame */
+  TRACE_REPLAY_STAGE_DETECT,        /* Gating, fusion and tracking */
+  TRACE_REPLAY_STAGE_HAPTIC,        /* Sector selection and RTP target */
+  TRACE_REPLAY_STAGE_COUNT,
+} trace_replay_stage_t;
+
+/* Haptic decision for one replayed frame */
+
+typedef struct
+{
+  uint8_t sensor;                   /* vl53l5cx_sensor_t */
+  bool tagged;                      /* Orientation was recorded */
+  uint16_t session;
+  uint32_t seq;                     /* Log record sequence */
+  uint32_t time_ms;                 /* Recorded frame time */
+  uint16_t distance_mm;             /* Most urgent sector, UINT16_MAX if
+                                     * none */
+  uint16_t ttc_ms;                  /* OBSTACLE_TTC_NONE if not closing */
+  uint8_t level;                    /* RTP target amplitude */
+} trace_replay_decision_t;
+
+/* Per-frame decision callback (caller's task) */
+
+typedef void (*trace_replay_cb_t)(const trace_replay_decision_t *decision,
+                                  void *arg);
+
+/* Run parameters */
+
+typedef struct
+{
+  int32_t session;                  /* TRACE_REPLAY_ALL_SESSIONS or one */
+  bool realtime;                    /* Pace at the recorded times */
+  trace_replay_cb_t callback;       /* NULL: result only */
+  void *arg;
+} trace_replay_config_t;
+
+/* Stage cost */
+
+typedef struct
+{
+  uint32_t avg_cycles;
+  uint32_t max_cycles;
+} trace_replay_timing_t;
+
+/* Run result */
+
+typedef struct
+{
+  uint32_t pages;                   /* Log pages replayed */
+  uint32_t records;                 /* Records read (all types) */
+  uint32_t frames;                  /* ToF frames replayed */
+  uint32_t untagged;                /* Frames without orientation */
+  uint32_t corrupt;                 /* Bad CRC, length or payload */
+  uint32_t no_ref;                  /* Deltas without their keyframe */
+  uint32_t sessions;                /* Sessions replayed */
+  uint32_t level_changes;           /* RTP target changes */
+  uint32_t digest;                  /* FNV-1a of the decision stream */
+  uint32_t span_ms;                 /* Recorded time covered */
+  int64_t elapsed_us;               /* Wall time of the run */
+  trace_replay_timing_t stages[TRACE_REPLAY_STAGE_COUNT];
+} trace_replay_result_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trace_replay_run
+ *
+ * Description:
+ *   Replay the readable log pages, oldest first. Each ToF record is
+ *   paired with the orientation record logged right after it (if any).
+ *   Obstacle detection state is reset at the start and at every session
+ *   change, as at boot.
+ *
+ *   Needs data_logger_init() and haptic_feedback_init() (RTP streaming
+ *   need not run: only the target is computed), and obstacle detection
+ *   must not be started. Blocks until the end of the log.
+ *
+ * Input Parameters:
+ *   config - Run parameters
+ *   result - Counters, digest and stage costs (output)
+ *
+ * Returned Value:
+ *   ESP_OK; ESP_ERR_NOT_FOUND if no frame was replayed;
+ *   ESP_ERR_INVALID_STATE if the logger is not running or obstacle
+ *   detection is live; ESP_ERR_INVALID_ARG on bad arguments.
+ *
+ ****************************************************************************/
+
+esp_err_t trace_replay_run(const trace_replay_config_t *config,
+                           trace_replay_result_t *result);
+
+#endif /* __COMPONENTS_SERVICES_TRACE_REPLAY_INCLUDE_TRACE_REPLAY_H */
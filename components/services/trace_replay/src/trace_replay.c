@@ -0,0 +1,515 @@
+/****************************************************************************
+ * components/services/trace_replay/src/trace_replay.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Pages are read whole from the log partition, their records checked
+ * (CRC-16, length) and decoded into driver frames. A frame is held until
+ * the next record: an orientation record right after it is its tag, as
+ * the sensing task logs them; anything else means it was untagged.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "trace_replay.h"
+#include "data_logger.h"
+#include "data_logger_codec.h"
+#include "haptic_feedback.h"
+#include "obstacle_detection.h"
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[REPLAY]"
+
+#define TR_REC_SIZE             sizeof(data_logger_rec_t)
+
+/* Real-time pacing: recorded gaps longer than this are not waited */
+
+#define TR_MAX_GAP_MS           1000
+
+/* FNV-1a */
+
+#define TR_FNV_OFFSET           0x811c9dc5u
+#define TR_FNV_PRIME            0x01000193u
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* One run at a time (caller's task) */
+
+static const trace_replay_config_t *g_config;
+static trace_replay_result_t *g_result;
+static uint8_t g_page[DATA_LOGGER_PAGE_SIZE];
+static data_logger_codec_t g_codec[DATA_LOGGER_TOF_SENSORS];
+static vl53l5cx_frame_t g_frame;
+static bool g_pending = false;          /* g_frame waits for its tag */
+static uint16_t g_session;
+static uint8_t g_level;
+static uint64_t g_cycles[TRACE_REPLAY_STAGE_COUNT];
+
+/* Recorded time: session span and real-time pacing */
+
+static bool g_have_last = false;        /* g_last_ms valid (session) */
+static uint32_t g_last_ms;
+static int64_t g_pace_us;               /* Wall time of g_pace_ms */
+static uint32_t g_pace_ms;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tr_stage
+ ****************************************************************************/
+
+static void tr_stage(trace_replay_stage_t stage, uint32_t cycles)
+{
+  trace_replay_timing_t *t = &g_result->stages[stage];
+
+  g_cycles[stage] += cycles;
+  if (cycles > t->max_cycles)
+    {
+      t->max_cycles = cycles;
+    }
+}
+
+/****************************************************************************
+ * Name: tr_digest
+ ****************************************************************************/
+
+static void tr_digest(const void *data, size_t len)
+{
+  const uint8_t *p = data;
+
+  for (size_t i = 0; i < len; i++)
+    {
+      g_result->digest = (g_result->digest ^ p[i]) * TR_FNV_PRIME;
+    }
+}
+
+/****************************************************************************
+ * Name: tr_pace
+ *
+ * Description:
+ *   Wait until the frame's recorded time, relative to the first frame
+ *   of the stretch. Time going backwards or a long gap starts a new
+ *   stretch.
+ *
+ ****************************************************************************/
+
+static void tr_pace(uint32_t time_ms)
+{
+  int64_t now = esp_timer_get_time();
+  int64_t wait_us;
+
+  if (!g_have_last || time_ms < g_last_ms ||
+      time_ms - g_last_ms > TR_MAX_GAP_MS)
+    {
+      g_pace_ms = time_ms;
+      g_pace_us = now;
+      return;
+    }
+
+  wait_us = g_pace_us + (int64_t)(time_ms - g_pace_ms) * 1000 - now;
+  if (wait_us >= 1000)
+    {
+      vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+    }
+}
+
+/****************************************************************************
+ * Name: tr_replay_frame
+ *
+ * Description:
+ *   Run the held frame through obstacle detection and the haptic threat
+ *   mapping (same sector selection as the haptic task) and report the
+ *   decision.
+ *
+ ****************************************************************************/
+
+static void tr_replay_frame(const obstacle_orientation_t *o)
+{
+  trace_replay_decision_t d;
+  obstacle_ttc_t ttc;
+  uint32_t c0;
+  uint32_t c1;
+  uint16_t best_ttc = OBSTACLE_TTC_NONE;
+  uint16_t best_mm = UINT16_MAX;
+  uint32_t time_ms = (uint32_t)(g_frame.int_time_us / 1000);
+
+  g_pending = false;
+
+  if (g_config->realtime)
+    {
+      tr_pace(time_ms);
+    }
+
+  if (g_have_last && time_ms >= g_last_ms)
+    {
+      g_result->span_ms += time_ms - g_last_ms;
+    }
+
+  g_have_last = true;
+  g_last_ms = time_ms;
+
+  c0 = esp_cpu_get_cycle_count();
+  obstacle_detection_replay_frame(&g_frame, o);
+  c1 = esp_cpu_get_cycle_count();
+
+  if (obstacle_detection_get_ttc(&ttc) == ESP_OK)
+    {
+      for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+        {
+          uint16_t mm = ttc.distance_mm[s] == VL53L5CX_DISTANCE_INVALID ?
+                        UINT16_MAX : (uint16_t)ttc.distance_mm[s];
+
+          if (ttc.ttc_ms[s] < best_ttc ||
+              (ttc.ttc_ms[s] == best_ttc && mm < best_mm))
+            {
+              best_ttc = ttc.ttc_ms[s];
+              best_mm = mm;
+            }
+        }
+    }
+
+  haptic_feedback_set_threat(best_mm, best_ttc, 0);
+  d.level = haptic_feedback_get_target();
+
+  tr_stage(TRACE_REPLAY_STAGE_DETECT, c1 - c0);
+  tr_stage(TRACE_REPLAY_STAGE_HAPTIC, esp_cpu_get_cycle_count() - c1);
+
+  d.sensor = (uint8_t)g_frame.sensor;
+  d.tagged = (o != NULL);
+  d.session = g_session;
+  d.seq = g_frame.sequence;
+  d.time_ms = time_ms;
+  d.distance_mm = best_mm;
+  d.ttc_ms = best_ttc;
+
+  g_result->frames++;
+  if (o == NULL)
+    {
+      g_result->untagged++;
+    }
+
+  if (d.level != g_level)
+    {
+      g_result->level_changes++;
+      g_level = d.level;
+    }
+
+  tr_digest(&d.sensor, sizeof(d.sensor));
+  tr_digest(&d.time_ms, sizeof(d.time_ms));
+  tr_digest(&d.distance_mm, sizeof(d.distance_mm));
+  tr_digest(&d.ttc_ms, sizeof(d.ttc_ms));
+  tr_digest(&d.level, sizeof(d.level));
+
+  if (g_config->callback != NULL)
+    {
+      g_config->callback(&d, g_config->arg);
+    }
+}
+
+/****************************************************************************
+ * Name: tr_decode_tof
+ *
+ * Description:
+ *   Decode a ToF record into g_frame.
+ *
+ ****************************************************************************/
+
+static bool tr_decode_tof(const data_logger_rec_t *rec,
+                          const uint8_t *payload)
+{
+  const data_logger_tof_t *tof = (const data_logger_tof_t *)payload;
+  vl53l5cx_frame_t *f = &g_frame;
+  uint8_t nb_zones;
+  uint8_t sensor;
+  int ret;
+
+  if (rec->len < sizeof(*tof))
+    {
+      g_result->corrupt++;
+      return false;
+    }
+
+  /* Both payload formats start with the sensor index */
+
+  sensor = tof->sensor;
+  if (sensor >= DATA_LOGGER_TOF_SENSORS)
+    {
+      g_result->corrupt++;
+      return false;
+    }
+
+  if (rec->type == DATA_LOGGER_REC_TOF_DELTA)
+    {
+      ret = data_logger_codec_decode(&g_codec[sensor], payload, rec->len,
+                                     &nb_zones, f->distance_mm,
+                                     f->target_status);
+      if (ret == DATA_LOGGER_CODEC_NO_REF)
+        {
+          g_result->no_ref++;
+          return false;
+        }
+
+      if (ret != DATA_LOGGER_CODEC_OK)
+        {
+          g_result->corrupt++;
+          return false;
+        }
+    }
+  else
+    {
+      nb_zones = tof->nb_zones;
+      if ((nb_zones != VL53L5CX_RESOLUTION_4X4 &&
+           nb_zones != VL53L5CX_RESOLUTION_8X8) ||
+          rec->len != sizeof(*tof) + nb_zones * 3)
+        {
+          g_result->corrupt++;
+          return false;
+        }
+
+      memcpy(f->distance_mm, payload + sizeof(*tof),
+             nb_zones * sizeof(f->distance_mm[0]));
+      memcpy(f->target_status,
+             payload + sizeof(*tof) + nb_zones * sizeof(f->distance_mm[0]),
+             nb_zones);
+    }
+
+  f->sensor = (vl53l5cx_sensor_t)sensor;
+  f->nb_zones = nb_zones;
+  f->valid_zones = 0;
+  f->stream_count = 0;
+  f->sequence = rec->seq;
+  f->int_time_us = (int64_t)rec->time_ms * 1000;
+  f->read_done_us = f->int_time_us;
+
+  for (int z = 0; z < nb_zones; z++)
+    {
+      f->signal_kcps[z] = UINT16_MAX;  /* Not logged: always above */
+      if (f->distance_mm[z] != VL53L5CX_DISTANCE_INVALID)
+        {
+          f->valid_zones++;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: tr_record
+ ****************************************************************************/
+
+static void tr_record(const data_logger_rec_t *rec, const uint8_t *payload)
+{
+  const data_logger_imu_t *imu = (const data_logger_imu_t *)payload;
+  obstacle_orientation_t o;
+  uint32_t c0;
+  bool ok;
+
+  g_result->records++;
+
+  if (rec->type == DATA_LOGGER_REC_IMU && g_pending &&
+      rec->len == sizeof(*imu))
+    {
+      o.pitch = imu->pitch;
+      o.roll = imu->roll;
+      o.timestamp_us = (int64_t)rec->time_ms * 1000;
+      tr_replay_frame(&o);
+      return;
+    }
+
+  if (g_pending)
+    {
+      tr_replay_frame(NULL);
+    }
+
+  if (rec->type == DATA_LOGGER_REC_TOF ||
+      rec->type == DATA_LOGGER_REC_TOF_DELTA)
+    {
+      c0 = esp_cpu_get_cycle_count();
+      ok = tr_decode_tof(rec, payload);
+      tr_stage(TRACE_REPLAY_STAGE_DECODE, esp_cpu_get_cycle_count() - c0);
+      g_pending = ok;
+    }
+}
+
+/****************************************************************************
+ * Name: tr_page
+ *
+ * Description:
+ *   Replay the records of a page read into g_page. A record failing its
+ *   CRC ends the page: its length cannot be trusted.
+ *
+ ****************************************************************************/
+
+static void tr_page(size_t used)
+{
+  data_logger_rec_t rec;
+  size_t off = sizeof(data_logger_page_t);
+  const uint8_t *payload;
+  uint16_t crc;
+
+  while (off + TR_REC_SIZE <= used)
+    {
+      memcpy(&rec, g_page + off, TR_REC_SIZE);
+      payload = g_page + off + TR_REC_SIZE;
+
+      if (off + TR_REC_SIZE + rec.len > used)
+        {
+          g_result->corrupt++;
+          return;
+        }
+
+      crc = esp_rom_crc16_le(0, payload, rec.len);
+      crc = esp_rom_crc16_le(crc, g_page + off + sizeof(rec.crc),
+                             TR_REC_SIZE - sizeof(rec.crc));
+      if (crc != rec.crc)
+        {
+          g_result->corrupt++;
+          return;
+        }
+
+      tr_record(&rec, payload);
+      off += TR_REC_SIZE + rec.len;
+    }
+}
+
+/****************************************************************************
+ * Name: tr_start_session
+ *
+ * Description:
+ *   A new boot session: finish the held frame and start from a cold
+ *   state, as the device did.
+ *
+ ****************************************************************************/
+
+static void tr_start_session(uint16_t session)
+{
+  if (g_pending)
+    {
+      tr_replay_frame(NULL);
+    }
+
+  obstacle_detection_replay_reset();
+
+  for (int i = 0; i < DATA_LOGGER_TOF_SENSORS; i++)
+    {
+      data_logger_codec_reset(&g_codec[i]);
+    }
+
+  g_session = session;
+  g_have_last = false;
+  g_result->sessions++;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trace_replay_run
+ ****************************************************************************/
+
+esp_err_t trace_replay_run(const trace_replay_config_t *config,
+                           trace_replay_result_t *result)
+{
+  data_logger_page_t hdr;
+  uint32_t first;
+  uint32_t next;
+  int64_t start_us;
+  esp_err_t ret;
+
+  if (config == NULL || result == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  ret = data_logger_get_range(&first, &next);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  ret = obstacle_detection_replay_reset();
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  memset(result, 0, sizeof(*result));
+  memset(g_cycles, 0, sizeof(g_cycles));
+  result->digest = TR_FNV_OFFSET;
+  g_config = config;
+  g_result = result;
+  g_pending = false;
+  g_level = haptic_feedback_get_target();
+
+  ESP_LOGI(TAG, "Replaying pages %lu-%lu (%s)", (unsigned long)first,
+           (unsigned long)(next - 1),
+           config->realtime ? "real time" : "as fast as possible");
+
+  start_us = esp_timer_get_time();
+
+  for (uint32_t page = first; page != next; page++)
+    {
+      if (data_logger_read_header(page, &hdr) != ESP_OK)
+        {
+          continue;
+        }
+
+      if (config->session != TRACE_REPLAY_ALL_SESSIONS &&
+          hdr.session != (uint16_t)config->session)
+        {
+          continue;
+        }
+
+      if (hdr.used < sizeof(hdr) || hdr.used > DATA_LOGGER_PAGE_SIZE)
+        {
+          result->corrupt++;
+          continue;
+        }
+
+      if (data_logger_read(page, 0, g_page, hdr.used) != ESP_OK)
+        {
+          continue;
+        }
+
+      if (result->sessions == 0 || hdr.session != g_session)
+        {
+          tr_start_session(hdr.session);
+        }
+
+      result->pages++;
+      tr_page(hdr.used);
+    }
+
+  if (g_pending)
+    {
+      tr_replay_frame(NULL);
+    }
+
+  result->elapsed_us = esp_timer_get_time() - start_us;
+
+  for (int i = 0; i < TRACE_REPLAY_STAGE_COUNT; i++)
+    {
+      result->stages[i].avg_cycles = result->frames == 0 ? 0 :
+        (uint32_t)(g_cycles[i] / result->frames);
+    }
+
+  return result->frames == 0 ? ESP_ERR_NOT_FOUND : ESP_OK;
+}
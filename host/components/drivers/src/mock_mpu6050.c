@@ -0,0 +1,303 @@
+/****************************************************************************
+ * host/components/drivers/src/mock_mpu6050.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host sample source with the mpu6050.h API. A producer task delivers a
+ * burst of CONFIG_MAIA_MPU6050_FIFO_WATERMARK samples per watermark
+ * period, as the FIFO drain does on the target: gravity on Z with a
+ * 2 Hz walking bounce, a small pitch oscillation and noise.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "mpu6050.h"
+#include "maia_board.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MOCK_IMU_TASK_STACK_SIZE    3072
+#define MOCK_IMU_TASK_PRIORITY      (configMAX_PRIORITIES - 3)
+
+#define MOCK_IMU_SMPLRT_DIV         ((1000 / CONFIG_MAIA_MPU6050_ODR_HZ) - 1)
+#define MOCK_IMU_PERIOD_US          (1000 * (1 + MOCK_IMU_SMPLRT_DIV))
+#define MOCK_IMU_WATERMARK          CONFIG_MAIA_MPU6050_FIFO_WATERMARK
+#define MOCK_IMU_RING_SIZE          CONFIG_MAIA_MPU6050_RING_SIZE
+
+/* Gait: triangle wave of MOCK_IMU_GAIT_US period, amplitudes in LSB */
+
+#define MOCK_IMU_GAIT_US            500000
+#define MOCK_IMU_BOUNCE_LSB         (MPU6050_ACCEL_LSB_PER_G / 8)
+#define MOCK_IMU_PITCH_LSB          (MPU6050_GYRO_LSB_PER_DPS_X10 * 2)
+#define MOCK_IMU_NOISE_LSB          64
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static portMUX_TYPE g_ring_lock = portMUX_INITIALIZER_UNLOCKED;
+static mpu6050_sample_t g_ring[MOCK_IMU_RING_SIZE];
+static uint32_t g_head = 0;
+static uint32_t g_tail = 0;
+static mpu6050_stats_t g_stats;
+
+static TaskHandle_t g_task = NULL;
+static volatile bool g_running = false;
+static mpu6050_sample_cb_t g_sample_cb = NULL;
+static void *g_sample_cb_arg = NULL;
+
+static uint32_t g_rng = CONFIG_MAIA_HOST_SEED ^ 0x5a5a5a5a;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_imu_noise
+ ****************************************************************************/
+
+static int16_t mock_imu_noise(void)
+{
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return (int16_t)((int32_t)(g_rng % (2 * MOCK_IMU_NOISE_LSB + 1)) -
+                   MOCK_IMU_NOISE_LSB);
+}
+
+/****************************************************************************
+ * Name: mock_imu_wave
+ *
+ * Description:
+ *   Triangle wave in [-amplitude, amplitude] over the gait period.
+ *
+ ****************************************************************************/
+
+static int32_t mock_imu_wave(int64_t t_us, int32_t amplitude)
+{
+  int32_t phase = (int32_t)(t_us % MOCK_IMU_GAIT_US);
+  int32_t half = MOCK_IMU_GAIT_US / 2;
+  int32_t tri = phase < half ? phase : MOCK_IMU_GAIT_US - phase;
+
+  return (int32_t)((int64_t)amplitude * (4 * tri - MOCK_IMU_GAIT_US) /
+                   MOCK_IMU_GAIT_US);
+}
+
+/****************************************************************************
+ * Name: mock_imu_push
+ ****************************************************************************/
+
+static void mock_imu_push(const mpu6050_sample_t *samples, size_t n)
+{
+  portENTER_CRITICAL(&g_ring_lock);
+
+  for (size_t i = 0; i < n; i++)
+    {
+      if (g_head - g_tail >= MOCK_IMU_RING_SIZE)
+        {
+          g_stats.dropped += n - i;
+          break;
+        }
+
+      g_ring[g_head % MOCK_IMU_RING_SIZE] = samples[i];
+      g_head++;
+    }
+
+  g_stats.bursts++;
+  g_stats.samples += n;
+  portEXIT_CRITICAL(&g_ring_lock);
+}
+
+/****************************************************************************
+ * Name: mock_imu_task
+ ****************************************************************************/
+
+static void mock_imu_task(void *arg)
+{
+  static mpu6050_sample_t burst[MOCK_IMU_WATERMARK];
+  TickType_t period = pdMS_TO_TICKS(MOCK_IMU_WATERMARK *
+                                    MOCK_IMU_PERIOD_US / 1000);
+  TickType_t last;
+  int64_t now;
+
+  (void)arg;
+
+  if (period == 0)
+    {
+      period = 1;
+    }
+
+  last = xTaskGetTickCount();
+
+  for (;;)
+    {
+      if (!g_running)
+        {
+          ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+          last = xTaskGetTickCount();
+          continue;
+        }
+
+      vTaskDelayUntil(&last, period);
+
+      /* Oldest sample first, the newest one taken now */
+
+      now = esp_timer_get_time();
+      for (int i = 0; i < MOCK_IMU_WATERMARK; i++)
+        {
+          mpu6050_sample_t *s = &burst[i];
+          int64_t t = now - (int64_t)(MOCK_IMU_WATERMARK - 1 - i) *
+                            MOCK_IMU_PERIOD_US;
+
+          s->timestamp_us = t;
+          s->accel[0] = mock_imu_noise();
+          s->accel[1] = mock_imu_noise();
+          s->accel[2] = (int16_t)(MPU6050_ACCEL_LSB_PER_G +
+                                  mock_imu_wave(t, MOCK_IMU_BOUNCE_LSB) +
+                                  mock_imu_noise());
+          s->gyro[0] = (int16_t)(mock_imu_wave(t, MOCK_IMU_PITCH_LSB) +
+                                 mock_imu_noise());
+          s->gyro[1] = mock_imu_noise();
+          s->gyro[2] = mock_imu_noise();
+        }
+
+      mock_imu_push(burst, MOCK_IMU_WATERMARK);
+
+      if (g_sample_cb != NULL)
+        {
+          g_sample_cb(g_sample_cb_arg);
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mpu6050_init
+ ****************************************************************************/
+
+esp_err_t mpu6050_init(void)
+{
+  if (g_task != NULL)
+    {
+      return ESP_OK;
+    }
+
+  memset(&g_stats, 0, sizeof(g_stats));
+
+  if (xTaskCreatePinnedToCore(mock_imu_task, "imu_reader",
+                              MOCK_IMU_TASK_STACK_SIZE, NULL,
+                              MOCK_IMU_TASK_PRIORITY, &g_task,
+                              MAIA_CORE_RT) != pdPASS)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: mpu6050_start / mpu6050_stop
+ ****************************************************************************/
+
+esp_err_t mpu6050_start(void)
+{
+  if (g_task == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  g_running = true;
+  xTaskNotifyGive(g_task);
+  return ESP_OK;
+}
+
+esp_err_t mpu6050_stop(void)
+{
+  if (g_task == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  g_running = false;
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: mpu6050_read_samples
+ ****************************************************************************/
+
+size_t mpu6050_read_samples(mpu6050_sample_t *samples, size_t max)
+{
+  size_t n = 0;
+
+  if (samples == NULL)
+    {
+      return 0;
+    }
+
+  portENTER_CRITICAL(&g_ring_lock);
+
+  while (n < max && g_tail != g_head)
+    {
+      samples[n++] = g_ring[g_tail % MOCK_IMU_RING_SIZE];
+      g_tail++;
+    }
+
+  portEXIT_CRITICAL(&g_ring_lock);
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: mpu6050_set_sample_callback
+ ****************************************************************************/
+
+esp_err_t mpu6050_set_sample_callback(mpu6050_sample_cb_t callback,
+                                      void *arg)
+{
+  portENTER_CRITICAL(&g_ring_lock);
+  g_sample_cb = callback;
+  g_sample_cb_arg = arg;
+  portEXIT_CRITICAL(&g_ring_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: mpu6050_get_odr_hz
+ ****************************************************************************/
+
+uint16_t mpu6050_get_odr_hz(void)
+{
+  return 1000 / (1 + MOCK_IMU_SMPLRT_DIV);
+}
+
+/****************************************************************************
+ * Name: mpu6050_get_stats
+ ****************************************************************************/
+
+esp_err_t mpu6050_get_stats(mpu6050_stats_t *stats)
+{
+  if (stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_ring_lock);
+  *stats = g_stats;
+  portEXIT_CRITICAL(&g_ring_lock);
+
+  return ESP_OK;
+}
@@ -0,0 +1,507 @@
+/****************************************************************************
+ * host/components/drivers/src/mock_vl53l5cx.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host frame source with the vl53l5cx.h API. Instead of emulating the
+ * ULD register interface, a producer task synthesizes both sensors'
+ * frames: a far wall, the ground in the bottom row and an obstacle in
+ * the inner half of each field of view that approaches from 2.5 m to
+ * 0.3 m every CONFIG_MAIA_HOST_APPROACH_FRAMES frames, plus range noise
+ * and a few zones without target.
+ *
+ * Paced mode publishes at the ranging frequency. Free-run mode publishes
+ * the next frame as soon as the consumer has released the previous one,
+ * to measure the pipeline's throughput; frame timestamps then follow
+ * the host clock, so speeds and TTC are not meaningful.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "vl53l5cx.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MOCK_TOF]"
+
+#define MOCK_TOF_TASK_STACK_SIZE    4096
+#define MOCK_TOF_TASK_PRIORITY      (configMAX_PRIORITIES - 2)
+
+#define MOCK_TOF_FRAME_NONE         0xff
+
+#define MOCK_TOF_MAX_FREQ_8X8       15
+#define MOCK_TOF_MAX_FREQ_4X4       60
+
+/* Scene (mm) */
+
+#define MOCK_TOF_WALL_MM            3000
+#define MOCK_TOF_GROUND_MM          900
+#define MOCK_TOF_NEAR_MM            300
+#define MOCK_TOF_FAR_MM             2500
+#define MOCK_TOF_NOISE_MM           16
+
+/* One zone in MOCK_TOF_NO_TARGET_RATE reports no target */
+
+#define MOCK_TOF_NO_TARGET_RATE     32
+
+/* Free-run: give up waiting for a consumer after this long */
+
+#define MOCK_TOF_RELEASE_TIMEOUT_MS 100
+
+#ifdef CONFIG_MAIA_VL53L5CX_RESOLUTION_4X4
+#  define MOCK_TOF_DEFAULT_RESOLUTION  VL53L5CX_RESOLUTION_4X4
+#else
+#  define MOCK_TOF_DEFAULT_RESOLUTION  VL53L5CX_RESOLUTION_8X8
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  vl53l5cx_frame_t frames[2];       /* Ping-pong buffer */
+  uint8_t front;                    /* Latest published half */
+  uint8_t held;                     /* Half held by the consumer */
+  bool pending;                     /* Published, not released yet */
+  uint32_t sequence;
+  vl53l5cx_stats_t stats;
+} mock_tof_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static portMUX_TYPE g_frame_lock = portMUX_INITIALIZER_UNLOCKED;
+static mock_tof_t g_sensors[VL53L5CX_SENSOR_COUNT];
+static TaskHandle_t g_task = NULL;
+static bool g_initialized = false;
+static volatile bool g_ranging = false;
+
+static vl53l5cx_resolution_t g_res = MOCK_TOF_DEFAULT_RESOLUTION;
+static uint8_t g_freq_hz = CONFIG_MAIA_VL53L5CX_RANGING_FREQ_HZ;
+
+static vl53l5cx_frame_cb_t g_frame_cb = NULL;
+static void *g_frame_cb_arg = NULL;
+
+static uint32_t g_rng = CONFIG_MAIA_HOST_SEED;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_tof_rand
+ *
+ * Description:
+ *   xorshift32: reproducible scenes for a given seed.
+ *
+ ****************************************************************************/
+
+static uint32_t mock_tof_rand(void)
+{
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return g_rng;
+}
+
+/****************************************************************************
+ * Name: mock_tof_scene
+ *
+ * Description:
+ *   Fill one frame of the synthetic scene.
+ *
+ ****************************************************************************/
+
+static void mock_tof_scene(vl53l5cx_sensor_t sensor, uint32_t sequence,
+                           uint8_t zones, vl53l5cx_frame_t *f)
+{
+  uint8_t side = (zones == VL53L5CX_RESOLUTION_8X8) ? 8 : 4;
+  uint32_t phase = sequence % CONFIG_MAIA_HOST_APPROACH_FRAMES;
+  int32_t obstacle;
+  uint8_t valid = 0;
+
+  obstacle = MOCK_TOF_FAR_MM -
+             (int32_t)(phase * (MOCK_TOF_FAR_MM - MOCK_TOF_NEAR_MM) /
+                       CONFIG_MAIA_HOST_APPROACH_FRAMES);
+
+  for (uint8_t z = 0; z < zones; z++)
+    {
+      uint8_t row = z / side;
+      uint8_t col = z % side;
+      bool inner = (sensor == VL53L5CX_SENSOR_LEFT) ? col >= side / 2
+                                                    : col < side / 2;
+      uint32_t r = mock_tof_rand();
+      int32_t d;
+
+      if (row == side - 1)
+        {
+          d = MOCK_TOF_GROUND_MM;
+        }
+      else if (inner && row >= side / 4 && row < side - side / 4)
+        {
+          d = obstacle;
+        }
+      else
+        {
+          d = MOCK_TOF_WALL_MM;
+        }
+
+      if ((r >> 24) % MOCK_TOF_NO_TARGET_RATE == 0)
+        {
+          f->distance_mm[z] = VL53L5CX_DISTANCE_INVALID;
+          f->target_status[z] = VL53L5CX_TARGET_STATUS_NO_TARGET;
+          f->signal_kcps[z] = 0;
+          continue;
+        }
+
+      d += (int32_t)(r % (2 * MOCK_TOF_NOISE_MM + 1)) - MOCK_TOF_NOISE_MM;
+      f->distance_mm[z] = (int16_t)d;
+      f->target_status[z] = VL53L5CX_TARGET_STATUS_VALID;
+      f->signal_kcps[z] = (uint16_t)(4000000 / d);
+      valid++;
+    }
+
+  f->nb_zones = zones;
+  f->valid_zones = valid;
+}
+
+/****************************************************************************
+ * Name: mock_tof_publish
+ *
+ * Description:
+ *   Same ping-pong policy as the target driver: if the consumer holds
+ *   the only free half, the frame is dropped.
+ *
+ ****************************************************************************/
+
+static void mock_tof_publish(vl53l5cx_sensor_t sensor, uint8_t zones)
+{
+  mock_tof_t *s = &g_sensors[sensor];
+  vl53l5cx_frame_t *f;
+  uint8_t back;
+
+  portENTER_CRITICAL(&g_frame_lock);
+  back = (s->front == MOCK_TOF_FRAME_NONE) ? 0 : (s->front ^ 1);
+  if (s->held == back)
+    {
+      s->stats.dropped++;
+      portEXIT_CRITICAL(&g_frame_lock);
+      return;
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  f = &s->frames[back];
+  f->int_time_us = esp_timer_get_time();
+  f->sensor = sensor;
+  f->sequence = ++s->sequence;
+  f->stream_count = (uint8_t)f->sequence;
+  mock_tof_scene(sensor, f->sequence, zones, f);
+  f->read_done_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&g_frame_lock);
+  s->front = back;
+  s->pending = true;
+  s->stats.frames++;
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  if (g_frame_cb != NULL)
+    {
+      g_frame_cb(sensor, g_frame_cb_arg);
+    }
+}
+
+/****************************************************************************
+ * Name: mock_tof_pace
+ *
+ * Description:
+ *   Wait before the next frame pair: until the consumer has released
+ *   both frames (free-run) or for one ranging period.
+ *
+ ****************************************************************************/
+
+static void mock_tof_pace(TickType_t *last)
+{
+#ifdef CONFIG_MAIA_HOST_FREE_RUN
+  bool pending;
+
+  (void)last;
+
+  for (;;)
+    {
+      portENTER_CRITICAL(&g_frame_lock);
+      pending = g_sensors[VL53L5CX_SENSOR_LEFT].pending ||
+                g_sensors[VL53L5CX_SENSOR_RIGHT].pending;
+      portEXIT_CRITICAL(&g_frame_lock);
+
+      if (!pending ||
+          ulTaskNotifyTake(pdTRUE,
+                           pdMS_TO_TICKS(MOCK_TOF_RELEASE_TIMEOUT_MS)) == 0)
+        {
+          return;
+        }
+    }
+#else
+  vTaskDelayUntil(last, pdMS_TO_TICKS(1000 / g_freq_hz));
+#endif
+}
+
+/****************************************************************************
+ * Name: mock_tof_task
+ ****************************************************************************/
+
+static void mock_tof_task(void *arg)
+{
+  TickType_t last = xTaskGetTickCount();
+  uint8_t zones;
+
+  (void)arg;
+
+  for (;;)
+    {
+      if (!g_ranging)
+        {
+          ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+          last = xTaskGetTickCount();
+          continue;
+        }
+
+      portENTER_CRITICAL(&g_frame_lock);
+      zones = (uint8_t)g_res;
+      portEXIT_CRITICAL(&g_frame_lock);
+
+      mock_tof_publish(VL53L5CX_SENSOR_LEFT, zones);
+      mock_tof_publish(VL53L5CX_SENSOR_RIGHT, zones);
+
+      mock_tof_pace(&last);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vl53l5cx_init
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_init(void)
+{
+  if (g_initialized)
+    {
+      return ESP_OK;
+    }
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      memset(&g_sensors[i], 0, sizeof(g_sensors[i]));
+      g_sensors[i].front = MOCK_TOF_FRAME_NONE;
+      g_sensors[i].held = MOCK_TOF_FRAME_NONE;
+    }
+
+  if (xTaskCreatePinnedToCore(mock_tof_task, "tof_reader",
+                              MOCK_TOF_TASK_STACK_SIZE, NULL,
+                              MOCK_TOF_TASK_PRIORITY, &g_task,
+                              MAIA_CORE_RT) != pdPASS)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+
+  g_initialized = true;
+
+  ESP_LOGI(TAG, "Simulated sensors ready (%u zones, %u Hz%s)",
+           (unsigned)g_res, g_freq_hz,
+#ifdef CONFIG_MAIA_HOST_FREE_RUN
+           ", free-run"
+#else
+           ""
+#endif
+           );
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_start_ranging / vl53l5cx_stop_ranging
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_start_ranging(void)
+{
+  if (!g_initialized)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  g_ranging = true;
+  xTaskNotifyGive(g_task);
+  return ESP_OK;
+}
+
+esp_err_t vl53l5cx_stop_ranging(void)
+{
+  if (!g_initialized)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  g_ranging = false;
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_set_profile
+ *
+ * Description:
+ *   Same validation as the target driver; applied from the next frame.
+ *
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_set_profile(vl53l5cx_resolution_t resolution,
+                               uint8_t freq_hz)
+{
+  uint8_t max_hz;
+
+  if (!g_initialized)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  if (resolution == VL53L5CX_RESOLUTION_8X8)
+    {
+      max_hz = MOCK_TOF_MAX_FREQ_8X8;
+    }
+  else if (resolution == VL53L5CX_RESOLUTION_4X4)
+    {
+      max_hz = MOCK_TOF_MAX_FREQ_4X4;
+    }
+  else
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (freq_hz == 0 || freq_hz > max_hz)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_frame_lock);
+  if (resolution != g_res || freq_hz != g_freq_hz)
+    {
+      g_res = resolution;
+      g_freq_hz = freq_hz;
+      for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+        {
+          g_sensors[i].stats.reconfigs++;
+        }
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_set_frame_callback
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_set_frame_callback(vl53l5cx_frame_cb_t callback,
+                                      void *arg)
+{
+  g_frame_cb_arg = arg;
+  g_frame_cb = callback;
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_acquire_frame
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_acquire_frame(vl53l5cx_sensor_t sensor,
+                                 const vl53l5cx_frame_t **frame)
+{
+  mock_tof_t *s;
+  esp_err_t ret = ESP_OK;
+
+  if (sensor >= VL53L5CX_SENSOR_COUNT || frame == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  s = &g_sensors[sensor];
+
+  portENTER_CRITICAL(&g_frame_lock);
+  if (s->held != MOCK_TOF_FRAME_NONE)
+    {
+      ret = ESP_ERR_INVALID_STATE;
+    }
+  else if (s->front == MOCK_TOF_FRAME_NONE)
+    {
+      ret = ESP_ERR_NOT_FOUND;
+    }
+  else
+    {
+      s->held = s->front;
+      *frame = &s->frames[s->held];
+    }
+
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_release_frame
+ *
+ * Description:
+ *   Also paces the free-running producer.
+ *
+ ****************************************************************************/
+
+void vl53l5cx_release_frame(vl53l5cx_sensor_t sensor)
+{
+  if (sensor >= VL53L5CX_SENSOR_COUNT)
+    {
+      return;
+    }
+
+  portENTER_CRITICAL(&g_frame_lock);
+  g_sensors[sensor].held = MOCK_TOF_FRAME_NONE;
+  g_sensors[sensor].pending = false;
+  portEXIT_CRITICAL(&g_frame_lock);
+
+#ifdef CONFIG_MAIA_HOST_FREE_RUN
+  xTaskNotifyGive(g_task);
+#endif
+}
+
+/****************************************************************************
+ * Name: vl53l5cx_get_stats
+ ****************************************************************************/
+
+esp_err_t vl53l5cx_get_stats(vl53l5cx_sensor_t sensor,
+                             vl53l5cx_stats_t *stats)
+{
+  if (sensor >= VL53L5CX_SENSOR_COUNT || stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  portENTER_CRITICAL(&g_frame_lock);
+  *stats = g_sensors[sensor].stats;
+  portEXIT_CRITICAL(&g_frame_lock);
+
+  return ESP_OK;
+}
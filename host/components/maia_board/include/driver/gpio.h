@@ -0,0 +1,22 @@
+/****************************************************************************
+ * host/components/maia_board/include/driver/gpio.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host build: the GPIO types maia_board.h needs (no GPIO driver on the
+ * linux target).
+ *
+ ****************************************************************************/
+
+#ifndef __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_GPIO_H
+#define __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_GPIO_H
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC                 (-1)
+
+#endif /* __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_GPIO_H */
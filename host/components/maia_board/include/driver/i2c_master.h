@@ -0,0 +1,27 @@
+/****************************************************************************
+ * host/components/maia_board/include/driver/i2c_master.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host build: the I2C master types maia_board.h needs. The bus itself is
+ * simulated behind the maia_i2c_* API (mock_i2c.c).
+ *
+ ****************************************************************************/
+
+#ifndef __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_I2C_MASTER_H
+#define __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_I2C_MASTER_H
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef struct i2c_master_bus_t *i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t *i2c_master_dev_handle_t;
+
+typedef enum
+{
+  I2C_NUM_0 = 0,
+  I2C_NUM_1,
+} i2c_port_num_t;
+
+#endif /* __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_I2C_MASTER_H */
@@ -0,0 +1,40 @@
+/****************************************************************************
+ * host/components/maia_board/include/driver/ledc.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host build: the LEDC types maia_board.h needs.
+ *
+ ****************************************************************************/
+
+#ifndef __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_LEDC_H
+#define __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_LEDC_H
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef enum
+{
+  LEDC_LOW_SPEED_MODE = 0,
+} ledc_mode_t;
+
+typedef enum
+{
+  LEDC_CHANNEL_0 = 0,
+  LEDC_CHANNEL_1,
+  LEDC_CHANNEL_MAX,
+} ledc_channel_t;
+
+typedef enum
+{
+  LEDC_TIMER_0 = 0,
+  LEDC_TIMER_1,
+} ledc_timer_t;
+
+typedef enum
+{
+  LEDC_TIMER_8_BIT = 8,
+} ledc_timer_bit_t;
+
+#endif /* __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_DRIVER_LEDC_H */
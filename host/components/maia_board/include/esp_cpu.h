@@ -0,0 +1,33 @@
+/****************************************************************************
+ * host/components/maia_board/include/esp_cpu.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host build: esp_cpu_get_cycle_count() returns monotonic nanoseconds
+ * (truncated to 32 bits), so the service "cycles" statistics read as ns.
+ *
+ ****************************************************************************/
+
+#ifndef __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_ESP_CPU_H
+#define __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_ESP_CPU_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <time.h>
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+#endif /* __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_ESP_CPU_H */
@@ -0,0 +1,107 @@
+/****************************************************************************
+ * host/components/maia_board/include/maia_board_mock.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host build of the board: maia_board.h implemented on the ESP-IDF linux
+ * target. The I2C bus is a table of simulated devices. Transfers run
+ * to completion without sleeping, and the statistics account the time
+ * they would have taken at the device's SCL speed.
+ *
+ ****************************************************************************/
+
+#ifndef __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_MAIA_BOARD_MOCK_H
+#define __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_MAIA_BOARD_MOCK_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Simulated I2C device. write() gets the bytes of one write transaction
+ * (prefix included); read() fills the read phase of a write-read.
+ * Either may return ESP_FAIL to simulate a NACK.
+ */
+
+typedef struct
+{
+  const char *name;
+  uint16_t addr;
+  esp_err_t (*write)(void *ctx, const uint8_t *data, size_t len);
+  esp_err_t (*read)(void *ctx, uint8_t *data, size_t len);
+  void *ctx;
+} mock_i2c_model_t;
+
+/* SSD1306 model counters */
+
+typedef struct
+{
+  uint32_t commands;                /* Command bytes parsed */
+  uint32_t data_bytes;              /* Bytes written to GDDRAM */
+  bool display_on;
+} mock_ssd1306_stats_t;
+
+/* DRV2605L model counters */
+
+typedef struct
+{
+  uint32_t go;                      /* GO triggers (effects, sequences) */
+  uint32_t rtp_writes;              /* RTP input updates */
+  uint8_t mode;                     /* MODE register */
+  uint8_t rtp;                      /* Last RTP input */
+} mock_drv2605l_stats_t;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_i2c_attach
+ *
+ * Description:
+ *   Put a simulated device on the bus (the model is not copied).
+ *   Transfers to an address without a model fail as a NACK would.
+ *
+ * Returned Value:
+ *   ESP_OK on success; ESP_ERR_NO_MEM if the table is full.
+ *
+ ****************************************************************************/
+
+esp_err_t mock_i2c_attach(const mock_i2c_model_t *model);
+
+/****************************************************************************
+ * Name: mock_ssd1306_attach / mock_drv2605l_attach
+ *
+ * Description:
+ *   Attach the display and haptic driver models at their Kconfig
+ *   addresses (done by maia_board_init()).
+ *
+ ****************************************************************************/
+
+esp_err_t mock_ssd1306_attach(void);
+esp_err_t mock_drv2605l_attach(void);
+
+/****************************************************************************
+ * Name: mock_ssd1306_get_gddram
+ *
+ * Description:
+ *   Panel memory as the display would show it (page-major, one byte per
+ *   8 pixel column).
+ *
+ ****************************************************************************/
+
+const uint8_t *mock_ssd1306_get_gddram(void);
+
+/****************************************************************************
+ * Name: mock_ssd1306_get_stats / mock_drv2605l_get_stats
+ ****************************************************************************/
+
+void mock_ssd1306_get_stats(mock_ssd1306_stats_t *stats);
+void mock_drv2605l_get_stats(mock_drv2605l_stats_t *stats);
+
+#endif /* __HOST_COMPONENTS_MAIA_BOARD_INCLUDE_MAIA_BOARD_MOCK_H */
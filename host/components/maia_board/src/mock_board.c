@@ -0,0 +1,283 @@
+/****************************************************************************
+ * host/components/maia_board/src/mock_board.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host board: maia_board_init() brings up the simulated I2C bus with the
+ * display and haptic driver models. GPIO, LED, PWM and power hooks keep
+ * their state in memory only. The OneWire bus is empty, so every reset
+ * sees no presence pulse.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board_mock.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MOCK_BOARD]"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static bool g_led = false;
+static uint8_t g_duty[LEDC_CHANNEL_MAX];
+static int64_t g_pm_init_us = 0;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_board_init
+ ****************************************************************************/
+
+esp_err_t maia_board_init(void)
+{
+  esp_err_t ret;
+
+  ESP_LOGI(TAG, "============ Initializing MAIA host board ============");
+
+#ifdef CONFIG_MAIA_LOG_GENERAL_CONFIG
+  maia_config_log();
+#endif
+
+  maia_gpio_init();
+  maia_led_init();
+  maia_pm_init();
+
+  ret = maia_i2c_init();
+  if (ret == ESP_OK)
+    {
+      ret = mock_ssd1306_attach();
+    }
+
+  if (ret == ESP_OK)
+    {
+      ret = mock_drv2605l_attach();
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to set up the simulated I2C bus");
+      return ret;
+    }
+
+  return maia_pwm_init();
+}
+
+/****************************************************************************
+ * Name: maia_gpio_init
+ ****************************************************************************/
+
+esp_err_t maia_gpio_init(void)
+{
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_led_init / maia_led_set / maia_led_toggle
+ ****************************************************************************/
+
+esp_err_t maia_led_init(void)
+{
+  g_led = false;
+  return ESP_OK;
+}
+
+esp_err_t maia_led_set(bool state)
+{
+  g_led = state;
+  return ESP_OK;
+}
+
+esp_err_t maia_led_toggle(void)
+{
+  g_led = !g_led;
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_init
+ ****************************************************************************/
+
+esp_err_t maia_pwm_init(void)
+{
+  memset(g_duty, 0, sizeof(g_duty));
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_set_duty / maia_pwm_set_duty_stereo
+ ****************************************************************************/
+
+esp_err_t maia_pwm_set_duty(ledc_channel_t channel, uint8_t duty)
+{
+  if (channel >= LEDC_CHANNEL_MAX)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  g_duty[channel] = duty;
+  return ESP_OK;
+}
+
+esp_err_t maia_pwm_set_duty_stereo(uint8_t left, uint8_t right)
+{
+  g_duty[MAIA_PWM_CH_MOTOR_LEFT] = left;
+  g_duty[MAIA_PWM_CH_MOTOR_RIGHT] = right;
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_pwm_fade_stereo
+ *
+ * Description:
+ *   No time base for ramps: the last step's duties apply at once and a
+ *   finite pattern completes immediately.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pwm_fade_stereo(const maia_pwm_fade_step_t *steps,
+                               size_t count, uint8_t cycles,
+                               maia_pwm_fade_cb_t cb, void *arg)
+{
+  if (steps == NULL || count == 0 || count > MAIA_PWM_FADE_MAX_STEPS)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  maia_pwm_set_duty_stereo(steps[count - 1].left, steps[count - 1].right);
+
+  if (cycles > 0 && cb != NULL)
+    {
+      cb(arg);
+    }
+
+  return ESP_OK;
+}
+
+void maia_pwm_fade_stop(void)
+{
+}
+
+/****************************************************************************
+ * Name: maia_onewire_*
+ ****************************************************************************/
+
+esp_err_t maia_onewire_init(void)
+{
+  return ESP_OK;
+}
+
+bool maia_onewire_reset(gpio_num_t pin)
+{
+  (void)pin;
+  return false;
+}
+
+void maia_onewire_write_bit(gpio_num_t pin, uint8_t bit)
+{
+  (void)pin;
+  (void)bit;
+}
+
+uint8_t maia_onewire_read_bit(gpio_num_t pin)
+{
+  (void)pin;
+  return 1;                         /* Idle bus reads high */
+}
+
+void maia_onewire_write_byte(gpio_num_t pin, uint8_t byte)
+{
+  (void)pin;
+  (void)byte;
+}
+
+uint8_t maia_onewire_read_byte(gpio_num_t pin)
+{
+  (void)pin;
+  return 0xff;
+}
+
+void maia_onewire_write_block(gpio_num_t pin, const uint8_t *data,
+                              size_t len)
+{
+  (void)pin;
+  (void)data;
+  (void)len;
+}
+
+void maia_onewire_read_block(gpio_num_t pin, uint8_t *data, size_t len)
+{
+  (void)pin;
+  memset(data, 0xff, len);
+}
+
+/****************************************************************************
+ * Name: maia_onewire_crc8
+ *
+ * Description:
+ *   Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1, reflected), bitwise.
+ *
+ ****************************************************************************/
+
+uint8_t maia_onewire_crc8(const uint8_t *data, uint8_t len)
+{
+  uint8_t crc = 0;
+
+  for (uint8_t i = 0; i < len; i++)
+    {
+      crc ^= data[i];
+      for (int b = 0; b < 8; b++)
+        {
+          crc = (crc & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+        }
+    }
+
+  return crc;
+}
+
+/****************************************************************************
+ * Name: maia_pm_*
+ *
+ * Description:
+ *   No sleep and no DFS on the host: all uptime counts as awake.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_pm_init(void)
+{
+  g_pm_init_us = esp_timer_get_time();
+  return ESP_OK;
+}
+
+esp_err_t maia_pm_wake_enable(gpio_num_t pin, int level)
+{
+  (void)pin;
+  (void)level;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void maia_pm_busy_acquire(void)
+{
+}
+
+void maia_pm_busy_release(void)
+{
+}
+
+void maia_pm_get_stats(maia_pm_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  stats->uptime_us = esp_timer_get_time() - g_pm_init_us;
+}
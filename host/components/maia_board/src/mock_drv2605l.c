@@ -0,0 +1,188 @@
+/****************************************************************************
+ * host/components/maia_board/src/mock_drv2605l.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * DRV2605L model: auto-incrementing register file. GO clears as soon as
+ * it is set (effects and auto-calibration complete at once, diagnostics
+ * pass), and GO triggers and RTP updates are counted.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board_mock.h"
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DRV_NB_REGS                 0x23
+
+#define DRV_REG_STATUS              0x00
+#define DRV_REG_MODE                0x01
+#define DRV_REG_RTPIN               0x02
+#define DRV_REG_GO                  0x0c
+
+#define DRV_STATUS_RESET            0xe0  /* Device ID 7 (DRV2605L) */
+#define DRV_MODE_RESET              0x40  /* Standby */
+#define DRV_MODE_DEV_RESET          0x80
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  uint8_t regs[DRV_NB_REGS];
+  uint8_t ptr;                      /* Register pointer */
+  mock_drv2605l_stats_t stats;
+} mock_drv2605l_t;
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static esp_err_t mock_drv2605l_write(void *ctx, const uint8_t *data,
+                                     size_t len);
+static esp_err_t mock_drv2605l_read(void *ctx, uint8_t *data, size_t len);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static mock_drv2605l_t g_drv;
+
+static const mock_i2c_model_t g_model =
+{
+  .name = "drv2605l",
+  .addr = CONFIG_MAIA_DRV2605L_I2C_ADDR,
+  .write = mock_drv2605l_write,
+  .read = mock_drv2605l_read,
+  .ctx = &g_drv,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_drv2605l_reset
+ ****************************************************************************/
+
+static void mock_drv2605l_reset(mock_drv2605l_t *d)
+{
+  memset(d->regs, 0, sizeof(d->regs));
+  d->regs[DRV_REG_STATUS] = DRV_STATUS_RESET;
+  d->regs[DRV_REG_MODE] = DRV_MODE_RESET;
+}
+
+/****************************************************************************
+ * Name: mock_drv2605l_store
+ ****************************************************************************/
+
+static void mock_drv2605l_store(mock_drv2605l_t *d, uint8_t reg,
+                                uint8_t value)
+{
+  switch (reg)
+    {
+      case DRV_REG_STATUS:
+        return;                     /* Read only */
+
+      case DRV_REG_MODE:
+        if (value & DRV_MODE_DEV_RESET)
+          {
+            mock_drv2605l_reset(d);
+            return;
+          }
+
+        d->stats.mode = value;
+        break;
+
+      case DRV_REG_RTPIN:
+        d->stats.rtp_writes++;
+        d->stats.rtp = value;
+        break;
+
+      case DRV_REG_GO:
+        if (value & 1)
+          {
+            d->stats.go++;
+          }
+
+        value = 0;                  /* Playback done at once */
+        break;
+
+      default:
+        break;
+    }
+
+  d->regs[reg] = value;
+}
+
+/****************************************************************************
+ * Name: mock_drv2605l_write
+ ****************************************************************************/
+
+static esp_err_t mock_drv2605l_write(void *ctx, const uint8_t *data,
+                                     size_t len)
+{
+  mock_drv2605l_t *d = ctx;
+
+  if (len == 0 || data[0] >= DRV_NB_REGS)
+    {
+      return ESP_FAIL;
+    }
+
+  d->ptr = data[0];
+  for (size_t i = 1; i < len; i++)
+    {
+      mock_drv2605l_store(d, d->ptr, data[i]);
+      d->ptr = (d->ptr + 1) % DRV_NB_REGS;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: mock_drv2605l_read
+ ****************************************************************************/
+
+static esp_err_t mock_drv2605l_read(void *ctx, uint8_t *data, size_t len)
+{
+  mock_drv2605l_t *d = ctx;
+
+  for (size_t i = 0; i < len; i++)
+    {
+      data[i] = d->regs[d->ptr];
+      d->ptr = (d->ptr + 1) % DRV_NB_REGS;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_drv2605l_attach
+ ****************************************************************************/
+
+esp_err_t mock_drv2605l_attach(void)
+{
+  mock_drv2605l_reset(&g_drv);
+  return mock_i2c_attach(&g_model);
+}
+
+/****************************************************************************
+ * Name: mock_drv2605l_get_stats
+ ****************************************************************************/
+
+void mock_drv2605l_get_stats(mock_drv2605l_stats_t *stats)
+{
+  *stats = g_drv.stats;
+}
@@ -0,0 +1,528 @@
+/****************************************************************************
+ * host/components/maia_board/src/mock_i2c.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Simulated I2C bus behind the maia_i2c_* API. One mutex stands in for
+ * the arbiters of both buses (no lanes: transfers never wait on the
+ * wire); a device only keeps its bus for the default clock. Each
+ * transfer is handed to the model at the device address, and the time
+ * it would hold a real bus (9 clocks per byte plus start, address and
+ * stop) is accounted as busy time, so the per-device statistics keep
+ * their on-target meaning.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board_mock.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <inttypes.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[MOCK_I2C]"
+
+#define MOCK_I2C_PREFIX_MAX         4
+#define MOCK_I2C_SPLIT_SIZE         CONFIG_MAIA_I2C_SPLIT_SIZE
+#define MOCK_I2C_BUF_MAX            (MOCK_I2C_PREFIX_MAX + 1024)
+
+/* Start + address + stop, and the repeated start of a write-read */
+
+#define MOCK_I2C_FRAME_CLOCKS       11
+#define MOCK_I2C_BYTE_CLOCKS        9
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct maia_i2c_dev_s
+{
+  bool in_use;
+  const char *name;
+  uint16_t addr;
+  maia_i2c_bus_t bus;
+  uint32_t scl_hz;
+  bool splittable;
+  maia_i2c_stats_t stats;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static SemaphoreHandle_t g_bus = NULL;
+
+/* Everything below is protected by g_bus */
+
+static struct maia_i2c_dev_s g_devices[MAIA_I2C_MAX_DEVICES];
+static const mock_i2c_model_t *g_models[MAIA_I2C_MAX_DEVICES];
+static uint64_t g_busy_us = 0;
+static int64_t g_stats_since_us = 0;
+static uint8_t g_buf[MOCK_I2C_BUF_MAX];
+
+/* Placeholder bus handle: only compared against NULL by callers */
+
+static uint8_t g_bus_handle;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_i2c_model
+ ****************************************************************************/
+
+static const mock_i2c_model_t *mock_i2c_model(uint16_t addr)
+{
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES; i++)
+    {
+      if (g_models[i] != NULL && g_models[i]->addr == addr)
+        {
+          return g_models[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mock_i2c_account
+ *
+ * Description:
+ *   Statistics of one transfer, its bus time derived from the byte
+ *   count at the device clock (g_bus held).
+ *
+ ****************************************************************************/
+
+static void mock_i2c_account(struct maia_i2c_dev_s *dev, esp_err_t ret,
+                             size_t bytes, bool restart)
+{
+  uint64_t clocks = MOCK_I2C_FRAME_CLOCKS * (restart ? 2 : 1) +
+                    (uint64_t)bytes * MOCK_I2C_BYTE_CLOCKS;
+  uint64_t us = clocks * 1000000 / dev->scl_hz;
+
+  if (ret == ESP_OK)
+    {
+      dev->stats.transactions++;
+      dev->stats.bytes += bytes;
+    }
+  else
+    {
+      dev->stats.errors++;
+    }
+
+  dev->stats.busy_us += us;
+  g_busy_us += us;
+}
+
+/****************************************************************************
+ * Name: mock_i2c_write
+ *
+ * Description:
+ *   One write transaction to the device model (g_bus held).
+ *
+ ****************************************************************************/
+
+static esp_err_t mock_i2c_write(struct maia_i2c_dev_s *dev,
+                                const uint8_t *data, size_t len)
+{
+  const mock_i2c_model_t *m = mock_i2c_model(dev->addr);
+  esp_err_t ret;
+
+  ret = (m != NULL && m->write != NULL) ? m->write(m->ctx, data, len) :
+                                          ESP_FAIL;
+  mock_i2c_account(dev, ret, len, false);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mock_i2c_take
+ ****************************************************************************/
+
+static esp_err_t mock_i2c_take(struct maia_i2c_dev_s *dev, int timeout_ms)
+{
+  if (xSemaphoreTake(g_bus, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+    {
+      dev->stats.timeouts++;
+      return ESP_ERR_TIMEOUT;
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: maia_i2c_init
+ ****************************************************************************/
+
+esp_err_t maia_i2c_init(void)
+{
+  if (g_bus != NULL)
+    {
+      return ESP_OK;
+    }
+
+  g_bus = xSemaphoreCreateMutex();
+  if (g_bus == NULL)
+    {
+      return ESP_ERR_NO_MEM;
+    }
+
+  g_stats_since_us = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "Simulated I2C bus (%d Hz)", MAIA_I2C_FREQ_HZ);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_bus_handle
+ ****************************************************************************/
+
+i2c_master_bus_handle_t maia_i2c_get_bus_handle(maia_i2c_bus_t bus)
+{
+  return g_bus != NULL && bus < MAIA_I2C_BUS_COUNT ?
+         (i2c_master_bus_handle_t)&g_bus_handle : NULL;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_bus_freq
+ ****************************************************************************/
+
+uint32_t maia_i2c_get_bus_freq(maia_i2c_bus_t bus)
+{
+#ifdef CONFIG_MAIA_I2C_BUS1_ENABLE
+  if (bus == MAIA_I2C_BUS_1)
+    {
+      return MAIA_I2C1_FREQ_HZ;
+    }
+#endif
+
+  return bus == MAIA_I2C_BUS_0 ? MAIA_I2C_FREQ_HZ : 0;
+}
+
+/****************************************************************************
+ * Name: mock_i2c_attach
+ ****************************************************************************/
+
+esp_err_t mock_i2c_attach(const mock_i2c_model_t *model)
+{
+  esp_err_t ret = ESP_ERR_NO_MEM;
+
+  if (model == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_bus == NULL)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  xSemaphoreTake(g_bus, portMAX_DELAY);
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES; i++)
+    {
+      if (g_models[i] == NULL)
+        {
+          g_models[i] = model;
+          ret = ESP_OK;
+          break;
+        }
+    }
+
+  xSemaphoreGive(g_bus);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_add_device
+ ****************************************************************************/
+
+esp_err_t maia_i2c_add_device(const maia_i2c_dev_config_t *config,
+                              maia_i2c_dev_handle_t *dev)
+{
+  struct maia_i2c_dev_s *slot = NULL;
+
+  if (config == NULL || dev == NULL || config->prio >= MAIA_I2C_PRIO_COUNT ||
+      config->bus >= MAIA_I2C_BUS_COUNT)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  if (g_bus == NULL || maia_i2c_get_bus_freq(config->bus) == 0)
+    {
+      ESP_LOGE(TAG, "I2C bus %d not initialized", config->bus);
+      return ESP_ERR_INVALID_STATE;
+    }
+
+  xSemaphoreTake(g_bus, portMAX_DELAY);
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES; i++)
+    {
+      if (!g_devices[i].in_use)
+        {
+          slot = &g_devices[i];
+          memset(slot, 0, sizeof(*slot));
+          slot->in_use = true;
+          slot->name = config->name ? config->name : "?";
+          slot->addr = config->addr;
+          slot->bus = config->bus;
+          slot->scl_hz = config->scl_speed_hz ? config->scl_speed_hz :
+                         maia_i2c_get_bus_freq(config->bus);
+          slot->splittable = config->splittable;
+          break;
+        }
+    }
+
+  xSemaphoreGive(g_bus);
+
+  if (slot == NULL)
+    {
+      ESP_LOGE(TAG, "No free device slot for %s", config->name);
+      return ESP_ERR_NO_MEM;
+    }
+
+  *dev = slot;
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_remove_device
+ ****************************************************************************/
+
+esp_err_t maia_i2c_remove_device(maia_i2c_dev_handle_t dev)
+{
+  if (dev == NULL || !dev->in_use)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  xSemaphoreTake(g_bus, portMAX_DELAY);
+  dev->in_use = false;
+  xSemaphoreGive(g_bus);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_transmit
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit(maia_i2c_dev_handle_t dev, const uint8_t *data,
+                            size_t len, int timeout_ms)
+{
+  esp_err_t ret;
+
+  if (dev == NULL || !dev->in_use)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  ret = mock_i2c_take(dev, timeout_ms);
+  if (ret == ESP_OK)
+    {
+      ret = mock_i2c_write(dev, data, len);
+      xSemaphoreGive(g_bus);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_transmit_prefixed
+ *
+ * Description:
+ *   Same chunking as on target: the model sees each chunk as its own
+ *   transaction starting with the prefix.
+ *
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit_prefixed(maia_i2c_dev_handle_t dev,
+                                     const uint8_t *prefix,
+                                     size_t prefix_len,
+                                     const uint8_t *data, size_t len,
+                                     int timeout_ms)
+{
+  esp_err_t ret = ESP_OK;
+  size_t chunk;
+
+  if (dev == NULL || !dev->in_use || prefix_len > MOCK_I2C_PREFIX_MAX)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  chunk = dev->splittable ? MOCK_I2C_SPLIT_SIZE : len;
+  if (chunk > MOCK_I2C_BUF_MAX - MOCK_I2C_PREFIX_MAX)
+    {
+      chunk = MOCK_I2C_BUF_MAX - MOCK_I2C_PREFIX_MAX;
+    }
+
+  do
+    {
+      size_t n = (len > chunk) ? chunk : len;
+
+      ret = mock_i2c_take(dev, timeout_ms);
+      if (ret != ESP_OK)
+        {
+          break;
+        }
+
+      memcpy(g_buf, prefix, prefix_len);
+      memcpy(g_buf + prefix_len, data, n);
+      ret = mock_i2c_write(dev, g_buf, prefix_len + n);
+      xSemaphoreGive(g_bus);
+
+      data += n;
+      len -= n;
+    }
+  while (ret == ESP_OK && len > 0);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_transmit_receive
+ ****************************************************************************/
+
+esp_err_t maia_i2c_transmit_receive(maia_i2c_dev_handle_t dev,
+                                    const uint8_t *wr_data, size_t wr_len,
+                                    uint8_t *rd_data, size_t rd_len,
+                                    int timeout_ms)
+{
+  const mock_i2c_model_t *m;
+  esp_err_t ret;
+
+  if (dev == NULL || !dev->in_use)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  ret = mock_i2c_take(dev, timeout_ms);
+  if (ret != ESP_OK)
+    {
+      return ret;
+    }
+
+  m = mock_i2c_model(dev->addr);
+  ret = ESP_FAIL;
+  if (m != NULL && m->write != NULL && m->read != NULL)
+    {
+      ret = m->write(m->ctx, wr_data, wr_len);
+      if (ret == ESP_OK)
+        {
+          ret = m->read(m->ctx, rd_data, rd_len);
+        }
+    }
+
+  mock_i2c_account(dev, ret, wr_len + rd_len, true);
+  xSemaphoreGive(g_bus);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_stats
+ ****************************************************************************/
+
+esp_err_t maia_i2c_get_stats(maia_i2c_dev_handle_t dev,
+                             maia_i2c_stats_t *stats)
+{
+  if (dev == NULL || stats == NULL)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+
+  xSemaphoreTake(g_bus, portMAX_DELAY);
+  *stats = dev->stats;
+  xSemaphoreGive(g_bus);
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_get_all_stats
+ ****************************************************************************/
+
+size_t maia_i2c_get_all_stats(maia_i2c_dev_stats_t *out, size_t max)
+{
+  size_t n = 0;
+
+  if (g_bus == NULL)
+    {
+      return 0;
+    }
+
+  xSemaphoreTake(g_bus, portMAX_DELAY);
+  for (int i = 0; i < MAIA_I2C_MAX_DEVICES && n < max; i++)
+    {
+      struct maia_i2c_dev_s *dev = &g_devices[i];
+
+      if (dev->in_use)
+        {
+          out[n].name = dev->name;
+          out[n].addr = dev->addr;
+          out[n].bus = dev->bus;
+          out[n].stats = dev->stats;
+          n++;
+        }
+    }
+
+  xSemaphoreGive(g_bus);
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: maia_i2c_log_stats
+ *
+ * Description:
+ *   Simulated bus time per device since the previous call (wall clock
+ *   window, so under free running the utilization can exceed 100 %).
+ *
+ ****************************************************************************/
+
+void maia_i2c_log_stats(void)
+{
+  maia_i2c_dev_stats_t devs[MAIA_I2C_MAX_DEVICES];
+  int64_t now = esp_timer_get_time();
+  int64_t window_us;
+  uint64_t busy_us;
+  size_t n;
+
+  xSemaphoreTake(g_bus, portMAX_DELAY);
+  busy_us = g_busy_us;
+  g_busy_us = 0;
+  window_us = now - g_stats_since_us;
+  g_stats_since_us = now;
+  xSemaphoreGive(g_bus);
+
+  ESP_LOGI(TAG, "Bus utilization: %" PRIu32 "%% over %lld ms",
+           (uint32_t)(busy_us * 100 / (window_us ? window_us : 1)),
+           (long long)(window_us / 1000));
+
+  n = maia_i2c_get_all_stats(devs, MAIA_I2C_MAX_DEVICES);
+  for (size_t i = 0; i < n; i++)
+    {
+      const maia_i2c_stats_t *st = &devs[i].stats;
+
+      ESP_LOGI(TAG, "  %-8s %d:0x%02X tx=%" PRIu32 " bytes=%" PRIu32
+               " busy=%llu ms err=%" PRIu32, devs[i].name, devs[i].bus,
+               devs[i].addr,
+               st->transactions, st->bytes,
+               (unsigned long long)(st->busy_us / 1000), st->errors);
+    }
+}
@@ -0,0 +1,252 @@
+/****************************************************************************
+ * host/components/maia_board/src/mock_ssd1306.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * SSD1306 model: command parser (arguments may arrive in later
+ * transactions, as single commands do) and GDDRAM written through the
+ * COLUMN_ADDR / PAGE_ADDR window in horizontal addressing mode.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board_mock.h"
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SSD_WIDTH                   CONFIG_MAIA_SSD1306_WIDTH
+#define SSD_PAGES                   (CONFIG_MAIA_SSD1306_HEIGHT / 8)
+
+#define SSD_CTRL_CO                 0x80  /* Continuation bit */
+#define SSD_CTRL_DC                 0x40  /* Data / command */
+
+#define SSD_CMD_COLUMN_ADDR         0x21
+#define SSD_CMD_PAGE_ADDR           0x22
+#define SSD_CMD_DISPLAY_OFF         0xae
+#define SSD_CMD_DISPLAY_ON          0xaf
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  uint8_t gddram[SSD_PAGES * SSD_WIDTH];
+  uint8_t cmd;                      /* Command waiting for arguments */
+  uint8_t args[6];
+  uint8_t nargs;                    /* Received */
+  uint8_t need;                     /* Expected */
+  uint8_t col0;                     /* Window */
+  uint8_t col1;
+  uint8_t page0;
+  uint8_t page1;
+  uint8_t col;                      /* Write pointer */
+  uint8_t page;
+  mock_ssd1306_stats_t stats;
+} mock_ssd1306_t;
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static esp_err_t mock_ssd1306_write(void *ctx, const uint8_t *data,
+                                    size_t len);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static mock_ssd1306_t g_ssd =
+{
+  .col1 = SSD_WIDTH - 1,
+  .page1 = SSD_PAGES - 1,
+};
+
+static const mock_i2c_model_t g_model =
+{
+  .name = "ssd1306",
+  .addr = CONFIG_MAIA_SSD1306_I2C_ADDR,
+  .write = mock_ssd1306_write,
+  .ctx = &g_ssd,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_ssd1306_nargs
+ *
+ * Description:
+ *   Argument bytes following a command (datasheet command table).
+ *
+ ****************************************************************************/
+
+static uint8_t mock_ssd1306_nargs(uint8_t cmd)
+{
+  switch (cmd)
+    {
+      case 0x20: case 0x81: case 0x8d: case 0xa8: case 0xd3:
+      case 0xd5: case 0xd9: case 0xda: case 0xdb:
+        return 1;
+      case SSD_CMD_COLUMN_ADDR: case SSD_CMD_PAGE_ADDR: case 0xa3:
+        return 2;
+      case 0x29: case 0x2a:
+        return 5;
+      case 0x26: case 0x27:
+        return 6;
+      default:
+        return 0;
+    }
+}
+
+/****************************************************************************
+ * Name: mock_ssd1306_execute
+ ****************************************************************************/
+
+static void mock_ssd1306_execute(mock_ssd1306_t *s)
+{
+  switch (s->cmd)
+    {
+      case SSD_CMD_COLUMN_ADDR:
+        s->col0 = s->args[0] % SSD_WIDTH;
+        s->col1 = s->args[1] % SSD_WIDTH;
+        s->col = s->col0;
+        break;
+
+      case SSD_CMD_PAGE_ADDR:
+        s->page0 = s->args[0] % SSD_PAGES;
+        s->page1 = s->args[1] % SSD_PAGES;
+        s->page = s->page0;
+        break;
+
+      case SSD_CMD_DISPLAY_OFF:
+        s->stats.display_on = false;
+        break;
+
+      case SSD_CMD_DISPLAY_ON:
+        s->stats.display_on = true;
+        break;
+
+      default:
+        break;
+    }
+}
+
+/****************************************************************************
+ * Name: mock_ssd1306_command
+ ****************************************************************************/
+
+static void mock_ssd1306_command(mock_ssd1306_t *s, uint8_t b)
+{
+  s->stats.commands++;
+
+  if (s->nargs < s->need)
+    {
+      s->args[s->nargs++] = b;
+    }
+  else
+    {
+      s->cmd = b;
+      s->nargs = 0;
+      s->need = mock_ssd1306_nargs(b);
+    }
+
+  if (s->nargs == s->need)
+    {
+      mock_ssd1306_execute(s);
+    }
+}
+
+/****************************************************************************
+ * Name: mock_ssd1306_data
+ *
+ * Description:
+ *   One GDDRAM byte, the pointer wrapping inside the window.
+ *
+ ****************************************************************************/
+
+static void mock_ssd1306_data(mock_ssd1306_t *s, uint8_t b)
+{
+  s->gddram[s->page * SSD_WIDTH + s->col] = b;
+  s->stats.data_bytes++;
+
+  if (s->col++ >= s->col1)
+    {
+      s->col = s->col0;
+      s->page = s->page >= s->page1 ? s->page0 : s->page + 1;
+    }
+}
+
+/****************************************************************************
+ * Name: mock_ssd1306_write
+ ****************************************************************************/
+
+static esp_err_t mock_ssd1306_write(void *ctx, const uint8_t *data,
+                                    size_t len)
+{
+  mock_ssd1306_t *s = ctx;
+  size_t i = 0;
+
+  /* Control byte: Co = 1 means one byte follows, then a new control
+   * byte; Co = 0 means the rest of the transaction is of one kind
+   */
+
+  while (i < len)
+    {
+      uint8_t ctrl = data[i++];
+      bool is_data = (ctrl & SSD_CTRL_DC) != 0;
+      size_t end = (ctrl & SSD_CTRL_CO) ? i + 1 : len;
+
+      for (; i < end && i < len; i++)
+        {
+          if (is_data)
+            {
+              mock_ssd1306_data(s, data[i]);
+            }
+          else
+            {
+              mock_ssd1306_command(s, data[i]);
+            }
+        }
+    }
+
+  return ESP_OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mock_ssd1306_attach
+ ****************************************************************************/
+
+esp_err_t mock_ssd1306_attach(void)
+{
+  return mock_i2c_attach(&g_model);
+}
+
+/****************************************************************************
+ * Name: mock_ssd1306_get_gddram
+ ****************************************************************************/
+
+const uint8_t *mock_ssd1306_get_gddram(void)
+{
+  return g_ssd.gddram;
+}
+
+/****************************************************************************
+ * Name: mock_ssd1306_get_stats
+ ****************************************************************************/
+
+void mock_ssd1306_get_stats(mock_ssd1306_stats_t *stats)
+{
+  *stats = g_ssd.stats;
+}
@@ -0,0 +1,328 @@
+/****************************************************************************
+ * host/main/host_main.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host harness: runs the sensing path of the firmware on the linux
+ * target against the simulated board. Every tagged frame is logged and
+ * its most urgent sector drives the haptic RTP target, as the sensing
+ * and haptic tasks do on the device. After CONFIG_MAIA_HOST_FRAMES
+ * frames the throughput and the service counters are printed and the
+ * process exits, so a run can be wrapped in perf, valgrind or gprof.
+ *
+ * With MAIA_FLASH_IMAGE set to a flash dump of a device (esptool.py
+ * read_flash), the sessions in its log partition are replayed instead
+ * (trace_replay.h) and the decision digest and stage costs printed.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "maia_board.h"
+#include "maia_board_mock.h"
+#include "data_logger.h"
+#include "haptic_feedback.h"
+#include "obstacle_detection.h"
+#include "trace_replay.h"
+#include <esp_log.h>
+#include <esp_private/partition_linux.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[HOST]"
+
+/* Progress line every this many frames */
+
+#define HOST_REPORT_FRAMES      10000
+
+/* Environment variable naming a flash dump to replay */
+
+#define HOST_IMAGE_ENV          "MAIA_FLASH_IMAGE"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_main_task = NULL;
+static volatile uint32_t g_frames = 0;
+
+static const drv2605l_config_t g_drv_config =
+{
+  .i2c_addr = CONFIG_MAIA_DRV2605L_I2C_ADDR,
+#ifdef CONFIG_MAIA_DRV2605L_ACTUATOR_ERM
+  .actuator = DRV2605L_ACTUATOR_ERM,
+  .library = DRV2605L_LIB_ERM_A,
+#else
+  .actuator = DRV2605L_ACTUATOR_LRA,
+  .library = DRV2605L_LIB_LRA,
+#endif
+  .rated_voltage = CONFIG_MAIA_DRV2605L_RATED_VOLTAGE,
+  .overdrive_clamp = CONFIG_MAIA_DRV2605L_OVERDRIVE_CLAMP,
+  .auto_calibrate = false,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_frame_cb
+ *
+ * Description:
+ *   Obstacle detection task context: log the frame and wake the main
+ *   task, which plays the haptic task's part.
+ *
+ ****************************************************************************/
+
+static void host_frame_cb(const obstacle_frame_t *f, void *arg)
+{
+  (void)arg;
+
+  data_logger_log_tof((uint8_t)f->sensor, f->nb_zones, f->distance_mm,
+                      f->target_status, f->int_time_us);
+
+  g_frames++;
+  xTaskNotifyGive(g_main_task);
+}
+
+/****************************************************************************
+ * Name: host_apply_threat
+ *
+ * Description:
+ *   Same selection as the haptic task: lowest TTC, then nearest.
+ *
+ ****************************************************************************/
+
+static void host_apply_threat(void)
+{
+  obstacle_ttc_t ttc;
+  uint16_t best_ttc = OBSTACLE_TTC_NONE;
+  uint16_t best_mm = UINT16_MAX;
+
+  if (obstacle_detection_get_ttc(&ttc) != ESP_OK)
+    {
+      return;
+    }
+
+  for (int s = 0; s < OBSTACLE_SECTOR_COUNT; s++)
+    {
+      uint16_t mm = ttc.distance_mm[s] == VL53L5CX_DISTANCE_INVALID ?
+                    UINT16_MAX : (uint16_t)ttc.distance_mm[s];
+
+      if (ttc.ttc_ms[s] < best_ttc ||
+          (ttc.ttc_ms[s] == best_ttc && mm < best_mm))
+        {
+          best_ttc = ttc.ttc_ms[s];
+          best_mm = mm;
+        }
+    }
+
+  haptic_feedback_set_threat(best_mm, best_ttc, 0);
+}
+
+/****************************************************************************
+ * Name: host_report
+ ****************************************************************************/
+
+static void host_report(uint32_t frames, int64_t elapsed_us)
+{
+  obstacle_detection_stats_t od;
+  haptic_feedback_stats_t hf;
+  data_logger_stats_t dl;
+  mock_drv2605l_stats_t drv;
+  vl53l5cx_stats_t tof;
+
+  ESP_LOGI(TAG, "%lu frames in %lld ms: %lu fps",
+           (unsigned long)frames, (long long)(elapsed_us / 1000),
+           (unsigned long)(elapsed_us > 0 ?
+                           (int64_t)frames * 1000000 / elapsed_us : 0));
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      if (vl53l5cx_get_stats(i, &tof) == ESP_OK)
+        {
+          ESP_LOGI(TAG, "ToF %d: %lu frames, %lu dropped", i,
+                   (unsigned long)tof.frames, (unsigned long)tof.dropped);
+        }
+    }
+
+  if (obstacle_detection_get_stats(&od) == ESP_OK)
+    {
+      ESP_LOGI(TAG, "Obstacle: %lu frames, %lu untagged, fusion max %lu "
+               "cycles, track max %lu cycles, filter avg %lu cycles",
+               (unsigned long)od.frames, (unsigned long)od.untagged,
+               (unsigned long)od.fusion_max_cycles,
+               (unsigned long)od.track_max_cycles,
+               (unsigned long)od.filter_avg_cycles);
+    }
+
+  if (data_logger_get_stats(&dl) == ESP_OK)
+    {
+      ESP_LOGI(TAG, "Logger: %lu ToF frames, %lu -> %lu bytes, %lu pages, "
+               "%lu dropped, codec max %lu cycles",
+               (unsigned long)dl.tof_frames,
+               (unsigned long)dl.tof_raw_bytes,
+               (unsigned long)dl.tof_bytes, (unsigned long)dl.pages,
+               (unsigned long)dl.dropped,
+               (unsigned long)dl.codec_max_cycles);
+    }
+
+  if (haptic_feedback_get_stats(&hf) == ESP_OK)
+    {
+      mock_drv2605l_get_stats(&drv);
+      ESP_LOGI(TAG, "Haptic: %lu RTP updates, %lu errors, %lu RTP "
+               "register writes",
+               (unsigned long)hf.rtp_updates, (unsigned long)hf.errors,
+               (unsigned long)drv.rtp_writes);
+    }
+
+  maia_i2c_log_stats();
+  maia_latency_log();
+}
+
+/****************************************************************************
+ * Name: host_decision_cb
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_TRACE_REPLAY_DECISIONS
+static void host_decision_cb(const trace_replay_decision_t *d, void *arg)
+{
+  (void)arg;
+
+  printf("REPLAY,%u,%" PRIu32 ",%" PRIu32 ",%u,%u,%u,%u\n", d->session,
+         d->seq, d->time_ms, d->sensor, d->distance_mm, d->ttc_ms,
+         d->level);
+}
+#endif
+
+/****************************************************************************
+ * Name: host_replay
+ *
+ * Description:
+ *   Replay the log partition of a flash dump. The dump is mapped as the
+ *   emulated flash and is not modified (nothing is logged).
+ *
+ ****************************************************************************/
+
+static void host_replay(const char *image)
+{
+  esp_partition_file_mmap_ctrl_t *ctrl;
+  trace_replay_config_t config =
+    {
+      .session = CONFIG_MAIA_TRACE_REPLAY_SESSION,
+#ifdef CONFIG_MAIA_TRACE_REPLAY_REALTIME
+      .realtime = true,
+#endif
+#ifdef CONFIG_MAIA_TRACE_REPLAY_DECISIONS
+      .callback = host_decision_cb,
+#endif
+    };
+
+  trace_replay_result_t r;
+  esp_err_t ret;
+
+  ctrl = esp_partition_get_file_mmap_ctrl_input();
+  snprintf(ctrl->flash_file_name, sizeof(ctrl->flash_file_name), "%s",
+           image);
+  ctrl->remove_dump = false;
+
+  ESP_ERROR_CHECK(maia_board_init());
+  ESP_ERROR_CHECK(data_logger_init());
+  ESP_ERROR_CHECK(haptic_feedback_init(&g_drv_config));
+
+  ret = trace_replay_run(&config, &r);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Replay of %s failed: %s", image, esp_err_to_name(ret));
+      return;
+    }
+
+  ESP_LOGI(TAG, "%lu sessions, %lu frames (%lu untagged, %lu corrupt, "
+           "%lu without keyframe), %lu s recorded",
+           (unsigned long)r.sessions, (unsigned long)r.frames,
+           (unsigned long)r.untagged, (unsigned long)r.corrupt,
+           (unsigned long)r.no_ref, (unsigned long)(r.span_ms / 1000));
+  ESP_LOGI(TAG, "%lu level changes, digest 0x%08lx, %lld ms",
+           (unsigned long)r.level_changes, (unsigned long)r.digest,
+           (long long)(r.elapsed_us / 1000));
+  ESP_LOGI(TAG, "Cycles avg/max: decode %lu/%lu, detect %lu/%lu, "
+           "haptic %lu/%lu",
+           (unsigned long)r.stages[TRACE_REPLAY_STAGE_DECODE].avg_cycles,
+           (unsigned long)r.stages[TRACE_REPLAY_STAGE_DECODE].max_cycles,
+           (unsigned long)r.stages[TRACE_REPLAY_STAGE_DETECT].avg_cycles,
+           (unsigned long)r.stages[TRACE_REPLAY_STAGE_DETECT].max_cycles,
+           (unsigned long)r.stages[TRACE_REPLAY_STAGE_HAPTIC].avg_cycles,
+           (unsigned long)r.stages[TRACE_REPLAY_STAGE_HAPTIC].max_cycles);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: app_main
+ ****************************************************************************/
+
+void app_main(void)
+{
+  int64_t start_us;
+  uint32_t frames;
+  uint32_t next_report = HOST_REPORT_FRAMES;
+  const char *image = getenv(HOST_IMAGE_ENV);
+  esp_err_t ret;
+
+  if (image != NULL)
+    {
+      host_replay(image);
+      exit(0);
+    }
+
+  g_main_task = xTaskGetCurrentTaskHandle();
+
+  ESP_ERROR_CHECK(maia_board_init());
+
+  ret = data_logger_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Data logger unavailable (%s)", esp_err_to_name(ret));
+    }
+
+  ESP_ERROR_CHECK(haptic_feedback_init(&g_drv_config));
+  ESP_ERROR_CHECK(haptic_feedback_rtp_start());
+
+  obstacle_detection_set_frame_callback(host_frame_cb, NULL);
+
+  start_us = esp_timer_get_time();
+  ESP_ERROR_CHECK(obstacle_detection_init());
+
+  for (;;)
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      host_apply_threat();
+
+      frames = g_frames;
+      if (frames >= next_report)
+        {
+          ESP_LOGI(TAG, "%lu frames", (unsigned long)frames);
+          next_report += HOST_REPORT_FRAMES;
+        }
+
+      if (frames >= CONFIG_MAIA_HOST_FRAMES)
+        {
+          break;
+        }
+    }
+
+  host_report(frames, esp_timer_get_time() - start_us);
+  exit(0);
+}
@@ -72,6 +72,20 @@ void app_main(void)
   test_drv2605l_run();
 #elif defined(CONFIG_MAIA_TEST_DISPLAY)
   test_ssd1306_run();
+#elif defined(CONFIG_MAIA_TEST_TOF)
+  test_vl53l5cx_run();
+#elif defined(CONFIG_MAIA_TEST_IMU)
+  test_mpu6050_run();
+#elif defined(CONFIG_MAIA_TEST_OBSTACLE_FUSION)
+  test_obstacle_fusion_run();
+#elif defined(CONFIG_MAIA_TEST_LOGGER_CODEC)
+  test_data_logger_codec_run();
+#elif defined(CONFIG_MAIA_TEST_POWER)
+  test_power_run();
+#elif defined(CONFIG_MAIA_TEST_BENCHMARK)
+  test_benchmark_run();
+#elif defined(CONFIG_MAIA_TEST_TRACE_REPLAY)
+  test_trace_replay_run();
 #endif
 
 #else
@@ -0,0 +1,853 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_benchmark.c
+ *
+ * Micro-benchmark Suite
+ * Cycle counts of the display flush and glyph paths, haptic issue
+ * latency, OneWire primitives, deferred log writes and ISR-to-task
+ * wake-up, a check that the sensing loop makes no heap allocation and
+ * that its latency holds during a flash write burst, plus the I2C cost
+ * per device and the memory pool peaks over the whole run
+ *
+ * The report lines start with "BENCH" and are comma separated, so two
+ * firmware versions can be compared with grep and a spreadsheet:
+ *
+ *   BENCH_BEGIN,<version>,<cpu MHz>
+ *   BENCH,<name>,<runs>,<min cycles>,<avg cycles>,<max cycles>,<avg ns>
+ *   BENCH_HEAP,<frames>,<heap allocations>
+ *   BENCH_FLASH,<idle frames>,<idle p99 us>,<burst frames>,<burst p99 us>,
+ *               <burst max us>,<writes>
+ *   BENCH_I2C,<device>,<addr>,<transactions>,<bytes>,<avg us>
+ *   BENCH_POOL,<pool>,<blocks>,<block bytes>,<peak>,<failures>
+ *   BENCH_END,<errors>
+ *
+ * The cycle counter is per core: the suite runs in app_main (core 0),
+ * where the GPIO ISR service was installed too. The flash benchmark
+ * overwrites the tail of the session log partition and leaves it erased.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "maia_board.h"
+#include "data_logger.h"
+#include "drv2605l.h"
+#include "obstacle_detection.h"
+#include "ssd1306.h"
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_BENCH]"
+
+#define BENCH_CPU_MHZ         CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+
+#define BENCH_RUNS_FLUSH      20
+#define BENCH_RUNS_GLYPH      5       /* Passes over the ASCII range */
+#define BENCH_RUNS_HAPTIC     20
+#define BENCH_RUNS_ONEWIRE    50
+#define BENCH_RUNS_DLOG       200
+#define BENCH_RUNS_ISR        100
+
+#define BENCH_HAPTIC_EFFECT   1       /* Strong click */
+#define BENCH_HAPTIC_GAP_MS   100     /* Effect played out */
+
+#define BENCH_ONEWIRE_SKIP    0xcc    /* SKIP ROM */
+#define BENCH_ONEWIRE_READ    0xbe    /* READ SCRATCHPAD */
+#define BENCH_ONEWIRE_LEN     9
+
+#define BENCH_HEAP_FRAMES     60      /* Both sensors, about 2 s */
+#define BENCH_HEAP_WAIT_MS    10000   /* Bring-up, then the window */
+
+/* Flash burst: page programs paced through the window, into erased
+ * sectors at the end of the log partition (erased before and after)
+ */
+
+#define BENCH_FLASH_FRAMES    30      /* Per window */
+#define BENCH_FLASH_SECTORS   32      /* 128 KB, 512 programs */
+#define BENCH_FLASH_CHUNK     256     /* One page program */
+#define BENCH_FLASH_GAP_MS    5
+#define BENCH_FLASH_SLACK_US  1024    /* p99 growth allowed, 4 buckets */
+
+#define BENCH_MAX_I2C         8
+#define BENCH_MAX_POOLS       8
+
+/* The status LED pin loops its own output back to its input: driving it
+ * high raises the GPIO interrupt without any wiring
+ */
+
+#define BENCH_ISR_PIN         MAIA_GPIO_LED_STATUS
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef struct
+{
+  const char *name;
+  uint32_t runs;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+} bench_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint32_t g_errors = 0;
+
+/* Tasks of the sensing loop (the IMU reader is optional) */
+
+static const char *const g_heap_tasks[] =
+{
+  "tof_reader", "imu_reader", "obstacle",
+};
+
+static TaskHandle_t g_isr_task = NULL;
+static volatile uint32_t g_isr_cycles = 0;
+
+#ifdef CONFIG_MAIA_DRV2605L_ENABLE
+
+/* No auto-calibration: only the I2C issue path is timed */
+
+static const drv2605l_config_t g_drv_config =
+{
+  .i2c_addr = CONFIG_MAIA_DRV2605L_I2C_ADDR,
+#ifdef CONFIG_MAIA_DRV2605L_ACTUATOR_ERM
+  .actuator = DRV2605L_ACTUATOR_ERM,
+  .library = DRV2605L_LIB_ERM_A,
+#else
+  .actuator = DRV2605L_ACTUATOR_LRA,
+  .library = DRV2605L_LIB_LRA,
+#endif
+  .rated_voltage = CONFIG_MAIA_DRV2605L_RATED_VOLTAGE,
+  .overdrive_clamp = CONFIG_MAIA_DRV2605L_OVERDRIVE_CLAMP,
+  .auto_calibrate = false,
+};
+
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bench_init / bench_add / bench_report
+ *
+ * Description:
+ *   Accumulate cycle samples of one benchmark and print its line.
+ *
+ ****************************************************************************/
+
+static void bench_init(bench_t *b, const char *name)
+{
+  memset(b, 0, sizeof(*b));
+  b->name = name;
+  b->min = UINT32_MAX;
+}
+
+static void bench_add(bench_t *b, uint32_t cycles)
+{
+  b->runs++;
+  b->total += cycles;
+  b->min = cycles < b->min ? cycles : b->min;
+  b->max = cycles > b->max ? cycles : b->max;
+}
+
+static void bench_report(const bench_t *b)
+{
+  uint32_t avg;
+
+  if (b->runs == 0)
+    {
+      printf("BENCH,%s,0,0,0,0,0\n", b->name);
+      return;
+    }
+
+  avg = (uint32_t)(b->total / b->runs);
+  printf("BENCH,%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%"
+         PRIu32 "\n", b->name, b->runs, b->min, avg, b->max,
+         (uint32_t)((uint64_t)avg * 1000 / BENCH_CPU_MHZ));
+}
+
+#ifdef CONFIG_MAIA_SSD1306_ENABLE
+
+/****************************************************************************
+ * Name: bench_display
+ *
+ * Description:
+ *   Full flush (every byte changed, all pages dirty), partial flush
+ *   (one glyph changed) and glyph rendering into the framebuffer.
+ *
+ ****************************************************************************/
+
+static void bench_display(void)
+{
+  static uint8_t fb[2][SSD1306_BUFFER_SIZE];
+  bench_t b;
+  uint32_t c0;
+
+  if (ssd1306_init() != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: SSD1306 init");
+      g_errors++;
+      return;
+    }
+
+  memset(fb[0], 0x55, sizeof(fb[0]));
+  memset(fb[1], 0xaa, sizeof(fb[1]));
+
+  bench_init(&b, "display_full");
+  for (int i = 0; i < BENCH_RUNS_FLUSH; i++)
+    {
+      ssd1306_load_framebuffer(fb[i & 1]);
+      c0 = esp_cpu_get_cycle_count();
+      g_errors += ssd1306_display() != ESP_OK;
+      g_errors += ssd1306_display_wait() != ESP_OK;
+      bench_add(&b, esp_cpu_get_cycle_count() - c0);
+    }
+
+  bench_report(&b);
+
+  ssd1306_clear();
+  ssd1306_display();
+  ssd1306_display_wait();
+
+  bench_init(&b, "display_partial");
+  for (int i = 0; i < BENCH_RUNS_FLUSH; i++)
+    {
+      ssd1306_draw_char(0, 0, (i & 1) ? 'A' : 'V', SSD1306_FONT_SMALL);
+      c0 = esp_cpu_get_cycle_count();
+      g_errors += ssd1306_display() != ESP_OK;
+      g_errors += ssd1306_display_wait() != ESP_OK;
+      bench_add(&b, esp_cpu_get_cycle_count() - c0);
+    }
+
+  bench_report(&b);
+
+  /* Glyphs only, no flush: per character over the printable range */
+
+  for (int font = SSD1306_FONT_SMALL; font <= SSD1306_FONT_LARGE; font++)
+    {
+      bench_init(&b, font == SSD1306_FONT_SMALL ? "glyph_5x8" :
+                                                  "glyph_8x16");
+      for (int i = 0; i < BENCH_RUNS_GLYPH; i++)
+        {
+          for (char ch = 0x20; ch <= 0x7e; ch++)
+            {
+              c0 = esp_cpu_get_cycle_count();
+              ssd1306_draw_char(i * 9, 0, ch, (ssd1306_font_t)font);
+              bench_add(&b, esp_cpu_get_cycle_count() - c0);
+            }
+        }
+
+      bench_report(&b);
+    }
+
+  ssd1306_clear();
+  ssd1306_display();
+  ssd1306_display_wait();
+}
+
+#endif /* CONFIG_MAIA_SSD1306_ENABLE */
+
+#ifdef CONFIG_MAIA_DRV2605L_ENABLE
+
+/****************************************************************************
+ * Name: bench_haptic
+ *
+ * Description:
+ *   Time from the call to the GO write acknowledged.
+ *
+ ****************************************************************************/
+
+static void bench_haptic(void)
+{
+  bench_t b;
+  uint32_t c0;
+
+  if (drv2605l_init(&g_drv_config) != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: DRV2605L init");
+      g_errors++;
+      return;
+    }
+
+  bench_init(&b, "haptic_play_effect");
+  for (int i = 0; i < BENCH_RUNS_HAPTIC; i++)
+    {
+      c0 = esp_cpu_get_cycle_count();
+      g_errors += drv2605l_play_effect(BENCH_HAPTIC_EFFECT) != ESP_OK;
+      bench_add(&b, esp_cpu_get_cycle_count() - c0);
+      vTaskDelay(pdMS_TO_TICKS(BENCH_HAPTIC_GAP_MS));
+    }
+
+  drv2605l_stop();
+  bench_report(&b);
+}
+
+#endif /* CONFIG_MAIA_DRV2605L_ENABLE */
+
+#ifdef CONFIG_MAIA_DS18B20_ENABLE
+
+/****************************************************************************
+ * Name: bench_onewire
+ *
+ * Description:
+ *   Reset pulse, one byte each way and the scratchpad CRC. Bytes are
+ *   timed inside a SKIP ROM / READ SCRATCHPAD exchange, so the sensor
+ *   answers as it does in service (one sensor on the bus).
+ *
+ ****************************************************************************/
+
+static void bench_onewire(void)
+{
+  uint8_t data[BENCH_ONEWIRE_LEN];
+  bench_t reset;
+  bench_t wr;
+  bench_t rd;
+  bench_t crc;
+  uint32_t c0;
+  uint8_t sum = 0;
+
+  bench_init(&reset, "onewire_reset");
+  bench_init(&wr, "onewire_write_byte");
+  bench_init(&rd, "onewire_read_byte");
+  bench_init(&crc, "onewire_crc8");
+
+  for (int i = 0; i < BENCH_RUNS_ONEWIRE; i++)
+    {
+      c0 = esp_cpu_get_cycle_count();
+      if (!maia_onewire_reset(MAIA_GPIO_ONEWIRE))
+        {
+          ESP_LOGE(TAG, "✗ FAILED: No OneWire presence pulse");
+          g_errors++;
+          break;
+        }
+
+      bench_add(&reset, esp_cpu_get_cycle_count() - c0);
+
+      c0 = esp_cpu_get_cycle_count();
+      maia_onewire_write_byte(MAIA_GPIO_ONEWIRE, BENCH_ONEWIRE_SKIP);
+      bench_add(&wr, esp_cpu_get_cycle_count() - c0);
+      maia_onewire_write_byte(MAIA_GPIO_ONEWIRE, BENCH_ONEWIRE_READ);
+
+      for (int j = 0; j < BENCH_ONEWIRE_LEN; j++)
+        {
+          c0 = esp_cpu_get_cycle_count();
+          data[j] = maia_onewire_read_byte(MAIA_GPIO_ONEWIRE);
+          bench_add(&rd, esp_cpu_get_cycle_count() - c0);
+        }
+
+      c0 = esp_cpu_get_cycle_count();
+      sum |= maia_onewire_crc8(data, BENCH_ONEWIRE_LEN);
+      bench_add(&crc, esp_cpu_get_cycle_count() - c0);
+    }
+
+  /* CRC over a scratchpad including its CRC byte is 0 */
+
+  if (sum != 0)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Scratchpad CRC errors");
+      g_errors++;
+    }
+
+  bench_report(&reset);
+  bench_report(&wr);
+  bench_report(&rd);
+  bench_report(&crc);
+}
+
+#endif /* CONFIG_MAIA_DS18B20_ENABLE */
+
+#if MAIA_DLOG_LEVEL > 0
+
+/****************************************************************************
+ * Name: bench_dlog
+ *
+ * Description:
+ *   Cost of a deferred log call (two arguments), kept under the ring
+ *   depth so nothing is dropped. Written at debug level, so the log
+ *   task formats it but the console filters it out.
+ *
+ ****************************************************************************/
+
+static void bench_dlog(void)
+{
+  bench_t b;
+  uint32_t args[2];
+  uint32_t c0;
+
+  bench_init(&b, "dlog_write");
+  for (int i = 0; i < BENCH_RUNS_DLOG; i++)
+    {
+      c0 = esp_cpu_get_cycle_count();
+      args[0] = i;
+      args[1] = BENCH_RUNS_DLOG;
+      maia_dlog_write(4, TAG, "bench %d of %d", args, 2);
+      bench_add(&b, esp_cpu_get_cycle_count() - c0);
+
+      if ((i & 15) == 15)
+        {
+          vTaskDelay(1);
+        }
+    }
+
+  bench_report(&b);
+}
+
+#endif /* MAIA_DLOG_LEVEL > 0 */
+
+/****************************************************************************
+ * Name: bench_isr_handler
+ ****************************************************************************/
+
+static void IRAM_ATTR bench_isr_handler(void *arg)
+{
+  BaseType_t woken = pdFALSE;
+
+  (void)arg;
+  g_isr_cycles = esp_cpu_get_cycle_count();
+  vTaskNotifyGiveFromISR(g_isr_task, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+/****************************************************************************
+ * Name: bench_isr
+ *
+ * Description:
+ *   Edge to handler entry, and handler to the notified task running.
+ *
+ ****************************************************************************/
+
+static void bench_isr(void)
+{
+  bench_t entry;
+  bench_t wake;
+  uint32_t c0;
+  uint32_t c1;
+
+  g_isr_task = xTaskGetCurrentTaskHandle();
+
+  gpio_set_level(BENCH_ISR_PIN, 0);
+  if (gpio_set_direction(BENCH_ISR_PIN, GPIO_MODE_INPUT_OUTPUT) != ESP_OK ||
+      gpio_set_intr_type(BENCH_ISR_PIN, GPIO_INTR_POSEDGE) != ESP_OK ||
+      gpio_isr_handler_add(BENCH_ISR_PIN, bench_isr_handler, NULL) !=
+      ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: ISR loopback pin setup");
+      g_errors++;
+      return;
+    }
+
+  bench_init(&entry, "isr_entry");
+  bench_init(&wake, "isr_to_task");
+
+  for (int i = 0; i < BENCH_RUNS_ISR; i++)
+    {
+      c0 = esp_cpu_get_cycle_count();
+      gpio_set_level(BENCH_ISR_PIN, 1);
+
+      if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)) == 0)
+        {
+          ESP_LOGE(TAG, "✗ FAILED: Loopback interrupt missing");
+          g_errors++;
+          break;
+        }
+
+      c1 = esp_cpu_get_cycle_count();
+      bench_add(&entry, g_isr_cycles - c0);
+      bench_add(&wake, c1 - g_isr_cycles);
+
+      gpio_set_level(BENCH_ISR_PIN, 0);
+      vTaskDelay(1);
+    }
+
+  gpio_isr_handler_remove(BENCH_ISR_PIN);
+  gpio_set_intr_type(BENCH_ISR_PIN, GPIO_INTR_DISABLE);
+  gpio_set_direction(BENCH_ISR_PIN, GPIO_MODE_OUTPUT);
+  gpio_set_level(BENCH_ISR_PIN, 0);
+
+  bench_report(&entry);
+  bench_report(&wake);
+}
+
+/****************************************************************************
+ * Name: bench_wait_frames
+ *
+ * Description:
+ *   Wait until obstacle detection has processed a number of frames.
+ *
+ * Returned Value:
+ *   Frames processed so far (below target on timeout).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_VL53L5CX_ENABLE
+static uint32_t bench_wait_frames(uint32_t target)
+{
+  obstacle_detection_stats_t od = { 0 };
+
+  for (int ms = 0; ms < BENCH_HEAP_WAIT_MS; ms += 100)
+    {
+      if (obstacle_detection_get_stats(&od) == ESP_OK &&
+          od.frames >= target)
+        {
+          break;
+        }
+
+      vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+  return od.frames;
+}
+
+/****************************************************************************
+ * Name: bench_heap
+ *
+ * Description:
+ *   Run the sensing loop (ToF, IMU, obstacle detection) and count the
+ *   heap allocations of its tasks once it is up. Bring-up may allocate;
+ *   the steady state must not.
+ *
+ ****************************************************************************/
+
+static void bench_heap(void)
+{
+  uint32_t start;
+  uint32_t frames;
+  uint32_t allocs;
+  esp_err_t ret;
+
+  ret = obstacle_detection_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Sensing init: %s", esp_err_to_name(ret));
+      g_errors++;
+      return;
+    }
+
+  start = bench_wait_frames(1);
+  if (start == 0)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: No ToF frame");
+      g_errors++;
+      return;
+    }
+
+  maia_mem_watch_reset();
+  for (size_t i = 0; i < sizeof(g_heap_tasks) / sizeof(g_heap_tasks[0]);
+       i++)
+    {
+      ret = maia_mem_watch_task(g_heap_tasks[i]);
+      if (ret == ESP_ERR_NOT_SUPPORTED)
+        {
+          ESP_LOGW(TAG, "Heap check skipped (CONFIG_HEAP_USE_HOOKS off)");
+          return;
+        }
+    }
+
+  frames = bench_wait_frames(start + BENCH_HEAP_FRAMES) - start;
+  allocs = maia_mem_watch_allocs();
+  maia_mem_watch_reset();
+
+  printf("BENCH_HEAP,%" PRIu32 ",%" PRIu32 "\n", frames, allocs);
+
+  if (frames < BENCH_HEAP_FRAMES)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %" PRIu32 " frames in the heap window",
+               frames);
+      g_errors++;
+    }
+
+  if (allocs > 0)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %" PRIu32 " heap allocations in the "
+               "sensing loop", allocs);
+      g_errors++;
+    }
+}
+
+/****************************************************************************
+ * Name: bench_flash_window
+ *
+ * Description:
+ *   Sensing latency (INT edge to fusion done) over BENCH_FLASH_FRAMES
+ *   frames, with page programs at offset..end of part in the meantime
+ *   if part is not NULL.
+ *
+ * Returned Value:
+ *   Page programs issued.
+ *
+ ****************************************************************************/
+
+static uint32_t bench_flash_window(const esp_partition_t *part,
+                                   size_t offset, size_t end,
+                                   maia_lat_stats_t *lat,
+                                   uint32_t *frames)
+{
+  static uint8_t chunk[BENCH_FLASH_CHUNK];
+  obstacle_detection_stats_t od = { 0 };
+  uint32_t writes = 0;
+  uint32_t start;
+
+  memset(chunk, 0xa5, sizeof(chunk));
+
+  obstacle_detection_get_stats(&od);
+  start = od.frames;
+  maia_latency_reset();
+
+  if (part == NULL)
+    {
+      bench_wait_frames(start + BENCH_FLASH_FRAMES);
+    }
+  else
+    {
+      while (od.frames - start < BENCH_FLASH_FRAMES &&
+             offset + BENCH_FLASH_CHUNK <= end)
+        {
+          if (esp_partition_write(part, offset, chunk, sizeof(chunk)) !=
+              ESP_OK)
+            {
+              ESP_LOGE(TAG, "✗ FAILED: Flash write at 0x%x",
+                       (unsigned)offset);
+              g_errors++;
+              break;
+            }
+
+          offset += BENCH_FLASH_CHUNK;
+          writes++;
+          vTaskDelay(pdMS_TO_TICKS(BENCH_FLASH_GAP_MS));
+          obstacle_detection_get_stats(&od);
+        }
+    }
+
+  maia_latency_get_stats(MAIA_LAT_FUSION, lat);
+  obstacle_detection_get_stats(&od);
+  *frames = od.frames - start;
+
+  return writes;
+}
+
+/****************************************************************************
+ * Name: bench_flash
+ *
+ * Description:
+ *   With the sensing loop running, compare the latency p99 of an idle
+ *   window with one under a flash write burst (cache disabled on both
+ *   cores for every program). Runs after bench_heap().
+ *
+ ****************************************************************************/
+
+static void bench_flash(void)
+{
+  const esp_partition_t *part;
+  maia_lat_stats_t idle;
+  maia_lat_stats_t burst;
+  uint32_t idle_frames;
+  uint32_t burst_frames;
+  uint32_t writes;
+  size_t len = BENCH_FLASH_SECTORS * DATA_LOGGER_PAGE_SIZE;
+  size_t offset;
+
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  ESP_PARTITION_SUBTYPE_ANY,
+                                  CONFIG_MAIA_DATA_LOGGER_PARTITION);
+  if (part == NULL || part->size < len)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: No log partition for the flash burst");
+      g_errors++;
+      return;
+    }
+
+  offset = part->size - len;
+  if (esp_partition_erase_range(part, offset, len) != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Flash erase");
+      g_errors++;
+      return;
+    }
+
+  bench_flash_window(NULL, 0, 0, &idle, &idle_frames);
+  if (idle_frames < BENCH_FLASH_FRAMES)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %" PRIu32 " frames in the idle window",
+               idle_frames);
+      g_errors++;
+      return;
+    }
+
+  if (idle.count == 0)
+    {
+      ESP_LOGW(TAG, "Flash check skipped (CONFIG_MAIA_LATENCY_ENABLE off)");
+      return;
+    }
+
+  writes = bench_flash_window(part, offset, part->size, &burst,
+                              &burst_frames);
+  esp_partition_erase_range(part, offset, len);
+
+  printf("BENCH_FLASH,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%"
+         PRIu32 ",%" PRIu32 "\n", idle_frames, idle.p99_us, burst_frames,
+         burst.p99_us, burst.max_us, writes);
+
+  if (burst_frames < BENCH_FLASH_FRAMES)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %" PRIu32 " frames in the flash burst",
+               burst_frames);
+      g_errors++;
+    }
+
+  if (burst.p99_us > idle.p99_us + BENCH_FLASH_SLACK_US)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Sensing p99 %" PRIu32 " us under flash "
+               "writes, %" PRIu32 " us idle", burst.p99_us, idle.p99_us);
+      g_errors++;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: bench_i2c
+ *
+ * Description:
+ *   Bus time per transaction of each device over the run.
+ *
+ ****************************************************************************/
+
+static void bench_i2c(void)
+{
+  maia_i2c_dev_stats_t devs[BENCH_MAX_I2C];
+  size_t n;
+
+  n = maia_i2c_get_all_stats(devs, BENCH_MAX_I2C);
+
+  for (size_t i = 0; i < n; i++)
+    {
+      const maia_i2c_stats_t *s = &devs[i].stats;
+
+      printf("BENCH_I2C,%s,0x%02x,%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n",
+             devs[i].name, devs[i].addr, s->transactions, s->bytes,
+             s->transactions > 0 ?
+             (uint32_t)(s->busy_us / s->transactions) : 0);
+    }
+}
+
+/****************************************************************************
+ * Name: bench_pool
+ *
+ * Description:
+ *   Peak occupancy of each memory pool over the run.
+ *
+ ****************************************************************************/
+
+static void bench_pool(void)
+{
+  maia_pool_stats_t pools[BENCH_MAX_POOLS];
+  size_t n;
+
+  n = maia_pool_get_all_stats(pools, BENCH_MAX_POOLS);
+
+  for (size_t i = 0; i < n; i++)
+    {
+      printf("BENCH_POOL,%s,%u,%u,%u,%" PRIu32 "\n", pools[i].name,
+             pools[i].blocks, (unsigned)pools[i].block_size, pools[i].peak,
+             pools[i].failures);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_benchmark_run
+ *
+ * Description:
+ *   Run every benchmark once and print the report.
+ *
+ ****************************************************************************/
+
+void test_benchmark_run(void)
+{
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   Micro-benchmarks - Regression Report             ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+
+  /* Let the boot logs drain before the console is timed against */
+
+  vTaskDelay(pdMS_TO_TICKS(500));
+
+  printf("BENCH_BEGIN,v%d.%d.%d,%d\n", CONFIG_MAIA_SW_VERSION_MAJOR,
+         CONFIG_MAIA_SW_VERSION_MINOR, CONFIG_MAIA_SW_VERSION_PATCH,
+         BENCH_CPU_MHZ);
+
+#ifdef CONFIG_MAIA_SSD1306_ENABLE
+  bench_display();
+#endif
+
+#ifdef CONFIG_MAIA_DRV2605L_ENABLE
+  bench_haptic();
+#endif
+
+#ifdef CONFIG_MAIA_DS18B20_ENABLE
+  bench_onewire();
+#endif
+
+#if MAIA_DLOG_LEVEL > 0
+  bench_dlog();
+#endif
+
+  bench_isr();
+
+#ifdef CONFIG_MAIA_VL53L5CX_ENABLE
+  bench_heap();
+  bench_flash();
+#endif
+
+  bench_i2c();
+  bench_pool();
+
+  printf("BENCH_END,%" PRIu32 "\n", g_errors);
+
+  if (g_errors == 0)
+    {
+      ESP_LOGI(TAG, "✓ ALL BENCHMARKS COMPLETED");
+    }
+  else
+    {
+      ESP_LOGE(TAG, "✗ %" PRIu32 " ERRORS", g_errors);
+    }
+}
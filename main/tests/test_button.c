@@ -49,9 +49,11 @@
  *
  ****************************************************************************/
 
-static void button_test_handler(button_event_t event)
+static void button_test_handler(const button_event_info_t *info)
 {
-  switch(event)
+  ESP_LOGI(TAG, "Event at %lld ms", (long long)(info->timestamp_us / 1000));
+
+  switch(info->event)
     {
       case BUTTON_EVENT_PRESSED:
         ESP_LOGI(TAG, ">>> BUTTON PRESSED");
@@ -59,7 +61,8 @@ static void button_test_handler(button_event_t event)
         break;
 
       case BUTTON_EVENT_RELEASED:
-        ESP_LOGI(TAG, ">>> BUTTON RELEASED");
+        ESP_LOGI(TAG, ">>> BUTTON RELEASED (held %lu ms)",
+                 (unsigned long)info->held_ms);
         maia_led_set(false);
         break;
 
@@ -115,9 +118,9 @@ void test_button_run(void)
   ESP_LOGI(TAG, "");
   ESP_LOGI(TAG, "Initializing board...");
 
-  /* Initialize button driver */
+  /* Initialize button driver (queue mode: events read by this task) */
 
-  esp_err_t ret = button_init(button_test_handler);
+  esp_err_t ret = button_init(NULL);
   if (ret != ESP_OK)
     {
       ESP_LOGE(TAG, "Failed to initialize button driver!");
@@ -128,10 +131,15 @@ void test_button_run(void)
   ESP_LOGI(TAG, "Press the button to start testing...");
   ESP_LOGI(TAG, "");
 
-  /* Keep test running */
+  /* Consume the event queue */
+
+  button_event_info_t info;
 
   while (1)
     {
-      vTaskDelay(1000 / portTICK_PERIOD_MS);
+      if (button_get_event(&info, 1000) == ESP_OK)
+        {
+          button_test_handler(&info);
+        }
     }
 }
\ No newline at end of file
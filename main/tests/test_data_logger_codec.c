@@ -0,0 +1,279 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_data_logger_codec.c
+ *
+ * ToF Frame Codec Test Suite
+ * Round-trips synthetic frame streams through the logger frame codec,
+ * checks resynchronisation after lost records and reports size and cost
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "data_logger_codec.h"
+#include <esp_log.h>
+#include <esp_cpu.h>
+#include <esp_random.h>
+#include <inttypes.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_CODEC]"
+
+#define TEST_FRAMES           3000    /* Frames per round-trip stream */
+#define TEST_KEY_INTERVAL     15
+#define TEST_LOST_RECORDS     50      /* Records dropped in test 2 */
+
+/* Raw record payload of a frame (sensor, zones, distances, status) */
+
+#define TEST_RAW_SIZE(nb)     (2 + (nb) * 3)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static data_logger_codec_t g_enc;
+static data_logger_codec_t g_dec;
+static int16_t g_distance[DATA_LOGGER_CODEC_ZONES];
+static uint8_t g_status[DATA_LOGGER_CODEC_ZONES];
+static int16_t g_out_distance[DATA_LOGGER_CODEC_ZONES];
+static uint8_t g_out_status[DATA_LOGGER_CODEC_ZONES];
+static uint8_t g_payload[DATA_LOGGER_CODEC_MAX];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_next_frame
+ *
+ * Description:
+ *   Next frame of a synthetic scene: ranging noise of a few mm, zones
+ *   dropping out or jumping to a new target, mostly valid status codes.
+ *
+ ****************************************************************************/
+
+static void test_next_frame(uint8_t nb_zones)
+{
+  for (int i = 0; i < nb_zones; i++)
+    {
+      uint32_t r = esp_random();
+      int16_t d = g_distance[i];
+
+      if (r % 100 < 2)
+        {
+          d = DATA_LOGGER_CODEC_INVALID;
+        }
+      else if (r % 100 < 4 || d == DATA_LOGGER_CODEC_INVALID)
+        {
+          d = (int16_t)((r >> 8) % 4000);
+        }
+      else
+        {
+          d += (int16_t)((r >> 8) % 9) - 4;
+          d = d < 0 ? 0 : d;
+        }
+
+      g_distance[i] = d;
+      g_status[i] = d == DATA_LOGGER_CODEC_INVALID ? 255 :
+                    ((r >> 20) % 16 == 0 ? 9 : 5);
+    }
+}
+
+/****************************************************************************
+ * Name: test_check
+ *
+ * Description:
+ *   Decode g_payload; true if it gives back the current frame.
+ *
+ ****************************************************************************/
+
+static bool test_check(size_t len, uint8_t nb_zones)
+{
+  uint8_t nb = 0;
+  int ret;
+
+  ret = data_logger_codec_decode(&g_dec, g_payload, len, &nb,
+                                 g_out_distance, g_out_status);
+  if (ret != DATA_LOGGER_CODEC_OK || nb != nb_zones ||
+      memcmp(g_out_distance, g_distance, nb * sizeof(g_distance[0])) != 0 ||
+      memcmp(g_out_status, g_status, nb) != 0)
+    {
+      ESP_LOGE(TAG, "✗ Decode mismatch (%d zones, result %d)", nb_zones,
+               ret);
+      return false;
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_data_logger_codec_run
+ *
+ * Description:
+ *   Round-trip, resynchronisation and cost of the ToF frame codec.
+ *
+ ****************************************************************************/
+
+void test_data_logger_codec_run(void)
+{
+  uint32_t failures = 0;
+  uint32_t cycles_max = 0;
+  uint64_t cycles_total = 0;
+  uint32_t coded = 0;
+  uint32_t raw = 0;
+
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   Data Logger - ToF Frame Codec                    ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+
+  /* Test 1: round trip, with resolution changes */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 1: Round Trip (%d frames)", TEST_FRAMES);
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  data_logger_codec_reset(&g_enc);
+  data_logger_codec_reset(&g_dec);
+  memset(g_distance, 0, sizeof(g_distance));
+
+  for (int f = 0; f < TEST_FRAMES; f++)
+    {
+      uint8_t nb = (f / 500) % 2 ? 16 : 64;
+      uint32_t c0;
+      uint32_t c;
+      size_t len;
+
+      test_next_frame(nb);
+
+      c0 = esp_cpu_get_cycle_count();
+      len = data_logger_codec_encode(&g_enc, 0, nb, g_distance, g_status,
+                                     TEST_KEY_INTERVAL, g_payload);
+      c = esp_cpu_get_cycle_count() - c0;
+
+      cycles_total += c;
+      cycles_max = c > cycles_max ? c : cycles_max;
+      coded += len;
+      raw += TEST_RAW_SIZE(nb);
+
+      failures += !test_check(len, nb);
+    }
+
+  ESP_LOGI(TAG, "%s Round trip", failures == 0 ? "✓ PASS:" : "✗ FAILED:");
+  ESP_LOGI(TAG, "");
+
+  /* Test 2: lost records */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 2: Resync After %d Lost Records", TEST_LOST_RECORDS);
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  uint32_t resync_failures = 0;
+
+  for (int n = 0; n < TEST_LOST_RECORDS; n++)
+    {
+      int waited = 0;
+      size_t len;
+
+      /* One record never reaches the decoder */
+
+      test_next_frame(64);
+      data_logger_codec_encode(&g_enc, 0, 64, g_distance, g_status,
+                               TEST_KEY_INTERVAL, g_payload);
+
+      for (;;)
+        {
+          int ret;
+          uint8_t nb;
+
+          test_next_frame(64);
+          len = data_logger_codec_encode(&g_enc, 0, 64, g_distance,
+                                         g_status, TEST_KEY_INTERVAL,
+                                         g_payload);
+          if (g_payload[2] & DATA_LOGGER_CODEC_KEY)
+            {
+              resync_failures += !test_check(len, 64);
+              break;
+            }
+
+          /* Deltas must be refused, not decoded on the wrong frame */
+
+          ret = data_logger_codec_decode(&g_dec, g_payload, len, &nb,
+                                         g_out_distance, g_out_status);
+          if (ret != DATA_LOGGER_CODEC_NO_REF ||
+              ++waited > TEST_KEY_INTERVAL)
+            {
+              ESP_LOGE(TAG, "✗ Delta accepted after a lost record");
+              resync_failures++;
+              break;
+            }
+        }
+
+      /* Random number of good frames before the next loss */
+
+      for (uint32_t k = esp_random() % 40; k > 0; k--)
+        {
+          test_next_frame(64);
+          len = data_logger_codec_encode(&g_enc, 0, 64, g_distance,
+                                         g_status, TEST_KEY_INTERVAL,
+                                         g_payload);
+          resync_failures += !test_check(len, 64);
+        }
+    }
+
+  failures += resync_failures;
+  ESP_LOGI(TAG, "%s %" PRIu32 " failures",
+           resync_failures == 0 ? "✓ PASS:" : "✗ FAILED:", resync_failures);
+  ESP_LOGI(TAG, "");
+
+  /* Test 3: size and cost (test 1 stream) */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 3: Size and Cost");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  ESP_LOGI(TAG, "Payload: %" PRIu32 " bytes coded / %" PRIu32
+           " raw (%" PRIu32 " %%)", coded, raw,
+           (uint32_t)((uint64_t)coded * 100 / raw));
+  ESP_LOGI(TAG, "Encode: %" PRIu32 " cycles avg, %" PRIu32
+           " max (%" PRIu32 " us)",
+           (uint32_t)(cycles_total / TEST_FRAMES), cycles_max,
+           cycles_max / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+  ESP_LOGI(TAG, "");
+
+  if (failures == 0)
+    {
+      ESP_LOGI(TAG, "✓ ALL TESTS PASSED");
+    }
+  else
+    {
+      ESP_LOGE(TAG, "✗ %" PRIu32 " FAILURES", failures);
+    }
+}
@@ -31,6 +31,9 @@
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include <esp_timer.h>
+#include <math.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -41,6 +44,21 @@
 #define TEST_READ_INTERVAL_MS   2000   /* Read every 2 seconds */
 #define TEST_DURATION_MS        30000  /* Run for 30 seconds */
 
+#define TEST_CONV_DONE_BIT      (1u << 0)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Sensor used by the single-device tests: NULL in Skip ROM mode, first
+ * discovered ROM in Match ROM mode
+ */
+
+#ifdef CONFIG_MAIA_DS18B20_ROM_MATCH
+static ds18b20_rom_t g_first_rom;
+#endif
+static const ds18b20_rom_t *g_rom = NULL;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -64,7 +82,7 @@ static void test_ds18b20_blocking(void)
   while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) <
          TEST_DURATION_MS)
     {
-      ret = ds18b20_read_temperature(&temp, NULL);
+      ret = ds18b20_read_temperature(&temp, g_rom);
       if (ret == ESP_OK)
         {
           ESP_LOGI(TAG, "Temperature: %.2f°", temp);
@@ -101,7 +119,7 @@ static void test_ds18b20_async(void)
     {
       /* Trigger conversion */
 
-      ret = ds18b20_trigger_conversion(NULL);
+      ret = ds18b20_trigger_conversion(g_rom);
       if (ret != ESP_OK)
         {
           ESP_LOGE(TAG, "Trigger failed: %s", esp_err_to_name(ret));
@@ -133,7 +151,7 @@ static void test_ds18b20_async(void)
 
       /* Read scratchpad */
 
-      ret = ds18b20_read_scratchpad(scratchpad, NULL);
+      ret = ds18b20_read_scratchpad(scratchpad, g_rom);
       if (ret == ESP_OK)
         {
           raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
@@ -162,6 +180,192 @@ static void test_ds18b20_async(void)
     }
 }
 
+/****************************************************************************
+ * Name: test_ds18b20_conv_done
+ *
+ * Description:
+ *   Conversion timer callback: set the event group bit.
+ *
+ ****************************************************************************/
+
+static void test_ds18b20_conv_done(void *arg)
+{
+  xEventGroupSetBits((EventGroupHandle_t)arg, TEST_CONV_DONE_BIT);
+}
+
+/****************************************************************************
+ * Name: test_ds18b20_timer
+ *
+ * Description:
+ *   Test timer-driven read (ds18b20_convert_async + event group bit +
+ *   ds18b20_read_result). The task keeps working while converting.
+ *
+ ****************************************************************************/
+
+static void test_ds18b20_timer(void)
+{
+  esp_err_t ret;
+  float temp;
+  int64_t t0;
+  uint32_t work;
+  EventGroupHandle_t events;
+  uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+  ESP_LOGI(TAG, "=== TEST: Timer-Driven Async Read ===");
+
+  events = xEventGroupCreate();
+  if (events == NULL)
+    {
+      ESP_LOGE(TAG, "Failed to create event group");
+      return;
+    }
+
+  while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) <
+         TEST_DURATION_MS)
+    {
+      t0 = esp_timer_get_time();
+      ret = ds18b20_convert_async(g_rom, test_ds18b20_conv_done, events);
+      if (ret != ESP_OK)
+        {
+          ESP_LOGE(TAG, "Convert failed: %s", esp_err_to_name(ret));
+          vTaskDelay(pdMS_TO_TICKS(TEST_READ_INTERVAL_MS));
+          continue;
+        }
+
+      /* Other work (here: LED) every 50 ms until the bit is set */
+
+      work = 0;
+      while ((xEventGroupWaitBits(events, TEST_CONV_DONE_BIT, pdTRUE,
+                                  pdFALSE, pdMS_TO_TICKS(50)) &
+              TEST_CONV_DONE_BIT) == 0)
+        {
+          maia_led_toggle();
+          work++;
+        }
+
+      ret = ds18b20_read_result(&temp, g_rom);
+      if (ret == ESP_OK)
+        {
+          ESP_LOGI(TAG, "Temperature: %.2f° (%lld ms, %lu work slots)",
+                   temp, (long long)((esp_timer_get_time() - t0) / 1000),
+                   (unsigned long)work);
+        }
+      else
+        {
+          ESP_LOGE(TAG, "Read result failed: %s", esp_err_to_name(ret));
+        }
+
+      vTaskDelay(pdMS_TO_TICKS(TEST_READ_INTERVAL_MS));
+    }
+
+  vEventGroupDelete(events);
+}
+
+/****************************************************************************
+ * Name: test_ds18b20_multi
+ *
+ * Description:
+ *   Test parallel conversion of every sensor (ds18b20_read_all): one
+ *   conversion period for the whole bus.
+ *
+ ****************************************************************************/
+
+static void test_ds18b20_multi(void)
+{
+  esp_err_t ret;
+  float temps[CONFIG_MAIA_DS18B20_MAX_DEVICES];
+  uint8_t count;
+  int64_t t0;
+  uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+  ESP_LOGI(TAG, "=== TEST: Parallel Multi-Sensor Read ===");
+  ESP_LOGI(TAG, "Cached ROMs: %d", ds18b20_get_rom_count());
+
+  while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) <
+         TEST_DURATION_MS)
+    {
+      t0 = esp_timer_get_time();
+      ret = ds18b20_read_all(temps, CONFIG_MAIA_DS18B20_MAX_DEVICES,
+                             &count);
+      if (count == 0)
+        {
+          ESP_LOGE(TAG, "Read all failed: %s", esp_err_to_name(ret));
+          vTaskDelay(pdMS_TO_TICKS(TEST_READ_INTERVAL_MS));
+          continue;
+        }
+
+      for (uint8_t i = 0; i < count; i++)
+        {
+          if (isnan(temps[i]))
+            {
+              ESP_LOGE(TAG, "Sensor %d: read failed", i);
+            }
+          else
+            {
+              ESP_LOGI(TAG, "Sensor %d: %.2f°", i, temps[i]);
+            }
+        }
+
+      ESP_LOGI(TAG, "%d sensors in %lld ms", count,
+               (long long)((esp_timer_get_time() - t0) / 1000));
+
+      vTaskDelay(pdMS_TO_TICKS(TEST_READ_INTERVAL_MS));
+    }
+}
+
+/****************************************************************************
+ * Name: test_ds18b20_adaptive
+ *
+ * Description:
+ *   Test the adaptive scheduler (ds18b20_adaptive_update): resolution and
+ *   interval follow the rate of change. Warm the sensor with a finger to
+ *   see it switch to 9 bits and fast sampling.
+ *
+ ****************************************************************************/
+
+static void test_ds18b20_adaptive(void)
+{
+  esp_err_t ret;
+  float temp;
+  uint32_t interval_ms = CONFIG_MAIA_DS18B20_ADAPTIVE_FAST_MS;
+  uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+  ESP_LOGI(TAG, "=== TEST: Adaptive Resolution ===");
+
+  while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) <
+         TEST_DURATION_MS)
+    {
+      ret = ds18b20_read_temperature(&temp, g_rom);
+      if (ret == ESP_OK)
+        {
+          ret = ds18b20_adaptive_update(temp, &interval_ms);
+          ESP_LOGI(TAG, "Temperature: %.2f° -> %d-bit (%d ms), next in "
+                   "%lu ms%s", temp, ds18b20_get_resolution(),
+                   ds18b20_get_conversion_time_ms(),
+                   (unsigned long)interval_ms,
+                   ret == ESP_OK ? "" : " (switch failed)");
+        }
+      else
+        {
+          ESP_LOGE(TAG, "Read failed: %s", esp_err_to_name(ret));
+        }
+
+      vTaskDelay(pdMS_TO_TICKS(interval_ms));
+    }
+
+  /* Back to the Kconfig resolution */
+
+#if defined(CONFIG_MAIA_DS18B20_RESOLUTION_9BIT)
+  ds18b20_set_resolution(DS18B20_RESOLUTION_9BIT);
+#elif defined(CONFIG_MAIA_DS18B20_RESOLUTION_10BIT)
+  ds18b20_set_resolution(DS18B20_RESOLUTION_10BIT);
+#elif defined(CONFIG_MAIA_DS18B20_RESOLUTION_11BIT)
+  ds18b20_set_resolution(DS18B20_RESOLUTION_11BIT);
+#else
+  ds18b20_set_resolution(DS18B20_RESOLUTION_12BIT);
+#endif
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -209,6 +413,18 @@ void test_ds18b20_run(void)
       return;
     }
 
+#ifdef CONFIG_MAIA_DS18B20_ROM_MATCH
+  ret = ds18b20_get_rom(0, &g_first_rom);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "No ROM discovered");
+      ds18b20_deinit();
+      return;
+    }
+
+  g_rom = &g_first_rom;
+#endif
+
   /* Test 1: Blocking read */
 
   test_ds18b20_blocking();
@@ -217,6 +433,18 @@ void test_ds18b20_run(void)
 
   test_ds18b20_async();
 
+  /* Test 3: Timer-driven async read */
+
+  test_ds18b20_timer();
+
+  /* Test 4: Parallel conversion of every sensor */
+
+  test_ds18b20_multi();
+
+  /* Test 5: Adaptive resolution scheduler */
+
+  test_ds18b20_adaptive();
+
   /* Deinitialize */
 
   ds18b20_deinit();
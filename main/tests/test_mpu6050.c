@@ -0,0 +1,216 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_mpu6050.c
+ *
+ * MPU6050 IMU Driver Test Suite
+ * Streams FIFO samples and checks the effective rate and bus load
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "mpu6050.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_MPU6050]"
+
+/* Samples popped from the ring per wake-up */
+
+#define TEST_BATCH_SIZE       32
+
+/* Statistics report period */
+
+#define TEST_STATS_PERIOD_MS  5000
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_test_task = NULL;
+static mpu6050_sample_t g_batch[TEST_BATCH_SIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_sample_cb
+ *
+ * Description:
+ *   Samples-ready callback: wake the test task.
+ *
+ ****************************************************************************/
+
+static void test_sample_cb(void *arg)
+{
+  (void)arg;
+  xTaskNotifyGive(g_test_task);
+}
+
+/****************************************************************************
+ * Name: test_print_sample
+ *
+ * Description:
+ *   Print one sample in physical units (accel in mg, gyro in 0.1 dps).
+ *
+ ****************************************************************************/
+
+static void test_print_sample(const mpu6050_sample_t *s)
+{
+  ESP_LOGI(TAG, "t=%lld us  acc=[%6ld %6ld %6ld] mg  "
+           "gyro=[%6ld %6ld %6ld] x0.1 dps",
+           (long long)s->timestamp_us,
+           (long)s->accel[0] * 1000 / MPU6050_ACCEL_LSB_PER_G,
+           (long)s->accel[1] * 1000 / MPU6050_ACCEL_LSB_PER_G,
+           (long)s->accel[2] * 1000 / MPU6050_ACCEL_LSB_PER_G,
+           (long)s->gyro[0] * 100 / MPU6050_GYRO_LSB_PER_DPS_X10,
+           (long)s->gyro[1] * 100 / MPU6050_GYRO_LSB_PER_DPS_X10,
+           (long)s->gyro[2] * 100 / MPU6050_GYRO_LSB_PER_DPS_X10);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_mpu6050_run
+ *
+ * Description:
+ *   Initialize the IMU, start FIFO streaming and print samples, sample
+ *   rate and bus statistics forever.
+ *
+ ****************************************************************************/
+
+void test_mpu6050_run(void)
+{
+  esp_err_t ret;
+  int64_t last_stats;
+  int64_t last_ts = 0;
+  uint32_t received = 0;
+  uint32_t gaps = 0;
+  size_t n;
+  mpu6050_stats_t stats;
+
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   MPU6050 IMU - FIFO Streaming Test               ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+
+  /* ===================================================================== */
+  /* TEST 1: Driver Initialization                                         */
+  /* ===================================================================== */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 1: Driver Initialization");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  g_test_task = xTaskGetCurrentTaskHandle();
+
+  ret = mpu6050_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Driver initialization (%s)",
+               esp_err_to_name(ret));
+      ESP_LOGE(TAG, "Test aborted - check hardware connections");
+      return;
+    }
+
+  ESP_LOGI(TAG, "✓ PASS: Driver initialized (%u Hz, watermark %d)",
+           mpu6050_get_odr_hz(), CONFIG_MAIA_MPU6050_FIFO_WATERMARK);
+  ESP_LOGI(TAG, "");
+
+  /* ===================================================================== */
+  /* TEST 2: FIFO Streaming                                                */
+  /* ===================================================================== */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 2: FIFO Streaming");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  mpu6050_set_sample_callback(test_sample_cb, NULL);
+
+  ret = mpu6050_start();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Start streaming (%s)", esp_err_to_name(ret));
+      return;
+    }
+
+  last_stats = esp_timer_get_time();
+
+  for (;;)
+    {
+      if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) == 0)
+        {
+          ESP_LOGW(TAG, "No samples for 1 s");
+          continue;
+        }
+
+      while ((n = mpu6050_read_samples(g_batch, TEST_BATCH_SIZE)) > 0)
+        {
+          for (size_t i = 0; i < n; i++)
+            {
+              /* Timestamps must increase by one sample period */
+
+              if (last_ts != 0 && g_batch[i].timestamp_us <= last_ts)
+                {
+                  gaps++;
+                }
+
+              last_ts = g_batch[i].timestamp_us;
+            }
+
+          if (received / mpu6050_get_odr_hz() !=
+              (received + n) / mpu6050_get_odr_hz())
+            {
+              test_print_sample(&g_batch[n - 1]);
+            }
+
+          received += n;
+        }
+
+      if (esp_timer_get_time() - last_stats >= TEST_STATS_PERIOD_MS * 1000)
+        {
+          mpu6050_get_stats(&stats);
+          ESP_LOGI(TAG, "rate=%" PRIu32 " Hz bursts=%" PRIu32
+                   " samples=%" PRIu32 " dropped=%" PRIu32
+                   " overflows=%" PRIu32 " i2c_errors=%" PRIu32
+                   " non-monotonic=%" PRIu32,
+                   received * 1000 / TEST_STATS_PERIOD_MS, stats.bursts,
+                   stats.samples, stats.dropped, stats.fifo_overflows,
+                   stats.i2c_errors, gaps);
+          maia_i2c_log_stats();
+
+          received = 0;
+          last_stats = esp_timer_get_time();
+        }
+    }
+}
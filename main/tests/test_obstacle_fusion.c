@@ -0,0 +1,292 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_obstacle_fusion.c
+ *
+ * Obstacle Fusion Kernel Test Suite
+ * Checks that the PIE and scalar sector kernels agree and times them
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "obstacle_fusion.h"
+#include <esp_log.h>
+#include <esp_cpu.h>
+#include <esp_random.h>
+#include <inttypes.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_FUSION]"
+
+#define TEST_RANDOM_FRAMES    2000    /* Random frame pairs compared */
+#define TEST_TIMING_RUNS      1000    /* Runs averaged per timing */
+
+/* Frame rates the kernel has to sustain (per sensor) */
+
+#define TEST_RATE_8X8_HZ      15
+#define TEST_RATE_4X4_HZ      60
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static obstacle_fusion_input_t g_input;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_fill_random
+ *
+ * Description:
+ *   Random zones: invalid and weak zones, near and far targets, signals
+ *   above 32767 to exercise the unsigned compare.
+ *
+ ****************************************************************************/
+
+static void test_fill_random(uint8_t nb_zones)
+{
+  g_input.nb_zones = nb_zones;
+  g_input.min_signal_kcps = esp_random() % 4 == 0 ?
+                            (uint16_t)esp_random() : esp_random() % 64;
+
+  for (int s = 0; s < VL53L5CX_SENSOR_COUNT; s++)
+    {
+      for (int i = 0; i < VL53L5CX_NB_ZONES_MAX; i++)
+        {
+          uint32_t r = esp_random();
+
+          g_input.zones[s].distance_mm[i] = (r & 7) == 0 ?
+            VL53L5CX_DISTANCE_INVALID : (int16_t)((r >> 3) % 4000);
+          g_input.zones[s].signal_kcps[i] = (r >> 16) & 1 ?
+            (uint16_t)(r >> 17) : (uint16_t)((r >> 17) % 128);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: test_compare
+ *
+ * Description:
+ *   Run both kernels on g_input; true if they agree.
+ *
+ ****************************************************************************/
+
+static bool test_compare(void)
+{
+  obstacle_sectors_t simd;
+  obstacle_sectors_t scalar;
+
+  obstacle_fusion_reduce(&g_input, &simd);
+  obstacle_fusion_reduce_scalar(&g_input, &scalar);
+
+  if (memcmp(&simd, &scalar, sizeof(simd)) == 0)
+    {
+      return true;
+    }
+
+  ESP_LOGE(TAG, "✗ Mismatch (%d zones): min %d/%d/%d vs %d/%d/%d, "
+           "conf %d/%d/%d vs %d/%d/%d", g_input.nb_zones,
+           simd.min_mm[0], simd.min_mm[1], simd.min_mm[2],
+           scalar.min_mm[0], scalar.min_mm[1], scalar.min_mm[2],
+           simd.confidence[0], simd.confidence[1], simd.confidence[2],
+           scalar.confidence[0], scalar.confidence[1],
+           scalar.confidence[2]);
+  return false;
+}
+
+/****************************************************************************
+ * Name: test_time
+ *
+ * Description:
+ *   Average cycles of one kernel run on g_input.
+ *
+ ****************************************************************************/
+
+static uint32_t test_time(bool scalar)
+{
+  obstacle_sectors_t out;
+  uint32_t c0 = esp_cpu_get_cycle_count();
+
+  for (int i = 0; i < TEST_TIMING_RUNS; i++)
+    {
+      if (scalar)
+        {
+          obstacle_fusion_reduce_scalar(&g_input, &out);
+        }
+      else
+        {
+          obstacle_fusion_reduce(&g_input, &out);
+        }
+    }
+
+  return (esp_cpu_get_cycle_count() - c0) / TEST_TIMING_RUNS;
+}
+
+/****************************************************************************
+ * Name: test_report_timing
+ *
+ * Description:
+ *   Time both kernels at one resolution and report the CPU share at the
+ *   required frame rate (one fusion per frame of either sensor).
+ *
+ ****************************************************************************/
+
+static void test_report_timing(uint8_t nb_zones, uint32_t rate_hz)
+{
+  uint32_t cpu_hz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000u;
+  uint32_t per_s = rate_hz * VL53L5CX_SENSOR_COUNT;
+  uint32_t scalar;
+  uint32_t simd;
+
+  test_fill_random(nb_zones);
+  scalar = test_time(true);
+  simd = test_time(false);
+
+  ESP_LOGI(TAG, "%s: scalar %" PRIu32 " cycles, kernel %" PRIu32
+           " cycles (x%" PRIu32 ".%02" PRIu32 ")",
+           nb_zones == VL53L5CX_RESOLUTION_8X8 ? "8x8" : "4x4",
+           scalar, simd, scalar / simd, scalar * 100 / simd % 100);
+  ESP_LOGI(TAG, "  at 2x%" PRIu32 " Hz: %" PRIu32 ".%03" PRIu32
+           " %% of one core", rate_hz,
+           (uint32_t)((uint64_t)simd * per_s * 100 / cpu_hz),
+           (uint32_t)((uint64_t)simd * per_s * 100000 / cpu_hz % 1000));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_obstacle_fusion_run
+ *
+ * Description:
+ *   Compare the PIE and scalar fusion kernels and time them.
+ *
+ ****************************************************************************/
+
+void test_obstacle_fusion_run(void)
+{
+  uint32_t failures = 0;
+
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   Obstacle Fusion Kernel - PIE vs Scalar          ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "Kernel: %s", obstacle_fusion_has_simd() ?
+           "PIE SIMD" : "scalar (PIE disabled)");
+  ESP_LOGI(TAG, "");
+
+  /* Test 1: edge cases */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 1: Edge Cases");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  for (int res = 0; res < 2; res++)
+    {
+      uint8_t nb = res ? VL53L5CX_RESOLUTION_8X8 : VL53L5CX_RESOLUTION_4X4;
+
+      /* All invalid */
+
+      test_fill_random(nb);
+      for (int s = 0; s < VL53L5CX_SENSOR_COUNT; s++)
+        {
+          for (int i = 0; i < VL53L5CX_NB_ZONES_MAX; i++)
+            {
+              g_input.zones[s].distance_mm[i] = VL53L5CX_DISTANCE_INVALID;
+            }
+        }
+
+      failures += !test_compare();
+
+      /* All weak, then threshold 0 (everything passes) */
+
+      test_fill_random(nb);
+      g_input.min_signal_kcps = UINT16_MAX;
+      failures += !test_compare();
+      g_input.min_signal_kcps = 0;
+      failures += !test_compare();
+
+      /* Zero distances and full-scale signals */
+
+      memset(g_input.zones, 0, sizeof(g_input.zones));
+      for (int s = 0; s < VL53L5CX_SENSOR_COUNT; s++)
+        {
+          for (int i = 0; i < VL53L5CX_NB_ZONES_MAX; i++)
+            {
+              g_input.zones[s].signal_kcps[i] = UINT16_MAX;
+            }
+        }
+
+      g_input.min_signal_kcps = 0x8000;
+      failures += !test_compare();
+    }
+
+  ESP_LOGI(TAG, "%s Edge cases", failures == 0 ? "✓ PASS:" : "✗ FAILED:");
+  ESP_LOGI(TAG, "");
+
+  /* Test 2: random frames */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 2: %d Random Frame Pairs", TEST_RANDOM_FRAMES);
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  uint32_t random_failures = 0;
+
+  for (int i = 0; i < TEST_RANDOM_FRAMES; i++)
+    {
+      test_fill_random(i & 1 ? VL53L5CX_RESOLUTION_8X8 :
+                               VL53L5CX_RESOLUTION_4X4);
+      random_failures += !test_compare();
+    }
+
+  failures += random_failures;
+  ESP_LOGI(TAG, "%s %" PRIu32 " mismatches",
+           random_failures == 0 ? "✓ PASS:" : "✗ FAILED:",
+           random_failures);
+  ESP_LOGI(TAG, "");
+
+  /* Test 3: timing */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 3: Timing");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  test_report_timing(VL53L5CX_RESOLUTION_8X8, TEST_RATE_8X8_HZ);
+  test_report_timing(VL53L5CX_RESOLUTION_4X4, TEST_RATE_4X4_HZ);
+  ESP_LOGI(TAG, "");
+
+  if (failures == 0)
+    {
+      ESP_LOGI(TAG, "✓ ALL TESTS PASSED");
+    }
+  else
+    {
+      ESP_LOGE(TAG, "✗ %" PRIu32 " FAILURES", failures);
+    }
+}
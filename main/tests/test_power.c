@@ -0,0 +1,374 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_power.c
+ *
+ * Power Management Test Suite
+ * Holds the board in each accounted power state for a timed window (read
+ * the supply meter meanwhile), checks the state time accounting and
+ * measures the wake-up latency light sleep adds to the ToF INT
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "maia_board.h"
+#include "power_manager.h"
+#include "vl53l5cx.h"
+#include <esp_log.h>
+#include <esp_pm.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_POWER]"
+
+#define TEST_WINDOW_MS        10000   /* Per state, for the meter */
+#define TEST_SETTLE_MS        200     /* Console drained before a window */
+#define TEST_SLEEP_MIN_PCT    80      /* Of the light sleep window */
+
+#define TEST_REF_FRAMES       60      /* INT period, chip held awake */
+#define TEST_WAKE_SAMPLES     50      /* Frames after an idle period */
+#define TEST_WOKEN_US         50      /* Lateness counted as a wake */
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_test_task = NULL;
+static esp_pm_lock_handle_t g_awake_lock = NULL;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_window
+ *
+ * Description:
+ *   Wait one window in the current state and return the accounted time
+ *   delta.
+ *
+ ****************************************************************************/
+
+static void test_window(const char *state, maia_pm_stats_t *delta)
+{
+  maia_pm_stats_t a;
+  maia_pm_stats_t b;
+
+  ESP_LOGI(TAG, ">>> %s: read the meter now (%d s)", state,
+           TEST_WINDOW_MS / 1000);
+  vTaskDelay(pdMS_TO_TICKS(TEST_SETTLE_MS));
+
+  maia_pm_get_stats(&a);
+  vTaskDelay(pdMS_TO_TICKS(TEST_WINDOW_MS));
+  maia_pm_get_stats(&b);
+
+  delta->sleeps = b.sleeps - a.sleeps;
+  delta->gpio_wakes = b.gpio_wakes - a.gpio_wakes;
+  delta->sleep_us = b.sleep_us - a.sleep_us;
+  delta->busy_us = b.busy_us - a.busy_us;
+  delta->uptime_us = b.uptime_us - a.uptime_us;
+
+  ESP_LOGI(TAG, "<<< %s: sleep %" PRIu32 " %%, busy %" PRIu32 " %%, %"
+           PRIu32 " sleeps", state,
+           (uint32_t)(delta->sleep_us * 100 / delta->uptime_us),
+           (uint32_t)(delta->busy_us * 100 / delta->uptime_us),
+           delta->sleeps);
+}
+
+#if defined(CONFIG_MAIA_PM_LIGHT_SLEEP) && \
+    defined(CONFIG_MAIA_VL53L5CX_ENABLE)
+
+/****************************************************************************
+ * Name: test_frame_cb
+ ****************************************************************************/
+
+static void test_frame_cb(vl53l5cx_sensor_t sensor, void *arg)
+{
+  (void)arg;
+  xTaskNotify(g_test_task, 1u << sensor, eSetBits);
+}
+
+/****************************************************************************
+ * Name: test_next_int
+ *
+ * Description:
+ *   INT timestamp of the next left sensor frame, 0 on timeout.
+ *
+ ****************************************************************************/
+
+static int64_t test_next_int(void)
+{
+  const vl53l5cx_frame_t *frame;
+  uint32_t pending;
+  int64_t t = 0;
+
+  while (t == 0)
+    {
+      if (xTaskNotifyWait(0, UINT32_MAX, &pending,
+                          pdMS_TO_TICKS(1000)) != pdTRUE)
+        {
+          return 0;
+        }
+
+      if ((pending & (1u << VL53L5CX_SENSOR_LEFT)) &&
+          vl53l5cx_acquire_frame(VL53L5CX_SENSOR_LEFT, &frame) == ESP_OK)
+        {
+          t = frame->int_time_us;
+          vl53l5cx_release_frame(VL53L5CX_SENSOR_LEFT);
+        }
+    }
+
+  return t;
+}
+
+/****************************************************************************
+ * Name: test_wake_latency
+ *
+ * Description:
+ *   Measure the INT period with the chip held awake, then let it sleep
+ *   before single frames: the lateness of their INT timestamp against
+ *   the previous (awake) one plus a period is the wake-up time.
+ *
+ * Returned Value:
+ *   true if the worst lateness is within CONFIG_MAIA_PM_WAKE_BUDGET_US.
+ *
+ ****************************************************************************/
+
+static bool test_wake_latency(void)
+{
+  maia_pm_stats_t a;
+  maia_pm_stats_t b;
+  int64_t first;
+  int64_t last = 0;
+  int64_t period;
+  int64_t late_max = 0;
+  int64_t late_total = 0;
+  uint32_t woken = 0;
+
+  g_test_task = xTaskGetCurrentTaskHandle();
+
+  if (vl53l5cx_init() != ESP_OK ||
+      vl53l5cx_set_frame_callback(test_frame_cb, NULL) != ESP_OK ||
+      vl53l5cx_start_ranging() != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: ToF bring-up");
+      return false;
+    }
+
+  /* Reference period, awake */
+
+  esp_pm_lock_acquire(g_awake_lock);
+  test_next_int();
+  first = test_next_int();
+
+  for (int i = 1; i < TEST_REF_FRAMES; i++)
+    {
+      last = test_next_int();
+    }
+
+  if (first == 0 || last == 0)
+    {
+      esp_pm_lock_release(g_awake_lock);
+      ESP_LOGE(TAG, "✗ FAILED: No ToF frames");
+      return false;
+    }
+
+  period = (last - first) / (TEST_REF_FRAMES - 1);
+  ESP_LOGI(TAG, "INT period %lld us", (long long)period);
+
+  /* Awake frame, then a frame after the idle gap (asleep unless the
+   * other sensor's INT woke the chip first)
+   */
+
+  maia_pm_get_stats(&a);
+
+  for (int i = 0; i < TEST_WAKE_SAMPLES; i++)
+    {
+      int64_t ref;
+      int64_t t;
+      int64_t late;
+
+      test_next_int();
+      ref = test_next_int();
+      esp_pm_lock_release(g_awake_lock);
+
+      t = test_next_int();
+      esp_pm_lock_acquire(g_awake_lock);
+
+      if (ref == 0 || t == 0)
+        {
+          ESP_LOGE(TAG, "✗ FAILED: Frame timeout");
+          esp_pm_lock_release(g_awake_lock);
+          return false;
+        }
+
+      late = t - (ref + period);
+      late = late < 0 ? 0 : late;
+      late_total += late;
+      late_max = late > late_max ? late : late_max;
+      woken += late > TEST_WOKEN_US;
+    }
+
+  esp_pm_lock_release(g_awake_lock);
+  maia_pm_get_stats(&b);
+  vl53l5cx_stop_ranging();
+
+  ESP_LOGI(TAG, "Wake-up: %lld us avg, %lld us max (%" PRIu32 "/%d "
+           "frames woken, %" PRIu32 " GPIO wakes)",
+           (long long)(late_total / TEST_WAKE_SAMPLES), (long long)late_max,
+           woken, TEST_WAKE_SAMPLES, b.gpio_wakes - a.gpio_wakes);
+
+  if (late_max > CONFIG_MAIA_PM_WAKE_BUDGET_US)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Over the %d us budget",
+               CONFIG_MAIA_PM_WAKE_BUDGET_US);
+      return false;
+    }
+
+  ESP_LOGI(TAG, "✓ PASS: Within the %d us budget",
+           CONFIG_MAIA_PM_WAKE_BUDGET_US);
+  return true;
+}
+
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_power_run
+ *
+ * Description:
+ *   Per-state windows and accounting, then the ToF wake-up latency.
+ *
+ ****************************************************************************/
+
+void test_power_run(void)
+{
+  maia_pm_stats_t d;
+  uint32_t failures = 0;
+  esp_err_t ret;
+
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   Power Management - States and Wake-up            ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+
+  ret = power_manager_init();
+  if (ret == ESP_OK)
+    {
+      ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "test_awake",
+                               &g_awake_lock);
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Power management (%s)", esp_err_to_name(ret));
+      return;
+    }
+
+  /* Test 1: busy (I2C transfer / motor drive, CPU idle) */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 1: Busy Lock Held");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  maia_pm_busy_acquire();
+  test_window("BUSY", &d);
+  maia_pm_busy_release();
+
+  if (d.sleeps != 0 || d.busy_us * 100 < d.uptime_us * 95)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Busy window not accounted as busy");
+      failures++;
+    }
+
+  ESP_LOGI(TAG, "");
+
+  /* Test 2: awake, DFS minimum */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 2: Awake (%d MHz minimum)",
+           CONFIG_MAIA_PM_MIN_FREQ_MHZ);
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  esp_pm_lock_acquire(g_awake_lock);
+  test_window("AWAKE", &d);
+  esp_pm_lock_release(g_awake_lock);
+
+  if (d.sleeps != 0 || d.busy_us * 100 > d.uptime_us * 5)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Awake window not accounted as awake");
+      failures++;
+    }
+
+  ESP_LOGI(TAG, "");
+
+  /* Test 3: light sleep (sensors idle: only the tick timeouts wake) */
+
+#ifdef CONFIG_MAIA_PM_LIGHT_SLEEP
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 3: Light Sleep");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  test_window("SLEEP", &d);
+
+  if (d.sleep_us * 100 < d.uptime_us * TEST_SLEEP_MIN_PCT)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Asleep under %d %% of the window",
+               TEST_SLEEP_MIN_PCT);
+      failures++;
+    }
+
+  ESP_LOGI(TAG, "");
+#endif
+
+  /* Test 4: ToF wake-up latency */
+
+#if defined(CONFIG_MAIA_PM_LIGHT_SLEEP) && \
+    defined(CONFIG_MAIA_VL53L5CX_ENABLE)
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 4: ToF Wake-up Latency");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  failures += !test_wake_latency();
+  ESP_LOGI(TAG, "");
+#endif
+
+  ESP_LOGI(TAG, "Enter the readings in Services > Power Management");
+
+  if (failures == 0)
+    {
+      ESP_LOGI(TAG, "✓ ALL TESTS PASSED");
+    }
+  else
+    {
+      ESP_LOGE(TAG, "✗ %" PRIu32 " FAILURES", failures);
+    }
+}
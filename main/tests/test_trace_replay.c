@@ -0,0 +1,233 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_trace_replay.c
+ *
+ * Trace Replay Test
+ * Replays the recorded sessions of the log partition through obstacle
+ * detection and the haptic threat mapping, twice: the decision streams
+ * must match, and the second run reports throughput and stage cost
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "trace_replay.h"
+#include "data_logger.h"
+#include "haptic_feedback.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_REPLAY]"
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_stage_names[TRACE_REPLAY_STAGE_COUNT] =
+{
+  "decode",
+  "detect",
+  "haptic",
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_decision_cb
+ ****************************************************************************/
+
+#ifdef CONFIG_MAIA_TRACE_REPLAY_DECISIONS
+static void test_decision_cb(const trace_replay_decision_t *d, void *arg)
+{
+  (void)arg;
+
+  printf("REPLAY,%u,%" PRIu32 ",%" PRIu32 ",%u,%u,%u,%u\n", d->session,
+         d->seq, d->time_ms, d->sensor, d->distance_mm, d->ttc_ms,
+         d->level);
+}
+#endif
+
+/****************************************************************************
+ * Name: test_haptic_init
+ *
+ * Description:
+ *   Haptic feedback for the threat mapping only: RTP streaming is not
+ *   started, so the motor stays off.
+ *
+ ****************************************************************************/
+
+static esp_err_t test_haptic_init(void)
+{
+  drv2605l_config_t config =
+    {
+      .i2c_addr = CONFIG_MAIA_DRV2605L_I2C_ADDR,
+#ifdef CONFIG_MAIA_DRV2605L_ACTUATOR_ERM
+      .actuator = DRV2605L_ACTUATOR_ERM,
+      .library = DRV2605L_LIB_ERM_A,
+#else
+      .actuator = DRV2605L_ACTUATOR_LRA,
+      .library = DRV2605L_LIB_LRA,
+#endif
+      .rated_voltage = CONFIG_MAIA_DRV2605L_RATED_VOLTAGE,
+      .overdrive_clamp = CONFIG_MAIA_DRV2605L_OVERDRIVE_CLAMP,
+      .auto_calibrate = false,
+    };
+
+  return haptic_feedback_init(&config);
+}
+
+/****************************************************************************
+ * Name: test_report
+ ****************************************************************************/
+
+static void test_report(const trace_replay_result_t *r)
+{
+  uint64_t fps = r->elapsed_us > 0 ?
+                 (uint64_t)r->frames * 1000000 / r->elapsed_us : 0;
+
+  ESP_LOGI(TAG, "%" PRIu32 " sessions, %" PRIu32 " pages, %" PRIu32
+           " records, %" PRIu32 " s recorded", r->sessions, r->pages,
+           r->records, r->span_ms / 1000);
+  ESP_LOGI(TAG, "%" PRIu32 " frames (%" PRIu32 " untagged), %" PRIu32
+           " corrupt, %" PRIu32 " without keyframe", r->frames,
+           r->untagged, r->corrupt, r->no_ref);
+  ESP_LOGI(TAG, "%" PRIu32 " level changes, digest 0x%08" PRIx32,
+           r->level_changes, r->digest);
+  ESP_LOGI(TAG, "%lld ms, %llu frames/s", (long long)(r->elapsed_us / 1000),
+           (unsigned long long)fps);
+
+  for (int i = 0; i < TRACE_REPLAY_STAGE_COUNT; i++)
+    {
+      ESP_LOGI(TAG, "  %-6s %6" PRIu32 " cycles avg, %6" PRIu32 " max",
+               g_stage_names[i], r->stages[i].avg_cycles,
+               r->stages[i].max_cycles);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_trace_replay_run
+ *
+ * Description:
+ *   Run the replay twice and compare the decision streams.
+ *
+ ****************************************************************************/
+
+void test_trace_replay_run(void)
+{
+  trace_replay_config_t config =
+    {
+      .session = CONFIG_MAIA_TRACE_REPLAY_SESSION,
+      .realtime = false,
+    };
+
+  trace_replay_result_t first;
+  trace_replay_result_t second;
+  esp_err_t ret;
+
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   Trace Replay - Recorded Sessions                 ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+
+  ret = data_logger_init();
+  if (ret == ESP_OK)
+    {
+      ret = test_haptic_init();
+    }
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ Init failed: %s", esp_err_to_name(ret));
+      return;
+    }
+
+  /* TEST 1: decisions (optionally printed), at the configured pace */
+
+#ifdef CONFIG_MAIA_TRACE_REPLAY_REALTIME
+  config.realtime = true;
+#endif
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 1: Replay (%s)",
+           config.realtime ? "recorded pace" : "as fast as possible");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+#ifdef CONFIG_MAIA_TRACE_REPLAY_DECISIONS
+  config.callback = test_decision_cb;
+  printf("REPLAY_BEGIN\n");
+#endif
+
+  ret = trace_replay_run(&config, &first);
+
+#ifdef CONFIG_MAIA_TRACE_REPLAY_DECISIONS
+  printf("REPLAY_END,%08" PRIx32 "\n", first.digest);
+#endif
+
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %s (nothing recorded?)",
+               esp_err_to_name(ret));
+      return;
+    }
+
+  test_report(&first);
+  ESP_LOGI(TAG, "");
+
+  /* TEST 2: same log, as fast as possible, no callback */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 2: Determinism and Throughput");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  config.realtime = false;
+  config.callback = NULL;
+  ret = trace_replay_run(&config, &second);
+  if (ret == ESP_OK)
+    {
+      test_report(&second);
+    }
+
+  ESP_LOGI(TAG, "");
+
+  if (ret == ESP_OK && second.frames == first.frames &&
+      second.digest == first.digest)
+    {
+      ESP_LOGI(TAG, "✓ ALL TESTS PASSED");
+    }
+  else
+    {
+      ESP_LOGE(TAG, "✗ FAILED: decisions differ between runs "
+               "(0x%08" PRIx32 " vs 0x%08" PRIx32 ")",
+               first.digest, second.digest);
+    }
+}
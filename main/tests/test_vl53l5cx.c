@@ -0,0 +1,391 @@
+/*
+ * Copyright 2026 Vinicius May
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************
+ * main/tests/test_vl53l5cx.c
+ *
+ * VL53L5CX ToF Driver Test Suite
+ * Brings up both sensors, ranges continuously and prints distance grids
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "tests.h"
+#include "vl53l5cx.h"
+#include "maia_board.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TAG "[TEST_VL53L5CX]"
+
+/* Print one grid per sensor every N frames (keeps the console readable) */
+
+#define TEST_PRINT_EVERY      15
+
+/* Statistics report period */
+
+#define TEST_STATS_PERIOD_MS  5000
+
+/* Profile switching: settle time after a change, rate window, tolerance */
+
+#define TEST_PROFILE_WAIT_MS  2000
+#define TEST_RATE_WINDOW_MS   2000
+#define TEST_RATE_TOL_PCT     20
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static TaskHandle_t g_test_task = NULL;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_frame_cb
+ *
+ * Description:
+ *   Frame-ready callback: wake the test task (one bit per sensor).
+ *
+ ****************************************************************************/
+
+static void test_frame_cb(vl53l5cx_sensor_t sensor, void *arg)
+{
+  (void)arg;
+  xTaskNotify(g_test_task, 1u << sensor, eSetBits);
+}
+
+/****************************************************************************
+ * Name: test_print_frame
+ *
+ * Description:
+ *   Print a frame as a square grid of distances in mm ("----" = invalid).
+ *
+ ****************************************************************************/
+
+static void test_print_frame(const vl53l5cx_frame_t *frame)
+{
+  char line[8 * 6 + 1];
+  int side = (frame->nb_zones == 64) ? 8 : 4;
+
+  ESP_LOGI(TAG, "%s #%" PRIu32 ": %d/%d valid, latency %lld us",
+           frame->sensor == VL53L5CX_SENSOR_LEFT ? "LEFT" : "RIGHT",
+           frame->sequence, frame->valid_zones, frame->nb_zones,
+           (long long)(frame->read_done_us - frame->int_time_us));
+
+  for (int row = 0; row < side; row++)
+    {
+      int pos = 0;
+
+      for (int col = 0; col < side; col++)
+        {
+          int16_t mm = frame->distance_mm[row * side + col];
+
+          if (mm == VL53L5CX_DISTANCE_INVALID)
+            {
+              pos += snprintf(&line[pos], sizeof(line) - pos, "  ----");
+            }
+          else
+            {
+              pos += snprintf(&line[pos], sizeof(line) - pos, " %5d", mm);
+            }
+        }
+
+      ESP_LOGI(TAG, "%s", line);
+    }
+}
+
+/****************************************************************************
+ * Name: test_profile
+ *
+ * Description:
+ *   Switch both sensors to a profile, wait for frames at the new
+ *   resolution and check the frame rate of each sensor.
+ *
+ ****************************************************************************/
+
+static bool test_profile(vl53l5cx_resolution_t res, uint8_t freq_hz)
+{
+  const vl53l5cx_frame_t *frame;
+  vl53l5cx_stats_t stats;
+  uint32_t pending;
+  uint32_t reconfigs[VL53L5CX_SENSOR_COUNT];
+  int64_t switch_us[VL53L5CX_SENSOR_COUNT] = {0};
+  uint32_t count[VL53L5CX_SENSOR_COUNT] = {0};
+  uint32_t mixed = 0;
+  uint32_t expected = freq_hz * TEST_RATE_WINDOW_MS / 1000;
+  int64_t t0 = esp_timer_get_time();
+  int64_t deadline = t0 + TEST_PROFILE_WAIT_MS * 1000;
+  int side = (res == VL53L5CX_RESOLUTION_8X8) ? 8 : 4;
+  bool both = false;
+  esp_err_t ret;
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      vl53l5cx_get_stats(i, &stats);
+      reconfigs[i] = stats.reconfigs;
+    }
+
+  ret = vl53l5cx_set_profile(res, freq_hz);
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %dx%d @ %u Hz rejected (%s)", side, side,
+               freq_hz, esp_err_to_name(ret));
+      return false;
+    }
+
+  /* Until both sensors were reconfigured, then the rate window. Frames
+   * integrated after a sensor's change must all be at the new resolution.
+   */
+
+  while (esp_timer_get_time() < deadline)
+    {
+      if (xTaskNotifyWait(0, UINT32_MAX, &pending,
+                          pdMS_TO_TICKS(100)) != pdTRUE)
+        {
+          continue;
+        }
+
+      for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+        {
+          if (switch_us[i] == 0)
+            {
+              vl53l5cx_get_stats(i, &stats);
+              if (stats.reconfigs != reconfigs[i])
+                {
+                  switch_us[i] = esp_timer_get_time();
+                }
+            }
+
+          if ((pending & (1u << i)) == 0 || switch_us[i] == 0 ||
+              vl53l5cx_acquire_frame(i, &frame) != ESP_OK)
+            {
+              continue;
+            }
+
+          if (frame->int_time_us > switch_us[i])
+            {
+              mixed += frame->nb_zones != res;
+              count[i]++;
+            }
+
+          vl53l5cx_release_frame(i);
+        }
+
+      if (!both && switch_us[0] != 0 && switch_us[1] != 0)
+        {
+          both = true;
+          ESP_LOGI(TAG, "%dx%d @ %u Hz: both sensors in %lld ms", side,
+                   side, freq_hz,
+                   (long long)((esp_timer_get_time() - t0) / 1000));
+          deadline = esp_timer_get_time() + TEST_RATE_WINDOW_MS * 1000;
+          count[0] = 0;
+          count[1] = 0;
+        }
+    }
+
+  if (!both)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %dx%d @ %u Hz not applied", side, side,
+               freq_hz);
+      return false;
+    }
+
+  ESP_LOGI(TAG, "%dx%d @ %u Hz: %" PRIu32 " / %" PRIu32 " frames in %d ms "
+           "(expected %" PRIu32 ")", side, side, freq_hz, count[0],
+           count[1], TEST_RATE_WINDOW_MS, expected);
+
+  if (mixed != 0)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: %" PRIu32 " frames at the old resolution "
+               "after the switch", mixed);
+      return false;
+    }
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      if (count[i] * 100 < expected * (100 - TEST_RATE_TOL_PCT) ||
+          count[i] * 100 > expected * (100 + TEST_RATE_TOL_PCT))
+        {
+          ESP_LOGE(TAG, "✗ FAILED: %s frame rate off",
+                   i == VL53L5CX_SENSOR_LEFT ? "LEFT" : "RIGHT");
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: test_vl53l5cx_run
+ *
+ * Description:
+ *   Initialize both sensors, start ranging, cycle through the ranging
+ *   profiles, then print frames and per-sensor statistics forever.
+ *
+ ****************************************************************************/
+
+void test_vl53l5cx_run(void)
+{
+  esp_err_t ret;
+  int64_t t0;
+  int64_t last_stats;
+  uint32_t pending;
+  const vl53l5cx_frame_t *frame;
+  vl53l5cx_stats_t stats;
+  bool ok;
+
+  ESP_LOGI(TAG, "");
+  ESP_LOGI(TAG, "╔════════════════════════════════════════════════════╗");
+  ESP_LOGI(TAG, "║   VL53L5CX ToF Sensors - Ranging Test             ║");
+  ESP_LOGI(TAG, "╚════════════════════════════════════════════════════╝");
+  ESP_LOGI(TAG, "");
+
+  /* ===================================================================== */
+  /* TEST 1: Driver Initialization                                         */
+  /* ===================================================================== */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 1: Driver Initialization");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  g_test_task = xTaskGetCurrentTaskHandle();
+
+  t0 = esp_timer_get_time();
+  ret = vl53l5cx_init();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Driver initialization (%s)",
+               esp_err_to_name(ret));
+      ESP_LOGE(TAG, "Test aborted - check hardware connections");
+      return;
+    }
+
+  ESP_LOGI(TAG, "✓ PASS: Driver initialized in %lld ms",
+           (long long)((esp_timer_get_time() - t0) / 1000));
+  ESP_LOGI(TAG, "");
+
+  /* ===================================================================== */
+  /* TEST 2: Profile Switching                                             */
+  /* ===================================================================== */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 2: Profile Switching");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  vl53l5cx_set_frame_callback(test_frame_cb, NULL);
+
+  ret = vl53l5cx_start_ranging();
+  if (ret != ESP_OK)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: Start ranging (%s)", esp_err_to_name(ret));
+      return;
+    }
+
+  ok = vl53l5cx_set_profile(VL53L5CX_RESOLUTION_8X8, 60) ==
+       ESP_ERR_INVALID_ARG;
+  if (!ok)
+    {
+      ESP_LOGE(TAG, "✗ FAILED: 8x8 @ 60 Hz accepted");
+    }
+
+  ok = test_profile(VL53L5CX_RESOLUTION_4X4, 60) && ok;
+  ok = test_profile(VL53L5CX_RESOLUTION_8X8, 5) && ok;
+  ok = test_profile(VL53L5CX_RESOLUTION_8X8, 15) && ok;
+
+  for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+    {
+      vl53l5cx_get_stats(i, &stats);
+      ESP_LOGI(TAG, "%s: %" PRIu32 " profile changes, longest gap %"
+               PRIu32 " ms", i == VL53L5CX_SENSOR_LEFT ? "LEFT" : "RIGHT",
+               stats.reconfigs, stats.reconfig_max_us / 1000);
+    }
+
+  if (ok)
+    {
+      ESP_LOGI(TAG, "✓ PASS: Profiles switched without mixed frames");
+    }
+
+  ESP_LOGI(TAG, "");
+
+  /* ===================================================================== */
+  /* TEST 3: Continuous Ranging                                            */
+  /* ===================================================================== */
+
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+  ESP_LOGI(TAG, "TEST 3: Continuous Ranging");
+  ESP_LOGI(TAG, "─────────────────────────────────────────────────────");
+
+  last_stats = esp_timer_get_time();
+
+  for (;;)
+    {
+      if (xTaskNotifyWait(0, UINT32_MAX, &pending,
+                          pdMS_TO_TICKS(1000)) != pdTRUE)
+        {
+          ESP_LOGW(TAG, "No frame for 1 s");
+          continue;
+        }
+
+      for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+        {
+          if ((pending & (1u << i)) == 0)
+            {
+              continue;
+            }
+
+          if (vl53l5cx_acquire_frame(i, &frame) == ESP_OK)
+            {
+              if ((frame->sequence % TEST_PRINT_EVERY) == 0)
+                {
+                  test_print_frame(frame);
+                }
+
+              vl53l5cx_release_frame(i);
+            }
+        }
+
+      if (esp_timer_get_time() - last_stats >= TEST_STATS_PERIOD_MS * 1000)
+        {
+          last_stats = esp_timer_get_time();
+
+          for (int i = 0; i < VL53L5CX_SENSOR_COUNT; i++)
+            {
+              vl53l5cx_get_stats(i, &stats);
+              ESP_LOGI(TAG, "%s: frames=%" PRIu32 " dropped=%" PRIu32
+                       " i2c_errors=%" PRIu32,
+                       i == VL53L5CX_SENSOR_LEFT ? "LEFT" : "RIGHT",
+                       stats.frames, stats.dropped, stats.i2c_errors);
+            }
+        }
+    }
+}
@@ -33,5 +33,12 @@ void test_button_run(void);
 void test_ds18b20_run(void);
 void test_drv2605l_run(void);
 void test_ssd1306_run(void);
+void test_vl53l5cx_run(void);
+void test_mpu6050_run(void);
+void test_obstacle_fusion_run(void);
+void test_data_logger_codec_run(void);
+void test_power_run(void);
+void test_benchmark_run(void);
+void test_trace_replay_run(void);
 
 #endif /* __MAIN_TESTS_TESTS_H */
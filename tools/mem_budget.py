@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+#
+# Link-time memory budget: static footprint of every component, read
+# from the GNU ld map file of the firmware, checked against the ceilings
+# in memory_budget.csv (component,dram,iram,flash; bytes, empty for no
+# ceiling). Stacks, pools and queues are static storage, so the DRAM
+# column is the bulk of what the firmware uses at runtime.
+#
+#   tools/mem_budget.py build/maiamute.map [--budget memory_budget.csv]
+#                       [--strict]
+#
+# With --strict a component over budget fails the run (exit status 1);
+# otherwise it is only reported.
+
+import argparse
+import csv
+import os
+import re
+import sys
+
+# Output section -> memory region. NOLOAD flash sections and
+# debug/comment sections are not counted.
+REGIONS = (
+    ('iram', re.compile(r'^\.iram0\.')),
+    ('dram', re.compile(r'^\.(dram0\.(data|bss)|noinit)')),
+    ('flash', re.compile(r'^\.flash\.(text|rodata|appdesc)$')),
+    ('rtc', re.compile(r'^\.rtc\.')),
+)
+
+COLUMNS = ('dram', 'iram', 'flash', 'rtc')
+
+OUTPUT_RE = re.compile(r'^(\.\S+)')
+INPUT_RE = re.compile(r'^ (\S+)'
+                      r'(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*))?$')
+CONT_RE = re.compile(r'^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$')
+ARCHIVE_RE = re.compile(r'lib([^/\\]+)\.a\(')
+
+
+def region_of(section):
+    for name, pattern in REGIONS:
+        if pattern.match(section):
+            return name
+    return None
+
+
+def component_of(path):
+    # esp-idf/<component>/lib<component>.a(file.c.obj), or a toolchain
+    # archive, or a bare object file
+    m = ARCHIVE_RE.search(path)
+    if m:
+        return m.group(1)
+    return os.path.basename(path).split('.')[0]
+
+
+def parse_map(path):
+    usage = {}
+    region = None
+    pending = False
+    in_map = False
+
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if not in_map:
+                in_map = line.startswith('Linker script and memory map')
+                continue
+
+            m = OUTPUT_RE.match(line)
+            if m:
+                region = region_of(m.group(1))
+                pending = False
+                continue
+
+            if region is None:
+                continue
+
+            m = INPUT_RE.match(line)
+            if m and not m.group(1).startswith('*'):
+                if m.group(2) is None:
+                    # Long input section name: address, size and file
+                    # on the next line
+                    pending = True
+                    continue
+                size, owner = int(m.group(3), 16), m.group(4)
+            elif pending and CONT_RE.match(line):
+                m = CONT_RE.match(line)
+                size, owner = int(m.group(2), 16), m.group(3)
+            else:
+                pending = False
+                continue
+
+            pending = False
+            if size:
+                counts = usage.setdefault(component_of(owner),
+                                          dict.fromkeys(COLUMNS, 0))
+                counts[region] += size
+
+    return usage
+
+
+def load_budget(path):
+    budget = {}
+    with open(path, newline='') as f:
+        rows = (r for r in f if r.strip() and not r.startswith('#'))
+        for row in csv.DictReader(rows):
+            budget[row['component'].strip()] = {
+                k: int(row[k]) for k in ('dram', 'iram', 'flash')
+                if row.get(k, '').strip()
+            }
+    return budget
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Per-component memory budget')
+    parser.add_argument('map', help='GNU ld map file')
+    parser.add_argument('--budget', help='budget CSV')
+    parser.add_argument('--strict', action='store_true',
+                        help='fail if a component is over budget')
+    args = parser.parse_args()
+
+    usage = parse_map(args.map)
+    budget = load_budget(args.budget) if args.budget else {}
+    over = []
+
+    print('%-24s %8s %8s %8s %8s' % (('component',) + COLUMNS))
+    for name in sorted(usage, key=lambda n: (-usage[n]['dram'], n)):
+        counts = usage[name]
+        limits = budget.get(name, {})
+        flags = [k for k, v in limits.items() if counts[k] > v]
+        print('%-24s %8d %8d %8d %8d%s' % (
+            (name,) + tuple(counts[k] for k in COLUMNS) +
+            ('  OVER ' + ','.join(flags) if flags else '',)))
+        over += ['%s %s %d > %d' % (name, k, counts[k], limits[k])
+                 for k in flags]
+
+    totals = [sum(u[k] for u in usage.values()) for k in COLUMNS]
+    print('%-24s %8d %8d %8d %8d' % tuple(['total'] + totals))
+
+    for name in sorted(set(budget) - set(usage)):
+        print('warning: budgeted component %s not in the map' % name,
+              file=sys.stderr)
+
+    for line in over:
+        print('memory budget exceeded: ' + line, file=sys.stderr)
+
+    return 1 if over and args.strict else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())